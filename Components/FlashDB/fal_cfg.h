@@ -1,14 +1,16 @@
 /**
  * @file fal_cfg.h
  * @brief FAL (Flash Abstraction Layer) 配置文件 - FM33LG04x平台
- * @version 1.1.0
+ * @version 1.2.0
  * @date 2026-01-05
  *
  * FM33LG04x Flash布局 (256KB总容量):
  * ┌───────────────────────────────────────────────────┐
  * │ 0x00000 - 0x03FFF │ Bootloader (16KB)             │
  * ├───────────────────────────────────────────────────┤
- * │ 0x04000 - 0x3BFFF │ APP (224KB)                   │
+ * │ 0x04000 - 0x1FFFF │ APP (A区, 112KB)              │
+ * ├───────────────────────────────────────────────────┤
+ * │ 0x20000 - 0x3BFFF │ fw_bank (B区, 112KB)          │ ← 后台下载的新固件
  * ├───────────────────────────────────────────────────┤
  * │ 0x3C000 - 0x3DFFF │ test_stats (8KB/4扇区)        │ ← 测试统计日志
  * ├───────────────────────────────────────────────────┤
@@ -21,6 +23,8 @@
 #ifndef _FAL_CFG_H_
 #define _FAL_CFG_H_
 
+#include <stdint.h>
+
 /*============================================================================
  * Flash 设备定义
  *===========================================================================*/
@@ -30,6 +34,30 @@
 /* 声明 Flash 设备 */
 extern const struct fal_flash_dev fm33lg04_onchip_flash;
 
+/**
+ * @brief 写合并/读缓存统计 (fal_flash_fm33lg04_port.c)
+ */
+typedef struct {
+  uint32_t sessions;       /**< 编程次数 (每次一个解锁周期, 连续多字) */
+  uint32_t words;          /**< 编程的字 */
+  uint32_t words_skipped;  /**< 全1或与现值相同而跳过的字 */
+  uint32_t wc_flushes;     /**< 写合并行刷出次数 */
+  uint32_t rewrite_errors; /**< 未擦除即改写 (需要 0->1) 被拒绝 */
+  uint32_t erases;         /**< 扇区擦除次数 */
+  uint32_t rc_hits;        /**< 读缓存命中 */
+  uint32_t rc_misses;      /**< 读缓存未命中 */
+} fal_fm33_stats_t;
+
+/**
+ * @brief 编程写合并行中尚未写入的数据
+ * @return 0: 成功, -1: 编程失败
+ * @note 直接使用 fal_partition_write 或 FlashDB 的模块在一次操作完成后调用,
+ *       保证返回前数据已落盘 (读取本身总能读到最新数据)
+ */
+int fal_flash_fm33lg04_sync(void);
+
+void fal_flash_fm33lg04_get_stats(fal_fm33_stats_t *stats);
+
 /* Flash 设备表 */
 #define FAL_FLASH_DEV_TABLE                                                    \
   { &fm33lg04_onchip_flash, }
@@ -52,15 +80,23 @@ extern const struct fal_flash_dev fm33lg04_onchip_flash;
  * - test_stats 分区用于存储测试统计信息 (支持磨损均衡)
  * - upgrade_params 分区用于存储升级参数，Bootloader和APP共享
  * - kvdb 分区用于FlashDB的KVDB存储
+ * - fw_bank 分区 (B区) 存放后台下载的新固件，复位后由Bootloader拷贝到APP区
+ *   (见 Protocol/upgrade_bank.h)，APP镜像因此不能超过112KB
  */
 #define FAL_PART_TABLE                                                         \
   {                                                                            \
     {FAL_PART_MAGIC_WORD,                                                      \
-     "test_stats",                                                             \
+     "fw_bank",                                                                \
      FM33LG04_FLASH_DEV_NAME,                                                  \
-     0x3C000,                                                                  \
-     8 * 1024,                                                                 \
+     0x20000,                                                                  \
+     112 * 1024,                                                               \
      0},                                                                       \
+        {FAL_PART_MAGIC_WORD,                                                  \
+         "test_stats",                                                         \
+         FM33LG04_FLASH_DEV_NAME,                                              \
+         0x3C000,                                                              \
+         8 * 1024,                                                             \
+         0},                                                                   \
         {FAL_PART_MAGIC_WORD,                                                  \
          "upgrade_params",                                                     \
          FM33LG04_FLASH_DEV_NAME,                                              \
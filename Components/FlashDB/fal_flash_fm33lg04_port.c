@@ -1,17 +1,39 @@
 /**
  * @file fal_flash_fm33lg04_port.c
  * @brief FAL Flash 移植层 - FM33LG04x平台
- * @version 1.0.0
+ * @version 1.1.0
  * @date 2026-01-05
  *
  * 实现 FlashDB 的 FAL (Flash Abstraction Layer) 接口
  * 使用 FM33LG0xx FL Driver 进行底层Flash操作
+ *
+ * 写合并: 写入先合并到一行 (FAL_FM33_WC_ROW_SIZE) 的RAM镜像, 换行/改写行内
+ * 已待写的字/擦除/fal_flash_fm33lg04_sync() 时一次解锁连续编程脏字。
+ * 改写待写字前先刷出, 保证 FlashDB 状态字的先后顺序 (PRE_WRITE -> 数据 ->
+ * WRITE) 不被合并打乱, 掉电安全性与逐字编程相同。
+ * 编程前检查 NOR 语义: 全1字跳过, 与Flash现值相同跳过, 需要 0->1 时报错。
+ *
+ * 读缓存: FAL_FM33_RC_LINES 行 x FAL_FM33_RC_LINE_SIZE 字节, 按地址标记,
+ * 擦除/编程时作废重叠的行。读取结果叠加尚未刷出的写合并数据。
+ *
+ * 定义 FAL_FLASH_SIM 时底层读/编程/擦除改用 sim/flash_sim.c 的RAM模拟
+ * NOR (本机基准测试, 见 VscodeGcc/scripts/flash_bench.py)。
  */
 
-#include "fm33lg0xx_fl.h"
 #include <fal.h>
 #include <string.h>
 
+#ifdef FAL_FLASH_SIM
+#include "flash_sim.h"
+#else
+#include "WTD.h"
+#include "fm33lg0xx_fl.h"
+#endif
+
+#ifndef FAL_SIM_CHARGE
+#define FAL_SIM_CHARGE(cycles)
+#endif
+
 /*============================================================================
  * FM33LG04x Flash 参数
  *===========================================================================*/
@@ -21,6 +43,341 @@
 #define FM33LG04_FLASH_SECTOR_SIZE (2 * 1024)  /**< 扇区大小 2KB */
 #define FM33LG04_FLASH_PAGE_SIZE (512)         /**< 页大小 512B */
 
+/*============================================================================
+ * 写合并 / 读缓存配置
+ *===========================================================================*/
+
+/** 写合并行大小 (字节, 4~128 且为2的幂), 0 = 每次写入立即编程 */
+#ifndef FAL_FM33_WC_ROW_SIZE
+#define FAL_FM33_WC_ROW_SIZE 128
+#endif
+
+/**
+ * 读缓存行数, 0 = 直接读Flash
+ * 片上Flash按地址直接读取只有1个等待周期, 查缓存反而更慢 (flash_bench.py
+ * 周期模型中 kv_get/kv_boot 慢 10%~13%), 默认关闭; 底层换成外部/慢速存储
+ * 时再开启
+ */
+#ifndef FAL_FM33_RC_LINES
+#define FAL_FM33_RC_LINES 0
+#endif
+
+/** 读缓存行大小 (字节, 2的幂) */
+#ifndef FAL_FM33_RC_LINE_SIZE
+#define FAL_FM33_RC_LINE_SIZE 32
+#endif
+
+#define WC_WORDS (FAL_FM33_WC_ROW_SIZE / 4)
+
+#if FAL_FM33_WC_ROW_SIZE > 128
+#error "FAL_FM33_WC_ROW_SIZE: 脏字掩码为32位, 最大128字节"
+#endif
+
+/*============================================================================
+ * 内部变量
+ *===========================================================================*/
+
+static fal_fm33_stats_t s_stats;
+
+#if FAL_FM33_WC_ROW_SIZE > 0
+static struct {
+  uint32_t row;             /**< 行起始地址 */
+  uint32_t dirty;           /**< 待写字掩码, 0 = 空 */
+  uint32_t data[WC_WORDS];  /**< 行镜像 (未写字为全1) */
+} s_wc;
+#endif
+
+#if FAL_FM33_RC_LINES > 0
+static struct {
+  uint32_t tag[FAL_FM33_RC_LINES]; /**< 行地址, 0xFFFFFFFF = 无效 */
+  uint8_t data[FAL_FM33_RC_LINES][FAL_FM33_RC_LINE_SIZE];
+  uint8_t next;                    /**< 轮换替换位置 */
+} s_rc;
+#endif
+
+/*============================================================================
+ * 底层操作
+ *===========================================================================*/
+
+#ifdef FAL_FLASH_SIM
+
+static void hw_read(uint32_t addr, uint8_t *buf, size_t size) {
+  flash_sim_read(addr, buf, size);
+}
+
+static uint32_t hw_read_word(uint32_t addr) { return flash_sim_read_word(addr); }
+
+static int hw_program(uint32_t addr, const uint32_t *words, size_t count) {
+  return flash_sim_program(addr, words, count);
+}
+
+static int hw_erase_sector(uint32_t addr) { return flash_sim_erase(addr); }
+
+#define hw_erase_begin()
+#define hw_erase_checkin()
+#define hw_erase_end()
+
+#else
+
+static void hw_read(uint32_t addr, uint8_t *buf, size_t size) {
+  /* 直接内存读取 */
+  memcpy(buf, (const void *)addr, size);
+}
+
+static uint32_t hw_read_word(uint32_t addr) {
+  return *(const volatile uint32_t *)addr;
+}
+
+/**
+ * @brief 一次解锁连续编程多个字 (同 FL_FLASH_Program_Page, 长度任意)
+ * @note 每字仍需等待编程完成; 省去的是逐字的时钟开关和解锁/上锁
+ */
+static int hw_program(uint32_t addr, const uint32_t *words, size_t count) {
+  uint32_t primask;
+  uint32_t timeout;
+  int ret = 0;
+
+  if (FL_FLASH_GetFlashLockStatus(FLASH) == FL_FLASH_KEY_STATUS_ERROR) {
+    return -1; /* 复位前无法操作 */
+  }
+
+  FL_CMU_EnableGroup2BusClock(FL_CMU_GROUP2_BUSCLK_FLASH);
+  FL_CMU_EnableGroup3OperationClock(FL_CMU_GROUP3_OPCLK_FLASH);
+  FL_FLASH_EnableProgram(FLASH);
+  primask = __get_PRIMASK();
+  __disable_irq();
+  FL_FLASH_UnlockFlash(FLASH, FL_FLASH_PROGRAM_KEY1);
+  FL_FLASH_UnlockFlash(FLASH, FL_FLASH_PROGRAM_KEY2);
+  __set_PRIMASK(primask);
+  FL_FLASH_ClearFlag_ClockError(FLASH);
+  FL_FLASH_ClearFlag_AuthenticationError(FLASH);
+
+  while (count-- > 0 && ret == 0) {
+    FL_FLASH_EnableProgram(FLASH);
+    *((volatile uint32_t *)addr) = *words++;
+    addr += 4;
+    for (timeout = 0;; timeout++) {
+      if (timeout > FL_FLASH_ERASE_TIMEOUT ||
+          FL_FLASH_IsActiveFlag_ClockError(FLASH) ||
+          FL_FLASH_IsActiveFlag_KeyError(FLASH) ||
+          FL_FLASH_IsActiveFlag_AuthenticationError(FLASH)) {
+        ret = -1;
+        break;
+      }
+      if (FL_FLASH_IsActiveFlag_ProgramComplete(FLASH)) {
+        FL_FLASH_ClearFlag_ProgramComplete(FLASH);
+        break;
+      }
+    }
+  }
+
+  FL_FLASH_LockFlash(FLASH);
+  FL_CMU_DisableGroup3OperationClock(FL_CMU_GROUP3_OPCLK_FLASH);
+  FL_CMU_DisableGroup2BusClock(FL_CMU_GROUP2_BUSCLK_FLASH);
+  return ret;
+}
+
+static int hw_erase_sector(uint32_t addr) {
+  return FL_FLASH_SectorErase(FLASH, addr) == FL_PASS ? 0 : -1;
+}
+
+/* 整分区擦除可达数百毫秒, 每个扇区向软件看门狗签到 */
+#define hw_erase_begin() WDT_Task_Begin(WDT_TASK_FLASH, WDT_DEADLINE_FLASH)
+#define hw_erase_checkin() WDT_CheckIn(WDT_TASK_FLASH)
+#define hw_erase_end() WDT_Task_End(WDT_TASK_FLASH)
+
+#endif /* FAL_FLASH_SIM */
+
+/*============================================================================
+ * 读缓存
+ *===========================================================================*/
+
+/**
+ * @brief 作废与 [addr, addr+size) 重叠的缓存行
+ */
+static void rc_invalidate(uint32_t addr, size_t size) {
+#if FAL_FM33_RC_LINES > 0
+  for (uint8_t i = 0; i < FAL_FM33_RC_LINES; i++) {
+    uint32_t tag = s_rc.tag[i];
+    if (tag != 0xFFFFFFFF && tag < addr + size &&
+        addr < tag + FAL_FM33_RC_LINE_SIZE) {
+      s_rc.tag[i] = 0xFFFFFFFF;
+    }
+  }
+#else
+  (void)addr;
+  (void)size;
+#endif
+}
+
+static void rc_read(uint32_t addr, uint8_t *buf, size_t size) {
+#if FAL_FM33_RC_LINES > 0
+  while (size > 0) {
+    uint32_t line = addr & ~(uint32_t)(FAL_FM33_RC_LINE_SIZE - 1);
+    uint32_t pos = addr - line;
+    size_t n = FAL_FM33_RC_LINE_SIZE - pos;
+    uint8_t i;
+
+    if (n > size) {
+      n = size;
+    }
+    /* 整行读取不经过缓存, 避免大块顺序读冲掉小块热数据 */
+    if (pos == 0 && n == FAL_FM33_RC_LINE_SIZE) {
+      hw_read(addr, buf, n);
+    } else {
+      for (i = 0; i < FAL_FM33_RC_LINES; i++) {
+        if (s_rc.tag[i] == line) {
+          break;
+        }
+      }
+      if (i < FAL_FM33_RC_LINES) {
+        s_stats.rc_hits++;
+      } else {
+        s_stats.rc_misses++;
+        i = s_rc.next;
+        s_rc.next = (uint8_t)((i + 1) % FAL_FM33_RC_LINES);
+        hw_read(line, s_rc.data[i], FAL_FM33_RC_LINE_SIZE);
+        s_rc.tag[i] = line;
+      }
+      FAL_SIM_CHARGE(FAL_SIM_COST_RC_LOOKUP + n / 4);
+      memcpy(buf, &s_rc.data[i][pos], n);
+    }
+    addr += n;
+    buf += n;
+    size -= n;
+  }
+#else
+  hw_read(addr, buf, size);
+#endif
+}
+
+/*============================================================================
+ * 写合并
+ *===========================================================================*/
+
+/**
+ * @brief 按 NOR 语义编程一段字: 全1/与现值相同的字跳过, 需要 0->1 时失败
+ */
+static int program_words(uint32_t addr, const uint32_t *words, size_t count) {
+  size_t i = 0;
+
+  while (i < count) {
+    size_t run = 0;
+
+    /* 找出需要编程的连续字 */
+    while (i + run < count) {
+      uint32_t cur = hw_read_word(addr + (i + run) * 4);
+      uint32_t want = words[i + run];
+      if ((cur & want) != want) {
+        s_stats.rewrite_errors++;
+        return -1; /* 未擦除 */
+      }
+      if (cur == want) {
+        break;
+      }
+      run++;
+    }
+
+    if (run > 0) {
+      rc_invalidate(addr + i * 4, run * 4);
+      s_stats.sessions++;
+      s_stats.words += run;
+      if (hw_program(addr + i * 4, &words[i], run) != 0) {
+        return -1;
+      }
+      i += run;
+    } else {
+      s_stats.words_skipped++;
+      i++;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief 编程写合并行中的待写字
+ */
+static int wc_flush(void) {
+#if FAL_FM33_WC_ROW_SIZE > 0
+  int ret = 0;
+  uint8_t i = 0;
+
+  if (s_wc.dirty == 0) {
+    return 0;
+  }
+  s_stats.wc_flushes++;
+  while (i < WC_WORDS && ret == 0) {
+    uint8_t start;
+    if (!(s_wc.dirty & (1UL << i))) {
+      i++;
+      continue;
+    }
+    start = i;
+    while (i < WC_WORDS && (s_wc.dirty & (1UL << i))) {
+      i++;
+    }
+    ret = program_words(s_wc.row + start * 4U, &s_wc.data[start], i - start);
+  }
+  s_wc.dirty = 0;
+  return ret;
+#else
+  return 0;
+#endif
+}
+
+/**
+ * @brief 合并写入一个字 (addr 4字节对齐)
+ */
+static int wc_put(uint32_t addr, uint32_t word) {
+#if FAL_FM33_WC_ROW_SIZE > 0
+  uint32_t row = addr & ~(uint32_t)(FAL_FM33_WC_ROW_SIZE - 1);
+  uint8_t idx = (uint8_t)((addr - row) / 4);
+
+  /* 换行或改写待写字: 先刷出, 保持写入顺序 */
+  if (s_wc.dirty != 0 && (row != s_wc.row || (s_wc.dirty & (1UL << idx)))) {
+    if (wc_flush() != 0) {
+      return -1;
+    }
+  }
+  if (s_wc.dirty == 0) {
+    s_wc.row = row;
+    memset(s_wc.data, 0xFF, sizeof(s_wc.data));
+  }
+  s_wc.data[idx] = word;
+  s_wc.dirty |= 1UL << idx;
+  return 0;
+#else
+  return program_words(addr, &word, 1);
+#endif
+}
+
+/**
+ * @brief 读取结果叠加尚未编程的写合并数据 (NOR 写入只能清0, 按位与)
+ */
+static void wc_overlay(uint32_t addr, uint8_t *buf, size_t size) {
+#if FAL_FM33_WC_ROW_SIZE > 0
+  if (s_wc.dirty == 0 || addr >= s_wc.row + FAL_FM33_WC_ROW_SIZE ||
+      addr + size <= s_wc.row) {
+    return;
+  }
+  for (uint8_t i = 0; i < WC_WORDS; i++) {
+    uint32_t waddr = s_wc.row + i * 4U;
+    if (!(s_wc.dirty & (1UL << i))) {
+      continue;
+    }
+    for (uint8_t b = 0; b < 4; b++) {
+      if (waddr + b >= addr && waddr + b < addr + size) {
+        buf[waddr + b - addr] &= (uint8_t)(s_wc.data[i] >> (b * 8));
+      }
+    }
+  }
+#else
+  (void)addr;
+  (void)buf;
+  (void)size;
+#endif
+}
+
 /*============================================================================
  * Flash 操作实现
  *===========================================================================*/
@@ -31,6 +388,9 @@
  */
 static int fm33lg04_flash_init(void) {
   /* FM33LG04x Flash 无需特殊初始化 */
+#if FAL_FM33_RC_LINES > 0
+  memset(s_rc.tag, 0xFF, sizeof(s_rc.tag));
+#endif
   return 0;
 }
 
@@ -44,8 +404,8 @@ static int fm33lg04_flash_init(void) {
 static int fm33lg04_flash_read(long offset, uint8_t *buf, size_t size) {
   uint32_t addr = FM33LG04_FLASH_START_ADDR + offset;
 
-  /* 直接内存读取 */
-  memcpy(buf, (const void *)addr, size);
+  rc_read(addr, buf, size);
+  wc_overlay(addr, buf, size);
 
   return size;
 }
@@ -57,14 +417,14 @@ static int fm33lg04_flash_read(long offset, uint8_t *buf, size_t size) {
  * @param size 写入字节数
  * @return 实际写入的字节数，-1表示错误
  *
- * @note FM33LG04x 要求4字节对齐写入
+ * @note FM33LG04x 要求4字节对齐写入; 数据可能仍在写合并行中,
+ *       需要落盘时调用 fal_flash_fm33lg04_sync()
  */
 static int fm33lg04_flash_write(long offset, const uint8_t *buf, size_t size) {
   uint32_t addr = FM33LG04_FLASH_START_ADDR + offset;
   size_t i;
   uint32_t write_data;
   const uint8_t *src = buf;
-  FL_ErrorStatus status;
 
   /* 检查4字节对齐 */
   if ((addr % 4) != 0) {
@@ -75,18 +435,19 @@ static int fm33lg04_flash_write(long offset, const uint8_t *buf, size_t size) {
   for (i = 0; i < size; i += 4) {
     /* 组装32位数据 (小端序) */
     if (i + 4 <= size) {
-      write_data = src[0] | (src[1] << 8) | (src[2] << 16) | (src[3] << 24);
+      write_data = src[0] | (src[1] << 8) | (src[2] << 16) |
+                   ((uint32_t)src[3] << 24);
     } else {
-      /* 处理不足4字节的尾部数据 */
-      write_data = 0xFFFFFFFF;
+      /* 处理不足4字节的尾部数据: 其余字节保持Flash现值, 不要求 0->1 */
+      fm33lg04_flash_read(addr - FM33LG04_FLASH_START_ADDR,
+                          (uint8_t *)&write_data, 4);
       for (size_t j = 0; j < (size - i); j++) {
-        write_data &= ~(0xFF << (j * 8));
-        write_data |= (src[j] << (j * 8));
+        write_data &= ~(0xFFUL << (j * 8));
+        write_data |= ((uint32_t)src[j] << (j * 8));
       }
     }
 
-    status = FL_FLASH_Program_Word(FLASH, addr, write_data);
-    if (status != FL_PASS) {
+    if (wc_put(addr, write_data) != 0) {
       return -1;
     }
 
@@ -108,20 +469,38 @@ static int fm33lg04_flash_write(long offset, const uint8_t *buf, size_t size) {
 static int fm33lg04_flash_erase(long offset, size_t size) {
   uint32_t addr = FM33LG04_FLASH_START_ADDR + offset;
   uint32_t end_addr = addr + size;
-  FL_ErrorStatus status;
 
-  /* 按扇区擦除 */
+  /* 擦除前刷出待写数据, 保持先后顺序 */
+  if (wc_flush() != 0) {
+    return -1;
+  }
+
+  hw_erase_begin();
   while (addr < end_addr) {
-    status = FL_FLASH_SectorErase(FLASH, addr);
-    if (status != FL_PASS) {
+    rc_invalidate(addr, FM33LG04_FLASH_SECTOR_SIZE);
+    s_stats.erases++;
+    if (hw_erase_sector(addr) != 0) {
+      hw_erase_end();
       return -1;
     }
+    hw_erase_checkin();
     addr += FM33LG04_FLASH_SECTOR_SIZE;
   }
+  hw_erase_end();
 
   return size;
 }
 
+/*============================================================================
+ * 公共接口
+ *===========================================================================*/
+
+int fal_flash_fm33lg04_sync(void) { return wc_flush(); }
+
+void fal_flash_fm33lg04_get_stats(fal_fm33_stats_t *stats) {
+  *stats = s_stats;
+}
+
 /*============================================================================
  * Flash 设备定义
  *===========================================================================*/
@@ -53,7 +53,7 @@ bool FlashDiag_GetInfo(FlashDiagInfo_t *info) {
   info->sector_size = FLASH_SECTOR_SIZE;
 
   /* 填充分区信息 */
-  info->partition_count = 5;
+  info->partition_count = 6;
 
   /* Bootloader */
   info->partitions[0].name = "bootloader";
@@ -85,6 +85,12 @@ bool FlashDiag_GetInfo(FlashDiagInfo_t *info) {
   info->partitions[4].size = FLASH_KVDB_SIZE;
   info->partitions[4].valid = FlashDiag_ValidatePartition("kvdb");
 
+  /* FW Bank (B区) */
+  info->partitions[5].name = "fw_bank";
+  info->partitions[5].addr = FLASH_FW_BANK_ADDR;
+  info->partitions[5].size = FLASH_FW_BANK_SIZE;
+  info->partitions[5].valid = FlashDiag_ValidatePartition("fw_bank");
+
   return true;
 }
 
@@ -97,7 +103,9 @@ void FlashDiag_PrintInfo(void) {
   log_i("| Partition      | Address Range         | Size   | Status   |");
   log_i("+----------------+-----------------------+--------+----------+");
   log_i("| bootloader     | 0x00000 - 0x03FFF     | 16KB   | --       |");
-  log_i("| app            | 0x04000 - 0x3BFFF     | 224KB  | --       |");
+  log_i("| app            | 0x04000 - 0x1FFFF     | 112KB  | --       |");
+  log_i("| fw_bank        | 0x20000 - 0x3BFFF     | 112KB  | %-8s |",
+        FlashDiag_ValidatePartition("fw_bank") ? "Valid" : "Empty");
   log_i("| test_stats     | 0x3C000 - 0x3DFFF     | 8KB    | %-8s |",
         FlashDiag_ValidatePartition("test_stats") ? "Valid" : "Empty");
   log_i("| upgrade_params | 0x3E000 - 0x3EFFF     | 4KB    | %-8s |",
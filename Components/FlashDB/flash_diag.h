@@ -31,7 +31,10 @@ extern "C" {
 #define FLASH_BOOTLOADER_SIZE (16 * 1024) /* 16KB */
 
 #define FLASH_APP_ADDR 0x00004000UL
-#define FLASH_APP_SIZE (224 * 1024) /* 224KB */
+#define FLASH_APP_SIZE (112 * 1024) /* 112KB */
+
+#define FLASH_FW_BANK_ADDR 0x00020000UL
+#define FLASH_FW_BANK_SIZE (112 * 1024) /* 112KB, 后台下载的新固件 */
 
 #define FLASH_TEST_STATS_ADDR 0x0003C000UL
 #define FLASH_TEST_STATS_SIZE (8 * 1024) /* 8KB */
@@ -67,7 +70,7 @@ typedef struct {
   uint32_t total_size;                /**< Flash总大小 */
   uint32_t sector_size;               /**< 扇区大小 */
   uint8_t partition_count;            /**< 分区数量 */
-  FlashPartitionInfo_t partitions[5]; /**< 分区信息数组 */
+  FlashPartitionInfo_t partitions[6]; /**< 分区信息数组 */
 } FlashDiagInfo_t;
 
 /*============================================================================
@@ -0,0 +1,335 @@
+/**
+ * @file golden_sample.c
+ * @brief 金样检测实现
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * 参考约 70 字节, 趋势约 300 字节, 都常驻RAM。金样检测由MES按需发起
+ * (一般每班一次), 每次检测写一次趋势, 不影响 KVDB 寿命。
+ */
+
+#define LOG_TAG "golden"
+
+#include "golden_sample.h"
+#include "jig_config.h"
+#include "utility.h"
+#include <elog.h>
+
+/*============================================================================
+ * 内部变量
+ *===========================================================================*/
+
+static GoldenRef s_ref;
+static GoldenTrend s_trend;
+static GoldenState s_state = GOLDEN_STATE_IDLE;
+static int32_t s_last[GOLDEN_MAX_CH];
+
+/*============================================================================
+ * 内部函数
+ *===========================================================================*/
+
+/**
+ * @brief 解析参考镜像, ref 为NULL时只校验
+ */
+static GoldenResult parse(const uint8_t *image, uint16_t len, GoldenRef *ref) {
+  uint8_t count;
+  uint16_t size;
+
+  if (len < GOLDEN_HEAD_SIZE + 4) {
+    return GOLDEN_ERR_SIZE;
+  }
+  if (util_read_le_u16(&image[0]) != GOLDEN_MAGIC) {
+    return GOLDEN_ERR_MAGIC;
+  }
+  if (image[2] != GOLDEN_FORMAT) {
+    return GOLDEN_ERR_FORMAT;
+  }
+  count = image[3];
+  size = GOLDEN_HEAD_SIZE + count * GOLDEN_CH_SIZE;
+  if (count == 0 || count > GOLDEN_MAX_CH || len != size + 4) {
+    return GOLDEN_ERR_SIZE;
+  }
+  if (util_crc32(image, size) != util_read_le_u32(&image[size])) {
+    return GOLDEN_ERR_CRC;
+  }
+  if (ref == NULL) {
+    return GOLDEN_OK;
+  }
+
+  ref->sample_id = util_read_le_u16(&image[4]);
+  ref->count = count;
+  ref->crc = util_read_le_u32(&image[size]);
+  for (uint8_t i = 0; i < count; i++) {
+    const uint8_t *p = &image[GOLDEN_HEAD_SIZE + i * GOLDEN_CH_SIZE];
+    ref->ch[i].expected = (int32_t)util_read_le_u32(&p[0]);
+    ref->ch[i].tol = util_read_le_u16(&p[4]);
+    ref->ch[i].drift = util_read_le_u16(&p[6]);
+  }
+  return GOLDEN_OK;
+}
+
+static void trend_reset(void) {
+  memset(&s_trend, 0, sizeof(s_trend));
+  s_trend.magic = GOLDEN_MAGIC;
+  s_trend.version = GOLDEN_TREND_VERSION;
+  s_trend.base = 1;
+}
+
+/**
+ * @brief 重新建立漂移基线: 清除标记和滤波值, 记录保留
+ */
+static void trend_rebase(void) {
+  s_trend.base = 1;
+  s_trend.since = 0;
+  s_trend.drift_mask = 0;
+  s_trend.tol_mask = 0;
+  memset(s_trend.streak, 0, sizeof(s_trend.streak));
+  memset(s_trend.ewma, 0, sizeof(s_trend.ewma));
+}
+
+static GoldenResult trend_save(void) {
+  return JigConfig_SetBlob(GOLDEN_TREND_KEY, &s_trend, sizeof(s_trend)) ==
+                 JIG_CFG_OK
+             ? GOLDEN_OK
+             : GOLDEN_ERR_FLASH;
+}
+
+static int16_t sat16(int32_t v) {
+  if (v > INT16_MAX) {
+    return INT16_MAX;
+  }
+  if (v < INT16_MIN) {
+    return INT16_MIN;
+  }
+  return (int16_t)v;
+}
+
+/*============================================================================
+ * API 实现
+ *===========================================================================*/
+
+void GoldenSample_Init(void) {
+  uint8_t image[GOLDEN_REF_MAX_SIZE];
+  uint16_t len;
+
+  memset(&s_ref, 0, sizeof(s_ref));
+  memset(s_last, 0, sizeof(s_last));
+  s_state = GOLDEN_STATE_IDLE;
+
+  len = JigConfig_GetBlob(GOLDEN_REF_KEY, image, sizeof(image));
+  if (len != 0 && parse(image, len, &s_ref) != GOLDEN_OK) {
+    log_w("保存的金样参考无效");
+    memset(&s_ref, 0, sizeof(s_ref));
+  }
+
+  if (JigConfig_GetBlob(GOLDEN_TREND_KEY, &s_trend, sizeof(s_trend)) !=
+          sizeof(s_trend) ||
+      s_trend.magic != GOLDEN_MAGIC ||
+      s_trend.version != GOLDEN_TREND_VERSION) {
+    trend_reset();
+  }
+
+  if (s_ref.count != 0) {
+    log_i("金样%u, %d通道, 已检测%u次", s_ref.sample_id, s_ref.count,
+          s_trend.runs);
+  }
+  if (GoldenSample_RecalMask() != 0) {
+    log_w("需要重新校准: 通道 %02X (漂移 %02X, 连续超差 %02X)",
+          GoldenSample_RecalMask(), s_trend.drift_mask, s_trend.tol_mask);
+  }
+}
+
+GoldenResult GoldenSample_SetRef(const uint8_t *image, uint16_t len) {
+  GoldenResult result;
+
+  if (s_state != GOLDEN_STATE_IDLE) {
+    return GOLDEN_ERR_BUSY;
+  }
+  if (len == 0) {
+    memset(&s_ref, 0, sizeof(s_ref));
+    log_i("删除金样参考");
+    return JigConfig_SetBlob(GOLDEN_REF_KEY, NULL, 0) == JIG_CFG_OK
+               ? GOLDEN_OK
+               : GOLDEN_ERR_FLASH;
+  }
+
+  result = parse(image, len, NULL);
+  if (result != GOLDEN_OK) {
+    log_w("金样参考无效: %d", result);
+    return result;
+  }
+  parse(image, len, &s_ref);
+  trend_rebase();
+  log_i("金样参考: 编号%u, %d通道 (CRC %08lX)", s_ref.sample_id, s_ref.count,
+        (unsigned long)s_ref.crc);
+
+  if (JigConfig_SetBlob(GOLDEN_REF_KEY, image, len) != JIG_CFG_OK) {
+    return GOLDEN_ERR_FLASH;
+  }
+  return trend_save();
+}
+
+uint16_t GoldenSample_GetRef(uint8_t *buf, uint16_t size) {
+  uint16_t len;
+
+  if (s_ref.count == 0) {
+    return 0;
+  }
+  len = GOLDEN_HEAD_SIZE + s_ref.count * GOLDEN_CH_SIZE;
+  if (size < len + 4) {
+    return 0;
+  }
+  util_write_le_u16(&buf[0], GOLDEN_MAGIC);
+  buf[2] = GOLDEN_FORMAT;
+  buf[3] = s_ref.count;
+  util_write_le_u16(&buf[4], s_ref.sample_id);
+  for (uint8_t i = 0; i < s_ref.count; i++) {
+    uint8_t *p = &buf[GOLDEN_HEAD_SIZE + i * GOLDEN_CH_SIZE];
+    util_write_le_u32(&p[0], (uint32_t)s_ref.ch[i].expected);
+    util_write_le_u16(&p[4], s_ref.ch[i].tol);
+    util_write_le_u16(&p[6], s_ref.ch[i].drift);
+  }
+  util_write_le_u32(&buf[len], util_crc32(buf, len));
+  return len + 4;
+}
+
+const GoldenRef *GoldenSample_Ref(void) { return &s_ref; }
+
+GoldenResult GoldenSample_Request(void) {
+  if (s_ref.count == 0) {
+    return GOLDEN_ERR_NOREF;
+  }
+  if (s_state != GOLDEN_STATE_IDLE) {
+    return GOLDEN_ERR_BUSY;
+  }
+  s_state = GOLDEN_STATE_PENDING;
+  return GOLDEN_OK;
+}
+
+bool GoldenSample_TakeRequest(void) {
+  if (s_state != GOLDEN_STATE_PENDING) {
+    return false;
+  }
+  s_state = GOLDEN_STATE_RUNNING;
+  return true;
+}
+
+void GoldenSample_Cancel(void) {
+  if (s_state != GOLDEN_STATE_IDLE) {
+    log_w("金样检测取消");
+  }
+  s_state = GOLDEN_STATE_IDLE;
+}
+
+GoldenState GoldenSample_GetState(void) { return s_state; }
+
+GoldenResult GoldenSample_Submit(const int32_t *values, uint8_t count,
+                                 GoldenRecord *rec) {
+  GoldenRecord *r;
+  uint8_t old_mask = GoldenSample_RecalMask();
+
+  s_state = GOLDEN_STATE_IDLE;
+  if (s_ref.count == 0) {
+    return GOLDEN_ERR_NOREF;
+  }
+  if (count > s_ref.count) {
+    count = s_ref.count;
+  }
+
+  r = &s_trend.rec[s_trend.head];
+  memset(r, 0, sizeof(*r));
+  r->run = ++s_trend.runs;
+  r->flags = s_trend.base ? GOLDEN_REC_BASE : 0;
+
+  for (uint8_t i = 0; i < count; i++) {
+    const GoldenChannel *ch = &s_ref.ch[i];
+    int32_t dev = values[i] - ch->expected;
+    int32_t mag = dev < 0 ? -dev : dev;
+    int32_t *f = &s_trend.ewma[i];
+
+    s_last[i] = values[i];
+    r->dev[i] = sat16(dev);
+    if (ch->tol == 0) {
+      continue;
+    }
+
+    /* 超差: 单次只记录, 连续 GOLDEN_FAIL_CONFIRM 次才标记 */
+    if (mag > ch->tol) {
+      r->fail |= 1U << i;
+      if (s_trend.streak[i] < 0xFF) {
+        s_trend.streak[i]++;
+      }
+      if (s_trend.streak[i] >= GOLDEN_FAIL_CONFIRM) {
+        s_trend.tol_mask |= 1U << i;
+      }
+    } else {
+      s_trend.streak[i] = 0;
+    }
+
+    /* 漂移估计: 偏差的指数滤波 (x16 保留小数), 基线后第一次直接取偏差。
+     * 超差的偏差按允许偏差计入, 单次异常读数 (接触不良) 不会拉出漂移标记,
+     * 持续超差由上面的连续超差判断 */
+    if (dev > ch->tol) {
+      dev = ch->tol;
+    } else if (dev < -(int32_t)ch->tol) {
+      dev = -(int32_t)ch->tol;
+    }
+    if (s_trend.base) {
+      *f = dev * 16;
+    } else {
+      *f += (dev * 16 - *f) / (1 << GOLDEN_EWMA_SHIFT);
+    }
+    if (ch->drift != 0 && (*f > (int32_t)ch->drift * 16 ||
+                           *f < -(int32_t)ch->drift * 16)) {
+      s_trend.drift_mask |= 1U << i;
+    }
+  }
+
+  if (GoldenSample_RecalMask() & ~old_mask) {
+    r->flags |= GOLDEN_REC_RECAL;
+    log_w("金样检测: 通道 %02X 需要重新校准",
+          GoldenSample_RecalMask() & ~old_mask);
+  }
+  s_trend.base = 0;
+  if (s_trend.since < 0xFFFF) {
+    s_trend.since++;
+  }
+  s_trend.head = (s_trend.head + 1) % GOLDEN_TREND_NUM;
+  if (s_trend.count < GOLDEN_TREND_NUM) {
+    s_trend.count++;
+  }
+  log_i("金样检测 #%u: 超差 %02X, 需校准 %02X", r->run, r->fail,
+        GoldenSample_RecalMask());
+
+  if (rec != NULL) {
+    *rec = *r;
+  }
+  return trend_save();
+}
+
+const int32_t *GoldenSample_LastValues(void) { return s_last; }
+
+uint8_t GoldenSample_RecalMask(void) {
+  return s_trend.drift_mask | s_trend.tol_mask;
+}
+
+GoldenResult GoldenSample_ClearRecal(void) {
+  if (s_state != GOLDEN_STATE_IDLE) {
+    return GOLDEN_ERR_BUSY;
+  }
+  trend_rebase();
+  log_i("清除重新校准标记, 重新建立漂移基线");
+  return trend_save();
+}
+
+const GoldenTrend *GoldenSample_GetTrend(void) { return &s_trend; }
+
+void GoldenSample_Print(void) {
+  log_i("金样%u, %d通道, 检测%u次 (基线后%u次), 需校准 %02X", s_ref.sample_id,
+        s_ref.count, s_trend.runs, s_trend.since, GoldenSample_RecalMask());
+  for (uint8_t i = 0; i < s_ref.count; i++) {
+    log_i("  通道%d: 期望%ld 偏差±%u 漂移门限%u, 最近%ld, 漂移估计%ld/16", i,
+          (long)s_ref.ch[i].expected, s_ref.ch[i].tol, s_ref.ch[i].drift,
+          (long)s_last[i], (long)s_trend.ewma[i]);
+  }
+}
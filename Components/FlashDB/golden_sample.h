@@ -0,0 +1,244 @@
+/**
+ * @file golden_sample.h
+ * @brief 金样检测: 测量准确度回归与漂移跟踪
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * @section intro 简介
+ * 电压 (ADC_CHK.c, 以 VREF1P2 为基准) 和功耗 (ZDINA219.c) 的测量误差
+ * 原先没有任何跟踪, 基准或分流电阻漂移只表现为误判率慢慢升高。
+ * 金样检测把一块已知的参考被测板 (金样) 放到工位上, MES 发命令后按生产
+ * 测试相同的路径测量各通道, 与保存的期望值比较:
+ *   - 参考: 各通道期望值、允许偏差、漂移门限, 由MES下载 (带CRC32)
+ *   - 判定: |测量值 - 期望值| <= 允许偏差
+ *   - 趋势: 每次检测的偏差记入环形记录, 同时做指数滤波
+ *           (系数 1/2^GOLDEN_EWMA_SHIFT, 超差时按允许偏差计入) 得到漂移
+ *           估计, 和记录一起保存在 jig_config 的 KVDB 中, 复位后继续累计
+ *   - 标记: 漂移估计超过漂移门限, 或同一通道连续 GOLDEN_FAIL_CONFIRM 次
+ *           超差时, 标记该通道需要重新校准; 标记一直保持到校准后清除
+ * 测量由调用方完成 (Src/Golden_Ctrl.c), 本模块只做判定和保存, 可在本机
+ * 编译仿真 (VscodeGcc/scripts/golden_sim.py)。
+ *
+ * @section format 参考镜像格式 (小端)
+ *   头部 6 字节:
+ *     [0-1] 魔数 0x5347 ("GS")
+ *     [2]   格式版本 GOLDEN_FORMAT
+ *     [3]   通道数 N (1..GOLDEN_MAX_CH)
+ *     [4-5] 金样编号
+ *   通道 8 字节 * N:
+ *     [0-3] 期望值 (int32, mV 或 uA)
+ *     [4-5] 允许偏差 (同单位), 0=不检测该通道
+ *     [6-7] 漂移门限 (同单位), 0=不做漂移判断
+ *   CRC32 4 字节: 头部和全部通道的 util_crc32
+ */
+
+#ifndef __GOLDEN_SAMPLE_H__
+#define __GOLDEN_SAMPLE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*============================================================================
+ * 配置定义
+ *===========================================================================*/
+
+#define GOLDEN_MAGIC 0x5347 /* "GS" */
+#define GOLDEN_FORMAT 1
+
+/** 最多通道数 */
+#define GOLDEN_MAX_CH 8
+
+#define GOLDEN_HEAD_SIZE 6
+#define GOLDEN_CH_SIZE 8
+#define GOLDEN_REF_MAX_SIZE                                                    \
+  (GOLDEN_HEAD_SIZE + GOLDEN_CH_SIZE * GOLDEN_MAX_CH + 4)
+
+/** 保存的检测记录条数 */
+#define GOLDEN_TREND_NUM 12
+
+/** 漂移滤波系数 1/2^n (n=2: 约最近4次检测的加权平均) */
+#define GOLDEN_EWMA_SHIFT 2
+
+/** 同一通道连续超差次数达到该值时标记 (单次超差可能是接触不良) */
+#define GOLDEN_FAIL_CONFIRM 2
+
+/** KVDB 键名 */
+#define GOLDEN_REF_KEY "gref"
+#define GOLDEN_TREND_KEY "gtrend"
+
+/** 趋势数据版本 (GoldenTrend 结构变化时递增, 旧数据丢弃) */
+#define GOLDEN_TREND_VERSION 1
+
+/** 记录标志 */
+#define GOLDEN_REC_BASE 0x01   /**< 新的基线 (下载参考或清除标记后第一次) */
+#define GOLDEN_REC_RECAL 0x02  /**< 本次检测新标记了需要重新校准的通道 */
+
+/*============================================================================
+ * 数据结构定义
+ *===========================================================================*/
+
+/**
+ * @brief 参考中的一个通道
+ */
+typedef struct {
+  int32_t expected; /**< 期望值 */
+  uint16_t tol;     /**< 允许偏差, 0=不检测 */
+  uint16_t drift;   /**< 漂移门限, 0=不做漂移判断 */
+} GoldenChannel;
+
+/**
+ * @brief 解码后的参考
+ */
+typedef struct {
+  uint16_t sample_id; /**< 金样编号 */
+  uint8_t count;      /**< 通道数, 0=没有参考 */
+  uint32_t crc;       /**< 镜像CRC32 */
+  GoldenChannel ch[GOLDEN_MAX_CH];
+} GoldenRef;
+
+/**
+ * @brief 一次检测的记录
+ */
+typedef struct {
+  uint16_t run;               /**< 检测序号 */
+  uint8_t fail;               /**< 超差通道位掩码 */
+  uint8_t flags;              /**< GOLDEN_REC_xxx */
+  int16_t dev[GOLDEN_MAX_CH]; /**< 偏差 (测量值-期望值, 饱和到int16) */
+} GoldenRecord;
+
+/**
+ * @brief 漂移趋势 (整体保存在 KVDB)
+ */
+typedef struct {
+  uint16_t magic;                      /**< GOLDEN_MAGIC */
+  uint8_t version;                     /**< GOLDEN_TREND_VERSION */
+  uint8_t head;                        /**< 下一条记录的位置 */
+  uint8_t count;                       /**< 有效记录数 */
+  uint8_t base;                        /**< 下一次检测重新建立基线 */
+  uint8_t drift_mask;                  /**< 漂移超过门限的通道 */
+  uint8_t tol_mask;                    /**< 连续超差的通道 */
+  uint16_t runs;                       /**< 累计检测次数 */
+  uint16_t since;                      /**< 建立基线后的检测次数 */
+  uint8_t streak[GOLDEN_MAX_CH];       /**< 连续超差次数 */
+  int32_t ewma[GOLDEN_MAX_CH];         /**< 漂移估计 (偏差的滤波值 x16) */
+  GoldenRecord rec[GOLDEN_TREND_NUM];  /**< 环形记录 */
+} GoldenTrend;
+
+/**
+ * @brief 结果码 (PC协议应答状态)
+ */
+typedef enum {
+  GOLDEN_OK = 0,
+  GOLDEN_ERR_SIZE,   /**< 长度与通道数不符 */
+  GOLDEN_ERR_MAGIC,  /**< 魔数错误 */
+  GOLDEN_ERR_FORMAT, /**< 不支持的格式版本 */
+  GOLDEN_ERR_CRC,    /**< CRC错误 */
+  GOLDEN_ERR_NOREF,  /**< 没有参考 */
+  GOLDEN_ERR_BUSY,   /**< 检测进行中或测试进行中 */
+  GOLDEN_ERR_FLASH,  /**< 保存失败 (RAM中已生效, 复位后丢失) */
+} GoldenResult;
+
+/**
+ * @brief 检测状态
+ */
+typedef enum {
+  GOLDEN_STATE_IDLE = 0, /**< 空闲 */
+  GOLDEN_STATE_PENDING,  /**< 已请求, 等待开始测量 */
+  GOLDEN_STATE_RUNNING,  /**< 测量中 */
+} GoldenState;
+
+/*============================================================================
+ * API 函数
+ *===========================================================================*/
+
+/**
+ * @brief 初始化: 加载参考和趋势 (在 JigConfig_Init 之后)
+ */
+void GoldenSample_Init(void);
+
+/**
+ * @brief 下载参考: 校验后保存, 各通道重新建立漂移基线 (记录保留)
+ * @param image 镜像, len=0 表示删除参考
+ * @param len 镜像长度
+ * @return 结果码
+ */
+GoldenResult GoldenSample_SetRef(const uint8_t *image, uint16_t len);
+
+/**
+ * @brief 编码当前参考
+ * @return 镜像长度, 0: 没有参考或缓冲区不足
+ */
+uint16_t GoldenSample_GetRef(uint8_t *buf, uint16_t size);
+
+/**
+ * @brief 当前参考 (count=0 表示没有)
+ */
+const GoldenRef *GoldenSample_Ref(void);
+
+/**
+ * @brief 请求一次检测 (PC命令), 由测量方在空闲时取走
+ * @return GOLDEN_OK / GOLDEN_ERR_NOREF / GOLDEN_ERR_BUSY
+ */
+GoldenResult GoldenSample_Request(void);
+
+/**
+ * @brief 测量方取走请求
+ * @return true: 有请求, 状态变为测量中
+ */
+bool GoldenSample_TakeRequest(void);
+
+/**
+ * @brief 测量方放弃本次检测 (如测试开始), 不记入趋势
+ */
+void GoldenSample_Cancel(void);
+
+/**
+ * @brief 检测状态
+ */
+GoldenState GoldenSample_GetState(void);
+
+/**
+ * @brief 提交测量值: 判定、更新漂移估计和记录并保存
+ * @param values 各通道测量值, 顺序与参考相同
+ * @param count 通道数, 多于参考的通道忽略
+ * @param rec 输出本次记录 (可为NULL)
+ * @return 结果码 (GOLDEN_ERR_FLASH 时判定仍有效)
+ */
+GoldenResult GoldenSample_Submit(const int32_t *values, uint8_t count,
+                                 GoldenRecord *rec);
+
+/**
+ * @brief 最近一次提交的测量值 (没有时为0)
+ */
+const int32_t *GoldenSample_LastValues(void);
+
+/**
+ * @brief 需要重新校准的通道掩码 (漂移或连续超差)
+ */
+uint8_t GoldenSample_RecalMask(void);
+
+/**
+ * @brief 校准后清除标记, 各通道重新建立漂移基线 (记录保留)
+ * @return 结果码
+ */
+GoldenResult GoldenSample_ClearRecal(void);
+
+/**
+ * @brief 趋势数据 (记录按时间顺序: rec[(head - count + i) % N])
+ */
+const GoldenTrend *GoldenSample_GetTrend(void);
+
+/**
+ * @brief 打印参考和最近的记录到日志
+ */
+void GoldenSample_Print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GOLDEN_SAMPLE_H__ */
@@ -0,0 +1,400 @@
+/**
+ * @file jig_config.c
+ * @brief 工装持久化配置/校准参数存储实现
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * 使用 FlashDB KVDB 保存配置，每项一个4字节blob (int32 小端)。
+ * Flash 中只保存被修改过的项，未保存的项使用配置表中的默认值。
+ */
+
+#define LOG_TAG "jig_config"
+
+#include "jig_config.h"
+#include <elog.h>
+#include <flashdb.h>
+#include <string.h>
+
+/*============================================================================
+ * 内部定义
+ *===========================================================================*/
+
+/** 配置表版本号键名 */
+#define SCHEMA_KEY "cfg_ver"
+
+/** 基准测试循环次数 */
+#define BENCH_LOOPS 100
+
+/**
+ * @brief 配置项描述
+ */
+typedef struct {
+  const char *key;    /**< KVDB 键名 */
+  uint8_t type;       /**< JigConfigType */
+  int32_t def;        /**< 默认值 */
+  int32_t min;        /**< 最小值 */
+  int32_t max;        /**< 最大值 */
+} JigConfigItem;
+
+/**
+ * @brief 配置表 (顺序与 JigConfigId 一致)
+ * @note 默认值即原先代码中的常量
+ */
+static const JigConfigItem s_items[JIG_CFG_NUM] = {
+    [JIG_CFG_STATION_ID] = {"station", JIG_CFG_TYPE_U8,
+                            JIG_CONFIG_STATION_AUTO, 0, 0xFF},
+    [JIG_CFG_DEBUG_MODE] = {"debug", JIG_CFG_TYPE_U8, 0, 0, 1},
+    [JIG_CFG_PASSTHROUGH_MODE] = {"pt_mode", JIG_CFG_TYPE_U8, 0, 0, 1},
+    [JIG_CFG_PASSTHROUGH_PREAMBLE] = {"pt_pre", JIG_CFG_TYPE_U8, 0, 0, 1},
+    [JIG_CFG_VCC_MIN_MV] = {"vcc_min", JIG_CFG_TYPE_U16, 3000, 0, 20000},
+    [JIG_CFG_VCC_MAX_MV] = {"vcc_max", JIG_CFG_TYPE_U16, 3600, 0, 20000},
+    [JIG_CFG_MAIN_MIN_MV] = {"main_min", JIG_CFG_TYPE_U16, 5500, 0, 20000},
+    [JIG_CFG_MAIN_MAX_MV] = {"main_max", JIG_CFG_TYPE_U16, 6500, 0, 20000},
+    [JIG_CFG_VDD_MIN_MV] = {"vdd_min", JIG_CFG_TYPE_U16, 3200, 0, 20000},
+    [JIG_CFG_VDD_MAIN_MIN_MV] = {"vdd_main", JIG_CFG_TYPE_U16, 4200, 0,
+                                 20000},
+    [JIG_CFG_ADC_SCALE] = {"adc_scale", JIG_CFG_TYPE_U32, 11000, 1000, 50000},
+    [JIG_CFG_INA219_CAL] = {"ina_cal", JIG_CFG_TYPE_U16, 0x1000, 1, 0xFFFE},
+    [JIG_CFG_TEST_TIMEOUT_MS] = {"test_tmo", JIG_CFG_TYPE_U32, 90000, 1000,
+                                 600000},
+    [JIG_CFG_BUS_SLOT_MS] = {"bus_slot", JIG_CFG_TYPE_U16, 100, 20, 1000},
+    [JIG_CFG_PUSH_EN] = {"push_en", JIG_CFG_TYPE_U8, 0, 0, 1},
+    [JIG_CFG_STEP_OVERLAP] = {"step_ovl", JIG_CFG_TYPE_U8, 0, 0, 1},
+};
+
+/*============================================================================
+ * 内部变量
+ *===========================================================================*/
+
+static struct fdb_kvdb s_kvdb;
+static bool s_initialized = false;
+
+/* RAM 缓存, 未初始化时也持有默认值 */
+static int32_t s_cache[JIG_CFG_NUM];
+static bool s_cache_loaded = false;
+
+static JigConfigStats s_stats;
+static uint32_t (*s_get_us)(void) = NULL;
+
+/*============================================================================
+ * 内部函数
+ *===========================================================================*/
+
+static uint32_t now_us(void) { return (s_get_us != NULL) ? s_get_us() : 0; }
+
+static void load_defaults(void) {
+  for (uint8_t i = 0; i < JIG_CFG_NUM; i++) {
+    s_cache[i] = s_items[i].def;
+  }
+  s_cache_loaded = true;
+}
+
+static bool value_valid(JigConfigId id, int32_t value) {
+  return value >= s_items[id].min && value <= s_items[id].max;
+}
+
+/**
+ * @brief 从KVDB读取单项
+ * @return true: Flash中有有效值
+ */
+static bool kv_read(JigConfigId id, int32_t *value) {
+  struct fdb_blob blob;
+  int32_t stored = 0;
+
+  size_t len = fdb_kv_get_blob(&s_kvdb, s_items[id].key,
+                               fdb_blob_make(&blob, &stored, sizeof(stored)));
+  if (len != sizeof(stored) || blob.saved.len != sizeof(stored)) {
+    return false;
+  }
+  *value = stored;
+  return true;
+}
+
+/**
+ * @brief 写入收尾: 落盘并记录耗时统计
+ */
+static JigConfigResult write_done(const char *key, fdb_err_t err,
+                                  uint32_t start) {
+  /* 写合并中的数据落盘后才算写入完成 */
+  if (err == FDB_NO_ERR && fal_flash_fm33lg04_sync() != 0) {
+    err = FDB_WRITE_ERR;
+  }
+
+  uint32_t cost = now_us() - start;
+  s_stats.kv_writes++;
+  s_stats.write_us_last = cost;
+  s_stats.write_us_total += cost;
+  if (cost > s_stats.write_us_max) {
+    s_stats.write_us_max = cost;
+  }
+
+  if (err != FDB_NO_ERR) {
+    s_stats.kv_write_fail++;
+    log_e("写入 %s 失败: %d", key, err);
+    return JIG_CFG_ERR_FLASH;
+  }
+  return JIG_CFG_OK;
+}
+
+/**
+ * @brief 写入单项到KVDB (等于默认值时删除，节省空间)
+ */
+static JigConfigResult kv_write(JigConfigId id, int32_t value) {
+  struct fdb_blob blob;
+  fdb_err_t err;
+  uint32_t start = now_us();
+
+  if (value == s_items[id].def) {
+    err = fdb_kv_del(&s_kvdb, s_items[id].key);
+    if (err == FDB_KV_NAME_ERR) {
+      err = FDB_NO_ERR; /* 本来就没有保存 */
+    }
+  } else {
+    err = fdb_kv_set_blob(&s_kvdb, s_items[id].key,
+                          fdb_blob_make(&blob, &value, sizeof(value)));
+  }
+  return write_done(s_items[id].key, err, start);
+}
+
+/**
+ * @brief 配置表版本迁移: 旧值仍在范围内则保留，否则删除恢复默认
+ */
+static void migrate_schema(void) {
+  struct fdb_blob blob;
+  uint16_t version = 0;
+
+  fdb_kv_get_blob(&s_kvdb, SCHEMA_KEY,
+                  fdb_blob_make(&blob, &version, sizeof(version)));
+  if (blob.saved.len == sizeof(version) &&
+      version == JIG_CONFIG_SCHEMA_VERSION) {
+    return;
+  }
+
+  log_i("配置表版本 %d -> %d, 迁移中", version, JIG_CONFIG_SCHEMA_VERSION);
+  for (uint8_t i = 0; i < JIG_CFG_NUM; i++) {
+    int32_t value;
+    if (kv_read((JigConfigId)i, &value) && !value_valid((JigConfigId)i, value)) {
+      log_w("配置 %s=%ld 超出范围, 恢复默认", s_items[i].key, (long)value);
+      fdb_kv_del(&s_kvdb, s_items[i].key);
+    }
+  }
+
+  version = JIG_CONFIG_SCHEMA_VERSION;
+  fdb_kv_set_blob(&s_kvdb, SCHEMA_KEY,
+                  fdb_blob_make(&blob, &version, sizeof(version)));
+}
+
+/*============================================================================
+ * API 实现
+ *===========================================================================*/
+
+void JigConfig_SetTimeSource(uint32_t (*get_us)(void)) { s_get_us = get_us; }
+
+bool JigConfig_Init(void) {
+  uint32_t start;
+
+  load_defaults();
+  memset(&s_stats, 0, sizeof(s_stats));
+
+  if (fdb_kvdb_init(&s_kvdb, "jig_cfg", JIG_CONFIG_PARTITION, NULL, NULL) !=
+      FDB_NO_ERR) {
+    log_e("KVDB初始化失败, 使用默认配置");
+    s_initialized = false;
+    return false;
+  }
+  s_initialized = true;
+
+  migrate_schema();
+  fal_flash_fm33lg04_sync();
+
+  start = now_us();
+  for (uint8_t i = 0; i < JIG_CFG_NUM; i++) {
+    int32_t value;
+    if (kv_read((JigConfigId)i, &value) && value_valid((JigConfigId)i, value)) {
+      s_cache[i] = value;
+    }
+  }
+  s_stats.load_us = now_us() - start;
+
+  log_i("配置加载完成, %d项, 耗时%luus", JIG_CFG_NUM,
+        (unsigned long)s_stats.load_us);
+  return true;
+}
+
+int32_t JigConfig_Get(JigConfigId id) {
+  if ((unsigned)id >= JIG_CFG_NUM) {
+    return 0;
+  }
+  if (!s_cache_loaded) {
+    return s_items[id].def;
+  }
+  return s_cache[id];
+}
+
+JigConfigResult JigConfig_Set(JigConfigId id, int32_t value) {
+  uint8_t raw_id = (uint8_t)id;
+  return JigConfig_SetBulk(&raw_id, &value, 1, NULL);
+}
+
+JigConfigResult JigConfig_SetBulk(const uint8_t *ids, const int32_t *values,
+                                  uint8_t count, uint8_t *failed_index) {
+  JigConfigResult result = JIG_CFG_OK;
+
+  if (!s_cache_loaded) {
+    load_defaults();
+  }
+
+  /* 先全部校验，避免部分写入 */
+  for (uint8_t i = 0; i < count; i++) {
+    if (ids[i] >= JIG_CFG_NUM) {
+      if (failed_index != NULL) {
+        *failed_index = i;
+      }
+      return JIG_CFG_ERR_ID;
+    }
+    if (!value_valid((JigConfigId)ids[i], values[i])) {
+      if (failed_index != NULL) {
+        *failed_index = i;
+      }
+      return JIG_CFG_ERR_RANGE;
+    }
+  }
+
+  for (uint8_t i = 0; i < count; i++) {
+    JigConfigId id = (JigConfigId)ids[i];
+    if (s_cache[id] == values[i]) {
+      continue; /* 未变化不写Flash */
+    }
+    if (!s_initialized) {
+      s_cache[id] = values[i];
+      result = JIG_CFG_ERR_NOINIT;
+      continue;
+    }
+    /* 写入成功才更新缓存，写失败时缓存与Flash一致 */
+    if (kv_write(id, values[i]) != JIG_CFG_OK) {
+      if (failed_index != NULL) {
+        *failed_index = i;
+      }
+      return JIG_CFG_ERR_FLASH;
+    }
+    s_cache[id] = values[i];
+  }
+  return result;
+}
+
+JigConfigResult JigConfig_Reset(JigConfigId id) {
+  if ((unsigned)id >= JIG_CFG_NUM) {
+    return JIG_CFG_ERR_ID;
+  }
+  return JigConfig_Set(id, s_items[id].def);
+}
+
+JigConfigResult JigConfig_ResetAll(void) {
+  JigConfigResult result = JIG_CFG_OK;
+  for (uint8_t i = 0; i < JIG_CFG_NUM; i++) {
+    JigConfigResult r = JigConfig_Reset((JigConfigId)i);
+    if (r != JIG_CFG_OK) {
+      result = r;
+    }
+  }
+  return result;
+}
+
+uint16_t JigConfig_GetBlob(const char *key, void *buf, uint16_t size) {
+  struct fdb_blob blob;
+  size_t len;
+
+  if (!s_initialized) {
+    return 0;
+  }
+  len = fdb_kv_get_blob(&s_kvdb, key, fdb_blob_make(&blob, buf, size));
+  if (len == 0 || blob.saved.len > size) {
+    return 0;
+  }
+  return (uint16_t)len;
+}
+
+JigConfigResult JigConfig_SetBlob(const char *key, const void *buf,
+                                  uint16_t len) {
+  struct fdb_blob blob;
+  fdb_err_t err;
+  uint32_t start = now_us();
+
+  if (!s_initialized) {
+    return JIG_CFG_ERR_NOINIT;
+  }
+  if (len == 0) {
+    err = fdb_kv_del(&s_kvdb, key);
+    if (err == FDB_KV_NAME_ERR) {
+      err = FDB_NO_ERR;
+    }
+  } else {
+    err = fdb_kv_set_blob(&s_kvdb, key, fdb_blob_make(&blob, buf, len));
+  }
+  return write_done(key, err, start);
+}
+
+JigConfigType JigConfig_GetType(JigConfigId id) {
+  if ((unsigned)id >= JIG_CFG_NUM) {
+    return JIG_CFG_TYPE_I32;
+  }
+  return (JigConfigType)s_items[id].type;
+}
+
+const char *JigConfig_GetName(JigConfigId id) {
+  if ((unsigned)id >= JIG_CFG_NUM) {
+    return NULL;
+  }
+  return s_items[id].key;
+}
+
+const JigConfigStats *JigConfig_GetStats(void) { return &s_stats; }
+
+void JigConfig_Benchmark(void) {
+  volatile int32_t sink = 0;
+  uint32_t start;
+  uint32_t cost;
+
+  if (s_get_us == NULL) {
+    log_w("未设置时间源, 无法测量");
+    return;
+  }
+
+  start = now_us();
+  for (uint16_t n = 0; n < BENCH_LOOPS; n++) {
+    sink += JigConfig_Get((JigConfigId)(n % JIG_CFG_NUM));
+  }
+  cost = now_us() - start;
+  s_stats.cache_read_ns = cost * 1000 / BENCH_LOOPS;
+
+  if (s_initialized) {
+    start = now_us();
+    for (uint16_t n = 0; n < BENCH_LOOPS; n++) {
+      int32_t value = 0;
+      kv_read((JigConfigId)(n % JIG_CFG_NUM), &value);
+      sink += value;
+    }
+    cost = now_us() - start;
+    s_stats.kv_read_us = cost / BENCH_LOOPS;
+  }
+  (void)sink;
+
+  log_i("读取耗时: 缓存 %luns/次, KVDB %luus/次",
+        (unsigned long)s_stats.cache_read_ns,
+        (unsigned long)s_stats.kv_read_us);
+}
+
+void JigConfig_Print(void) {
+  log_i("========== 工装配置 (v%d, %s) ==========", JIG_CONFIG_SCHEMA_VERSION,
+        s_initialized ? "KVDB" : "仅默认值");
+  for (uint8_t i = 0; i < JIG_CFG_NUM; i++) {
+    log_i("[%2d] %-10s = %ld%s", i, s_items[i].key, (long)JigConfig_Get(i),
+          (JigConfig_Get(i) == s_items[i].def) ? "" : " *");
+  }
+  log_i("写入: %lu次 (失败%lu), 最近%luus, 最大%luus, 累计%luus",
+        (unsigned long)s_stats.kv_writes, (unsigned long)s_stats.kv_write_fail,
+        (unsigned long)s_stats.write_us_last,
+        (unsigned long)s_stats.write_us_max,
+        (unsigned long)s_stats.write_us_total);
+  log_i("加载: %luus", (unsigned long)s_stats.load_us);
+}
@@ -0,0 +1,209 @@
+/**
+ * @file jig_config.h
+ * @brief 工装持久化配置/校准参数存储接口
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * 基于 FlashDB KVDB (kvdb 分区) 的类型化配置表：
+ * - 每项配置有类型、默认值和取值范围，Flash 中只保存与默认值不同的项
+ * - 启动时一次性加载到RAM缓存，读取只访问缓存，不访问Flash
+ * - 配置表版本号 (JIG_CONFIG_SCHEMA_VERSION) 变化时自动迁移：
+ *   保留仍在范围内的旧值，无效项恢复默认
+ * - 支持批量读写 (PC协议 0xD6/0xD8)
+ * - 同一KVDB中也可保存不在配置表中的数据块 (如测试计划), 按键名读写
+ */
+
+#ifndef __JIG_CONFIG_H__
+#define __JIG_CONFIG_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*============================================================================
+ * 配置定义
+ *===========================================================================*/
+
+/** KVDB 分区名 */
+#define JIG_CONFIG_PARTITION "kvdb"
+
+/** 配置表版本 (增删配置项或修改范围时递增) */
+#define JIG_CONFIG_SCHEMA_VERSION 3
+
+/** 工位号自动检测 (按拨码/GPIO) */
+#define JIG_CONFIG_STATION_AUTO 0xFF
+
+/*============================================================================
+ * 数据结构定义
+ *===========================================================================*/
+
+/**
+ * @brief 配置项ID (PC协议中直接使用该编号，只能在末尾追加)
+ */
+typedef enum {
+  JIG_CFG_STATION_ID = 0,       /**< 工位号覆盖, 0xFF=自动检测 */
+  JIG_CFG_DEBUG_MODE,           /**< 调试模式 */
+  JIG_CFG_PASSTHROUGH_MODE,     /**< 透传模式 */
+  JIG_CFG_PASSTHROUGH_PREAMBLE, /**< 透传前导 */
+  JIG_CFG_VCC_MIN_MV,           /**< VCC 合格下限 (mV) */
+  JIG_CFG_VCC_MAX_MV,           /**< VCC 合格上限 (mV) */
+  JIG_CFG_MAIN_MIN_MV,          /**< 主电供电合格下限 (mV) */
+  JIG_CFG_MAIN_MAX_MV,          /**< 主电供电合格上限 (mV) */
+  JIG_CFG_VDD_MIN_MV,           /**< VDD 合格下限 (mV) */
+  JIG_CFG_VDD_MAIN_MIN_MV,      /**< VDD 测试时主电供电下限 (mV) */
+  JIG_CFG_ADC_SCALE,            /**< ADC 分压系数 x1000 (未校准的通道) */
+  JIG_CFG_INA219_CAL,           /**< INA219 校准寄存器值 (未校准时) */
+  JIG_CFG_TEST_TIMEOUT_MS,      /**< 整体测试超时 (ms) */
+  JIG_CFG_BUS_SLOT_MS,          /**< 广播命令应答时隙 (ms) */
+  JIG_CFG_PUSH_EN,              /**< 主动上报测试事件 */
+  JIG_CFG_STEP_OVERLAP,         /**< 测试步骤并行执行, 0=按原流程串行 (默认) */
+  JIG_CFG_NUM
+} JigConfigId;
+
+/**
+ * @brief 配置项类型
+ */
+typedef enum {
+  JIG_CFG_TYPE_U8 = 0,
+  JIG_CFG_TYPE_U16,
+  JIG_CFG_TYPE_U32,
+  JIG_CFG_TYPE_I32,
+} JigConfigType;
+
+/**
+ * @brief 配置项结果码 (PC协议应答状态)
+ */
+typedef enum {
+  JIG_CFG_OK = 0,
+  JIG_CFG_ERR_ID,     /**< 无效配置项 */
+  JIG_CFG_ERR_RANGE,  /**< 超出取值范围 */
+  JIG_CFG_ERR_FLASH,  /**< Flash写入失败 */
+  JIG_CFG_ERR_NOINIT, /**< 未初始化 (仅缓存生效) */
+} JigConfigResult;
+
+/**
+ * @brief 读写耗时统计
+ */
+typedef struct {
+  uint32_t kv_writes;      /**< KVDB 写入次数 */
+  uint32_t kv_write_fail;  /**< 写入失败次数 */
+  uint32_t write_us_last;  /**< 最近一次写入耗时 (含可能的GC擦除) */
+  uint32_t write_us_max;   /**< 最大写入耗时 */
+  uint32_t write_us_total; /**< 累计写入耗时 */
+  uint32_t load_us;        /**< 启动加载全部配置耗时 */
+  uint32_t cache_read_ns;  /**< 缓存读取单次耗时 (基准测试) */
+  uint32_t kv_read_us;     /**< KVDB 直接读取单次耗时 (基准测试) */
+} JigConfigStats;
+
+/*============================================================================
+ * API 函数
+ *===========================================================================*/
+
+/**
+ * @brief 设置微秒时间源 (用于耗时统计，可不设置)
+ * @param get_us 返回单调递增微秒计数的函数
+ */
+void JigConfig_SetTimeSource(uint32_t (*get_us)(void));
+
+/**
+ * @brief 初始化: 挂载KVDB、迁移配置表版本、加载全部配置到缓存
+ * @return true: 成功, false: KVDB不可用 (仍可读取默认值)
+ */
+bool JigConfig_Init(void);
+
+/**
+ * @brief 读取配置 (只读RAM缓存)
+ * @param id 配置项ID
+ * @return 配置值，无效ID返回0
+ */
+int32_t JigConfig_Get(JigConfigId id);
+
+/**
+ * @brief 写入单个配置 (更新缓存并保存到Flash)
+ * @param id 配置项ID
+ * @param value 配置值
+ * @return 结果码
+ */
+JigConfigResult JigConfig_Set(JigConfigId id, int32_t value);
+
+/**
+ * @brief 批量写入配置 (先全部校验，全部有效后才写入)
+ * @param ids 配置项ID数组
+ * @param values 配置值数组
+ * @param count 数量
+ * @param failed_index 失败时输出出错项下标 (可为NULL)
+ * @return 结果码 (JIG_CFG_ERR_FLASH: 出错项及之后各项保持原值,
+ *         之前各项已写入)
+ */
+JigConfigResult JigConfig_SetBulk(const uint8_t *ids, const int32_t *values,
+                                  uint8_t count, uint8_t *failed_index);
+
+/**
+ * @brief 恢复单项默认值 (删除Flash中的覆盖值)
+ * @param id 配置项ID
+ * @return 结果码
+ */
+JigConfigResult JigConfig_Reset(JigConfigId id);
+
+/**
+ * @brief 全部恢复默认值
+ * @return 结果码
+ */
+JigConfigResult JigConfig_ResetAll(void);
+
+/**
+ * @brief 读取数据块 (不在配置表中的键, 如测试计划)
+ * @param key KVDB 键名, 不能与配置项重名
+ * @param buf 输出缓冲区
+ * @param size 缓冲区大小
+ * @return 数据块长度, 0: 不存在、长度超过 size 或KVDB不可用
+ */
+uint16_t JigConfig_GetBlob(const char *key, void *buf, uint16_t size);
+
+/**
+ * @brief 写入数据块并落盘
+ * @param key KVDB 键名
+ * @param buf 数据
+ * @param len 长度, 0 表示删除该键
+ * @return 结果码 (JIG_CFG_ERR_NOINIT: KVDB不可用)
+ */
+JigConfigResult JigConfig_SetBlob(const char *key, const void *buf,
+                                  uint16_t len);
+
+/**
+ * @brief 获取配置项类型
+ * @param id 配置项ID
+ * @return 类型, 无效ID返回 JIG_CFG_TYPE_I32
+ */
+JigConfigType JigConfig_GetType(JigConfigId id);
+
+/**
+ * @brief 获取配置项名称 (即KVDB键名)
+ * @param id 配置项ID
+ * @return 名称, 无效ID返回NULL
+ */
+const char *JigConfig_GetName(JigConfigId id);
+
+/**
+ * @brief 获取读写耗时统计
+ */
+const JigConfigStats *JigConfig_GetStats(void);
+
+/**
+ * @brief 基准测试: 测量缓存读取与KVDB直接读取的单次耗时，结果写入统计
+ */
+void JigConfig_Benchmark(void);
+
+/**
+ * @brief 打印全部配置和统计到日志
+ */
+void JigConfig_Print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __JIG_CONFIG_H__ */
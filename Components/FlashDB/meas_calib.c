@@ -0,0 +1,393 @@
+/**
+ * @file meas_calib.c
+ * @brief 测量通道两点校准实现
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * 校准值约 60 字节常驻RAM, 只在校准或MES恢复备份时写一次 KVDB。
+ * 计算校准值时用64位整数除法 (每次校准一次), 换算只用32位乘法和移位。
+ */
+
+#define LOG_TAG "calib"
+
+#include "meas_calib.h"
+#include "jig_config.h"
+#include "utility.h"
+#include <elog.h>
+
+/*============================================================================
+ * 内部变量
+ *===========================================================================*/
+
+static MeasCalChannel s_cal[MEASCAL_MAX_CH];
+static uint32_t s_nominal[MEASCAL_MAX_CH];
+static MeasCalPoint s_point[MEASCAL_MAX_CH];
+static uint8_t s_count;
+static uint16_t s_seq;
+
+static MeasCalState s_state = MEASCAL_STATE_IDLE;
+static uint8_t s_req_point;
+static uint8_t s_req_mask;
+static int32_t s_req_ref[MEASCAL_MAX_CH];
+
+/*============================================================================
+ * 内部函数
+ *===========================================================================*/
+
+/**
+ * @brief 四舍五入的整数除法
+ */
+static int64_t div_round(int64_t n, int64_t d) {
+  if (d < 0) {
+    n = -n;
+    d = -d;
+  }
+  return (n >= 0 ? n + d / 2 : n - d / 2) / d;
+}
+
+/**
+ * @brief 检查一个通道的校准值 (增益为0表示未校准, 不检查)
+ */
+static MeasCalResult check_channel(uint8_t ch, const MeasCalChannel *c) {
+  uint32_t nom = s_nominal[ch];
+
+  if (c->gain == 0) {
+    return MEASCAL_OK;
+  }
+  if (c->gain >= (1UL << 20)) {
+    return MEASCAL_ERR_GAIN;
+  }
+  if (nom != 0 && (c->gain > nom + (nom >> MEASCAL_GAIN_TOL_SHIFT) ||
+                   c->gain < nom - (nom >> MEASCAL_GAIN_TOL_SHIFT))) {
+    return MEASCAL_ERR_GAIN;
+  }
+  if (c->offset > MEASCAL_OFFSET_MAX || c->offset < -MEASCAL_OFFSET_MAX) {
+    return MEASCAL_ERR_OFFSET;
+  }
+  return MEASCAL_OK;
+}
+
+/**
+ * @brief 由采样点求校准值
+ */
+static MeasCalResult fit(const MeasCalPoint *p, MeasCalChannel *c) {
+  int64_t gain;
+  int64_t offset;
+
+  if ((p->mask & 0x01) == 0) {
+    return MEASCAL_ERR_POINT;
+  }
+  if (p->mask & 0x02) {
+    /* 两点: 过两点的直线 */
+    int64_t dr = (int64_t)p->raw[1] - p->raw[0];
+    if (dr < ((int64_t)MEASCAL_MIN_SPAN << MEASCAL_RAW_SHIFT) &&
+        dr > -((int64_t)MEASCAL_MIN_SPAN << MEASCAL_RAW_SHIFT)) {
+      return MEASCAL_ERR_SPAN;
+    }
+    gain = div_round(((int64_t)p->ref[1] - p->ref[0])
+                         << (MEASCAL_GAIN_SHIFT + MEASCAL_RAW_SHIFT),
+                     dr);
+    offset = p->ref[0] -
+             div_round((int64_t)p->raw[0] * gain,
+                       1LL << (MEASCAL_GAIN_SHIFT + MEASCAL_RAW_SHIFT));
+  } else {
+    /* 一点: 过零点, 只求增益 */
+    if (p->raw[0] < ((int32_t)MEASCAL_MIN_SPAN << MEASCAL_RAW_SHIFT)) {
+      return MEASCAL_ERR_SPAN;
+    }
+    gain = div_round((int64_t)p->ref[0]
+                         << (MEASCAL_GAIN_SHIFT + MEASCAL_RAW_SHIFT),
+                     p->raw[0]);
+    offset = 0;
+  }
+
+  if (gain <= 0 || gain >= (1LL << 20)) {
+    return MEASCAL_ERR_GAIN;
+  }
+  if (offset > MEASCAL_OFFSET_MAX || offset < -MEASCAL_OFFSET_MAX) {
+    return MEASCAL_ERR_OFFSET;
+  }
+  c->gain = (uint32_t)gain;
+  c->offset = (int16_t)offset;
+  return MEASCAL_OK;
+}
+
+/**
+ * @brief 解析校准镜像, cal 为NULL时只校验
+ */
+static MeasCalResult parse(const uint8_t *image, uint16_t len,
+                           MeasCalChannel *cal, uint16_t *seq, uint8_t *bad) {
+  uint8_t count;
+  uint16_t size;
+
+  if (len < MEASCAL_HEAD_SIZE + 4) {
+    return MEASCAL_ERR_SIZE;
+  }
+  if (util_read_le_u16(&image[0]) != MEASCAL_MAGIC) {
+    return MEASCAL_ERR_MAGIC;
+  }
+  if (image[2] != MEASCAL_FORMAT) {
+    return MEASCAL_ERR_FORMAT;
+  }
+  count = image[3];
+  size = MEASCAL_HEAD_SIZE + count * MEASCAL_CH_SIZE;
+  if (count == 0 || count > MEASCAL_MAX_CH || len != size + 4) {
+    return MEASCAL_ERR_SIZE;
+  }
+  if (util_crc32(image, size) != util_read_le_u32(&image[size])) {
+    return MEASCAL_ERR_CRC;
+  }
+
+  for (uint8_t i = 0; i < count; i++) {
+    const uint8_t *p = &image[MEASCAL_HEAD_SIZE + i * MEASCAL_CH_SIZE];
+    MeasCalChannel c;
+    MeasCalResult r;
+
+    c.gain = util_read_le_u32(&p[0]);
+    c.offset = (int16_t)util_read_le_u16(&p[4]);
+    r = check_channel(i, &c);
+    if (r != MEASCAL_OK) {
+      if (bad != NULL) {
+        *bad = i;
+      }
+      return r;
+    }
+    if (cal != NULL) {
+      cal[i] = c;
+    }
+  }
+  if (cal != NULL) {
+    for (uint8_t i = count; i < MEASCAL_MAX_CH; i++) {
+      cal[i].gain = 0;
+      cal[i].offset = 0;
+    }
+    *seq = util_read_le_u16(&image[4]);
+  }
+  return MEASCAL_OK;
+}
+
+static MeasCalResult save(void) {
+  uint8_t image[MEASCAL_IMAGE_MAX_SIZE];
+  uint16_t len = MeasCalib_GetImage(image, sizeof(image));
+
+  return JigConfig_SetBlob(MEASCAL_KEY, image, len) == JIG_CFG_OK
+             ? MEASCAL_OK
+             : MEASCAL_ERR_FLASH;
+}
+
+/*============================================================================
+ * API 实现
+ *===========================================================================*/
+
+void MeasCalib_Init(uint8_t count, const uint32_t *nominal) {
+  uint8_t image[MEASCAL_IMAGE_MAX_SIZE];
+  uint16_t len;
+
+  if (count > MEASCAL_MAX_CH) {
+    count = MEASCAL_MAX_CH;
+  }
+  s_count = count;
+  memset(s_cal, 0, sizeof(s_cal));
+  memset(s_nominal, 0, sizeof(s_nominal));
+  memset(s_point, 0, sizeof(s_point));
+  memcpy(s_nominal, nominal, count * sizeof(uint32_t));
+  s_seq = 0;
+  s_state = MEASCAL_STATE_IDLE;
+
+  len = JigConfig_GetBlob(MEASCAL_KEY, image, sizeof(image));
+  if (len != 0 && parse(image, len, s_cal, &s_seq, NULL) != MEASCAL_OK) {
+    log_w("保存的校准值无效, 使用固定系数");
+    memset(s_cal, 0, sizeof(s_cal));
+    s_seq = 0;
+  }
+  if (MeasCalib_ValidMask() != 0) {
+    log_i("校准#%u, 已校准通道 %02X", s_seq, MeasCalib_ValidMask());
+  }
+}
+
+uint8_t MeasCalib_Count(void) { return s_count; }
+
+bool MeasCalib_Valid(uint8_t ch) {
+  return ch < s_count && s_cal[ch].gain != 0;
+}
+
+const MeasCalChannel *MeasCalib_Get(uint8_t ch) {
+  return &s_cal[ch < MEASCAL_MAX_CH ? ch : 0];
+}
+
+int32_t MeasCalib_Apply(uint8_t ch, int32_t raw) {
+  const MeasCalChannel *c = &s_cal[ch];
+  uint32_t mag = raw < 0 ? (uint32_t)-raw : (uint32_t)raw;
+  int32_t v = (int32_t)((mag * c->gain + (1UL << (MEASCAL_GAIN_SHIFT - 1))) >>
+                        MEASCAL_GAIN_SHIFT);
+
+  return (raw < 0 ? -v : v) + c->offset;
+}
+
+MeasCalResult MeasCalib_Request(uint8_t point, uint8_t mask,
+                                const int32_t *refs, uint8_t count) {
+  if (point >= MEASCAL_POINT_NUM || mask == 0 || count > MEASCAL_MAX_CH ||
+      (mask >> count) != 0 || (mask >> s_count) != 0) {
+    return MEASCAL_ERR_PARAM;
+  }
+  if (s_state != MEASCAL_STATE_IDLE) {
+    return MEASCAL_ERR_BUSY;
+  }
+  s_req_point = point;
+  s_req_mask = mask;
+  memset(s_req_ref, 0, sizeof(s_req_ref));
+  memcpy(s_req_ref, refs, count * sizeof(int32_t));
+  s_state = MEASCAL_STATE_PENDING;
+  return MEASCAL_OK;
+}
+
+bool MeasCalib_TakeRequest(uint8_t *point, uint8_t *mask) {
+  if (s_state != MEASCAL_STATE_PENDING) {
+    return false;
+  }
+  s_state = MEASCAL_STATE_RUNNING;
+  *point = s_req_point;
+  *mask = s_req_mask;
+  return true;
+}
+
+void MeasCalib_Cancel(void) {
+  if (s_state != MEASCAL_STATE_IDLE) {
+    log_w("校准采样取消");
+  }
+  s_state = MEASCAL_STATE_IDLE;
+}
+
+MeasCalState MeasCalib_GetState(void) { return s_state; }
+
+void MeasCalib_SubmitPoint(const int32_t *raw) {
+  uint8_t p = s_req_point;
+
+  s_state = MEASCAL_STATE_IDLE;
+  for (uint8_t i = 0; i < s_count; i++) {
+    if ((s_req_mask & (1U << i)) == 0) {
+      continue;
+    }
+    s_point[i].raw[p] = raw[i];
+    s_point[i].ref[p] = s_req_ref[i];
+    s_point[i].mask |= 1U << p;
+    log_i("校准点%d 通道%d: 原始值%ld/16 参考值%ld", p, i, (long)raw[i],
+          (long)s_req_ref[i]);
+  }
+}
+
+const MeasCalPoint *MeasCalib_GetPoint(uint8_t ch) {
+  return &s_point[ch < MEASCAL_MAX_CH ? ch : 0];
+}
+
+MeasCalResult MeasCalib_Commit(uint8_t mask, uint8_t *bad) {
+  MeasCalChannel cal[MEASCAL_MAX_CH];
+
+  if (mask == 0 || (mask >> s_count) != 0) {
+    return MEASCAL_ERR_PARAM;
+  }
+  if (s_state != MEASCAL_STATE_IDLE) {
+    return MEASCAL_ERR_BUSY;
+  }
+
+  memcpy(cal, s_cal, sizeof(cal));
+  for (uint8_t i = 0; i < s_count; i++) {
+    MeasCalResult r;
+
+    if ((mask & (1U << i)) == 0) {
+      continue;
+    }
+    r = fit(&s_point[i], &cal[i]);
+    if (r == MEASCAL_OK) {
+      r = check_channel(i, &cal[i]);
+    }
+    if (r != MEASCAL_OK) {
+      log_w("通道%d 校准失败: %d", i, r);
+      if (bad != NULL) {
+        *bad = i;
+      }
+      return r;
+    }
+  }
+
+  memcpy(s_cal, cal, sizeof(s_cal));
+  for (uint8_t i = 0; i < s_count; i++) {
+    if (mask & (1U << i)) {
+      memset(&s_point[i], 0, sizeof(s_point[i]));
+      log_i("通道%d: 增益%lu/16384 偏移%d", i, (unsigned long)s_cal[i].gain,
+            s_cal[i].offset);
+    }
+  }
+  s_seq++;
+  log_i("校准#%u 生效, 已校准通道 %02X", s_seq, MeasCalib_ValidMask());
+  return save();
+}
+
+MeasCalResult MeasCalib_SetImage(const uint8_t *image, uint16_t len,
+                                 uint8_t *bad) {
+  MeasCalResult result;
+
+  if (s_state != MEASCAL_STATE_IDLE) {
+    return MEASCAL_ERR_BUSY;
+  }
+  if (len == 0) {
+    memset(s_cal, 0, sizeof(s_cal));
+    log_i("删除校准值, 恢复固定系数");
+    return JigConfig_SetBlob(MEASCAL_KEY, NULL, 0) == JIG_CFG_OK
+               ? MEASCAL_OK
+               : MEASCAL_ERR_FLASH;
+  }
+
+  result = parse(image, len, NULL, NULL, bad);
+  if (result != MEASCAL_OK) {
+    log_w("校准镜像无效: %d", result);
+    return result;
+  }
+  parse(image, len, s_cal, &s_seq, NULL);
+  log_i("下载校准#%u, 已校准通道 %02X", s_seq, MeasCalib_ValidMask());
+  return JigConfig_SetBlob(MEASCAL_KEY, image, len) == JIG_CFG_OK
+             ? MEASCAL_OK
+             : MEASCAL_ERR_FLASH;
+}
+
+uint16_t MeasCalib_GetImage(uint8_t *buf, uint16_t size) {
+  uint16_t len = MEASCAL_HEAD_SIZE + s_count * MEASCAL_CH_SIZE;
+
+  if (size < len + 4) {
+    return 0;
+  }
+  util_write_le_u16(&buf[0], MEASCAL_MAGIC);
+  buf[2] = MEASCAL_FORMAT;
+  buf[3] = s_count;
+  util_write_le_u16(&buf[4], s_seq);
+  for (uint8_t i = 0; i < s_count; i++) {
+    uint8_t *p = &buf[MEASCAL_HEAD_SIZE + i * MEASCAL_CH_SIZE];
+    util_write_le_u32(&p[0], s_cal[i].gain);
+    util_write_le_u16(&p[4], (uint16_t)s_cal[i].offset);
+  }
+  util_write_le_u32(&buf[len], util_crc32(buf, len));
+  return len + 4;
+}
+
+uint8_t MeasCalib_ValidMask(void) {
+  uint8_t mask = 0;
+
+  for (uint8_t i = 0; i < s_count; i++) {
+    if (s_cal[i].gain != 0) {
+      mask |= 1U << i;
+    }
+  }
+  return mask;
+}
+
+uint16_t MeasCalib_Seq(void) { return s_seq; }
+
+void MeasCalib_Print(void) {
+  log_i("校准#%u, %d通道, 已校准 %02X", s_seq, s_count,
+        MeasCalib_ValidMask());
+  for (uint8_t i = 0; i < s_count; i++) {
+    log_i("  通道%d: 增益%lu/16384 (标称%lu) 偏移%d, 采样点 %02X", i,
+          (unsigned long)s_cal[i].gain, (unsigned long)s_nominal[i],
+          s_cal[i].offset, s_point[i].mask);
+  }
+}
@@ -0,0 +1,242 @@
+/**
+ * @file meas_calib.h
+ * @brief 测量通道两点校准: 增益/偏移 (定点), 带CRC保存
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * @section intro 简介
+ * 电压通道原先按固定分压系数 (JIG_CFG_ADC_SCALE, 全部通道相同) 换算,
+ * INA219 使用固定的校准寄存器值 (JIG_CFG_INA219_CAL), 分压电阻、VREF1P2
+ * 和分流电阻的板间差异直接变成测量误差。本模块为每个通道保存一组校准值:
+ *   输出 = ((原始值 * 增益) >> MEASCAL_GAIN_SHIFT) + 偏移
+ * 只用32位整数乘法和移位, 测量路径中没有除法和浮点。
+ *   - 原始值: 电压通道为分压后引脚 mV (GetSingleChannelVoltage_POLL),
+ *             功耗通道为默认校准寄存器下的 INA219 读数
+ *   - 校准: 在两个已知参考点 (外接校准源/万用表读数由PC下发) 各采样一次,
+ *           由两点直线求增益和偏移; 只有一个点时按过零点只求增益
+ *   - 检查: 两点原始值之差不小于 MEASCAL_MIN_SPAN, 增益与标称值相差不超过
+ *           1/2^MEASCAL_GAIN_TOL_SHIFT, |偏移| <= MEASCAL_OFFSET_MAX
+ *   - 保存: 按镜像格式带CRC32保存在 jig_config 的 KVDB 中, 也可由MES备份/恢复
+ * 未校准的通道 (增益为0) 由调用方按原来的固定系数换算。
+ *
+ * @section format 校准镜像格式 (小端)
+ *   头部 6 字节:
+ *     [0-1] 魔数 0x434D ("MC")
+ *     [2]   格式版本 MEASCAL_FORMAT
+ *     [3]   通道数 N (1..MEASCAL_MAX_CH)
+ *     [4-5] 校准序号 (每次校准加1)
+ *   通道 6 字节 * N:
+ *     [0-3] 增益 (Q14, 0=未校准)
+ *     [4-5] 偏移 (int16, 输出单位)
+ *   CRC32 4 字节: 头部和全部通道的 util_crc32
+ */
+
+#ifndef __MEAS_CALIB_H__
+#define __MEAS_CALIB_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*============================================================================
+ * 配置定义
+ *===========================================================================*/
+
+#define MEASCAL_MAGIC 0x434D /* "MC" */
+#define MEASCAL_FORMAT 1
+
+/** 最多通道数 */
+#define MEASCAL_MAX_CH 8
+
+#define MEASCAL_HEAD_SIZE 6
+#define MEASCAL_CH_SIZE 6
+#define MEASCAL_IMAGE_MAX_SIZE                                                 \
+  (MEASCAL_HEAD_SIZE + MEASCAL_CH_SIZE * MEASCAL_MAX_CH + 4)
+
+/** 增益定点位数 (Q14: 1.0 = 16384), |原始值| * 增益 不超过32位 */
+#define MEASCAL_GAIN_SHIFT 14
+
+/** 采样点原始值保留的小数位 (多次采样之和, 2^n 次平均不丢精度) */
+#define MEASCAL_RAW_SHIFT 4
+
+/** 两点原始值之差的下限 (原始值单位) */
+#define MEASCAL_MIN_SPAN 64
+
+/** 增益允许偏离标称值 1/2^n (n=3: 12.5%) */
+#define MEASCAL_GAIN_TOL_SHIFT 3
+
+/** 偏移上限 (输出单位) */
+#define MEASCAL_OFFSET_MAX 500
+
+/** 采样点数 */
+#define MEASCAL_POINT_NUM 2
+
+/** KVDB 键名 */
+#define MEASCAL_KEY "mcal"
+
+/*============================================================================
+ * 数据结构定义
+ *===========================================================================*/
+
+/**
+ * @brief 一个通道的校准值
+ */
+typedef struct {
+  uint32_t gain; /**< 增益 Q14, 0=未校准 */
+  int16_t offset; /**< 偏移 (输出单位) */
+} MeasCalChannel;
+
+/**
+ * @brief 一个通道的采样点 (只在RAM中, 计算校准值后不再需要)
+ */
+typedef struct {
+  int32_t raw[MEASCAL_POINT_NUM]; /**< 原始值 x2^MEASCAL_RAW_SHIFT */
+  int32_t ref[MEASCAL_POINT_NUM]; /**< 参考值 (输出单位) */
+  uint8_t mask;                   /**< 已采样的点 */
+} MeasCalPoint;
+
+/**
+ * @brief 结果码 (PC协议应答状态)
+ */
+typedef enum {
+  MEASCAL_OK = 0,
+  MEASCAL_ERR_SIZE,   /**< 长度与通道数不符 */
+  MEASCAL_ERR_MAGIC,  /**< 魔数错误 */
+  MEASCAL_ERR_FORMAT, /**< 不支持的格式版本 */
+  MEASCAL_ERR_CRC,    /**< CRC错误 */
+  MEASCAL_ERR_PARAM,  /**< 点号或通道无效 */
+  MEASCAL_ERR_BUSY,   /**< 采样进行中 */
+  MEASCAL_ERR_POINT,  /**< 通道没有采样点 */
+  MEASCAL_ERR_SPAN,   /**< 两点原始值太接近 */
+  MEASCAL_ERR_GAIN,   /**< 增益超出范围 */
+  MEASCAL_ERR_OFFSET, /**< 偏移超出范围 */
+  MEASCAL_ERR_FLASH,  /**< 保存失败 (RAM中已生效, 复位后丢失) */
+} MeasCalResult;
+
+/**
+ * @brief 采样状态
+ */
+typedef enum {
+  MEASCAL_STATE_IDLE = 0, /**< 空闲 */
+  MEASCAL_STATE_PENDING,  /**< 已请求, 等待开始采样 */
+  MEASCAL_STATE_RUNNING,  /**< 采样中 */
+} MeasCalState;
+
+/*============================================================================
+ * API 函数
+ *===========================================================================*/
+
+/**
+ * @brief 初始化: 设置通道数和各通道标称增益, 加载保存的校准值
+ *        (在 JigConfig_Init 之后)
+ * @param count 通道数
+ * @param nominal 各通道标称增益 (Q14), 用于检查校准结果
+ */
+void MeasCalib_Init(uint8_t count, const uint32_t *nominal);
+
+/**
+ * @brief 通道数
+ */
+uint8_t MeasCalib_Count(void);
+
+/**
+ * @brief 通道是否已校准
+ */
+bool MeasCalib_Valid(uint8_t ch);
+
+/**
+ * @brief 通道校准值 (未校准时增益为0)
+ */
+const MeasCalChannel *MeasCalib_Get(uint8_t ch);
+
+/**
+ * @brief 换算: ((raw * 增益) >> MEASCAL_GAIN_SHIFT) + 偏移 (四舍五入)
+ * @note 只对已校准的通道调用
+ */
+int32_t MeasCalib_Apply(uint8_t ch, int32_t raw);
+
+/**
+ * @brief 请求在一个参考点采样 (PC命令), 由采样方在空闲时取走
+ * @param point 点号 (0..MEASCAL_POINT_NUM-1)
+ * @param mask 采样的通道
+ * @param refs 各通道参考值 (下标为通道号, 只用 mask 中的通道)
+ * @param count refs 个数
+ * @return MEASCAL_OK / MEASCAL_ERR_PARAM / MEASCAL_ERR_BUSY
+ */
+MeasCalResult MeasCalib_Request(uint8_t point, uint8_t mask,
+                                const int32_t *refs, uint8_t count);
+
+/**
+ * @brief 采样方取走请求
+ * @return true: 有请求, 状态变为采样中
+ */
+bool MeasCalib_TakeRequest(uint8_t *point, uint8_t *mask);
+
+/**
+ * @brief 采样方放弃本次采样 (如测试开始)
+ */
+void MeasCalib_Cancel(void);
+
+/**
+ * @brief 采样状态
+ */
+MeasCalState MeasCalib_GetState(void);
+
+/**
+ * @brief 提交采样结果
+ * @param raw 各通道原始值 x2^MEASCAL_RAW_SHIFT (下标为通道号, 只用请求中的通道)
+ */
+void MeasCalib_SubmitPoint(const int32_t *raw);
+
+/**
+ * @brief 采样点
+ */
+const MeasCalPoint *MeasCalib_GetPoint(uint8_t ch);
+
+/**
+ * @brief 由采样点计算校准值并保存, 只要有一个通道不合格就全部不生效
+ * @param mask 计算的通道
+ * @param bad 输出出错的通道 (可为NULL)
+ * @return 结果码
+ */
+MeasCalResult MeasCalib_Commit(uint8_t mask, uint8_t *bad);
+
+/**
+ * @brief 下载校准镜像 (MES恢复备份): 校验后保存
+ * @param image 镜像, len=0 表示删除全部校准值 (恢复固定系数)
+ * @param len 镜像长度
+ * @param bad 输出出错的通道 (可为NULL)
+ * @return 结果码
+ */
+MeasCalResult MeasCalib_SetImage(const uint8_t *image, uint16_t len,
+                                 uint8_t *bad);
+
+/**
+ * @brief 编码当前校准值
+ * @return 镜像长度, 0: 缓冲区不足
+ */
+uint16_t MeasCalib_GetImage(uint8_t *buf, uint16_t size);
+
+/**
+ * @brief 已校准的通道掩码
+ */
+uint8_t MeasCalib_ValidMask(void);
+
+/**
+ * @brief 校准序号 (每次校准加1)
+ */
+uint16_t MeasCalib_Seq(void);
+
+/**
+ * @brief 打印校准值到日志
+ */
+void MeasCalib_Print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MEAS_CALIB_H__ */
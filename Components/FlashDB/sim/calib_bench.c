@@ -0,0 +1,136 @@
+/**
+ * @file calib_bench.c
+ * @brief 测量校准 (meas_calib.c) 计算/换算/保存 检查 (本机运行)
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * 由 VscodeGcc/scripts/calib_sim.py 与 meas_calib.c、jig_config.c、
+ * FlashDB、FAL、移植层和 RAM 模拟 NOR 一起编译, 校准值真实保存在
+ * KVDB 中。采样原始值由脚本中的板间差异模型给出。
+ *
+ * 从标准输入逐行读取命令, 每条命令输出一行:
+ *   init <标称增益>...     -> init 已校准 序号          (设置通道数和标称增益)
+ *   req <点> <掩码> <参考值>... -> req 结果码
+ *   point <原始值x16>...   -> point 状态               (取走请求并提交)
+ *   commit <掩码>          -> commit 结果码 出错通道
+ *   apply <通道> <起> <止> -> apply 换算值...          (原始值 起..止)
+ *   image                  -> image 镜像hex
+ *   load <镜像hex|->       -> load 结果码 出错通道     (- 为删除)
+ *   reboot                 -> reboot 已校准 序号
+ */
+
+#include "flash_sim.h"
+#include "jig_config.h"
+#include "meas_calib.h"
+#include <fal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint16_t parse_hex(const char *text, uint8_t *buf, uint16_t size) {
+  uint16_t n = 0;
+  unsigned int v;
+
+  while (n < size && sscanf(text, "%2x", &v) == 1) {
+    buf[n++] = (uint8_t)v;
+    text += 2;
+  }
+  return n;
+}
+
+/**
+ * @brief 读取一行中的整数, 返回个数
+ */
+static uint8_t parse_ints(char *p, int32_t *out, uint8_t max) {
+  uint8_t n = 0;
+  char *end;
+
+  while (n < max) {
+    long v = strtol(p, &end, 10);
+    if (end == p) {
+      break;
+    }
+    out[n++] = (int32_t)v;
+    p = end;
+  }
+  return n;
+}
+
+int main(void) {
+  static char line[1024];
+  static uint8_t image[256];
+  uint32_t nominal[MEASCAL_MAX_CH] = {0};
+  uint8_t count = 0;
+  char cmd[16];
+
+  flash_sim_reset();
+  fal_init();
+  JigConfig_Init();
+
+  while (fgets(line, sizeof(line), stdin) != NULL) {
+    int32_t v[MEASCAL_MAX_CH + 2];
+    uint8_t bad = 0xFF;
+    char *p = line;
+    int n = 0;
+
+    if (sscanf(line, "%15s%n", cmd, &n) < 1) {
+      continue;
+    }
+    p += n;
+    if (strcmp(cmd, "init") == 0 || strcmp(cmd, "reboot") == 0) {
+      if (cmd[0] == 'i') {
+        count = parse_ints(p, v, MEASCAL_MAX_CH);
+        for (uint8_t i = 0; i < count; i++) {
+          nominal[i] = (uint32_t)v[i];
+        }
+      }
+      MeasCalib_Init(count, nominal);
+      printf("%s %u %u\n", cmd, MeasCalib_ValidMask(), MeasCalib_Seq());
+    } else if (strcmp(cmd, "req") == 0) {
+      uint8_t m = parse_ints(p, v, MEASCAL_MAX_CH + 2);
+      printf("req %d\n", m < 2 ? MEASCAL_ERR_PARAM
+                                 : MeasCalib_Request((uint8_t)v[0],
+                                                     (uint8_t)v[1], &v[2],
+                                                     m - 2));
+    } else if (strcmp(cmd, "point") == 0) {
+      uint8_t point, mask;
+      memset(v, 0, sizeof(v));
+      parse_ints(p, v, MEASCAL_MAX_CH);
+      if (MeasCalib_TakeRequest(&point, &mask)) {
+        MeasCalib_SubmitPoint(v);
+        printf("point 0\n");
+      } else {
+        printf("point 1\n");
+      }
+    } else if (strcmp(cmd, "commit") == 0) {
+      MeasCalResult r;
+      parse_ints(p, v, 1);
+      r = MeasCalib_Commit((uint8_t)v[0], &bad);
+      printf("commit %d %u\n", r, bad);
+    } else if (strcmp(cmd, "apply") == 0) {
+      parse_ints(p, v, 3);
+      printf("apply");
+      for (int32_t raw = v[1]; raw <= v[2]; raw++) {
+        printf(" %ld", (long)MeasCalib_Apply((uint8_t)v[0], raw));
+      }
+      printf("\n");
+    } else if (strcmp(cmd, "image") == 0) {
+      uint16_t len = MeasCalib_GetImage(image, sizeof(image));
+      printf("image ");
+      for (uint16_t i = 0; i < len; i++) {
+        printf("%02x", image[i]);
+      }
+      printf("\n");
+    } else if (strcmp(cmd, "load") == 0) {
+      char arg[600] = "";
+      uint16_t len;
+      MeasCalResult r;
+      sscanf(p, "%599s", arg);
+      len = strcmp(arg, "-") == 0 ? 0 : parse_hex(arg, image, sizeof(image));
+      r = MeasCalib_SetImage(image, len, &bad);
+      printf("load %d %u\n", r, bad);
+    }
+    fflush(stdout);
+  }
+  return 0;
+}
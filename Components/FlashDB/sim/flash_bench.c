@@ -0,0 +1,186 @@
+/**
+ * @file flash_bench.c
+ * @brief FlashDB 负载在模拟 NOR 上的基准 (本机运行)
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * 由 VscodeGcc/scripts/flash_bench.py 与 FlashDB、FAL、移植层和 jig_config.c
+ * 一起编译, 每个负载输出一行:
+ *   wl 名称 操作数 周期 编程次数 编程字 跳过字 擦除 最大扇区擦除
+ *      缓存命中 缓存未命中 重复编程
+ * 最后一行为 JigConfig_Benchmark 的结果 (时间按模拟器周期换算):
+ *   cfg 缓存读取ns/次 KVDB读取us/次
+ */
+
+#include "flash_sim.h"
+#include "jig_config.h"
+#include <fal.h>
+#include <flashdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 与 jig_config.c 的配置项相同的键 */
+static const char *const s_keys[] = {"station", "debug",   "pt_mode",
+                                     "vcc_min", "vcc_max", "adc_scale",
+                                     "ina_cal", "bus_slot"};
+#define KEY_NUM (sizeof(s_keys) / sizeof(s_keys[0]))
+
+static struct fdb_kvdb s_kvdb;
+static fal_fm33_stats_t s_port_start;
+
+static void report(const char *name, uint32_t ops) {
+  flash_sim_stats_t sim;
+  fal_fm33_stats_t port;
+  uint32_t max_erase = 0;
+
+  flash_sim_get_stats(&sim);
+  fal_flash_fm33lg04_get_stats(&port);
+  port.words_skipped -= s_port_start.words_skipped;
+  port.rc_hits -= s_port_start.rc_hits;
+  port.rc_misses -= s_port_start.rc_misses;
+  for (uint32_t i = 0; i < FLASH_SIM_SECTORS; i++) {
+    if (sim.sector_erases[i] > max_erase) {
+      max_erase = sim.sector_erases[i];
+    }
+  }
+  printf("wl %s %u %llu %u %u %u %u %u %u %u %u\n", name, ops,
+         (unsigned long long)sim.cycles, sim.sessions, sim.words,
+         port.words_skipped, sim.erases, max_erase, port.rc_hits,
+         port.rc_misses, sim.double_programs);
+}
+
+static void begin(void) {
+  flash_sim_clear_stats();
+  /* 移植层统计只增不减, 输出本负载的差值 */
+  fal_flash_fm33lg04_get_stats(&s_port_start);
+}
+
+static int kv_open(void) {
+  return fdb_kvdb_init(&s_kvdb, "jig_cfg", "kvdb", NULL, NULL) == FDB_NO_ERR
+             ? 0
+             : -1;
+}
+
+/** 配置写入: 轮流修改各键 (jig_config 的 kv_write) */
+static int wl_kv_set(uint32_t loops) {
+  struct fdb_blob blob;
+
+  begin();
+  for (uint32_t i = 0; i < loops; i++) {
+    int32_t value = (int32_t)(i * 7 + 1);
+    if (fdb_kv_set_blob(&s_kvdb, s_keys[i % KEY_NUM],
+                        fdb_blob_make(&blob, &value, sizeof(value))) !=
+        FDB_NO_ERR) {
+      return -1;
+    }
+    fal_flash_fm33lg04_sync();
+  }
+  report("kv_set", loops);
+  return 0;
+}
+
+/** 配置读取 (上电加载 / 查询命令) */
+static int wl_kv_get(uint32_t loops) {
+  struct fdb_blob blob;
+
+  begin();
+  for (uint32_t i = 0; i < loops; i++) {
+    int32_t value = 0;
+    fdb_kv_get_blob(&s_kvdb, s_keys[i % KEY_NUM],
+                    fdb_blob_make(&blob, &value, sizeof(value)));
+    if (blob.saved.len != sizeof(value)) {
+      return -1;
+    }
+  }
+  report("kv_get", loops);
+  return 0;
+}
+
+/** 上电初始化: 扫描全部扇区 */
+static int wl_kv_boot(uint32_t loops) {
+  begin();
+  for (uint32_t i = 0; i < loops; i++) {
+    fdb_kvdb_deinit(&s_kvdb);
+    if (kv_open() != 0) {
+      return -1;
+    }
+  }
+  report("kv_boot", loops);
+  return 0;
+}
+
+/** 测试统计汇总: 擦除后写入 64 字节并读回校验 (test_stats.c) */
+static int wl_stats(uint32_t loops) {
+  const struct fal_partition *part = fal_partition_find("test_stats");
+  uint8_t buf[64];
+  uint8_t verify[64];
+
+  if (part == NULL) {
+    return -1;
+  }
+  begin();
+  for (uint32_t i = 0; i < loops; i++) {
+    memset(buf, (int)(i & 0x7F), sizeof(buf));
+    buf[0] = (uint8_t)i;
+    if (fal_partition_erase(part, 0, 2048) < 0 ||
+        fal_partition_write(part, 0, buf, sizeof(buf)) < 0) {
+      return -1;
+    }
+    fal_flash_fm33lg04_sync();
+    fal_partition_read(part, 0, verify, sizeof(verify));
+    if (memcmp(buf, verify, sizeof(buf)) != 0) {
+      return -1;
+    }
+  }
+  report("stats", loops);
+  return 0;
+}
+
+/** 模拟器周期换算的时间, 作为 jig_config 的时间源 */
+static uint32_t sim_us(void) {
+  flash_sim_stats_t sim;
+  flash_sim_get_stats(&sim);
+  return (uint32_t)(sim.cycles * 1000000ULL / FLASH_SIM_CPU_HZ);
+}
+
+/**
+ * 配置读取: JigConfig_Benchmark (每次缓存读和 KVDB 直接读各100次)
+ * 模型只计 Flash 访问周期, 缓存读取不访问 Flash, 计为0
+ */
+static int wl_cfg(uint32_t loops) {
+  const JigConfigStats *stats;
+
+  fdb_kvdb_deinit(&s_kvdb);
+  JigConfig_SetTimeSource(sim_us);
+  if (!JigConfig_Init()) {
+    return -1;
+  }
+  begin();
+  for (uint32_t i = 0; i < loops; i++) {
+    JigConfig_Benchmark();
+  }
+  report("cfg_get", loops * 100);
+  stats = JigConfig_GetStats();
+  printf("cfg %u %u\n", stats->cache_read_ns, stats->kv_read_us);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  uint32_t scale = argc > 1 ? (uint32_t)atoi(argv[1]) : 1;
+
+  flash_sim_reset();
+  fal_init();
+  if (kv_open() != 0) {
+    fprintf(stderr, "kvdb init failed\n");
+    return 1;
+  }
+
+  if (wl_kv_set(200 * scale) != 0 || wl_kv_get(1000 * scale) != 0 ||
+      wl_kv_boot(20 * scale) != 0 || wl_stats(50 * scale) != 0 ||
+      wl_cfg(5 * scale) != 0) {
+    fprintf(stderr, "workload failed\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file flash_sim.c
+ * @brief RAM 模拟 FM33LG04x 片上 NOR Flash (仅本机基准测试)
+ * @version 1.0.0
+ * @date 2026-10-16
+ */
+
+#include "flash_sim.h"
+#include <string.h>
+
+static uint8_t s_flash[FLASH_SIM_SIZE];
+static flash_sim_stats_t s_stats;
+
+void flash_sim_reset(void) {
+  memset(s_flash, 0xFF, sizeof(s_flash));
+  flash_sim_clear_stats();
+}
+
+void flash_sim_clear_stats(void) { memset(&s_stats, 0, sizeof(s_stats)); }
+
+void flash_sim_get_stats(flash_sim_stats_t *stats) { *stats = s_stats; }
+
+void flash_sim_charge(uint32_t cycles) { s_stats.cycles += cycles; }
+
+void flash_sim_read(uint32_t addr, uint8_t *buf, size_t size) {
+  if (addr + size > FLASH_SIM_SIZE) {
+    memset(buf, 0xFF, size);
+    return;
+  }
+  memcpy(buf, &s_flash[addr], size);
+  s_stats.reads++;
+  s_stats.read_bytes += size;
+  s_stats.cycles += FLASH_SIM_COST_READ_CALL +
+                    (size + 3) / 4 * FLASH_SIM_COST_READ_WORD;
+}
+
+uint32_t flash_sim_read_word(uint32_t addr) {
+  uint32_t word = 0xFFFFFFFF;
+
+  if (addr + 4 <= FLASH_SIM_SIZE) {
+    memcpy(&word, &s_flash[addr], 4);
+  }
+  s_stats.cycles += FLASH_SIM_COST_READ_WORD;
+  return word;
+}
+
+int flash_sim_program(uint32_t addr, const uint32_t *words, size_t count) {
+  if ((addr % 4) != 0 || addr + count * 4 > FLASH_SIM_SIZE) {
+    return -1;
+  }
+  s_stats.sessions++;
+  s_stats.cycles += FLASH_SIM_COST_PROG_SESSION;
+  for (size_t i = 0; i < count; i++, addr += 4) {
+    uint32_t cur;
+    memcpy(&cur, &s_flash[addr], 4);
+    if (cur != 0xFFFFFFFF) {
+      s_stats.double_programs++;
+    }
+    cur &= words[i];
+    memcpy(&s_flash[addr], &cur, 4);
+    s_stats.words++;
+    s_stats.cycles += FLASH_SIM_COST_PROG_WORD;
+  }
+  return 0;
+}
+
+int flash_sim_erase(uint32_t addr) {
+  uint32_t sector = addr / FLASH_SIM_SECTOR_SIZE;
+
+  if (sector >= FLASH_SIM_SECTORS) {
+    return -1;
+  }
+  memset(&s_flash[sector * FLASH_SIM_SECTOR_SIZE], 0xFF, FLASH_SIM_SECTOR_SIZE);
+  s_stats.erases++;
+  s_stats.sector_erases[sector]++;
+  s_stats.cycles += FLASH_SIM_COST_ERASE;
+  return 0;
+}
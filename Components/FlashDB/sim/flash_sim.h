@@ -0,0 +1,92 @@
+/**
+ * @file flash_sim.h
+ * @brief RAM 模拟 FM33LG04x 片上 NOR Flash (仅本机基准测试)
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * 定义 FAL_FLASH_SIM 编译 fal_flash_fm33lg04_port.c 时, 底层读/编程/擦除
+ * 调用这里的函数。按周期模型累计耗时, 统计编程次数和每扇区擦除次数。
+ * 周期参数可用 -D 覆盖; 默认值按 32MHz、Flash 1个等待周期估算。
+ */
+
+#ifndef __FLASH_SIM_H__
+#define __FLASH_SIM_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FLASH_SIM_SIZE (256 * 1024)
+#define FLASH_SIM_SECTOR_SIZE (2 * 1024)
+#define FLASH_SIM_SECTORS (FLASH_SIM_SIZE / FLASH_SIM_SECTOR_SIZE)
+
+/*============================================================================
+ * 周期模型 (CPU 32MHz)
+ *===========================================================================*/
+
+#ifndef FLASH_SIM_CPU_HZ
+#define FLASH_SIM_CPU_HZ 32000000UL
+#endif
+/** 一次读调用的固定开销 (FAL 调用链 + memcpy 准备) */
+#ifndef FLASH_SIM_COST_READ_CALL
+#define FLASH_SIM_COST_READ_CALL 30
+#endif
+/** 每读一个字 (1个等待周期) */
+#ifndef FLASH_SIM_COST_READ_WORD
+#define FLASH_SIM_COST_READ_WORD 2
+#endif
+/** 一次编程的固定开销: 时钟开关、解锁/上锁、清标志 */
+#ifndef FLASH_SIM_COST_PROG_SESSION
+#define FLASH_SIM_COST_PROG_SESSION 80
+#endif
+/** 每编程一个字 (写入 + 等待完成) */
+#ifndef FLASH_SIM_COST_PROG_WORD
+#define FLASH_SIM_COST_PROG_WORD 960
+#endif
+/** 扇区擦除 */
+#ifndef FLASH_SIM_COST_ERASE
+#define FLASH_SIM_COST_ERASE 96000
+#endif
+
+/** 读缓存查找 (移植层调用 FAL_SIM_CHARGE 计入) */
+#define FAL_SIM_COST_RC_LOOKUP 12
+#define FAL_SIM_CHARGE(cycles) flash_sim_charge(cycles)
+
+/*============================================================================
+ * 统计
+ *===========================================================================*/
+
+typedef struct {
+  uint64_t cycles;           /**< 模型累计周期 */
+  uint32_t reads;            /**< 读调用次数 */
+  uint32_t read_bytes;       /**< 读取字节 */
+  uint32_t sessions;         /**< 编程次数 */
+  uint32_t words;            /**< 编程字数 */
+  uint32_t double_programs;  /**< 对未擦除字再次编程 */
+  uint32_t erases;           /**< 擦除次数 */
+  uint32_t sector_erases[FLASH_SIM_SECTORS]; /**< 每扇区擦除次数 (磨损) */
+} flash_sim_stats_t;
+
+/** 整片置为擦除状态并清零统计 */
+void flash_sim_reset(void);
+/** 清零统计, 保留Flash内容 */
+void flash_sim_clear_stats(void);
+void flash_sim_get_stats(flash_sim_stats_t *stats);
+
+void flash_sim_read(uint32_t addr, uint8_t *buf, size_t size);
+/** 按地址直接读一个字 (移植层编程前检查) */
+uint32_t flash_sim_read_word(uint32_t addr);
+/** 一次编程连续 count 个字, NOR 语义 (只能 1->0) */
+int flash_sim_program(uint32_t addr, const uint32_t *words, size_t count);
+/** 擦除 addr 所在扇区 */
+int flash_sim_erase(uint32_t addr);
+void flash_sim_charge(uint32_t cycles);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FLASH_SIM_H__ */
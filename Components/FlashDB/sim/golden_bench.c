@@ -0,0 +1,109 @@
+/**
+ * @file golden_bench.c
+ * @brief 金样检测 (golden_sample.c) 判定/漂移/保存 检查 (本机运行)
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * 由 VscodeGcc/scripts/golden_sim.py 与 golden_sample.c、jig_config.c、
+ * FlashDB、FAL、移植层和 RAM 模拟 NOR 一起编译, 参考和趋势真实保存在
+ * KVDB 中。测量值由脚本中的传感器漂移模型给出。
+ *
+ * 从标准输入逐行读取命令, 每条命令输出一行:
+ *   ref <镜像hex|->     -> ref 结果码                         (- 为删除参考)
+ *   run <v0> <v1> ...   -> run 结果码 超差 需校准 标志 漂移估计x16...
+ *   clear               -> clear 结果码                       (清除标记)
+ *   reboot              -> reboot 需校准 检测次数 基线后次数
+ *   trend               -> trend 条数 {序号:超差:标志:偏差,...}...
+ */
+
+#include "flash_sim.h"
+#include "golden_sample.h"
+#include "jig_config.h"
+#include <fal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint16_t parse_hex(const char *text, uint8_t *buf, uint16_t size) {
+  uint16_t n = 0;
+  unsigned int v;
+
+  while (n < size && sscanf(text, "%2x", &v) == 1) {
+    buf[n++] = (uint8_t)v;
+    text += 2;
+  }
+  return n;
+}
+
+int main(void) {
+  static char line[1024];
+  static uint8_t image[256];
+  char cmd[16];
+
+  flash_sim_reset();
+  fal_init();
+  JigConfig_Init();
+  GoldenSample_Init();
+
+  while (fgets(line, sizeof(line), stdin) != NULL) {
+    char *p = line;
+    int n = 0;
+
+    if (sscanf(line, "%15s%n", cmd, &n) < 1) {
+      continue;
+    }
+    p += n;
+    if (strcmp(cmd, "ref") == 0) {
+      char arg[600] = "";
+      uint16_t len;
+      sscanf(p, "%599s", arg);
+      len = strcmp(arg, "-") == 0 ? 0 : parse_hex(arg, image, sizeof(image));
+      printf("ref %d\n", GoldenSample_SetRef(image, len));
+    } else if (strcmp(cmd, "run") == 0) {
+      int32_t values[GOLDEN_MAX_CH];
+      uint8_t count = 0;
+      GoldenRecord rec = {0};
+      GoldenResult r;
+      char *end;
+
+      while (count < GOLDEN_MAX_CH) {
+        long v = strtol(p, &end, 10);
+        if (end == p) {
+          break;
+        }
+        values[count++] = (int32_t)v;
+        p = end;
+      }
+      GoldenSample_Request();
+      GoldenSample_TakeRequest();
+      r = GoldenSample_Submit(values, count, &rec);
+      printf("run %d %u %u %u", r, rec.fail, GoldenSample_RecalMask(),
+             rec.flags);
+      for (uint8_t i = 0; i < GoldenSample_Ref()->count; i++) {
+        printf(" %ld", (long)GoldenSample_GetTrend()->ewma[i]);
+      }
+      printf("\n");
+    } else if (strcmp(cmd, "clear") == 0) {
+      printf("clear %d\n", GoldenSample_ClearRecal());
+    } else if (strcmp(cmd, "reboot") == 0) {
+      GoldenSample_Init();
+      printf("reboot %u %u %u\n", GoldenSample_RecalMask(),
+             GoldenSample_GetTrend()->runs, GoldenSample_GetTrend()->since);
+    } else if (strcmp(cmd, "trend") == 0) {
+      const GoldenTrend *t = GoldenSample_GetTrend();
+      printf("trend %u", t->count);
+      for (uint8_t i = 0; i < t->count; i++) {
+        const GoldenRecord *r =
+            &t->rec[(t->head + GOLDEN_TREND_NUM - t->count + i) %
+                    GOLDEN_TREND_NUM];
+        printf(" %u:%u:%u:", r->run, r->fail, r->flags);
+        for (uint8_t c = 0; c < GoldenSample_Ref()->count; c++) {
+          printf(c == 0 ? "%d" : ",%d", r->dev[c]);
+        }
+      }
+      printf("\n");
+    }
+    fflush(stdout);
+  }
+  return 0;
+}
@@ -0,0 +1,127 @@
+/**
+ * @file test_plan_bench.c
+ * @brief 测试计划 (test_plan.c) 下载/校验/切换 检查 (本机运行)
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * 由 VscodeGcc/scripts/test_plan.py check 与 test_plan.c、jig_config.c、
+ * FlashDB、FAL、移植层和 RAM 模拟 NOR 一起编译, 计划真实保存在 KVDB 中。
+ * 步骤检查和内置计划与 Src/Test_List.c 相同 (步骤号 1..7, 切换供电不用
+ * 间隔, 其他步骤间隔不小于10ms; 内置计划限值取自 jig_config 默认值)。
+ *
+ * 从标准输入逐行读取命令, 每条命令输出一行:
+ *   load <镜像hex|->   -> load 结果码 出错步骤 计划状态      (- 为删除计划)
+ *   begin              -> begin 版本 CRC 步骤数 超时ms       (测试开始)
+ *   read               -> read 计划状态 镜像hex              (0xDC 读取)
+ *   reboot             -> reboot 计划状态                    (重新加载)
+ *   writes             -> writes KVDB写入次数
+ */
+
+#include "flash_sim.h"
+#include "jig_config.h"
+#include "test_plan.h"
+#include <fal.h>
+#include <stdio.h>
+#include <string.h>
+
+#define STEP_NUM 7
+#define STEP_SWITCH 4
+#define STEP_BIT(i) (1U << (i))
+
+static bool step_check(const TestPlanStep *step) {
+  if (step->id < 1 || step->id > STEP_NUM) {
+    return false;
+  }
+  return step->id == STEP_SWITCH || step->interval_ms >= 10;
+}
+
+static void set_step(TestPlanStep *s, uint8_t id, uint16_t after,
+                     uint16_t interval, int32_t lo, int32_t hi, int32_t aux) {
+  s->id = id;
+  s->tries = 0;
+  s->after = after;
+  s->interval_ms = interval;
+  s->timeout_ms = 0;
+  s->lo = lo;
+  s->hi = hi;
+  s->aux = aux;
+}
+
+static void builtin(TestPlan *plan) {
+  plan->version = 0;
+  plan->product = 0;
+  plan->crc = 0;
+  plan->timeout_ms = JigConfig_Get(JIG_CFG_TEST_TIMEOUT_MS);
+  plan->count = STEP_NUM;
+  set_step(&plan->steps[0], 1, 0, 1000, JigConfig_Get(JIG_CFG_VCC_MIN_MV),
+           JigConfig_Get(JIG_CFG_VCC_MAX_MV), 0);
+  set_step(&plan->steps[1], 2, STEP_BIT(0), 1000,
+           JigConfig_Get(JIG_CFG_MAIN_MIN_MV),
+           JigConfig_Get(JIG_CFG_MAIN_MAX_MV), 0);
+  set_step(&plan->steps[2], 3, STEP_BIT(1), 1000,
+           JigConfig_Get(JIG_CFG_VDD_MIN_MV), INT32_MAX,
+           JigConfig_Get(JIG_CFG_VDD_MAIN_MIN_MV));
+  set_step(&plan->steps[3], 4, STEP_BIT(0), 0, INT32_MIN, INT32_MAX, 0);
+  set_step(&plan->steps[4], 5, STEP_BIT(3), 3000, INT32_MIN, INT32_MAX, 0);
+  set_step(&plan->steps[5], 6, STEP_BIT(4), 3000, INT32_MIN, INT32_MAX, 0);
+  set_step(&plan->steps[6], 7, STEP_BIT(5), 1000, INT32_MIN, INT32_MAX, 0);
+}
+
+static uint16_t parse_hex(const char *text, uint8_t *buf, uint16_t size) {
+  uint16_t n = 0;
+  unsigned int v;
+
+  while (n < size && sscanf(text, "%2x", &v) == 1) {
+    buf[n++] = (uint8_t)v;
+    text += 2;
+  }
+  return n;
+}
+
+static void print_hex(const uint8_t *buf, uint16_t len) {
+  for (uint16_t i = 0; i < len; i++) {
+    printf("%02x", buf[i]);
+  }
+}
+
+int main(void) {
+  static char line[1024];
+  static uint8_t image[512];
+  char cmd[16];
+  char arg[1000];
+
+  flash_sim_reset();
+  fal_init();
+  JigConfig_Init();
+  TestPlan_Init(step_check, builtin);
+
+  while (fgets(line, sizeof(line), stdin) != NULL) {
+    arg[0] = '\0';
+    if (sscanf(line, "%15s %999s", cmd, arg) < 1) {
+      continue;
+    }
+    if (strcmp(cmd, "load") == 0) {
+      uint8_t bad = 0;
+      uint16_t len = strcmp(arg, "-") == 0 ? 0
+                                           : parse_hex(arg, image, sizeof(image));
+      TestPlanResult r = TestPlan_Load(image, len, &bad);
+      printf("load %d %d %d\n", r, bad, TestPlan_GetState());
+    } else if (strcmp(cmd, "begin") == 0) {
+      const TestPlan *plan = TestPlan_Begin();
+      printf("begin %u %08x %u %u\n", plan->version, plan->crc, plan->count,
+             plan->timeout_ms);
+    } else if (strcmp(cmd, "read") == 0) {
+      uint16_t len = TestPlan_ReadNext(image, sizeof(image));
+      printf("read %d ", TestPlan_GetState());
+      print_hex(image, len);
+      printf("\n");
+    } else if (strcmp(cmd, "reboot") == 0) {
+      TestPlan_Init(step_check, builtin);
+      printf("reboot %d\n", TestPlan_GetState());
+    } else if (strcmp(cmd, "writes") == 0) {
+      printf("writes %u\n", JigConfig_GetStats()->kv_writes);
+    }
+    fflush(stdout);
+  }
+  return 0;
+}
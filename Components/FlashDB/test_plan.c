@@ -0,0 +1,293 @@
+/**
+ * @file test_plan.c
+ * @brief 可下载的测试计划实现
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * 当前计划和挂起的新计划各占一份 TestPlan (约 2 * 208 字节)。
+ * 镜像保存在 jig_config 的 KVDB 中, 只在下载时写入一次。
+ */
+
+#define LOG_TAG "test_plan"
+
+#include "test_plan.h"
+#include "jig_config.h"
+#include "utility.h"
+#include <elog.h>
+
+/*============================================================================
+ * 内部变量
+ *===========================================================================*/
+
+static TestPlanStepCheck s_check = NULL;
+static TestPlanBuiltinFunc s_builtin = NULL;
+
+static TestPlan s_active;        /**< 本次测试使用的计划 */
+static TestPlan s_next;          /**< 挂起的新计划, 无挂起时用作临时区 */
+static bool s_loaded = false;    /**< s_active 为下载的计划 */
+static bool s_pending = false;   /**< 有待生效的新计划 */
+static bool s_to_builtin = false; /**< 待生效的是内置计划 (已删除下载的计划) */
+static uint32_t s_stored_crc = 0; /**< Flash中计划的CRC, 0=无 */
+
+/*============================================================================
+ * 内部函数
+ *===========================================================================*/
+
+static uint16_t get_u16(const uint8_t *p) {
+  return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+static void put_u16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+/**
+ * @brief 解析镜像, plan 为NULL时只校验
+ * @note 先以 plan=NULL 完整校验, 再解析到目标, 校验失败不会改动目标
+ */
+static TestPlanResult parse(const uint8_t *image, uint16_t len, TestPlan *plan,
+                            uint8_t *bad_step) {
+  uint8_t count;
+  uint16_t size;
+
+  if (bad_step != NULL) {
+    *bad_step = 0xFF;
+  }
+  if (len < TEST_PLAN_HEAD_SIZE + 4) {
+    return TEST_PLAN_ERR_SIZE;
+  }
+  if (get_u16(&image[0]) != TEST_PLAN_MAGIC) {
+    return TEST_PLAN_ERR_MAGIC;
+  }
+  if (image[2] != TEST_PLAN_FORMAT) {
+    return TEST_PLAN_ERR_FORMAT;
+  }
+  count = image[3];
+  size = TEST_PLAN_HEAD_SIZE + count * TEST_PLAN_STEP_SIZE;
+  if (count == 0 || count > TEST_PLAN_MAX_STEPS || len != size + 4) {
+    return TEST_PLAN_ERR_SIZE;
+  }
+  if (util_crc32(image, size) != get_u32(&image[size])) {
+    return TEST_PLAN_ERR_CRC;
+  }
+  if (get_u32(&image[8]) < 1000 || get_u32(&image[8]) > TEST_PLAN_TIMEOUT_MAX) {
+    return TEST_PLAN_ERR_STEP;
+  }
+
+  for (uint8_t i = 0; i < count; i++) {
+    const uint8_t *p = &image[TEST_PLAN_HEAD_SIZE + i * TEST_PLAN_STEP_SIZE];
+    TestPlanStep step;
+
+    step.id = p[0];
+    step.tries = p[1];
+    step.after = get_u16(&p[2]);
+    step.interval_ms = get_u16(&p[4]);
+    step.timeout_ms = get_u32(&p[8]);
+    step.lo = (int32_t)get_u32(&p[12]);
+    step.hi = (int32_t)get_u32(&p[16]);
+    step.aux = (int32_t)get_u32(&p[20]);
+
+    /* 前置步骤只能在前面, 保证没有循环依赖 */
+    if ((step.after >> i) != 0 || step.timeout_ms > TEST_PLAN_TIMEOUT_MAX ||
+        step.lo >= step.hi || (s_check != NULL && !s_check(&step))) {
+      if (bad_step != NULL) {
+        *bad_step = i;
+      }
+      return TEST_PLAN_ERR_STEP;
+    }
+    if (plan != NULL) {
+      plan->steps[i] = step;
+    }
+  }
+
+  if (plan != NULL) {
+    plan->version = get_u16(&image[4]);
+    plan->product = get_u16(&image[6]);
+    plan->timeout_ms = get_u32(&image[8]);
+    plan->crc = get_u32(&image[size]);
+    plan->count = count;
+  }
+  return TEST_PLAN_OK;
+}
+
+/*============================================================================
+ * API 实现
+ *===========================================================================*/
+
+void TestPlan_Init(TestPlanStepCheck check, TestPlanBuiltinFunc builtin) {
+  uint8_t image[TEST_PLAN_MAX_SIZE];
+  uint16_t len;
+  TestPlanResult result;
+
+  s_check = check;
+  s_builtin = builtin;
+  s_loaded = false;
+  s_pending = false;
+  s_stored_crc = 0;
+
+  len = JigConfig_GetBlob(TEST_PLAN_KEY, image, sizeof(image));
+  if (len == 0) {
+    log_i("使用内置测试计划");
+    return;
+  }
+  /* 固件更新后保存的计划可能引用已不存在的步骤, 此时保留在Flash中不删除 */
+  result = TestPlan_Decode(image, len, &s_next, NULL);
+  if (result != TEST_PLAN_OK) {
+    log_w("保存的测试计划无效 (%d), 使用内置计划", result);
+    return;
+  }
+  s_pending = true;
+  s_to_builtin = false;
+  s_stored_crc = s_next.crc;
+  log_i("加载测试计划 v%u, 产品%u, %d步", s_next.version, s_next.product,
+        s_next.count);
+}
+
+TestPlanResult TestPlan_Decode(const uint8_t *image, uint16_t len,
+                               TestPlan *plan, uint8_t *bad_step) {
+  TestPlanResult result = parse(image, len, NULL, bad_step);
+
+  if (result == TEST_PLAN_OK && plan != NULL) {
+    parse(image, len, plan, NULL);
+  }
+  return result;
+}
+
+uint16_t TestPlan_Encode(const TestPlan *plan, uint8_t *buf, uint16_t size) {
+  uint16_t len;
+
+  if (plan->count == 0 || plan->count > TEST_PLAN_MAX_STEPS) {
+    return 0;
+  }
+  len = TEST_PLAN_HEAD_SIZE + plan->count * TEST_PLAN_STEP_SIZE;
+  if (size < len + 4) {
+    return 0;
+  }
+
+  put_u16(&buf[0], TEST_PLAN_MAGIC);
+  buf[2] = TEST_PLAN_FORMAT;
+  buf[3] = plan->count;
+  put_u16(&buf[4], plan->version);
+  put_u16(&buf[6], plan->product);
+  put_u32(&buf[8], plan->timeout_ms);
+  for (uint8_t i = 0; i < plan->count; i++) {
+    const TestPlanStep *step = &plan->steps[i];
+    uint8_t *p = &buf[TEST_PLAN_HEAD_SIZE + i * TEST_PLAN_STEP_SIZE];
+
+    p[0] = step->id;
+    p[1] = step->tries;
+    put_u16(&p[2], step->after);
+    put_u16(&p[4], step->interval_ms);
+    put_u16(&p[6], 0);
+    put_u32(&p[8], step->timeout_ms);
+    put_u32(&p[12], (uint32_t)step->lo);
+    put_u32(&p[16], (uint32_t)step->hi);
+    put_u32(&p[20], (uint32_t)step->aux);
+  }
+  put_u32(&buf[len], util_crc32(buf, len));
+  return len + 4;
+}
+
+TestPlanResult TestPlan_Load(const uint8_t *image, uint16_t len,
+                             uint8_t *bad_step) {
+  TestPlanResult result;
+
+  if (len == 0) {
+    if (bad_step != NULL) {
+      *bad_step = 0xFF;
+    }
+    s_pending = true;
+    s_to_builtin = true;
+    s_stored_crc = 0;
+    log_i("删除测试计划, 下一次测试起使用内置计划");
+    return JigConfig_SetBlob(TEST_PLAN_KEY, NULL, 0) == JIG_CFG_OK
+               ? TEST_PLAN_OK
+               : TEST_PLAN_ERR_FLASH;
+  }
+
+  result = TestPlan_Decode(image, len, &s_next, bad_step);
+  if (result != TEST_PLAN_OK) {
+    log_w("测试计划无效: %d, 步骤%d", result,
+          bad_step != NULL ? *bad_step : 0xFF);
+    return result;
+  }
+  s_pending = true;
+  s_to_builtin = false;
+  log_i("测试计划 v%u (CRC %08lX) 下一次测试起生效", s_next.version,
+        (unsigned long)s_next.crc);
+
+  /* 与Flash中相同时不重复写入 (广播后MES对漏收的工位单独补发) */
+  if (s_next.crc == s_stored_crc) {
+    return TEST_PLAN_OK;
+  }
+  if (JigConfig_SetBlob(TEST_PLAN_KEY, image, len) != JIG_CFG_OK) {
+    s_stored_crc = 0;
+    return TEST_PLAN_ERR_FLASH;
+  }
+  s_stored_crc = s_next.crc;
+  return TEST_PLAN_OK;
+}
+
+const TestPlan *TestPlan_Begin(void) {
+  if (s_pending) {
+    s_pending = false;
+    s_loaded = !s_to_builtin;
+    if (s_loaded) {
+      s_active = s_next;
+    }
+    log_i("切换到%s测试计划 v%u", s_loaded ? "下载的" : "内置",
+          s_loaded ? s_active.version : 0);
+  }
+  if (!s_loaded && s_builtin != NULL) {
+    s_builtin(&s_active);
+  }
+  return &s_active;
+}
+
+const TestPlan *TestPlan_Active(void) { return &s_active; }
+
+TestPlanState TestPlan_GetState(void) {
+  if (s_pending) {
+    return TEST_PLAN_STATE_PENDING;
+  }
+  return s_loaded ? TEST_PLAN_STATE_LOADED : TEST_PLAN_STATE_BUILTIN;
+}
+
+uint16_t TestPlan_ReadNext(uint8_t *buf, uint16_t size) {
+  /* 下一次是内置计划时 s_next 空闲, 用来生成 */
+  if (s_pending ? s_to_builtin : !s_loaded) {
+    if (s_builtin == NULL) {
+      return 0;
+    }
+    s_builtin(&s_next);
+    return TestPlan_Encode(&s_next, buf, size);
+  }
+  return TestPlan_Encode(s_pending ? &s_next : &s_active, buf, size);
+}
+
+void TestPlan_Print(const TestPlan *plan) {
+  log_i("测试计划 v%u 产品%u, 超时%lums, %d步, CRC %08lX", plan->version,
+        plan->product, (unsigned long)plan->timeout_ms, plan->count,
+        (unsigned long)plan->crc);
+  for (uint8_t i = 0; i < plan->count; i++) {
+    const TestPlanStep *s = &plan->steps[i];
+    log_i("  [%d] 步骤%d 前置%04X 间隔%ums 次数%u 超时%lums 范围(%ld,%ld) "
+          "附加%ld",
+          i, s->id, s->after, s->interval_ms, s->tries,
+          (unsigned long)s->timeout_ms, (long)s->lo, (long)s->hi,
+          (long)s->aux);
+  }
+}
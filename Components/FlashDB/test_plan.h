@@ -0,0 +1,202 @@
+/**
+ * @file test_plan.h
+ * @brief 可下载的测试计划 (步骤表/限值/超时/重试次数)
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * @section intro 简介
+ * 测试步骤的顺序、合格范围、复测/重发间隔、重试次数和超时原先编译在
+ * 固件里 (部分限值可通过 jig_config 修改), 换产品批次要给每个工位重新
+ * 烧录。测试计划把这些参数做成一个紧凑的二进制镜像, 由MES通过PC协议
+ * (0xDA, 可广播) 一帧下发:
+ *   - 校验: 魔数、格式版本、长度、CRC32, 以及步骤号/前置步骤/参数范围
+ *   - 保存: jig_config 所在的 KVDB, 键名 TEST_PLAN_KEY, 复位后自动加载
+ *   - 切换: 新计划先挂起, 下一次测试开始时生效, 进行中的测试不受影响,
+ *           不需要复位
+ * 没有下载过计划时使用固件内置计划 (由注册的回调按 jig_config 生成)。
+ *
+ * @section format 镜像格式 (小端)
+ *   头部 12 字节:
+ *     [0-1]  魔数 0x5054 ("TP")
+ *     [2]    格式版本 TEST_PLAN_FORMAT
+ *     [3]    步骤数 N (1..TEST_PLAN_MAX_STEPS)
+ *     [4-5]  计划版本 (MES分配, 测试结果中可追溯)
+ *     [6-7]  产品代码
+ *     [8-11] 整体测试超时 (ms)
+ *   步骤 24 字节 * N:
+ *     [0]     步骤号 (固件中的步骤实现)
+ *     [1]     最多测量/发送次数, 0=不限 (直到步骤超时或整体超时)
+ *     [2-3]   前置步骤 (计划内下标位掩码, 只能指向前面的步骤)
+ *     [4-5]   复测/重发间隔 (ms)
+ *     [6-7]   保留, 0
+ *     [8-11]  步骤超时 (ms), 0=不限
+ *     [12-15] 合格下限 lo (int32, 合格为 lo < 测量值 < hi)
+ *     [16-19] 合格上限 hi (int32)
+ *     [20-23] 附加限值 aux (int32, 含义由步骤定义)
+ *   CRC32 4 字节: 头部和全部步骤的 util_crc32
+ * 最大 12 + 24*8 + 4 = 208 字节, 一帧PC命令即可装下。
+ */
+
+#ifndef __TEST_PLAN_H__
+#define __TEST_PLAN_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*============================================================================
+ * 配置定义
+ *===========================================================================*/
+
+#define TEST_PLAN_MAGIC 0x5054 /* "TP" */
+#define TEST_PLAN_FORMAT 1
+
+/** 计划最多步骤数 (受单帧长度限制) */
+#define TEST_PLAN_MAX_STEPS 8
+
+#define TEST_PLAN_HEAD_SIZE 12
+#define TEST_PLAN_STEP_SIZE 24
+#define TEST_PLAN_MAX_SIZE                                                     \
+  (TEST_PLAN_HEAD_SIZE + TEST_PLAN_STEP_SIZE * TEST_PLAN_MAX_STEPS + 4)
+
+/** 整体/步骤超时上限 (ms) */
+#define TEST_PLAN_TIMEOUT_MAX 600000
+
+/** KVDB 键名 */
+#define TEST_PLAN_KEY "plan"
+
+/*============================================================================
+ * 数据结构定义
+ *===========================================================================*/
+
+/**
+ * @brief 计划中的一个步骤
+ */
+typedef struct {
+  uint8_t id;           /**< 步骤号 */
+  uint8_t tries;        /**< 最多测量/发送次数, 0=不限 */
+  uint16_t after;       /**< 前置步骤 (计划内下标位掩码) */
+  uint16_t interval_ms; /**< 复测/重发间隔 */
+  uint32_t timeout_ms;  /**< 步骤超时, 0=不限 */
+  int32_t lo;           /**< 合格下限 (不含) */
+  int32_t hi;           /**< 合格上限 (不含) */
+  int32_t aux;          /**< 附加限值 */
+} TestPlanStep;
+
+/**
+ * @brief 解码后的测试计划
+ */
+typedef struct {
+  uint16_t version;    /**< 计划版本, 0=固件内置 */
+  uint16_t product;    /**< 产品代码 */
+  uint32_t timeout_ms; /**< 整体测试超时 */
+  uint32_t crc;        /**< 镜像CRC32 (内置计划为0) */
+  uint8_t count;       /**< 步骤数 */
+  TestPlanStep steps[TEST_PLAN_MAX_STEPS];
+} TestPlan;
+
+/**
+ * @brief 结果码 (PC协议应答状态)
+ */
+typedef enum {
+  TEST_PLAN_OK = 0,
+  TEST_PLAN_ERR_SIZE,   /**< 长度与步骤数不符 */
+  TEST_PLAN_ERR_MAGIC,  /**< 魔数错误 */
+  TEST_PLAN_ERR_FORMAT, /**< 不支持的格式版本 */
+  TEST_PLAN_ERR_CRC,    /**< CRC错误 */
+  TEST_PLAN_ERR_STEP,   /**< 步骤无效 (步骤号/前置步骤/参数) */
+  TEST_PLAN_ERR_FLASH,  /**< 保存失败 (计划仍会生效, 复位后丢失) */
+} TestPlanResult;
+
+/**
+ * @brief 计划状态 (PC协议应答)
+ */
+typedef enum {
+  TEST_PLAN_STATE_BUILTIN = 0, /**< 使用固件内置计划 */
+  TEST_PLAN_STATE_LOADED,      /**< 使用下载的计划 */
+  TEST_PLAN_STATE_PENDING,     /**< 新计划待下一次测试开始时生效 */
+} TestPlanState;
+
+/**
+ * @brief 步骤检查回调: 步骤号是否有实现、参数是否适用于该步骤
+ */
+typedef bool (*TestPlanStepCheck)(const TestPlanStep *step);
+
+/**
+ * @brief 生成固件内置计划的回调 (每次测试开始时调用, 可读取最新配置)
+ */
+typedef void (*TestPlanBuiltinFunc)(TestPlan *plan);
+
+/*============================================================================
+ * API 函数
+ *===========================================================================*/
+
+/**
+ * @brief 初始化: 注册回调, 加载Flash中保存的计划 (在 JigConfig_Init 之后)
+ * @param check 步骤检查回调, 可为NULL
+ * @param builtin 内置计划回调
+ */
+void TestPlan_Init(TestPlanStepCheck check, TestPlanBuiltinFunc builtin);
+
+/**
+ * @brief 解码并校验镜像
+ * @param image 镜像
+ * @param len 镜像长度
+ * @param plan 输出
+ * @param bad_step 步骤无效时输出步骤下标 (可为NULL), 其他错误为0xFF
+ * @return 结果码
+ */
+TestPlanResult TestPlan_Decode(const uint8_t *image, uint16_t len,
+                               TestPlan *plan, uint8_t *bad_step);
+
+/**
+ * @brief 编码为镜像 (计算CRC32)
+ * @return 镜像长度, 0: 缓冲区不足或步骤数无效
+ */
+uint16_t TestPlan_Encode(const TestPlan *plan, uint8_t *buf, uint16_t size);
+
+/**
+ * @brief 下载计划: 校验、保存到Flash, 下一次测试开始时生效
+ * @param image 镜像, len=0 表示删除已保存的计划, 恢复内置计划
+ * @param len 镜像长度
+ * @param bad_step 同 TestPlan_Decode
+ * @return 结果码, TEST_PLAN_ERR_FLASH 时计划仍会生效
+ */
+TestPlanResult TestPlan_Load(const uint8_t *image, uint16_t len,
+                             uint8_t *bad_step);
+
+/**
+ * @brief 测试开始时调用: 切换到挂起的新计划, 返回本次测试使用的计划
+ * @note 返回的计划在下一次调用前保持不变
+ */
+const TestPlan *TestPlan_Begin(void);
+
+/**
+ * @brief 本次 (或最近一次) 测试使用的计划
+ */
+const TestPlan *TestPlan_Active(void);
+
+/**
+ * @brief 计划状态
+ */
+TestPlanState TestPlan_GetState(void);
+
+/**
+ * @brief 编码下一次测试将使用的计划 (挂起的新计划或当前计划)
+ * @return 镜像长度, 0: 缓冲区不足
+ */
+uint16_t TestPlan_ReadNext(uint8_t *buf, uint16_t size);
+
+/**
+ * @brief 打印计划到日志
+ */
+void TestPlan_Print(const TestPlan *plan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TEST_PLAN_H__ */
@@ -11,6 +11,7 @@
 #define LOG_TAG "test_stats"
 
 #include "test_stats.h"
+#include "utility.h"
 #include <elog.h>
 #include <fal.h>
 #include <string.h>
@@ -43,25 +44,6 @@ static uint8_t s_station_id = 0;
 static TestStatsSummary_t s_summary_cache;
 static bool s_cache_valid = false;
 
-/*============================================================================
- * CRC32 计算
- *===========================================================================*/
-
-static uint32_t calc_crc32(const uint8_t *data, size_t len) {
-  uint32_t crc = 0xFFFFFFFF;
-  for (size_t i = 0; i < len; i++) {
-    crc ^= data[i];
-    for (int j = 0; j < 8; j++) {
-      if (crc & 1) {
-        crc = (crc >> 1) ^ 0xEDB88320;
-      } else {
-        crc >>= 1;
-      }
-    }
-  }
-  return ~crc;
-}
-
 /*============================================================================
  * 内部函数
  *===========================================================================*/
@@ -85,7 +67,7 @@ static bool load_summary(void) {
   }
 
   /* 验证CRC */
-  uint32_t calc_crc = calc_crc32((const uint8_t *)&summary,
+  uint32_t calc_crc = util_crc32((const uint8_t *)&summary,
                                  sizeof(summary) - sizeof(summary.checksum));
   if (calc_crc != summary.checksum) {
     log_e("统计数据CRC错误");
@@ -104,7 +86,7 @@ static bool save_summary(void) {
 
   /* 更新校验和 */
   s_summary_cache.checksum =
-      calc_crc32((const uint8_t *)&s_summary_cache,
+      util_crc32((const uint8_t *)&s_summary_cache,
                  sizeof(s_summary_cache) - sizeof(s_summary_cache.checksum));
 
   /* 需要先擦除 (擦除整个分区会影响历史记录，这里只读取-修改-写入前512字节) */
@@ -121,7 +103,8 @@ static bool save_summary(void) {
 
   /* 写入汇总数据 */
   if (fal_partition_write(s_part, SUMMARY_OFFSET, buf,
-                          sizeof(s_summary_cache)) < 0) {
+                          sizeof(s_summary_cache)) < 0 ||
+      fal_flash_fm33lg04_sync() != 0) {
     log_e("写入统计数据失败");
     return false;
   }
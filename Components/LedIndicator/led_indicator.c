@@ -10,18 +10,7 @@
  *                          闪烁模式时序表
  *===========================================================================*/
 
-/**
- * @brief 闪烁模式时序定义
- * @note 用数组定义一个周期内的亮灭序列，-1表示结束
- *       时间单位：10ms
- */
-typedef struct {
-  uint16_t period_ms;   // 总周期时间
-  uint8_t sequence[16]; // 亮灭序列 (1=亮, 0=灭)，按时间片划分
-  uint8_t seq_count;    // 序列长度
-} BlinkPattern_t;
-
-static const BlinkPattern_t s_blink_patterns[LED_BLINK_MODE_COUNT] = {
+static const LedPattern_t s_blink_patterns[LED_BLINK_MODE_COUNT] = {
     // LED_BLINK_OFF: 常灭
     [LED_BLINK_OFF] = {.period_ms = 1000, .sequence = {0}, .seq_count = 1},
 
@@ -59,10 +48,11 @@ static const BlinkPattern_t s_blink_patterns[LED_BLINK_MODE_COUNT] = {
                                           0, 0, 0},
                              .seq_count = 16},
 
-    // LED_BLINK_BREATH: 呼吸灯（简化为慢闪）
+    // LED_BLINK_BREATH: 呼吸灯（后端不支持PWM时为慢闪）
     [LED_BLINK_BREATH] = {.period_ms = 2000,
                           .sequence = {1, 0},
-                          .seq_count = 2},
+                          .seq_count = 2,
+                          .breath = 1},
 };
 
 /*============================================================================
@@ -164,6 +154,7 @@ static struct {
   LedStatus_t current_status;
   uint32_t status_enter_tick; // 进入当前状态的时刻
   uint8_t led_states[2];      // 当前LED状态缓存
+  LedBlinkMode_t led_modes[2]; // 后端正在播放的模式
 } s_ctx = {0};
 
 /*============================================================================
@@ -181,7 +172,7 @@ static uint8_t calc_led_state(LedBlinkMode_t mode, uint32_t tick) {
     return 0;
   }
 
-  const BlinkPattern_t *pattern = &s_blink_patterns[mode];
+  const LedPattern_t *pattern = &s_blink_patterns[mode];
 
   // 计算在周期内的位置
   uint32_t pos_in_period = tick % pattern->period_ms;
@@ -212,18 +203,35 @@ static void update_led_output(uint8_t led_index, uint8_t new_state) {
   }
 }
 
+/**
+ * @brief 定时器后端: 模式变化时交给后端播放
+ */
+static void update_led_pattern(uint8_t led_index, LedBlinkMode_t mode) {
+  if (led_index >= 2 || mode >= LED_BLINK_MODE_COUNT) {
+    return;
+  }
+
+  if (s_ctx.led_modes[led_index] != mode) {
+    s_ctx.led_modes[led_index] = mode;
+    s_ctx.hw.play(led_index, &s_blink_patterns[mode]);
+  }
+}
+
 /*============================================================================
  *                          API实现
  *===========================================================================*/
 
 bool LedIndicator_Init(const LedHardwareConfig_t *hw_config) {
-  if (hw_config == NULL || hw_config->control == NULL ||
+  if (hw_config == NULL ||
+      (hw_config->control == NULL && hw_config->play == NULL) ||
       hw_config->get_tick == NULL || hw_config->led_count == 0) {
     return false;
   }
 
   memset(&s_ctx, 0, sizeof(s_ctx));
   s_ctx.hw = *hw_config;
+  s_ctx.led_modes[0] = LED_BLINK_MODE_COUNT;
+  s_ctx.led_modes[1] = LED_BLINK_MODE_COUNT;
   s_ctx.initialized = true;
   s_ctx.current_status = LED_STATUS_POWER_ON;
   s_ctx.status_enter_tick = s_ctx.hw.get_tick();
@@ -244,6 +252,9 @@ bool LedIndicator_SetScheme(const LedScheme_t *scheme) {
   }
 
   s_ctx.scheme = scheme;
+  // 后端重新播放新方案的模式
+  s_ctx.led_modes[0] = LED_BLINK_MODE_COUNT;
+  s_ctx.led_modes[1] = LED_BLINK_MODE_COUNT;
   return true;
 }
 
@@ -278,6 +289,15 @@ void LedIndicator_Process(void) {
     }
   }
 
+  // 定时器后端: 只在模式变化时下发
+  if (s_ctx.hw.play != NULL) {
+    update_led_pattern(0, mapping->led1_mode);
+    if (s_ctx.hw.led_count >= 2) {
+      update_led_pattern(1, mapping->led2_mode);
+    }
+    return;
+  }
+
   // 计算LED1状态
   uint8_t led1_state = calc_led_state(mapping->led1_mode, current_tick);
   update_led_output(0, led1_state);
@@ -290,6 +310,10 @@ void LedIndicator_Process(void) {
 }
 
 void LedIndicator_ForceState(uint8_t led_index, uint8_t state) {
+  if (s_ctx.initialized && s_ctx.hw.play != NULL && led_index < 2) {
+    update_led_pattern(led_index, state ? LED_BLINK_ON : LED_BLINK_OFF);
+    return;
+  }
   if (s_ctx.initialized && s_ctx.hw.control != NULL && led_index < 2) {
     s_ctx.hw.control(led_index, state);
     s_ctx.led_states[led_index] = state;
@@ -299,3 +323,7 @@ void LedIndicator_ForceState(uint8_t led_index, uint8_t state) {
 const char *LedIndicator_GetSchemeName(void) {
   return s_ctx.scheme ? s_ctx.scheme->name : "未设置";
 }
+
+const LedPattern_t *LedIndicator_GetPattern(LedBlinkMode_t mode) {
+  return (mode < LED_BLINK_MODE_COUNT) ? &s_blink_patterns[mode] : NULL;
+}
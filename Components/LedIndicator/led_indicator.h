@@ -3,6 +3,16 @@
  * @brief LED指示器组件 - 支持单/双LED，可注册不同方案
  * @version 1.0.0
  * @date 2026-01-31
+ *
+ * @section backend 定时器后端
+ * 默认由 LedIndicator_Process 在主循环中按 tick 计算亮灭并调用 control,
+ * 主循环阻塞时闪烁会抖动。硬件配置提供 play 时, 模式切换时把 LedPattern_t
+ * 交给后端由定时器播放, Process 只处理状态的自动跳转:
+ * @code
+ * LedHardwareConfig_t hw = {.led_count = 1, .control = LED_Control,
+ *                           .get_tick = TM_GetTick, .play = Led_Play};
+ * LedIndicator_Init(&hw);
+ * @endcode
  */
 
 #ifndef __LED_INDICATOR_H__
@@ -37,6 +47,20 @@ typedef enum {
   LED_BLINK_MODE_COUNT
 } LedBlinkMode_t;
 
+/**
+ * @brief 闪烁模式描述
+ * @note 一个周期均分为 seq_count 个时间片, sequence[i] 为第i片的亮灭。
+ *       breath=1 为呼吸效果 (一个周期内由暗到亮再到暗), 不支持PWM的后端按
+ *       sequence 播放; once=1 只播放一个周期, 之后后端恢复原来的循环模式。
+ */
+typedef struct {
+  uint16_t period_ms;   // 总周期时间
+  uint8_t sequence[16]; // 亮灭序列 (1=亮, 0=灭)，按时间片划分
+  uint8_t seq_count;    // 序列长度
+  uint8_t breath;       // 呼吸效果
+  uint8_t once;         // 单次播放
+} LedPattern_t;
+
 /**
  * @brief 工装状态枚举 - 业务层使用
  */
@@ -69,13 +93,21 @@ typedef void (*LedControlFunc)(uint8_t led_index, uint8_t state);
  */
 typedef uint32_t (*GetTickFunc)(void);
 
+/**
+ * @brief 模式播放回调 (定时器后端)
+ * @param led_index LED索引
+ * @param pattern 模式描述, 后端循环播放直到下次调用
+ */
+typedef void (*LedPatternFunc)(uint8_t led_index, const LedPattern_t *pattern);
+
 /**
  * @brief LED硬件配置
  */
 typedef struct {
   uint8_t led_count;      // LED数量 (1或2)
-  LedControlFunc control; // LED控制函数
+  LedControlFunc control; // LED控制函数 (提供 play 时可为NULL)
   GetTickFunc get_tick;   // 获取系统tick函数
+  LedPatternFunc play;    // 可选: 定时器后端, NULL=主循环计算亮灭
 } LedHardwareConfig_t;
 
 /*============================================================================
@@ -149,6 +181,13 @@ void LedIndicator_ForceState(uint8_t led_index, uint8_t state);
  */
 const char *LedIndicator_GetSchemeName(void);
 
+/**
+ * @brief 获取闪烁模式描述
+ * @param mode 闪烁模式
+ * @return 模式描述, 无效模式返回NULL
+ */
+const LedPattern_t *LedIndicator_GetPattern(LedBlinkMode_t mode);
+
 /*============================================================================
  *                          预定义方案
  *===========================================================================*/
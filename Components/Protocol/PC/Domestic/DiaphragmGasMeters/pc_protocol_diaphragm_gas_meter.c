@@ -59,6 +59,11 @@ extern uint8_t PassThrough_Mode;
 #define OPT_INSTALL 0x05  // 安装/配置操作
 #define OPT_LOADLINK 0x08 // 加载链接
 
+// 控制码即命令表请求码, 分发表按命令表行号查找
+_Static_assert(OPT_READ == PC_CMD_QUERY_RESULT, "OPT_READ 与命令表不一致");
+_Static_assert(OPT_WRITE == PC_CMD_SET_TIME, "OPT_WRITE 与命令表不一致");
+_Static_assert(OPT_INSTALL == PC_CMD_START_TEST, "OPT_INSTALL 与命令表不一致");
+
 /*============ 数据标识定义 (与PIC一致) ============*/
 
 #define DEV_TIME 0xC621            // 时间
@@ -129,6 +134,7 @@ static void mes_set_event_callback(ProtocolEventCallback callback);
 // 命令处理函数
 static void handle_start_test(const uint8_t *data, uint16_t len);
 static void handle_query_result(const uint8_t *data, uint16_t len);
+static void handle_set_time(const uint8_t *data, uint16_t len);
 static void handle_set_config(const uint8_t *data, uint16_t len);
 
 // 响应发送函数
@@ -139,6 +145,15 @@ static void send_start_test_ack(void);
 static void send_test_result(void);
 static void send_config_ack(void);
 
+// 命令分发表 (下标为命令表行号, 按控制码查找)
+static const PCCmdHandler s_handlers[PC_CMD_SLOT_NUM] = {
+    [PC_CMD_SLOT_START_TEST] = handle_start_test,
+    [PC_CMD_SLOT_QUERY_RESULT] = handle_query_result,
+    [PC_CMD_SLOT_SET_TIME] = handle_set_time,
+    // 私有扩展命令 (非标准MES协议)
+    [PC_CMD_SLOT_SET_CONFIG] = handle_set_config,
+};
+
 /*============ 协议接口实例 ============*/
 
 const ProtocolInterface diaphragm_gas_meter_pc_protocol = {
@@ -233,9 +248,8 @@ static ProtocolResult mes_parse(uint8_t *data, uint16_t len) {
       continue;
     }
 
-    // 获取控制码和数据标识
+    // 获取控制码 (数据标识由各处理函数检查)
     uint8_t ctrl_code = data[pos + INDEX_CONTROL_CODE];
-    uint16_t data_mark = READ_LE_U16(&data[pos + INDEX_DATA_MARK]);
 
     // 获取工位号 (数据域第一个字节)
     uint8_t station_id = data[pos + INDEX_VOLUME_DATA];
@@ -254,40 +268,12 @@ static ProtocolResult mes_parse(uint8_t *data, uint16_t len) {
     // 保存时间
     memcpy(s_rtc_time, &data[pos + INDEX_TIME], 6);
 
-    // 根据控制码和数据标识分发处理
-    switch (ctrl_code) {
-    case OPT_INSTALL: // 0x05 - 安装/启动命令
-      if (data_mark == DEV_START_TEST) {
-        log_d("收到启动测试命令 (0xFC03)");
-        handle_start_test(&data[pos], frame_len);
-        handled = true;
-      }
-      break;
-
-    case OPT_READ: // 0x01 - 读操作
-      if (data_mark == DEV_GETCHECK_RESULT) {
-        log_d("收到查询结果命令 (0xFC04)");
-        handle_query_result(&data[pos], frame_len);
-        handled = true;
-      }
-      break;
-
-    case OPT_WRITE: // 0x04 - 写操作
-      if (data_mark == DEV_TIME) {
-        log_d("收到设置时间命令 (0xC621)");
-        // 处理时间设置
-        handled = true;
-      }
-      break;
-
-    default:
+    // 按控制码查分发表
+    ProtocolResult result =
+        PC_Cmd_Dispatch(s_handlers, ctrl_code, &data[pos], frame_len);
+    if (result == PROTOCOL_RESULT_UNKNOWN_CMD) {
       log_d("未处理的控制码: 0x%02X", ctrl_code);
-      break;
-    }
-
-    // 私有扩展命令 (非标准MES协议)
-    if (!handled && ctrl_code == PC_CMD_SET_CONFIG) {
-      handle_set_config(&data[pos], frame_len);
+    } else {
       handled = true;
     }
 
@@ -333,6 +319,10 @@ static void mes_set_event_callback(ProtocolEventCallback callback) {
  * @brief 处理启动测试命令 (OPT_INSTALL + DEV_START_TEST)
  */
 static void handle_start_test(const uint8_t *data, uint16_t len) {
+  if (READ_LE_U16(&data[INDEX_DATA_MARK]) != DEV_START_TEST) {
+    log_d("未处理的数据标识: 0x%04X", READ_LE_U16(&data[INDEX_DATA_MARK]));
+    return;
+  }
   log_i("处理启动测试命令");
 
   // 获取工位号
@@ -362,6 +352,10 @@ static void handle_start_test(const uint8_t *data, uint16_t len) {
  * @brief 处理查询结果命令 (OPT_READ + DEV_GETCHECK_RESULT)
  */
 static void handle_query_result(const uint8_t *data, uint16_t len) {
+  if (READ_LE_U16(&data[INDEX_DATA_MARK]) != DEV_GETCHECK_RESULT) {
+    log_d("未处理的数据标识: 0x%04X", READ_LE_U16(&data[INDEX_DATA_MARK]));
+    return;
+  }
   log_i("处理查询结果命令");
 
   // 检查测试是否已结束:
@@ -377,6 +371,19 @@ static void handle_query_result(const uint8_t *data, uint16_t len) {
   send_test_result();
 }
 
+/**
+ * @brief 处理设置时间命令 (OPT_WRITE + DEV_TIME)
+ *
+ * 每帧的时间已在解析时保存到 s_rtc_time，这里只确认数据标识。
+ */
+static void handle_set_time(const uint8_t *data, uint16_t len) {
+  if (READ_LE_U16(&data[INDEX_DATA_MARK]) != DEV_TIME) {
+    log_d("未处理的数据标识: 0x%04X", READ_LE_U16(&data[INDEX_DATA_MARK]));
+    return;
+  }
+  log_d("收到设置时间命令 (0xC621)");
+}
+
 /**
  * @brief 处理配置命令 (私有扩展)
  */
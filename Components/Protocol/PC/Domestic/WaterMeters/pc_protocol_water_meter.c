@@ -104,6 +104,12 @@ static void handle_query_result(const uint8_t *data, uint16_t len);
 static void send_start_test_ack(void);
 static void send_test_result(void);
 
+// 命令分发表 (下标为命令表行号)
+static const PCCmdHandler s_handlers[PC_CMD_SLOT_NUM] = {
+    [PC_CMD_SLOT_START_TEST] = handle_start_test,
+    [PC_CMD_SLOT_QUERY_RESULT] = handle_query_result,
+};
+
 /*============ 协议接口实例 ============*/
 
 const ProtocolInterface water_meter_pc_protocol = {
@@ -154,28 +160,17 @@ static ProtocolResult mes_parse(uint8_t *data, uint16_t len) {
       continue;
     }
 
-    // 处理不同命令
-    switch (cmd) {
-    case PC_CMD_START_TEST: // 0xAA
-      log_d("收到开始测试命令");
-      handle_start_test(&data[pos], frame_len);
-      handled = true;
-      break;
-
-    case PC_CMD_QUERY_RESULT: // 0xAC
-      log_d("收到查询结果命令");
-      handle_query_result(&data[pos], frame_len);
-      handled = true;
-      break;
-
-      // 注意: 0xAE (设置配置) 和 0xBE (查询步骤) 命令已移至公共配置协议
-      // (pc_protocol_config.c)
-
-    default:
+    // 处理不同命令 (按命令表行号查分发表)
+    // 注意: 0xAE (设置配置) 和 0xBE (查询步骤) 命令已移至公共配置协议
+    // (pc_protocol_config.c)
+    ProtocolResult result =
+        PC_Cmd_Dispatch(s_handlers, cmd, &data[pos], frame_len);
+    if (result == PROTOCOL_RESULT_UNKNOWN_CMD) {
       // 未知命令，不认领此帧，让其他协议处理
       log_d("非MES命令: 0x%02X, 跳过让其他协议处理", cmd);
       return PROTOCOL_RESULT_UNKNOWN_CMD;
     }
+    handled = true;
 
     pos += frame_len;
   }
@@ -0,0 +1,68 @@
+/**
+ * @file pc_cmd_def.h
+ * @brief 上位机协议命令表 (唯一定义处)
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * @section intro 简介
+ * 所有PC命令码只在本表中分配。以下内容都由本表生成，不要在别处手写命令码：
+ * - pc_protocol.h 中的 PCProtocolCmd 枚举 (PC_CMD_xxx / 应答码)
+ * - pc_cmd_table.c 中的命令信息表和 O(1) 查找索引
+ * - 各协议的处理函数分发表 (按 PC_CMD_SLOT_xxx 下标填写)
+ * - 上位机工具: VscodeGcc/scripts/pc_cmd_table.py 解析本文件
+ *
+ * @section rule 规则
+ * - 请求码和应答码都不能重复，重复时 pc_cmd_table.c 编译报
+ *   "duplicate case value"
+ * - 只追加或修改行，不要调整已有行的参数顺序 (上位机脚本按位置解析)
+ * - 每行: X(名称, 请求码, 应答名称, 应答码, 请求最小帧长, 应答帧长, 说明)
+ *   帧长含帧头/帧尾，0 表示变长或由具体协议决定
+ */
+
+#ifndef __PC_CMD_DEF_H__
+#define __PC_CMD_DEF_H__
+
+/* clang-format off */
+#define PC_CMD_TABLE(X)                                                        \
+  /* 工装 0x68 帧协议 (Src/PC_xieyi_Ctrl.c) */                               \
+  X(JIG_START,       0xAA, JIG_START_ACK,       0xAB, 17,  5, "开始测试(68帧)") \
+  X(JIG_RESULT,      0xAC, JIG_RESULT_ACK,      0xAD,  5, 63, "查询结果(68帧)") \
+  X(BUS_STATS,       0xB0, BUS_STATS_ACK,       0xB1,  5, 15, "总线时隙统计")  \
+  X(PUSH,            0xB2, PUSH_ACK,            0xB3, 13,  6, "事件上报(工装发起)") \
+  X(PUSH_CTRL,       0xB4, PUSH_CTRL_ACK,       0xB5,  6, 18, "事件上报开关")  \
+  X(PROF,            0xB6, PROF_ACK,            0xB7,  6, 11, "CPU耗时剖析")   \
+  X(RAM_STATS,       0xB8, RAM_STATS_ACK,       0xB9,  5, 19, "RAM/栈水位")    \
+  X(TRACE,           0xA0, TRACE_ACK,           0xA1,  6,  7, "通讯录制")      \
+  X(BRIDGE,          0xA2, BRIDGE_ACK,          0xA3,  6, 22, "UART0/1透传")   \
+  X(IDLE_STATS,      0xA4, IDLE_STATS_ACK,      0xA5,  5, 30, "空闲/休眠统计") \
+  X(ADC_BENCH,       0xA6, ADC_BENCH_ACK,       0xA7,  6, 15, "ADC批量测量耗时") \
+  /* 测试控制 */                                                               \
+  X(START_TEST,      0x05, START_TEST_ACK,      0x85,  0,  0, "开始测试")      \
+  X(QUERY_RESULT,    0x01, RESULT_RESPONSE,     0x81,  0,  0, "查询测试结果")  \
+  X(SET_TIME,        0x04, SET_TIME_ACK,        0x84,  0,  0, "设置时间")      \
+  /* 配置 */                                                                   \
+  X(SET_CONFIG,      0xAE, SET_CONFIG_ACK,      0xAF,  9,  9, "设置日志/透传") \
+  /* 调试 */                                                                   \
+  X(QUERY_FAIL_STEP, 0xBE, QUERY_FAIL_STEP_ACK, 0xBF,  6,  0, "查询失败步骤")  \
+  /* 升级 */                                                                   \
+  X(UPGRADE,         0xBA, UPGRADE_ACK,         0xBB, 17, 11, "APP升级")       \
+  X(BANK_LOAD,       0xBC, BANK_LOAD_ACK,       0xBD,  7,  0, "后台下载到B区") \
+  /* 查询与控制 */                                                             \
+  X(QUERY_CONFIG,    0xC0, QUERY_CONFIG_ACK,    0xC1,  6, 42, "查询版本/编译时间") \
+  X(FT_CONTROL,      0xC2, FT_CONTROL_ACK,      0xC3, 36,  7, "控制工装功能")  \
+  X(HEARTBEAT,       0xC4, HEARTBEAT_ACK,       0xC5,  6,  6, "心跳")          \
+  X(RESET,           0xC6, RESET_ACK,           0xC7,  6,  7, "复位工装")      \
+  /* 诊断 (0xD0-0xDF) */                                                       \
+  X(FLASH_INFO,      0xD0, FLASH_INFO_ACK,      0xD1,  6,  0, "Flash分区信息") \
+  X(FLASH_READ,      0xD2, FLASH_READ_ACK,      0xD3,  0,  0, "读取Flash数据") \
+  X(TEST_STATS,      0xD4, TEST_STATS_ACK,      0xD5,  6,  0, "查询测试统计")  \
+  X(CONFIG_GET,      0xD6, CONFIG_GET_ACK,      0xD7,  7,  0, "批量读取配置")  \
+  X(CONFIG_SET,      0xD8, CONFIG_SET_ACK,      0xD9,  7,  8, "批量写入配置")  \
+  X(PLAN_LOAD,       0xDA, PLAN_LOAD_ACK,       0xDB,  6,  9, "下载测试计划")  \
+  X(PLAN_GET,        0xDC, PLAN_GET_ACK,        0xDD,  6,  0, "读取测试计划")  \
+  /* 测量准确度 (0xE0-0xEF) */                                                 \
+  X(GOLDEN,          0xE0, GOLDEN_ACK,          0xE1,  7,  0, "金样检测")      \
+  X(CALIB,           0xE2, CALIB_ACK,           0xE3,  7,  0, "测量校准")
+/* clang-format on */
+
+#endif /* __PC_CMD_DEF_H__ */
@@ -0,0 +1,101 @@
+/**
+ * @file pc_cmd_table.c
+ * @brief PC协议命令表查询与分发
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * @section intro 简介
+ * 由 pc_cmd_def.h 的 PC_CMD_TABLE 生成命令信息表和256项索引表，
+ * 命令码 -> 行号 -> 处理函数 都是数组下标访问，不再逐个 switch 比较。
+ * 命令码重复在本文件编译时报错 (见 pc_cmd_unique_check)。
+ */
+
+#define LOG_TAG "pc_cmd"
+
+#include "pc_protocol.h"
+#include <elog.h>
+
+/*============ 命令表 ============*/
+
+static const PCCmdInfo s_cmd_info[PC_CMD_SLOT_NUM] = {
+#define X(name, code, ack_name, ack_code, req_len, ack_len, desc)              \
+  [PC_CMD_SLOT_##name] = {code, ack_code, req_len, ack_len, #name},
+    PC_CMD_TABLE(X)
+#undef X
+};
+
+// 命令码 -> 行号+1 (0 表示未分配)，请求码和应答码都指向同一行
+static const uint8_t s_cmd_index[256] = {
+#define X(name, code, ack_name, ack_code, req_len, ack_len, desc)              \
+  [code] = PC_CMD_SLOT_##name + 1, [ack_code] = PC_CMD_SLOT_##name + 1,
+    PC_CMD_TABLE(X)
+#undef X
+};
+
+_Static_assert(PC_CMD_SLOT_NUM < 0xFF, "PC命令表行数超出索引表范围");
+
+/**
+ * @brief 命令码唯一性检查 (只用于编译期，不会被调用)
+ *
+ * 所有请求码和应答码展开为同一个 switch 的 case，
+ * 任意两个命令码相同时编译报 "duplicate case value"。
+ */
+static inline void pc_cmd_unique_check(uint8_t code) {
+  switch (code) {
+#define X(name, code, ack_name, ack_code, req_len, ack_len, desc)              \
+  case code:                                                                   \
+  case ack_code:
+    PC_CMD_TABLE(X)
+#undef X
+    break;
+  default:
+    break;
+  }
+}
+
+/*============ API实现 ============*/
+
+uint8_t PC_Cmd_GetSlot(uint8_t code) {
+  uint8_t slot = s_cmd_index[code];
+  return slot ? (uint8_t)(slot - 1) : PC_CMD_SLOT_NONE;
+}
+
+const PCCmdInfo *PC_Cmd_GetInfo(uint8_t code) {
+  uint8_t slot = PC_Cmd_GetSlot(code);
+  return (slot == PC_CMD_SLOT_NONE) ? NULL : &s_cmd_info[slot];
+}
+
+bool PC_Cmd_IsAck(uint8_t code) {
+  const PCCmdInfo *info = PC_Cmd_GetInfo(code);
+  return (info != NULL) && (info->ack_code == code);
+}
+
+uint8_t PC_Cmd_AckOf(uint8_t code) {
+  const PCCmdInfo *info = PC_Cmd_GetInfo(code);
+  if (info == NULL || info->code != code) {
+    return 0;
+  }
+  return info->ack_code;
+}
+
+ProtocolResult PC_Cmd_Dispatch(const PCCmdHandler *handlers, uint8_t code,
+                               const uint8_t *data, uint16_t len) {
+  uint8_t slot = PC_Cmd_GetSlot(code);
+
+  // 未分配的命令码，或应答码 (工装不处理上位机发来的应答)
+  if (slot == PC_CMD_SLOT_NONE || s_cmd_info[slot].code != code) {
+    return PROTOCOL_RESULT_UNKNOWN_CMD;
+  }
+  if (handlers[slot] == NULL) {
+    return PROTOCOL_RESULT_UNKNOWN_CMD;
+  }
+  if (len < s_cmd_info[slot].req_len) {
+    log_e("命令 %s(0x%02X) 帧长度错误: %d < %d", s_cmd_info[slot].name, code,
+          len, s_cmd_info[slot].req_len);
+    return PROTOCOL_RESULT_LENGTH_ERROR;
+  }
+
+  log_d("收到命令 %s(0x%02X)", s_cmd_info[slot].name, code);
+  handlers[slot](data, len);
+  return PROTOCOL_RESULT_OK;
+}
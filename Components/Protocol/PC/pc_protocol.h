@@ -13,6 +13,7 @@
 #define __PC_PROTOCOL_H__
 
 #include "../protocol_def.h"
+#include "pc_cmd_def.h"
 #include "utility.h"
 
 /*============ PC协议命令码定义 ============*/
@@ -20,50 +21,48 @@
 /**
  * @brief PC协议命令码枚举
  *
- * 定义上位机与测试工装之间的通信命令
+ * 定义上位机与测试工装之间的通信命令，由 pc_cmd_def.h 命令表生成。
+ * 新增命令请修改 PC_CMD_TABLE，不要在此手写命令码。
  */
 typedef enum {
-  // 测试控制命令
-  PC_CMD_START_TEST = 0x05,      // 开始测试
-  PC_CMD_START_TEST_ACK = 0x85,  // 开始测试应答
-  PC_CMD_QUERY_RESULT = 0x01,    // 查询测试结果
-  PC_CMD_RESULT_RESPONSE = 0x81, // 测试结果响应
-
-  // 配置命令
-  PC_CMD_SET_CONFIG = 0xAE,     // 设置配置(日志/透传模式)
-  PC_CMD_SET_CONFIG_ACK = 0xAF, // 设置配置应答
-
-  // 读取命令
-  PC_CMD_QUERY_CONFIG =
-      0xC0, // 查询命令，数据域暂时只有程序版本，编译时间，等等
-  PC_CMD_QUERY_CONFIG_ACK = 0xC1, // 查询命令应答
-  // 控制命令
-  PC_CMD_FT_CONTROL = 0xC2,     // 控制工装功能指令
-  PC_CMD_FT_CONTROL_ACK = 0xC3, // 控制工装功能应答
-  // 升级命令
-  PC_CMD_UPGRADE = 0xBA,     // 升级命令
-  PC_CMD_UPGRADE_ACK = 0xBB, // 升级应答
-
-  // 诊断命令 (0xD0-0xDF)
-  PC_CMD_FLASH_INFO = 0xD0,     // 查询Flash分区信息
-  PC_CMD_FLASH_INFO_ACK = 0xD1, // Flash信息应答
-  PC_CMD_FLASH_READ = 0xD2,     // 读取Flash数据
-  PC_CMD_FLASH_READ_ACK = 0xD3, // 读取应答
-  PC_CMD_TEST_STATS = 0xD4,     // 查询测试统计
-  PC_CMD_TEST_STATS_ACK = 0xD5, // 测试统计应答
-
-  // 控制工装的功能指令，比如检测低功耗，检测运行功耗，检测某个端口电压，开关膜表的电源等
-
-  // 调试命令 (0xBE-0xBF)
-  PC_CMD_QUERY_FAIL_STEP = 0xBE,     // 查询失败步骤
-  PC_CMD_QUERY_FAIL_STEP_ACK = 0xBF, // 失败步骤应答
-
-  // 其他命令
-  PC_CMD_HEARTBEAT = 0xC0, // 心跳
-  PC_CMD_RESET = 0xC1,     // 复位
-
+#define X(name, code, ack_name, ack_code, req_len, ack_len, desc)              \
+  PC_CMD_##name = code, PC_CMD_##ack_name = ack_code,
+  PC_CMD_TABLE(X)
+#undef X
 } PCProtocolCmd;
 
+/**
+ * @brief 命令表行号 (分发表下标)
+ */
+typedef enum {
+#define X(name, code, ack_name, ack_code, req_len, ack_len, desc)              \
+  PC_CMD_SLOT_##name,
+  PC_CMD_TABLE(X)
+#undef X
+  PC_CMD_SLOT_NUM
+} PCCmdSlot;
+
+/** 无效行号 (命令码未在命令表中分配) */
+#define PC_CMD_SLOT_NONE 0xFF
+
+/**
+ * @brief 命令信息 (命令表的一行)
+ */
+typedef struct {
+  uint8_t code;     // 请求码
+  uint8_t ack_code; // 应答码
+  uint8_t req_len;  // 请求最小帧长, 0=不检查
+  uint8_t ack_len;  // 应答帧长, 0=变长
+  const char *name; // 命令名称
+} PCCmdInfo;
+
+/**
+ * @brief 命令处理函数类型
+ * @param data 完整帧数据 (从帧头开始)
+ * @param len  帧长度
+ */
+typedef void (*PCCmdHandler)(const uint8_t *data, uint16_t len);
+
 /*============ PC协议数据结构 ============*/
 
 /**
@@ -235,7 +234,8 @@ extern const ProtocolInterface upgrade_pc_protocol;
  * @brief 公共调试配置协议实例
  *
  * 在 pc_protocol_config.c 中定义
- * 处理调试配置命令 (0xAE/0xAF) 和查询步骤 (0xBE/0xBF)
+ * 处理调试配置命令 (0xAE/0xAF)、查询步骤 (0xBE/0xBF)
+ * 和持久化配置批量读写 (0xD6-0xD9)
  * 此协议与具体表计类型无关，所有表计都可使用
  */
 extern const ProtocolInterface config_pc_protocol;
@@ -307,6 +307,51 @@ void PC_SendTestResult(void);
  */
 void PC_test_result_analysis(void);
 
+/*============ 命令表查询 ============*/
+
+/**
+ * @brief 按命令码查询行号 (查表, O(1))
+ * @param code 请求码或应答码
+ * @return 行号, 未分配的命令码返回 PC_CMD_SLOT_NONE
+ */
+uint8_t PC_Cmd_GetSlot(uint8_t code);
+
+/**
+ * @brief 按命令码查询命令信息
+ * @param code 请求码或应答码
+ * @return 命令信息, 未分配返回NULL
+ */
+const PCCmdInfo *PC_Cmd_GetInfo(uint8_t code);
+
+/**
+ * @brief 判断命令码是否为应答码
+ */
+bool PC_Cmd_IsAck(uint8_t code);
+
+/**
+ * @brief 查询请求对应的应答码
+ * @param code 请求码
+ * @return 应答码, 未分配或本身是应答码返回0
+ */
+uint8_t PC_Cmd_AckOf(uint8_t code);
+
+/**
+ * @brief 按分发表分发一帧
+ *
+ * 用命令码查表得到行号，再取协议自己的分发表中对应的处理函数，
+ * 并按命令表检查请求最小帧长。
+ *
+ * @param handlers 分发表, 以 PC_CMD_SLOT_xxx 为下标, 长度 PC_CMD_SLOT_NUM
+ * @param code 命令码 (不同帧格式命令码位置不同, 由调用者取出)
+ * @param data 完整帧数据
+ * @param len  帧长度
+ * @return PROTOCOL_RESULT_OK: 已处理
+ *         PROTOCOL_RESULT_UNKNOWN_CMD: 本协议不处理此命令
+ *         PROTOCOL_RESULT_LENGTH_ERROR: 帧长小于命令表要求 (已认领, 丢弃)
+ */
+ProtocolResult PC_Cmd_Dispatch(const PCCmdHandler *handlers, uint8_t code,
+                               const uint8_t *data, uint16_t len);
+
 /*============ 辅助函数 ============*/
 
 /**
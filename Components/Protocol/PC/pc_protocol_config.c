@@ -8,6 +8,10 @@
  * 实现通用的调试配置协议，包括：
  * - 设置调试模式和透传模式 (0xAE)
  * - 查询当前测试步骤 (0xBE)
+ * - 持久化配置批量读写 (0xD6/0xD8)，配置保存在 KVDB (jig_config)
+ * - 测试计划下载/读取 (0xDA/0xDC)，格式见 FlashDB/test_plan.h
+ * - 金样检测 (0xE0)，参考格式和判定见 FlashDB/golden_sample.h
+ * - 测量校准 (0xE2)，校准值格式见 FlashDB/meas_calib.h
  *
  * 这些配置命令与具体的表计类型无关，是调试用的公共协议。
  * 所有表计类型（水表、膜式气表、超声波气表等）都可以使用。
@@ -20,11 +24,66 @@
  * [步骤名称...] [原因长度] [原因名称...] [校验和] 16 测试状态: 0=进行中,
  * 1=成功, 2=失败 失败原因: 枚举值 (0=无失败)
  *
+ * 批量读取: 55 D6 [长度] [工位号] [N] [ID1..IDN] [校验和] AA  (N=0读取全部)
+ * 读取应答: 55 D7 [长度] [工位号] [N] {[ID] [类型] [值4字节小端]}*N [校验和] AA
+ * 批量写入: 55 D8 [长度] [工位号] [N] {[ID] [值4字节小端]}*N [校验和] AA
+ * 写入应答: 55 D9 08 [工位号] [状态] [出错下标] [校验和] AA
+ *
+ * 测试统计: 55 D4 06 [工位号] [校验和] AA              (段0)
+ *           55 D4 07 [工位号] [段号] [校验和] AA
+ * 统计应答: 55 D5 [长度] [工位号] [段号] [段数据...] [校验和] AA
+ *   段0 汇总: 总数/通过/失败(各4字节) 通过率x100(2) [N] 各步骤失败次数(2)*N
+ *   段1 耗时: [N] {[步骤] [次数2] [min4] [avg4] [max4] [p95_4]}*N
+ *             步骤0xFF为整个测试周期，单位us
+ *   段2 时间线: [总耗时4] [N] {[步骤] [起始偏移4] [耗时4]}*N (最近一次测试)
+ *   段FF: 清除耗时统计，应答无段数据
+ *
+ * 下载计划: 55 DA [长度] [工位号] [计划镜像...] [校验和] AA
+ *   工位号 FF 为整线广播, 不应答; 镜像为空表示删除, 恢复内置计划
+ * 下载应答: 55 DB 09 [工位号] [状态] [出错步骤] [计划状态] [校验和] AA
+ *   状态见 TestPlanResult, 计划状态 0=内置 1=下载的 2=下一次测试起生效
+ * 读取计划: 55 DC 06 [工位号] [校验和] AA
+ * 读取应答: 55 DD [长度] [工位号] [计划状态] [计划镜像...] [校验和] AA
+ *   镜像为下一次测试将使用的计划 (内置计划也按镜像格式返回, 版本为0)
+ *
+ * 金样检测: 55 E0 [长度] [工位号] [操作] [数据...] [校验和] AA
+ * 检测应答: 55 E1 [长度] [工位号] [操作] [状态] [数据...] [校验和] AA
+ *   状态见 GoldenResult, 操作:
+ *   0 状态: [检测状态] [需校准] [漂移] [连续超差] [检测次数2] [基线后次数2]
+ *           [金样编号2] [最近超差] [N] {[测量值4] [偏差2] [漂移估计2]}*N
+ *           检测状态 0=空闲 1=等待开始 2=测量中, 漂移估计为偏差的滤波值
+ *   1 启动检测: 工装空闲时开始, 完成后上报 PUSH_EVT_GOLDEN
+ *   2 下载参考: 数据为参考镜像, 为空表示删除
+ *   3 读取参考: 应答数据为参考镜像
+ *   4 趋势记录: [N] [M] {[序号2] [超差] [标志] [偏差2*N]}*M, 按时间顺序
+ *   5 清除标记: 重新校准后清除, 重新建立漂移基线
+ *
+ * 测量校准: 55 E2 [长度] [工位号] [操作] [数据...] [校验和] AA
+ * 校准应答: 55 E3 [长度] [工位号] [操作] [状态] [数据...] [校验和] AA
+ *   状态见 MeasCalResult, 通道顺序同金样检测, 操作:
+ *   0 状态: [采样状态] [已校准] [校准序号2] [N] {[增益4] [偏移2] [采样点]}*N
+ *           增益为Q14 (0=未校准, 按固定系数换算), 采样点为已采样的点掩码
+ *   1 采样: [点号] [通道掩码] {[参考值4]}*M, 参考值下标为通道号 (mV/功耗读数)
+ *           工装空闲时开始, 完成后上报 PUSH_EVT_CALIB
+ *   2 计算保存: [通道掩码], 应答 [出错通道]; 成功后清除金样检测的重新校准
+ *           标记并重新建立漂移基线
+ *   3 读取校准: 应答数据为校准镜像 (MES备份)
+ *   4 下载校准: 数据为校准镜像, 为空表示删除 (恢复固定系数), 应答 [出错通道]
+ *   5 采样点: [N] {[采样点] [原始值0 4] [参考值0 4] [原始值1 4] [参考值1 4]}*N
+ *           原始值 x16
+ *
  * @note 透传前导: 0=无前导(膜表), 1=有前导(水表)
+ * @note 0xAE 设置的调试/透传模式同时写入持久化配置，复位后保持
  */
 
 #define LOG_TAG "pc_config"
 
+#include "FlashDB/golden_sample.h"
+#include "FlashDB/jig_config.h"
+#include "FlashDB/meas_calib.h"
+#include "FlashDB/test_plan.h"
+#include "FlashDB/test_stats.h"
+#include "TimeManager/step_profiler.h"
 #include "pc_protocol.h"
 #include <elog.h>
 #include <stdio.h>
@@ -40,8 +99,14 @@ extern uint8_t PassThrough_Preamble;
 static ProtocolSendFunc s_send_func = NULL;
 static ProtocolEventCallback s_event_callback = NULL;
 
-// 发送缓冲区
-#define CONFIG_TX_BUF_SIZE 128
+// 发送缓冲区 (测试统计耗时段最长255字节)
+#define CONFIG_TX_BUF_SIZE 256
+
+// 批量读写单帧最大项数 (5字节头 + 6字节*N + 2字节尾 <= 发送缓冲区)
+#define CONFIG_BULK_MAX 16
+
+// 测试计划整线广播工位号
+#define PLAN_BROADCAST_STATION 0xFF
 static uint8_t s_tx_buffer[CONFIG_TX_BUF_SIZE];
 
 /*============ 协议帧结构 ============*/
@@ -109,7 +174,7 @@ typedef struct {
 // 功能：电源控制、功耗测试、电压采集、到位信号、霍尔控制等
 typedef struct {
   uint8_t head;       // [0] FT_FRAME_HEAD 帧头
-  uint8_t cmd;        // [1] 0xD0 命令
+  uint8_t cmd;        // [1] 0xC2 命令
   uint8_t length;     // [2] 帧长度 (36)
   uint8_t station_id; // [3] 工位号
 
@@ -161,7 +226,7 @@ typedef struct {
 //功能控制码响应
 typedef struct {
   uint8_t head;       // [0] FT_FRAME_HEAD 帧头
-  uint8_t cmd;        // [1] 0xD1 命令
+  uint8_t cmd;        // [1] 0xC3 命令
   uint8_t length;     // [2] 帧长度
   uint8_t station_id; // [3] 工位号
   uint8_t status;     // [4] 状态，0成功，1失败
@@ -185,11 +250,33 @@ static void handle_set_config(const uint8_t *data, uint16_t len);
 static void handle_query_config(const uint8_t *data, uint16_t len);
 static void handle_ft_control(const uint8_t *data, uint16_t len);
 static void handle_query_fail_step(const uint8_t *data, uint16_t len);
+static void handle_config_get(const uint8_t *data, uint16_t len);
+static void handle_config_set(const uint8_t *data, uint16_t len);
+static void handle_test_stats(const uint8_t *data, uint16_t len);
+static void handle_plan_load(const uint8_t *data, uint16_t len);
+static void handle_plan_get(const uint8_t *data, uint16_t len);
+static void handle_golden(const uint8_t *data, uint16_t len);
+static void handle_calib(const uint8_t *data, uint16_t len);
 
 // 响应发送函数
 static void send_config_ack(void);
 static void send_fail_step_response(void);
 
+// 命令分发表 (下标为命令表行号)
+static const PCCmdHandler s_handlers[PC_CMD_SLOT_NUM] = {
+    [PC_CMD_SLOT_QUERY_CONFIG] = handle_query_config,
+    [PC_CMD_SLOT_FT_CONTROL] = handle_ft_control,
+    [PC_CMD_SLOT_SET_CONFIG] = handle_set_config,
+    [PC_CMD_SLOT_QUERY_FAIL_STEP] = handle_query_fail_step,
+    [PC_CMD_SLOT_CONFIG_GET] = handle_config_get,
+    [PC_CMD_SLOT_CONFIG_SET] = handle_config_set,
+    [PC_CMD_SLOT_TEST_STATS] = handle_test_stats,
+    [PC_CMD_SLOT_PLAN_LOAD] = handle_plan_load,
+    [PC_CMD_SLOT_PLAN_GET] = handle_plan_get,
+    [PC_CMD_SLOT_GOLDEN] = handle_golden,
+    [PC_CMD_SLOT_CALIB] = handle_calib,
+};
+
 /*============ 协议接口实例 ============*/
 
 const ProtocolInterface config_pc_protocol = {
@@ -238,34 +325,15 @@ static ProtocolResult config_parse(uint8_t *data, uint16_t len) {
       continue;
     }
 
-    // 处理配置相关命令
-    switch (cmd) {
-    case PC_CMD_QUERY_CONFIG: // 0xC0
-      log_d("收到查询配置命令");
-      handle_query_config(&data[pos], frame_len);
-      handled = true;
-      break;
-    case PC_CMD_FT_CONTROL: // 0x
-      log_d("收到FT控制命令");
-      handle_ft_control(&data[pos], frame_len);
-      handled = true;
-      break;
-    case PC_CMD_SET_CONFIG: // 0xAE
-      log_d("收到设置配置命令");
-      handle_set_config(&data[pos], frame_len);
-      handled = true;
-      break;
-
-    case PC_CMD_QUERY_FAIL_STEP: // 0xBE
-      log_d("收到查询失败步骤命令");
-      handle_query_fail_step(&data[pos], frame_len);
-      handled = true;
-      break;
-
-    default:
+    // 处理配置相关命令 (按命令表行号查分发表)
+    ProtocolResult result =
+        PC_Cmd_Dispatch(s_handlers, cmd, &data[pos], frame_len);
+    if (result == PROTOCOL_RESULT_UNKNOWN_CMD) {
       // 非配置命令，让其他协议处理
       return PROTOCOL_RESULT_UNKNOWN_CMD;
     }
+    // 长度错误的帧已认领，直接丢弃
+    handled = true;
 
     pos += frame_len;
   }
@@ -361,6 +429,15 @@ static void handle_set_config(const uint8_t *data, uint16_t len) {
         PassThrough_Preamble ? "有" : "无");
   log_i("+----------------------------------------------+");
 
+  // 写入持久化配置, 复位后保持
+  const uint8_t ids[3] = {JIG_CFG_DEBUG_MODE, JIG_CFG_PASSTHROUGH_MODE,
+                          JIG_CFG_PASSTHROUGH_PREAMBLE};
+  const int32_t values[3] = {Debug_Mode, PassThrough_Mode,
+                             PassThrough_Preamble};
+  if (JigConfig_SetBulk(ids, values, 3, NULL) != JIG_CFG_OK) {
+    log_w("调试配置未能保存到Flash");
+  }
+
   // 发送应答
   send_config_ack();
 
@@ -722,6 +799,593 @@ static void handle_query_fail_step(const uint8_t *data, uint16_t len) {
   }
 }
 
+/**
+ * @brief 校验工位号和累加和 (批量配置/测试统计命令公共部分)
+ * @return true: 校验通过
+ */
+static bool check_config_frame(const uint8_t *data, uint16_t len) {
+  if (len < 6) {
+    log_e("配置帧长度错误: %d < 6", len);
+    return false;
+  }
+
+  uint8_t station = data[3];
+  uint8_t local_station = PC_Protocol_GetStationId();
+  if (station != local_station) {
+    log_d("工位不匹配: 收到%d, 本机%d", station, local_station);
+    return false;
+  }
+
+  uint8_t calc_sum = 0;
+  for (uint16_t i = 0; i < len - 2; i++) {
+    calc_sum += data[i];
+  }
+  if (calc_sum != data[len - 2]) {
+    log_e("配置帧校验和错误");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief 处理批量读取配置命令 (0xD6)
+ *
+ * 协议格式:
+ *   请求: 55 D6 [长度] [工位号] [N] [ID1..IDN] [校验和] AA   (N=0 读取全部)
+ *   响应: 55 D7 [长度] [工位号] [N] {[ID] [类型] [值4字节小端]}*N [校验和] AA
+ *   无效ID的类型返回0xFF
+ *
+ * @param data 帧数据
+ * @param len  帧长度
+ */
+static void handle_config_get(const uint8_t *data, uint16_t len) {
+  if (!check_config_frame(data, len)) {
+    return;
+  }
+
+  uint8_t count = data[4];
+  bool all = (count == 0);
+  if (all) {
+    count = JIG_CFG_NUM;
+  }
+  if (count > CONFIG_BULK_MAX || (!all && 5 + count + 2 > len)) {
+    log_e("批量读取项数错误: %d", count);
+    return;
+  }
+
+  uint16_t pos = 0;
+  s_tx_buffer[pos++] = FT_FRAME_HEAD;
+  s_tx_buffer[pos++] = PC_CMD_CONFIG_GET_ACK; // 0xD7
+  s_tx_buffer[pos++] = 0;                     // 长度占位
+  s_tx_buffer[pos++] = PC_Protocol_GetStationId();
+  s_tx_buffer[pos++] = count;
+
+  for (uint8_t i = 0; i < count; i++) {
+    uint8_t id = all ? i : data[5 + i];
+    int32_t value = 0;
+    uint8_t type = 0xFF;
+    if (id < JIG_CFG_NUM) {
+      value = JigConfig_Get((JigConfigId)id);
+      type = JigConfig_GetType((JigConfigId)id);
+    }
+    s_tx_buffer[pos++] = id;
+    s_tx_buffer[pos++] = type;
+    s_tx_buffer[pos++] = value & 0xFF;
+    s_tx_buffer[pos++] = (value >> 8) & 0xFF;
+    s_tx_buffer[pos++] = (value >> 16) & 0xFF;
+    s_tx_buffer[pos++] = (value >> 24) & 0xFF;
+  }
+
+  s_tx_buffer[2] = pos + 2; // 加上校验和和帧尾
+  s_tx_buffer[pos] = pc_calc_checksum(s_tx_buffer, pos);
+  pos++;
+  s_tx_buffer[pos++] = FT_FRAME_TAIL;
+
+  log_d("发送批量读取应答: %d项", count);
+
+  if (s_send_func != NULL) {
+    s_send_func(s_tx_buffer, pos);
+  }
+}
+
+/**
+ * @brief 处理批量写入配置命令 (0xD8)
+ *
+ * 协议格式:
+ *   请求: 55 D8 [长度] [工位号] [N] {[ID] [值4字节小端]}*N [校验和] AA
+ *   响应: 55 D9 08 [工位号] [状态] [出错下标] [校验和] AA
+ *   状态: 0=成功, 1=无效ID, 2=超出范围, 3=Flash写入失败, 4=仅缓存生效
+ *   任一项校验失败时全部不写入
+ *
+ * @param data 帧数据
+ * @param len  帧长度
+ */
+static void handle_config_set(const uint8_t *data, uint16_t len) {
+  uint8_t ids[CONFIG_BULK_MAX];
+  int32_t values[CONFIG_BULK_MAX];
+  uint8_t failed_index = 0xFF;
+
+  if (!check_config_frame(data, len)) {
+    return;
+  }
+
+  uint8_t count = data[4];
+  if (count == 0 || count > CONFIG_BULK_MAX || 5 + count * 5 + 2 > len) {
+    log_e("批量写入项数错误: %d", count);
+    return;
+  }
+
+  for (uint8_t i = 0; i < count; i++) {
+    const uint8_t *p = &data[5 + i * 5];
+    ids[i] = p[0];
+    values[i] = (int32_t)((uint32_t)p[1] | ((uint32_t)p[2] << 8) |
+                          ((uint32_t)p[3] << 16) | ((uint32_t)p[4] << 24));
+  }
+
+  JigConfigResult result =
+      JigConfig_SetBulk(ids, values, count, &failed_index);
+  if (result != JIG_CFG_OK) {
+    log_w("批量写入配置失败: 状态=%d, 下标=%d", result, failed_index);
+  } else {
+    log_i("批量写入配置 %d 项", count);
+    failed_index = 0xFF;
+  }
+
+  uint16_t pos = 0;
+  s_tx_buffer[pos++] = FT_FRAME_HEAD;
+  s_tx_buffer[pos++] = PC_CMD_CONFIG_SET_ACK; // 0xD9
+  s_tx_buffer[pos++] = 8;
+  s_tx_buffer[pos++] = PC_Protocol_GetStationId();
+  s_tx_buffer[pos++] = (uint8_t)result;
+  s_tx_buffer[pos++] = failed_index;
+  s_tx_buffer[pos] = pc_calc_checksum(s_tx_buffer, pos);
+  pos++;
+  s_tx_buffer[pos++] = FT_FRAME_TAIL;
+
+  if (s_send_func != NULL) {
+    s_send_func(s_tx_buffer, pos);
+  }
+}
+
+/**
+ * @brief 写入一项耗时统计 (测试统计段1)
+ */
+static uint16_t put_step_timing(uint16_t pos, uint8_t step,
+                                const StepProfSummary_t *sum) {
+  s_tx_buffer[pos++] = step;
+  util_write_le_u16(&s_tx_buffer[pos],
+                    sum->count > 0xFFFF ? 0xFFFF : (uint16_t)sum->count);
+  pos += 2;
+  util_write_le_u32(&s_tx_buffer[pos], sum->min_us);
+  util_write_le_u32(&s_tx_buffer[pos + 4], sum->avg_us);
+  util_write_le_u32(&s_tx_buffer[pos + 8], sum->max_us);
+  util_write_le_u32(&s_tx_buffer[pos + 12], sum->p95_us);
+  return pos + 16;
+}
+
+/**
+ * @brief 处理测试统计查询命令 (0xD4)
+ *
+ * 协议格式见文件头。段0来自Flash中的测试统计，段1/2来自RAM中的步骤耗时
+ * 剖析 (step_profiler)，复位后清零。
+ *
+ * @param data 帧数据
+ * @param len  帧长度
+ */
+static void handle_test_stats(const uint8_t *data, uint16_t len) {
+  if (!check_config_frame(data, len)) {
+    return;
+  }
+
+  uint8_t section = (len >= 7) ? data[4] : 0;
+  uint16_t pos = 0;
+  s_tx_buffer[pos++] = FT_FRAME_HEAD;
+  s_tx_buffer[pos++] = PC_CMD_TEST_STATS_ACK; // 0xD5
+  s_tx_buffer[pos++] = 0;                     // 长度，最后填写
+  s_tx_buffer[pos++] = PC_Protocol_GetStationId();
+  s_tx_buffer[pos++] = section;
+
+  switch (section) {
+  case 0: {
+    TestStatsSummary_t summary;
+    if (!TestStats_GetSummary(&summary)) {
+      memset(&summary, 0, sizeof(summary));
+    }
+    util_write_le_u32(&s_tx_buffer[pos], summary.total_tests);
+    util_write_le_u32(&s_tx_buffer[pos + 4], summary.total_pass);
+    util_write_le_u32(&s_tx_buffer[pos + 8], summary.total_fail);
+    util_write_le_u16(&s_tx_buffer[pos + 12],
+                      (uint16_t)TestStats_GetPassRate());
+    pos += 14;
+    s_tx_buffer[pos++] = TEST_STATS_MAX_STEPS;
+    for (uint8_t i = 0; i < TEST_STATS_MAX_STEPS; i++) {
+      uint32_t n = summary.step_fail_count[i];
+      util_write_le_u16(&s_tx_buffer[pos], n > 0xFFFF ? 0xFFFF : (uint16_t)n);
+      pos += 2;
+    }
+    break;
+  }
+
+  case 1: {
+    StepProfSummary_t sum;
+    uint16_t count_pos = pos++;
+    uint8_t count = 0;
+
+    StepProf_GetCycle(&sum);
+    pos = put_step_timing(pos, STEP_PROF_NONE, &sum);
+    count++;
+    for (uint8_t i = 0; i < STEP_PROF_MAX_STEPS; i++) {
+      if (StepProf_GetStep(i, &sum) && sum.count > 0) {
+        pos = put_step_timing(pos, i, &sum);
+        count++;
+      }
+    }
+    s_tx_buffer[count_pos] = count;
+    break;
+  }
+
+  case 2: {
+    const StepProfTimeline_t *tl = StepProf_GetTimeline();
+    util_write_le_u32(&s_tx_buffer[pos], tl->total_us);
+    pos += 4;
+    s_tx_buffer[pos++] = tl->count;
+    for (uint8_t i = 0; i < tl->count; i++) {
+      s_tx_buffer[pos++] = tl->segments[i].step;
+      util_write_le_u32(&s_tx_buffer[pos], tl->segments[i].start_us);
+      util_write_le_u32(&s_tx_buffer[pos + 4], tl->segments[i].dur_us);
+      pos += 8;
+    }
+    break;
+  }
+
+  case 0xFF:
+    StepProf_Reset();
+    log_i("步骤耗时统计已清除");
+    break;
+
+  default:
+    log_w("未知测试统计段: %d", section);
+    return;
+  }
+
+  s_tx_buffer[2] = pos + 2; // 加上校验和和帧尾
+  s_tx_buffer[pos] = pc_calc_checksum(s_tx_buffer, pos);
+  pos++;
+  s_tx_buffer[pos++] = FT_FRAME_TAIL;
+
+  if (s_send_func != NULL) {
+    s_send_func(s_tx_buffer, pos);
+  }
+}
+
+/**
+ * @brief 处理测试计划下载命令 (0xDA)
+ *
+ * 校验、保存后下一次测试开始时生效，进行中的测试继续使用原计划。
+ * 整线广播时各工位不应答，MES 再用 0xDC 逐个核对版本和CRC，
+ * 对未收到的工位单独补发。
+ *
+ * @param data 帧数据
+ * @param len  帧长度
+ */
+static void handle_plan_load(const uint8_t *data, uint16_t len) {
+  bool broadcast = data[3] == PLAN_BROADCAST_STATION;
+  uint8_t bad_step = 0xFF;
+
+  if (!broadcast && data[3] != PC_Protocol_GetStationId()) {
+    log_d("工位不匹配: 收到%d, 本机%d", data[3], PC_Protocol_GetStationId());
+    return;
+  }
+  if (pc_calc_checksum(data, len - 2) != data[len - 2]) {
+    log_e("测试计划帧校验和错误");
+    return;
+  }
+
+  TestPlanResult result = TestPlan_Load(&data[4], len - 6, &bad_step);
+  if (broadcast) {
+    return;
+  }
+
+  uint16_t pos = 0;
+  s_tx_buffer[pos++] = FT_FRAME_HEAD;
+  s_tx_buffer[pos++] = PC_CMD_PLAN_LOAD_ACK; // 0xDB
+  s_tx_buffer[pos++] = 9;
+  s_tx_buffer[pos++] = PC_Protocol_GetStationId();
+  s_tx_buffer[pos++] = (uint8_t)result;
+  s_tx_buffer[pos++] = bad_step;
+  s_tx_buffer[pos++] = (uint8_t)TestPlan_GetState();
+  s_tx_buffer[pos] = pc_calc_checksum(s_tx_buffer, pos);
+  pos++;
+  s_tx_buffer[pos++] = FT_FRAME_TAIL;
+
+  if (s_send_func != NULL) {
+    s_send_func(s_tx_buffer, pos);
+  }
+}
+
+/**
+ * @brief 处理测试计划读取命令 (0xDC)
+ *
+ * @param data 帧数据
+ * @param len  帧长度
+ */
+static void handle_plan_get(const uint8_t *data, uint16_t len) {
+  if (!check_config_frame(data, len)) {
+    return;
+  }
+
+  uint16_t pos = 0;
+  s_tx_buffer[pos++] = FT_FRAME_HEAD;
+  s_tx_buffer[pos++] = PC_CMD_PLAN_GET_ACK; // 0xDD
+  s_tx_buffer[pos++] = 0;                   // 长度，最后填写
+  s_tx_buffer[pos++] = PC_Protocol_GetStationId();
+  s_tx_buffer[pos++] = (uint8_t)TestPlan_GetState();
+  pos += TestPlan_ReadNext(&s_tx_buffer[pos], CONFIG_TX_BUF_SIZE - pos - 2);
+
+  s_tx_buffer[2] = pos + 2; // 加上校验和和帧尾
+  s_tx_buffer[pos] = pc_calc_checksum(s_tx_buffer, pos);
+  pos++;
+  s_tx_buffer[pos++] = FT_FRAME_TAIL;
+
+  if (s_send_func != NULL) {
+    s_send_func(s_tx_buffer, pos);
+  }
+}
+
+/**
+ * @brief 写入金样检测状态 (操作0)
+ */
+static uint16_t put_golden_status(uint16_t pos) {
+  const GoldenRef *ref = GoldenSample_Ref();
+  const GoldenTrend *trend = GoldenSample_GetTrend();
+  const GoldenRecord *last =
+      &trend->rec[(trend->head + GOLDEN_TREND_NUM - 1) % GOLDEN_TREND_NUM];
+  const int32_t *values = GoldenSample_LastValues();
+
+  if (trend->count == 0) {
+    last = NULL;
+  }
+  s_tx_buffer[pos++] = (uint8_t)GoldenSample_GetState();
+  s_tx_buffer[pos++] = GoldenSample_RecalMask();
+  s_tx_buffer[pos++] = trend->drift_mask;
+  s_tx_buffer[pos++] = trend->tol_mask;
+  util_write_le_u16(&s_tx_buffer[pos], trend->runs);
+  util_write_le_u16(&s_tx_buffer[pos + 2], trend->since);
+  util_write_le_u16(&s_tx_buffer[pos + 4], ref->sample_id);
+  pos += 6;
+  s_tx_buffer[pos++] = last != NULL ? last->fail : 0;
+  s_tx_buffer[pos++] = ref->count;
+  for (uint8_t i = 0; i < ref->count; i++) {
+    int32_t ewma = trend->ewma[i];
+    util_write_le_u32(&s_tx_buffer[pos], (uint32_t)values[i]);
+    util_write_le_u16(&s_tx_buffer[pos + 4],
+                      last != NULL ? (uint16_t)last->dev[i] : 0);
+    util_write_le_u16(&s_tx_buffer[pos + 6],
+                      (uint16_t)(int16_t)((ewma + (ewma < 0 ? -8 : 8)) / 16));
+    pos += 8;
+  }
+  return pos;
+}
+
+/**
+ * @brief 写入金样检测趋势记录 (操作4)
+ */
+static uint16_t put_golden_trend(uint16_t pos) {
+  const GoldenTrend *trend = GoldenSample_GetTrend();
+  uint8_t n = GoldenSample_Ref()->count;
+
+  s_tx_buffer[pos++] = n;
+  s_tx_buffer[pos++] = trend->count;
+  for (uint8_t i = 0; i < trend->count; i++) {
+    const GoldenRecord *r =
+        &trend->rec[(trend->head + GOLDEN_TREND_NUM - trend->count + i) %
+                    GOLDEN_TREND_NUM];
+    util_write_le_u16(&s_tx_buffer[pos], r->run);
+    s_tx_buffer[pos + 2] = r->fail;
+    s_tx_buffer[pos + 3] = r->flags;
+    pos += 4;
+    for (uint8_t c = 0; c < n; c++) {
+      util_write_le_u16(&s_tx_buffer[pos], (uint16_t)r->dev[c]);
+      pos += 2;
+    }
+  }
+  return pos;
+}
+
+/**
+ * @brief 处理金样检测命令 (0xE0)
+ *
+ * 测量在主循环中由 Src/Golden_Ctrl.c 完成 (需要等待供电稳定, 功耗测量
+ * 阻塞约2.5秒)，本命令只发起请求，结果通过上报事件或状态查询取得。
+ *
+ * @param data 帧数据
+ * @param len  帧长度
+ */
+static void handle_golden(const uint8_t *data, uint16_t len) {
+  if (!check_config_frame(data, len) || len < 7) {
+    return;
+  }
+
+  uint8_t op = data[4];
+  GoldenResult result = GOLDEN_OK;
+  uint16_t pos = 0;
+  s_tx_buffer[pos++] = FT_FRAME_HEAD;
+  s_tx_buffer[pos++] = PC_CMD_GOLDEN_ACK; // 0xE1
+  s_tx_buffer[pos++] = 0;                 // 长度，最后填写
+  s_tx_buffer[pos++] = PC_Protocol_GetStationId();
+  s_tx_buffer[pos++] = op;
+  uint16_t status_pos = pos++;
+
+  switch (op) {
+  case 0:
+    if (GoldenSample_Ref()->count == 0) {
+      result = GOLDEN_ERR_NOREF;
+    }
+    pos = put_golden_status(pos);
+    break;
+
+  case 1:
+    result = GoldenSample_Request();
+    break;
+
+  case 2:
+    result = GoldenSample_SetRef(&data[5], len - 7);
+    break;
+
+  case 3:
+    pos += GoldenSample_GetRef(&s_tx_buffer[pos], CONFIG_TX_BUF_SIZE - pos - 2);
+    if (pos == status_pos + 1) {
+      result = GOLDEN_ERR_NOREF;
+    }
+    break;
+
+  case 4:
+    pos = put_golden_trend(pos);
+    break;
+
+  case 5:
+    result = GoldenSample_ClearRecal();
+    break;
+
+  default:
+    log_w("未知金样检测操作: %d", op);
+    return;
+  }
+  s_tx_buffer[status_pos] = (uint8_t)result;
+
+  s_tx_buffer[2] = pos + 2; // 加上校验和和帧尾
+  s_tx_buffer[pos] = pc_calc_checksum(s_tx_buffer, pos);
+  pos++;
+  s_tx_buffer[pos++] = FT_FRAME_TAIL;
+
+  if (s_send_func != NULL) {
+    s_send_func(s_tx_buffer, pos);
+  }
+}
+
+/**
+ * @brief 写入测量校准状态 (操作0)
+ */
+static uint16_t put_calib_status(uint16_t pos, uint8_t n) {
+  s_tx_buffer[pos++] = (uint8_t)MeasCalib_GetState();
+  s_tx_buffer[pos++] = MeasCalib_ValidMask();
+  util_write_le_u16(&s_tx_buffer[pos], MeasCalib_Seq());
+  pos += 2;
+  s_tx_buffer[pos++] = n;
+  for (uint8_t i = 0; i < n; i++) {
+    const MeasCalChannel *c = MeasCalib_Get(i);
+    util_write_le_u32(&s_tx_buffer[pos], c->gain);
+    util_write_le_u16(&s_tx_buffer[pos + 4], (uint16_t)c->offset);
+    s_tx_buffer[pos + 6] = MeasCalib_GetPoint(i)->mask;
+    pos += 7;
+  }
+  return pos;
+}
+
+/**
+ * @brief 写入测量校准采样点 (操作5)
+ */
+static uint16_t put_calib_points(uint16_t pos, uint8_t n) {
+  s_tx_buffer[pos++] = n;
+  for (uint8_t i = 0; i < n; i++) {
+    const MeasCalPoint *p = MeasCalib_GetPoint(i);
+    s_tx_buffer[pos++] = p->mask;
+    for (uint8_t k = 0; k < MEASCAL_POINT_NUM; k++) {
+      util_write_le_u32(&s_tx_buffer[pos], (uint32_t)p->raw[k]);
+      util_write_le_u32(&s_tx_buffer[pos + 4], (uint32_t)p->ref[k]);
+      pos += 8;
+    }
+  }
+  return pos;
+}
+
+/**
+ * @brief 处理测量校准命令 (0xE2)
+ *
+ * 采样在主循环中由 Src/Calib_Ctrl.c 完成 (需要等待供电稳定, 功耗采样
+ * 阻塞约2.5秒)，本命令只发起请求；计算、读取和下载校准值直接应答。
+ *
+ * @param data 帧数据
+ * @param len  帧长度
+ */
+static void handle_calib(const uint8_t *data, uint16_t len) {
+  if (!check_config_frame(data, len) || len < 7) {
+    return;
+  }
+
+  uint8_t op = data[4];
+  uint8_t n = MeasCalib_Count();
+  uint8_t bad = 0xFF;
+  MeasCalResult result = MEASCAL_OK;
+  uint16_t pos = 0;
+  s_tx_buffer[pos++] = FT_FRAME_HEAD;
+  s_tx_buffer[pos++] = PC_CMD_CALIB_ACK; // 0xE3
+  s_tx_buffer[pos++] = 0;                // 长度，最后填写
+  s_tx_buffer[pos++] = PC_Protocol_GetStationId();
+  s_tx_buffer[pos++] = op;
+  uint16_t status_pos = pos++;
+
+  switch (op) {
+  case 0:
+    pos = put_calib_status(pos, n);
+    break;
+
+  case 1: {
+    int32_t refs[MEASCAL_MAX_CH];
+    uint8_t m;
+
+    if (len < 9 || (len - 9) % 4 != 0 || (len - 9) / 4 > MEASCAL_MAX_CH) {
+      result = MEASCAL_ERR_PARAM;
+      break;
+    }
+    m = (uint8_t)((len - 9) / 4);
+    for (uint8_t i = 0; i < m; i++) {
+      refs[i] = (int32_t)util_read_le_u32(&data[7 + i * 4]);
+    }
+    result = MeasCalib_Request(data[5], data[6], refs, m);
+    break;
+  }
+
+  case 2:
+    result = len < 8 ? MEASCAL_ERR_PARAM : MeasCalib_Commit(data[5], &bad);
+    s_tx_buffer[pos++] = bad;
+    break;
+
+  case 3:
+    pos += MeasCalib_GetImage(&s_tx_buffer[pos], CONFIG_TX_BUF_SIZE - pos - 2);
+    break;
+
+  case 4:
+    result = MeasCalib_SetImage(&data[5], len - 7, &bad);
+    s_tx_buffer[pos++] = bad;
+    break;
+
+  case 5:
+    pos = put_calib_points(pos, n);
+    break;
+
+  default:
+    log_w("未知测量校准操作: %d", op);
+    return;
+  }
+  s_tx_buffer[status_pos] = (uint8_t)result;
+
+  /* 校准值变化后金样检测的漂移基线失效 (保存失败时RAM中也已生效) */
+  if ((op == 2 || op == 4) &&
+      (result == MEASCAL_OK || result == MEASCAL_ERR_FLASH)) {
+    GoldenSample_ClearRecal();
+  }
+
+  s_tx_buffer[2] = pos + 2; // 加上校验和和帧尾
+  s_tx_buffer[pos] = pc_calc_checksum(s_tx_buffer, pos);
+  pos++;
+  s_tx_buffer[pos++] = FT_FRAME_TAIL;
+
+  if (s_send_func != NULL) {
+    s_send_func(s_tx_buffer, pos);
+  }
+}
+
 /*============ 响应发送实现 ============*/
 
 /**
@@ -1,13 +1,16 @@
 /**
  * @file pc_protocol_upgrade.c
  * @brief APP升级协议实现 (带魔数验证)
- * @version 2.0.0
- * @date 2026-01-05
+ * @version 2.3.0
+ * @date 2026-10-16
  *
  * @section intro 简介
  * 实现APP固件升级相关的协议处理。
  * 支持手动模式和自动模式升级。
  * v2.0.0: 添加4字节魔数验证，支持多芯片平台
+ * v2.1.0: 后台下载到B区 (0xBC)，测试间隙分块接收，停产只需一次短重启
+ * v2.2.0: 0xBC 增加差分下载子命令，由当前APP + 差分包还原新固件 (upgrade_delta.h)
+ * v2.3.0: 0xBC 增加广播分块下载和缺块查询，一次发送升级整条总线的工位
  *
  * @section protocol 协议格式
  * 升级命令 (0xBA):
@@ -34,10 +37,36 @@
  *   状态: 0x00=准备就绪, 0x01=参数错误, 0x02=忙, 0x03=固件超限, 0x04=魔数错误
  *   校验和: 累加和
  *   帧尾: 0x16
+ *
+ * 后台下载 (0xBC, 见 upgrade_bank.h), 多字节字段均为小端:
+ *   开始: 55 BC 17 [工位] 00 [魔数4] [大小4] [CRC32 4] [版本4] [校验和] AA
+ *   数据: 55 BC [长度] [工位] 01 [偏移4] [数据1-128] [校验和] AA
+ *   查询: 55 BC 07 [工位] 02 [校验和] AA
+ *   提交: 55 BC 08 [工位] 03 [复位] [校验和] AA
+ *         复位: 0=下次复位时切换, 1=应答后立即复位切换
+ *   取消: 55 BC 07 [工位] 04 [校验和] AA
+ *   差分开始: 55 BC 1F [工位] 05 [魔数4] [旧大小4] [旧CRC32 4] [新大小4]
+ *             [新CRC32 4] [版本4] [校验和] AA
+ *   差分数据: 55 BC [长度] [工位] 06 [差分包偏移4] [数据1-128] [校验和] AA
+ *   差分下载时应答中的"下一偏移"为差分包偏移; 还原完后同样用"提交"切换
+ *   分块开始: 55 BC 17 [工位/FF] 07 [魔数4] [大小4] [CRC32 4] [版本4] [校验和] AA
+ *   分块数据: 55 BC [长度] [工位/FF] 08 [块号2] [数据, 每块128, 最后一块可不满] [校验和] AA
+ *             工位号 0xFF 为广播, 所有工位写入且都不应答
+ *   缺块查询: 55 BC 09 [工位] 09 [起始块号2] [校验和] AA
+ *   缺块应答: 55 BD 1D [工位] 09 [状态] [下载状态] [缺块总数2] [起始块号2]
+ *             [位图16: 起始块起128块, 位=1表示缺] [校验和] AA
+ *   上位机广播全部块后逐个工位查询缺块, 广播各工位缺块的并集, 直到都收齐,
+ *   再逐个工位"提交", 提交的回读CRC32 通过才算该工位升级完成;
+ *   正在测试的工位丢弃广播块 (不写Flash), 在缺块查询中报缺, 由下一轮补发
+ *   应答: 55 BD 0D [工位] [子命令] [状态] [下载状态] [下一偏移4] [校验和] AA
+ *   状态见 UpgradeBankResult; 忙 (测试中) 或偏移错误时上位机从"下一偏移"重发,
+ *   差分数据成功但"下一偏移"小于本块末尾 (单次输出达到上限) 时也从那里继续
  */
 
 #define LOG_TAG "pc_upgrade"
 
+#include "../upgrade_bank.h"
+#include "../upgrade_delta.h"
 #include "../upgrade_magic.h"
 #include "Utility/utility.h"
 #include "pc_protocol.h"
@@ -99,6 +128,32 @@ _Static_assert(sizeof(UpgradeCommandFrame) == 17,
 _Static_assert(sizeof(UpgradeResponseFrame) == 11,
                "UpgradeResponseFrame size error! Expected 11 bytes");
 
+/*============ 后台下载 (0xBC) ============*/
+
+typedef enum {
+  BANK_SUB_BEGIN = 0x00,
+  BANK_SUB_DATA = 0x01,
+  BANK_SUB_STATUS = 0x02,
+  BANK_SUB_COMMIT = 0x03,
+  BANK_SUB_ABORT = 0x04,
+  BANK_SUB_DELTA_BEGIN = 0x05,
+  BANK_SUB_DELTA_DATA = 0x06,
+  BANK_SUB_BLOCK_BEGIN = 0x07,
+  BANK_SUB_BLOCK_DATA = 0x08,
+  BANK_SUB_MISSING = 0x09,
+} BankLoadSub;
+
+// 帧头3字节 + 工位 + 子命令, 参数从 [5] 开始
+#define BANK_PARAM_POS 5
+// 帧头5字节 + 校验和 + 帧尾
+#define BANK_FRAME_OVERHEAD 7
+#define BANK_ACK_LEN 13
+// 广播工位号 (只用于分块开始/分块数据)
+#define BANK_BROADCAST_STATION 0xFF
+// 缺块应答: 一次带128块的位图
+#define BANK_MISSING_WINDOW 128
+#define BANK_MISSING_ACK_LEN (13 + BANK_MISSING_WINDOW / 8)
+
 /*============ 升级状态码 ============*/
 
 typedef enum {
@@ -135,6 +190,15 @@ static void upgrade_set_event_callback(ProtocolEventCallback callback);
 // 内部处理函数
 static void handle_upgrade_command(const uint8_t *data, uint16_t len);
 static void send_upgrade_response(uint8_t status);
+static void handle_bank_load(const uint8_t *data, uint16_t len);
+static void send_bank_response(uint8_t sub, uint8_t status);
+static void send_missing_response(uint16_t from);
+
+// 命令分发表 (下标为命令表行号)
+static const PCCmdHandler s_handlers[PC_CMD_SLOT_NUM] = {
+    [PC_CMD_SLOT_UPGRADE] = handle_upgrade_command,
+    [PC_CMD_SLOT_BANK_LOAD] = handle_bank_load,
+};
 
 /*============ 协议接口实例 ============*/
 
@@ -188,10 +252,14 @@ static ProtocolResult upgrade_parse(uint8_t *data, uint16_t len) {
       continue;
     }
 
-    // 只处理升级命令 0xBA
-    if (cmd == PC_CMD_UPGRADE) {
-      log_i("收到升级命令");
-      handle_upgrade_command(&data[pos], frame_len);
+    // 只处理升级命令 0xBA 和后台下载 0xBC (按命令表行号查分发表)
+    ProtocolResult result =
+        PC_Cmd_Dispatch(s_handlers, cmd, &data[pos], frame_len);
+    if (result == PROTOCOL_RESULT_LENGTH_ERROR && cmd == PC_CMD_UPGRADE) {
+      // 升级命令帧长不足时也要应答, 上位机据此停止等待
+      send_upgrade_response(UPGRADE_STATUS_PARAM_ERROR);
+    }
+    if (result != PROTOCOL_RESULT_UNKNOWN_CMD) {
       handled = true;
     }
 
@@ -235,6 +303,7 @@ static void upgrade_set_event_callback(ProtocolEventCallback callback) {
  * @brief 处理升级命令 (带魔数验证)
  */
 static void handle_upgrade_command(const uint8_t *data, uint16_t len) {
+  log_i("收到升级命令");
   if (len < sizeof(UpgradeCommandFrame)) {
     log_e("升级命令帧长度错误: %d < %d", len, (int)sizeof(UpgradeCommandFrame));
     send_upgrade_response(UPGRADE_STATUS_PARAM_ERROR);
@@ -457,3 +526,202 @@ void Upgrade_ClearPending(void) {
   s_upgrade_pending = false;
   memset(&s_pending_upgrade, 0, sizeof(s_pending_upgrade));
 }
+
+/*============ 后台下载 (0xBC) ============*/
+
+/**
+ * @brief 处理后台下载命令
+ *
+ * 数据块只在测试间隙写入 (UpgradeBank_SetBusyFunc), 测试中应答"忙",
+ * 上位机等这一轮测试结束后从应答的偏移继续。
+ */
+static void handle_bank_load(const uint8_t *data, uint16_t len) {
+  uint8_t status = UPGRADE_BANK_ERR_PARAM;
+  uint8_t sub;
+  const uint8_t *param = &data[BANK_PARAM_POS];
+  uint16_t param_len;
+  bool broadcast;
+
+  if (len < BANK_FRAME_OVERHEAD || data[2] != len) {
+    return;
+  }
+  sub = data[4];
+  broadcast = data[3] == BANK_BROADCAST_STATION &&
+              (sub == BANK_SUB_BLOCK_BEGIN || sub == BANK_SUB_BLOCK_DATA);
+  if (data[3] != PC_Protocol_GetStationId() && !broadcast) {
+    return; // 不是发给本工位的，静默忽略
+  }
+  if (util_checksum_sum8(data, len - 2) != data[len - 2]) {
+    log_e("后台下载校验和错误");
+    if (!broadcast) {
+      send_bank_response(sub, UPGRADE_BANK_ERR_PARAM);
+    }
+    return;
+  }
+  param_len = len - BANK_FRAME_OVERHEAD;
+
+  switch (sub) {
+  case BANK_SUB_BEGIN: {
+    UpgradeMagic_t magic;
+    if (param_len != 16) {
+      break;
+    }
+    magic.prefix = param[0];
+    magic.vendor = param[1];
+    magic.chip = util_read_le_u16(&param[2]);
+    if (UpgradeDelta_IsActive()) {
+      UpgradeDelta_Abort();
+    }
+    status = UpgradeBank_Begin(&magic, util_read_le_u32(&param[4]),
+                               util_read_le_u32(&param[8]), util_read_le_u32(&param[12]));
+    break;
+  }
+  case BANK_SUB_DATA:
+    if (param_len <= 4) {
+      break;
+    }
+    status = UpgradeBank_Write(util_read_le_u32(param), &param[4], param_len - 4);
+    break;
+  case BANK_SUB_STATUS:
+    status = UPGRADE_BANK_OK;
+    break;
+  case BANK_SUB_COMMIT:
+    if (param_len != 1) {
+      break;
+    }
+    status = UpgradeBank_Commit();
+    send_bank_response(sub, status);
+    if (status == UPGRADE_BANK_OK && param[0] == 1) {
+      // 应答发出后复位, 由Bootloader把B区拷贝到APP区
+      if (system_reset_to_bootloader) {
+        system_reset_to_bootloader();
+      } else {
+        log_w("system_reset_to_bootloader() 未实现");
+      }
+    }
+    return;
+  case BANK_SUB_ABORT:
+    UpgradeDelta_Abort();
+    status = UPGRADE_BANK_OK;
+    break;
+  case BANK_SUB_DELTA_BEGIN: {
+    UpgradeMagic_t magic;
+    if (param_len != 24) {
+      break;
+    }
+    magic.prefix = param[0];
+    magic.vendor = param[1];
+    magic.chip = util_read_le_u16(&param[2]);
+    status = UpgradeDelta_Begin(&magic, util_read_le_u32(&param[4]),
+                                util_read_le_u32(&param[8]), util_read_le_u32(&param[12]),
+                                util_read_le_u32(&param[16]), util_read_le_u32(&param[20]));
+    break;
+  }
+  case BANK_SUB_DELTA_DATA:
+    if (param_len <= 4) {
+      break;
+    }
+    status = UpgradeDelta_Write(util_read_le_u32(param), &param[4], param_len - 4);
+    break;
+  case BANK_SUB_BLOCK_BEGIN: {
+    UpgradeMagic_t magic;
+    if (param_len != 16) {
+      break;
+    }
+    magic.prefix = param[0];
+    magic.vendor = param[1];
+    magic.chip = util_read_le_u16(&param[2]);
+    if (UpgradeDelta_IsActive()) {
+      UpgradeDelta_Abort();
+    }
+    status = UpgradeBank_BeginBlocks(&magic, util_read_le_u32(&param[4]),
+                                     util_read_le_u32(&param[8]),
+                                     util_read_le_u32(&param[12]));
+    break;
+  }
+  case BANK_SUB_BLOCK_DATA:
+    if (param_len <= 2) {
+      break;
+    }
+    // 测试中 (忙) 丢弃的块在缺块查询中补发
+    status = UpgradeBank_WriteBlock(util_read_le_u16(param), &param[2], param_len - 2);
+    break;
+  case BANK_SUB_MISSING:
+    if (param_len != 2) {
+      break;
+    }
+    send_missing_response(util_read_le_u16(param));
+    return;
+  default:
+    break;
+  }
+  if (!broadcast) {
+    send_bank_response(sub, status);
+  }
+}
+
+/**
+ * @brief 发送后台下载应答
+ */
+static void send_bank_response(uint8_t sub, uint8_t status) {
+  uint8_t frame[BANK_ACK_LEN];
+  uint32_t next =
+      UpgradeDelta_IsActive() ? UpgradeDelta_NextOffset() : UpgradeBank_NextOffset();
+
+  frame[0] = FT_FRAME_HEAD;
+  frame[1] = PC_CMD_BANK_LOAD_ACK;
+  frame[2] = BANK_ACK_LEN;
+  frame[3] = PC_Protocol_GetStationId();
+  frame[4] = sub;
+  frame[5] = status;
+  frame[6] = (uint8_t)UpgradeBank_GetState();
+  util_write_le_u32(&frame[7], next);
+  frame[11] = util_checksum_sum8(frame, BANK_ACK_LEN - 2);
+  frame[12] = FT_FRAME_TAIL;
+
+  if (status != UPGRADE_BANK_OK && status != UPGRADE_BANK_ERR_BUSY) {
+    log_w("后台下载应答: 子命令%d 状态0x%02X 偏移%lu", sub, status,
+          (unsigned long)next);
+  }
+  if (s_send_func != NULL) {
+    s_send_func(frame, BANK_ACK_LEN);
+  }
+}
+
+/**
+ * @brief 发送缺块应答 (从 from 起 BANK_MISSING_WINDOW 块的位图)
+ */
+static void send_missing_response(uint16_t from) {
+  uint8_t frame[BANK_MISSING_ACK_LEN];
+  uint16_t count = UpgradeBank_BlockCount();
+  uint16_t missing = 0;
+  uint16_t i;
+
+  memset(frame, 0, sizeof(frame));
+  for (i = 0; i < count; i++) {
+    if (UpgradeBank_BlockReceived(i)) {
+      continue;
+    }
+    missing++;
+    if (i >= from && i - from < BANK_MISSING_WINDOW) {
+      frame[11 + (i - from) / 8] |= 1U << ((i - from) % 8);
+    }
+  }
+
+  frame[0] = FT_FRAME_HEAD;
+  frame[1] = PC_CMD_BANK_LOAD_ACK;
+  frame[2] = BANK_MISSING_ACK_LEN;
+  frame[3] = PC_Protocol_GetStationId();
+  frame[4] = BANK_SUB_MISSING;
+  frame[5] = count ? UPGRADE_BANK_OK : UPGRADE_BANK_ERR_STATE;
+  frame[6] = (uint8_t)UpgradeBank_GetState();
+  util_write_le_u16(&frame[7], missing);
+  util_write_le_u16(&frame[9], from);
+  frame[BANK_MISSING_ACK_LEN - 2] =
+      util_checksum_sum8(frame, BANK_MISSING_ACK_LEN - 2);
+  frame[BANK_MISSING_ACK_LEN - 1] = FT_FRAME_TAIL;
+
+  if (s_send_func != NULL) {
+    s_send_func(frame, BANK_MISSING_ACK_LEN);
+  }
+}
@@ -1,8 +1,11 @@
 /**
  * @file protocol_manager.c
  * @brief 协议管理器实现
- * @version 1.0.0
+ * @version 1.1.0
  * @date 2024-12
+ *
+ * v1.1.0: 前导码改为异步发送任务 (发送中断逐字节生成，突发间隔由
+ *         ProtocolManager_Process 调度)，并统计调用者阻塞时间
  */
 
 #define LOG_TAG "proto_mgr"
@@ -11,6 +14,14 @@
 #include <elog.h>
 #include <stdio.h>
 
+/*============ 配置 ============*/
+
+// 异步发送帧缓冲区大小 (与设备协议发送缓冲区一致)
+#define ASYNC_TX_FRAME_MAX 256
+
+// 异步发送无进展超时(ms)，9600bps下单字节约1ms
+#define ASYNC_TX_STALL_MS 100
+
 /*============ 内部数据结构 ============*/
 
 // 协议注册表项
@@ -36,19 +47,52 @@ typedef struct {
   ProtocolSendFunc device_send_func; // 原始底层发送函数(不带前导)
   ProtocolSendFunc device_send_func_raw; // 保存原始函数用于前导发送
 
+  // 异步发送端口与统计
+  ProtocolAsyncTxPort async_port;
+  bool async_enabled; // tx_kick 有效时才走异步通道
+  ProtocolTxDoneCallback tx_done_cb;
+  ProtocolTxStats tx_stats;
+
   // 初始化标志
   bool initialized;
 } ProtocolManagerContext;
 
+// 异步发送任务阶段
+typedef enum {
+  TX_PHASE_IDLE = 0, // 空闲
+  TX_PHASE_BURST,    // 发送主前导突发
+  TX_PHASE_GAP,      // 突发间隔 (发送中断已关闭)
+  TX_PHASE_SYNC,     // 发送同步前导
+  TX_PHASE_FRAME,    // 发送数据帧
+  TX_PHASE_DONE,     // 最后一个字节已交给UART，等待主循环收尾
+} TxJobPhase;
+
+// 异步发送任务 (与发送中断共享)
+typedef struct {
+  volatile uint8_t phase;
+  volatile uint16_t pos;        // 当前段内偏移
+  volatile uint8_t burst_done;  // 已完成的主前导突发次数
+  volatile uint32_t isr_bytes;  // 中断已取出的字节数 (用于判断进展)
+  volatile uint32_t gap_start;  // 进入突发间隔的tick
+  const ProtocolPreambleConfig *preamble;
+  uint32_t submit_tick;         // 提交时刻
+  uint32_t progress_tick;       // 最近一次观察到进展的时刻
+  uint32_t progress_bytes;      // 最近一次观察到的 isr_bytes
+  uint16_t frame_len;
+  uint8_t frame[ASYNC_TX_FRAME_MAX];
+} AsyncTxJob;
+
 // 全局管理器实例
 static ProtocolManagerContext g_manager = {0};
 
+// 异步发送任务
+static AsyncTxJob s_tx_job = {0};
+
 // 外部延时函数声明 (由底层提供)
 extern void FL_DelayMs(uint32_t ms);
 
 #ifdef ENABLE_WATCHDOG
-#include "fm33lg0xx_fl_iwdt.h"
-extern IWDT_Type *IWDT;
+#include "WTD.h"
 #endif
 
 /*============ 内部函数 ============*/
@@ -68,13 +112,10 @@ static void send_preamble(const ProtocolPreambleConfig *preamble) {
     g_manager.device_send_func_raw((uint8_t *)preamble->data, preamble->length);
 
     // 等待发送完成并延时
+    // 发送/延时各自登记看门狗任务 (Uart_Send / FL_DelayMs)，这里不再签到
     if (preamble->delay_ms > 0) {
       FL_DelayMs(preamble->delay_ms);
     }
-
-#ifdef ENABLE_WATCHDOG
-    FL_IWDT_ReloadCounter(IWDT);
-#endif
   }
 
   // 发送同步前导码 (如果有)
@@ -84,25 +125,168 @@ static void send_preamble(const ProtocolPreambleConfig *preamble) {
   }
 }
 
+/**
+ * @brief 读取毫秒tick (未绑定端口时返回0，统计值随之为0)
+ */
+static uint32_t tx_now(void) {
+  return (g_manager.async_port.get_tick != NULL)
+             ? g_manager.async_port.get_tick()
+             : 0;
+}
+
+/**
+ * @brief 获取当前活跃设备协议的前导配置
+ */
+static const ProtocolPreambleConfig *active_preamble(void) {
+  if (g_manager.active_device_index < 0) {
+    return NULL;
+  }
+  const ProtocolInterface *protocol =
+      g_manager.device_protocols[g_manager.active_device_index].interface;
+  if (protocol == NULL || protocol->preamble == NULL ||
+      !protocol->preamble->enabled) {
+    return NULL;
+  }
+  return protocol->preamble;
+}
+
+/**
+ * @brief 主前导发送完成后的下一阶段
+ */
+static uint8_t phase_after_burst(const ProtocolPreambleConfig *preamble) {
+  if (preamble->sync_data != NULL && preamble->sync_length > 0) {
+    return TX_PHASE_SYNC;
+  }
+  return TX_PHASE_FRAME;
+}
+
+/**
+ * @brief 更新发送耗时统计
+ */
+static void update_tx_stats(uint32_t blocked_ms) {
+  ProtocolTxStats *st = &g_manager.tx_stats;
+  st->frames++;
+  st->blocked_last_ms = blocked_ms;
+  st->blocked_total_ms += blocked_ms;
+  if (blocked_ms > st->blocked_max_ms) {
+    st->blocked_max_ms = blocked_ms;
+  }
+}
+
+/**
+ * @brief 结束异步发送任务
+ * @param success 是否完整发送
+ */
+static void finish_async_job(bool success) {
+  uint32_t elapsed = tx_now() - s_tx_job.submit_tick;
+
+  s_tx_job.phase = TX_PHASE_IDLE;
+
+  if (success) {
+    g_manager.tx_stats.complete_last_ms = elapsed;
+    if (elapsed > g_manager.tx_stats.complete_max_ms) {
+      g_manager.tx_stats.complete_max_ms = elapsed;
+    }
+  } else {
+    g_manager.tx_stats.timeouts++;
+    log_w("异步发送超时: 已发送%lu字节", (unsigned long)s_tx_job.isr_bytes);
+  }
+
+  if (g_manager.tx_done_cb != NULL) {
+    g_manager.tx_done_cb(success, elapsed);
+  }
+}
+
+/**
+ * @brief 提交异步发送任务
+ *
+ * 前导码不复制，发送中断直接引用协议中的常量数组；
+ * 只有数据帧复制一次，因为协议层会复用自己的发送缓冲区。
+ */
+static bool submit_async_job(const ProtocolPreambleConfig *preamble,
+                             const uint8_t *data, uint16_t len) {
+  if (len == 0 || len > ASYNC_TX_FRAME_MAX) {
+    log_e("异步发送帧过长: %d > %d", len, ASYNC_TX_FRAME_MAX);
+    return false;
+  }
+
+  memcpy(s_tx_job.frame, data, len);
+  s_tx_job.frame_len = len;
+  s_tx_job.preamble = preamble;
+  s_tx_job.pos = 0;
+  s_tx_job.burst_done = 0;
+  s_tx_job.isr_bytes = 0;
+  s_tx_job.submit_tick = tx_now();
+  s_tx_job.progress_tick = s_tx_job.submit_tick;
+  s_tx_job.progress_bytes = 0;
+
+  if (preamble != NULL && preamble->length > 0 && preamble->repeat_count > 0) {
+    s_tx_job.phase = TX_PHASE_BURST;
+  } else if (preamble != NULL) {
+    s_tx_job.phase = phase_after_burst(preamble);
+  } else {
+    s_tx_job.phase = TX_PHASE_FRAME;
+  }
+
+  g_manager.tx_stats.async_frames++;
+  g_manager.async_port.tx_kick();
+  return true;
+}
+
 /**
  * @brief 带前导的设备发送包装函数
  * @param data 数据
  * @param len 长度
+ *
+ * 绑定异步端口后只提交任务立即返回；否则按原方式阻塞发送。
+ * 两种方式都统计调用者被阻塞的时间，便于对比。
  */
 static void device_send_with_preamble(uint8_t *data, uint16_t len) {
-  // 获取当前活跃设备协议的前导配置
-  if (g_manager.active_device_index >= 0) {
-    const ProtocolInterface *protocol =
-        g_manager.device_protocols[g_manager.active_device_index].interface;
-    if (protocol != NULL && protocol->preamble != NULL) {
-      send_preamble(protocol->preamble);
+  uint32_t start = tx_now();
+  const ProtocolPreambleConfig *preamble = active_preamble();
+
+  if (g_manager.async_enabled) {
+    // 上一帧未发完 (通常是前导间隔中)，推进调度直到空闲或超时
+    if (s_tx_job.phase != TX_PHASE_IDLE) {
+      g_manager.tx_stats.busy_waits++;
+#ifdef ENABLE_WATCHDOG
+      // 只有ISR仍在出字节时才签到，停滞由 Process 在 ASYNC_TX_STALL_MS 后结束
+      uint32_t seen = s_tx_job.isr_bytes;
+      WDT_Task_Begin(WDT_TASK_UART, ASYNC_TX_STALL_MS + WDT_DEADLINE_UART_MARGIN);
+#endif
+      while (s_tx_job.phase != TX_PHASE_IDLE) {
+        ProtocolManager_Process();
+#ifdef ENABLE_WATCHDOG
+        if (s_tx_job.isr_bytes != seen) {
+          seen = s_tx_job.isr_bytes;
+          WDT_CheckIn(WDT_TASK_UART);
+        }
+#endif
+      }
+#ifdef ENABLE_WATCHDOG
+      WDT_Task_End(WDT_TASK_UART);
+#endif
+    }
+    if (submit_async_job(preamble, data, len)) {
+      update_tx_stats(tx_now() - start);
+      return;
     }
+    // 帧过长，退回阻塞发送
   }
 
+  send_preamble(preamble);
+
   // 发送实际数据
   if (g_manager.device_send_func_raw != NULL) {
     g_manager.device_send_func_raw(data, len);
   }
+
+  uint32_t blocked = tx_now() - start;
+  update_tx_stats(blocked);
+  g_manager.tx_stats.complete_last_ms = blocked;
+  if (blocked > g_manager.tx_stats.complete_max_ms) {
+    g_manager.tx_stats.complete_max_ms = blocked;
+  }
 }
 
 /**
@@ -133,6 +317,7 @@ static int8_t find_protocol_by_name(const ProtocolEntry *entries, uint8_t count,
 void ProtocolManager_Init(void) {
   // 清零所有数据
   memset(&g_manager, 0, sizeof(g_manager));
+  memset(&s_tx_job, 0, sizeof(s_tx_job));
 
   g_manager.active_pc_index = -1;
   g_manager.active_device_index = -1;
@@ -311,7 +496,8 @@ const char *ProtocolManager_GetDeviceNameByIndex(uint8_t index) {
  * - MES和Upgrade可以完美共存
  * - 上位机可以混发不同类型的指令
  *
- * 要求：各协议的命令字不能重复（MES用AA/AC/AE，Upgrade用BA/BB）
+ * 要求：各协议的命令字不能重复。命令码统一在 PC/pc_cmd_def.h 中分配，
+ * 重复时编译报错；各协议内部按命令表行号查分发表 (PC_Cmd_Dispatch)
  */
 ProtocolResult ProtocolManager_PC_Parse(uint8_t *data, uint16_t len) {
   if (g_manager.pc_count == 0) {
@@ -418,6 +604,13 @@ bool ProtocolManager_Device_SendCmd(uint16_t cmd, void *param) {
   return protocol->send_cmd(cmd, param);
 }
 
+void ProtocolManager_Device_SendRaw(uint8_t *data, uint16_t len) {
+  if (data == NULL || len == 0) {
+    return;
+  }
+  device_send_with_preamble(data, len);
+}
+
 void ProtocolManager_PC_OnResponse(uint16_t code, const uint8_t *data,
                                    uint16_t len) {
   if (g_manager.active_pc_index < 0) {
@@ -474,6 +667,125 @@ void ProtocolManager_SetDeviceSendFunc(ProtocolSendFunc send_func) {
   }
 }
 
+/*============ 异步前导发送 ============*/
+
+bool ProtocolManager_SetDeviceAsyncTx(const ProtocolAsyncTxPort *port) {
+  if (s_tx_job.phase != TX_PHASE_IDLE) {
+    log_w("异步发送进行中，不能切换端口");
+    return false;
+  }
+
+  if (port == NULL) {
+    memset(&g_manager.async_port, 0, sizeof(g_manager.async_port));
+    g_manager.async_enabled = false;
+    log_i("设备发送: 阻塞模式");
+    return true;
+  }
+
+  g_manager.async_port = *port;
+  // 只提供 get_tick 时仅统计阻塞时间，仍走阻塞发送 (用于对比测量)
+  g_manager.async_enabled =
+      (port->tx_kick != NULL && port->get_tick != NULL);
+  log_i("设备发送: %s", g_manager.async_enabled ? "异步模式" : "阻塞模式(计时)");
+  return true;
+}
+
+void ProtocolManager_SetTxDoneCallback(ProtocolTxDoneCallback callback) {
+  g_manager.tx_done_cb = callback;
+}
+
+bool ProtocolManager_TxIsrFetch(uint8_t *byte) {
+  const ProtocolPreambleConfig *preamble = s_tx_job.preamble;
+
+  switch (s_tx_job.phase) {
+  case TX_PHASE_BURST:
+    *byte = preamble->data[s_tx_job.pos++];
+    if (s_tx_job.pos >= preamble->length) {
+      s_tx_job.pos = 0;
+      s_tx_job.burst_done++;
+      if (s_tx_job.burst_done >= preamble->repeat_count) {
+        s_tx_job.phase = phase_after_burst(preamble);
+      } else if (preamble->delay_ms > 0) {
+        // 突发间隔交给主循环计时，本字节发完后中断关闭
+        s_tx_job.gap_start = g_manager.async_port.get_tick();
+        s_tx_job.phase = TX_PHASE_GAP;
+      }
+    }
+    break;
+
+  case TX_PHASE_SYNC:
+    *byte = preamble->sync_data[s_tx_job.pos++];
+    if (s_tx_job.pos >= preamble->sync_length) {
+      s_tx_job.pos = 0;
+      s_tx_job.phase = TX_PHASE_FRAME;
+    }
+    break;
+
+  case TX_PHASE_FRAME:
+    *byte = s_tx_job.frame[s_tx_job.pos++];
+    if (s_tx_job.pos >= s_tx_job.frame_len) {
+      s_tx_job.pos = 0;
+      s_tx_job.phase = TX_PHASE_DONE;
+    }
+    break;
+
+  default:
+    return false;
+  }
+
+  s_tx_job.isr_bytes++;
+  return true;
+}
+
+void ProtocolManager_Process(void) {
+  if (!g_manager.async_enabled || s_tx_job.phase == TX_PHASE_IDLE) {
+    return;
+  }
+
+  uint32_t now = g_manager.async_port.get_tick();
+
+  switch (s_tx_job.phase) {
+  case TX_PHASE_GAP:
+    if (now - s_tx_job.gap_start >= s_tx_job.preamble->delay_ms) {
+      s_tx_job.phase = TX_PHASE_BURST;
+      s_tx_job.progress_tick = now;
+      g_manager.async_port.tx_kick();
+    }
+    break;
+
+  case TX_PHASE_DONE:
+    finish_async_job(true);
+    break;
+
+  default:
+    // 发送中: 一段时间没有取走新字节则认为UART卡死
+    if (s_tx_job.isr_bytes != s_tx_job.progress_bytes) {
+      s_tx_job.progress_bytes = s_tx_job.isr_bytes;
+      s_tx_job.progress_tick = now;
+    } else if (now - s_tx_job.progress_tick > ASYNC_TX_STALL_MS) {
+      finish_async_job(false);
+    } else {
+      // 提交时端口正忙(上一包阻塞发送未完)，启动被忽略，这里补一次
+      g_manager.async_port.tx_kick();
+    }
+    break;
+  }
+}
+
+bool ProtocolManager_IsTxBusy(void) {
+  return s_tx_job.phase != TX_PHASE_IDLE;
+}
+
+void ProtocolManager_GetTxStats(ProtocolTxStats *stats) {
+  if (stats != NULL) {
+    *stats = g_manager.tx_stats;
+  }
+}
+
+void ProtocolManager_ResetTxStats(void) {
+  memset(&g_manager.tx_stats, 0, sizeof(g_manager.tx_stats));
+}
+
 void ProtocolManager_PrintInfo(void) {
   log_i("========== 协议管理器信息 ==========");
   log_i("PC协议 (共%d个):", g_manager.pc_count);
@@ -488,5 +800,16 @@ void ProtocolManager_PrintInfo(void) {
     log_i("  [%d] %s%s", i, g_manager.device_protocols[i].interface->name,
           active);
   }
+
+  const ProtocolTxStats *st = &g_manager.tx_stats;
+  log_i("设备发送 (%s): 帧=%lu 异步=%lu 等待=%lu 超时=%lu",
+        g_manager.async_enabled ? "异步" : "阻塞", (unsigned long)st->frames,
+        (unsigned long)st->async_frames, (unsigned long)st->busy_waits,
+        (unsigned long)st->timeouts);
+  log_i("  阻塞: 最近%lums 最大%lums 平均%lums", (unsigned long)st->blocked_last_ms,
+        (unsigned long)st->blocked_max_ms,
+        (unsigned long)(st->frames ? st->blocked_total_ms / st->frames : 0));
+  log_i("  完成: 最近%lums 最大%lums", (unsigned long)st->complete_last_ms,
+        (unsigned long)st->complete_max_ms);
   log_i("====================================");
 }
@@ -32,6 +32,15 @@
  * ProtocolManager_PC_Parse(rx_buf, rx_len);
  * ProtocolManager_Device_Parse(rx_buf, rx_len);
  * @endcode
+ *
+ * 5. 异步前导发送 (可选):
+ * @code
+ * ProtocolAsyncTxPort port = {.tx_kick = Uart0_Tx_AsyncKick,
+ *                             .get_tick = TM_GetTick};
+ * ProtocolManager_SetDeviceAsyncTx(&port);
+ * // 发送中断中: ProtocolManager_TxIsrFetch(&byte)
+ * // 主循环中:   ProtocolManager_Process();
+ * @endcode
  */
 
 #ifndef __PROTOCOL_MANAGER_H__
@@ -162,6 +171,14 @@ bool ProtocolManager_PC_SendCmd(uint16_t cmd, void *param);
  */
 bool ProtocolManager_Device_SendCmd(uint16_t cmd, void *param);
 
+/**
+ * @brief 直接发送已组好的设备帧 (加当前设备协议的前导)
+ * @param data 帧数据 (异步模式下会复制，调用后可复用)
+ * @param len 帧长度
+ * @note 供不经过协议接口组帧的旧代码使用，与 SendCmd 共用异步通道和统计
+ */
+void ProtocolManager_Device_SendRaw(uint8_t *data, uint16_t len);
+
 /*============ 响应处理接口 ============*/
 
 /**
@@ -196,6 +213,84 @@ void ProtocolManager_SetPCSendFunc(ProtocolSendFunc send_func);
  */
 void ProtocolManager_SetDeviceSendFunc(ProtocolSendFunc send_func);
 
+/*============ 异步前导发送接口 ============*/
+
+/**
+ * @brief 设备帧发送完成回调
+ * @param success true=整帧已送入移位寄存器, false=超时/被取消
+ * @param elapsed_ms 从提交到完成的耗时(ms)
+ */
+typedef void (*ProtocolTxDoneCallback)(bool success, uint32_t elapsed_ms);
+
+/**
+ * @brief 异步发送硬件端口
+ *
+ * 启用后，前导/同步码/数据帧由发送中断逐字节从管理器取出，
+ * 前导码直接引用协议中的常量数组，不再复制到RAM；
+ * 突发之间的间隔由 ProtocolManager_Process() 按tick调度，不再阻塞调用者。
+ */
+typedef struct {
+  void (*tx_kick)(void);      ///< 启动发送中断(驱动自行调用TxIsrFetch取首字节)
+  uint32_t (*get_tick)(void); ///< 毫秒tick
+} ProtocolAsyncTxPort;
+
+/**
+ * @brief 设备发送耗时统计
+ */
+typedef struct {
+  uint32_t frames;          ///< 已提交帧数
+  uint32_t async_frames;    ///< 其中走异步通道的帧数
+  uint32_t busy_waits;      ///< 提交时上一帧未完成而等待的次数
+  uint32_t timeouts;        ///< 异步任务超时次数
+  uint32_t blocked_last_ms; ///< 最近一次调用者被阻塞的时间
+  uint32_t blocked_max_ms;  ///< 调用者最大阻塞时间
+  uint32_t blocked_total_ms; ///< 调用者累计阻塞时间
+  uint32_t complete_last_ms; ///< 最近一帧从提交到发送完成的时间
+  uint32_t complete_max_ms;  ///< 从提交到发送完成的最大时间
+} ProtocolTxStats;
+
+/**
+ * @brief 绑定异步发送端口
+ * @param port 端口配置, NULL=恢复阻塞发送
+ * @return 成功返回true
+ */
+bool ProtocolManager_SetDeviceAsyncTx(const ProtocolAsyncTxPort *port);
+
+/**
+ * @brief 设置设备帧发送完成回调
+ * @param callback 回调函数(在 ProtocolManager_Process 上下文中调用)
+ */
+void ProtocolManager_SetTxDoneCallback(ProtocolTxDoneCallback callback);
+
+/**
+ * @brief 发送中断取下一个字节
+ * @param byte 输出字节
+ * @return true=有字节需要发送, false=当前无数据(驱动应关闭发送中断)
+ * @note 仅在UART发送中断中调用
+ */
+bool ProtocolManager_TxIsrFetch(uint8_t *byte);
+
+/**
+ * @brief 异步发送调度 - 在主循环中调用
+ */
+void ProtocolManager_Process(void);
+
+/**
+ * @brief 异步发送任务是否进行中
+ */
+bool ProtocolManager_IsTxBusy(void);
+
+/**
+ * @brief 获取设备发送耗时统计
+ * @param stats 输出统计
+ */
+void ProtocolManager_GetTxStats(ProtocolTxStats *stats);
+
+/**
+ * @brief 清零设备发送耗时统计
+ */
+void ProtocolManager_ResetTxStats(void);
+
 /*============ 调试接口 ============*/
 
 /**
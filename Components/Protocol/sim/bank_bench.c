@@ -0,0 +1,137 @@
+/**
+ * @file bank_bench.c
+ * @brief 后台下载 (upgrade_bank.c) 在模拟 NOR 上的开销 (本机运行)
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * 由 VscodeGcc/scripts/bank_sim.py 与 upgrade_bank.c、upgrade_storage.c、
+ * FAL、移植层和 Components/FlashDB/sim/flash_sim.c 一起编译, 按真实顺序
+ * 开始 -> 分块写入 -> 提交 -> Bootloader拷贝, 输出各步的模型周期:
+ *   op begin 周期
+ *   op chunk 块数 总周期 单块最大周期
+ *   op commit 周期
+ *   op install 周期
+ *   img 字节数 擦除次数 重复编程
+ * 拷贝后比对APP区与镜像, 不一致时返回非0。
+ */
+
+#include "flash_sim.h"
+#include "upgrade_bank.h"
+#include "utility.h"
+#include <fal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** CRC32 (slice-by-4) 每字节周期, 估算值, 可用 -D 覆盖 */
+#ifndef BANK_SIM_CRC_CYCLES_PER_BYTE
+#define BANK_SIM_CRC_CYCLES_PER_BYTE 8
+#endif
+
+static uint8_t s_image[UPGRADE_BANK_APP_SIZE];
+
+static uint64_t cycles_now(void) {
+  flash_sim_stats_t sim;
+  flash_sim_get_stats(&sim);
+  return sim.cycles;
+}
+
+/** 伪随机镜像, 向量表指向RAM栈顶和APP区内的复位入口 */
+static void make_image(uint32_t size) {
+  uint32_t seed = 0x12345678;
+  uint32_t vec[2] = {0x20008000, UPGRADE_BANK_APP_ADDR + 0x101};
+
+  for (uint32_t i = 0; i < size; i++) {
+    seed = seed * 1103515245u + 12345u;
+    s_image[i] = (uint8_t)(seed >> 16);
+  }
+  memcpy(s_image, vec, sizeof(vec));
+}
+
+int main(int argc, char **argv) {
+  uint32_t size = (argc > 1 ? (uint32_t)atoi(argv[1]) : 96) * 1024;
+  uint32_t chunk = argc > 2 ? (uint32_t)atoi(argv[2]) : UPGRADE_BANK_CHUNK_MAX;
+  UpgradeMagic_t magic = {.prefix = UPGRADE_MAGIC_PREFIX,
+                          .vendor = CURRENT_CHIP_VENDOR,
+                          .chip = CURRENT_CHIP_CODE};
+  uint64_t t0, chunk_total = 0, chunk_max = 0;
+  uint32_t chunks = 0;
+  uint8_t verify[256];
+  flash_sim_stats_t sim;
+
+  if (size > UPGRADE_BANK_APP_SIZE - UPGRADE_BANK_HDR_SIZE ||
+      chunk > UPGRADE_BANK_CHUNK_MAX || chunk == 0 || (chunk % 4) != 0) {
+    fprintf(stderr, "bad size/chunk\n");
+    return 1;
+  }
+  make_image(size);
+  flash_sim_reset();
+  /* 旧APP占满A区, 拷贝时必须先擦除 */
+  for (uint32_t off = 0; off < UPGRADE_BANK_APP_SIZE; off += 4) {
+    uint32_t old = 0x5A5A0000u | off;
+    flash_sim_program(UPGRADE_BANK_APP_ADDR + off, &old, 1);
+  }
+  fal_init();
+  if (!UpgradeBank_Init()) {
+    fprintf(stderr, "bank init failed\n");
+    return 1;
+  }
+  flash_sim_clear_stats();
+
+  t0 = cycles_now();
+  if (UpgradeBank_Begin(&magic, size, util_crc32(s_image, size), 1) !=
+      UPGRADE_BANK_OK) {
+    fprintf(stderr, "begin failed\n");
+    return 1;
+  }
+  printf("op begin %llu\n", (unsigned long long)(cycles_now() - t0));
+
+  for (uint32_t off = 0; off < size; off += chunk) {
+    uint32_t n = size - off < chunk ? size - off : chunk;
+    uint64_t c;
+
+    t0 = cycles_now();
+    if (UpgradeBank_Write(off, &s_image[off], (uint16_t)n) != UPGRADE_BANK_OK) {
+      fprintf(stderr, "write failed at %u\n", off);
+      return 1;
+    }
+    flash_sim_charge(n * BANK_SIM_CRC_CYCLES_PER_BYTE);
+    c = cycles_now() - t0;
+    chunk_total += c;
+    if (c > chunk_max) {
+      chunk_max = c;
+    }
+    chunks++;
+  }
+  printf("op chunk %u %llu %llu\n", chunks, (unsigned long long)chunk_total,
+         (unsigned long long)chunk_max);
+
+  t0 = cycles_now();
+  if (UpgradeBank_Commit() != UPGRADE_BANK_OK) {
+    fprintf(stderr, "commit failed\n");
+    return 1;
+  }
+  flash_sim_charge(size * BANK_SIM_CRC_CYCLES_PER_BYTE);
+  printf("op commit %llu\n", (unsigned long long)(cycles_now() - t0));
+
+  t0 = cycles_now();
+  if (UpgradeBank_Install() != UPGRADE_BANK_OK) {
+    fprintf(stderr, "install failed\n");
+    return 1;
+  }
+  /* 拷贝前后各校验一次 */
+  flash_sim_charge(2 * size * BANK_SIM_CRC_CYCLES_PER_BYTE);
+  printf("op install %llu\n", (unsigned long long)(cycles_now() - t0));
+
+  for (uint32_t off = 0; off < size; off += sizeof(verify)) {
+    uint32_t n = size - off < sizeof(verify) ? size - off : sizeof(verify);
+    flash_sim_read(UPGRADE_BANK_APP_ADDR + off, verify, n);
+    if (memcmp(verify, &s_image[off], n) != 0) {
+      fprintf(stderr, "app mismatch at %u\n", off);
+      return 1;
+    }
+  }
+  flash_sim_get_stats(&sim);
+  printf("img %u %u %u\n", size, sim.erases, sim.double_programs);
+  return sim.double_programs ? 1 : 0;
+}
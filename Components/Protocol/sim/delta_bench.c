@@ -0,0 +1,182 @@
+/**
+ * @file delta_bench.c
+ * @brief 差分还原 (upgrade_delta.c) 在模拟 NOR 上的开销 (本机运行)
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * 由 VscodeGcc/scripts/delta_tool.py 与 upgrade_delta.c、upgrade_bank.c、
+ * FAL、移植层和 Components/FlashDB/sim/flash_sim.c 一起编译:
+ *   delta_bench 旧镜像.bin 新镜像.bin 差分包.bin [每帧字节]
+ * 旧镜像先写入模拟Flash的APP区, 然后按协议的顺序 差分开始 -> 逐帧下发
+ * (按"下一偏移"续传) -> 提交, 输出各步的模型周期:
+ *   op begin 周期
+ *   op call 帧数 总周期 单帧最大周期
+ *   op commit 周期
+ *   img 新镜像字节 差分包字节 擦除次数 暂停次数 旧镜像读取次数
+ * 提交后比对B区与新镜像, 不一致时返回非0。
+ */
+
+#include "flash_sim.h"
+#include "upgrade_delta.h"
+#include "utility.h"
+#include <fal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** CRC32 (slice-by-4) 每字节周期, 与 bank_bench.c 相同 */
+#ifndef BANK_SIM_CRC_CYCLES_PER_BYTE
+#define BANK_SIM_CRC_CYCLES_PER_BYTE 8
+#endif
+
+/** 还原每输出一个字节的CPU周期 (两层状态机 + 旧镜像缓存), 估算值 */
+#ifndef DELTA_SIM_CYCLES_PER_OUT
+#define DELTA_SIM_CYCLES_PER_OUT 40
+#endif
+
+/** 每处理一个差分包字节的CPU周期, 估算值 */
+#ifndef DELTA_SIM_CYCLES_PER_IN
+#define DELTA_SIM_CYCLES_PER_IN 20
+#endif
+
+#define FW_BANK_ADDR 0x20000
+
+static uint8_t *load(const char *path, uint32_t *size) {
+  FILE *f = fopen(path, "rb");
+  uint8_t *buf;
+  long n;
+
+  if (f == NULL) {
+    return NULL;
+  }
+  fseek(f, 0, SEEK_END);
+  n = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  buf = malloc(n > 0 ? n : 1);
+  if (fread(buf, 1, n, f) != (size_t)n) {
+    fclose(f);
+    return NULL;
+  }
+  fclose(f);
+  *size = (uint32_t)n;
+  return buf;
+}
+
+static uint64_t cycles_now(void) {
+  flash_sim_stats_t sim;
+  flash_sim_get_stats(&sim);
+  return sim.cycles;
+}
+
+int main(int argc, char **argv) {
+  uint32_t old_size, new_size, patch_size, body_len, chunk;
+  uint8_t *old_img, *new_img, *patch, *body;
+  UpgradeDeltaFileHeader_t hdr;
+  UpgradeDeltaStats_t stats;
+  flash_sim_stats_t sim;
+  uint64_t t0, call_total = 0, call_max = 0;
+  uint32_t calls = 0, out_before, in_before;
+  uint8_t verify[256];
+
+  if (argc < 4) {
+    fprintf(stderr, "usage: delta_bench old.bin new.bin patch.bin [chunk]\n");
+    return 2;
+  }
+  old_img = load(argv[1], &old_size);
+  new_img = load(argv[2], &new_size);
+  patch = load(argv[3], &patch_size);
+  chunk = argc > 4 ? (uint32_t)atoi(argv[4]) : UPGRADE_BANK_CHUNK_MAX;
+  if (old_img == NULL || new_img == NULL || patch == NULL ||
+      patch_size < sizeof(hdr) || chunk == 0 ||
+      chunk > UPGRADE_BANK_CHUNK_MAX) {
+    fprintf(stderr, "bad arguments\n");
+    return 2;
+  }
+  memcpy(&hdr, patch, sizeof(hdr));
+  if (hdr.magic != UPGRADE_DELTA_MAGIC ||
+      hdr.checksum != util_crc32((const uint8_t *)&hdr,
+                                 sizeof(hdr) - sizeof(hdr.checksum)) ||
+      hdr.old_size != old_size || hdr.new_size != new_size) {
+    fprintf(stderr, "bad patch header\n");
+    return 1;
+  }
+  body = patch + sizeof(hdr);
+  body_len = patch_size - sizeof(hdr);
+
+  /* 当前APP (旧镜像) */
+  flash_sim_reset();
+  for (uint32_t off = 0; off < old_size; off += 4) {
+    uint32_t w = 0xFFFFFFFFu;
+    memcpy(&w, &old_img[off], old_size - off < 4 ? old_size - off : 4);
+    flash_sim_program(UPGRADE_BANK_APP_ADDR + off, &w, 1);
+  }
+  fal_init();
+  if (!UpgradeBank_Init()) {
+    fprintf(stderr, "bank init failed\n");
+    return 1;
+  }
+  flash_sim_clear_stats();
+
+  t0 = cycles_now();
+  if (UpgradeDelta_Begin(&hdr.target, hdr.old_size, hdr.old_crc32, hdr.new_size,
+                         hdr.new_crc32, hdr.version) != UPGRADE_BANK_OK) {
+    fprintf(stderr, "delta begin failed\n");
+    return 1;
+  }
+  flash_sim_charge(old_size * BANK_SIM_CRC_CYCLES_PER_BYTE);
+  printf("op begin %llu\n", (unsigned long long)(cycles_now() - t0));
+
+  while (!UpgradeDelta_IsComplete()) {
+    uint32_t off = UpgradeDelta_NextOffset();
+    uint32_t n = body_len - off < chunk ? body_len - off : chunk;
+    uint64_t c;
+
+    if (off >= body_len || calls > 1000000) {
+      fprintf(stderr, "patch ended early at %u\n", off);
+      return 1;
+    }
+    UpgradeDelta_GetStats(&stats);
+    out_before = stats.out_bytes;
+    in_before = stats.patch_bytes;
+    t0 = cycles_now();
+    if (UpgradeDelta_Write(off, &body[off], (uint16_t)n) != UPGRADE_BANK_OK) {
+      fprintf(stderr, "delta write failed at %u\n", off);
+      return 1;
+    }
+    UpgradeDelta_GetStats(&stats);
+    flash_sim_charge(
+        (stats.out_bytes - out_before) *
+            (DELTA_SIM_CYCLES_PER_OUT + BANK_SIM_CRC_CYCLES_PER_BYTE) +
+        (stats.patch_bytes - in_before) * DELTA_SIM_CYCLES_PER_IN);
+    c = cycles_now() - t0;
+    call_total += c;
+    if (c > call_max) {
+      call_max = c;
+    }
+    calls++;
+  }
+  printf("op call %u %llu %llu\n", calls, (unsigned long long)call_total,
+         (unsigned long long)call_max);
+
+  t0 = cycles_now();
+  if (UpgradeBank_Commit() != UPGRADE_BANK_OK) {
+    fprintf(stderr, "commit failed\n");
+    return 1;
+  }
+  flash_sim_charge(new_size * BANK_SIM_CRC_CYCLES_PER_BYTE);
+  printf("op commit %llu\n", (unsigned long long)(cycles_now() - t0));
+
+  for (uint32_t off = 0; off < new_size; off += sizeof(verify)) {
+    uint32_t n = new_size - off < sizeof(verify) ? new_size - off : sizeof(verify);
+    flash_sim_read(FW_BANK_ADDR + off, verify, n);
+    if (memcmp(verify, &new_img[off], n) != 0) {
+      fprintf(stderr, "bank mismatch at %u\n", off);
+      return 1;
+    }
+  }
+  UpgradeDelta_GetStats(&stats);
+  flash_sim_get_stats(&sim);
+  printf("img %u %u %u %u %u\n", new_size, patch_size, sim.erases, stats.pauses,
+         stats.old_reads);
+  return sim.double_programs ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file fleet_bench.c
+ * @brief 单个工位的 0xBC 协议处理 (pc_protocol_upgrade.c) 在模拟 NOR 上运行 (本机)
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * 由 VscodeGcc/scripts/fleet_sim.py 与 pc_protocol_upgrade.c、
+ * pc_protocol_common.c、upgrade_*.c、FAL、移植层和
+ * Components/FlashDB/sim/flash_sim.c 一起编译, 每个模拟工位一个进程:
+ *   fleet_bench 工位号
+ * 从标准输入逐行读取上位机发出的帧 (十六进制), 交给
+ * upgrade_pc_protocol.parse() 处理, 每帧输出一行:
+ *   应答帧十六进制 (没有应答时为 -) 处理该帧的模型周期
+ * 输入 "q" 时输出 "img B区擦除次数 重复块数 二次编程次数" 后退出。
+ */
+
+#include "PC/pc_protocol.h"
+#include "flash_sim.h"
+#include "upgrade_bank.h"
+#include <fal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** CRC32 (slice-by-4) 每字节周期, 与 bank_bench.c 相同 */
+#ifndef BANK_SIM_CRC_CYCLES_PER_BYTE
+#define BANK_SIM_CRC_CYCLES_PER_BYTE 8
+#endif
+
+/** 协议层每个接收字节的CPU周期 (找帧头、累加和、拷贝), 估算值 */
+#ifndef FLEET_SIM_CYCLES_PER_RX
+#define FLEET_SIM_CYCLES_PER_RX 12
+#endif
+
+uint8_t Debug_Mode = 0;
+
+static uint8_t s_station;
+static uint8_t s_resp[64];
+static uint16_t s_resp_len;
+
+static uint8_t get_station(void) { return s_station; }
+
+static void capture(uint8_t *data, uint16_t len) {
+  if (len <= sizeof(s_resp)) {
+    memcpy(s_resp, data, len);
+    s_resp_len = len;
+  }
+}
+
+static uint64_t cycles_now(void) {
+  flash_sim_stats_t sim;
+  flash_sim_get_stats(&sim);
+  return sim.cycles;
+}
+
+static int hex_nibble(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+int main(int argc, char **argv) {
+  static char line[1024];
+  uint8_t frame[256];
+  flash_sim_stats_t sim;
+  UpgradeBankStats_t stats;
+  uint32_t image_size = 0;
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: fleet_bench station\n");
+    return 2;
+  }
+  s_station = (uint8_t)atoi(argv[1]);
+
+  flash_sim_reset();
+  fal_init();
+  if (!UpgradeBank_Init()) {
+    fprintf(stderr, "bank init failed\n");
+    return 1;
+  }
+  PC_Protocol_SetStationIdFunc(get_station);
+  upgrade_pc_protocol.init();
+  upgrade_pc_protocol.set_send_func(capture);
+  flash_sim_clear_stats();
+
+  while (fgets(line, sizeof(line), stdin) != NULL) {
+    uint16_t len = 0;
+    uint64_t t0;
+    int hi, lo;
+
+    if (line[0] == 'q') {
+      break;
+    }
+    for (char *p = line; len < sizeof(frame); p += 2) {
+      hi = hex_nibble(p[0]);
+      lo = hi < 0 ? -1 : hex_nibble(p[1]);
+      if (lo < 0) {
+        break;
+      }
+      frame[len++] = (uint8_t)(hi << 4 | lo);
+    }
+
+    s_resp_len = 0;
+    t0 = cycles_now();
+    upgrade_pc_protocol.parse(frame, len);
+    flash_sim_charge(len * FLEET_SIM_CYCLES_PER_RX);
+    /* 开始帧里的镜像大小; 提交时回读整个镜像算CRC32 */
+    if (len == 23 && frame[1] == PC_CMD_BANK_LOAD) {
+      image_size = util_read_le_u32(&frame[9]);
+    } else if (len > 4 && frame[1] == PC_CMD_BANK_LOAD && frame[4] == 0x03) {
+      flash_sim_charge(image_size * BANK_SIM_CRC_CYCLES_PER_BYTE);
+    }
+    if (s_resp_len == 0) {
+      printf("-");
+    }
+    for (uint16_t i = 0; i < s_resp_len; i++) {
+      printf("%02X", s_resp[i]);
+    }
+    printf(" %llu\n", (unsigned long long)(cycles_now() - t0));
+    fflush(stdout);
+  }
+
+  UpgradeBank_GetStats(&stats);
+  flash_sim_get_stats(&sim);
+  printf("img %u %u %u\n", sim.erases, stats.duplicates, sim.double_programs);
+  return 0;
+}
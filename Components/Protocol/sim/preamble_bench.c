@@ -0,0 +1,237 @@
+/**
+ * @file preamble_bench.c
+ * @brief 设备发送 (protocol_manager.c) 阻塞/异步两种方式的调用者阻塞时间 (本机运行)
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * 由 VscodeGcc/scripts/preamble_sim.py 与 protocol_manager.c 一起编译。
+ * UART0 按 Src/Uart_Ctrl.c 建模 (发送中断逐字节发出, 每字节10位):
+ *   - 原始发送函数同 Uart_Send: 上一包未发完时忙等 (最多 tx_wait_ms),
+ *     发送前延时 tx_guard_ms, 复制后启动中断
+ *   - tx_kick 同 Uart_Tx_AsyncKick, 发送中断走 ProtocolManager_TxIsrFetch
+ *   - FL_DelayMs 推进模拟时钟, tick 取模拟时钟的毫秒数 (每次读取计1us)
+ * 主循环每 loop_us 调一次 ProtocolManager_Process。
+ *
+ * 每条命令连续发送 count 次 (每次之间主循环先跑 think_us 做别的事), 输出:
+ *   cmd 名称 模式 帧长 前导字节 阻塞最大us 阻塞合计us 发完us 统计阻塞ms 统计发完ms 超时 完成回调 发出字节
+ * 模式 block = 原阻塞发送, async = 发送中断生成前导。
+ */
+
+#include "protocol_manager.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*============ 模拟时钟和 UART0 ============*/
+
+static uint64_t s_ns;      // 模拟时钟
+static uint32_t s_byte_ns; // 每字节时间 (10位)
+static uint32_t s_guard_ms = 1;
+static uint32_t s_wait_ms = 100;
+
+static struct {
+  const uint8_t *buf;
+  uint16_t len;
+  uint16_t opc;
+  bool async;
+  bool shifting;   // 发送中断使能, 移位寄存器中有字节
+  uint64_t next_ns; // 当前字节发完的时刻
+  uint64_t last_end_ns;
+  uint32_t bytes;  // 实际移出的字节数 (Uart_Send 超时丢弃的段不计)
+  uint8_t tx_buf[256];
+} s_uart;
+
+static void uart_shift_out(void) {
+  s_uart.shifting = true;
+  s_uart.next_ns = s_ns + s_byte_ns;
+  s_uart.last_end_ns = s_uart.next_ns;
+  s_uart.bytes++;
+}
+
+/** 同 Uart_IRQ 的发送分支 */
+static void uart_isr(void) {
+  uint8_t data;
+
+  s_uart.shifting = false;
+  if (s_uart.async) {
+    if (ProtocolManager_TxIsrFetch(&data)) {
+      uart_shift_out();
+    } else {
+      s_uart.async = false;
+    }
+  } else if (s_uart.opc < s_uart.len) {
+    s_uart.opc++;
+    uart_shift_out();
+  }
+}
+
+static void sim_advance_to(uint64_t target) {
+  while (s_uart.shifting && s_uart.next_ns <= target) {
+    s_ns = s_uart.next_ns;
+    uart_isr();
+  }
+  if (target > s_ns) {
+    s_ns = target;
+  }
+}
+
+static bool uart_busy(void) {
+  return s_uart.len != s_uart.opc || s_uart.async;
+}
+
+void FL_DelayMs(uint32_t ms) { sim_advance_to(s_ns + (uint64_t)ms * 1000000); }
+
+/** 读tick计1us CPU时间, 否则忙等 Process 的循环在模拟时钟上不前进 */
+static uint32_t sim_tick(void) {
+  sim_advance_to(s_ns + 1000);
+  return (uint32_t)(s_ns / 1000000);
+}
+
+/** 同 Uart_Send */
+static void sim_uart_send(uint8_t *data, uint16_t len) {
+  uint64_t start = s_ns;
+
+  while (uart_busy() && s_ns - start < (uint64_t)s_wait_ms * 1000000) {
+    sim_advance_to(s_ns + 1000);
+  }
+  if (uart_busy()) {
+    return;
+  }
+  FL_DelayMs(s_guard_ms);
+  memcpy(s_uart.tx_buf, data, len);
+  s_uart.buf = s_uart.tx_buf;
+  s_uart.len = len;
+  s_uart.opc = 1;
+  uart_shift_out();
+}
+
+/** 同 Uart_Tx_AsyncKick */
+static void sim_uart_kick(void) {
+  uint8_t data;
+
+  if (s_uart.async || s_uart.len != s_uart.opc) {
+    return;
+  }
+  if (!ProtocolManager_TxIsrFetch(&data)) {
+    return;
+  }
+  s_uart.async = true;
+  uart_shift_out();
+}
+
+/*============ 设备协议 ============*/
+
+// 水表前导 (Device/Diomestic/WaterMeters): 50 x 0xAA 重复32次, 间隔3ms, 10 x 0xFE
+static uint8_t s_aa[50];
+static uint8_t s_fe[10];
+static const ProtocolPreambleConfig s_water_preamble = {
+    .enabled = true,
+    .data = s_aa,
+    .length = sizeof(s_aa),
+    .repeat_count = 32,
+    .delay_ms = 3,
+    .sync_data = s_fe,
+    .sync_length = sizeof(s_fe),
+};
+static const ProtocolInterface s_water = {
+    .name = "water_meter_sim",
+    .preamble = &s_water_preamble,
+};
+
+struct bench_cmd {
+  const char *name;
+  uint16_t len;
+  bool preamble;
+};
+
+// NTST/ICDC: Src/tongxin_xieyi_Ctrl.c; water: 水表读数帧 (68 ... 16)
+static const struct bench_cmd s_cmds[] = {
+    {"NTST", 19, false},
+    {"ICDC", 6, false},
+    {"water", 24, true},
+};
+
+static uint32_t s_done_count;
+static void on_done(bool success, uint32_t elapsed_ms) {
+  (void)success;
+  (void)elapsed_ms;
+  s_done_count++;
+}
+
+static void run(const struct bench_cmd *cmd, bool async, uint32_t count,
+                uint32_t loop_us, uint32_t think_us) {
+  static const ProtocolAsyncTxPort async_port = {.tx_kick = sim_uart_kick,
+                                                 .get_tick = sim_tick};
+  static const ProtocolAsyncTxPort timing_port = {.get_tick = sim_tick};
+  uint8_t frame[256];
+  uint64_t blocked_max = 0, blocked_sum = 0, t0, t_first;
+  ProtocolTxStats st;
+  uint32_t pre_bytes = 0;
+
+  memset(&s_uart, 0, sizeof(s_uart));
+  s_ns = 0;
+  s_done_count = 0;
+  ProtocolManager_Init();
+  ProtocolManager_SetDeviceSendFunc(sim_uart_send);
+  ProtocolManager_SetDeviceAsyncTx(async ? &async_port : &timing_port);
+  ProtocolManager_SetTxDoneCallback(on_done);
+  if (cmd->preamble) {
+    ProtocolManager_RegisterDevice(&s_water);
+    pre_bytes = s_water_preamble.length * s_water_preamble.repeat_count +
+                s_water_preamble.sync_length;
+  }
+  for (uint16_t i = 0; i < cmd->len; i++) {
+    frame[i] = (uint8_t)(0x30 + i);
+  }
+
+  t_first = s_ns;
+  for (uint32_t n = 0; n < count; n++) {
+    t0 = s_ns;
+    ProtocolManager_Device_SendRaw(frame, cmd->len);
+    blocked_sum += s_ns - t0;
+    if (s_ns - t0 > blocked_max) {
+      blocked_max = s_ns - t0;
+    }
+    // 主循环做别的事, 顺带调度异步发送
+    for (uint64_t end = s_ns + (uint64_t)think_us * 1000; s_ns < end;) {
+      ProtocolManager_Process();
+      sim_advance_to(s_ns + (uint64_t)loop_us * 1000);
+    }
+  }
+  // 等最后一帧发完
+  while (ProtocolManager_IsTxBusy() || uart_busy() || s_uart.shifting) {
+    ProtocolManager_Process();
+    sim_advance_to(s_ns + (uint64_t)loop_us * 1000);
+  }
+
+  ProtocolManager_GetTxStats(&st);
+  printf("cmd %s %s %u %lu %llu %llu %llu %lu %lu %lu %lu %lu\n", cmd->name,
+         async ? "async" : "block", cmd->len, (unsigned long)pre_bytes,
+         (unsigned long long)(blocked_max / 1000),
+         (unsigned long long)(blocked_sum / 1000),
+         (unsigned long long)((s_uart.last_end_ns - t_first) / 1000),
+         (unsigned long)st.blocked_max_ms, (unsigned long)st.complete_max_ms,
+         (unsigned long)st.timeouts, (unsigned long)s_done_count,
+         (unsigned long)s_uart.bytes);
+}
+
+int main(int argc, char **argv) {
+  uint32_t baud = argc > 1 ? (uint32_t)atoi(argv[1]) : 115200;
+  uint32_t count = argc > 2 ? (uint32_t)atoi(argv[2]) : 1;
+  uint32_t loop_us = argc > 3 ? (uint32_t)atoi(argv[3]) : 200;
+  uint32_t think_us = argc > 4 ? (uint32_t)atoi(argv[4]) : 5000;
+
+  if (baud == 0 || count == 0 || loop_us == 0) {
+    fprintf(stderr, "bad args\n");
+    return 1;
+  }
+  s_byte_ns = (uint32_t)(10ull * 1000000000ull / baud);
+  memset(s_aa, 0xAA, sizeof(s_aa));
+  memset(s_fe, 0xFE, sizeof(s_fe));
+
+  for (size_t i = 0; i < sizeof(s_cmds) / sizeof(s_cmds[0]); i++) {
+    run(&s_cmds[i], false, count, loop_us, think_us);
+    run(&s_cmds[i], true, count, loop_us, think_us);
+  }
+  return 0;
+}
@@ -0,0 +1,505 @@
+/**
+ * @file upgrade_bank.c
+ * @brief 后台下载新固件到B区 (测试间隙分块接收, 短重启切换)
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * 见 upgrade_bank.h。B区通过 FAL 的 fw_bank 分区访问，
+ * 写入走移植层的写合并，每块写完 sync 一次。
+ */
+
+#define LOG_TAG "upgrade_bank"
+
+#include "upgrade_bank.h"
+#include "upgrade_storage.h"
+#include "utility.h"
+#include <elog.h>
+#include <fal.h>
+#include <string.h>
+
+/*============================================================================
+ * 内部定义
+ *===========================================================================*/
+
+/* 扇区大小 (擦除粒度) */
+#define BANK_SECTOR_SIZE 2048
+
+/* 向量表检查: 初始栈顶须落在RAM内 */
+#define BANK_RAM_START 0x20000000UL
+#define BANK_RAM_END (BANK_RAM_START + 32 * 1024)
+
+/* 回读校验的分块大小 */
+#define BANK_VERIFY_BLOCK 128
+
+/* 分块模式位图 */
+#define BANK_BLOCK_MAP_BYTES ((UPGRADE_BANK_MAX_BLOCKS + 7) / 8)
+#define BANK_SECTOR_MAP_BYTES                                                  \
+  ((UPGRADE_BANK_APP_SIZE / BANK_SECTOR_SIZE + 1 + 7) / 8)
+
+/* 运行镜像在Flash中的结束地址 (链接脚本定义, 超过B区起点时链接报错)。
+ * 本机模拟和没有该符号的链接脚本中为0, 不检查 */
+extern const uint8_t __app_flash_end[] __attribute__((weak));
+
+static const struct fal_partition *s_part = NULL;
+static const struct fal_flash_dev *s_dev = NULL;
+static UpgradeBankBusyFunc s_busy_func = NULL;
+/* 上次提交的 INSTALL 未被Bootloader处理 (见 @ref bootver) */
+static bool s_boot_old = false;
+
+static struct {
+  UpgradeBankState state;
+  UpgradeMagic_t target;
+  uint32_t size;
+  uint32_t crc32;
+  uint32_t version;
+  uint32_t next;       /* 已接收字节数 */
+  uint32_t run_crc;    /* 已接收部分的CRC32 */
+  uint32_t erased_end; /* [0, erased_end) 已擦除 */
+  bool blocks;         /* 分块模式: 按块号乱序写入 */
+  uint16_t block_count;
+  uint8_t block_map[BANK_BLOCK_MAP_BYTES];   /* 已收到的块 */
+  uint8_t sector_map[BANK_SECTOR_MAP_BYTES]; /* 已擦除的扇区 */
+} s_bank;
+
+static UpgradeBankStats_t s_stats;
+
+/*============================================================================
+ * 内部函数
+ *===========================================================================*/
+
+static uint32_t bank_capacity(void) {
+  return (uint32_t)s_part->len - UPGRADE_BANK_HDR_SIZE;
+}
+
+static uint32_t hdr_offset(void) {
+  return (uint32_t)s_part->len - UPGRADE_BANK_HDR_SIZE;
+}
+
+static bool bank_erase(uint32_t offset, uint32_t size) {
+  uint32_t app_end = (uint32_t)(uintptr_t)__app_flash_end;
+
+  /* 链接检查之外再确认一次: 擦除B区不能破坏正在运行的镜像 */
+  if (app_end != 0 && app_end > s_dev->addr + s_part->offset + offset) {
+    log_e("APP镜像结束于0x%05lX, 与B区重叠, 拒绝擦除", (unsigned long)app_end);
+    return false;
+  }
+  if (fal_partition_erase(s_part, offset, size) < 0) {
+    log_e("B区擦除失败: 0x%05lX+%lu", (unsigned long)offset,
+          (unsigned long)size);
+    return false;
+  }
+  s_stats.erases += (size + BANK_SECTOR_SIZE - 1) / BANK_SECTOR_SIZE;
+  return true;
+}
+
+/** 对Flash设备 [offset, offset+size) 重算CRC32 (B区和APP区共用) */
+static uint32_t flash_crc32(uint32_t offset, uint32_t size) {
+  uint8_t buf[BANK_VERIFY_BLOCK];
+  uint32_t crc = UTIL_CRC32_INIT;
+
+  while (size > 0) {
+    uint32_t n = size > sizeof(buf) ? sizeof(buf) : size;
+    s_dev->ops.read(offset, buf, n);
+    crc = util_crc32_update(crc, buf, n);
+    offset += n;
+    size -= n;
+  }
+  return crc;
+}
+
+/** 向量表是否像本机APP (栈顶在RAM内, 复位入口在APP区内且为Thumb地址) */
+static bool image_vectors_ok(void) {
+  uint32_t vec[2];
+
+  fal_partition_read(s_part, 0, (uint8_t *)vec, sizeof(vec));
+  if (vec[0] <= BANK_RAM_START || vec[0] > BANK_RAM_END) {
+    log_e("镜像栈顶无效: 0x%08lX", (unsigned long)vec[0]);
+    return false;
+  }
+  if ((vec[1] & 1U) == 0 ||
+      vec[1] - (uint32_t)UPGRADE_BANK_APP_ADDR >= s_bank.size) {
+    log_e("镜像复位入口无效: 0x%08lX", (unsigned long)vec[1]);
+    return false;
+  }
+  return true;
+}
+
+#ifdef UPGRADE_BANK_INSTALLER
+static bool header_read(UpgradeBankHeader_t *hdr) {
+  fal_partition_read(s_part, hdr_offset(), (uint8_t *)hdr, sizeof(*hdr));
+  return hdr->magic == UPGRADE_BANK_MAGIC &&
+         hdr->checksum == util_crc32((const uint8_t *)hdr,
+                                     sizeof(*hdr) - sizeof(hdr->checksum));
+}
+#endif
+
+/*============================================================================
+ * API 实现
+ *===========================================================================*/
+
+bool UpgradeBank_Init(void) {
+  if (s_part != NULL) {
+    return true;
+  }
+  if (fal_init() < 0) {
+    log_e("FAL初始化失败");
+    return false;
+  }
+  s_part = fal_partition_find(UPGRADE_BANK_PARTITION_NAME);
+  if (s_part == NULL) {
+    log_e("找不到分区: %s", UPGRADE_BANK_PARTITION_NAME);
+    return false;
+  }
+  s_dev = fal_flash_device_find(s_part->flash_name);
+  if (s_dev == NULL) {
+    s_part = NULL;
+    return false;
+  }
+
+  memset(&s_bank, 0, sizeof(s_bank));
+#ifndef UPGRADE_BANK_INSTALLER
+  /* 提交后总会复位, 本函数在复位后首次调用; Bootloader安装 (或放弃) 后
+   * 标志已改回 NORMAL, 仍为 INSTALL 说明Bootloader不认识该标志 */
+  if (UpgradeStorage_Init() &&
+      UpgradeStorage_GetUpgradeFlag() == UPGRADE_FLAG_INSTALL) {
+    log_e("Bootloader未处理B区镜像, 需要 %s 及以上版本",
+          UPGRADE_BANK_MIN_BOOTLOADER);
+    UpgradeStorage_SetUpgradeFlag(UPGRADE_FLAG_NORMAL);
+    s_boot_old = true;
+  }
+#endif
+  log_i("B区初始化成功, 容量=%luB", (unsigned long)bank_capacity());
+  return true;
+}
+
+void UpgradeBank_SetBusyFunc(UpgradeBankBusyFunc func) { s_busy_func = func; }
+
+UpgradeBankResult UpgradeBank_CheckBootloader(void) {
+#ifdef USE_BOOTLOADER
+  if (!s_boot_old) {
+    return UPGRADE_BANK_OK;
+  }
+#endif
+  return UPGRADE_BANK_ERR_BOOTLOADER;
+}
+
+static UpgradeBankResult bank_begin(const UpgradeMagic_t *target, uint32_t size,
+                                    uint32_t crc32, uint32_t version,
+                                    bool blocks) {
+  if (s_part == NULL && !UpgradeBank_Init()) {
+    return UPGRADE_BANK_ERR_FLASH;
+  }
+  if (UpgradeBank_CheckBootloader() != UPGRADE_BANK_OK) {
+    log_e("没有能安装B区的Bootloader (需要USE_BOOTLOADER编译, Bootloader %s 及以上)",
+          UPGRADE_BANK_MIN_BOOTLOADER);
+    return UPGRADE_BANK_ERR_BOOTLOADER;
+  }
+  if (target == NULL || size < 8) {
+    return UPGRADE_BANK_ERR_PARAM;
+  }
+  if (!Upgrade_ValidateMagic(target) || !Upgrade_MatchCurrentChip(target)) {
+    log_e("B区下载魔数不匹配: vendor=0x%02X chip=0x%04X", target->vendor,
+          target->chip);
+    return UPGRADE_BANK_ERR_MAGIC;
+  }
+  if (size > bank_capacity() || size > UPGRADE_BANK_APP_SIZE) {
+    log_e("镜像超出B区: %lu > %lu", (unsigned long)size,
+          (unsigned long)bank_capacity());
+    return UPGRADE_BANK_ERR_SIZE;
+  }
+  if (UpgradeBank_IsBusy()) {
+    return UPGRADE_BANK_ERR_BUSY;
+  }
+
+  /* 已提交的旧镜像作废: 标志和镜像头都清掉 */
+  if (s_bank.state == UPGRADE_BANK_STATE_READY) {
+    UpgradeStorage_SetUpgradeFlag(UPGRADE_FLAG_NORMAL);
+  }
+  memset(&s_bank, 0, sizeof(s_bank));
+  if (!bank_erase(hdr_offset() / BANK_SECTOR_SIZE * BANK_SECTOR_SIZE,
+                  BANK_SECTOR_SIZE)) {
+    return UPGRADE_BANK_ERR_FLASH;
+  }
+
+  s_bank.state = UPGRADE_BANK_STATE_RECEIVING;
+  s_bank.target = *target;
+  s_bank.size = size;
+  s_bank.crc32 = crc32;
+  s_bank.version = version;
+  s_bank.run_crc = UTIL_CRC32_INIT;
+  s_bank.blocks = blocks;
+  s_bank.block_count = (uint16_t)((size + UPGRADE_BANK_BLOCK_SIZE - 1) /
+                                  UPGRADE_BANK_BLOCK_SIZE);
+  /* 镜像头所在扇区刚擦过 */
+  s_bank.sector_map[(hdr_offset() / BANK_SECTOR_SIZE) / 8] |=
+      1U << ((hdr_offset() / BANK_SECTOR_SIZE) % 8);
+  log_i("B区下载开始%s: %luB, CRC=0x%08lX, 版本=%lu", blocks ? "(分块)" : "",
+        (unsigned long)size, (unsigned long)crc32, (unsigned long)version);
+  return UPGRADE_BANK_OK;
+}
+
+UpgradeBankResult UpgradeBank_Begin(const UpgradeMagic_t *target, uint32_t size,
+                                    uint32_t crc32, uint32_t version) {
+  return bank_begin(target, size, crc32, version, false);
+}
+
+UpgradeBankResult UpgradeBank_BeginBlocks(const UpgradeMagic_t *target,
+                                          uint32_t size, uint32_t crc32,
+                                          uint32_t version) {
+  return bank_begin(target, size, crc32, version, true);
+}
+
+UpgradeBankResult UpgradeBank_Write(uint32_t offset, const uint8_t *data,
+                                    uint16_t len) {
+  if (s_bank.state != UPGRADE_BANK_STATE_RECEIVING || s_bank.blocks) {
+    return UPGRADE_BANK_ERR_STATE;
+  }
+  if (data == NULL || len == 0 || len > UPGRADE_BANK_CHUNK_MAX ||
+      offset + len > s_bank.size ||
+      ((len % 4) != 0 && offset + len != s_bank.size)) {
+    return UPGRADE_BANK_ERR_PARAM;
+  }
+  if (offset != s_bank.next) {
+    /* 丢帧或应答丢失后重发: 应答带回 next, 上位机从那里继续 */
+    s_stats.offset_errors++;
+    return UPGRADE_BANK_ERR_OFFSET;
+  }
+  if (UpgradeBank_IsBusy()) {
+    return UPGRADE_BANK_ERR_BUSY;
+  }
+
+  /* 首次写到的扇区先擦除 (每块最多跨一个扇区边界) */
+  if (offset + len > s_bank.erased_end) {
+    uint32_t end = (offset + len + BANK_SECTOR_SIZE - 1) / BANK_SECTOR_SIZE *
+                   BANK_SECTOR_SIZE;
+    if (!bank_erase(s_bank.erased_end, end - s_bank.erased_end)) {
+      return UPGRADE_BANK_ERR_FLASH;
+    }
+    s_bank.erased_end = end;
+  }
+
+  if (fal_partition_write(s_part, offset, data, len) < 0 ||
+      fal_flash_fm33lg04_sync() != 0) {
+    log_e("B区写入失败: 0x%05lX", (unsigned long)offset);
+    return UPGRADE_BANK_ERR_FLASH;
+  }
+  s_bank.run_crc = util_crc32_update(s_bank.run_crc, data, len);
+  s_bank.next += len;
+  s_stats.chunks++;
+  return UPGRADE_BANK_OK;
+}
+
+UpgradeBankResult UpgradeBank_WriteBlock(uint16_t index, const uint8_t *data,
+                                         uint16_t len) {
+  uint32_t offset = (uint32_t)index * UPGRADE_BANK_BLOCK_SIZE;
+  uint32_t sector = offset / BANK_SECTOR_SIZE;
+
+  if (s_bank.state != UPGRADE_BANK_STATE_RECEIVING || !s_bank.blocks) {
+    return UPGRADE_BANK_ERR_STATE;
+  }
+  if (data == NULL || index >= s_bank.block_count ||
+      len != (s_bank.size - offset < UPGRADE_BANK_BLOCK_SIZE
+                  ? s_bank.size - offset
+                  : UPGRADE_BANK_BLOCK_SIZE)) {
+    return UPGRADE_BANK_ERR_PARAM;
+  }
+  /* 重发的块已经写过, NOR 不能再编程一次 */
+  if (UpgradeBank_BlockReceived(index)) {
+    s_stats.duplicates++;
+    return UPGRADE_BANK_OK;
+  }
+  if (UpgradeBank_IsBusy()) {
+    return UPGRADE_BANK_ERR_BUSY;
+  }
+
+  /* 块按扇区对齐, 不会跨扇区; 扇区第一次写到时擦除 */
+  if ((s_bank.sector_map[sector / 8] & (1U << (sector % 8))) == 0) {
+    if (!bank_erase(sector * BANK_SECTOR_SIZE, BANK_SECTOR_SIZE)) {
+      return UPGRADE_BANK_ERR_FLASH;
+    }
+    s_bank.sector_map[sector / 8] |= 1U << (sector % 8);
+  }
+  if (fal_partition_write(s_part, offset, data, len) < 0 ||
+      fal_flash_fm33lg04_sync() != 0) {
+    log_e("B区写入失败: 块%u", index);
+    return UPGRADE_BANK_ERR_FLASH;
+  }
+  s_bank.block_map[index / 8] |= 1U << (index % 8);
+  s_bank.next += len;
+  s_stats.chunks++;
+  return UPGRADE_BANK_OK;
+}
+
+bool UpgradeBank_BlockReceived(uint16_t index) {
+  if (!s_bank.blocks || index >= s_bank.block_count) {
+    return false;
+  }
+  return (s_bank.block_map[index / 8] & (1U << (index % 8))) != 0;
+}
+
+uint16_t UpgradeBank_BlockCount(void) {
+  return s_bank.blocks ? s_bank.block_count : 0;
+}
+
+UpgradeBankResult UpgradeBank_Commit(void) {
+  UpgradeBankHeader_t hdr;
+  uint32_t crc;
+
+  if (UpgradeBank_CheckBootloader() != UPGRADE_BANK_OK) {
+    return UPGRADE_BANK_ERR_BOOTLOADER;
+  }
+  if (s_bank.state == UPGRADE_BANK_STATE_READY) {
+    return UPGRADE_BANK_OK;
+  }
+  if (s_bank.state != UPGRADE_BANK_STATE_RECEIVING ||
+      s_bank.next != s_bank.size) {
+    return UPGRADE_BANK_ERR_STATE;
+  }
+  if (UpgradeBank_IsBusy()) {
+    return UPGRADE_BANK_ERR_BUSY;
+  }
+
+  /* 接收时的CRC只说明收到的数据对, 回读说明写进Flash的也对;
+   * 分块模式乱序接收, 只能回读 */
+  if (!s_bank.blocks && s_bank.run_crc != s_bank.crc32) {
+    log_e("B区接收CRC错误: 0x%08lX != 0x%08lX", (unsigned long)s_bank.run_crc,
+          (unsigned long)s_bank.crc32);
+    return UPGRADE_BANK_ERR_CRC;
+  }
+  crc = flash_crc32(s_part->offset, s_bank.size);
+  if (crc != s_bank.crc32) {
+    log_e("B区回读CRC错误: 0x%08lX != 0x%08lX", (unsigned long)crc,
+          (unsigned long)s_bank.crc32);
+    return UPGRADE_BANK_ERR_CRC;
+  }
+  if (!Upgrade_MatchCurrentChip(&s_bank.target)) {
+    return UPGRADE_BANK_ERR_MAGIC;
+  }
+  if (!image_vectors_ok()) {
+    return UPGRADE_BANK_ERR_IMAGE;
+  }
+
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.magic = UPGRADE_BANK_MAGIC;
+  hdr.target = s_bank.target;
+  hdr.size = s_bank.size;
+  hdr.crc32 = s_bank.crc32;
+  hdr.version = s_bank.version;
+  hdr.checksum =
+      util_crc32((const uint8_t *)&hdr, sizeof(hdr) - sizeof(hdr.checksum));
+  if (fal_partition_write(s_part, hdr_offset(), (const uint8_t *)&hdr,
+                          sizeof(hdr)) < 0 ||
+      fal_flash_fm33lg04_sync() != 0) {
+    return UPGRADE_BANK_ERR_FLASH;
+  }
+
+  if (!UpgradeStorage_Init() ||
+      !UpgradeStorage_SetUpgradeFlag(UPGRADE_FLAG_INSTALL)) {
+    return UPGRADE_BANK_ERR_FLASH;
+  }
+  s_bank.state = UPGRADE_BANK_STATE_READY;
+  log_i("B区镜像校验通过, 复位后切换: %luB, CRC=0x%08lX",
+        (unsigned long)s_bank.size, (unsigned long)s_bank.crc32);
+  return UPGRADE_BANK_OK;
+}
+
+void UpgradeBank_Abort(void) {
+  if (s_bank.state == UPGRADE_BANK_STATE_READY) {
+    UpgradeStorage_SetUpgradeFlag(UPGRADE_FLAG_NORMAL);
+    bank_erase(hdr_offset() / BANK_SECTOR_SIZE * BANK_SECTOR_SIZE,
+               BANK_SECTOR_SIZE);
+  }
+  if (s_bank.state != UPGRADE_BANK_STATE_IDLE) {
+    log_i("B区下载已放弃 (%lu/%luB)", (unsigned long)s_bank.next,
+          (unsigned long)s_bank.size);
+  }
+  memset(&s_bank, 0, sizeof(s_bank));
+}
+
+UpgradeBankState UpgradeBank_GetState(void) { return s_bank.state; }
+
+uint32_t UpgradeBank_NextOffset(void) { return s_bank.next; }
+
+void UpgradeBank_GetStats(UpgradeBankStats_t *stats) {
+  if (stats != NULL) {
+    *stats = s_stats;
+  }
+}
+
+bool UpgradeBank_IsBusy(void) {
+  if (s_busy_func != NULL && s_busy_func()) {
+    s_stats.busy_rejects++;
+    return true;
+  }
+  return false;
+}
+
+bool UpgradeBank_ReadApp(uint32_t offset, uint8_t *buf, uint32_t len) {
+  if (s_dev == NULL || offset + len > UPGRADE_BANK_APP_SIZE) {
+    return false;
+  }
+  return s_dev->ops.read(UPGRADE_BANK_APP_ADDR - s_dev->addr + offset, buf,
+                         len) >= 0;
+}
+
+uint32_t UpgradeBank_AppCrc32(uint32_t size) {
+  if (s_dev == NULL || size > UPGRADE_BANK_APP_SIZE) {
+    return 0;
+  }
+  return flash_crc32(UPGRADE_BANK_APP_ADDR - s_dev->addr, size);
+}
+
+/*============================================================================
+ * Bootloader 拷贝 (参考实现)
+ *===========================================================================*/
+
+#ifdef UPGRADE_BANK_INSTALLER
+
+UpgradeBankResult UpgradeBank_Install(void) {
+  UpgradeBankHeader_t hdr;
+  uint8_t buf[BANK_VERIFY_BLOCK];
+  uint32_t offset;
+  uint32_t app;
+
+  if (s_part == NULL && !UpgradeBank_Init()) {
+    return UPGRADE_BANK_ERR_FLASH;
+  }
+  /* APP区不是FAL分区, 直接用设备接口, 偏移相对设备起始 */
+  app = UPGRADE_BANK_APP_ADDR - s_dev->addr;
+  if (!header_read(&hdr)) {
+    return UPGRADE_BANK_ERR_STATE;
+  }
+  if (!Upgrade_MatchCurrentChip(&hdr.target)) {
+    return UPGRADE_BANK_ERR_MAGIC;
+  }
+  if (hdr.size > bank_capacity() || hdr.size > UPGRADE_BANK_APP_SIZE) {
+    return UPGRADE_BANK_ERR_SIZE;
+  }
+  if (flash_crc32(s_part->offset, hdr.size) != hdr.crc32) {
+    return UPGRADE_BANK_ERR_CRC;
+  }
+
+  /* 只擦镜像占用的扇区 */
+  if (s_dev->ops.erase(app, hdr.size) < 0) {
+    return UPGRADE_BANK_ERR_FLASH;
+  }
+  for (offset = 0; offset < hdr.size; offset += sizeof(buf)) {
+    uint32_t n = hdr.size - offset;
+    if (n > sizeof(buf)) {
+      n = sizeof(buf);
+    }
+    s_dev->ops.read(s_part->offset + offset, buf, n);
+    if (s_dev->ops.write(app + offset, buf, n) < 0) {
+      return UPGRADE_BANK_ERR_FLASH;
+    }
+  }
+  if (fal_flash_fm33lg04_sync() != 0) {
+    return UPGRADE_BANK_ERR_FLASH;
+  }
+  if (flash_crc32(app, hdr.size) != hdr.crc32) {
+    return UPGRADE_BANK_ERR_CRC;
+  }
+  return UPGRADE_BANK_OK;
+}
+
+#endif /* UPGRADE_BANK_INSTALLER */
@@ -0,0 +1,274 @@
+/**
+ * @file upgrade_bank.h
+ * @brief 后台下载新固件到B区 (测试间隙分块接收, 短重启切换)
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * @section intro 简介
+ * 原升级流程 (0xBA) 先重启进入Bootloader再用Xmodem接收整个镜像，
+ * 传输期间工位停产。本模块让APP在正常运行时把新镜像分块写入
+ * fw_bank 分区 (B区)：
+ * - 上位机在测试间隙逐块发送 (PC命令0xBC)，测试进行中拒绝写入 (忙)，
+ *   上位机稍后从应答给出的偏移继续
+ * - 按顺序接收，边收边算CRC32；首次写到某扇区时才擦除，单次阻塞
+ *   不超过一次扇区擦除
+ * - 收完后回读B区重算CRC32，并检查目标芯片魔数 (Upgrade_MatchCurrentChip)
+ *   和向量表，全部通过才写入镜像头并把升级标志设为 UPGRADE_FLAG_INSTALL
+ * - 重启后由Bootloader把B区拷贝到APP区 (A区)，停产时间只有这次短重启
+ *
+ * @section layout B区布局
+ * [0, size) 镜像，分区末尾 UPGRADE_BANK_HDR_SIZE 字节为镜像头
+ * (UpgradeBankHeader_t)。镜像头只在校验通过后写入，
+ * 开始新的下载时先擦掉镜像头所在扇区，旧镜像随即失效。
+ *
+ * @section boot Bootloader约定
+ * 升级标志为 UPGRADE_FLAG_INSTALL 时：
+ * 1. 读取B区镜像头，检查 magic/checksum 和目标芯片
+ * 2. 对B区 [0, size) 重算CRC32，与镜像头一致才继续，否则清标志正常启动
+ * 3. 逐扇区擦除并拷贝到 APP 区，拷贝后再次校验CRC32
+ * 4. 标志改回 UPGRADE_FLAG_NORMAL，跳转APP
+ * 拷贝中途掉电时标志仍为 INSTALL，下次上电重新拷贝。
+ * 定义 UPGRADE_BANK_INSTALLER 编译本模块即得到参考实现 UpgradeBank_Install()。
+ *
+ * @section bootver Bootloader要求
+ * - 只有 USE_BOOTLOADER 编译 (APP在0x4000, 前16KB为Bootloader) 时才能使用B区。
+ *   独立运行 (APP在0, 没有Bootloader) 时开始下载和提交都应答
+ *   UPGRADE_BANK_ERR_BOOTLOADER，不写B区也不置标志。
+ * - Bootloader最低版本为 UPGRADE_BANK_MIN_BOOTLOADER。这是与本模块同时发布、
+ *   按上面的约定处理 INSTALL 的第一个版本。
+ * - 更早的Bootloader只认识 NORMAL/UPGRADE，会忽略 INSTALL 并照常启动APP。
+ *   这时APP启动 (UpgradeBank_Init) 看到标志仍为 INSTALL，就判定Bootloader过旧：
+ *   清除标志，本次运行中的开始/提交应答 UPGRADE_BANK_ERR_BOOTLOADER。
+ *
+ * @section blocks 分块模式
+ * 广播升级 (一帧发给总线上所有工位) 时丢帧的工位不能要求重发, 只能乱序补齐:
+ * UpgradeBank_BeginBlocks() 之后按块号 (每块 UPGRADE_BANK_BLOCK_SIZE 字节)
+ * 任意顺序写入, 位图记录收到的块, 上位机查询缺块后补发。全部收齐才能提交,
+ * 提交时的回读CRC32 即各工位的完整性判定。
+ */
+
+#ifndef __UPGRADE_BANK_H__
+#define __UPGRADE_BANK_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "upgrade_magic.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/*============================================================================
+ * 配置
+ *===========================================================================*/
+
+/** B区分区名 (fal_cfg.h) */
+#define UPGRADE_BANK_PARTITION_NAME "fw_bank"
+
+/** 支持 UPGRADE_FLAG_INSTALL 的最低Bootloader版本 (见 @ref bootver) */
+#define UPGRADE_BANK_MIN_BOOTLOADER "2.1.0"
+
+/** APP区 (A区) 起始地址和大小，即当前运行的镜像 (差分升级的基准)。
+ * Bootloader模式与 fal_cfg.h 的布局一致；独立运行时同 fm33lg04x_flash.ld */
+#ifndef UPGRADE_BANK_APP_ADDR
+#if defined(APP_START_ADDRESS)
+#define UPGRADE_BANK_APP_ADDR APP_START_ADDRESS
+#elif defined(USE_BOOTLOADER)
+#define UPGRADE_BANK_APP_ADDR 0x4000
+#else
+#define UPGRADE_BANK_APP_ADDR 0x0000
+#endif
+#endif
+#ifndef UPGRADE_BANK_APP_SIZE
+#ifdef USE_BOOTLOADER
+#define UPGRADE_BANK_APP_SIZE (112 * 1024)
+#else
+#define UPGRADE_BANK_APP_SIZE (128 * 1024)
+#endif
+#endif
+
+/** 镜像头保留区 (B区末尾) */
+#define UPGRADE_BANK_HDR_SIZE 32
+
+/** 单块最大数据长度, 与写合并行 (128字节) 一致 */
+#define UPGRADE_BANK_CHUNK_MAX 128
+
+/** 分块模式的块大小 (2KB扇区的整数分之一) 和最大块数 */
+#define UPGRADE_BANK_BLOCK_SIZE 128
+#define UPGRADE_BANK_MAX_BLOCKS (UPGRADE_BANK_APP_SIZE / UPGRADE_BANK_BLOCK_SIZE)
+
+/** 镜像头魔数 "BANK" */
+#define UPGRADE_BANK_MAGIC 0x4B4E4142
+
+/*============================================================================
+ * 数据结构
+ *===========================================================================*/
+
+/**
+ * @brief B区镜像头 (校验通过后写在分区末尾)
+ */
+#pragma pack(1)
+typedef struct {
+  uint32_t magic;        /**< UPGRADE_BANK_MAGIC */
+  UpgradeMagic_t target; /**< 目标芯片魔数 */
+  uint32_t size;         /**< 镜像字节数 */
+  uint32_t crc32;        /**< 镜像CRC32 (util_crc32) */
+  uint32_t version;      /**< 固件版本 (上位机给出, 只记录) */
+  uint32_t checksum;     /**< 前面字段的CRC32 */
+} UpgradeBankHeader_t;
+#pragma pack()
+
+/**
+ * @brief 操作结果 (同时用作0xBD应答的状态码)
+ */
+typedef enum {
+  UPGRADE_BANK_OK = 0x00,
+  UPGRADE_BANK_ERR_PARAM = 0x01,  /**< 参数错误 */
+  UPGRADE_BANK_ERR_BUSY = 0x02,   /**< 测试进行中, 稍后重发 */
+  UPGRADE_BANK_ERR_SIZE = 0x03,   /**< 镜像超过B区容量 */
+  UPGRADE_BANK_ERR_MAGIC = 0x04,  /**< 魔数无效或芯片不匹配 */
+  UPGRADE_BANK_ERR_OFFSET = 0x05, /**< 偏移不连续, 按应答中的偏移重发 */
+  UPGRADE_BANK_ERR_STATE = 0x06,  /**< 未开始下载或尚未收完 */
+  UPGRADE_BANK_ERR_FLASH = 0x07,  /**< 擦除/编程失败 */
+  UPGRADE_BANK_ERR_CRC = 0x08,    /**< CRC校验失败 */
+  UPGRADE_BANK_ERR_IMAGE = 0x09,  /**< 向量表不像本机APP */
+  UPGRADE_BANK_ERR_BASE = 0x0A,   /**< 当前APP与差分基准不一致 (upgrade_delta.h) */
+  UPGRADE_BANK_ERR_PATCH = 0x0B,  /**< 差分数据格式错误 */
+  UPGRADE_BANK_ERR_BOOTLOADER = 0x0C, /**< 没有能安装B区的Bootloader (@ref bootver) */
+} UpgradeBankResult;
+
+/**
+ * @brief 下载状态
+ */
+typedef enum {
+  UPGRADE_BANK_STATE_IDLE = 0,  /**< 无下载 */
+  UPGRADE_BANK_STATE_RECEIVING, /**< 接收中 */
+  UPGRADE_BANK_STATE_READY,     /**< 已校验, 等待重启切换 */
+} UpgradeBankState;
+
+/**
+ * @brief 下载统计
+ */
+typedef struct {
+  uint32_t chunks;        /**< 写入的块数 */
+  uint32_t busy_rejects;  /**< 测试中被拒绝的块 */
+  uint32_t offset_errors; /**< 偏移不连续 (丢帧后重发) */
+  uint32_t erases;        /**< 扇区擦除次数 */
+  uint32_t duplicates;    /**< 分块模式下重复收到的块 */
+} UpgradeBankStats_t;
+
+/** 是否正在测试 (测试中拒绝写Flash, 避免擦除阻塞采样) */
+typedef bool (*UpgradeBankBusyFunc)(void);
+
+/*============================================================================
+ * API 函数
+ *===========================================================================*/
+
+/**
+ * @brief 初始化 (查找B区分区)
+ * @return true: 成功
+ */
+bool UpgradeBank_Init(void);
+
+/**
+ * @brief 设置测试忙判断函数, 未设置时总认为空闲
+ */
+void UpgradeBank_SetBusyFunc(UpgradeBankBusyFunc func);
+
+/**
+ * @brief 开始下载: 检查魔数和大小, 擦除镜像头所在扇区使旧镜像失效
+ *
+ * @param target 目标芯片魔数
+ * @param size 镜像字节数
+ * @param crc32 镜像CRC32
+ * @param version 固件版本
+ */
+UpgradeBankResult UpgradeBank_Begin(const UpgradeMagic_t *target, uint32_t size,
+                                    uint32_t crc32, uint32_t version);
+
+/**
+ * @brief 写入一块 (必须从 UpgradeBank_NextOffset() 处连续写)
+ *
+ * @param offset 镜像内偏移
+ * @param data 数据
+ * @param len 长度 (<= UPGRADE_BANK_CHUNK_MAX, 除最后一块外须为4的倍数)
+ */
+UpgradeBankResult UpgradeBank_Write(uint32_t offset, const uint8_t *data,
+                                    uint16_t len);
+
+/**
+ * @brief 开始分块下载 (块可乱序写入, 见 @ref blocks), 参数同 UpgradeBank_Begin()
+ */
+UpgradeBankResult UpgradeBank_BeginBlocks(const UpgradeMagic_t *target,
+                                          uint32_t size, uint32_t crc32,
+                                          uint32_t version);
+
+/**
+ * @brief 分块模式写入一块, 已收到的块直接返回成功
+ *
+ * @param index 块号
+ * @param len 块长度 (最后一块可以不满 UPGRADE_BANK_BLOCK_SIZE)
+ */
+UpgradeBankResult UpgradeBank_WriteBlock(uint16_t index, const uint8_t *data,
+                                         uint16_t len);
+
+/** 分块模式下该块是否已收到 */
+bool UpgradeBank_BlockReceived(uint16_t index);
+
+/** 分块模式的总块数, 非分块模式为0 */
+uint16_t UpgradeBank_BlockCount(void);
+
+/**
+ * @brief 收完后校验并写入镜像头、设置 UPGRADE_FLAG_INSTALL
+ *
+ * 回读B区重算CRC32, 检查芯片魔数和向量表。成功后下次复位切换到新固件。
+ */
+UpgradeBankResult UpgradeBank_Commit(void);
+
+/**
+ * @brief 放弃当前下载 (已提交的镜像同时作废)
+ */
+void UpgradeBank_Abort(void);
+
+UpgradeBankState UpgradeBank_GetState(void);
+
+/** 下一块应写入的偏移 (= 已接收字节数, 分块模式下同样是已接收字节数) */
+uint32_t UpgradeBank_NextOffset(void);
+
+void UpgradeBank_GetStats(UpgradeBankStats_t *stats);
+
+/**
+ * @brief 复位后能否由Bootloader安装B区 (@ref bootver)
+ * @return UPGRADE_BANK_OK 或 UPGRADE_BANK_ERR_BOOTLOADER
+ */
+UpgradeBankResult UpgradeBank_CheckBootloader(void);
+
+/**
+ * @brief 当前是否在测试中 (忙判断函数返回true时计入 busy_rejects)
+ */
+bool UpgradeBank_IsBusy(void);
+
+/**
+ * @brief 读取APP区 (A区, 当前运行的固件), 供差分升级取旧镜像
+ * @return true: 成功; false: 越界或未初始化
+ */
+bool UpgradeBank_ReadApp(uint32_t offset, uint8_t *buf, uint32_t len);
+
+/**
+ * @brief APP区 [0, size) 的CRC32
+ */
+uint32_t UpgradeBank_AppCrc32(uint32_t size);
+
+#ifdef UPGRADE_BANK_INSTALLER
+/**
+ * @brief 把B区镜像拷贝到APP区 (Bootloader调用, APP运行时不能调用)
+ * @return UPGRADE_BANK_OK: 已拷贝并校验; 其它: 未拷贝或拷贝失败
+ */
+UpgradeBankResult UpgradeBank_Install(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UPGRADE_BANK_H__ */
@@ -0,0 +1,415 @@
+/**
+ * @file upgrade_delta.c
+ * @brief 差分升级: 用当前APP + 差分包流式还原新固件, 写入B区
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * 见 upgrade_delta.h。两层逐字节状态机: 游程解码层把差分包还原成
+ * 记录流, 记录层按 差分/新增/跳转 输出新镜像字节, 凑满一块交给
+ * UpgradeBank_Write()。
+ */
+
+#define LOG_TAG "upgrade_delta"
+
+#include "upgrade_delta.h"
+#include <elog.h>
+#include <string.h>
+
+/*============================================================================
+ * 内部定义
+ *===========================================================================*/
+
+/* 旧镜像读缓存 */
+#define DELTA_OLD_CACHE 64
+
+/* varint 最多5字节 (32位) */
+#define DELTA_VARINT_MAX_SHIFT 28
+
+typedef enum {
+  RLE_TAG = 0, /* 等待标记字节 */
+  RLE_COUNT,   /* 读取长度 varint */
+  RLE_VALUE,   /* 读取重复值 */
+  RLE_LITERAL, /* 原样字节 */
+  RLE_REPEAT,  /* 展开重复值 */
+} RleState;
+
+typedef enum {
+  REC_DIFF_LEN = 0,
+  REC_EXTRA_LEN,
+  REC_SEEK,
+  REC_DIFF,
+  REC_EXTRA,
+} RecState;
+
+typedef struct {
+  uint32_t acc;
+  uint8_t shift;
+} Varint;
+
+static struct {
+  bool active;
+  uint32_t old_size;
+  uint32_t new_size;
+  uint32_t next;      /* 已处理的差分包字节 */
+  uint32_t out_total; /* 已还原字节 (含输出缓冲) */
+  uint32_t flushed;   /* 已写入B区字节 */
+
+  /* 游程解码层 */
+  RleState rle_state;
+  uint8_t rle_tag;
+  uint8_t rle_value;
+  uint32_t rle_left;
+  Varint rle_var;
+
+  /* 记录层 */
+  RecState rec_state;
+  uint32_t diff_left;
+  uint32_t extra_left;
+  uint32_t seek; /* zigzag 编码 */
+  uint32_t old_pos;
+  Varint rec_var;
+
+  uint8_t out[UPGRADE_BANK_CHUNK_MAX];
+  uint16_t out_len;
+
+  uint8_t old_buf[DELTA_OLD_CACHE];
+  uint32_t old_base;
+  uint16_t old_valid;
+} s_delta;
+
+static UpgradeDeltaStats_t s_stats;
+
+/*============================================================================
+ * 内部函数
+ *===========================================================================*/
+
+/** LEB128: 返回1=完成, 0=还有后续字节, -1=超长 */
+static int varint_push(Varint *v, uint8_t b) {
+  if (v->shift > DELTA_VARINT_MAX_SHIFT) {
+    return -1;
+  }
+  v->acc |= (uint32_t)(b & 0x7F) << v->shift;
+  v->shift += 7;
+  if (b & 0x80) {
+    return 0;
+  }
+  return 1;
+}
+
+static uint32_t varint_take(Varint *v) {
+  uint32_t value = v->acc;
+  v->acc = 0;
+  v->shift = 0;
+  return value;
+}
+
+static bool old_byte(uint8_t *b) {
+  uint32_t pos = s_delta.old_pos;
+
+  if (pos >= s_delta.old_size) {
+    return false;
+  }
+  if (pos < s_delta.old_base || pos >= s_delta.old_base + s_delta.old_valid) {
+    uint32_t n = s_delta.old_size - pos;
+    if (n > DELTA_OLD_CACHE) {
+      n = DELTA_OLD_CACHE;
+    }
+    if (!UpgradeBank_ReadApp(pos, s_delta.old_buf, n)) {
+      return false;
+    }
+    s_delta.old_base = pos;
+    s_delta.old_valid = (uint16_t)n;
+    s_stats.old_reads++;
+  }
+  *b = s_delta.old_buf[pos - s_delta.old_base];
+  return true;
+}
+
+static UpgradeBankResult out_byte(uint8_t b) {
+  UpgradeBankResult res;
+
+  s_delta.out[s_delta.out_len++] = b;
+  s_delta.out_total++;
+  if (s_delta.out_len < sizeof(s_delta.out) &&
+      s_delta.out_total != s_delta.new_size) {
+    return UPGRADE_BANK_OK;
+  }
+  res = UpgradeBank_Write(s_delta.flushed, s_delta.out, s_delta.out_len);
+  if (res == UPGRADE_BANK_OK) {
+    s_delta.flushed += s_delta.out_len;
+    s_delta.out_len = 0;
+  }
+  return res;
+}
+
+static void rec_finish(void) {
+  uint32_t z = s_delta.seek;
+  int32_t seek = (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+
+  s_delta.old_pos += (uint32_t)seek;
+  s_delta.rec_state = REC_DIFF_LEN;
+}
+
+/** 记录层: 处理解压后的一个字节 */
+static UpgradeBankResult rec_byte(uint8_t b) {
+  uint8_t old;
+  int r;
+
+  switch (s_delta.rec_state) {
+  case REC_DIFF_LEN:
+  case REC_EXTRA_LEN:
+  case REC_SEEK:
+    r = varint_push(&s_delta.rec_var, b);
+    if (r < 0) {
+      return UPGRADE_BANK_ERR_PATCH;
+    }
+    if (r == 0) {
+      return UPGRADE_BANK_OK;
+    }
+    if (s_delta.rec_state == REC_DIFF_LEN) {
+      s_delta.diff_left = varint_take(&s_delta.rec_var);
+      s_delta.rec_state = REC_EXTRA_LEN;
+    } else if (s_delta.rec_state == REC_EXTRA_LEN) {
+      s_delta.extra_left = varint_take(&s_delta.rec_var);
+      if (s_delta.diff_left > s_delta.new_size - s_delta.out_total ||
+          s_delta.extra_left >
+              s_delta.new_size - s_delta.out_total - s_delta.diff_left) {
+        return UPGRADE_BANK_ERR_PATCH;
+      }
+      s_delta.rec_state = REC_SEEK;
+    } else {
+      s_delta.seek = varint_take(&s_delta.rec_var);
+      if (s_delta.diff_left) {
+        s_delta.rec_state = REC_DIFF;
+      } else if (s_delta.extra_left) {
+        s_delta.rec_state = REC_EXTRA;
+      } else if (s_delta.seek != 0) {
+        rec_finish(); /* 只移动旧指针 */
+      } else {
+        /* 什么都不做的记录, 生成器不会输出, 拒绝以免重复段空转 */
+        return UPGRADE_BANK_ERR_PATCH;
+      }
+    }
+    return UPGRADE_BANK_OK;
+
+  case REC_DIFF:
+    if (!old_byte(&old)) {
+      return UPGRADE_BANK_ERR_PATCH;
+    }
+    s_delta.old_pos++;
+    if (--s_delta.diff_left == 0) {
+      if (s_delta.extra_left) {
+        s_delta.rec_state = REC_EXTRA;
+      } else {
+        rec_finish();
+      }
+    }
+    return out_byte((uint8_t)(old + b));
+
+  case REC_EXTRA:
+    if (--s_delta.extra_left == 0) {
+      rec_finish();
+    }
+    return out_byte(b);
+  }
+  return UPGRADE_BANK_ERR_PATCH;
+}
+
+/** 游程层: 处理差分包的一个字节 (重复段在调用方展开) */
+static UpgradeBankResult rle_byte(uint8_t b) {
+  int r;
+
+  switch (s_delta.rle_state) {
+  case RLE_TAG:
+    if (b != UPGRADE_DELTA_RLE_LITERAL && b != UPGRADE_DELTA_RLE_REPEAT) {
+      return UPGRADE_BANK_ERR_PATCH;
+    }
+    s_delta.rle_tag = b;
+    s_delta.rle_state = RLE_COUNT;
+    return UPGRADE_BANK_OK;
+
+  case RLE_COUNT:
+    r = varint_push(&s_delta.rle_var, b);
+    if (r < 0) {
+      return UPGRADE_BANK_ERR_PATCH;
+    }
+    if (r == 1) {
+      s_delta.rle_left = varint_take(&s_delta.rle_var);
+      if (s_delta.rle_left == 0) {
+        return UPGRADE_BANK_ERR_PATCH;
+      }
+      s_delta.rle_state = s_delta.rle_tag == UPGRADE_DELTA_RLE_LITERAL
+                              ? RLE_LITERAL
+                              : RLE_VALUE;
+    }
+    return UPGRADE_BANK_OK;
+
+  case RLE_VALUE:
+    s_delta.rle_value = b;
+    s_delta.rle_state = RLE_REPEAT;
+    return UPGRADE_BANK_OK;
+
+  case RLE_LITERAL:
+    if (--s_delta.rle_left == 0) {
+      s_delta.rle_state = RLE_TAG;
+    }
+    return rec_byte(b);
+
+  default:
+    break;
+  }
+  return UPGRADE_BANK_ERR_PATCH;
+}
+
+/** 展开重复段, 到输出上限为止 */
+static UpgradeBankResult rle_expand(uint32_t limit) {
+  UpgradeBankResult res;
+
+  while (s_delta.rle_state == RLE_REPEAT && s_delta.out_total < limit) {
+    res = rec_byte(s_delta.rle_value);
+    if (res != UPGRADE_BANK_OK) {
+      return res;
+    }
+    if (--s_delta.rle_left == 0) {
+      s_delta.rle_state = RLE_TAG;
+    }
+  }
+  return UPGRADE_BANK_OK;
+}
+
+static void delta_fail(UpgradeBankResult res) {
+  log_e("差分还原失败: 状态0x%02X, 差分包偏移%lu, 输出%lu/%lu", res,
+        (unsigned long)s_delta.next, (unsigned long)s_delta.out_total,
+        (unsigned long)s_delta.new_size);
+  UpgradeBank_Abort();
+  s_delta.active = false;
+}
+
+/*============================================================================
+ * API 实现
+ *===========================================================================*/
+
+UpgradeBankResult UpgradeDelta_Begin(const UpgradeMagic_t *target,
+                                     uint32_t old_size, uint32_t old_crc32,
+                                     uint32_t new_size, uint32_t new_crc32,
+                                     uint32_t version) {
+  UpgradeBankResult res;
+  uint32_t crc;
+
+  if (!UpgradeBank_Init()) {
+    return UPGRADE_BANK_ERR_FLASH;
+  }
+  /* 没有Bootloader时差分基准 (APP区) 也不同, 先于基准检查拒绝 */
+  if (UpgradeBank_CheckBootloader() != UPGRADE_BANK_OK) {
+    return UPGRADE_BANK_ERR_BOOTLOADER;
+  }
+  if (old_size == 0 || old_size > UPGRADE_BANK_APP_SIZE) {
+    return UPGRADE_BANK_ERR_PARAM;
+  }
+  /* APP区CRC要读整个旧镜像, 测试中不做 */
+  if (UpgradeBank_IsBusy()) {
+    return UPGRADE_BANK_ERR_BUSY;
+  }
+  crc = UpgradeBank_AppCrc32(old_size);
+  if (crc != old_crc32) {
+    log_e("差分基准不符: APP CRC=0x%08lX, 差分包基准=0x%08lX",
+          (unsigned long)crc, (unsigned long)old_crc32);
+    return UPGRADE_BANK_ERR_BASE;
+  }
+
+  res = UpgradeBank_Begin(target, new_size, new_crc32, version);
+  if (res != UPGRADE_BANK_OK) {
+    return res;
+  }
+  memset(&s_delta, 0, sizeof(s_delta));
+  memset(&s_stats, 0, sizeof(s_stats));
+  s_delta.old_size = old_size;
+  s_delta.new_size = new_size;
+  s_delta.active = true;
+  log_i("差分下载开始: %luB -> %luB", (unsigned long)old_size,
+        (unsigned long)new_size);
+  return UPGRADE_BANK_OK;
+}
+
+UpgradeBankResult UpgradeDelta_Write(uint32_t offset, const uint8_t *data,
+                                     uint16_t len) {
+  UpgradeBankResult res;
+  uint32_t limit;
+  uint16_t pos = 0;
+
+  if (!s_delta.active) {
+    return UPGRADE_BANK_ERR_STATE;
+  }
+  if (data == NULL || len == 0) {
+    return UPGRADE_BANK_ERR_PARAM;
+  }
+  if (offset != s_delta.next) {
+    return UPGRADE_BANK_ERR_OFFSET;
+  }
+  if (UpgradeBank_IsBusy()) {
+    return UPGRADE_BANK_ERR_BUSY;
+  }
+
+  limit = s_delta.out_total + UPGRADE_DELTA_OUT_BUDGET;
+  for (;;) {
+    /* 刚读到重复值的重复段在这里展开 */
+    res = rle_expand(limit);
+    if (res != UPGRADE_BANK_OK) {
+      delta_fail(res);
+      return res;
+    }
+    if (s_delta.rle_state == RLE_REPEAT || pos >= len ||
+        s_delta.out_total >= limit) {
+      break;
+    }
+    if (s_delta.out_total == s_delta.new_size) {
+      /* 已还原完, 后面不应再有数据 */
+      delta_fail(UPGRADE_BANK_ERR_PATCH);
+      return UPGRADE_BANK_ERR_PATCH;
+    }
+    res = rle_byte(data[pos++]);
+    if (res != UPGRADE_BANK_OK) {
+      delta_fail(res);
+      return res;
+    }
+  }
+
+  if (s_delta.rle_state == RLE_REPEAT) {
+    /* 重复段没展开完: 退回到重复值字节, 上位机从那里重发; 否则重复值
+     * 恰好是差分包最后一个字节时"下一偏移"已到末尾, 上位机无从续传 */
+    s_delta.rle_state = RLE_VALUE;
+    pos--;
+  }
+  if (pos < len) {
+    s_stats.pauses++;
+  }
+  s_delta.next += pos;
+  s_stats.patch_bytes = s_delta.next;
+  s_stats.out_bytes = s_delta.out_total;
+  if (UpgradeDelta_IsComplete()) {
+    log_i("差分还原完成: 差分包%luB -> %luB", (unsigned long)s_delta.next,
+          (unsigned long)s_delta.new_size);
+  }
+  return UPGRADE_BANK_OK;
+}
+
+bool UpgradeDelta_IsActive(void) { return s_delta.active; }
+
+uint32_t UpgradeDelta_NextOffset(void) { return s_delta.next; }
+
+bool UpgradeDelta_IsComplete(void) {
+  return s_delta.active && s_delta.out_total == s_delta.new_size &&
+         s_delta.flushed == s_delta.new_size &&
+         s_delta.rle_state == RLE_TAG && s_delta.rec_state == REC_DIFF_LEN;
+}
+
+void UpgradeDelta_Abort(void) {
+  UpgradeBank_Abort();
+  memset(&s_delta, 0, sizeof(s_delta));
+}
+
+void UpgradeDelta_GetStats(UpgradeDeltaStats_t *stats) {
+  if (stats != NULL) {
+    *stats = s_stats;
+  }
+}
@@ -0,0 +1,138 @@
+/**
+ * @file upgrade_delta.h
+ * @brief 差分升级: 用当前APP + 差分包流式还原新固件, 写入B区
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * @section intro 简介
+ * 只改了限值表或一两个函数时, 新旧镜像绝大部分相同, 没有必要在
+ * 9600波特率的总线上把整个镜像逐个工位发一遍。上位机用
+ * VscodeGcc/scripts/delta_tool.py 对比新旧镜像生成差分包, 经PC命令
+ * 0xBC 的差分子命令分块下发, 本模块边收边还原, 输出交给 upgrade_bank
+ * 按顺序写入B区; 之后的提交、校验和切换与整包后台下载完全相同。
+ *
+ * @section format 差分包格式
+ * 差分包 = 文件头 (UpgradeDeltaFileHeader_t, 只在上位机使用,
+ * 其中的字段通过"差分开始"帧发给工装) + 数据流。数据流按 bsdiff 的思路
+ * 由若干记录组成, 每条记录:
+ *   差分长度 (varint), 新增长度 (varint), 旧镜像跳转 (zigzag varint),
+ *   差分字节 x 差分长度: 新字节 = 旧镜像[旧指针++] + 差分字节 (模256),
+ *   新增字节 x 新增长度: 直接输出,
+ *   之后 旧指针 += 跳转
+ * 函数挪了位置时调用/跳转地址只差几个字节, 差分字节大多是0。
+ * 整个数据流再用一层简单的游程编码压缩:
+ *   0x00 n [n字节]    n个原样字节
+ *   0x01 n [v]        v重复n次
+ * (n为varint)。varint 为LEB128: 每字节低7位有效, 最高位1表示还有后续。
+ *
+ * @section stream 流式还原
+ * - 只需几百字节RAM: 解码状态、128字节输出缓冲 (凑满一块写B区)
+ *   和64字节旧镜像读缓存; 旧镜像直接从APP区读取
+ * - 每次调用最多输出 UPGRADE_DELTA_OUT_BUDGET 字节, 一小段差分包可能
+ *   展开成几十KB (大段不变的代码), 达到上限就停下, 应答中的"下一偏移"
+ *   小于本块末尾, 上位机从那里继续发, 主循环单次阻塞与整包下载相当
+ * - 开始时对APP区 [0, 旧大小) 算CRC32, 与差分包的基准不一致直接拒绝
+ */
+
+#ifndef __UPGRADE_DELTA_H__
+#define __UPGRADE_DELTA_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "upgrade_bank.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/*============================================================================
+ * 配置
+ *===========================================================================*/
+
+/** 单次调用最多输出的字节数 (一个扇区) */
+#ifndef UPGRADE_DELTA_OUT_BUDGET
+#define UPGRADE_DELTA_OUT_BUDGET 2048
+#endif
+
+/** 差分包文件头魔数 "JDLT" */
+#define UPGRADE_DELTA_MAGIC 0x544C444A
+
+/** 游程编码标记 */
+#define UPGRADE_DELTA_RLE_LITERAL 0x00
+#define UPGRADE_DELTA_RLE_REPEAT 0x01
+
+/*============================================================================
+ * 数据结构
+ *===========================================================================*/
+
+/**
+ * @brief 差分包文件头 (上位机生成, 小端)
+ */
+#pragma pack(1)
+typedef struct {
+  uint32_t magic;        /**< UPGRADE_DELTA_MAGIC */
+  UpgradeMagic_t target; /**< 新固件目标芯片魔数 */
+  uint32_t old_size;     /**< 基准镜像 (当前APP) 字节数 */
+  uint32_t old_crc32;    /**< 基准镜像CRC32 */
+  uint32_t new_size;     /**< 新镜像字节数 */
+  uint32_t new_crc32;    /**< 新镜像CRC32 */
+  uint32_t version;      /**< 新固件版本 */
+  uint32_t checksum;     /**< 前面字段的CRC32 */
+} UpgradeDeltaFileHeader_t;
+#pragma pack()
+
+/**
+ * @brief 差分还原统计
+ */
+typedef struct {
+  uint32_t patch_bytes; /**< 已处理的差分包字节 */
+  uint32_t out_bytes;   /**< 已还原的新镜像字节 */
+  uint32_t old_reads;   /**< 旧镜像读缓存未命中次数 */
+  uint32_t pauses;      /**< 因输出上限提前返回的次数 */
+} UpgradeDeltaStats_t;
+
+/*============================================================================
+ * API 函数
+ *===========================================================================*/
+
+/**
+ * @brief 开始差分下载
+ *
+ * 检查APP区 [0, old_size) 的CRC32 与基准一致, 然后以新镜像参数
+ * 调用 UpgradeBank_Begin()。
+ */
+UpgradeBankResult UpgradeDelta_Begin(const UpgradeMagic_t *target,
+                                     uint32_t old_size, uint32_t old_crc32,
+                                     uint32_t new_size, uint32_t new_crc32,
+                                     uint32_t version);
+
+/**
+ * @brief 处理一段差分包 (必须从 UpgradeDelta_NextOffset() 处连续发送)
+ *
+ * 返回 UPGRADE_BANK_OK 时不一定处理完整段: 达到输出上限会提前返回,
+ * 以 UpgradeDelta_NextOffset() 为准继续发送。
+ *
+ * @param offset 差分数据流内偏移
+ */
+UpgradeBankResult UpgradeDelta_Write(uint32_t offset, const uint8_t *data,
+                                     uint16_t len);
+
+/** 是否有差分下载 (开始后到放弃或下一次开始前) */
+bool UpgradeDelta_IsActive(void);
+
+/** 差分数据流中下一个要发送的偏移 */
+uint32_t UpgradeDelta_NextOffset(void);
+
+/** 新镜像是否已全部还原 (之后用 UpgradeBank_Commit() 提交) */
+bool UpgradeDelta_IsComplete(void);
+
+/** 放弃差分下载 (同时调用 UpgradeBank_Abort()) */
+void UpgradeDelta_Abort(void);
+
+void UpgradeDelta_GetStats(UpgradeDeltaStats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UPGRADE_DELTA_H__ */
@@ -11,6 +11,7 @@
 #define LOG_TAG "upgrade_storage"
 
 #include "upgrade_storage.h"
+#include "utility.h"
 #include <elog.h>
 #include <fal.h>
 #include <string.h>
@@ -26,25 +27,6 @@
 static const struct fal_partition *s_upgrade_part = NULL;
 static bool s_initialized = false;
 
-/*============================================================================
- * CRC32 计算 (简化版)
- *===========================================================================*/
-
-static uint32_t calc_crc32(const uint8_t *data, size_t len) {
-  uint32_t crc = 0xFFFFFFFF;
-  for (size_t i = 0; i < len; i++) {
-    crc ^= data[i];
-    for (int j = 0; j < 8; j++) {
-      if (crc & 1) {
-        crc = (crc >> 1) ^ 0xEDB88320;
-      } else {
-        crc >>= 1;
-      }
-    }
-  }
-  return ~crc;
-}
-
 /*============================================================================
  * API 实现
  *===========================================================================*/
@@ -100,7 +82,7 @@ bool UpgradeStorage_SaveParams(uint8_t station_id, uint8_t mode,
 
   /* 计算CRC (不包括checksum字段本身) */
   data.checksum =
-      calc_crc32((const uint8_t *)&data, sizeof(data) - sizeof(data.checksum));
+      util_crc32((const uint8_t *)&data, sizeof(data) - sizeof(data.checksum));
 
   /* 擦除分区 (至少擦除一个扇区) */
   if (fal_partition_erase(s_upgrade_part, 0, s_upgrade_part->len) < 0) {
@@ -110,7 +92,8 @@ bool UpgradeStorage_SaveParams(uint8_t station_id, uint8_t mode,
 
   /* 写入数据 */
   if (fal_partition_write(s_upgrade_part, 0, (const uint8_t *)&data,
-                          sizeof(data)) < 0) {
+                          sizeof(data)) < 0 ||
+      fal_flash_fm33lg04_sync() != 0) {
     log_e("写入数据失败");
     return false;
   }
@@ -162,7 +145,7 @@ bool UpgradeStorage_ReadParams(UpgradeStorageData_t *data) {
 
   /* 验证CRC */
   uint32_t calc_crc =
-      calc_crc32((const uint8_t *)data, sizeof(*data) - sizeof(data->checksum));
+      util_crc32((const uint8_t *)data, sizeof(*data) - sizeof(data->checksum));
   if (calc_crc != data->checksum) {
     log_e("CRC校验失败: 0x%08lX != 0x%08lX", (unsigned long)calc_crc,
           (unsigned long)data->checksum);
@@ -185,7 +168,7 @@ bool UpgradeStorage_SetUpgradeFlag(uint8_t flag) {
 
   /* 重新计算CRC */
   data.checksum =
-      calc_crc32((const uint8_t *)&data, sizeof(data) - sizeof(data.checksum));
+      util_crc32((const uint8_t *)&data, sizeof(data) - sizeof(data.checksum));
 
   /* 擦除并写入 */
   if (fal_partition_erase(s_upgrade_part, 0, s_upgrade_part->len) < 0) {
@@ -193,11 +176,14 @@ bool UpgradeStorage_SetUpgradeFlag(uint8_t flag) {
   }
 
   if (fal_partition_write(s_upgrade_part, 0, (const uint8_t *)&data,
-                          sizeof(data)) < 0) {
+                          sizeof(data)) < 0 ||
+      fal_flash_fm33lg04_sync() != 0) {
     return false;
   }
 
-  log_i("升级标志已设置为: %s", flag ? "升级模式" : "正常启动");
+  log_i("升级标志已设置为: %s",
+        flag == UPGRADE_FLAG_INSTALL ? "安装B区"
+                                     : (flag ? "升级模式" : "正常启动"));
   return true;
 }
 
@@ -42,7 +42,7 @@ typedef struct {
   uint16_t fw_size_kb;  /**< 固件大小(KB) */
   uint16_t chip_code;   /**< 芯片代码 (与魔数中的chip_code一致) */
   uint8_t vendor_code;  /**< 厂商代码 */
-  uint8_t upgrade_flag; /**< 升级标志: 0=正常启动, 1=进入升级模式 */
+  uint8_t upgrade_flag; /**< 升级标志: 0=正常启动, 1=进入升级模式, 2=安装B区 */
   uint32_t checksum;    /**< CRC32校验 */
 } UpgradeStorageData_t;
 #pragma pack()
@@ -54,6 +54,7 @@ typedef struct {
 /* 升级标志 */
 #define UPGRADE_FLAG_NORMAL 0x00  /**< 正常启动 */
 #define UPGRADE_FLAG_UPGRADE 0x01 /**< 进入升级模式 */
+#define UPGRADE_FLAG_INSTALL 0x02 /**< B区有已校验的新固件, 拷贝到APP区后启动 */
 
 /*============================================================================
  * API 函数
@@ -98,7 +99,7 @@ bool UpgradeStorage_ReadParams(UpgradeStorageData_t *data);
  *
  * 设置后下次启动Bootloader会检测到升级请求
  *
- * @param flag UPGRADE_FLAG_NORMAL 或 UPGRADE_FLAG_UPGRADE
+ * @param flag UPGRADE_FLAG_NORMAL / UPGRADE_FLAG_UPGRADE / UPGRADE_FLAG_INSTALL
  * @return true: 成功, false: 失败
  */
 bool UpgradeStorage_SetUpgradeFlag(uint8_t flag);
@@ -0,0 +1,161 @@
+/**
+ * @file step_exec_bench.c
+ * @brief 测试步骤执行器 (step_executor.c) 串行/并行对比 (本机运行)
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * 由 VscodeGcc/scripts/overlap_sim.py 与 step_executor.c 一起编译。
+ * 步骤表与 Src/Test_List.c 的 test_buzhou_biao 相同 (步骤号、资源、前置),
+ * poll 换成被测板/电源的模型, 时间用虚拟时钟: 主循环每轮 1ms,
+ * 阻塞的测量 (ADC采样、INA219 约500ms) 直接推进时钟。
+ *
+ * 从标准输入每行读取一次测试的场景 (单位 ms, 相对测试开始):
+ *   vcc_ok main_ok vdd_ok boot reply net adc ina net_rel resend
+ *     vcc_ok/main_ok/vdd_ok  该路电压进入合格范围的时刻
+ *     boot                   被测板可以应答串口的时刻
+ *     reply                  被测板应答延时
+ *     net                    5G注册完成 (查询上告合格) 的时刻
+ *     net_rel                1: net 改为从设置表号成功起算 (被测板收到表号后才开始注册)
+ *     adc / ina              一次电压检测 / 功耗测试的阻塞时间
+ *     resend                 串口命令无合格应答时的重发间隔 (固件为3000)
+ * 分别以串行和并行执行, 每种输出一行:
+ *   serial|overlap 总耗时us 步骤耗时之和us 关键路径(步骤号,逗号分隔)
+ *   开始us,结束us ... (按表顺序)
+ */
+
+#include "step_executor.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Inc/Test_List.h */
+#define TEST_RES_SUPPLY (1U << 0)
+#define TEST_RES_UART0 (1U << 1)
+#define TEST_RES_ADC (1U << 2)
+#define TEST_RES_INA219 (1U << 3)
+
+enum { W_START = 1, W_ZHUDIAN, W_VDD, W_SWITCH, W_BIAOHAO, W_SHANGGAO, W_GONGHAO };
+
+typedef struct {
+  uint32_t vcc_ok, main_ok, vdd_ok, boot, reply, net, adc, ina, net_rel, resend;
+} Scenario_t;
+
+static Scenario_t s_sc;
+static uint32_t s_now_us;
+static uint32_t s_reply_due; /**< 被测板应答到达时刻 (0=无) */
+static uint32_t s_net_ready; /**< 5G注册完成时刻 */
+
+static uint32_t get_us(void) { return s_now_us; }
+static uint32_t now_ms(void) { return s_now_us / 1000; }
+static void block_ms(uint32_t ms) { s_now_us += ms * 1000; }
+
+static StepExecResult_t adc_check(uint32_t ok_ms) {
+  if (!StepExec_Every(1000)) {
+    return STEP_EXEC_BUSY;
+  }
+  block_ms(s_sc.adc);
+  return now_ms() >= ok_ms ? STEP_EXEC_DONE : STEP_EXEC_BUSY;
+}
+
+static StepExecResult_t step_vcc(void) { return adc_check(s_sc.vcc_ok); }
+static StepExecResult_t step_zhudian(void) { return adc_check(s_sc.main_ok); }
+static StepExecResult_t step_vdd(void) { return adc_check(s_sc.vdd_ok); }
+
+static StepExecResult_t step_switch(void) {
+  s_reply_due = 0;
+  return STEP_EXEC_DONE;
+}
+
+/** 一问一答, 每 resend 毫秒重发; ready_ms 之前发出的请求没有 (合格的) 应答 */
+static StepExecResult_t dut_exchange(uint32_t ready_ms) {
+  if (s_reply_due != 0 && now_ms() >= s_reply_due) {
+    s_reply_due = 0;
+    return STEP_EXEC_DONE;
+  }
+  if (StepExec_Every(s_sc.resend)) {
+    s_reply_due = now_ms() >= ready_ms ? now_ms() + s_sc.reply : 0;
+  }
+  return STEP_EXEC_BUSY;
+}
+
+static StepExecResult_t step_biaohao(void) {
+  StepExecResult_t r = dut_exchange(s_sc.boot);
+  if (r == STEP_EXEC_DONE && s_sc.net_rel) {
+    s_net_ready = now_ms() + s_sc.net;
+  }
+  return r;
+}
+static StepExecResult_t step_shanggao(void) { return dut_exchange(s_net_ready); }
+
+static StepExecResult_t step_gonghao(void) {
+  block_ms(s_sc.ina);
+  return STEP_EXEC_DONE;
+}
+
+#define STEP_BIT(i) (1U << (i))
+static const StepExecStep_t s_steps[] = {
+    {W_START, TEST_RES_ADC, 0, NULL, step_vcc},
+    {W_ZHUDIAN, TEST_RES_ADC, STEP_BIT(0), NULL, step_zhudian},
+    {W_VDD, TEST_RES_ADC, STEP_BIT(1), NULL, step_vdd},
+    {W_SWITCH, TEST_RES_SUPPLY | TEST_RES_UART0, STEP_BIT(0), NULL, step_switch},
+    {W_BIAOHAO, TEST_RES_UART0, STEP_BIT(3), NULL, step_biaohao},
+    {W_SHANGGAO, TEST_RES_UART0, STEP_BIT(4), NULL, step_shanggao},
+    {W_GONGHAO, TEST_RES_SUPPLY | TEST_RES_INA219 | TEST_RES_ADC, STEP_BIT(5),
+     NULL, step_gonghao},
+};
+#define STEP_NUM (sizeof(s_steps) / sizeof(s_steps[0]))
+
+static int run(bool serial) {
+  uint8_t path[STEP_EXEC_MAX_STEPS];
+  uint32_t total, busy;
+  uint8_t n, i;
+
+  s_now_us = 1000; // 0 留给"无应答"
+  s_reply_due = 0;
+  s_net_ready = s_sc.net_rel ? 0xFFFFFFFFu : s_sc.net + 1;
+  StepExec_SetSerial(serial);
+  if (!StepExec_Start(s_steps, STEP_NUM)) {
+    return 1;
+  }
+  while (StepExec_Process()) {
+    s_now_us += 1000;
+    if (s_now_us > 600000000u) {
+      fprintf(stderr, "run did not finish\n");
+      return 1;
+    }
+  }
+  StepExec_GetTotals(&total, &busy);
+  n = StepExec_CriticalPath(path, sizeof(path));
+  printf("%s %u %u ", serial ? "serial" : "overlap", total, busy);
+  for (i = 0; i < n; i++) {
+    printf("%s%d", i ? "," : "", s_steps[path[i]].id);
+  }
+  for (i = 0; i < STEP_NUM; i++) {
+    const StepExecRecord_t *rec = StepExec_GetRecord(i);
+    printf(" %u,%u", rec->start_us - 1000, rec->end_us - 1000);
+  }
+  printf("\n");
+  return StepExec_IsPassed() ? 0 : 1;
+}
+
+int main(void) {
+  char line[256];
+
+  StepExec_SetTimeSource(get_us);
+  while (fgets(line, sizeof(line), stdin) != NULL) {
+    if (sscanf(line, "%u %u %u %u %u %u %u %u %u %u", &s_sc.vcc_ok, &s_sc.main_ok,
+               &s_sc.vdd_ok, &s_sc.boot, &s_sc.reply, &s_sc.net, &s_sc.adc,
+               &s_sc.ina, &s_sc.net_rel, &s_sc.resend) != 10) {
+      continue;
+    }
+    // 场景时刻相对测试开始 (虚拟时钟从1ms起)
+    s_sc.vcc_ok += 1;
+    s_sc.main_ok += 1;
+    s_sc.vdd_ok += 1;
+    s_sc.boot += 1;
+    if (run(true) != 0 || run(false) != 0) {
+      return 1;
+    }
+    fflush(stdout);
+  }
+  return 0;
+}
@@ -0,0 +1,304 @@
+/**
+ * @file step_executor.c
+ * @brief 测试步骤并行执行器 - 实现
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * RAM占用约 STEP_EXEC_MAX_STEPS * 20 + 20 字节
+ */
+
+#define LOG_TAG "step_exec"
+
+#include "step_executor.h"
+#include <elog.h>
+#include <string.h>
+
+/*============================================================================
+ *                          内部状态
+ *===========================================================================*/
+
+static uint32_t (*s_get_us)(void) = NULL;
+static StepExecEventFunc s_event_func = NULL;
+static bool s_serial = false;
+
+static const StepExecStep_t *s_steps = NULL;
+static uint8_t s_count = 0;
+static StepExecRecord_t s_rec[STEP_EXEC_MAX_STEPS];
+
+static bool s_running = false;
+static bool s_passed = false;
+static uint32_t s_run_start_us = 0;
+static uint8_t s_held = 0;     /**< 运行中步骤占用的资源 */
+static uint16_t s_done = 0;    /**< 已完成步骤 (下标位掩码) */
+static uint8_t s_active = 0;   /**< 运行中步骤数 */
+static uint8_t s_cur = STEP_EXEC_NONE; /**< 正在 poll 的步骤 */
+
+/*============================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+static uint32_t now_us(void) { return s_get_us != NULL ? s_get_us() : 0; }
+
+/** a 是否晚于 b (计数回绕安全) */
+static bool later(uint32_t a, uint32_t b) { return (int32_t)(a - b) > 0; }
+
+static void notify(uint8_t i) {
+  if (s_event_func != NULL) {
+    s_event_func(i, &s_steps[i], &s_rec[i]);
+  }
+}
+
+/**
+ * @brief 步骤 i 开始时的"原因": 前置步骤和资源冲突步骤中最后完成的一个
+ * @note 串行模式下任意已完成步骤都算 (上一个完成的步骤)
+ */
+static uint8_t find_cause(uint8_t i) {
+  uint8_t best = STEP_EXEC_NONE;
+  uint8_t j;
+
+  for (j = 0; j < s_count; j++) {
+    if (s_rec[j].state != STEP_EXEC_FINISHED) {
+      continue;
+    }
+    if (!s_serial && !(s_steps[i].after & (1U << j)) &&
+        !(s_steps[i].resources & s_steps[j].resources)) {
+      continue;
+    }
+    if (best == STEP_EXEC_NONE || later(s_rec[j].end_us, s_rec[best].end_us)) {
+      best = j;
+    }
+  }
+  return best;
+}
+
+/** @brief 按表顺序启动前置已完成且资源空闲的步骤 */
+static void start_ready(void) {
+  uint8_t i;
+
+  for (i = 0; i < s_count; i++) {
+    const StepExecStep_t *step = &s_steps[i];
+
+    if (s_serial && s_active > 0) {
+      return;
+    }
+    if (s_rec[i].state != STEP_EXEC_PENDING ||
+        (step->after & ~s_done) != 0 || (step->resources & s_held) != 0) {
+      if (s_serial && s_rec[i].state == STEP_EXEC_PENDING) {
+        return; // 串行: 严格按表顺序
+      }
+      continue;
+    }
+    s_rec[i].cause = find_cause(i);
+    s_rec[i].state = STEP_EXEC_RUNNING;
+    s_rec[i].start_us = now_us();
+    s_rec[i].armed = false;
+    s_held |= step->resources;
+    s_active++;
+    if (step->start != NULL) {
+      step->start();
+    }
+    notify(i);
+  }
+}
+
+static void finish(uint8_t i, StepExecState_t state) {
+  s_rec[i].state = (uint8_t)state;
+  s_rec[i].end_us = now_us();
+  s_held &= (uint8_t)~s_steps[i].resources;
+  s_active--;
+  if (state == STEP_EXEC_FINISHED) {
+    s_done |= (uint16_t)(1U << i);
+  }
+  notify(i);
+}
+
+/*============================================================================
+ *                          API 实现
+ *===========================================================================*/
+
+void StepExec_SetTimeSource(uint32_t (*get_us)(void)) { s_get_us = get_us; }
+
+void StepExec_SetEventFunc(StepExecEventFunc func) { s_event_func = func; }
+
+void StepExec_SetSerial(bool serial) { s_serial = serial; }
+
+bool StepExec_Start(const StepExecStep_t *steps, uint8_t count) {
+  uint8_t i;
+
+  s_running = false;
+  if (steps == NULL || count == 0 || count > STEP_EXEC_MAX_STEPS) {
+    return false;
+  }
+  for (i = 0; i < count; i++) {
+    // 前置步骤只能在表中靠前, 保证没有循环依赖
+    if (steps[i].poll == NULL || (steps[i].after >> i) != 0) {
+      log_e("步骤表第%d项无效", i);
+      return false;
+    }
+  }
+  s_steps = steps;
+  s_count = count;
+  memset(s_rec, 0, sizeof(s_rec));
+  for (i = 0; i < count; i++) {
+    s_rec[i].cause = STEP_EXEC_NONE;
+  }
+  s_held = 0;
+  s_done = 0;
+  s_active = 0;
+  s_passed = false;
+  s_run_start_us = now_us();
+  s_running = true;
+  return true;
+}
+
+bool StepExec_Process(void) {
+  uint8_t i;
+
+  if (!s_running) {
+    return false;
+  }
+  start_ready();
+  for (i = 0; i < s_count; i++) {
+    StepExecResult_t r;
+
+    if (s_rec[i].state != STEP_EXEC_RUNNING) {
+      continue;
+    }
+    s_cur = i;
+    r = s_steps[i].poll();
+    s_cur = STEP_EXEC_NONE;
+    if (r == STEP_EXEC_BUSY && s_steps[i].timeout_ms != 0 &&
+        now_us() - s_rec[i].start_us >= s_steps[i].timeout_ms * 1000U) {
+      log_w("步骤%d超时 (%lums)", s_steps[i].id,
+            (unsigned long)s_steps[i].timeout_ms);
+      r = STEP_EXEC_FAIL;
+    }
+    if (r == STEP_EXEC_DONE) {
+      finish(i, STEP_EXEC_FINISHED);
+    } else if (r == STEP_EXEC_FAIL) {
+      finish(i, STEP_EXEC_FAILED);
+      s_running = false;
+      return false;
+    }
+  }
+  if (s_done == (uint16_t)((1UL << s_count) - 1)) {
+    s_running = false;
+    s_passed = true;
+    return false;
+  }
+  // 本轮完成的步骤释放了资源, 后继步骤不必等下一轮
+  start_ready();
+  return true;
+}
+
+void StepExec_Abort(void) { s_running = false; }
+
+bool StepExec_IsRunning(void) { return s_running; }
+
+bool StepExec_IsPassed(void) { return s_passed; }
+
+bool StepExec_Every(uint32_t ms) {
+  StepExecRecord_t *rec;
+  uint32_t now;
+
+  if (s_cur == STEP_EXEC_NONE || s_get_us == NULL) {
+    return true;
+  }
+  rec = &s_rec[s_cur];
+  now = s_get_us();
+  if (!rec->armed || now - rec->last_us >= ms * 1000U) {
+    rec->armed = true;
+    rec->last_us = now;
+    rec->count++;
+    return true;
+  }
+  return false;
+}
+
+uint16_t StepExec_Count(void) {
+  return s_cur != STEP_EXEC_NONE ? s_rec[s_cur].count : 0;
+}
+
+uint8_t StepExec_Current(void) { return s_cur; }
+
+uint8_t StepExec_FirstPending(void) {
+  uint8_t i;
+
+  for (i = 0; i < s_count; i++) {
+    if (s_rec[i].state != STEP_EXEC_FINISHED) {
+      return i;
+    }
+  }
+  return STEP_EXEC_NONE;
+}
+
+const StepExecRecord_t *StepExec_GetRecord(uint8_t index) {
+  return index < s_count ? &s_rec[index] : NULL;
+}
+
+uint8_t StepExec_CriticalPath(uint8_t *path, uint8_t max) {
+  uint8_t last = STEP_EXEC_NONE;
+  uint8_t n = 0;
+  uint8_t i;
+
+  for (i = 0; i < s_count; i++) {
+    if (s_rec[i].state != STEP_EXEC_FINISHED && s_rec[i].state != STEP_EXEC_FAILED) {
+      continue;
+    }
+    if (last == STEP_EXEC_NONE || later(s_rec[i].end_us, s_rec[last].end_us)) {
+      last = i;
+    }
+  }
+  // 从最后完成的步骤沿原因回溯, 再倒序
+  for (i = last; i != STEP_EXEC_NONE && n < max; i = s_rec[i].cause) {
+    path[n++] = i;
+  }
+  for (i = 0; i < n / 2; i++) {
+    uint8_t t = path[i];
+    path[i] = path[n - 1 - i];
+    path[n - 1 - i] = t;
+  }
+  return n;
+}
+
+void StepExec_GetTotals(uint32_t *total_us, uint32_t *busy_us) {
+  uint32_t end = s_run_start_us;
+  uint32_t busy = 0;
+  uint8_t i;
+
+  for (i = 0; i < s_count; i++) {
+    if (s_rec[i].state != STEP_EXEC_FINISHED && s_rec[i].state != STEP_EXEC_FAILED) {
+      continue;
+    }
+    busy += s_rec[i].end_us - s_rec[i].start_us;
+    if (later(s_rec[i].end_us, end)) {
+      end = s_rec[i].end_us;
+    }
+  }
+  *total_us = end - s_run_start_us;
+  *busy_us = busy;
+}
+
+void StepExec_Print(void) {
+  uint8_t path[STEP_EXEC_MAX_STEPS];
+  uint32_t total, busy;
+  uint8_t n, i;
+
+  StepExec_GetTotals(&total, &busy);
+  log_i("测试 %ums, 步骤耗时之和 %ums%s", total / 1000, busy / 1000,
+        s_serial ? " (串行)" : "");
+  for (i = 0; i < s_count; i++) {
+    const StepExecRecord_t *rec = &s_rec[i];
+    if (rec->state != STEP_EXEC_FINISHED && rec->state != STEP_EXEC_FAILED) {
+      continue;
+    }
+    log_i("  步骤%d: +%ums 耗时%ums 等待%d", s_steps[i].id,
+          (rec->start_us - s_run_start_us) / 1000,
+          (rec->end_us - rec->start_us) / 1000,
+          rec->cause == STEP_EXEC_NONE ? -1 : s_steps[rec->cause].id);
+  }
+  n = StepExec_CriticalPath(path, sizeof(path));
+  for (i = 0; i < n; i++) {
+    log_i("  关键路径 %d/%d: 步骤%d", i + 1, n, s_steps[path[i]].id);
+  }
+}
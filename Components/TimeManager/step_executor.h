@@ -0,0 +1,202 @@
+/**
+ * @file step_executor.h
+ * @brief 测试步骤并行执行器 (按资源和前置步骤调度的协作式状态机)
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * @section intro 简介
+ * 原测试流程是一条串行状态机: 等待被测板应答的几秒内, 与串口无关的
+ * ADC 电压检测也只能干等。本模块把每个步骤描述为:
+ *   - 占用的资源 (位掩码, 如 供电继电器/UART0/ADC/INA219), 运行期间独占
+ *   - 前置步骤 (表内下标的位掩码), 全部完成后才能开始
+ *   - poll 函数: 每轮主循环调用一次, 不阻塞, 返回 忙/完成/失败
+ * 每轮按表顺序启动所有 前置已完成且资源空闲 的步骤, 再轮询运行中的步骤,
+ * 互不冲突的步骤因此交错进行。
+ *
+ * @section timer 步骤定时
+ * 步骤内的重试/重发间隔用 StepExec_Every(): 步骤第一次调用返回 true,
+ * 之后每隔 ms 返回一次 true。每个步骤有自己的计时, 不再共用
+ * Test_quanju_canshu_L.time_softdelay_ms。StepExec_Count() 为本步骤
+ * StepExec_Every() 返回 true 的次数, 用于限制复测/重发次数。
+ * 步骤描述中 timeout_ms 不为0时, 步骤运行超过该时间即判失败。
+ *
+ * @section report 关键路径
+ * 步骤开始时记录"原因": 前置步骤和资源冲突步骤中最后完成的一个。
+ * 从最后完成的步骤沿原因回溯即为本次测试的关键路径; 各步骤耗时之和
+ * 与实际总耗时之比即为并行带来的缩短。串行模式 (StepExec_SetSerial)
+ * 一次只运行一个步骤, 按表顺序, 与原流程相同, 用于对比或回退。
+ *
+ * 使用方法:
+ *   StepExec_Start(表, 步骤数);      开始一次测试
+ *   while (StepExec_Process()) {}    主循环每轮调用, 全部完成或失败后返回 false
+ */
+
+#ifndef __STEP_EXECUTOR_H__
+#define __STEP_EXECUTOR_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================================
+ *                          配置
+ *===========================================================================*/
+
+/** 一张步骤表最多的步骤数 (前置步骤掩码为 uint16_t) */
+#define STEP_EXEC_MAX_STEPS 16
+
+/** 无步骤 (原因/当前步骤) */
+#define STEP_EXEC_NONE 0xFF
+
+/*============================================================================
+ *                          数据结构
+ *===========================================================================*/
+
+/**
+ * @brief poll 返回值
+ */
+typedef enum {
+  STEP_EXEC_BUSY = 0, /**< 未完成, 下一轮继续调用 */
+  STEP_EXEC_DONE,     /**< 完成, 释放资源 */
+  STEP_EXEC_FAIL,     /**< 失败, 停止整个测试 */
+} StepExecResult_t;
+
+/**
+ * @brief 步骤状态
+ */
+typedef enum {
+  STEP_EXEC_PENDING = 0, /**< 等待前置步骤或资源 */
+  STEP_EXEC_RUNNING,     /**< 运行中 */
+  STEP_EXEC_FINISHED,    /**< 已完成 */
+  STEP_EXEC_FAILED,      /**< 失败 */
+} StepExecState_t;
+
+/**
+ * @brief 步骤描述 (常量表)
+ */
+typedef struct {
+  uint8_t id;                    /**< 步骤号 (日志/耗时剖析/上报用) */
+  uint8_t resources;             /**< 占用的资源, 位掩码 */
+  uint16_t after;                /**< 前置步骤, 表内下标的位掩码 */
+  void (*start)(void);           /**< 开始时调用一次, 可为NULL */
+  StepExecResult_t (*poll)(void); /**< 每轮调用, 不阻塞 */
+  uint32_t timeout_ms;           /**< 步骤超时, 0=不限 */
+} StepExecStep_t;
+
+/**
+ * @brief 单个步骤的执行记录 (时间为 StepExec_SetTimeSource 的微秒计数)
+ */
+typedef struct {
+  uint8_t state;     /**< StepExecState_t */
+  uint8_t cause;     /**< 决定开始时刻的步骤下标, STEP_EXEC_NONE=测试开始即可运行 */
+  uint32_t start_us; /**< 开始时刻 */
+  uint32_t end_us;   /**< 结束时刻 */
+  uint32_t last_us;  /**< StepExec_Every 上次触发时刻 */
+  uint16_t count;    /**< StepExec_Every 触发次数 */
+  bool armed;        /**< StepExec_Every 已触发过 */
+} StepExecRecord_t;
+
+/**
+ * @brief 步骤事件回调 (开始和结束各一次)
+ * @param index 表内下标
+ * @param step  步骤描述
+ * @param rec   执行记录, rec->state 为 RUNNING 表示开始
+ */
+typedef void (*StepExecEventFunc)(uint8_t index, const StepExecStep_t *step,
+                                  const StepExecRecord_t *rec);
+
+/*============================================================================
+ *                          API
+ *===========================================================================*/
+
+/**
+ * @brief 设置微秒时间源 (未设置时 StepExec_Every 总是返回 true)
+ */
+void StepExec_SetTimeSource(uint32_t (*get_us)(void));
+
+/**
+ * @brief 设置步骤开始/结束回调, 可为NULL
+ */
+void StepExec_SetEventFunc(StepExecEventFunc func);
+
+/**
+ * @brief 串行模式: 一次只运行一个步骤, 按表顺序 (与原状态机相同)
+ */
+void StepExec_SetSerial(bool serial);
+
+/**
+ * @brief 开始一次测试 (放弃进行中的测试)
+ * @return false: 参数错误 (步骤数超过 STEP_EXEC_MAX_STEPS 或前置步骤不在表前面)
+ */
+bool StepExec_Start(const StepExecStep_t *steps, uint8_t count);
+
+/**
+ * @brief 调度一轮: 启动可运行的步骤, 轮询运行中的步骤
+ * @return true: 测试进行中
+ */
+bool StepExec_Process(void);
+
+/**
+ * @brief 放弃进行中的测试 (整体超时等), 不再调用任何步骤
+ */
+void StepExec_Abort(void);
+
+/** 测试进行中 */
+bool StepExec_IsRunning(void);
+
+/** 上次测试是否全部完成 (无失败、未放弃) */
+bool StepExec_IsPassed(void);
+
+/**
+ * @brief 在 poll 中调用: 本步骤第一次调用返回 true, 之后每隔 ms 返回一次 true
+ */
+bool StepExec_Every(uint32_t ms);
+
+/**
+ * @brief 在 poll 中调用: 本步骤 StepExec_Every() 已返回 true 的次数
+ */
+uint16_t StepExec_Count(void);
+
+/**
+ * @brief 在 poll 中调用: 本步骤的表内下标 (其他时候为 STEP_EXEC_NONE)
+ */
+uint8_t StepExec_Current(void);
+
+/**
+ * @brief 表顺序中第一个未完成的步骤下标 (兼容原流程的"当前步骤")
+ * @return STEP_EXEC_NONE: 全部完成
+ */
+uint8_t StepExec_FirstPending(void);
+
+/**
+ * @brief 获取执行记录
+ * @return NULL: 下标无效
+ */
+const StepExecRecord_t *StepExec_GetRecord(uint8_t index);
+
+/**
+ * @brief 上次测试的关键路径 (从第一个步骤到最后完成的步骤)
+ * @param path 输出表内下标
+ * @param max  path 容量
+ * @return 路径上的步骤数
+ */
+uint8_t StepExec_CriticalPath(uint8_t *path, uint8_t max);
+
+/**
+ * @brief 上次测试的总耗时和各步骤耗时之和 (us)
+ */
+void StepExec_GetTotals(uint32_t *total_us, uint32_t *busy_us);
+
+/**
+ * @brief 打印上次测试的各步骤时间和关键路径到日志
+ */
+void StepExec_Print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STEP_EXECUTOR_H__ */
@@ -0,0 +1,206 @@
+/**
+ * @file step_profiler.c
+ * @brief 测试步骤耗时剖析 - 实现
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * RAM占用约 (STEP_PROF_MAX_STEPS + 1) * (24 + 4 * STEP_PROF_WINDOW)
+ * + 2 * STEP_PROF_TIMELINE_MAX * 12 字节 (默认约1.8KB)
+ */
+
+#define LOG_TAG "step_prof"
+
+#include "step_profiler.h"
+#include <elog.h>
+#include <string.h>
+
+/*============================================================================
+ *                          内部状态
+ *===========================================================================*/
+
+/** @brief 单项累计统计 */
+typedef struct {
+  uint32_t count;
+  uint32_t min_us;
+  uint32_t max_us;
+  uint64_t sum_us;
+  uint32_t window[STEP_PROF_WINDOW]; /**< 最近N次耗时 (环形) */
+  uint8_t win_pos;
+} StepProfStat_t;
+
+static uint32_t (*s_get_us)(void) = NULL;
+
+static StepProfStat_t s_steps[STEP_PROF_MAX_STEPS];
+static StepProfStat_t s_cycle;
+
+/** @brief 进行中的测试 */
+static bool s_run_active = false;
+static uint32_t s_run_start_us = 0;
+static uint8_t s_cur_step = STEP_PROF_NONE;
+static uint32_t s_step_start_us = 0;
+static StepProfTimeline_t s_run_timeline;
+
+/** @brief 最近一次完整测试 */
+static StepProfTimeline_t s_last_timeline;
+
+/*============================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+static void stat_add(StepProfStat_t *stat, uint32_t us) {
+  if (stat->count == 0 || us < stat->min_us) {
+    stat->min_us = us;
+  }
+  if (us > stat->max_us) {
+    stat->max_us = us;
+  }
+  stat->count++;
+  stat->sum_us += us;
+  stat->window[stat->win_pos] = us;
+  stat->win_pos = (stat->win_pos + 1) % STEP_PROF_WINDOW;
+}
+
+static void stat_summary(const StepProfStat_t *stat, StepProfSummary_t *out) {
+  uint32_t sorted[STEP_PROF_WINDOW];
+  uint8_t n;
+  uint8_t i, j;
+
+  memset(out, 0, sizeof(*out));
+  if (stat->count == 0) {
+    return;
+  }
+  out->count = stat->count;
+  out->min_us = stat->min_us;
+  out->max_us = stat->max_us;
+  out->avg_us = (uint32_t)(stat->sum_us / stat->count);
+
+  /* 窗口插入排序后取 ceil(0.95n) 位 */
+  n = (stat->count < STEP_PROF_WINDOW) ? (uint8_t)stat->count
+                                       : STEP_PROF_WINDOW;
+  for (i = 0; i < n; i++) {
+    uint32_t v = stat->window[i];
+    for (j = i; j > 0 && sorted[j - 1] > v; j--) {
+      sorted[j] = sorted[j - 1];
+    }
+    sorted[j] = v;
+  }
+  out->p95_us = sorted[(n * 95 + 99) / 100 - 1];
+}
+
+/** @brief 步骤耗时计入统计和本次时间线 */
+static void add_segment(uint8_t step, uint32_t start_us, uint32_t dur) {
+  if (step < STEP_PROF_MAX_STEPS) {
+    stat_add(&s_steps[step], dur);
+  }
+  if (s_run_timeline.count < STEP_PROF_TIMELINE_MAX) {
+    StepProfSegment_t *seg = &s_run_timeline.segments[s_run_timeline.count++];
+    seg->step = step;
+    seg->start_us = start_us - s_run_start_us;
+    seg->dur_us = dur;
+  }
+}
+
+/** @brief 结束当前步骤并计入统计 */
+static void close_step(uint32_t now) {
+  if (s_cur_step == STEP_PROF_NONE) {
+    return;
+  }
+  add_segment(s_cur_step, s_step_start_us, now - s_step_start_us);
+  s_cur_step = STEP_PROF_NONE;
+}
+
+/** @brief 开始一次测试 (已在进行中则忽略) */
+static void begin_run(uint32_t now) {
+  if (!s_run_active) {
+    s_run_active = true;
+    s_run_start_us = now;
+    s_run_timeline.count = 0;
+  }
+}
+
+/*============================================================================
+ *                          API 实现
+ *===========================================================================*/
+
+void StepProf_SetTimeSource(uint32_t (*get_us)(void)) { s_get_us = get_us; }
+
+void StepProf_Enter(uint8_t step) {
+  uint32_t now;
+
+  if (s_get_us == NULL || step == s_cur_step) {
+    return;
+  }
+  now = s_get_us();
+  begin_run(now);
+  close_step(now);
+  s_cur_step = step;
+  s_step_start_us = now;
+}
+
+void StepProf_Exit(void) {
+  if (s_get_us == NULL) {
+    return;
+  }
+  close_step(s_get_us());
+}
+
+void StepProf_Record(uint8_t step, uint32_t start_us, uint32_t end_us) {
+  if (s_get_us == NULL) {
+    return;
+  }
+  begin_run(start_us);
+  add_segment(step, start_us, end_us - start_us);
+}
+
+void StepProf_RunEnd(void) {
+  uint32_t now;
+
+  if (s_get_us == NULL || !s_run_active) {
+    return;
+  }
+  now = s_get_us();
+  close_step(now);
+  s_run_timeline.total_us = now - s_run_start_us;
+  stat_add(&s_cycle, s_run_timeline.total_us);
+  memcpy(&s_last_timeline, &s_run_timeline, sizeof(s_last_timeline));
+  s_run_active = false;
+}
+
+bool StepProf_GetStep(uint8_t step, StepProfSummary_t *out) {
+  if (step >= STEP_PROF_MAX_STEPS) {
+    return false;
+  }
+  stat_summary(&s_steps[step], out);
+  return true;
+}
+
+void StepProf_GetCycle(StepProfSummary_t *out) { stat_summary(&s_cycle, out); }
+
+const StepProfTimeline_t *StepProf_GetTimeline(void) {
+  return &s_last_timeline;
+}
+
+void StepProf_Reset(void) {
+  memset(s_steps, 0, sizeof(s_steps));
+  memset(&s_cycle, 0, sizeof(s_cycle));
+  memset(&s_last_timeline, 0, sizeof(s_last_timeline));
+  s_run_active = false;
+  s_cur_step = STEP_PROF_NONE;
+}
+
+void StepProf_Print(void) {
+  StepProfSummary_t sum;
+  uint8_t i;
+
+  StepProf_GetCycle(&sum);
+  log_i("测试周期: %u次 min=%uus avg=%uus max=%uus p95=%uus", sum.count,
+        sum.min_us, sum.avg_us, sum.max_us, sum.p95_us);
+  for (i = 0; i < STEP_PROF_MAX_STEPS; i++) {
+    StepProf_GetStep(i, &sum);
+    if (sum.count == 0) {
+      continue;
+    }
+    log_i("  步骤%d: %u次 min=%uus avg=%uus max=%uus p95=%uus", i, sum.count,
+          sum.min_us, sum.avg_us, sum.max_us, sum.p95_us);
+  }
+}
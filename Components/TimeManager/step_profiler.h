@@ -0,0 +1,148 @@
+/**
+ * @file step_profiler.h
+ * @brief 测试步骤耗时剖析
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * 记录测试流程每个步骤的进入/退出时间 (微秒时间源，由 ATIM 自由运行计数提供)：
+ * - 每个步骤跨多次测试统计 次数/最小/平均/最大/P95 (P95 取最近
+ *   STEP_PROF_WINDOW 次)
+ * - 整个测试周期同样统计
+ * - 保存最近一次测试的时间线 (各步骤起始偏移和耗时)，用于上位机瀑布图
+ * 数据只保存在RAM中，复位清零。通过 PC 命令 0xD4 读取。
+ *
+ * 使用方法 (状态机每轮调用):
+ *   if (状态 == 空闲) StepProf_RunEnd(); else StepProf_Enter(状态);
+ * 步骤号变化时自动结束上一步骤，首个步骤自动开始一次测试。
+ * 步骤并行执行时 (step_executor.h) 改为每个步骤结束时调用
+ * StepProf_Record()，时间线中的段可以重叠。
+ */
+
+#ifndef __STEP_PROFILER_H__
+#define __STEP_PROFILER_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================================
+ *                          配置
+ *===========================================================================*/
+
+/** 最大步骤数 (步骤号 0 ~ STEP_PROF_MAX_STEPS-1) */
+#define STEP_PROF_MAX_STEPS 12
+
+/** P95 统计窗口 (最近N次) */
+#define STEP_PROF_WINDOW 20
+
+/** 单次测试时间线最大段数 (超出后不再记录时间线，统计不受影响) */
+#define STEP_PROF_TIMELINE_MAX 16
+
+/** 无步骤 */
+#define STEP_PROF_NONE 0xFF
+
+/*============================================================================
+ *                          数据结构
+ *===========================================================================*/
+
+/**
+ * @brief 耗时统计汇总 (单位 us)
+ */
+typedef struct {
+  uint32_t count;  /**< 次数 */
+  uint32_t min_us; /**< 最小 */
+  uint32_t avg_us; /**< 平均 */
+  uint32_t max_us; /**< 最大 */
+  uint32_t p95_us; /**< 最近 STEP_PROF_WINDOW 次的 P95 */
+} StepProfSummary_t;
+
+/**
+ * @brief 时间线中的一段
+ */
+typedef struct {
+  uint8_t step;      /**< 步骤号 */
+  uint32_t start_us; /**< 相对测试开始的偏移 */
+  uint32_t dur_us;   /**< 耗时 */
+} StepProfSegment_t;
+
+/**
+ * @brief 最近一次完整测试的时间线
+ */
+typedef struct {
+  uint32_t total_us;                                   /**< 测试总耗时 */
+  uint8_t count;                                       /**< 段数 */
+  StepProfSegment_t segments[STEP_PROF_TIMELINE_MAX]; /**< 各段 */
+} StepProfTimeline_t;
+
+/*============================================================================
+ *                          API
+ *===========================================================================*/
+
+/**
+ * @brief 设置微秒时间源 (未设置时不记录)
+ * @param get_us 返回单调递增微秒计数的函数
+ */
+void StepProf_SetTimeSource(uint32_t (*get_us)(void));
+
+/**
+ * @brief 进入步骤 (与当前步骤相同则忽略，不同则先结束当前步骤)
+ * @param step 步骤号
+ */
+void StepProf_Enter(uint8_t step);
+
+/**
+ * @brief 结束当前步骤
+ */
+void StepProf_Exit(void);
+
+/**
+ * @brief 记录一个已结束的步骤 (并行执行时使用，不影响 StepProf_Enter 的当前步骤)
+ * @param step 步骤号
+ * @param start_us 开始时刻 (与时间源同一计数)
+ * @param end_us 结束时刻
+ * @note 没有进行中的测试时以 start_us 作为本次测试的开始
+ */
+void StepProf_Record(uint8_t step, uint32_t start_us, uint32_t end_us);
+
+/**
+ * @brief 结束本次测试 (结束当前步骤，更新周期统计和时间线)
+ * @note 没有进行中的测试时忽略
+ */
+void StepProf_RunEnd(void);
+
+/**
+ * @brief 获取步骤耗时统计
+ * @param step 步骤号
+ * @param out 输出
+ * @return false: 步骤号无效
+ */
+bool StepProf_GetStep(uint8_t step, StepProfSummary_t *out);
+
+/**
+ * @brief 获取整个测试周期耗时统计
+ */
+void StepProf_GetCycle(StepProfSummary_t *out);
+
+/**
+ * @brief 获取最近一次完整测试的时间线
+ */
+const StepProfTimeline_t *StepProf_GetTimeline(void);
+
+/**
+ * @brief 清除全部统计
+ */
+void StepProf_Reset(void);
+
+/**
+ * @brief 打印统计到日志
+ */
+void StepProf_Print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STEP_PROFILER_H__ */
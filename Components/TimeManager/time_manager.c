@@ -22,6 +22,9 @@ static TM_State_t s_tm_state = {0};
 /** @brief 初始化标志 */
 static bool s_initialized = false;
 
+/** @brief 阻塞延时钩子 */
+static const TM_DelayHooks_t *s_delay_hooks = NULL;
+
 /*============================================================================
  *                          基础API实现
  *===========================================================================*/
@@ -247,11 +250,23 @@ bool TM_IsPeriodElapsed(TM_PeriodId_t id) {
  *                          阻塞延时API实现
  *===========================================================================*/
 
+void TM_SetDelayHooks(const TM_DelayHooks_t *hooks) { s_delay_hooks = hooks; }
+
 void TM_DelayMs(uint32_t ms) {
+  const TM_DelayHooks_t *hooks = s_delay_hooks;
   uint32_t start = s_tm_state.sys_tick;
+
+  if (hooks != NULL && hooks->enter != NULL) {
+    hooks->enter(ms);
+  }
   while (TM_GetElapsed(start) < ms) {
-    /* 空循环等待 */
-    /* 如果有看门狗，可以在这里喂狗 */
+    /* 等待期间签到, 避免长延时触发看门狗 */
+    if (hooks != NULL && hooks->poll != NULL) {
+      hooks->poll();
+    }
+  }
+  if (hooks != NULL && hooks->exit != NULL) {
+    hooks->exit();
   }
 }
 
@@ -386,6 +386,22 @@ bool TM_IsPeriodElapsed(TM_PeriodId_t id);
  */
 void TM_DelayMs(uint32_t ms);
 
+/**
+ * @brief 阻塞延时钩子
+ * @note 用于在长延时期间向看门狗签到; 未设置的回调可为NULL
+ */
+typedef struct {
+  void (*enter)(uint32_t ms); /**< 延时开始 */
+  void (*poll)(void);         /**< 延时等待中循环调用 */
+  void (*exit)(void);         /**< 延时结束 */
+} TM_DelayHooks_t;
+
+/**
+ * @brief 设置阻塞延时钩子
+ * @param hooks 钩子表 (需静态存储), NULL表示清除
+ */
+void TM_SetDelayHooks(const TM_DelayHooks_t *hooks);
+
 /**
  * @brief 阻塞延时 - 微秒级
  * @param us 延时时间(us)
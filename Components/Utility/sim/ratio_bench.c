@@ -0,0 +1,211 @@
+/**
+ * @file ratio_bench.c
+ * @brief 定点比例换算 (util_ratio_init/util_ratio_mul) 与 ADC 除法公式对比 (本机运行)
+ * @version 1.0.0
+ * @date 2026-10-16
+ *
+ * 由 VscodeGcc/scripts/adc_conv_bench.py 与 utility_convert.c 一起编译。
+ * 下面的 legacy_xxx 与 Src/ADC_CHK.c 原来的64位除法公式相同, 逐个比较:
+ *   single <ADC_VREF>...    VREF码值 1..4095 x 通道码值 0..4095 (穷举)
+ *                           -> single ADC_VREF 比较数 不同数 无法换算数
+ *   scale <起> <止>         分压系数x1000 起..止 x 引脚mV 0..4095 (穷举)
+ *                           -> scale 比较数 不同数 无法换算数
+ *   batch <ADC_VREF> <步长> 批量: 次数 1..16 x 分压倍数 x VREF之和 (按步长)
+ *                           x 通道码值之和 0..次数*4095 (穷举)
+ *                           -> batch 比较数 不同数 无法换算数
+ *   time <ADC_VREF> <轮数>  每次换算耗时 (取最快一轮)
+ *                           -> time 除法ns 倒数ns 计算倒数ns
+ * 有不同时先输出一行 diff 参数... 除法结果 倒数结果 (每条命令最多10行)。
+ */
+
+#include "utility.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CODE_MAX 4095U
+#define BATCH_MAX 16U
+#define DIFF_MAX 10
+
+static const uint8_t dividers[] = {1, 2, 5, 11, 21, 101, 255};
+
+static volatile uint32_t sink;
+static uint32_t diff_count;
+
+/* GetSingleChannelVoltage_POLL 原公式 */
+static uint32_t legacy_pin(uint32_t code, uint32_t vref, uint32_t adc_vref) {
+  return (uint32_t)(((uint64_t)code * 3000 * adc_vref) / ((uint64_t)vref * 4095));
+}
+
+/* adc_raw_to_mv 原公式 */
+static uint32_t legacy_batch(uint32_t raw_sum, uint32_t vref_sum,
+                             uint32_t adc_vref, uint8_t divider) {
+  return (uint32_t)(((uint64_t)raw_sum * 3000 * adc_vref * divider) /
+                    ((uint64_t)vref_sum * 4095));
+}
+
+static void diff(const char *what, uint32_t a, uint32_t b, uint32_t x,
+                 uint32_t want, uint32_t got) {
+  if (diff_count++ < DIFF_MAX) {
+    printf("diff %s %lu %lu %lu %lu %lu\n", what, (unsigned long)a,
+           (unsigned long)b, (unsigned long)x, (unsigned long)want,
+           (unsigned long)got);
+  }
+}
+
+static void cmd_single(uint32_t adc_vref) {
+  uint64_t checked = 0, bad = 0, nofit = 0;
+  UtilRatio r;
+
+  for (uint32_t vref = 1; vref <= CODE_MAX; vref++) {
+    if (!util_ratio_init(&r, 3000 * adc_vref, vref * 4095)) {
+      nofit++;
+      continue;
+    }
+    for (uint32_t code = 0; code <= CODE_MAX; code++) {
+      uint32_t want = legacy_pin(code, vref, adc_vref);
+      uint32_t got = util_ratio_mul(&r, code);
+      checked++;
+      if (want != got) {
+        bad++;
+        diff("single", adc_vref, vref, code, want, got);
+      }
+    }
+  }
+  printf("single %lu %llu %llu %llu\n", (unsigned long)adc_vref,
+         (unsigned long long)checked, (unsigned long long)bad,
+         (unsigned long long)nofit);
+}
+
+static void cmd_scale(uint32_t from, uint32_t to) {
+  uint64_t checked = 0, bad = 0, nofit = 0;
+  UtilRatio r;
+
+  for (uint32_t scale = from; scale <= to; scale++) {
+    if (!util_ratio_init(&r, scale, 1000)) {
+      nofit++;
+      continue;
+    }
+    for (uint32_t pin = 0; pin <= CODE_MAX; pin++) {
+      uint32_t want = pin * scale / 1000;
+      uint32_t got = util_ratio_mul(&r, pin);
+      checked++;
+      if (want != got) {
+        bad++;
+        diff("scale", scale, 1000, pin, want, got);
+      }
+    }
+  }
+  printf("scale %llu %llu %llu\n", (unsigned long long)checked,
+         (unsigned long long)bad, (unsigned long long)nofit);
+}
+
+static void cmd_batch(uint32_t adc_vref, uint32_t step) {
+  uint64_t checked = 0, bad = 0, nofit = 0;
+  UtilRatio r;
+
+  for (uint32_t n = 1; n <= BATCH_MAX; n++) {
+    for (size_t d = 0; d < sizeof(dividers); d++) {
+      uint32_t num = 3000 * adc_vref * dividers[d];
+      /* 每个次数都包含最小和最大的VREF之和 */
+      for (uint32_t vref_sum = n; vref_sum <= n * CODE_MAX;
+           vref_sum = (vref_sum == n * CODE_MAX || vref_sum + step <= n * CODE_MAX)
+                          ? vref_sum + step
+                          : n * CODE_MAX) {
+        if (!util_ratio_init(&r, num, vref_sum * 4095)) {
+          nofit++;
+          continue;
+        }
+        for (uint32_t raw = 0; raw <= n * CODE_MAX; raw++) {
+          uint32_t want = legacy_batch(raw, vref_sum, adc_vref, dividers[d]);
+          uint32_t got = util_ratio_mul(&r, raw);
+          checked++;
+          if (want != got) {
+            bad++;
+            diff("batch", vref_sum, dividers[d], raw, want, got);
+          }
+        }
+      }
+    }
+  }
+  printf("batch %llu %llu %llu\n", (unsigned long long)checked,
+         (unsigned long long)bad, (unsigned long long)nofit);
+}
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void cmd_time(uint32_t adc_vref, uint32_t rounds) {
+  /* VREF 码值经 volatile 读出, 除数不能在编译时确定 */
+  volatile uint32_t vref_in = adc_vref;
+  double best_legacy = 1e30, best_ratio = 1e30, best_init = 1e30;
+  UtilRatio r;
+
+  for (uint32_t k = 0; k < rounds; k++) {
+    uint32_t vref = vref_in;
+    uint32_t acc = 0;
+    double t0, t1;
+
+    t0 = now_ns();
+    for (uint32_t code = 0; code <= CODE_MAX; code++) {
+      acc += legacy_pin(code, vref, adc_vref);
+    }
+    t1 = now_ns();
+    if (t1 - t0 < best_legacy) {
+      best_legacy = t1 - t0;
+    }
+
+    t0 = now_ns();
+    for (uint32_t i = 0; i < 64; i++) {
+      util_ratio_init(&r, 3000 * adc_vref, (vref_in + (i & 1)) * 4095);
+      acc += r.m[0];
+    }
+    t1 = now_ns();
+    if (t1 - t0 < best_init) {
+      best_init = t1 - t0;
+    }
+
+    util_ratio_init(&r, 3000 * adc_vref, vref * 4095);
+    t0 = now_ns();
+    for (uint32_t code = 0; code <= CODE_MAX; code++) {
+      acc += util_ratio_mul(&r, code);
+    }
+    t1 = now_ns();
+    if (t1 - t0 < best_ratio) {
+      best_ratio = t1 - t0;
+    }
+    sink = acc;
+  }
+  printf("time %.3f %.3f %.3f\n", best_legacy / (CODE_MAX + 1),
+         best_ratio / (CODE_MAX + 1), best_init / 64);
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: ratio_bench single|scale|batch|time ...\n");
+    return 2;
+  }
+  diff_count = 0;
+  if (strcmp(argv[1], "single") == 0) {
+    for (int i = 2; i < argc; i++) {
+      cmd_single((uint32_t)strtoul(argv[i], NULL, 0));
+    }
+  } else if (strcmp(argv[1], "scale") == 0 && argc >= 4) {
+    cmd_scale((uint32_t)strtoul(argv[2], NULL, 0),
+              (uint32_t)strtoul(argv[3], NULL, 0));
+  } else if (strcmp(argv[1], "batch") == 0 && argc >= 4) {
+    cmd_batch((uint32_t)strtoul(argv[2], NULL, 0),
+              (uint32_t)strtoul(argv[3], NULL, 0));
+  } else if (strcmp(argv[1], "time") == 0 && argc >= 4) {
+    cmd_time((uint32_t)strtoul(argv[2], NULL, 0),
+             (uint32_t)strtoul(argv[3], NULL, 0));
+  } else {
+    fprintf(stderr, "bad command\n");
+    return 2;
+  }
+  return 0;
+}
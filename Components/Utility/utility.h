@@ -9,6 +9,7 @@
  * - CRC/校验和计算
  * - 滤波/去极值算法
  * - 数据格式转换
+ * - 定点比例换算 (预先计算倒数, 换算时只有乘法和移位)
  *
  * @section usage 使用方法
  * @code
@@ -16,6 +17,7 @@
  *
  * // CRC计算
  * uint16_t crc = util_crc16_modbus(data, len);
+ * uint32_t img = util_crc32_update(UTIL_CRC32_INIT, block, n); // 可分段
  * uint8_t sum = util_checksum_sum8(data, len);
  *
  * // 去极值滤波
@@ -23,6 +25,10 @@
  *
  * // 数据转换
  * uint16_t val = util_read_le_u16(buf);
+ *
+ * // 比例换算: 每批计算一次, 之后 floor(x * num / den) 不用除法
+ * UtilRatio r;
+ * if (util_ratio_init(&r, num, den)) { mv = util_ratio_mul(&r, code); }
  * @endcode
  */
 
@@ -41,6 +47,87 @@ extern "C" {
  *                              CRC/校验和计算
  *============================================================================*/
 
+/**
+ * @name CRC实现配置
+ * 每种CRC可单独选择实现, 在编译选项中定义 (CMake: -DUTIL_CRC_PROFILE=n)。
+ * Flash占用/速度用 VscodeGcc/scripts/crc_bench.py bench 测量。
+ * @{
+ */
+#define UTIL_CRC_PROFILE_BITWISE 0 /**< 逐位计算, 无表, 最小最慢 */
+#define UTIL_CRC_PROFILE_NIBBLE 1  /**< 16项半字节表 */
+#define UTIL_CRC_PROFILE_SLICE4 2  /**< 4x256项表, 每次4字节, 最快 */
+
+#ifndef UTIL_CRC_PROFILE
+#define UTIL_CRC_PROFILE UTIL_CRC_PROFILE_NIBBLE
+#endif
+#ifndef UTIL_CRC8_PROFILE
+#define UTIL_CRC8_PROFILE UTIL_CRC_PROFILE
+#endif
+#ifndef UTIL_CRC16_CCITT_PROFILE
+#define UTIL_CRC16_CCITT_PROFILE UTIL_CRC_PROFILE
+#endif
+#ifndef UTIL_CRC16_MODBUS_PROFILE
+#define UTIL_CRC16_MODBUS_PROFILE UTIL_CRC_PROFILE
+#endif
+/* CRC32 用于升级镜像整体校验 (数百KB), 默认取最快实现 (4KB表) */
+#ifndef UTIL_CRC32_PROFILE
+#define UTIL_CRC32_PROFILE UTIL_CRC_PROFILE_SLICE4
+#endif
+/** @} */
+
+/** @name 增量计算初始值 @{ */
+#define UTIL_CRC8_INIT 0x00
+#define UTIL_CRC16_CCITT_INIT 0x0000
+#define UTIL_CRC16_MODBUS_INIT 0xFFFF
+#define UTIL_CRC32_INIT 0x00000000 /**< 取反在 util_crc32_update 内完成 */
+/** @} */
+
+/**
+ * @brief CRC8 增量计算 (多项式 0x07, 初始值 0x00)
+ * @param crc 上次结果, 首次为 UTIL_CRC8_INIT
+ * @param data 数据缓冲区
+ * @param len 数据长度
+ * @return 新的CRC值
+ */
+uint8_t util_crc8_update(uint8_t crc, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief CRC16-CCITT 增量计算
+ * @param crc 上次结果, 首次为 UTIL_CRC16_CCITT_INIT
+ * @param data 数据缓冲区
+ * @param len 数据长度
+ * @return 新的CRC值
+ */
+uint16_t util_crc16_ccitt_update(uint16_t crc, const uint8_t *data,
+                                 uint32_t len);
+
+/**
+ * @brief CRC16-Modbus 增量计算
+ * @param crc 上次结果, 首次为 UTIL_CRC16_MODBUS_INIT
+ * @param data 数据缓冲区
+ * @param len 数据长度
+ * @return 新的CRC值
+ */
+uint16_t util_crc16_modbus_update(uint16_t crc, const uint8_t *data,
+                                  uint32_t len);
+
+/**
+ * @brief CRC32 增量计算 (与 zlib crc32() 相同)
+ * @param crc 上次结果, 首次为 UTIL_CRC32_INIT
+ * @param data 数据缓冲区
+ * @param len 数据长度
+ * @return 到目前为止数据的CRC32, 可直接作为下次的 crc 参数
+ */
+uint32_t util_crc32_update(uint32_t crc, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief 计算CRC32校验值
+ * @param data 数据缓冲区
+ * @param len 数据长度
+ * @return CRC32值
+ */
+uint32_t util_crc32(const uint8_t *data, uint32_t len);
+
 /**
  * @brief 计算CRC16-Modbus校验值
  * @param data 数据缓冲区
@@ -144,6 +231,55 @@ void util_reverse_bytes(uint8_t *data, uint16_t len);
 uint16_t util_hex_str_to_bytes(const char *hex_str, uint8_t *out_buf,
                                uint16_t max_len);
 
+/*============================================================================
+ *                              定点比例换算
+ *============================================================================*/
+
+/** util_ratio_mul() 输入上限 (16位) */
+#define UTIL_RATIO_X_MAX 0xFFFFU
+
+/**
+ * @brief 定点比例 num/den, 由 util_ratio_init() 计算
+ *
+ * m 为倒数 M = ceil(num * 2^shift / den) 按16位分段 (m[0] 最低),
+ * M <= 2^48, m[2] 最大为 0x10000。
+ */
+typedef struct {
+  uint32_t m[3]; /**< 倒数分段 */
+  uint8_t shift; /**< 定点位数 (32..48) */
+} UtilRatio;
+
+/**
+ * @brief 计算比例 num/den 的定点倒数
+ *
+ * 之后 util_ratio_mul(r, x) 对 0 <= x <= UTIL_RATIO_X_MAX 与
+ * (uint32_t)((uint64_t)x * num / den) 结果完全相同
+ * (误差项 x * (M*den - num*2^shift) < 2^shift, 不改变取整结果)。
+ * 用逐位长除法计算, 没有除法指令, 约 (32 + shift) 次循环。
+ *
+ * @param r 输出
+ * @param num 分子
+ * @param den 分母 (1..0x7FFFFFFF)
+ * @return false: 参数超出范围 (den 为0或过大, 或 num/den 整数部分与 den 的位数之和
+ *         超过32位, 无法保证结果相同), 调用方应改用除法
+ */
+bool util_ratio_init(UtilRatio *r, uint32_t num, uint32_t den);
+
+/**
+ * @brief 按 util_ratio_init() 计算的倒数换算: floor(x * num / den)
+ * @param r 比例
+ * @param x 输入 (0..UTIL_RATIO_X_MAX)
+ * @return 换算结果
+ *
+ * @note 三次32位乘法和移位: 各步中间值不超过 2^32 - 2^16, 不会溢出
+ */
+static inline uint32_t util_ratio_mul(const UtilRatio *r, uint32_t x) {
+  uint32_t t = (x * r->m[0]) >> 16;
+
+  t = (x * r->m[1] + t) >> 16;
+  return (x * r->m[2] + t) >> (r->shift - 32);
+}
+
 #ifdef __cplusplus
 }
 #endif
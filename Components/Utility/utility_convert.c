@@ -79,3 +79,52 @@ uint16_t util_hex_str_to_bytes(const char *hex_str, uint8_t *out_buf,
 
   return out_idx;
 }
+
+/*============================================================================
+ *                              定点比例换算
+ *============================================================================*/
+
+bool util_ratio_init(UtilRatio *r, uint32_t num, uint32_t den) {
+  uint64_t q = 0;
+  uint32_t rem = 0;
+  uint8_t k = 0;
+  uint8_t den_bits = 0;
+  uint8_t i;
+
+  if (r == NULL || den == 0 || den > 0x7FFFFFFFU) {
+    return false;
+  }
+
+  // k: num < den * 2^k 的最小值, 即整数部分的位数
+  while (k <= 16 && ((uint64_t)den << k) <= num) {
+    k++;
+  }
+  while (den_bits < 32 && (den >> den_bits) != 0) {
+    den_bits++;
+  }
+  // 倒数不超过 2^48 需要 shift = 48 - k, 结果相同需要 shift >= 16 + den 位数
+  if (k > 16 || k + den_bits > 32) {
+    return false;
+  }
+  r->shift = (uint8_t)(48 - k);
+
+  // 逐位长除法: num * 2^shift / den, rem < den < 2^31, 左移不溢出
+  for (i = 0; i < 32 + r->shift; i++) {
+    uint32_t bit = i < 32 ? (num >> (31 - i)) & 1U : 0;
+
+    rem = (rem << 1) | bit;
+    q <<= 1;
+    if (rem >= den) {
+      rem -= den;
+      q |= 1;
+    }
+  }
+  if (rem != 0) {
+    q++;
+  }
+
+  r->m[0] = (uint32_t)q & 0xFFFFU;
+  r->m[1] = (uint32_t)(q >> 16) & 0xFFFFU;
+  r->m[2] = (uint32_t)(q >> 32);
+  return true;
+}
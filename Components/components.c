@@ -74,6 +74,18 @@ bool Components_Init(const ComponentsConfig *config) {
   } else {
     elog_w("components", "测试统计初始化失败 (首次使用正常)");
   }
+
+  // 持久化配置 (KVDB), 恢复上次设置的调试/透传模式
+  if (JigConfig_Init()) {
+    elog_i("components", "工装配置加载成功");
+  } else {
+    elog_w("components", "工装配置不可用, 使用默认值");
+  }
+#ifdef COMPONENT_PC_PROTOCOL_CONFIG
+  PC_Config_SetDebugMode((uint8_t)JigConfig_Get(JIG_CFG_DEBUG_MODE));
+  PC_Config_SetPassThroughMode(
+      (uint8_t)JigConfig_Get(JIG_CFG_PASSTHROUGH_MODE));
+#endif
 #endif
 
 #ifdef COMPONENT_UPGRADE_STORAGE
@@ -120,6 +120,7 @@ extern "C" {
 #ifdef COMPONENT_FLASHDB
 #include "FlashDB/flash_diag.h"
 #include "FlashDB/inc/flashdb.h"
+#include "FlashDB/jig_config.h"
 #include "FlashDB/port/fal/inc/fal.h"
 #include "FlashDB/test_stats.h"
 #endif
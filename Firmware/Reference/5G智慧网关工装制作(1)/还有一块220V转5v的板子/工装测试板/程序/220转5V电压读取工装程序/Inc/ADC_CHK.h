@@ -15,4 +15,48 @@ uint32_t get_VDD4_dianya(void);
 uint32_t get_VDD5_dianya(void);
 //ȡVDD6
 uint32_t get_VDD6_dianya(void);
+
+//: ÿֻһVREFУ׼ͨβƽ/С//(mV)
+#define ADC_RAIL_MAX        8
+#define ADC_RAIL_VDD_COUNT  6
+
+typedef struct
+{
+	uint32_t channel;        //FL_ADC_EXTERNAL_CHx
+	uint8_t  divider;        //ѹ (11 = 10:1 ѹ)
+	void (*ctrl_on)(void);   //ǰ򿪼⿪, ΪNULL
+	void (*ctrl_off)(void);  //رռ⿪, ΪNULL
+} ADC_Rail_t;
+
+typedef struct
+{
+	uint32_t avg_mv;
+	uint32_t min_mv;
+	uint32_t max_mv;
+	uint32_t spread_mv;      //max - min
+	uint8_t  valid;          //0=ͨʱ
+} ADC_RailResult_t;
+
+typedef struct
+{
+	uint8_t  count;
+	uint8_t  samples;
+	uint32_t vref_raw;       //VREF1P2ƽֵ
+	uint32_t elapsed_us;     //ʱ
+	ADC_RailResult_t rail[ADC_RAIL_MAX];
+} ADC_RailSet_t;
+
+typedef struct
+{
+	uint32_t legacy_us;      //6getȡ
+	uint32_t batch_us;       //һ6·
+} ADC_RailBench_t;
+
+//VDD1~VDD6, ˳ͬget
+extern const ADC_Rail_t ADC_Rails_VDD[ADC_RAIL_VDD_COUNT];
+
+//0ɹ, 1ʧ(VREFʱ)
+uint8_t ADC_MeasureRailSet(const ADC_Rail_t *rails, uint8_t count, uint8_t samples, ADC_RailSet_t *out);
+//ȡȡʱԱ, ӡԿڲout (PC 68 A6), 0ɹ
+uint8_t ADC_RailSet_Benchmark(uint8_t samples, ADC_RailBench_t *out);
 #endif
@@ -1,5 +1,7 @@
 #include "ADC_CHK.h"
 #include "GPIO.h"
+#include "time.h"
+#include "uart1.h"
 static void MF_ADC_Common_Init(void)
 {
     FL_ADC_CommonInitTypeDef    Common_InitStruct;
@@ -250,4 +252,181 @@ uint32_t get_VDD6_dianya()
 	return test_shuju;
 }
 
+/*============================ 批量测量 (rail set) ============================*/
+// 逐个调用 get_VDDx_dianya() 时，每个通道都要重新做一次 VREF 采样、开关 VREF BUFFER
+// 并重新使能 ADC。批量测量把 VREF 校准放在批次开头只做一次，各通道多次采样后
+// 在原始码值上求 min/max/平均，最后只做三次除法换算成 mV。
 
+#define ADC_POLL_TIMEOUT 0x000FFFFFU // 单次转换等待上限 (原为 0xFFFFFFFF)
+
+// 6路VDD测量通道 (与 get_VDDx_dianya() 一一对应)
+const ADC_Rail_t ADC_Rails_VDD[ADC_RAIL_VDD_COUNT] =
+{
+	{FL_ADC_EXTERNAL_CH18, 11, NULL, NULL}, // VDD1 PD10
+	{FL_ADC_EXTERNAL_CH19, 11, NULL, NULL}, // VDD2 PE9
+	{FL_ADC_EXTERNAL_CH4, 11, NULL, NULL},  // VDD3 PA13
+	{FL_ADC_EXTERNAL_CH11, 11, NULL, NULL}, // VDD4 PA14
+	{FL_ADC_EXTERNAL_CH5, 11, NULL, NULL},  // VDD5 PA0
+	{FL_ADC_EXTERNAL_CH12, 11, NULL, NULL}, // VDD6 PA1
+};
+
+// ADC 已使能且通道已选好，触发一次转换并等待结果
+static uint8_t adc_convert_once(uint32_t *ADCRdresult)
+{
+	uint32_t counter = 0;
+
+	FL_ADC_ClearFlag_EndOfConversion(ADC);
+	FL_ADC_EnableSWConversion(ADC);
+	while (FL_ADC_IsActiveFlag_EndOfConversion(ADC) == 0U)
+	{
+		if (++counter >= ADC_POLL_TIMEOUT)
+		{
+			return 1;
+		}
+	}
+	FL_ADC_ClearFlag_EndOfConversion(ADC);
+	*ADCRdresult = FL_ADC_ReadConversionData(ADC);
+	return 0;
+}
+
+// 对一个通道连续采样，只统计原始码值
+static uint8_t adc_sample_channel(uint32_t channel, uint8_t samples,
+                                  uint32_t *sum, uint32_t *min, uint32_t *max)
+{
+	uint32_t value = 0;
+	uint8_t i;
+
+	FL_ADC_Disable(ADC);
+	FL_ADC_DisableSequencerChannel(ADC, FL_ADC_ALL_CHANNEL);
+	FL_ADC_EnableSequencerChannel(ADC, channel);
+	FL_ADC_Enable(ADC);
+
+	*sum = 0;
+	*min = 0xFFFFFFFFU;
+	*max = 0;
+	for (i = 0; i < samples; i++)
+	{
+		if (adc_convert_once(&value) != 0)
+		{
+			return 1;
+		}
+		*sum += value;
+		if (value < *min)
+		{
+			*min = value;
+		}
+		if (value > *max)
+		{
+			*max = value;
+		}
+	}
+	return 0;
+}
+
+// 原始码值换算为分压前的 mV (与 GetSingleChannelVoltage_POLL 公式一致)
+// vref_sum 为 samples 次 VREF 采样之和，raw 同样按 samples 次累加
+static uint32_t adc_raw_to_mv(uint32_t raw_sum, uint32_t vref_sum, uint8_t divider)
+{
+	return (uint32_t)(((uint64_t)raw_sum * 3000 * (ADC_VREF) * divider) / ((uint64_t)vref_sum * 4095));
+}
+
+uint8_t ADC_MeasureRailSet(const ADC_Rail_t *rails, uint8_t count, uint8_t samples, ADC_RailSet_t *out)
+{
+	uint32_t start_us = time_get_us();
+	uint32_t vref_sum = 0, vref_min = 0, vref_max = 0;
+	uint32_t sum = 0, min = 0, max = 0;
+	uint8_t i;
+	uint8_t state = 0;
+
+	if (rails == NULL || out == NULL || count == 0 || count > ADC_RAIL_MAX || samples == 0)
+	{
+		return 1;
+	}
+	memset(out, 0, sizeof(ADC_RailSet_t));
+	out->count = count;
+	out->samples = samples;
+
+	// 批次开头做一次 VREF 校准
+	FL_CMU_SetADCPrescaler(FL_CMU_ADC_PSC_DIV8);
+	FL_VREF_EnableVREFBuffer(VREF);
+	state = adc_sample_channel(FL_ADC_INTERNAL_VREF1P2, samples, &vref_sum, &vref_min, &vref_max);
+	FL_VREF_DisableVREFBuffer(VREF);
+	if (state != 0 || vref_sum == 0)
+	{
+		FL_ADC_Disable(ADC);
+		FL_ADC_DisableSequencerChannel(ADC, FL_ADC_ALL_CHANNEL);
+		return 1;
+	}
+	out->vref_raw = vref_sum / samples;
+
+	for (i = 0; i < count; i++)
+	{
+		ADC_RailResult_t *res = &out->rail[i];
+
+		if (rails[i].ctrl_on != NULL)
+		{
+			rails[i].ctrl_on();
+		}
+		state = adc_sample_channel(rails[i].channel, samples, &sum, &min, &max);
+		if (rails[i].ctrl_off != NULL)
+		{
+			rails[i].ctrl_off();
+		}
+		if (state != 0)
+		{
+			res->valid = 0;
+			continue;
+		}
+
+		// min/max 为单次码值，换算时乘以 samples 与 vref_sum 对齐
+		res->avg_mv = adc_raw_to_mv(sum, vref_sum, rails[i].divider);
+		res->min_mv = adc_raw_to_mv(min * samples, vref_sum, rails[i].divider);
+		res->max_mv = adc_raw_to_mv(max * samples, vref_sum, rails[i].divider);
+		res->spread_mv = res->max_mv - res->min_mv;
+		res->valid = 1;
+	}
+
+	FL_ADC_Disable(ADC);
+	FL_ADC_DisableSequencerChannel(ADC, FL_ADC_ALL_CHANNEL);
+
+	out->elapsed_us = time_get_us() - start_us;
+	return 0;
+}
+
+// 对比逐个读取与批量读取的总耗时 (调试用，结果打印到调试口)
+uint8_t ADC_RailSet_Benchmark(uint8_t samples, ADC_RailBench_t *out)
+{
+	ADC_RailSet_t set;
+	uint32_t start_us;
+	uint32_t legacy_us;
+	uint32_t legacy_mv[ADC_RAIL_VDD_COUNT];
+	uint8_t i;
+
+	start_us = time_get_us();
+	legacy_mv[0] = get_VDD1_dianya();
+	legacy_mv[1] = get_VDD2_dianya();
+	legacy_mv[2] = get_VDD3_dianya();
+	legacy_mv[3] = get_VDD4_dianya();
+	legacy_mv[4] = get_VDD5_dianya();
+	legacy_mv[5] = get_VDD6_dianya();
+	legacy_us = time_get_us() - start_us;
+
+	if (ADC_MeasureRailSet(ADC_Rails_VDD, ADC_RAIL_VDD_COUNT, samples, &set) != 0)
+	{
+		DeBug_print("ADC batch: measure failed\r\n");
+		return 1;
+	}
+	out->legacy_us = legacy_us;
+	out->batch_us = set.elapsed_us;
+
+	DeBug_print("ADC bench: legacy 6x1 = %luus, batch 6x%d = %luus\r\n",
+	            (unsigned long)legacy_us, samples, (unsigned long)set.elapsed_us);
+	for (i = 0; i < ADC_RAIL_VDD_COUNT; i++)
+	{
+		DeBug_print("  rail%d: legacy=%lumV avg=%lumV min=%lu max=%lu spread=%lu\r\n", i,
+		            (unsigned long)legacy_mv[i], (unsigned long)set.rail[i].avg_mv,
+		            (unsigned long)set.rail[i].min_mv, (unsigned long)set.rail[i].max_mv,
+		            (unsigned long)set.rail[i].spread_mv);
+	}
+	return 0;
+}
@@ -2,6 +2,7 @@
 #include "PC_xieyi_Ctrl.h"
 #include "LED_CTRL.h"
 #include "Test_List.h"
+#include "ADC_CHK.h"
 #include "uart0.h"
 #include "uart1.h"
 #define send_lenth 200
@@ -35,6 +36,33 @@ void PC_xieyifasong_2()
 	xieyi2_fanhui[jishu_lenth++] = 0x16;
 	PC_Chuankou_tongxin_send(xieyi2_fanhui,jishu_lenth);
 }
+//ADC批量测量耗时应答: 68 A7 工位 采样次数 状态(0成功 2测量失败) 逐个读取us(4) 批量us(4) 和校验 16
+void PC_xieyifasong_adc(uint8_t gongwei,uint8_t samples)
+{
+	uint8_t fanhui[15];
+	uint8_t i;
+	ADC_RailBench_t jieguo = {0};
+	fanhui[0] = 0x68;
+	fanhui[1] = 0xA7;
+	fanhui[2] = gongwei;
+	fanhui[3] = samples;
+	fanhui[4] = ADC_RailSet_Benchmark(samples,&jieguo)==0 ? 0 : 2;
+	fanhui[5] = (jieguo.legacy_us>>24)&0xFF;
+	fanhui[6] = (jieguo.legacy_us>>16)&0xFF;
+	fanhui[7] = (jieguo.legacy_us>>8)&0xFF;
+	fanhui[8] = jieguo.legacy_us&0xFF;
+	fanhui[9] = (jieguo.batch_us>>24)&0xFF;
+	fanhui[10] = (jieguo.batch_us>>16)&0xFF;
+	fanhui[11] = (jieguo.batch_us>>8)&0xFF;
+	fanhui[12] = jieguo.batch_us&0xFF;
+	fanhui[13] = 0;
+	for(i=0;i<13;i++)
+	{
+		fanhui[13]+=fanhui[i];
+	}
+	fanhui[14] = 0x16;
+	PC_Chuankou_tongxin_send(fanhui,15);
+}
 
 void PC_xieyijiexi(uint8_t zufuchua[],uint16_t lenth)
 {
@@ -67,6 +95,16 @@ void PC_xieyijiexi(uint8_t zufuchua[],uint16_t lenth)
 					pHead+=3;
 				}
 			}
+			else if(zufuchua[pHead+1]==0xA6&&pHead+5<lenth&&zufuchua[pHead+5]==0x16)
+			{
+				//ADC批量测量耗时: 68 A6 工位 采样次数(1~255) 和校验 16
+				hejiaoyan = zufuchua[pHead]+zufuchua[pHead+1]+zufuchua[pHead+2]+zufuchua[pHead+3];
+				if(hejiaoyan==zufuchua[pHead+4]&&zufuchua[pHead+3]>0)
+				{
+					PC_xieyifasong_adc(zufuchua[pHead+2],zufuchua[pHead+3]);
+					pHead+=4;
+				}
+			}
 		}
 		pHead++;
 	}
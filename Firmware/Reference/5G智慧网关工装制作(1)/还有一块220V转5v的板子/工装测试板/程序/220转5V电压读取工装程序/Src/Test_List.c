@@ -10,6 +10,9 @@ enum Test_liucheng Test_liucheng_L = w_wait;
 struct Test_jieguo Test_jiejuo_jilu;
 enum test_xieyi_jilu test_xieyi_jilu_Rec = No_Receive;
 
+//ÿβѯVDDĲ (ͬһֻһVREFУ׼)
+#define VDD_CAIYANG_CISHU 4
+
 void test_quanju_canshu_Init()
 {
 	Test_quanju_canshu_L.time_softdelay_ms = 10;
@@ -42,29 +45,17 @@ void test_start()
 //ֹ
 void test_simple_chk(uint8_t cunn)
 {
-	switch(cunn)
+	ADC_RailSet_t jieguo;
+
+	//λżVDDͨ (0~5ӦVDD1~VDD6), һֻһ·, βȡƽ
+	Test_jiejuo_jilu.VDD_dianya_5 = 0;
+	if(cunn >= ADC_RAIL_VDD_COUNT)
 	{
-		case 0:
-			Test_jiejuo_jilu.VDD_dianya_5 = get_VDD1_dianya();
-			break;
-		case 1:
-			Test_jiejuo_jilu.VDD_dianya_5 = get_VDD2_dianya();
-			break;
-		case 2:
-			Test_jiejuo_jilu.VDD_dianya_5 = get_VDD3_dianya();
-			break;
-		case 3:
-			Test_jiejuo_jilu.VDD_dianya_5 = get_VDD4_dianya();
-			break;
-		case 4:
-			Test_jiejuo_jilu.VDD_dianya_5 = get_VDD5_dianya();
-			break;
-		case 5:
-			Test_jiejuo_jilu.VDD_dianya_5 = get_VDD6_dianya();
-			break;
-		default:
-			Test_jiejuo_jilu.VDD_dianya_5 = 0;
-			break;
+		return;
+	}
+	if(ADC_MeasureRailSet(&ADC_Rails_VDD[cunn], 1, VDD_CAIYANG_CISHU, &jieguo) == 0 && jieguo.rail[0].valid)
+	{
+		Test_jiejuo_jilu.VDD_dianya_5 = jieguo.rail[0].avg_mv;
 	}
 }
 //ֹԵǣʱذ뿪˹װ
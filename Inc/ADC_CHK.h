@@ -15,4 +15,62 @@ uint32_t get_SY_weizhi_dianya(void);
 uint32_t get_zhudian_gongdian_weizhi_dianya(void);
 //⹤װ·ѹ
 uint32_t get_gongzhuang_MCU_gongdian_weizhi_dianya(void);
+
+//: ÿֻһVREFУ׼ͨβƽ/С//(mV)
+#define ADC_RAIL_MAX        8
+#define ADC_RAIL_MAIN_COUNT 6
+#define ADC_RAIL_NO_CALIB   0xFF
+
+//ADC_Rails_Main ±
+#define ADC_RAIL_ZHUDIAN    0   //
+#define ADC_RAIL_ERJI       1   //Դ
+#define ADC_RAIL_VCC        2   //VCC
+#define ADC_RAIL_SY         3   //ѹ
+#define ADC_RAIL_GONGDIAN   4   //繩
+#define ADC_RAIL_GONGZHUANG 5   //װ
+
+typedef struct
+{
+	uint32_t channel;        //FL_ADC_EXTERNAL_CHx
+	uint8_t  divider;        //ѹ (11 = 10:1 ѹ)
+	void (*ctrl_on)(void);   //ǰ򿪼⿪, ΪNULL
+	void (*ctrl_off)(void);  //رռ⿪, ΪNULL
+	uint8_t  calib;          //У׼ͨ CALIB_CH_xxx, ͬget; ADC_RAIL_NO_CALIB=divider
+} ADC_Rail_t;
+
+typedef struct
+{
+	uint32_t avg_mv;
+	uint32_t min_mv;
+	uint32_t max_mv;
+	uint32_t spread_mv;      //max - min
+	uint8_t  valid;          //0=ͨʱ
+} ADC_RailResult_t;
+
+typedef struct
+{
+	uint8_t  count;
+	uint8_t  samples;
+	uint32_t vref_raw;       //VREF1P2ƽֵ
+	uint32_t elapsed_us;     //ʱ
+	ADC_RailResult_t rail[ADC_RAIL_MAX];
+} ADC_RailSet_t;
+
+typedef struct
+{
+	uint32_t legacy_us;      //6getȡ
+	uint32_t batch_us;       //һ6·
+} ADC_RailBench_t;
+
+//װ6·ѹ, ˳ͬget
+extern const ADC_Rail_t ADC_Rails_Main[ADC_RAIL_MAIN_COUNT];
+//ȡһͨδУ׼ŵѹ(mV), У׼
+uint32_t ADC_GetRailPinMv(const ADC_Rail_t *rail);
+
+//0ɹ, 1ʧ(VREFʱ)
+uint8_t ADC_MeasureRailSet(const ADC_Rail_t *rails, uint8_t count, uint8_t samples, ADC_RailSet_t *out);
+//ȡȡʱԱ, ӡԿڲout (PC 68 A6), 0ɹ
+uint8_t ADC_RailSet_Benchmark(uint8_t samples, ADC_RailBench_t *out);
+//ֵʱ: ԭ64λ뵹˷ / ԱȲȽϽ, ӡԿ
+void ADC_Conv_Benchmark(void);
 #endif
@@ -0,0 +1,38 @@
+#ifndef __BUS_CTRL_H__
+#define __BUS_CTRL_H__
+#include "main.h"
+
+// RS-485 多工位总线: 广播命令 + 按工位号分时隙应答
+// 上位机发送工位号为 BUS_GUANGBO 的开始测试(0xAA)/查询结果(0xAC)命令,
+// 各工位在 "广播帧最后一字节 + BUS_RX_IDLE_MS + 工位号 * 时隙" 处依次应答,
+// 一次广播即可收齐整条总线的结果。时隙宽度由配置 JIG_CFG_BUS_SLOT_MS 决定
+// (默认100ms, 9600波特率下可容纳查询结果应答及前后收发切换延时)。
+
+#define BUS_GUANGBO 0xFF     // 广播工位号
+#define BUS_RX_IDLE_MS 100   // 与uart1接收帧间隔超时一致, 各工位同时开始解析
+#define BUS_GONGWEI_MAX 4    // 工位数, 广播后这么多个时隙内总线留给时隙应答
+
+struct Bus_tongji
+{
+	uint32_t guangbo_rx;  // 收到的广播命令
+	uint32_t slot_tx;     // 按时隙发出的应答
+	uint32_t slot_miss;   // 主循环阻塞错过时隙或工位号没有时隙, 放弃应答
+	uint32_t chongtu;     // 本时隙内总线上已有数据, 放弃应答 (冲突)
+	uint32_t late_max_ms; // 应答相对时隙起点的最大延迟
+};
+
+void Bus_Init(void);
+// UART1接收中断中调用, 记录总线最后活动时刻
+void Bus_Rx_Mark(void);
+// 帧中的工位号是否由本机处理 (本工位或广播)
+uint8_t Bus_Is_Mine(uint8_t gongwei);
+// 把广播命令的应答排到本工位时隙发送 (只保留最近一次), 工位号 >= BUS_GONGWEI_MAX 时不应答
+void Bus_Slot_Reply(void (*send)(void));
+// 收到广播命令 (无论本工位是否应答), 之后 BUS_GONGWEI_MAX 个时隙内不主动发送
+void Bus_Guangbo_Mark(void);
+// 主循环调用: 时隙到达时发送
+void Bus_Process(void);
+// 总线是否可以主动发送: 无待发时隙应答、不在广播应答窗口内、且已空闲 idle_ms
+uint8_t Bus_Kongxian(uint32_t idle_ms);
+void Bus_Get_tongji(struct Bus_tongji *out);
+#endif
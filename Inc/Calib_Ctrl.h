@@ -0,0 +1,28 @@
+#ifndef __CALIB_CTRL_H__
+#define __CALIB_CTRL_H__
+#include "main.h"
+
+// 测量通道两点校准, 校准值的计算和保存见 FlashDB/meas_calib.h
+// MES 经 UART1 发 55 E2 帧 (PC_xieyijiexi 转发到配置协议, 帧格式见 pc_protocol_config.c):
+// 接上校准源 (或用万用表测量工装上的电压) -> 55 E2 操作1 采样点0 (带参考值)
+// -> 改变校准源 -> 55 E2 操作1 采样点1 -> 55 E2 操作2 计算并保存 -> 金样检测复核
+// 工装空闲时 (Test_liucheng_L == w_wait) 才开始: 按测试开始时的状态打开供电,
+// 等待 CALIB_WENDING_MS 后读取未校准的原始值, 电压取 2^MEASCAL_RAW_SHIFT 次之和。
+// 期间开始测试则取消本次采样。
+
+// 通道顺序 (与金样检测 GOLDEN_CH_xxx 相同)
+#define CALIB_CH_VCC         0 // get_VCC_weizhi_dianya
+#define CALIB_CH_GONGDIAN    1 // get_zhudian_gongdian_weizhi_dianya
+#define CALIB_CH_VDD         2 // get_erjidianyuan_weizhi_dianya
+#define CALIB_CH_ZHUDIAN     3 // get_zhudian_weizhi_dianya
+#define CALIB_CH_SHENGYA     4 // get_SY_weizhi_dianya
+#define CALIB_CH_GONGZHUANG  5 // get_gongzhuang_MCU_gongdian_weizhi_dianya
+#define CALIB_CH_GONGHAO     6 // Current_CHK_Func
+#define CALIB_CH_NUM         7
+
+#define CALIB_WENDING_MS 3000 // 上电后等待稳定
+
+void Calib_Init(void);
+// 主循环调用
+void Calib_Process(void);
+#endif
@@ -0,0 +1,29 @@
+#ifndef __GOLDEN_CTRL_H__
+#define __GOLDEN_CTRL_H__
+#include "main.h"
+
+// 金样检测 (参考被测板定期复测, 跟踪测量准确度), 判定和保存见 FlashDB/golden_sample.h
+// MES 经 UART1 发 55 E0 帧 (PC_xieyijiexi 转发到配置协议, 帧格式见 pc_protocol_config.c):
+// 放上金样 -> 55 E0 操作1 启动 -> 收到上报 68 B2 事件 PUSH_EVT_GOLDEN (需开启上报)
+// 或轮询 55 E0 操作0 状态 -> 取回金样
+// 工装空闲时 (Test_liucheng_L == w_wait) 才开始: 按测试开始时的状态打开供电,
+// 等待 GOLDEN_WENDING_MS 后按生产测试相同的函数测量, 电压取 GOLDEN_CAIYANG 次平均。
+// 期间开始测试则取消本次检测。
+
+// 通道顺序 (参考镜像中的通道下标)
+#define GOLDEN_CH_VCC         0 // get_VCC_weizhi_dianya
+#define GOLDEN_CH_GONGDIAN    1 // get_zhudian_gongdian_weizhi_dianya
+#define GOLDEN_CH_VDD         2 // get_erjidianyuan_weizhi_dianya
+#define GOLDEN_CH_ZHUDIAN     3 // get_zhudian_weizhi_dianya
+#define GOLDEN_CH_SHENGYA     4 // get_SY_weizhi_dianya
+#define GOLDEN_CH_GONGZHUANG  5 // get_gongzhuang_MCU_gongdian_weizhi_dianya
+#define GOLDEN_CH_GONGHAO     6 // Current_CHK_Func
+#define GOLDEN_CH_NUM         7
+
+#define GOLDEN_WENDING_MS 3000 // 上电后等待稳定
+#define GOLDEN_CAIYANG 8       // 电压通道平均次数
+
+void Golden_Init(void);
+// 主循环调用
+void Golden_Process(void);
+#endif
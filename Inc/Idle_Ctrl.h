@@ -0,0 +1,34 @@
+#ifndef __IDLE_CTRL_H__
+#define __IDLE_CTRL_H__
+#include "main.h"
+
+// 唤醒源
+#define IDLE_WAKE_NONE  0
+#define IDLE_WAKE_UART0 1
+#define IDLE_WAKE_UART1 2
+#define IDLE_WAKE_UART5 3
+#define IDLE_WAKE_NUM   4
+
+struct Idle_tongji
+{
+	uint32_t window_us;                  // 统计窗口长度
+	uint32_t sleep_us;                   // 窗口内处于WFI的时间
+	uint32_t sleep_count;                // 进入WFI次数
+	uint32_t wake_count[IDLE_WAKE_NUM];  // 各唤醒源次数 (NONE=定时器等)
+	uint32_t wake_latency_last_us;       // 串口中断到主循环恢复的延时
+	uint32_t wake_latency_max_us;
+};
+
+// 空闲管理使能 (0=主循环全速运行, 与旧版一致)
+extern uint8_t Idle_Enable;
+
+void Idle_Init(void);
+// 主循环末尾调用: 无待处理事件时WFI休眠，最迟由ATIM 1ms中断唤醒
+void Idle_Sleep(void);
+// 中断中调用: 标记有事件待处理，并记录唤醒源/时刻
+void Idle_Wake_Mark(uint8_t wake_src);
+// 读取并清零统计窗口
+void Idle_Get_tongji(struct Idle_tongji *out);
+// 打印空闲率和唤醒延时 (并开始新的统计窗口)
+void Idle_Report(void);
+#endif
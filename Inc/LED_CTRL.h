@@ -1,6 +1,18 @@
 #ifndef __LED_CTRL_H__
 #define __LED_CTRL_H__
 #include "main.h"
-void LED_FLAG_LOOP(void);
+#include "led_indicator.h"
+
+// 指示灯 (PA8, 低电平亮) 由 GPTIM2 按 LedPattern_t 播放, 不占用主循环:
+// 定时器每段 (相同亮灭的连续时间片) 只中断一次, 自动重载值设为该段时长;
+// 呼吸模式以 LED_BREATH_FRAME_US 为周期做软件PWM, 每帧两次中断。
+// Led_Play 可直接作为 LedHardwareConfig_t.play 绑定到 LedIndicator。
+
+#define LED_BREATH_FRAME_US 10000 // 呼吸PWM周期 (100Hz)
+
+void LED_Init(void);
+// 播放模式 (once 模式播完后恢复之前的循环模式)
+void Led_Play(uint8_t led_index, const LedPattern_t *pattern);
+// 通讯指示: 亮20ms
 void LED_FLAG_Run(void);
 #endif
@@ -2,4 +2,6 @@
 #define __PC_XIEYI_CTRL_H__
 #include "main.h"
 void PC_xieyijiexi(uint8_t zufuchua[],uint16_t lenth);
+// 0x55 帧转发的协议初始化 (工位号回调、应答发送函数)
+void PC_xieyi_Init(void);
 #endif
@@ -0,0 +1,67 @@
+#ifndef __PROF_CTRL_H__
+#define __PROF_CTRL_H__
+#include "main.h"
+
+// CPU耗时剖析 (M0+没有DWT周期计数器)
+// 1. 高精度时间戳: BSTIM32 以APB时钟(32MHz)自由运行, 1个计数 = 1个CPU周期,
+//    约134秒回绕一次, 差值计算不受回绕影响。PROF_ENTER/PROF_EXIT 统计代码段
+//    的 次数/总周期/最大周期。
+// 2. PC采样: GPTIM0 以最高中断优先级每 PROF_SAMPLE_US 触发一次, 从异常栈帧取出
+//    被打断的PC计入直方图 (包括被打断的其他中断)。由PC命令 68 B6 开始/停止/导出,
+//    VscodeGcc/scripts/prof_report.py 按ELF符号表汇总到函数。
+// 关闭 PROF_ENABLE 后宏为空, 不占用定时器。
+
+#ifndef PROF_ENABLE
+#define PROF_ENABLE 1
+#endif
+
+// 代码段编号
+#define PROF_ZONE_UART5 0 // Uart5_Rx_rec
+#define PROF_ZONE_UART1 1 // Uart1_Rx_rec (含PC协议解析和应答)
+#define PROF_ZONE_BUS   2 // Bus_Process + Push_Process
+#define PROF_ZONE_UART0 3 // Uart0_Rx_rec
+#define PROF_ZONE_LED   4 // 未使用 (指示灯已改由GPTIM2播放)
+#define PROF_ZONE_TEST  5 // test_Loop_Func
+#define PROF_ZONE_LOOP  6 // 主循环一轮 (不含休眠)
+#define PROF_ZONE_NUM   8
+
+#define PROF_SAMPLE_US 997 // 采样周期, 与1ms节拍错开避免同步
+#define PROF_PC_NUM 128    // 直方图PC条数 (2的幂), 满后计入丢弃
+
+struct Prof_Zone
+{
+	uint32_t start;
+	uint32_t count;
+	uint32_t max;
+	uint64_t total;
+};
+
+struct Prof_tongji
+{
+	uint32_t samples;   // 总采样数
+	uint32_t handler;   // 采样时处于其他中断中的次数
+	uint32_t dropped;   // 直方图已满丢弃的采样
+	uint8_t running;    // 采样中
+};
+
+#if PROF_ENABLE
+extern struct Prof_Zone prof_zone[PROF_ZONE_NUM];
+#define PROF_NOW() FL_BSTIM32_ReadCounter(BSTIM32)
+#define PROF_ENTER(id) (prof_zone[id].start = PROF_NOW())
+#define PROF_EXIT(id) Prof_Zone_Add((id), PROF_NOW() - prof_zone[id].start)
+#else
+#define PROF_NOW() 0
+#define PROF_ENTER(id) ((void)0)
+#define PROF_EXIT(id) ((void)0)
+#endif
+
+// 启动时间戳计数器, 采样默认不开启
+void Prof_Init(void);
+void Prof_Zone_Add(uint8_t id, uint32_t cycles);
+// 清空直方图和代码段统计并开始采样
+void Prof_Start(void);
+void Prof_Stop(void);
+// 经UART1以文本行导出 (格式见prof_report.py)
+void Prof_Dump(void);
+void Prof_Get_tongji(struct Prof_tongji *out);
+#endif
@@ -0,0 +1,57 @@
+#ifndef __PUSH_CTRL_H__
+#define __PUSH_CTRL_H__
+#include "main.h"
+
+// 测试事件主动上报 (工装 -> MES), 配置 JIG_CFG_PUSH_EN 开启, 默认关闭
+// 上报帧: 68 B2 工位 序号 类型 步骤 结果 数据(4, 大端) 和校验 16
+// MES确认: 68 B3 工位 序号 和校验 16
+// 停等方式: 同时只有一条未确认事件, PUSH_ACK_MS 内未确认则重发, 共发送
+// 1 + PUSH_RETRY 次仍无确认则丢弃。只在串口和总线都空闲时发送, 命令应答和
+// 广播时隙应答优先; 各工位按工位号错开空闲门限, 两帧之间至少间隔 PUSH_GAP_MS。
+// 收到确认后总线上没有其他数据时, 下一条事件不再等待空闲门限 (确认帧解析时
+// 总线已空闲 BUS_RX_IDLE_MS, 早于任何工位的门限), 连续最多 PUSH_BURST 条。
+
+// 事件类型
+#define PUSH_EVT_STEP_START  1 // 步骤开始
+#define PUSH_EVT_STEP_RESULT 2 // 步骤结果, 结果 0合格 1不合格, 数据=测量值(mV/uA)
+#define PUSH_EVT_TEST_DONE   3 // 测试结束, 结果 0完成 1超时终止 2步骤失败, 数据=测试耗时ms
+#define PUSH_EVT_FAULT       4 // 异常, 结果=异常码
+#define PUSH_EVT_GOLDEN      5 // 金样检测完成, 结果=超差通道掩码, 数据=需要重新校准的通道掩码
+#define PUSH_EVT_CALIB       6 // 校准采样完成, 结果=点号, 数据=采样的通道掩码
+
+// 异常码
+#define PUSH_FAULT_TIMEOUT 1 // 测试超时
+#define PUSH_FAULT_STEP    2 // 步骤失败 (测试计划的重试次数用完或步骤超时), 步骤=失败的步骤
+#define PUSH_FAULT_RECAL   3 // 金样检测发现需要重新校准, 数据=通道掩码
+
+#define PUSH_QUEUE_NUM 8      // 待发事件队列
+#define PUSH_IDLE_MS 130      // 总线空闲门限, 大于接收帧间隔超时, 保证命令已解析
+#define PUSH_STAGGER_MS 30    // 每个工位号增加的空闲门限, 一帧上报约25ms
+#define PUSH_GAP_MS 50        // 两帧上报最小间隔
+#define PUSH_ACK_MS 300       // 等待确认超时
+#define PUSH_RETRY 3          // 重发次数
+#define PUSH_BURST 4          // 确认后连续发送的最大条数
+
+struct Push_tongji
+{
+	uint32_t shangbao;      // 产生的事件
+	uint32_t fasong;        // 发出的上报帧 (含重发)
+	uint32_t chongfa;       // 重发
+	uint32_t queren;        // 已确认
+	uint32_t diuqi;         // 重发后仍未确认而丢弃
+	uint32_t yichu;         // 队列满丢弃
+	uint32_t yanchi_max_ms; // 事件产生到确认的最大延时
+};
+
+void Push_Init(void);
+// 开启/关闭主动上报并写入配置, 关闭时清空队列
+void Push_Enable(uint8_t kaiqi);
+uint8_t Push_Is_Enabled(void);
+// 产生事件 (主循环中调用), 未开启时忽略; 同一步骤连续相同的结果只上报一次
+void Push_Event(uint8_t leixing, uint8_t buzhou, uint8_t jieguo, uint32_t shuju);
+// MES确认
+void Push_Ack(uint8_t xuhao);
+// 主循环调用: 空闲时发送/重发
+void Push_Process(void);
+void Push_Get_tongji(struct Push_tongji *out);
+#endif
@@ -0,0 +1,31 @@
+#ifndef __STACK_CTRL_H__
+#define __STACK_CTRL_H__
+#include "main.h"
+
+// 栈深度水位和RAM使用
+// 启动时把静态变量之后到当前栈顶之间的RAM填充为 STACK_PAINT, 运行中从低地址
+// 向上扫描第一个被改写的字, 得到栈曾经到达的最深位置。堆 (newlib的malloc)
+// 从静态变量之后向上增长, 扫描从当前堆顶开始, 不会把堆误算为栈。
+// 链接脚本只为栈保留 _Stack_Size (1KB), 实际栈可以继续向下占用未使用的堆区,
+// 水位超过保留值说明已经越界进入堆区, 需要调整缓冲区大小或 _Stack_Size。
+
+#define STACK_PAINT 0xA5A5A5A5
+
+struct Stack_tongji
+{
+	uint32_t ram_size;     // RAM总大小
+	uint32_t static_size;  // .data + .bss + .noinit
+	uint32_t heap_used;    // 堆已分配 (sbrk)
+	uint32_t stack_rsv;    // 链接脚本保留的栈大小
+	uint32_t stack_peak;   // 栈最大深度 (水位)
+	uint32_t stack_now;    // 当前栈深度
+	uint32_t free_min;     // 堆顶与栈水位之间从未使用过的RAM
+};
+
+// 尽早调用 (main开头), 填充未使用的RAM
+void Stack_Paint(void);
+// 扫描水位并计算RAM使用
+void Stack_Get_tongji(struct Stack_tongji *out);
+// 调试口打印
+void Stack_Report(void);
+#endif
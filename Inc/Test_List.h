@@ -48,6 +48,12 @@ enum Test_liucheng
 };
 extern enum Test_liucheng Test_liucheng_L;
 
+// ԲռõԴ (step_executor), ռͬԴĲ費ͬʱ
+#define TEST_RES_SUPPLY (1U << 0) // /繩̵
+#define TEST_RES_UART0  (1U << 1) // 뱻ͨ (UART0 + ͨſƽ)
+#define TEST_RES_ADC    (1U << 2) // ADC ·ѹ⿪
+#define TEST_RES_INA219 (1U << 3) // INA219 
+
 enum test_xieyi_jilu
 {
 	connect_xingshan = 0,
@@ -64,4 +70,6 @@ void gongwei_jiance(void);
 void test_start_Init(void);
 //ʼ
 void test_start(void);
+//زԼƻ (jig_config ʼ֮)
+void test_jihua_Init(void);
 #endif
@@ -0,0 +1,53 @@
+#ifndef __TRACE_CTRL_H__
+#define __TRACE_CTRL_H__
+#include "main.h"
+
+// 串口通讯录制: 记录UART0/UART1/UART5每个收发字节及时间间隔,
+// 由PC命令导出后用 VscodeGcc/scripts/trace_replay.py 统计、比对和回放。
+// 两种方式: 缓存 (记满为止, 停止后导出) 和 流式 (边录边在UART1空闲时导出,
+// 可覆盖整个测试周期, 只有导出跟不上时才丢弃)
+
+// 端口 (与trace_replay.py一致)
+#define TRACE_PORT_UART0 0
+#define TRACE_PORT_UART1 1
+#define TRACE_PORT_UART5 2
+#define TRACE_PORT_EXT   3 // 时间扩展记录, 非数据
+
+#define TRACE_DIR_RX 0
+#define TRACE_DIR_TX 1
+
+// 记录条数, 每条4字节, 2的幂 (环形缓冲); 缓存方式记满后丢弃后续字节 (保留会话开头)
+// 一帧被测设备输出最长512字节 (UART0接收缓冲), 调试口转发后约1100条, 再加应答留余量
+#define TRACE_BUF_NUM 2048
+
+// 记录格式 (小端): tag[7:6]=端口 tag[5]=方向 tag[4:0]=0, data, dt_us(16位, 距上一条)
+// 间隔超过65535us时先插入一条EXT记录, 其dt_us为间隔的高16位
+struct Trace_Entry
+{
+	uint8_t tag;
+	uint8_t data;
+	uint16_t dt_us;
+};
+
+struct Trace_tongji
+{
+	uint32_t count;     // 已记录条数 (流式方式为累计)
+	uint32_t dropped;   // 缓冲满丢弃的字节数
+	uint8_t running;    // 录制中
+	uint8_t stream;     // 流式导出中 (停止后导出完剩余记录才清零)
+};
+
+void Trace_Init(void);
+// 清空并开始录制 (缓存方式)
+void Trace_Start(void);
+// 清空并开始录制, 主循环中 Trace_Process 边录边导出
+void Trace_Start_Stream(void);
+void Trace_Stop(void);
+// 主循环调用: 流式方式下UART1空闲时发出一行记录
+void Trace_Process(void);
+// 串口中断/发送函数中调用, 未录制时直接返回
+void Trace_Byte(uint8_t port, uint8_t dir, uint8_t data);
+void Trace_Get_tongji(struct Trace_tongji *out);
+// 通过UART1以文本行导出 (导出前自动停止录制; 流式方式下只停止)
+void Trace_Dump(void);
+#endif
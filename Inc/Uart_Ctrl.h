@@ -0,0 +1,111 @@
+#ifndef __UART_CTRL_H__
+#define __UART_CTRL_H__
+#include "main.h"
+#include <stdbool.h>
+
+// 串口驱动: UART0/UART1/UART5 共用同一份中断和收发代码, 各口差异由 Uart_Port 描述
+// (uart0.c/uart1.c/uart5.c 中定义描述和帧处理函数)。
+// 接收: 中断把字节存入 rx_buf, 最后一字节后 frame_ms 内没有新数据视为一帧结束,
+//       主循环 Uart_Poll 复制到 frame_buf 后调用 on_frame。缓冲区满后丢弃新字节
+//       (不回绕覆盖帧头), 帧结束时计入溢出次数。
+// 发送: Uart_Send 复制到 tx_buf 后由发送中断逐字节发出; 上一包未发完时最多等待
+//       tx_wait_ms, 等待期间登记为看门狗 WDT_TASK_UART 任务。tx_fetch 非空时
+//       Uart_Tx_AsyncKick 改由回调逐字节取数 (协议管理器异步前导发送)。
+// 透传: Uart_Bridge_Start 把两个口接成一对, 接收中断直接把字节放入本口 rx_buf
+//       (此时作环形缓冲, 不再按帧接收), 并启动对端发送中断从中取字节发出, 不经过
+//       主循环。慢口方向的缓冲需容纳一次突发与发送能力之差:
+//       突发B字节时最多积压 B * (1 - 慢口波特率 / 快口波特率)。没有硬件流控,
+//       缓冲满时丢弃并计数。在 a 口收到 escape 序列后退出透传, 主循环把 escape
+//       作为一帧交给 a 口的 on_frame (用于应答退出命令)。
+
+#define UART_PORT_MAX 3 // 注册的串口数 (帧超时由 Uart_Tick 统一倒计时)
+
+// 收发方向控制
+#define UART_DE_NONE     0 // 全双工
+#define UART_DE_TX_FLOAT 1 // 空闲时TX脚设为输入释放总线 (自动收发切换的RS-485)
+#define UART_DE_PIN      2 // 发送期间 de_pin 输出高
+
+struct Uart_State
+{
+	volatile uint16_t rx_count;   // rx_buf 中已收字节
+	volatile uint16_t rx_timer;   // 帧间隔倒计时 (ms)
+	volatile uint8_t rx_flag;     // 有未处理的接收数据
+	volatile uint8_t rx_overflow; // 本帧缓冲区满丢弃过字节
+	volatile uint8_t tx_async;    // 发送中断从 tx_fetch 取字节
+	volatile uint8_t tx_done;     // 发送完成, 等待 Uart_Poll 释放总线
+	volatile uint16_t tx_len;     // 发送数据长度
+	volatile uint16_t tx_opc;     // 已发送数据长度
+	uint16_t overflow_count;      // 溢出帧数
+	// 透传
+	const struct Uart_Port *volatile peer; // 对端, NULL=未透传
+	volatile uint16_t ring_head;  // rx_buf 写入位置 (接收中断)
+	volatile uint16_t ring_tail;  // rx_buf 读出位置 (对端发送中断)
+	volatile uint8_t bridge_tx;   // 发送中断正在从对端缓冲取字节
+	volatile uint8_t bridge_stop; // 收到退出序列, 等待主循环退出透传
+	const uint8_t *escape;        // 退出序列
+	uint8_t escape_len;
+	uint8_t escape_pos;
+	uint16_t ring_peak;           // 缓冲最大积压
+	uint32_t bridge_fwd;          // 转发的字节
+	uint32_t bridge_drop;         // 缓冲满丢弃的字节
+};
+
+struct Uart_Bridge_tongji
+{
+	uint32_t fwd;   // 本口收到并已从对端发出的字节
+	uint32_t drop;  // 缓冲满丢弃 (含退出时未发出的)
+	uint16_t peak;  // 缓冲最大积压
+	uint16_t size;  // 缓冲大小
+};
+
+struct Uart_Port
+{
+	UART_Type *uart;
+	IRQn_Type irq;
+	uint8_t priority; // 中断抢占优先级
+	uint32_t baud;
+	GPIO_Type *gpio;  // RX/TX 所在端口
+	uint32_t rx_pin;
+	uint32_t tx_pin;
+	uint8_t rx_pull;  // RX脚上拉
+	uint8_t de_mode;  // UART_DE_xxx
+	GPIO_Type *de_gpio;
+	uint32_t de_pin;
+	uint8_t *rx_buf;
+	uint8_t *frame_buf;
+	uint16_t rx_size;     // rx_buf 和 frame_buf 的大小
+	uint8_t *tx_buf;
+	uint16_t tx_size;
+	uint16_t frame_ms;    // 帧间隔超时
+	uint16_t tx_wait_ms;  // 等待上一包发完的最长时间
+	uint8_t tx_guard_ms;  // 发送前延时; 发完后延时再释放总线
+	uint8_t trace_port;   // TRACE_PORT_xxx
+	uint8_t wake_src;     // IDLE_WAKE_xxx
+	void (*on_rx_byte)(void);                         // 接收中断中每字节调用, 可为NULL
+	void (*on_frame)(uint8_t data[], uint16_t lenth); // 主循环中每帧调用
+	bool (*tx_fetch)(uint8_t *byte);                  // 异步发送取字节, 可为NULL
+	struct Uart_State *state;
+};
+
+// 初始化引脚/串口/中断并注册到 Uart_Tick
+void Uart_Init(const struct Uart_Port *port);
+// UARTx_IRQHandler 中调用
+void Uart_IRQ(const struct Uart_Port *port);
+// 中断发送, 返回0表示长度非法或上一包超时未发完
+uint8_t Uart_Send(const struct Uart_Port *port, uint8_t data[], uint16_t lenth);
+// 启动异步发送, 发送中断运行中或上一包未发完时不启动 (由协议管理器调度时重试)
+void Uart_Tx_AsyncKick(const struct Uart_Port *port);
+// 主循环调用: 释放总线, 帧结束时调用 on_frame
+void Uart_Poll(const struct Uart_Port *port);
+// 没有待处理的接收帧, 上一包已发完
+uint8_t Uart_Kongxian(const struct Uart_Port *port);
+// 1ms定时中断中调用
+void Uart_Tick(void);
+// 透传 a<->b, 等待两口当前发送完成后开始; 返回0表示超时未能开始
+uint8_t Uart_Bridge_Start(const struct Uart_Port *a, const struct Uart_Port *b, const uint8_t *escape, uint8_t escape_len);
+// 等待缓冲发完 (最多 tx_wait_ms) 后退出透传, port 为任一端
+void Uart_Bridge_Stop(const struct Uart_Port *port);
+uint8_t Uart_Bridge_Active(const struct Uart_Port *port);
+// 统计在下次 Uart_Bridge_Start 时清零
+void Uart_Bridge_Get_tongji(const struct Uart_Port *port, struct Uart_Bridge_tongji *out);
+#endif
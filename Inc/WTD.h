@@ -2,5 +2,52 @@
 #define __WTD_H__
 
 #include "main.h"
+
+// 硬件看门狗溢出周期 (原默认500ms; 有任务签到后可缩短, 不会误复位)
+#define WDT_IWDT_PERIOD FL_IWDT_PERIOD_250MS
+
+// 受监管任务ID
+#define WDT_TASK_MAIN        0 // 主循环 (常驻)
+#define WDT_TASK_CURRENT_CHK 1 // INA219功耗测试 Current_CHK_Func
+#define WDT_TASK_FLASH       2 // Flash扇区擦除/写入
+#define WDT_TASK_DELAY       3 // TM_DelayMs等阻塞延时
+#define WDT_TASK_UART        4 // 串口等待上一包/透传缓冲发完
+#define WDT_TASK_NUM         5
+#define WDT_TASK_NONE        0xFF
+
+// 各任务默认签到期限 (ms)
+#define WDT_DEADLINE_MAIN        200
+#define WDT_DEADLINE_CURRENT_CHK 150 // 两次签到间最长约102ms (100ms延时 + IIC读写)
+#define WDT_DEADLINE_FLASH       100
+#define WDT_DEADLINE_DELAY       100
+#define WDT_DEADLINE_UART_MARGIN 20 // 串口等待期限 = tx_wait_ms + 余量
+
+// 复位后保留的现场记录 (位于.noinit段, 上电复位后无效)
+#define WDT_RECORD_MAGIC 0x57445447 // "WDTG"
+struct WDT_Record
+{
+	uint32_t magic;
+	uint8_t task_id;        // 超时任务
+	uint8_t reserved[3];
+	uint32_t pc;            // 超时时被打断的PC
+	uint32_t lr;            // 超时时被打断的LR
+	uint32_t checkin_addr;  // 该任务最后一次签到的调用地址
+	uint32_t overrun_ms;    // 距最后一次签到的时间
+	uint32_t reset_count;   // 累计看门狗复位次数
+	uint32_t checksum;      // 以上字段的按字异或校验
+};
+
 void WatchDog_Init(void);
+// 长操作开始: 登记任务并设置签到期限; 主循环任务在长操作期间暂停计时
+void WDT_Task_Begin(uint8_t id, uint32_t deadline_ms);
+// 长操作结束: 全部长操作结束后主循环任务从暂停时的计时继续 (不重新计时)
+void WDT_Task_End(uint8_t id);
+// 任务签到: 刷新期限并尝试喂狗
+void WDT_CheckIn(uint8_t id);
+// 全部任务健康时才喂硬件看门狗, 返回1表示已喂狗
+uint8_t WDT_Feed(void);
+// ATIM 1ms中断中调用: 检测超时并抓取现场
+void WDT_Tick(void);
+// 读取上次复位前保留的记录, 返回0表示没有有效记录
+uint8_t WDT_Get_Record(struct WDT_Record *out);
 #endif
@@ -21,5 +21,7 @@ void INA219_IIC_GPIO_Init(void);
 #define ZDINA219_SDA_InPut         (ZDINA219_SDA_PIN_OUT&ZDINA219_SDA_PIN_PORT)
 */
 uint16_t Current_CHK_Func(void);
+//δУ׼Ķ(ĬУ׼Ĵ), У׼
+uint16_t Current_CHK_Raw(void);
 
 #endif
@@ -3,4 +3,6 @@
 #include "main.h"
 
 void ATIM_Init(void);
+extern volatile uint32_t time_ms_count;
+uint32_t time_get_us(void);
 #endif
@@ -1,6 +1,8 @@
 #ifndef __TONGXIN_XIEYI_CTRL_H__
 #define __TONGXIN_XIEYI_CTRL_H__
 #include "main.h"
+// 被测设备发送绑定到协议管理器 (UART0 异步发送, 前导由发送中断生成)
+void TONGXIN_Init(void);
 void TONGXIN_xieyijiexi(uint8_t zufuchua[],uint16_t lenth);
 void TONGXIN_xieyifasong(void);
 void TONGXIN_xieyifasong_NTST(void);
@@ -1,9 +1,12 @@
 #ifndef __UART0_H__
 #define __UART0_H__
 #include "main.h"
+#include "Uart_Ctrl.h"
+extern const struct Uart_Port uart0_port;
 void UART0_MF_Config_Init(void);
 void Uart0_Rx_rec(void);
 void UART0_IRQHandler(void);
+// 可直接作为 ProtocolSendFunc / ProtocolAsyncTxPort.tx_kick 绑定到协议管理器
 void Uart0_Tx_Send(uint8_t zufuchua[],uint16_t lenth);
-void Uart0_Tx_Send_init(void);
+void Uart0_Tx_AsyncKick(void);
 #endif
@@ -1,5 +1,11 @@
 #include "ADC_CHK.h"
 #include "GPIO.h"
+#include "time.h"
+#include "uart1.h"
+#include "jig_config.h"
+#include "meas_calib.h"
+#include "Calib_Ctrl.h"
+#include "utility.h"
 static void MF_ADC_Common_Init(void)
 {
     FL_ADC_CommonInitTypeDef    Common_InitStruct;
@@ -181,6 +187,55 @@ static uint8_t GetSingleChannelSample_POLL(uint32_t channel, uint32_t *ADCRdresu
 }
 
 
+// 码值换算为引脚 mV: floor(code * 3000 * ADC_VREF / (vref * 4095))
+// 原来每次换算都是一次64位除法 (M0+ 没有除法指令, 调用库函数)。现在按 VREF 码值
+// 预先算好倒数 (util_ratio_init, 没有除法指令), 换算只有三次32位乘法和移位,
+// 结果与原公式完全相同 (VscodeGcc/scripts/adc_conv_bench.py 穷举检查)。
+// VREF 码值只在附近几个值跳动, 按码值缓存几组倒数, 变化时才重新计算。
+#define ADC_CONV_CACHE 4 // 2的幂
+
+typedef struct
+{
+	uint32_t vref;   // VREF码值 (批量时为之和), 0=空
+	uint8_t  fenya;  // 分压倍数 (引脚电压为1)
+	uint8_t  ok;     // 0=无法用倒数, 用除法
+	UtilRatio bili;  // 3000 * ADC_VREF * fenya / (vref * 4095)
+} ADC_Conv_t;
+
+static ADC_Conv_t adc_conv_huancun[ADC_CONV_CACHE];
+
+// vref 不超过 255*4095 (批量测量最多255次之和), vref*4095 不溢出
+static void adc_conv_init(ADC_Conv_t *conv, uint32_t vref, uint8_t fenya)
+{
+	uint64_t fenzi = (uint64_t)3000 * (ADC_VREF) * fenya;
+
+	conv->vref = vref;
+	conv->fenya = fenya;
+	conv->ok = (fenzi <= 0xFFFFFFFFU && util_ratio_init(&conv->bili, (uint32_t)fenzi, vref * 4095)) ? 1 : 0;
+}
+
+static const ADC_Conv_t *adc_conv_get(uint32_t vref)
+{
+	ADC_Conv_t *conv = &adc_conv_huancun[vref & (ADC_CONV_CACHE - 1)];
+
+	if (conv->vref != vref)
+	{
+		adc_conv_init(conv, vref, 1);
+	}
+	return conv;
+}
+
+static uint32_t adc_code_to_mv(uint32_t code, uint32_t vref)
+{
+	const ADC_Conv_t *conv = adc_conv_get(vref);
+
+	if (conv->ok && code <= UTIL_RATIO_X_MAX)
+	{
+		return util_ratio_mul(&conv->bili, code);
+	}
+	return (uint32_t)(((uint64_t)code * 3000 * (ADC_VREF)) / ((uint64_t)vref * 4095));
+}
+
 uint32_t GetSingleChannelVoltage_POLL(uint32_t channel)
 {
     uint32_t Get122VSample = 0, GetChannelVoltage = 0, GetVSample = 0;
@@ -190,18 +245,47 @@ uint32_t GetSingleChannelVoltage_POLL(uint32_t channel)
 
     if((Get122VSample != 0) && (Get122VSample_State == 0)  && (GetVSample_State == 0))
     {
-        GetChannelVoltage = (uint32_t)(((uint64_t)GetVSample * 3000 * (ADC_VREF)) / ((uint64_t)Get122VSample * 4095));  //计算通道电压
+        GetChannelVoltage = adc_code_to_mv(GetVSample, Get122VSample);  //计算通道电压
     }
 
     return GetChannelVoltage;
 }
+// 固定分压系数 (x1000) 的倒数, 配置改变时重新计算
+static uint32_t adc_fenya_xishu = 0;
+static uint8_t adc_fenya_ok = 0;
+static UtilRatio adc_fenya_bili;
+
+// 引脚电压换算为分压前的电压: 已校准的通道用校准的增益/偏移 (只有乘法和移位),
+// 未校准时按固定分压系数 (同样用倒数换算, 与 /1000 结果相同)
+static uint32_t adc_jiaozhun(uint8_t tongdao, uint32_t yinjiao_mv)
+{
+	int32_t dianya;
+	uint32_t xishu;
+
+	if (!MeasCalib_Valid(tongdao))
+	{
+		xishu = JigConfig_Get(JIG_CFG_ADC_SCALE);
+		if (xishu != adc_fenya_xishu)
+		{
+			adc_fenya_xishu = xishu;
+			adc_fenya_ok = util_ratio_init(&adc_fenya_bili, xishu, 1000) ? 1 : 0;
+		}
+		if (adc_fenya_ok && yinjiao_mv <= UTIL_RATIO_X_MAX)
+		{
+			return util_ratio_mul(&adc_fenya_bili, yinjiao_mv);
+		}
+		return yinjiao_mv * xishu / 1000;
+	}
+	dianya = MeasCalib_Apply(tongdao, (int32_t)yinjiao_mv);
+	return dianya > 0 ? (uint32_t)dianya : 0;
+}
 //获取主电位置的电压
 uint32_t get_zhudian_weizhi_dianya()
 {
 	uint32_t test_shuju = 0;
 	zhudian_dianya_CHK_CTRL_ON();
 	test_shuju = GetSingleChannelVoltage_POLL(FL_ADC_EXTERNAL_CH7);
-	test_shuju = test_shuju*11;
+	test_shuju = adc_jiaozhun(CALIB_CH_ZHUDIAN, test_shuju);
 	zhudian_dianya_CHK_CTRL_OFF();
 	return test_shuju;
 }
@@ -211,7 +295,7 @@ uint32_t get_erjidianyuan_weizhi_dianya()
 	uint32_t test_shuju = 0;
 	erji_dianya_CHK_CTRL_ON();
 	test_shuju = GetSingleChannelVoltage_POLL(FL_ADC_EXTERNAL_CH8);
-	test_shuju = test_shuju*11;
+	test_shuju = adc_jiaozhun(CALIB_CH_VDD, test_shuju);
 	erji_dianya_CHK_CTRL_OFF();
 	return test_shuju;
 }
@@ -221,7 +305,7 @@ uint32_t get_VCC_weizhi_dianya()
 	uint32_t test_shuju = 0;
 	VCC_dianya_CHK_CTRL_ON();
 	test_shuju = GetSingleChannelVoltage_POLL(FL_ADC_EXTERNAL_CH2);
-	test_shuju = test_shuju*11;
+	test_shuju = adc_jiaozhun(CALIB_CH_VCC, test_shuju);
 	VCC_dianya_CHK_CTRL_OFF();
 	return test_shuju;
 }
@@ -231,7 +315,7 @@ uint32_t get_SY_weizhi_dianya()
 	uint32_t test_shuju = 0;
 	SY_dianya_CHK_CTRL_ON();
 	test_shuju = GetSingleChannelVoltage_POLL(FL_ADC_EXTERNAL_CH9);
-	test_shuju = test_shuju*11;
+	test_shuju = adc_jiaozhun(CALIB_CH_SHENGYA, test_shuju);
 	SY_dianya_CHK_CTRL_OFF();
 	return test_shuju;
 }
@@ -240,7 +324,7 @@ uint32_t get_zhudian_gongdian_weizhi_dianya()
 {
 	uint32_t test_shuju = 0;
 	test_shuju = GetSingleChannelVoltage_POLL(FL_ADC_EXTERNAL_CH1);
-	test_shuju = test_shuju*11;
+	test_shuju = adc_jiaozhun(CALIB_CH_GONGDIAN, test_shuju);
 	return test_shuju;
 }
 //检测工装自身电路电压
@@ -248,6 +332,284 @@ uint32_t get_gongzhuang_MCU_gongdian_weizhi_dianya()
 {
 	uint32_t test_shuju = 0;
 	test_shuju = GetSingleChannelVoltage_POLL(FL_ADC_EXTERNAL_CH3);
-	test_shuju = test_shuju*11;
+	test_shuju = adc_jiaozhun(CALIB_CH_GONGZHUANG, test_shuju);
 	return test_shuju;
 }
+
+// 读取一个通道未校准的引脚电压 (校准采样用)
+uint32_t ADC_GetRailPinMv(const ADC_Rail_t *rail)
+{
+	uint32_t test_shuju;
+
+	if (rail->ctrl_on != NULL)
+	{
+		rail->ctrl_on();
+	}
+	test_shuju = GetSingleChannelVoltage_POLL(rail->channel);
+	if (rail->ctrl_off != NULL)
+	{
+		rail->ctrl_off();
+	}
+	return test_shuju;
+}
+
+/*============================ 批量测量 (rail set) ============================*/
+// 逐个调用 get_xxx_dianya() 时，每个通道都要重新做一次 VREF 采样、开关 VREF BUFFER
+// 并重新使能 ADC。批量测量把 VREF 校准放在批次开头只做一次，各通道多次采样后
+// 在原始码值上求 min/max/平均。换算系数 (含各通道分压倍数) 的倒数每批只算一次
+// (分压倍数相同的通道共用)，之后各通道只有乘法和移位。
+
+#define ADC_POLL_TIMEOUT 0x000FFFFFU // 单次转换等待上限 (原为 0xFFFFFFFF)
+
+// 主工装的测量通道 (与 get_xxx_dianya() 一一对应)
+const ADC_Rail_t ADC_Rails_Main[ADC_RAIL_MAIN_COUNT] =
+{
+	[ADC_RAIL_ZHUDIAN] = {FL_ADC_EXTERNAL_CH7, 11, zhudian_dianya_CHK_CTRL_ON, zhudian_dianya_CHK_CTRL_OFF, CALIB_CH_ZHUDIAN},
+	[ADC_RAIL_ERJI] = {FL_ADC_EXTERNAL_CH8, 11, erji_dianya_CHK_CTRL_ON, erji_dianya_CHK_CTRL_OFF, CALIB_CH_VDD},
+	[ADC_RAIL_VCC] = {FL_ADC_EXTERNAL_CH2, 11, VCC_dianya_CHK_CTRL_ON, VCC_dianya_CHK_CTRL_OFF, CALIB_CH_VCC},
+	[ADC_RAIL_SY] = {FL_ADC_EXTERNAL_CH9, 11, SY_dianya_CHK_CTRL_ON, SY_dianya_CHK_CTRL_OFF, CALIB_CH_SHENGYA},
+	[ADC_RAIL_GONGDIAN] = {FL_ADC_EXTERNAL_CH1, 11, NULL, NULL, CALIB_CH_GONGDIAN},
+	[ADC_RAIL_GONGZHUANG] = {FL_ADC_EXTERNAL_CH3, 11, NULL, NULL, CALIB_CH_GONGZHUANG},
+};
+
+// ADC 已使能且通道已选好，触发一次转换并等待结果
+static uint8_t adc_convert_once(uint32_t *ADCRdresult)
+{
+	uint32_t counter = 0;
+
+	FL_ADC_ClearFlag_EndOfConversion(ADC);
+	FL_ADC_EnableSWConversion(ADC);
+	while (FL_ADC_IsActiveFlag_EndOfConversion(ADC) == 0U)
+	{
+		if (++counter >= ADC_POLL_TIMEOUT)
+		{
+			return 1;
+		}
+	}
+	FL_ADC_ClearFlag_EndOfConversion(ADC);
+	*ADCRdresult = FL_ADC_ReadConversionData(ADC);
+	return 0;
+}
+
+// 对一个通道连续采样，只统计原始码值
+static uint8_t adc_sample_channel(uint32_t channel, uint8_t samples,
+                                  uint32_t *sum, uint32_t *min, uint32_t *max)
+{
+	uint32_t value = 0;
+	uint8_t i;
+
+	FL_ADC_Disable(ADC);
+	FL_ADC_DisableSequencerChannel(ADC, FL_ADC_ALL_CHANNEL);
+	FL_ADC_EnableSequencerChannel(ADC, channel);
+	FL_ADC_Enable(ADC);
+
+	*sum = 0;
+	*min = 0xFFFFFFFFU;
+	*max = 0;
+	for (i = 0; i < samples; i++)
+	{
+		if (adc_convert_once(&value) != 0)
+		{
+			return 1;
+		}
+		*sum += value;
+		if (value < *min)
+		{
+			*min = value;
+		}
+		if (value > *max)
+		{
+			*max = value;
+		}
+	}
+	return 0;
+}
+
+// 原始码值换算为分压前的 mV (与 GetSingleChannelVoltage_POLL 公式一致)
+// vref_sum 为 samples 次 VREF 采样之和，raw 同样按 samples 次累加
+// conv 为本批次该分压倍数的换算系数 (ok=0 或累加值超过16位时用除法)
+static uint32_t adc_raw_to_mv(const ADC_Conv_t *conv, uint32_t raw_sum)
+{
+	if (conv->ok && raw_sum <= UTIL_RATIO_X_MAX)
+	{
+		return util_ratio_mul(&conv->bili, raw_sum);
+	}
+	return (uint32_t)(((uint64_t)raw_sum * 3000 * (ADC_VREF) * conv->fenya) / ((uint64_t)conv->vref * 4095));
+}
+
+// 有校准通道时 conv 按引脚电压 (分压倍数1) 换算, 再同 get_xxx_dianya() 做校准
+static uint32_t adc_rail_mv(const ADC_Rail_t *rail, const ADC_Conv_t *conv, uint32_t raw_sum)
+{
+	uint32_t mv = adc_raw_to_mv(conv, raw_sum);
+
+	if (rail->calib != ADC_RAIL_NO_CALIB)
+	{
+		mv = adc_jiaozhun(rail->calib, mv);
+	}
+	return mv;
+}
+
+uint8_t ADC_MeasureRailSet(const ADC_Rail_t *rails, uint8_t count, uint8_t samples, ADC_RailSet_t *out)
+{
+	uint32_t start_us = time_get_us();
+	uint32_t vref_sum = 0, vref_min = 0, vref_max = 0;
+	uint32_t sum = 0, min = 0, max = 0;
+	ADC_Conv_t conv = {0};
+	uint8_t fenya;
+	uint8_t i;
+	uint8_t state = 0;
+
+	if (rails == NULL || out == NULL || count == 0 || count > ADC_RAIL_MAX || samples == 0)
+	{
+		return 1;
+	}
+	memset(out, 0, sizeof(ADC_RailSet_t));
+	out->count = count;
+	out->samples = samples;
+
+	// 批次开头做一次 VREF 校准
+	FL_CMU_SetADCPrescaler(FL_CMU_ADC_PSC_DIV8);
+	FL_VREF_EnableVREFBuffer(VREF);
+	state = adc_sample_channel(FL_ADC_INTERNAL_VREF1P2, samples, &vref_sum, &vref_min, &vref_max);
+	FL_VREF_DisableVREFBuffer(VREF);
+	if (state != 0 || vref_sum == 0)
+	{
+		FL_ADC_Disable(ADC);
+		FL_ADC_DisableSequencerChannel(ADC, FL_ADC_ALL_CHANNEL);
+		return 1;
+	}
+	out->vref_raw = vref_sum / samples;
+
+	for (i = 0; i < count; i++)
+	{
+		ADC_RailResult_t *res = &out->rail[i];
+
+		if (rails[i].ctrl_on != NULL)
+		{
+			rails[i].ctrl_on();
+		}
+		state = adc_sample_channel(rails[i].channel, samples, &sum, &min, &max);
+		if (rails[i].ctrl_off != NULL)
+		{
+			rails[i].ctrl_off();
+		}
+		if (state != 0)
+		{
+			res->valid = 0;
+			continue;
+		}
+
+		// 分压倍数与上一通道不同时才重新计算倒数
+		fenya = (rails[i].calib != ADC_RAIL_NO_CALIB) ? 1 : rails[i].divider;
+		if (conv.vref == 0 || conv.fenya != fenya)
+		{
+			adc_conv_init(&conv, vref_sum, fenya);
+		}
+		// min/max 为单次码值，换算时乘以 samples 与 vref_sum 对齐
+		res->avg_mv = adc_rail_mv(&rails[i], &conv, sum);
+		res->min_mv = adc_rail_mv(&rails[i], &conv, min * samples);
+		res->max_mv = adc_rail_mv(&rails[i], &conv, max * samples);
+		res->spread_mv = res->max_mv - res->min_mv;
+		res->valid = 1;
+	}
+
+	FL_ADC_Disable(ADC);
+	FL_ADC_DisableSequencerChannel(ADC, FL_ADC_ALL_CHANNEL);
+
+	out->elapsed_us = time_get_us() - start_us;
+	return 0;
+}
+
+// 对比逐个读取与批量读取的总耗时 (调试用，结果打印到调试口)
+uint8_t ADC_RailSet_Benchmark(uint8_t samples, ADC_RailBench_t *out)
+{
+	ADC_RailSet_t set;
+	uint32_t start_us;
+	uint32_t legacy_us;
+	uint32_t legacy_mv[ADC_RAIL_MAIN_COUNT];
+	uint8_t i;
+
+	start_us = time_get_us();
+	legacy_mv[ADC_RAIL_ZHUDIAN] = get_zhudian_weizhi_dianya();
+	legacy_mv[ADC_RAIL_ERJI] = get_erjidianyuan_weizhi_dianya();
+	legacy_mv[ADC_RAIL_VCC] = get_VCC_weizhi_dianya();
+	legacy_mv[ADC_RAIL_SY] = get_SY_weizhi_dianya();
+	legacy_mv[ADC_RAIL_GONGDIAN] = get_zhudian_gongdian_weizhi_dianya();
+	legacy_mv[ADC_RAIL_GONGZHUANG] = get_gongzhuang_MCU_gongdian_weizhi_dianya();
+	legacy_us = time_get_us() - start_us;
+
+	if (ADC_MeasureRailSet(ADC_Rails_Main, ADC_RAIL_MAIN_COUNT, samples, &set) != 0)
+	{
+		DeBug_print("ADC batch: measure failed\r\n");
+		return 1;
+	}
+	out->legacy_us = legacy_us;
+	out->batch_us = set.elapsed_us;
+
+	DeBug_print("ADC bench: legacy 6x1 = %luus, batch 6x%d = %luus\r\n",
+	            (unsigned long)legacy_us, samples, (unsigned long)set.elapsed_us);
+	for (i = 0; i < ADC_RAIL_MAIN_COUNT; i++)
+	{
+		DeBug_print("  rail%d: legacy=%lumV avg=%lumV min=%lu max=%lu spread=%lu\r\n", i,
+		            (unsigned long)legacy_mv[i], (unsigned long)set.rail[i].avg_mv,
+		            (unsigned long)set.rail[i].min_mv, (unsigned long)set.rail[i].max_mv,
+		            (unsigned long)set.rail[i].spread_mv);
+	}
+	return 0;
+}
+
+// 码值换算耗时: 用当前 VREF 码值把 0..4095 各换算一次, 对比原64位除法与倒数,
+// 结果逐个比较 (调试用, 结果打印到调试口)
+void ADC_Conv_Benchmark(void)
+{
+	ADC_Conv_t conv;
+	uint32_t vref = 0;
+	uint32_t code;
+	uint32_t start_us, chufa_us, daoshu_us, jisuan_us;
+	uint32_t butong = 0;
+	volatile uint32_t he = 0;
+
+	if (GetVREF1P2Sample_POLL(&vref) != 0 || vref == 0)
+	{
+		DeBug_print("ADC conv: VREF sample failed\r\n");
+		return;
+	}
+
+	start_us = time_get_us();
+	for (code = 0; code < 4096; code++)
+	{
+		he += (uint32_t)(((uint64_t)code * 3000 * (ADC_VREF)) / ((uint64_t)vref * 4095));
+	}
+	chufa_us = time_get_us() - start_us;
+
+	start_us = time_get_us();
+	adc_conv_init(&conv, vref, 1);
+	jisuan_us = time_get_us() - start_us;
+	if (!conv.ok)
+	{
+		DeBug_print("ADC conv: vref %lu out of range\r\n", (unsigned long)vref);
+		return;
+	}
+
+	start_us = time_get_us();
+	for (code = 0; code < 4096; code++)
+	{
+		he += util_ratio_mul(&conv.bili, code);
+	}
+	daoshu_us = time_get_us() - start_us;
+
+	for (code = 0; code < 4096; code++)
+	{
+		if (util_ratio_mul(&conv.bili, code) != (uint32_t)(((uint64_t)code * 3000 * (ADC_VREF)) / ((uint64_t)vref * 4095)))
+		{
+			butong++;
+		}
+	}
+
+	// 周期/次 = us * (SystemCoreClock/1MHz) / 4096 (含循环和累加)
+	DeBug_print("ADC conv: vref %lu, 4096 codes: div %luus (%lu cyc/conv), recip %luus (%lu cyc/conv), init %luus, mismatch %lu\r\n",
+	            (unsigned long)vref,
+	            (unsigned long)chufa_us, (unsigned long)(chufa_us * (SystemCoreClock / 1000000U) / 4096),
+	            (unsigned long)daoshu_us, (unsigned long)(daoshu_us * (SystemCoreClock / 1000000U) / 4096),
+	            (unsigned long)jisuan_us, (unsigned long)butong);
+}
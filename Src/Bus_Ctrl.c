@@ -0,0 +1,116 @@
+#include "Bus_Ctrl.h"
+#include "time.h"
+#include "uart1.h"
+#include "Test_List.h"
+#include "jig_config.h"
+
+// 多工位总线时隙应答
+// 所有工位挂在同一条RS-485上, 同时收到广播帧, 并在同一时刻(最后一字节后
+// BUS_RX_IDLE_MS)完成解析。时隙起点以接收中断记录的最后一字节时刻为基准,
+// 不受各工位主循环快慢影响。主循环若被阻塞到时隙过半才轮到发送, 或者本时隙
+// 内总线上已经出现其他数据, 则放弃本次应答并计数, 避免与相邻工位冲突。
+
+static volatile uint32_t bus_last_rx_ms = 0;
+static void (*bus_pending_send)(void) = NULL;
+static uint32_t bus_slot_start_ms = 0;
+static uint32_t bus_slot_ms = 100;
+static uint32_t bus_guangbo_end_ms = 0;
+static struct Bus_tongji bus_tongji;
+
+void Bus_Init(void)
+{
+	memset(&bus_tongji, 0, sizeof(bus_tongji));
+	bus_pending_send = NULL;
+	bus_last_rx_ms = time_ms_count;
+	bus_guangbo_end_ms = time_ms_count;
+}
+
+void Bus_Rx_Mark(void)
+{
+	bus_last_rx_ms = time_ms_count;
+}
+
+uint8_t Bus_Is_Mine(uint8_t gongwei)
+{
+	return (gongwei == Test_jiejuo_jilu.gongwei || gongwei == BUS_GUANGBO);
+}
+
+void Bus_Slot_Reply(void (*send)(void))
+{
+	bus_tongji.guangbo_rx++;
+	Bus_Guangbo_Mark();
+	// 广播窗口只有 BUS_GONGWEI_MAX 个时隙, 更大的工位号会在窗口结束后应答,
+	// 与上位机的下一帧冲突, 放弃应答 (计入错过时隙)
+	if (Test_jiejuo_jilu.gongwei >= BUS_GONGWEI_MAX)
+	{
+		bus_pending_send = NULL;
+		bus_tongji.slot_miss++;
+		return;
+	}
+	bus_slot_start_ms = bus_last_rx_ms + BUS_RX_IDLE_MS + (uint32_t)Test_jiejuo_jilu.gongwei * bus_slot_ms;
+	bus_pending_send = send;
+}
+
+void Bus_Guangbo_Mark(void)
+{
+	bus_slot_ms = JigConfig_Get(JIG_CFG_BUS_SLOT_MS);
+	bus_guangbo_end_ms = bus_last_rx_ms + BUS_RX_IDLE_MS + BUS_GONGWEI_MAX * bus_slot_ms;
+}
+
+void Bus_Process(void)
+{
+	void (*send)(void);
+	uint32_t now;
+	uint32_t late;
+
+	if (bus_pending_send == NULL)
+	{
+		return;
+	}
+	now = time_ms_count;
+	if ((int32_t)(now - bus_slot_start_ms) < 0)
+	{
+		return;
+	}
+	send = bus_pending_send;
+	bus_pending_send = NULL;
+	late = now - bus_slot_start_ms;
+	// 时隙内已有其他工位在发送
+	if ((int32_t)(bus_last_rx_ms - bus_slot_start_ms) >= 0)
+	{
+		bus_tongji.chongtu++;
+		return;
+	}
+	// 剩余时间不足以发完应答
+	if (late > bus_slot_ms / 2)
+	{
+		bus_tongji.slot_miss++;
+		return;
+	}
+	if (late > bus_tongji.late_max_ms)
+	{
+		bus_tongji.late_max_ms = late;
+	}
+	send();
+	bus_tongji.slot_tx++;
+}
+
+uint8_t Bus_Kongxian(uint32_t idle_ms)
+{
+	uint32_t now = time_ms_count;
+
+	if (bus_pending_send != NULL)
+	{
+		return 0;
+	}
+	if ((int32_t)(now - bus_guangbo_end_ms) < 0)
+	{
+		return 0;
+	}
+	return (now - bus_last_rx_ms) >= idle_ms;
+}
+
+void Bus_Get_tongji(struct Bus_tongji *out)
+{
+	*out = bus_tongji;
+}
@@ -0,0 +1,103 @@
+#include "Calib_Ctrl.h"
+#include "ADC_CHK.h"
+#include "ZDINA219.h"
+#include "Test_List.h"
+#include "Push_Ctrl.h"
+#include "time.h"
+#include "uart1.h"
+#include "meas_calib.h"
+
+// 测量通道两点校准
+// 采样读取未校准的原始值 (电压为分压后引脚mV, 功耗为默认校准寄存器下的INA219读数),
+// 校准值由 meas_calib 计算和保存, 在 ADC_CHK.c / ZDINA219.c 的测量函数中换算。
+
+// 各电压通道对应的 ADC_Rails_Main 下标
+static const uint8_t calib_rail[CALIB_CH_GONGHAO] = {2, 4, 1, 0, 3, 5};
+
+static uint8_t calib_zhuangtai = 0; // 0空闲 1等待稳定
+static uint32_t calib_kaishi_ms = 0;
+static uint8_t calib_dian = 0;      // 本次采样的点号
+static uint8_t calib_tongdao = 0;   // 本次采样的通道掩码
+
+static void calib_caiyang(void)
+{
+	int32_t yuanshi[CALIB_CH_NUM] = {0};
+	uint32_t he;
+	uint8_t i, j;
+
+	for (i = 0; i < CALIB_CH_GONGHAO; i++)
+	{
+		if ((calib_tongdao & (1U << i)) == 0)
+			continue;
+		// 2^n 次之和即平均值 x2^n, 保留小数
+		he = 0;
+		for (j = 0; j < (1U << MEASCAL_RAW_SHIFT); j++)
+		{
+			he += ADC_GetRailPinMv(&ADC_Rails_Main[calib_rail[i]]);
+		}
+		yuanshi[i] = (int32_t)he;
+	}
+	if (calib_tongdao & (1U << CALIB_CH_GONGHAO))
+	{
+		// 功耗为有符号数, 已是多次读数的平均
+		yuanshi[CALIB_CH_GONGHAO] = (int32_t)(int16_t)Current_CHK_Raw() * (1 << MEASCAL_RAW_SHIFT);
+	}
+
+	MeasCalib_SubmitPoint(yuanshi);
+	for (i = 0; i < CALIB_CH_NUM; i++)
+	{
+		if (calib_tongdao & (1U << i))
+		{
+			DeBug_print("Calib point%d ch%d: raw %ld/16, ref %ld\r\n", calib_dian, i,
+			            (long)MeasCalib_GetPoint(i)->raw[calib_dian],
+			            (long)MeasCalib_GetPoint(i)->ref[calib_dian]);
+		}
+	}
+	Push_Event(PUSH_EVT_CALIB, 0, calib_dian, calib_tongdao);
+}
+
+void Calib_Init(void)
+{
+	uint32_t biaocheng[CALIB_CH_NUM];
+	uint8_t i;
+
+	// 标称增益: 电压为分压倍数, 功耗为1
+	for (i = 0; i < CALIB_CH_GONGHAO; i++)
+	{
+		biaocheng[i] = (uint32_t)ADC_Rails_Main[calib_rail[i]].divider << MEASCAL_GAIN_SHIFT;
+	}
+	biaocheng[CALIB_CH_GONGHAO] = 1UL << MEASCAL_GAIN_SHIFT;
+	MeasCalib_Init(CALIB_CH_NUM, biaocheng);
+	DeBug_print("Calib: #%u, calibrated channels %02X\r\n", MeasCalib_Seq(), MeasCalib_ValidMask());
+}
+
+void Calib_Process(void)
+{
+	switch (calib_zhuangtai)
+	{
+	case 0:
+		if (Test_liucheng_L != w_wait || !MeasCalib_TakeRequest(&calib_dian, &calib_tongdao))
+			return;
+		// 与测试开始时相同的供电状态
+		test_start_Init();
+		calib_kaishi_ms = time_ms_count;
+		calib_zhuangtai = 1;
+		DeBug_print("Calib point%d: settling %dms\r\n", calib_dian, CALIB_WENDING_MS);
+		break;
+	case 1:
+		if (Test_liucheng_L != w_wait)
+		{
+			MeasCalib_Cancel();
+			calib_zhuangtai = 0;
+			return;
+		}
+		if (time_ms_count - calib_kaishi_ms < CALIB_WENDING_MS)
+			return;
+		calib_caiyang();
+		calib_zhuangtai = 0;
+		break;
+	default:
+		calib_zhuangtai = 0;
+		break;
+	}
+}
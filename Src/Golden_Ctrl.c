@@ -0,0 +1,96 @@
+#include "Golden_Ctrl.h"
+#include "ADC_CHK.h"
+#include "ZDINA219.h"
+#include "Test_List.h"
+#include "Push_Ctrl.h"
+#include "time.h"
+#include "uart1.h"
+#include "golden_sample.h"
+
+// 金样检测
+// 测量走生产测试的同一条路径 (同样的换算系数和校准值), 检测结果反映的就是
+// 生产测试时的测量误差。判定/漂移估计/保存由 golden_sample 完成。
+
+static uint8_t golden_zhuangtai = 0; // 0空闲 1等待稳定
+static uint32_t golden_kaishi_ms = 0;
+
+// 电压通道多次测量取平均, 减小单次ADC噪声对趋势的影响
+static int32_t golden_pingjun(uint32_t (*celiang)(void))
+{
+	uint32_t he = 0;
+	uint8_t i;
+
+	for (i = 0; i < GOLDEN_CAIYANG; i++)
+	{
+		he += celiang();
+	}
+	return (int32_t)((he + GOLDEN_CAIYANG / 2) / GOLDEN_CAIYANG);
+}
+
+static void golden_celiang(void)
+{
+	int32_t zhi[GOLDEN_CH_NUM];
+	GoldenRecord jilu;
+	uint8_t i;
+
+	zhi[GOLDEN_CH_VCC] = golden_pingjun(get_VCC_weizhi_dianya);
+	zhi[GOLDEN_CH_GONGDIAN] = golden_pingjun(get_zhudian_gongdian_weizhi_dianya);
+	zhi[GOLDEN_CH_VDD] = golden_pingjun(get_erjidianyuan_weizhi_dianya);
+	zhi[GOLDEN_CH_ZHUDIAN] = golden_pingjun(get_zhudian_weizhi_dianya);
+	zhi[GOLDEN_CH_SHENGYA] = golden_pingjun(get_SY_weizhi_dianya);
+	zhi[GOLDEN_CH_GONGZHUANG] = golden_pingjun(get_gongzhuang_MCU_gongdian_weizhi_dianya);
+	// 功耗为有符号数 (INA219 分流电压寄存器)
+	zhi[GOLDEN_CH_GONGHAO] = (int16_t)Current_CHK_Func();
+
+	GoldenSample_Submit(zhi, GOLDEN_CH_NUM, &jilu);
+	for (i = 0; i < GOLDEN_CH_NUM; i++)
+	{
+		DeBug_print("Golden ch%d: %ld (%+d)\r\n", i, (long)zhi[i], jilu.dev[i]);
+	}
+	// 结果 = 超差通道, 数据 = 需要重新校准的通道; 新标记时另报异常
+	Push_Event(PUSH_EVT_GOLDEN, 0, jilu.fail, GoldenSample_RecalMask());
+	if (jilu.flags & GOLDEN_REC_RECAL)
+	{
+		Push_Event(PUSH_EVT_FAULT, 0, PUSH_FAULT_RECAL, GoldenSample_RecalMask());
+	}
+}
+
+void Golden_Init(void)
+{
+	GoldenSample_Init();
+	if (GoldenSample_RecalMask() != 0)
+	{
+		DeBug_print("Golden sample: recalibration needed, channels %02X\r\n", GoldenSample_RecalMask());
+	}
+}
+
+void Golden_Process(void)
+{
+	switch (golden_zhuangtai)
+	{
+	case 0:
+		if (Test_liucheng_L != w_wait || !GoldenSample_TakeRequest())
+			return;
+		// 与测试开始时相同的供电状态
+		test_start_Init();
+		golden_kaishi_ms = time_ms_count;
+		golden_zhuangtai = 1;
+		DeBug_print("Golden sample: settling %dms\r\n", GOLDEN_WENDING_MS);
+		break;
+	case 1:
+		if (Test_liucheng_L != w_wait)
+		{
+			GoldenSample_Cancel();
+			golden_zhuangtai = 0;
+			return;
+		}
+		if (time_ms_count - golden_kaishi_ms < GOLDEN_WENDING_MS)
+			return;
+		golden_celiang();
+		golden_zhuangtai = 0;
+		break;
+	default:
+		golden_zhuangtai = 0;
+		break;
+	}
+}
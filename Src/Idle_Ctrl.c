@@ -0,0 +1,115 @@
+#include "Idle_Ctrl.h"
+#include "time.h"
+#include "uart1.h"
+
+// 主循环空闲管理
+// 主循环每轮轮询完毕后进入WFI (Sleep模式, 非DeepSleep)，外设和时钟保持运行。
+// 任意中断都会唤醒: 串口接收立即唤醒；ATIM 1ms中断保证最长休眠1ms，
+// 因此所有基于毫秒倒计时的超时、看门狗喂狗周期都不受影响。
+
+uint8_t Idle_Enable = 1;
+
+static volatile uint8_t idle_event_pending = 0; // 休眠判断后到WFI前到达的事件
+static volatile uint8_t idle_sleeping = 0;
+static volatile uint8_t idle_wake_src = IDLE_WAKE_NONE;
+static volatile uint32_t idle_wake_us = 0;       // 唤醒中断发生时刻
+
+static struct Idle_tongji idle_tongji;
+static uint32_t idle_window_start_us = 0;
+
+void Idle_Init(void)
+{
+	memset(&idle_tongji, 0, sizeof(idle_tongji));
+	idle_event_pending = 0;
+	idle_sleeping = 0;
+	idle_wake_src = IDLE_WAKE_NONE;
+	idle_window_start_us = time_get_us();
+	// 使用Sleep模式, WFI后内核停止, 外设继续运行
+	SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+}
+
+void Idle_Wake_Mark(uint8_t wake_src)
+{
+	idle_event_pending = 1;
+	if (idle_sleeping && idle_wake_src == IDLE_WAKE_NONE)
+	{
+		idle_wake_src = wake_src;
+		idle_wake_us = time_get_us();
+	}
+}
+
+void Idle_Sleep(void)
+{
+	uint32_t sleep_start_us;
+	uint32_t wake_us;
+	uint8_t src;
+
+	if (Idle_Enable == 0)
+	{
+		return;
+	}
+
+	// 关中断后判断, 避免判断后、WFI前到达的中断被睡过去;
+	// PRIMASK置位时挂起的中断仍能唤醒WFI, 开中断后立即执行ISR
+	__disable_irq();
+	if (idle_event_pending)
+	{
+		idle_event_pending = 0;
+		__enable_irq();
+		return;
+	}
+	idle_sleeping = 1;
+	idle_wake_src = IDLE_WAKE_NONE;
+	sleep_start_us = time_get_us();
+	__DSB();
+	__WFI();
+	__enable_irq(); // 唤醒中断在此处执行
+	idle_sleeping = 0;
+	wake_us = time_get_us();
+
+	src = idle_wake_src;
+	idle_tongji.sleep_count++;
+	idle_tongji.sleep_us += wake_us - sleep_start_us;
+	idle_tongji.wake_count[src < IDLE_WAKE_NUM ? src : IDLE_WAKE_NONE]++;
+	if (src != IDLE_WAKE_NONE)
+	{
+		idle_tongji.wake_latency_last_us = wake_us - idle_wake_us;
+		if (idle_tongji.wake_latency_last_us > idle_tongji.wake_latency_max_us)
+		{
+			idle_tongji.wake_latency_max_us = idle_tongji.wake_latency_last_us;
+		}
+	}
+	idle_event_pending = 0;
+}
+
+void Idle_Get_tongji(struct Idle_tongji *out)
+{
+	uint32_t now_us = time_get_us();
+
+	idle_tongji.window_us = now_us - idle_window_start_us;
+	if (out != NULL)
+	{
+		*out = idle_tongji;
+	}
+	memset(&idle_tongji, 0, sizeof(idle_tongji));
+	idle_window_start_us = now_us;
+}
+
+void Idle_Report(void)
+{
+	struct Idle_tongji t;
+	uint32_t idle_permille = 0;
+
+	Idle_Get_tongji(&t);
+	if (t.window_us != 0)
+	{
+		idle_permille = (uint32_t)(((uint64_t)t.sleep_us * 1000) / t.window_us);
+	}
+	DeBug_print("[Idle] %s idle=%lu.%lu%% sleeps=%lu wake u0/u1/u5/tmr=%lu/%lu/%lu/%lu lat=%lu/%luus\r\n",
+	            Idle_Enable ? "on" : "off",
+	            (unsigned long)(idle_permille / 10), (unsigned long)(idle_permille % 10),
+	            (unsigned long)t.sleep_count,
+	            (unsigned long)t.wake_count[IDLE_WAKE_UART0], (unsigned long)t.wake_count[IDLE_WAKE_UART1],
+	            (unsigned long)t.wake_count[IDLE_WAKE_UART5], (unsigned long)t.wake_count[IDLE_WAKE_NONE],
+	            (unsigned long)t.wake_latency_last_us, (unsigned long)t.wake_latency_max_us);
+}
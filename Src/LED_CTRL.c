@@ -1,22 +1,161 @@
 #include "LED_CTRL.h"
 #include "GPIO.h"
 
-uint8_t LED_thing_FLAG = 0;
-uint8_t LED_thing_time = 0;
+// 通讯指示: 亮20ms后恢复循环模式
+static const LedPattern_t led_flash = {.period_ms = 20, .sequence = {1}, .seq_count = 1, .once = 1};
 
-void LED_FLAG_Run()
+static const LedPattern_t *volatile led_loop; // 循环模式
+static const LedPattern_t *volatile led_cur;  // 正在播放
+static uint8_t led_seg;     // 下一时间片 / 呼吸帧序号
+static uint8_t led_phase;   // 呼吸: 0=下一段为亮 1=下一段为灭
+static uint16_t led_on_us;  // 呼吸: 本帧亮的时间
+
+static void led_output(uint8_t level)
+{
+	if (level)
+	{
+		LED_On();
+	}
+	else
+	{
+		LED_Off();
+	}
+}
+
+// 呼吸帧亮度: 三角波再平方, 人眼感觉较线性
+static uint16_t led_breath_on_us(const LedPattern_t *p, uint8_t frame)
+{
+	uint16_t frames = (uint32_t)p->period_ms * 1000 / LED_BREATH_FRAME_US;
+	uint16_t half = frames / 2;
+	uint32_t d = (frame < half) ? frame : frames - frame;
+	return (uint32_t)LED_BREATH_FRAME_US * d * d / ((uint32_t)half * half);
+}
+
+// 输出下一段并设置其时长, 返回0表示单次模式已播完
+static uint8_t led_next_segment(void)
 {
-	LED_On();
-	LED_thing_FLAG = 1;
-	//灯会亮一下
-	LED_thing_time = 20;
+	const LedPattern_t *p = led_cur;
+	uint16_t frames;
+	uint8_t level;
+	uint8_t n = 1;
+
+	if (p->breath)
+	{
+		frames = (uint32_t)p->period_ms * 1000 / LED_BREATH_FRAME_US;
+		if (led_phase == 0)
+		{
+			led_on_us = led_breath_on_us(p, led_seg);
+			if (led_on_us > 0 && led_on_us < LED_BREATH_FRAME_US)
+			{
+				led_output(1);
+				FL_GPTIM_WriteAutoReload(GPTIM2, led_on_us - 1);
+				led_phase = 1;
+				return 1;
+			}
+			// 全亮或全灭的帧只中断一次
+			led_output(led_on_us > 0);
+			FL_GPTIM_WriteAutoReload(GPTIM2, LED_BREATH_FRAME_US - 1);
+		}
+		else
+		{
+			led_output(0);
+			FL_GPTIM_WriteAutoReload(GPTIM2, LED_BREATH_FRAME_US - led_on_us - 1);
+			led_phase = 0;
+		}
+		led_seg = (led_seg + 1 < frames) ? led_seg + 1 : 0;
+		return 1;
+	}
+
+	if (led_seg >= p->seq_count)
+	{
+		if (p->once)
+		{
+			return 0;
+		}
+		led_seg = 0;
+	}
+	// 相同电平的连续时间片合并为一段
+	level = p->sequence[led_seg];
+	while (led_seg + n < p->seq_count && p->sequence[led_seg + n] == level)
+	{
+		n++;
+	}
+	led_seg += n;
+	led_output(level);
+	FL_GPTIM_WriteAutoReload(GPTIM2, (uint32_t)n * (p->period_ms / p->seq_count) - 1);
+	return 1;
 }
-void LED_FLAG_LOOP()
+
+static void led_start(const LedPattern_t *p)
 {
-	if(LED_thing_FLAG==0)
+	FL_GPTIM_Disable(GPTIM2);
+	FL_GPTIM_ClearFlag_Update(GPTIM2);
+	led_cur = p;
+	led_seg = 0;
+	led_phase = 0;
+	// 常亮/常灭不需要定时器
+	if (!p->breath && !p->once && p->seq_count == 1)
+	{
+		led_output(p->sequence[0]);
 		return;
-	if(LED_thing_time!=0)
+	}
+	// 呼吸按1us计数, 其他按1ms计数; 软件更新事件装载新的预分频
+	FL_GPTIM_WritePrescaler(GPTIM2, p->breath ? 31 : 31999);
+	FL_GPTIM_WriteCounter(GPTIM2, 0);
+	FL_GPTIM_GenerateUpdateEvent(GPTIM2);
+	FL_GPTIM_ClearFlag_Update(GPTIM2);
+	led_next_segment();
+	FL_GPTIM_Enable(GPTIM2);
+}
+
+void GPTIM2_IRQHandler(void)
+{
+	if (FL_GPTIM_IsEnabledIT_Update(GPTIM2) && FL_GPTIM_IsActiveFlag_Update(GPTIM2))
+	{
+		FL_GPTIM_ClearFlag_Update(GPTIM2);
+		if (led_next_segment() == 0)
+		{
+			led_start(led_loop);
+		}
+	}
+}
+
+void LED_Init(void)
+{
+	FL_GPTIM_InitTypeDef TimerBase_InitStruct;
+	FL_NVIC_ConfigTypeDef InterruptConfigStruct;
+
+	TimerBase_InitStruct.prescaler = 31999;
+	TimerBase_InitStruct.counterMode = FL_GPTIM_COUNTER_DIR_UP;
+	TimerBase_InitStruct.autoReload = 999;
+	TimerBase_InitStruct.autoReloadState = FL_DISABLE;
+	TimerBase_InitStruct.clockDivision = FL_GPTIM_CLK_DIVISION_DIV1;
+	FL_GPTIM_Init(GPTIM2, &TimerBase_InitStruct);
+	FL_GPTIM_ClearFlag_Update(GPTIM2);
+	FL_GPTIM_EnableIT_Update(GPTIM2);
+
+	InterruptConfigStruct.preemptPriority = 0x03;
+	FL_NVIC_Init(&InterruptConfigStruct, GPTIM2_IRQn);
+
+	Led_Play(0, LedIndicator_GetPattern(LED_BLINK_OFF));
+}
+
+void Led_Play(uint8_t led_index, const LedPattern_t *pattern)
+{
+	if (led_index != 0 || pattern == NULL)
+	{
 		return;
-	LED_thing_FLAG = 0;
-	LED_Off();
+	}
+	NVIC_DisableIRQ(GPTIM2_IRQn);
+	if (!pattern->once)
+	{
+		led_loop = pattern;
+	}
+	led_start(pattern);
+	NVIC_EnableIRQ(GPTIM2_IRQn);
+}
+
+void LED_FLAG_Run()
+{
+	Led_Play(0, &led_flash);
 }
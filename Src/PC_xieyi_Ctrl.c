@@ -3,8 +3,17 @@
 #include "Test_List.h"
 #include "uart0.h"
 #include "uart1.h"
+#include "Trace_Ctrl.h"
+#include "Bus_Ctrl.h"
+#include "Push_Ctrl.h"
+#include "Prof_Ctrl.h"
+#include "Stack_Ctrl.h"
+#include "Idle_Ctrl.h"
+#include "ADC_CHK.h"
+#include "pc_protocol.h"
+#include "Protocol/upgrade_bank.h"
 #define send_lenth 200
-uint8_t xieyi1_fanhui[5] = {0x68, 0xAB, 0x00, 0x13, 0x16};
+uint8_t xieyi1_fanhui[5] = {0x68, PC_CMD_JIG_START_ACK, 0x00, 0x13, 0x16};
 uint8_t xieyi2_fanhui[send_lenth];
 // 开始测试设置成功后发?
 void PC_xieyifasong_1()
@@ -22,7 +31,7 @@ void PC_xieyifasong_2()
 	uint16_t hejiaoyan = 0;
 	memset(xieyi2_fanhui, 0x00, send_lenth);
 	xieyi2_fanhui[jishu_lenth++] = 0x68;
-	xieyi2_fanhui[jishu_lenth++] = 0xAD;
+	xieyi2_fanhui[jishu_lenth++] = PC_CMD_JIG_RESULT_ACK;
 	xieyi2_fanhui[jishu_lenth++] = Test_jiejuo_jilu.gongwei;
 	xieyi2_fanhui[jishu_lenth++] = ((Test_jiejuo_jilu.zhidian_gongdiandianya / 10) >> 8) & 0xFF;
 	xieyi2_fanhui[jishu_lenth++] = (Test_jiejuo_jilu.zhidian_gongdiandianya / 10) & 0xFF;
@@ -51,11 +60,602 @@ void PC_xieyifasong_2()
 	PC_Chuankou_tongxin_send(xieyi2_fanhui, jishu_lenth);
 }
 
+// 通讯录制控制应答: 68 A1 工位 子命令 状态 和校验 16
+void PC_xieyifasong_trace(uint8_t sub)
+{
+	uint8_t fanhui[7];
+	struct Trace_tongji tongji;
+	Trace_Get_tongji(&tongji);
+	fanhui[0] = 0x68;
+	fanhui[1] = PC_CMD_TRACE_ACK;
+	fanhui[2] = Test_jiejuo_jilu.gongwei;
+	fanhui[3] = sub;
+	fanhui[4] = tongji.running;
+	fanhui[5] = fanhui[0] + fanhui[1] + fanhui[2] + fanhui[3] + fanhui[4];
+	fanhui[6] = 0x16;
+	PC_Chuankou_tongxin_send(fanhui, 7);
+}
+
+// 总线时隙统计应答: 68 B1 工位 广播数(2) 应答数(2) 错过数(2) 冲突数(2) 最大延迟ms(2) 和校验 16
+void PC_xieyifasong_bus()
+{
+	uint8_t fanhui[15];
+	uint8_t i;
+	uint16_t shuju[5];
+	struct Bus_tongji tongji;
+	Bus_Get_tongji(&tongji);
+	shuju[0] = tongji.guangbo_rx > 0xFFFF ? 0xFFFF : tongji.guangbo_rx;
+	shuju[1] = tongji.slot_tx > 0xFFFF ? 0xFFFF : tongji.slot_tx;
+	shuju[2] = tongji.slot_miss > 0xFFFF ? 0xFFFF : tongji.slot_miss;
+	shuju[3] = tongji.chongtu > 0xFFFF ? 0xFFFF : tongji.chongtu;
+	shuju[4] = tongji.late_max_ms > 0xFFFF ? 0xFFFF : tongji.late_max_ms;
+	fanhui[0] = 0x68;
+	fanhui[1] = PC_CMD_BUS_STATS_ACK;
+	fanhui[2] = Test_jiejuo_jilu.gongwei;
+	for (i = 0; i < 5; i++)
+	{
+		fanhui[3 + i * 2] = (shuju[i] >> 8) & 0xFF;
+		fanhui[4 + i * 2] = shuju[i] & 0xFF;
+	}
+	fanhui[13] = 0;
+	for (i = 0; i < 13; i++)
+	{
+		fanhui[13] += fanhui[i];
+	}
+	fanhui[14] = 0x16;
+	PC_Chuankou_tongxin_send(fanhui, 15);
+}
+
+// 事件上报状态应答: 68 B5 工位 开关 事件数(2) 发送数(2) 重发数(2) 确认数(2) 丢弃数(2) 最大确认延时ms(2) 和校验 16
+void PC_xieyifasong_push()
+{
+	uint8_t fanhui[18];
+	uint8_t i;
+	uint32_t shuju[6];
+	struct Push_tongji tongji;
+	Push_Get_tongji(&tongji);
+	shuju[0] = tongji.shangbao;
+	shuju[1] = tongji.fasong;
+	shuju[2] = tongji.chongfa;
+	shuju[3] = tongji.queren;
+	shuju[4] = tongji.diuqi + tongji.yichu;
+	shuju[5] = tongji.yanchi_max_ms;
+	fanhui[0] = 0x68;
+	fanhui[1] = PC_CMD_PUSH_CTRL_ACK;
+	fanhui[2] = Test_jiejuo_jilu.gongwei;
+	fanhui[3] = Push_Is_Enabled();
+	for (i = 0; i < 6; i++)
+	{
+		if (shuju[i] > 0xFFFF)
+		{
+			shuju[i] = 0xFFFF;
+		}
+		fanhui[4 + i * 2] = (shuju[i] >> 8) & 0xFF;
+		fanhui[5 + i * 2] = shuju[i] & 0xFF;
+	}
+	fanhui[16] = 0;
+	for (i = 0; i < 16; i++)
+	{
+		fanhui[16] += fanhui[i];
+	}
+	fanhui[17] = 0x16;
+	PC_Chuankou_tongxin_send(fanhui, 18);
+}
+
+// CPU耗时剖析控制应答: 68 B7 工位 子命令 状态 采样数(4) 和校验 16
+void PC_xieyifasong_prof(uint8_t sub)
+{
+	uint8_t fanhui[11];
+	uint8_t i;
+	struct Prof_tongji tongji;
+	Prof_Get_tongji(&tongji);
+	fanhui[0] = 0x68;
+	fanhui[1] = PC_CMD_PROF_ACK;
+	fanhui[2] = Test_jiejuo_jilu.gongwei;
+	fanhui[3] = sub;
+	fanhui[4] = tongji.running;
+	fanhui[5] = (tongji.samples >> 24) & 0xFF;
+	fanhui[6] = (tongji.samples >> 16) & 0xFF;
+	fanhui[7] = (tongji.samples >> 8) & 0xFF;
+	fanhui[8] = tongji.samples & 0xFF;
+	fanhui[9] = 0;
+	for (i = 0; i < 9; i++)
+	{
+		fanhui[9] += fanhui[i];
+	}
+	fanhui[10] = 0x16;
+	PC_Chuankou_tongxin_send(fanhui, 11);
+}
+
+// RAM使用应答: 68 B9 工位 RAM总大小(2) 静态(2) 堆(2) 栈保留(2) 栈水位(2) 当前栈(2) 最小剩余(2) 和校验 16
+void PC_xieyifasong_ram()
+{
+	uint8_t fanhui[19];
+	uint8_t i;
+	uint32_t shuju[7];
+	struct Stack_tongji tongji;
+	Stack_Get_tongji(&tongji);
+	shuju[0] = tongji.ram_size;
+	shuju[1] = tongji.static_size;
+	shuju[2] = tongji.heap_used;
+	shuju[3] = tongji.stack_rsv;
+	shuju[4] = tongji.stack_peak;
+	shuju[5] = tongji.stack_now;
+	shuju[6] = tongji.free_min;
+	fanhui[0] = 0x68;
+	fanhui[1] = PC_CMD_RAM_STATS_ACK;
+	fanhui[2] = Test_jiejuo_jilu.gongwei;
+	for (i = 0; i < 7; i++)
+	{
+		fanhui[3 + i * 2] = (shuju[i] >> 8) & 0xFF;
+		fanhui[4 + i * 2] = shuju[i] & 0xFF;
+	}
+	fanhui[17] = 0;
+	for (i = 0; i < 17; i++)
+	{
+		fanhui[17] += fanhui[i];
+	}
+	fanhui[18] = 0x16;
+	PC_Chuankou_tongxin_send(fanhui, 19);
+}
+
+// 空闲统计应答: 68 A5 工位 使能 窗口us(4) 休眠us(4) 休眠次数(4) 唤醒UART0/UART1/UART5/定时器(各2) 唤醒延时us 最近(2) 最大(2) 和校验 16
+// 与心跳 Idle_Report 共用统计窗口, 读取后重新开始统计
+void PC_xieyifasong_idle()
+{
+	uint8_t fanhui[30];
+	uint8_t i;
+	uint8_t n = 4;
+	uint32_t shuju[3];
+	uint32_t shuju16[6];
+	struct Idle_tongji tongji;
+	Idle_Get_tongji(&tongji);
+	shuju[0] = tongji.window_us;
+	shuju[1] = tongji.sleep_us;
+	shuju[2] = tongji.sleep_count;
+	shuju16[0] = tongji.wake_count[IDLE_WAKE_UART0];
+	shuju16[1] = tongji.wake_count[IDLE_WAKE_UART1];
+	shuju16[2] = tongji.wake_count[IDLE_WAKE_UART5];
+	shuju16[3] = tongji.wake_count[IDLE_WAKE_NONE];
+	shuju16[4] = tongji.wake_latency_last_us;
+	shuju16[5] = tongji.wake_latency_max_us;
+	fanhui[0] = 0x68;
+	fanhui[1] = PC_CMD_IDLE_STATS_ACK;
+	fanhui[2] = Test_jiejuo_jilu.gongwei;
+	fanhui[3] = Idle_Enable;
+	for (i = 0; i < 3; i++)
+	{
+		fanhui[n++] = (shuju[i] >> 24) & 0xFF;
+		fanhui[n++] = (shuju[i] >> 16) & 0xFF;
+		fanhui[n++] = (shuju[i] >> 8) & 0xFF;
+		fanhui[n++] = shuju[i] & 0xFF;
+	}
+	for (i = 0; i < 6; i++)
+	{
+		if (shuju16[i] > 0xFFFF)
+		{
+			shuju16[i] = 0xFFFF;
+		}
+		fanhui[n++] = (shuju16[i] >> 8) & 0xFF;
+		fanhui[n++] = shuju16[i] & 0xFF;
+	}
+	fanhui[28] = 0;
+	for (i = 0; i < 28; i++)
+	{
+		fanhui[28] += fanhui[i];
+	}
+	fanhui[29] = 0x16;
+	PC_Chuankou_tongxin_send(fanhui, 30);
+}
+
+// ADCʱӦ: 68 A7 λ  ״̬(0ɹ 1 2ʧ) ȡus(4) us(4) У 16
+// в (ADCͼ⿪ɲԲռ)
+void PC_xieyifasong_adc(uint8_t samples)
+{
+	uint8_t fanhui[15];
+	uint8_t i;
+	ADC_RailBench_t jieguo = {0};
+	fanhui[0] = 0x68;
+	fanhui[1] = PC_CMD_ADC_BENCH_ACK;
+	fanhui[2] = Test_jiejuo_jilu.gongwei;
+	fanhui[3] = samples;
+	if (Test_liucheng_L != w_wait)
+	{
+		fanhui[4] = 1;
+	}
+	else
+	{
+		fanhui[4] = ADC_RailSet_Benchmark(samples, &jieguo) == 0 ? 0 : 2;
+	}
+	fanhui[5] = (jieguo.legacy_us >> 24) & 0xFF;
+	fanhui[6] = (jieguo.legacy_us >> 16) & 0xFF;
+	fanhui[7] = (jieguo.legacy_us >> 8) & 0xFF;
+	fanhui[8] = jieguo.legacy_us & 0xFF;
+	fanhui[9] = (jieguo.batch_us >> 24) & 0xFF;
+	fanhui[10] = (jieguo.batch_us >> 16) & 0xFF;
+	fanhui[11] = (jieguo.batch_us >> 8) & 0xFF;
+	fanhui[12] = jieguo.batch_us & 0xFF;
+	fanhui[13] = 0;
+	for (i = 0; i < 13; i++)
+	{
+		fanhui[13] += fanhui[i];
+	}
+	fanhui[14] = 0x16;
+	PC_Chuankou_tongxin_send(fanhui, 15);
+}
+
+// 0x55 帧命令 (55 命令 帧长 工位 ... 和校验 AA) 由 Components/Protocol/PC 中的协议实现,
+// 按命令码转发给对应协议的 parse, 应答经 PC_Chuankou_tongxin_send 发回
+struct PC_zhuanfa
+{
+	uint8_t cmd;
+	const ProtocolInterface *xieyi;
+};
+static const struct PC_zhuanfa pc_zhuanfa[] = {
+	{PC_CMD_CONFIG_GET, &config_pc_protocol},
+	{PC_CMD_CONFIG_SET, &config_pc_protocol},
+	{PC_CMD_TEST_STATS, &config_pc_protocol},
+	{PC_CMD_PLAN_LOAD, &config_pc_protocol},
+	{PC_CMD_PLAN_GET, &config_pc_protocol},
+	{PC_CMD_GOLDEN, &config_pc_protocol},
+	{PC_CMD_CALIB, &config_pc_protocol},
+	{PC_CMD_BANK_LOAD, &upgrade_pc_protocol},
+};
+
+static uint8_t pc_gongwei(void)
+{
+	return Test_jiejuo_jilu.gongwei;
+}
+// 测试中不写B区 (擦除扇区会阻塞测试采样), 后台下载命令回 BUSY 由上位机稍后重发
+static bool pc_ceshizhong(void)
+{
+	return Test_liucheng_L != w_wait;
+}
+
+void PC_xieyi_Init()
+{
+	PC_Protocol_SetStationIdFunc(pc_gongwei);
+	config_pc_protocol.set_send_func(PC_Chuankou_tongxin_send);
+	config_pc_protocol.init();
+	upgrade_pc_protocol.set_send_func(PC_Chuankou_tongxin_send);
+	upgrade_pc_protocol.init();
+	UpgradeBank_SetBusyFunc(pc_ceshizhong);
+}
+
+// 转发一帧0x55命令, 返回帧长; 帧不完整或命令未登记时返回0
+static uint16_t PC_zhuanfa_55(uint8_t zufuchua[], uint16_t lenth)
+{
+	uint8_t i;
+	uint8_t zhenchang;
+	if (lenth < 6)
+	{
+		return 0;
+	}
+	zhenchang = zufuchua[2];
+	if (zhenchang < 6 || zhenchang > lenth || zufuchua[zhenchang - 1] != FT_FRAME_TAIL)
+	{
+		return 0;
+	}
+	for (i = 0; i < sizeof(pc_zhuanfa) / sizeof(pc_zhuanfa[0]); i++)
+	{
+		if (pc_zhuanfa[i].cmd == zufuchua[1])
+		{
+			pc_zhuanfa[i].xieyi->parse(zufuchua, zhenchang);
+			return zhenchang;
+		}
+	}
+	return 0;
+}
+
+// 透传退出命令 68 A2 工位 00 和校验 16, 透传期间在UART1接收中断中匹配
+static uint8_t touchuan_tuichu[6];
+
+// 透传应答: 68 A3 工位 模式 上行转发(4) 上行丢弃(2) 上行最大积压(2) 下行转发(4) 下行丢弃(2) 下行最大积压(2) 和校验 16
+// 上行 = 被测设备(UART0) -> 上位机(UART1), 下行相反
+void PC_xieyifasong_touchuan()
+{
+	uint8_t fanhui[22];
+	uint8_t i;
+	uint8_t n = 4;
+	uint32_t drop;
+	struct Uart_Bridge_tongji tongji[2];
+	Uart_Bridge_Get_tongji(&uart0_port, &tongji[0]);
+	Uart_Bridge_Get_tongji(&uart1_port, &tongji[1]);
+	fanhui[0] = 0x68;
+	fanhui[1] = PC_CMD_BRIDGE_ACK;
+	fanhui[2] = Test_jiejuo_jilu.gongwei;
+	fanhui[3] = Uart_Bridge_Active(&uart1_port);
+	for (i = 0; i < 2; i++)
+	{
+		drop = (tongji[i].drop > 0xFFFF) ? 0xFFFF : tongji[i].drop;
+		fanhui[n++] = (tongji[i].fwd >> 24) & 0xFF;
+		fanhui[n++] = (tongji[i].fwd >> 16) & 0xFF;
+		fanhui[n++] = (tongji[i].fwd >> 8) & 0xFF;
+		fanhui[n++] = tongji[i].fwd & 0xFF;
+		fanhui[n++] = (drop >> 8) & 0xFF;
+		fanhui[n++] = drop & 0xFF;
+		fanhui[n++] = (tongji[i].peak >> 8) & 0xFF;
+		fanhui[n++] = tongji[i].peak & 0xFF;
+	}
+	fanhui[20] = 0;
+	for (i = 0; i < 20; i++)
+	{
+		fanhui[20] += fanhui[i];
+	}
+	fanhui[21] = 0x16;
+	PC_Chuankou_tongxin_send(fanhui, 22);
+}
+
+// 进入透传: 先应答, 发完后UART0与UART1在中断中直接互相转发
+void PC_touchuan_kaishi()
+{
+	uint8_t i;
+	touchuan_tuichu[0] = 0x68;
+	touchuan_tuichu[1] = PC_CMD_BRIDGE;
+	touchuan_tuichu[2] = Test_jiejuo_jilu.gongwei;
+	touchuan_tuichu[3] = 0x00;
+	touchuan_tuichu[4] = 0;
+	for (i = 0; i < 4; i++)
+	{
+		touchuan_tuichu[4] += touchuan_tuichu[i];
+	}
+	touchuan_tuichu[5] = 0x16;
+	PC_xieyifasong_touchuan();
+	Uart_Bridge_Start(&uart1_port, &uart0_port, touchuan_tuichu, 6);
+}
+
+// 0x68 帧处理函数: data 指向帧头, len 为命令表中的请求帧长, 帧尾和和校验已由 PC_jiexi_68 检查
+static bool pc_benzhan(const uint8_t *data)
+{
+	return data[2] == Test_jiejuo_jilu.gongwei;
+}
+
+// 开始测试: 68 AA 工位 主机MAC(12) 和校验 16
+static void pc_jig_start(const uint8_t *data, uint16_t len)
+{
+	(void)len;
+	DeBug_print("CMD=0xAA\r\n");
+	DeBug_print("RX_Station=%d\r\n", data[2]);
+	DeBug_print("Local_Station=%d\r\n", Test_jiejuo_jilu.gongwei);
+	if (Bus_Is_Mine(data[2]) == 0)
+	{
+		DeBug_print("!!! Station MISMATCH !!!\r\n");
+		return;
+	}
+	memcpy(Test_jiejuo_jilu.zhuji_MAC, &data[3], 12);
+	DeBug_print("\r\n[PC] Received START command\r\n");
+	DeBug_print("MAC: %.12s\r\n", Test_jiejuo_jilu.zhuji_MAC);
+	FL_DelayMs(10);
+	test_start();
+	FL_DelayMs(10);
+	DeBug_print("[PC] Sending ACK...\r\n");
+	// 广播开始: 应答排到本工位时隙
+	if (data[2] == BUS_GUANGBO)
+	{
+		Bus_Slot_Reply(PC_xieyifasong_1);
+	}
+	else
+	{
+		PC_xieyifasong_1();
+	}
+}
+
+// 查询结果: 68 AC 工位 和校验 16
+static void pc_jig_result(const uint8_t *data, uint16_t len)
+{
+	(void)len;
+	if (Bus_Is_Mine(data[2]) == 0)
+	{
+		return;
+	}
+	// 广播查询时未测完的工位不占用时隙 (上位机按超时处理)
+	if (data[2] == BUS_GUANGBO)
+	{
+		Bus_Guangbo_Mark();
+		if (Test_quanju_canshu_L.test_over == 1)
+		{
+			Bus_Slot_Reply(PC_xieyifasong_2);
+		}
+	}
+	else if (Test_quanju_canshu_L.test_over == 1)
+	{
+		PC_xieyifasong_2();
+	}
+}
+
+// 通讯录制: 68 A0 工位 子命令(0停止 1开始 2导出 3流式开始) 和校验 16
+static void pc_trace(const uint8_t *data, uint16_t len)
+{
+	(void)len;
+	if (!pc_benzhan(data))
+	{
+		return;
+	}
+	if (data[3] == 0)
+	{
+		Trace_Stop();
+		PC_xieyifasong_trace(0);
+	}
+	else if (data[3] == 1)
+	{
+		// 应答帧也会进入录制, trace_replay.py 比对时忽略0xA0/0xA1帧
+		Trace_Start();
+		PC_xieyifasong_trace(1);
+	}
+	else if (data[3] == 2)
+	{
+		Trace_Dump();
+	}
+	else if (data[3] == 3)
+	{
+		// 边录边导出, 停止 (子命令0) 后发完剩余记录和结尾
+		Trace_Start_Stream();
+		PC_xieyifasong_trace(3);
+	}
+}
+
+// 总线时隙统计: 68 B0 工位 和校验 16
+static void pc_bus_stats(const uint8_t *data, uint16_t len)
+{
+	(void)len;
+	if (pc_benzhan(data))
+	{
+		PC_xieyifasong_bus();
+	}
+}
+
+// 事件上报开关: 68 B4 工位 子命令(0关闭 1开启 2只查询) 和校验 16
+static void pc_push_ctrl(const uint8_t *data, uint16_t len)
+{
+	(void)len;
+	if (!pc_benzhan(data))
+	{
+		return;
+	}
+	if (data[3] < 2)
+	{
+		Push_Enable(data[3]);
+	}
+	PC_xieyifasong_push();
+}
+
+// CPU耗时剖析: 68 B6 工位 子命令(0停止 1开始 2导出) 和校验 16
+static void pc_prof(const uint8_t *data, uint16_t len)
+{
+	(void)len;
+	if (!pc_benzhan(data))
+	{
+		return;
+	}
+	if (data[3] == 0)
+	{
+		Prof_Stop();
+		PC_xieyifasong_prof(0);
+	}
+	else if (data[3] == 1)
+	{
+		Prof_Start();
+		PC_xieyifasong_prof(1);
+	}
+	else if (data[3] == 2)
+	{
+		Prof_Dump();
+	}
+}
+
+// 透传: 68 A2 工位 子命令 和校验 16, 子命令 0=查询统计 (透传中收到即退出) 1=进入透传
+static void pc_bridge(const uint8_t *data, uint16_t len)
+{
+	(void)len;
+	if (!pc_benzhan(data))
+	{
+		return;
+	}
+	if (data[3] == 1)
+	{
+		PC_touchuan_kaishi();
+	}
+	else
+	{
+		PC_xieyifasong_touchuan();
+	}
+}
+
+// 主循环空闲/休眠统计: 68 A4 工位 和校验 16
+static void pc_idle_stats(const uint8_t *data, uint16_t len)
+{
+	(void)len;
+	if (pc_benzhan(data))
+	{
+		PC_xieyifasong_idle();
+	}
+}
+
+// ADC批量测量耗时: 68 A6 工位 采样次数(1..255) 和校验 16
+static void pc_adc_bench(const uint8_t *data, uint16_t len)
+{
+	(void)len;
+	if (pc_benzhan(data) && data[3] > 0)
+	{
+		PC_xieyifasong_adc(data[3]);
+	}
+}
+
+// RAM使用/栈水位: 68 B8 工位 和校验 16
+static void pc_ram_stats(const uint8_t *data, uint16_t len)
+{
+	(void)len;
+	if (pc_benzhan(data))
+	{
+		PC_xieyifasong_ram();
+	}
+}
+
+// 0x68 帧分发表 (下标为命令表行号)
+static const PCCmdHandler pc_handlers_68[PC_CMD_SLOT_NUM] = {
+	[PC_CMD_SLOT_JIG_START] = pc_jig_start,
+	[PC_CMD_SLOT_JIG_RESULT] = pc_jig_result,
+	[PC_CMD_SLOT_TRACE] = pc_trace,
+	[PC_CMD_SLOT_BUS_STATS] = pc_bus_stats,
+	[PC_CMD_SLOT_PUSH_CTRL] = pc_push_ctrl,
+	[PC_CMD_SLOT_PROF] = pc_prof,
+	[PC_CMD_SLOT_BRIDGE] = pc_bridge,
+	[PC_CMD_SLOT_IDLE_STATS] = pc_idle_stats,
+	[PC_CMD_SLOT_ADC_BENCH] = pc_adc_bench,
+	[PC_CMD_SLOT_RAM_STATS] = pc_ram_stats,
+};
+
+// 解析一帧0x68命令, 返回帧长; 帧不完整、校验错或命令未登记时返回0
+// 0x68 帧没有长度字节, 帧长按命令表: 请求取请求帧长, 上位机的应答 (事件上报确认) 取应答帧长
+static uint16_t PC_jiexi_68(uint8_t zufuchua[], uint16_t lenth)
+{
+	const PCCmdInfo *xinxi;
+	uint8_t hejiaoyan = 0;
+	uint8_t zhenchang;
+	uint8_t i;
+
+	if (lenth < 2)
+	{
+		return 0;
+	}
+	xinxi = PC_Cmd_GetInfo(zufuchua[1]);
+	if (xinxi == NULL)
+	{
+		return 0;
+	}
+	zhenchang = (xinxi->code == zufuchua[1]) ? xinxi->req_len : xinxi->ack_len;
+	if (zhenchang < 5 || zhenchang > lenth || zufuchua[zhenchang - 1] != 0x16)
+	{
+		return 0;
+	}
+	for (i = 0; i < zhenchang - 2; i++)
+	{
+		hejiaoyan += zufuchua[i];
+	}
+	if (hejiaoyan != zufuchua[zhenchang - 2])
+	{
+		return 0;
+	}
+	// 事件上报确认: 68 B3 工位 序号 和校验 16, 不应答
+	if (zufuchua[1] == PC_CMD_PUSH_ACK)
+	{
+		if (pc_benzhan(zufuchua))
+		{
+			Push_Ack(zufuchua[3]);
+		}
+		return zhenchang;
+	}
+	if (PC_Cmd_Dispatch(pc_handlers_68, zufuchua[1], zufuchua, zhenchang) != PROTOCOL_RESULT_OK)
+	{
+		return 0;
+	}
+	return zhenchang;
+}
+
 void PC_xieyijiexi(uint8_t zufuchua[], uint16_t lenth)
 {
 	uint16_t pHead = 0;
-	uint8_t hejiaoyan = 0;
-	uint16_t zhenchangdu = 0;
+	uint16_t zhenchang;
 	uint16_t i;
 
 	DeBug_print("*** PC_xieyijiexi() called, len=%d ***\r\n", lenth);
@@ -73,57 +673,23 @@ void PC_xieyijiexi(uint8_t zufuchua[], uint16_t lenth)
 		{
 			break;
 		}
-		if (zufuchua[pHead] == 0x68)
+		if (zufuchua[pHead] == FT_FRAME_HEAD)
 		{
-			DeBug_print("Found 0x68 at pos %d\r\n", pHead);
-			if (zufuchua[pHead + 1] == 0xAA)
-			{
-				DeBug_print("CMD=0xAA\r\n");
-				DeBug_print("RX_Station=%d\r\n", zufuchua[pHead + 2]);
-				DeBug_print("Local_Station=%d\r\n", Test_jiejuo_jilu.gongwei);
-				if (zufuchua[pHead + 2] != Test_jiejuo_jilu.gongwei)
-				{
-					DeBug_print("!!! Station MISMATCH !!!\r\n");
-				}
-			}
-
-			if (zufuchua[pHead + 1] == 0xAA && zufuchua[pHead + 2] == Test_jiejuo_jilu.gongwei && zufuchua[pHead + 16] == 0x16)
+			zhenchang = PC_zhuanfa_55(&zufuchua[pHead], lenth - pHead);
+			if (zhenchang > 0)
 			{
-				// 进行和校?
-				hejiaoyan = 0;
-				for (zhenchangdu = 0; zhenchangdu < 15; zhenchangdu++)
-				{
-					hejiaoyan += zufuchua[pHead + zhenchangdu];
-				}
-				if (hejiaoyan == zufuchua[pHead + 15])
-				{
-					memcpy(Test_jiejuo_jilu.zhuji_MAC, &zufuchua[pHead + 3], 12);
-					DeBug_print("\r\n[PC] Received START command\r\n");
-					DeBug_print("MAC: %.12s\r\n", Test_jiejuo_jilu.zhuji_MAC);
-					FL_DelayMs(10);
-					test_start();
-					FL_DelayMs(10);
-					DeBug_print("[PC] Sending ACK...\r\n");
-					PC_xieyifasong_1();
-					pHead += 15;
-				}
+				pHead += zhenchang;
+				continue;
 			}
-			else if (zufuchua[pHead + 1] == 0xAC && zufuchua[pHead + 2] == Test_jiejuo_jilu.gongwei && zufuchua[pHead + 4] == 0x16)
+		}
+		if (zufuchua[pHead] == 0x68)
+		{
+			DeBug_print("Found 0x68 at pos %d\r\n", pHead);
+			zhenchang = PC_jiexi_68(&zufuchua[pHead], lenth - pHead);
+			if (zhenchang > 0)
 			{
-				// 进行和校?
-				hejiaoyan = 0;
-				for (zhenchangdu = 0; zhenchangdu < 3; zhenchangdu++)
-				{
-					hejiaoyan += zufuchua[pHead + zhenchangdu];
-				}
-				if (hejiaoyan == zufuchua[pHead + 3])
-				{
-					if (Test_quanju_canshu_L.test_over == 1)
-					{
-						PC_xieyifasong_2();
-					}
-					pHead += 3;
-				}
+				pHead += zhenchang;
+				continue;
 			}
 		}
 		pHead++;
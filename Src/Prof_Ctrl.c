@@ -0,0 +1,226 @@
+#include "Prof_Ctrl.h"
+#include "uart1.h"
+
+// CPU耗时剖析
+// 直方图按PC开放寻址 (最多探测 PROF_PC_PROBE 次), 每条8字节, 共1KB。
+// 采样中断只做查表加一, 约100个周期, 1kHz采样时占用CPU约0.3%。
+
+#if PROF_ENABLE
+
+#define PROF_PC_PROBE 8
+
+struct Prof_Zone prof_zone[PROF_ZONE_NUM];
+
+static uint32_t prof_pc[PROF_PC_NUM];
+static uint16_t prof_pc_count[PROF_PC_NUM];
+static volatile uint8_t prof_running = 0;
+static volatile uint32_t prof_samples = 0;
+static volatile uint32_t prof_handler = 0;
+static volatile uint32_t prof_dropped = 0;
+
+static void MF_BSTIM32_Init(void)
+{
+	FL_BSTIM32_InitTypeDef TimerBase_InitStruct;
+
+	TimerBase_InitStruct.clockSource = FL_CMU_BSTIM32_CLK_SOURCE_APBCLK;
+	TimerBase_InitStruct.prescaler = 0;
+	TimerBase_InitStruct.autoReload = 0xFFFFFFFF;
+	TimerBase_InitStruct.autoReloadState = FL_DISABLE;
+	FL_BSTIM32_Init(BSTIM32, &TimerBase_InitStruct);
+	FL_BSTIM32_Enable(BSTIM32);
+}
+
+static void MF_GPTIM0_Init(void)
+{
+	FL_GPTIM_InitTypeDef TimerBase_InitStruct;
+	FL_NVIC_ConfigTypeDef InterruptConfigStruct;
+
+	TimerBase_InitStruct.prescaler = 31;
+	TimerBase_InitStruct.counterMode = FL_GPTIM_COUNTER_DIR_UP;
+	TimerBase_InitStruct.autoReload = PROF_SAMPLE_US - 1;
+	TimerBase_InitStruct.autoReloadState = FL_DISABLE;
+	TimerBase_InitStruct.clockDivision = FL_GPTIM_CLK_DIVISION_DIV1;
+	FL_GPTIM_Init(GPTIM0, &TimerBase_InitStruct);
+	FL_GPTIM_ClearFlag_Update(GPTIM0);
+	FL_GPTIM_EnableIT_Update(GPTIM0);
+
+	// 最高优先级, 才能采到其他中断中的PC
+	InterruptConfigStruct.preemptPriority = 0x00;
+	FL_NVIC_Init(&InterruptConfigStruct, GPTIM01_IRQn);
+}
+
+static char prof_hex(uint8_t v)
+{
+	return (v < 10) ? ('0' + v) : ('A' + v - 10);
+}
+
+void Prof_Init(void)
+{
+	memset(prof_zone, 0, sizeof(prof_zone));
+	MF_BSTIM32_Init();
+	MF_GPTIM0_Init();
+}
+
+void Prof_Zone_Add(uint8_t id, uint32_t cycles)
+{
+	struct Prof_Zone *zone = &prof_zone[id];
+	zone->count++;
+	zone->total += cycles;
+	if (cycles > zone->max)
+	{
+		zone->max = cycles;
+	}
+}
+
+void Prof_Start(void)
+{
+	FL_GPTIM_Disable(GPTIM0);
+	memset(prof_pc, 0, sizeof(prof_pc));
+	memset(prof_pc_count, 0, sizeof(prof_pc_count));
+	memset(prof_zone, 0, sizeof(prof_zone));
+	prof_samples = 0;
+	prof_handler = 0;
+	prof_dropped = 0;
+	prof_running = 1;
+	FL_GPTIM_WriteCounter(GPTIM0, 0);
+	FL_GPTIM_Enable(GPTIM0);
+}
+
+void Prof_Stop(void)
+{
+	FL_GPTIM_Disable(GPTIM0);
+	prof_running = 0;
+}
+
+// 由GPTIM0_1_IRQHandler调用, frame指向异常栈帧 r0,r1,r2,r3,r12,lr,pc,xpsr
+void Prof_Sample(uint32_t *frame)
+{
+	uint32_t pc;
+	uint32_t idx;
+	uint8_t i;
+
+	FL_GPTIM_ClearFlag_Update(GPTIM0);
+	if (!prof_running)
+	{
+		return;
+	}
+	prof_samples++;
+	// 被打断现场的IPSR非0, 说明在其他中断中
+	if ((frame[7] & 0x3F) != 0)
+	{
+		prof_handler++;
+	}
+	pc = frame[6];
+	idx = (((pc >> 1) * 2654435761u) >> 16) & (PROF_PC_NUM - 1);
+	for (i = 0; i < PROF_PC_PROBE; i++)
+	{
+		if (prof_pc_count[idx] == 0)
+		{
+			prof_pc[idx] = pc;
+		}
+		if (prof_pc[idx] == pc)
+		{
+			if (prof_pc_count[idx] < 0xFFFF)
+			{
+				prof_pc_count[idx]++;
+			}
+			return;
+		}
+		idx = (idx + 1) & (PROF_PC_NUM - 1);
+	}
+	prof_dropped++;
+}
+
+// 按EXC_RETURN选择MSP/PSP, 将栈帧地址交给Prof_Sample (覆盖启动文件中的弱定义)
+__attribute__((naked)) void GPTIM0_1_IRQHandler(void)
+{
+	__asm volatile(
+		"movs r0, #4          \n"
+		"mov  r1, lr          \n"
+		"tst  r0, r1          \n"
+		"beq  1f              \n"
+		"mrs  r0, psp         \n"
+		"b    2f              \n"
+		"1:                   \n"
+		"mrs  r0, msp         \n"
+		"2:                   \n"
+		"ldr  r1, =Prof_Sample\n"
+		"bx   r1              \n");
+}
+
+void Prof_Dump(void)
+{
+	uint8_t line[48];
+	uint16_t sum = 0;
+	uint16_t i;
+	uint8_t j;
+	uint8_t len;
+	int res;
+
+	// 导出期间不采样, 避免导出本身占满直方图
+	Prof_Stop();
+	res = snprintf((char *)line, sizeof(line), "#PROF BEGIN %lu %lu %lu %u %lu\r\n",
+				   (unsigned long)prof_samples, (unsigned long)prof_handler, (unsigned long)prof_dropped,
+				   PROF_SAMPLE_US, (unsigned long)32000000);
+	PC_Chuankou_tongxin_send(line, res);
+	// 代码段: Z 编号 次数 最大周期 总周期(16位十六进制)
+	for (i = 0; i < PROF_ZONE_NUM; i++)
+	{
+		if (prof_zone[i].count == 0)
+		{
+			continue;
+		}
+		res = snprintf((char *)line, sizeof(line), "Z %u %lu %lu %08lX%08lX\r\n", i,
+					   (unsigned long)prof_zone[i].count, (unsigned long)prof_zone[i].max,
+					   (unsigned long)(prof_zone[i].total >> 32), (unsigned long)(prof_zone[i].total & 0xFFFFFFFF));
+		PC_Chuankou_tongxin_send(line, res);
+	}
+	// 采样: P PC(8位十六进制) 次数(4位十六进制)
+	for (i = 0; i < PROF_PC_NUM; i++)
+	{
+		if (prof_pc_count[i] == 0)
+		{
+			continue;
+		}
+		len = 0;
+		line[len++] = 'P';
+		line[len++] = ' ';
+		for (j = 0; j < 8; j++)
+		{
+			line[len++] = prof_hex((prof_pc[i] >> (28 - j * 4)) & 0x0F);
+		}
+		line[len++] = ' ';
+		for (j = 0; j < 4; j++)
+		{
+			line[len++] = prof_hex((prof_pc_count[i] >> (12 - j * 4)) & 0x0F);
+		}
+		line[len++] = '\r';
+		line[len++] = '\n';
+		sum += prof_pc_count[i];
+		PC_Chuankou_tongxin_send(line, len);
+	}
+	res = snprintf((char *)line, sizeof(line), "#PROF END %04X\r\n", sum);
+	PC_Chuankou_tongxin_send(line, res);
+}
+
+void Prof_Get_tongji(struct Prof_tongji *out)
+{
+	out->samples = prof_samples;
+	out->handler = prof_handler;
+	out->dropped = prof_dropped;
+	out->running = prof_running;
+}
+
+#else
+
+void Prof_Init(void) {}
+void Prof_Zone_Add(uint8_t id, uint32_t cycles) {}
+void Prof_Start(void) {}
+void Prof_Stop(void) {}
+void Prof_Dump(void) {}
+void Prof_Get_tongji(struct Prof_tongji *out)
+{
+	memset(out, 0, sizeof(*out));
+}
+
+#endif
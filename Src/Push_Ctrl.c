@@ -0,0 +1,218 @@
+#include "Push_Ctrl.h"
+#include "time.h"
+#include "uart1.h"
+#include "Bus_Ctrl.h"
+#include "Test_List.h"
+#include "jig_config.h"
+#include "pc_protocol.h"
+
+// 测试事件主动上报
+// MES不再需要周期轮询查询结果, 测试结束后收到 TEST_DONE 事件再查询一次即可。
+// 上报只占用命令之间的空闲时间: 有待解析的接收帧、正在发送、有时隙应答待发、
+// 处于广播应答窗口内或总线空闲不足门限时都不发送。
+
+struct Push_Shijian
+{
+	uint8_t xuhao;
+	uint8_t leixing;
+	uint8_t buzhou;
+	uint8_t jieguo;
+	uint32_t shuju;
+	uint32_t time_ms; // 产生时刻, 统计确认延时
+};
+
+static struct Push_Shijian push_dui[PUSH_QUEUE_NUM];
+static uint8_t push_dui_tou = 0;
+static uint8_t push_dui_shu = 0;
+static uint8_t push_xuhao = 0;
+static uint8_t push_kaiqi = 0;
+static uint8_t push_daiqueren = 0;  // 队首已发出, 等待确认
+static uint8_t push_cishu = 0;      // 队首已发送次数
+static uint32_t push_chongfa_ms = 0;
+static uint32_t push_last_tx_ms = 0;
+static uint32_t push_ack_ms = 0;
+static uint8_t push_lianfa = 0;     // 经空闲门限发送后连续确认的条数
+// 步骤结果去重 (不合格时每秒复测, 只报一次)
+static uint8_t push_last_buzhou = 0xFF;
+static uint8_t push_last_jieguo = 0xFF;
+static struct Push_tongji push_tongji;
+
+static void Push_Dui_Qingkong(void)
+{
+	push_dui_tou = 0;
+	push_dui_shu = 0;
+	push_daiqueren = 0;
+	push_cishu = 0;
+	push_lianfa = 0;
+	push_last_buzhou = 0xFF;
+	push_last_jieguo = 0xFF;
+}
+
+static void Push_Dui_Chu(void)
+{
+	push_dui_tou = (push_dui_tou + 1) % PUSH_QUEUE_NUM;
+	push_dui_shu--;
+	push_daiqueren = 0;
+	push_cishu = 0;
+}
+
+static void Push_Fasong(const struct Push_Shijian *shijian)
+{
+	uint8_t fanhui[13];
+	uint8_t i;
+
+	fanhui[0] = 0x68;
+	fanhui[1] = PC_CMD_PUSH;
+	fanhui[2] = Test_jiejuo_jilu.gongwei;
+	fanhui[3] = shijian->xuhao;
+	fanhui[4] = shijian->leixing;
+	fanhui[5] = shijian->buzhou;
+	fanhui[6] = shijian->jieguo;
+	fanhui[7] = (shijian->shuju >> 24) & 0xFF;
+	fanhui[8] = (shijian->shuju >> 16) & 0xFF;
+	fanhui[9] = (shijian->shuju >> 8) & 0xFF;
+	fanhui[10] = shijian->shuju & 0xFF;
+	fanhui[11] = 0;
+	for (i = 0; i < 11; i++)
+	{
+		fanhui[11] += fanhui[i];
+	}
+	fanhui[12] = 0x16;
+	PC_Chuankou_tongxin_send(fanhui, 13);
+}
+
+void Push_Init(void)
+{
+	memset(&push_tongji, 0, sizeof(push_tongji));
+	Push_Dui_Qingkong();
+	push_kaiqi = JigConfig_Get(JIG_CFG_PUSH_EN);
+}
+
+void Push_Enable(uint8_t kaiqi)
+{
+	push_kaiqi = kaiqi ? 1 : 0;
+	JigConfig_Set(JIG_CFG_PUSH_EN, push_kaiqi);
+	Push_Dui_Qingkong();
+}
+
+uint8_t Push_Is_Enabled(void)
+{
+	return push_kaiqi;
+}
+
+void Push_Event(uint8_t leixing, uint8_t buzhou, uint8_t jieguo, uint32_t shuju)
+{
+	struct Push_Shijian *shijian;
+
+	if (push_kaiqi == 0)
+	{
+		return;
+	}
+	if (leixing == PUSH_EVT_STEP_START)
+	{
+		push_last_buzhou = 0xFF;
+	}
+	else if (leixing == PUSH_EVT_STEP_RESULT)
+	{
+		if (buzhou == push_last_buzhou && jieguo == push_last_jieguo)
+		{
+			return;
+		}
+		push_last_buzhou = buzhou;
+		push_last_jieguo = jieguo;
+	}
+	push_tongji.shangbao++;
+	if (push_dui_shu >= PUSH_QUEUE_NUM)
+	{
+		push_tongji.yichu++;
+		return;
+	}
+	shijian = &push_dui[(push_dui_tou + push_dui_shu) % PUSH_QUEUE_NUM];
+	shijian->xuhao = push_xuhao++;
+	shijian->leixing = leixing;
+	shijian->buzhou = buzhou;
+	shijian->jieguo = jieguo;
+	shijian->shuju = shuju;
+	shijian->time_ms = time_ms_count;
+	push_dui_shu++;
+}
+
+void Push_Ack(uint8_t xuhao)
+{
+	uint32_t yanchi;
+
+	if (push_daiqueren == 0 || push_dui[push_dui_tou].xuhao != xuhao)
+	{
+		return;
+	}
+	yanchi = time_ms_count - push_dui[push_dui_tou].time_ms;
+	if (yanchi > push_tongji.yanchi_max_ms)
+	{
+		push_tongji.yanchi_max_ms = yanchi;
+	}
+	push_tongji.queren++;
+	Push_Dui_Chu();
+	push_ack_ms = time_ms_count;
+	if (push_lianfa < PUSH_BURST)
+	{
+		push_lianfa++;
+	}
+}
+
+void Push_Process(void)
+{
+	uint32_t now;
+	uint8_t xufa;
+
+	if (push_kaiqi == 0 || push_dui_shu == 0)
+	{
+		return;
+	}
+	now = time_ms_count;
+	if (push_daiqueren)
+	{
+		if ((int32_t)(now - push_chongfa_ms) < 0)
+		{
+			return;
+		}
+		if (push_cishu > PUSH_RETRY)
+		{
+			push_tongji.diuqi++;
+			Push_Dui_Chu();
+			return;
+		}
+	}
+	if (now - push_last_tx_ms < PUSH_GAP_MS)
+	{
+		return;
+	}
+	if (Uart1_Kongxian() == 0)
+	{
+		return;
+	}
+	// 确认之后总线上没有新数据时直接续发, 否则等待本工位的空闲门限
+	xufa = (push_daiqueren == 0 && push_lianfa > 0 && push_lianfa < PUSH_BURST && Bus_Kongxian(BUS_RX_IDLE_MS + (now - push_ack_ms)));
+	if (xufa == 0)
+	{
+		if (Bus_Kongxian(PUSH_IDLE_MS + (uint32_t)Test_jiejuo_jilu.gongwei * PUSH_STAGGER_MS) == 0)
+		{
+			return;
+		}
+		push_lianfa = 0;
+	}
+	Push_Fasong(&push_dui[push_dui_tou]);
+	if (push_cishu > 0)
+	{
+		push_tongji.chongfa++;
+	}
+	push_cishu++;
+	push_tongji.fasong++;
+	push_daiqueren = 1;
+	push_last_tx_ms = now;
+	push_chongfa_ms = now + PUSH_ACK_MS;
+}
+
+void Push_Get_tongji(struct Push_tongji *out)
+{
+	*out = push_tongji;
+}
@@ -0,0 +1,63 @@
+#include "Stack_Ctrl.h"
+#include "uart1.h"
+
+// 链接脚本 fm33lg04x_flash.ld 中的符号
+extern uint32_t _sdata;
+extern uint32_t _end;
+extern uint32_t _estack;
+extern uint32_t _stack_base;
+extern void *_sbrk(int incr);
+
+// 填充时留给当前函数栈帧的余量
+#define STACK_PAINT_MARGIN 64
+
+static uint32_t *stack_heap_top(void)
+{
+	uint32_t top = (uint32_t)_sbrk(0);
+	// 未分配过时 sbrk 返回 end
+	if (top < (uint32_t)&_end)
+	{
+		top = (uint32_t)&_end;
+	}
+	return (uint32_t *)((top + 3) & ~3u);
+}
+
+void Stack_Paint(void)
+{
+	uint32_t *p = stack_heap_top();
+	uint32_t *sp = (uint32_t *)(__get_MSP() - STACK_PAINT_MARGIN);
+
+	while (p < sp)
+	{
+		*p++ = STACK_PAINT;
+	}
+}
+
+void Stack_Get_tongji(struct Stack_tongji *out)
+{
+	uint32_t *heap_top = stack_heap_top();
+	uint32_t *p = heap_top;
+	uint32_t *sp = (uint32_t *)__get_MSP();
+	uint32_t estack = (uint32_t)&_estack;
+
+	while (p < sp && *p == STACK_PAINT)
+	{
+		p++;
+	}
+	out->ram_size = estack - (uint32_t)&_sdata;
+	out->static_size = (uint32_t)&_end - (uint32_t)&_sdata;
+	out->heap_used = (uint32_t)heap_top - (uint32_t)&_end;
+	out->stack_rsv = estack - (uint32_t)&_stack_base;
+	out->stack_peak = estack - (uint32_t)p;
+	out->stack_now = estack - (uint32_t)sp;
+	out->free_min = (uint32_t)p - (uint32_t)heap_top;
+}
+
+void Stack_Report(void)
+{
+	struct Stack_tongji tongji;
+	Stack_Get_tongji(&tongji);
+	DeBug_print("[RAM] static=%lu heap=%lu stack peak=%lu/%lu now=%lu free_min=%lu\r\n",
+				tongji.static_size, tongji.heap_used, tongji.stack_peak, tongji.stack_rsv,
+				tongji.stack_now, tongji.free_min);
+}
@@ -4,11 +4,21 @@
 #include "ADC_CHK.h"
 #include "uart1.h"
 #include "tongxin_xieyi_Ctrl.h"
+#include "jig_config.h"
+#include "step_profiler.h"
+#include "step_executor.h"
+#include "test_plan.h"
+#include "Push_Ctrl.h"
 
 struct Test_quanju_canshu Test_quanju_canshu_L;
 enum Test_liucheng Test_liucheng_L = w_wait;
 struct Test_jieguo Test_jiejuo_jilu;
 enum test_xieyi_jilu test_xieyi_jilu_Rec = No_Receive;
+// һϱĲ, 仯ʱϱ迪ʼ
+static enum Test_liucheng push_buzhou = w_wait;
+// βвʧ (Դ賬ʱ)
+static uint8_t buzhou_shibai = 0;
+static void test_buzhou_qidong(void);
 
 void test_quanju_canshu_Init()
 {
@@ -59,6 +69,11 @@ void gongwei_jiance()
 	{
 		Test_jiejuo_jilu.gongwei = 0x00;
 	}
+	// ָ˹λʱǲ
+	if (JigConfig_Get(JIG_CFG_STATION_ID) != JIG_CONFIG_STATION_AUTO)
+	{
+		Test_jiejuo_jilu.gongwei = JigConfig_Get(JIG_CFG_STATION_ID);
+	}
 	DeBug_print("Current station: %d\r\n", Test_jiejuo_jilu.gongwei);
 }
 // Խʼ
@@ -85,10 +100,10 @@ void test_start()
 	// Խ
 	test_jieguo_qingling();
 	Test_liucheng_L = w_start;
-	// ʱ90
-	Test_quanju_canshu_L.time_aroundtest_ms = 90000;
 	Test_quanju_canshu_L.test_over = 0;
 	Test_quanju_canshu_L.time_softdelay_ms = 0;
+	// Լƻɲ, ʱ (üƻΪ90, )
+	test_buzhou_qidong();
 	DeBug_print("*** Test State: w_start ***\r\n");
 	DeBug_print("*** MAC: %.12s ***\r\n\r\n", Test_jiejuo_jilu.zhuji_MAC);
 }
@@ -96,6 +111,7 @@ void test_start()
 // ֹԵǣʱذ뿪˹װ
 void test_testend()
 {
+	StepExec_Abort();
 	Test_liucheng_L = w_end;
 	Test_quanju_canshu_L.test_over = 1;
 	Test_quanju_canshu_L.time_softdelay_ms = 0;
@@ -107,129 +123,349 @@ void test_err_end_Func()
 	if (Test_quanju_canshu_L.time_aroundtest_ms == 0 && Test_quanju_canshu_L.test_over == 0)
 	{
 		// 
+		Push_Event(PUSH_EVT_FAULT, Test_liucheng_L, PUSH_FAULT_TIMEOUT, 0);
 		test_testend();
 	}
 }
 
-void test_Loop_Func()
+/*============================ Բ ============================*/
+// ÿһ״̬,  step_executor Դǰò,
+// ͻĲ貢н (ȴӦʱADCѹ)
+// ˳򡢺ϸΧͳʱԲԼƻ (test_plan),
+// ûؼƻʱʹüƻ (test_jihua_neizhi, ֵȡ jig_config)
+
+// βԵļƻ
+static const TestPlan *test_jihua;
+
+// ǰڼƻеĲ
+static const TestPlanStep *buzhou_canshu(void)
 {
-	test_err_end_Func();
-	// Test_liucheng_L = w_gonghao_CHK;
-	if (Test_quanju_canshu_L.time_softdelay_ms > 0)
-		return;
-	switch (Test_liucheng_L)
+	return &test_jihua->steps[StepExec_Current()];
+}
+// ֵǷڼƻĺϸΧ (lo < ֵ < hi)
+static uint8_t zai_fanwei(int32_t zhi, const TestPlanStep *canshu)
+{
+	return zhi > canshu->lo && zhi < canshu->hi;
+}
+// ж: ϸ; ϸʱ, ƻ޶˴ʱʧ
+static StepExecResult_t celiang_panding(enum Test_liucheng buzhou, uint8_t hege, uint32_t zhi)
+{
+	const TestPlanStep *canshu = buzhou_canshu();
+
+	Push_Event(PUSH_EVT_STEP_RESULT, buzhou, hege ? 0 : 1, zhi);
+	if (hege)
+		return STEP_EXEC_DONE;
+	if (canshu->tries != 0 && StepExec_Count() >= canshu->tries)
+		return STEP_EXEC_FAIL;
+	return STEP_EXEC_BUSY;
+}
+// ط: طʱ1; ƻ޶˷ʹʱ, һηͺ
+// ٵһ޺ϸӦʧ
+static uint8_t mingling_chongfa(enum Test_liucheng buzhou, StepExecResult_t *jieguo)
+{
+	const TestPlanStep *canshu = buzhou_canshu();
+
+	*jieguo = STEP_EXEC_BUSY;
+	if (!StepExec_Every(canshu->interval_ms))
+		return 0;
+	if (canshu->tries != 0 && StepExec_Count() > canshu->tries)
 	{
-	case w_wait:
-		// ȴһβ
-		break;
-	case w_start:
-		// ʼǰУVDDǷе磬ӶжϲǷʼ
-		Test_jiejuo_jilu.VCC_dianya = get_VCC_weizhi_dianya();
-		DeBug_print("[Test] State: w_start, VCC Voltage: %d mV\r\n", Test_jiejuo_jilu.VCC_dianya);
-		// Ժϸж
-		if (Test_jiejuo_jilu.VCC_dianya > 3000 && Test_jiejuo_jilu.VCC_dianya < 3600)
-		{
-			// Ժϸ񣬽һ
-			Test_quanju_canshu_L.time_softdelay_ms = 0;
-			Test_liucheng_L = w_zhudian_CHK;
-		}
-		else
-		{
-			// 1븴һ
-			Test_quanju_canshu_L.time_softdelay_ms = 1000;
-		}
-		break;
-	case w_zhudian_CHK:
-		Test_jiejuo_jilu.zhidian_gongdiandianya = get_zhudian_gongdian_weizhi_dianya();
-		DeBug_print("Supply voltage: %d mV\r\n", Test_jiejuo_jilu.zhidian_gongdiandianya);
-		if (Test_jiejuo_jilu.zhidian_gongdiandianya > 5500 && Test_jiejuo_jilu.zhidian_gongdiandianya < 6500)
-		{
-			// Ժϸ񣬽һ
-			Test_quanju_canshu_L.time_softdelay_ms = 0;
-			Test_liucheng_L = w_VDD_CHK;
-		}
-		else
-		{
-			// 1븴һ
-			Test_quanju_canshu_L.time_softdelay_ms = 1000;
-		}
-		break;
-	case w_VDD_CHK:
-		Test_jiejuo_jilu.VDD_dianya = get_erjidianyuan_weizhi_dianya();
-		DeBug_print("VDD voltage: %d mV\r\n", Test_jiejuo_jilu.VDD_dianya);
-		if (Test_jiejuo_jilu.VDD_dianya > 3200 && Test_jiejuo_jilu.zhidian_gongdiandianya > 4200)
-		{
-			// Ժϸ񣬽һ
-			Test_quanju_canshu_L.time_softdelay_ms = 0;
-			// ʱΪUSB
-			Test_jiejuo_jilu.USBgongdian = 1;
-			Test_liucheng_L = w_SWITCH_gongdian;
-		}
-		else
-		{
-			// 1븴һ
-			Test_quanju_canshu_L.time_softdelay_ms = 1000;
-		}
-		break;
-	case w_SWITCH_gongdian: // ӿ
-		DeBug_print("Swtiching power supply interface...\r\n");
-		// Դ
-		zhudian_gongdian_On();
-		// Դ
-		beidian_gongdian_On();
-		// ˳ߴͨſƽ
-		Uart_shineng_ON();
-		Test_quanju_canshu_L.time_softdelay_ms = 0;
-		// һ֮ǰҪýflag
+		Push_Event(PUSH_EVT_STEP_RESULT, buzhou, 1, 0);
+		*jieguo = STEP_EXEC_FAIL;
+		return 0;
+	}
+	test_xieyi_jilu_Rec = No_Receive;
+	return 1;
+}
+
+// ѹÿβһ·: ӿڶβȡƽ (ͬһһVREFУ׼),
+// У׼, ͬ get_xxx_dianya(); ʱ0, ϸ񸴲
+#define CELIANG_CAIYANG 4
+static uint32_t celiang_dianya(uint8_t tongdao)
+{
+	ADC_RailSet_t jieguo;
+
+	if (ADC_MeasureRailSet(&ADC_Rails_Main[tongdao], 1, CELIANG_CAIYANG, &jieguo) != 0 || !jieguo.rail[0].valid)
+		return 0;
+	return jieguo.rail[0].avg_mv;
+}
+// ʼǰУVDDǷе磬ӶжϲǷʼ
+static StepExecResult_t step_VCC_CHK(void)
+{
+	const TestPlanStep *canshu = buzhou_canshu();
+
+	// ϸʱ (üƻ1)
+	if (!StepExec_Every(canshu->interval_ms))
+		return STEP_EXEC_BUSY;
+	Test_jiejuo_jilu.VCC_dianya = celiang_dianya(ADC_RAIL_VCC);
+	DeBug_print("[Test] State: w_start, VCC Voltage: %d mV\r\n", Test_jiejuo_jilu.VCC_dianya);
+	return celiang_panding(w_start, zai_fanwei(Test_jiejuo_jilu.VCC_dianya, canshu), Test_jiejuo_jilu.VCC_dianya);
+}
+// 繩ѹ
+static StepExecResult_t step_zhudian_CHK(void)
+{
+	const TestPlanStep *canshu = buzhou_canshu();
+
+	if (!StepExec_Every(canshu->interval_ms))
+		return STEP_EXEC_BUSY;
+	Test_jiejuo_jilu.zhidian_gongdiandianya = celiang_dianya(ADC_RAIL_GONGDIAN);
+	DeBug_print("Supply voltage: %d mV\r\n", Test_jiejuo_jilu.zhidian_gongdiandianya);
+	return celiang_panding(w_zhudian_CHK, zai_fanwei(Test_jiejuo_jilu.zhidian_gongdiandianya, canshu), Test_jiejuo_jilu.zhidian_gongdiandianya);
+}
+// VDDѹ (жõ繩ѹ, ֮)
+// ƻֵ aux Ϊ繩ѹ
+static StepExecResult_t step_VDD_CHK(void)
+{
+	const TestPlanStep *canshu = buzhou_canshu();
+	uint8_t hege;
+
+	if (!StepExec_Every(canshu->interval_ms))
+		return STEP_EXEC_BUSY;
+	Test_jiejuo_jilu.VDD_dianya = celiang_dianya(ADC_RAIL_ERJI);
+	DeBug_print("VDD voltage: %d mV\r\n", Test_jiejuo_jilu.VDD_dianya);
+	hege = zai_fanwei(Test_jiejuo_jilu.VDD_dianya, canshu) && (int32_t)Test_jiejuo_jilu.zhidian_gongdiandianya > canshu->aux;
+	// ʱΪUSB
+	if (hege)
+		Test_jiejuo_jilu.USBgongdian = 1;
+	return celiang_panding(w_VDD_CHK, hege, Test_jiejuo_jilu.VDD_dianya);
+}
+// ӿ
+static StepExecResult_t step_SWITCH_gongdian(void)
+{
+	DeBug_print("Swtiching power supply interface...\r\n");
+	// Դ
+	zhudian_gongdian_On();
+	// Դ
+	beidian_gongdian_On();
+	// ˳ߴͨſƽ
+	Uart_shineng_ON();
+	// һ֮ǰҪýflag
+	test_xieyi_jilu_Rec = No_Receive;
+	return STEP_EXEC_DONE;
+}
+// ñţ
+static StepExecResult_t step_set_biaohao(void)
+{
+	StepExecResult_t jieguo;
+
+	if (test_xieyi_jilu_Rec == connect_xingshan)
+	{
+		// ӣһȴ5G
+		Push_Event(PUSH_EVT_STEP_RESULT, w_set_biaohao, 0, 0);
+		// ͨųɹ˵USBԼ繩,flash(ûflash)
+		Test_jiejuo_jilu.USBgongdian = 1;
+		Test_jiejuo_jilu.flash_test = 1;
 		test_xieyi_jilu_Rec = No_Receive;
-		Test_liucheng_L = w_set_biaohao;
-		break;
-	case w_set_biaohao:
+		// flag
+		get_imei_ICCID_flag = 0;
+		return STEP_EXEC_DONE;
+	}
+	// ӦʱԶط (üƻ3)
+	if (mingling_chongfa(w_set_biaohao, &jieguo))
+	{
 		DeBug_print("Setting serial number...\r\n");
-		if (test_xieyi_jilu_Rec != connect_xingshan)
-		{
-			test_xieyi_jilu_Rec = No_Receive;
-			TONGXIN_xieyifasong_NTST();
-			// ȴ3Զط
-			Test_quanju_canshu_L.time_softdelay_ms = 3000;
-		}
-		else
+		TONGXIN_xieyifasong_NTST();
+	}
+	return jieguo;
+}
+// ѯϸϢ, ƻĺϸΧźǿ CSQ
+static StepExecResult_t step_fand_shanggao(void)
+{
+	StepExecResult_t jieguo;
+
+	if (test_xieyi_jilu_Rec == shanggao_zhengchang)
+	{
+		test_xieyi_jilu_Rec = No_Receive;
+		// 5GźŻȡ
+		if (zai_fanwei(Test_jiejuo_jilu.CSQ, buzhou_canshu()))
 		{
-			// ӣһȴ5G
-			// ͨųɹ˵USBԼ繩,flash(ûflash)
-			Test_jiejuo_jilu.USBgongdian = 1;
-			Test_jiejuo_jilu.flash_test = 1;
-			test_xieyi_jilu_Rec = No_Receive;
-			// flag
-			get_imei_ICCID_flag = 0;
-			Test_liucheng_L = w_fand_shanggao;
+			Push_Event(PUSH_EVT_STEP_RESULT, w_fand_shanggao, 0, Test_jiejuo_jilu.CSQ);
+			return STEP_EXEC_DONE;
 		}
-		break;
-	case w_fand_shanggao:
+		// ź, ´طʱٲѯ
+		Push_Event(PUSH_EVT_STEP_RESULT, w_fand_shanggao, 1, Test_jiejuo_jilu.CSQ);
+	}
+	// ӦʱԶط (üƻ3)
+	if (mingling_chongfa(w_fand_shanggao, &jieguo))
+	{
 		DeBug_print("Checking 5G network connection...\r\n");
-		if (test_xieyi_jilu_Rec != shanggao_zhengchang)
+		TONGXIN_xieyifasong_ICDC();
+	}
+	return jieguo;
+}
+// Ĳ, üƻϸΧ (ֻ¼)
+static StepExecResult_t step_gonghao_CHK(void)
+{
+	const TestPlanStep *canshu = buzhou_canshu();
+
+	if (!StepExec_Every(canshu->interval_ms))
+		return STEP_EXEC_BUSY;
+	DeBug_print("Checking low power working current...\r\n");
+	// Դ
+	zhudian_gongdian_On();
+	// Դ
+	beidian_gongdian_On();
+	Test_jiejuo_jilu.zhudian_gonghao = Current_CHK_Func();
+	return celiang_panding(w_gonghao_CHK, zai_fanwei(Test_jiejuo_jilu.zhudian_gonghao, canshu), Test_jiejuo_jilu.zhudian_gonghao);
+}
+
+// ̼еĲʵ: , ռõԴ, ѯ, Ƿʹüƻĸ/ط
+// ADC⿪ػı䱻ĸ, ĲͬʱռADC, ѹص
+struct buzhou_shixian
+{
+	uint8_t id;
+	uint8_t resources;
+	StepExecResult_t (*poll)(void);
+	uint8_t jiange;
+};
+static const struct buzhou_shixian buzhou_shixian_biao[] = {
+	{w_start, TEST_RES_ADC, step_VCC_CHK, 1},
+	{w_zhudian_CHK, TEST_RES_ADC, step_zhudian_CHK, 1},
+	{w_VDD_CHK, TEST_RES_ADC, step_VDD_CHK, 1},
+	{w_SWITCH_gongdian, TEST_RES_SUPPLY | TEST_RES_UART0, step_SWITCH_gongdian, 0},
+	{w_set_biaohao, TEST_RES_UART0, step_set_biaohao, 1},
+	{w_fand_shanggao, TEST_RES_UART0, step_fand_shanggao, 1},
+	{w_gonghao_CHK, TEST_RES_SUPPLY | TEST_RES_INA219 | TEST_RES_ADC, step_gonghao_CHK, 1},
+};
+#define BUZHOU_SHIXIAN_NUM (sizeof(buzhou_shixian_biao) / sizeof(buzhou_shixian_biao[0]))
+
+static const struct buzhou_shixian *chazhao_shixian(uint8_t id)
+{
+	uint8_t i;
+	for (i = 0; i < BUZHOU_SHIXIAN_NUM; i++)
+	{
+		if (buzhou_shixian_biao[i].id == id)
+			return &buzhou_shixian_biao[i];
+	}
+	return NULL;
+}
+
+// صļƻÿļ: ʵ, /طС10ms
+static bool test_jihua_jiancha(const TestPlanStep *canshu)
+{
+	const struct buzhou_shixian *shixian = chazhao_shixian(canshu->id);
+
+	if (shixian == NULL)
+		return false;
+	return !shixian->jiange || canshu->interval_ms >= 10;
+}
+
+static void neizhi_buzhou(TestPlanStep *canshu, uint8_t id, uint16_t after, uint16_t jiange, int32_t lo, int32_t hi, int32_t aux)
+{
+	canshu->id = id;
+	canshu->tries = 0;
+	canshu->after = after;
+	canshu->interval_ms = jiange;
+	canshu->timeout_ms = 0;
+	canshu->lo = lo;
+	canshu->hi = hi;
+	canshu->aux = aux;
+}
+
+#define STEP_BIT(i) (1U << (i))
+// üƻ: ԭ, ֵȡ jig_config, ޴, ֻ峬ʱ
+static void test_jihua_neizhi(TestPlan *jihua)
+{
+	jihua->version = 0;
+	jihua->product = 0;
+	jihua->crc = 0;
+	jihua->timeout_ms = JigConfig_Get(JIG_CFG_TEST_TIMEOUT_MS);
+	jihua->count = 7;
+	neizhi_buzhou(&jihua->steps[0], w_start, 0, 1000, JigConfig_Get(JIG_CFG_VCC_MIN_MV), JigConfig_Get(JIG_CFG_VCC_MAX_MV), 0);
+	neizhi_buzhou(&jihua->steps[1], w_zhudian_CHK, STEP_BIT(0), 1000, JigConfig_Get(JIG_CFG_MAIN_MIN_MV), JigConfig_Get(JIG_CFG_MAIN_MAX_MV), 0);
+	neizhi_buzhou(&jihua->steps[2], w_VDD_CHK, STEP_BIT(1), 1000, JigConfig_Get(JIG_CFG_VDD_MIN_MV), INT32_MAX, JigConfig_Get(JIG_CFG_VDD_MAIN_MIN_MV));
+	neizhi_buzhou(&jihua->steps[3], w_SWITCH_gongdian, STEP_BIT(0), 0, INT32_MIN, INT32_MAX, 0);
+	neizhi_buzhou(&jihua->steps[4], w_set_biaohao, STEP_BIT(3), 3000, INT32_MIN, INT32_MAX, 0);
+	neizhi_buzhou(&jihua->steps[5], w_fand_shanggao, STEP_BIT(4), 3000, INT32_MIN, INT32_MAX, 0);
+	neizhi_buzhou(&jihua->steps[6], w_gonghao_CHK, STEP_BIT(5), 1000, INT32_MIN, INT32_MAX, 0);
+}
+
+void test_jihua_Init(void)
+{
+	TestPlan_Init(test_jihua_jiancha, test_jihua_neizhi);
+}
+
+// ɼƻɵĲ
+static StepExecStep_t test_buzhou_biao[TEST_PLAN_MAX_STEPS];
+
+// 迪ʼʱϱ, ʱ벽ʱͳ (ʱʱοص)
+static void test_buzhou_shijian(uint8_t index, const StepExecStep_t *step, const StepExecRecord_t *rec)
+{
+	if (rec->state == STEP_EXEC_RUNNING)
+		Push_Event(PUSH_EVT_STEP_START, step->id, 0, 0);
+	else
+		StepProf_Record(step->id, rec->start_us, rec->end_us);
+}
+
+// ʼִв,  JIG_CFG_STEP_OVERLAP=0 ʱƻ˳ִ
+static void test_buzhou_qidong(void)
+{
+	uint8_t i;
+
+	// صļƻЧ, еĲԲӰ
+	test_jihua = TestPlan_Begin();
+	for (i = 0; i < test_jihua->count; i++)
+	{
+		const TestPlanStep *canshu = &test_jihua->steps[i];
+		const struct buzhou_shixian *shixian = chazhao_shixian(canshu->id);
+
+		test_buzhou_biao[i].id = canshu->id;
+		test_buzhou_biao[i].resources = shixian->resources;
+		test_buzhou_biao[i].after = canshu->after;
+		test_buzhou_biao[i].start = NULL;
+		test_buzhou_biao[i].poll = shixian->poll;
+		test_buzhou_biao[i].timeout_ms = canshu->timeout_ms;
+	}
+	Test_quanju_canshu_L.time_aroundtest_ms = test_jihua->timeout_ms;
+	buzhou_shibai = 0;
+	StepExec_SetSerial(JigConfig_Get(JIG_CFG_STEP_OVERLAP) == 0);
+	StepExec_SetEventFunc(test_buzhou_shijian);
+	StepExec_Start(test_buzhou_biao, test_jihua->count);
+}
+
+void test_Loop_Func()
+{
+	test_err_end_Func();
+	// Բִ, ǰΪеһδɵĲ
+	if (StepExec_IsRunning())
+	{
+		if (StepExec_Process())
 		{
-			test_xieyi_jilu_Rec = No_Receive;
-			TONGXIN_xieyifasong_ICDC();
-			// ȴ3Զط
-			Test_quanju_canshu_L.time_softdelay_ms = 3000;
+			Test_liucheng_L = test_buzhou_biao[StepExec_FirstPending()].id;
+			return;
 		}
-		else
+		if (Debug_Mode)
+			StepExec_Print();
+		// ʧ (ƻԴ賬ʱ), ǰ
+		if (!StepExec_IsPassed())
 		{
-			// 5GźŻȡ
-			test_xieyi_jilu_Rec = No_Receive;
-			Test_liucheng_L = w_gonghao_CHK;
+			uint8_t i;
+			for (i = 0; i < test_jihua->count; i++)
+			{
+				if (StepExec_GetRecord(i)->state == STEP_EXEC_FAILED)
+					Push_Event(PUSH_EVT_FAULT, test_buzhou_biao[i].id, PUSH_FAULT_STEP, 0);
+			}
+			buzhou_shibai = 1;
 		}
-		break;
-	case w_gonghao_CHK:
-		DeBug_print("Checking low power working current...\r\n");
-		// Դ
-		zhudian_gongdian_On();
-		// Դ
-		beidian_gongdian_On();
-		Test_jiejuo_jilu.zhudian_gonghao = Current_CHK_Func();
-		// DeBug_print("Test current: %d uA\r\n", Test_jiejuo_jilu.zhudian_gonghao);
 		Test_liucheng_L = w_end;
+	}
+	// ʱͳ: Խصȴʱβ
+	if (Test_liucheng_L == w_wait)
+		StepProf_RunEnd();
+	else
+		StepProf_Enter(Test_liucheng_L);
+	if (Test_liucheng_L != push_buzhou)
+	{
+		push_buzhou = Test_liucheng_L;
+		if (Test_liucheng_L != w_wait)
+			Push_Event(PUSH_EVT_STEP_START, Test_liucheng_L, 0, 0);
+	}
+	if (Test_quanju_canshu_L.time_softdelay_ms > 0)
+		return;
+	switch (Test_liucheng_L)
+	{
+	case w_wait:
+		// ȴһβ
 		break;
 	case w_end:
 		// Դ
@@ -239,6 +475,8 @@ void test_Loop_Func()
 		beidian_gongdian_On();
 		// һвԶѽ򿪲Է
 		Test_quanju_canshu_L.test_over = 1;
+		// ʱֹʱʣʱΪ0, MESյٲѯ
+		Push_Event(PUSH_EVT_TEST_DONE, w_end, Test_quanju_canshu_L.time_aroundtest_ms == 0 ? 1 : buzhou_shibai ? 2 : 0, TestPlan_Active()->timeout_ms - Test_quanju_canshu_L.time_aroundtest_ms);
 		// صһ
 		Test_liucheng_L = w_wait;
 		break;
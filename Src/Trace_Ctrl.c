@@ -0,0 +1,228 @@
+#include "Trace_Ctrl.h"
+#include "time.h"
+#include "uart1.h"
+#include "Bus_Ctrl.h"
+
+// 串口通讯录制
+// 各串口中断中逐字节记录, 时间戳取time_get_us(), 只保存与上一条的间隔以压缩空间。
+// 导出格式 (文本行, 可直接从串口助手日志中提取):
+//   #TRACE BEGIN <条数> <丢弃数>
+//   T <每条8个十六进制字符, 每行最多8条>
+//   #TRACE END <按字节累加和, 16位>
+// 流式方式 (边录边导出, 与其他UART1输出交错):
+//   #TRACE BEGIN STREAM
+//   T ...
+//   #TRACE STREAM END <条数> <丢弃数> <按字节累加和, 16位>
+// 流式导出的行本身不录制: 只在UART1和总线空闲时发出 (不打断命令接收和时隙应答),
+// 发出前登记字节数, 中断按数跳过。9600波特率下每条约8.5字节, 约110条/秒;
+// 突发由缓冲吸收, 长时间超过时丢弃并计数 (调试输出 Debug_Mode 也会录制, 宜关闭)。
+
+#define TRACE_LINE_ENTRIES 8
+#define TRACE_MASK (TRACE_BUF_NUM - 1)
+
+static struct Trace_Entry trace_buf[TRACE_BUF_NUM];
+static volatile uint16_t trace_head = 0;     // 写位置 (自由计数, 取低位为下标)
+static volatile uint16_t trace_tail = 0;     // 流式导出读位置
+static volatile uint32_t trace_count = 0;
+static volatile uint32_t trace_dropped = 0;
+static volatile uint8_t trace_running = 0;
+static volatile uint8_t trace_stream = 0;    // 0=缓存 1=流式待发头 2=流式导出中
+static volatile uint16_t trace_skip_tx = 0;  // UART1接下来要跳过的发送字节数
+static uint16_t trace_sum = 0;
+static uint32_t trace_last_us = 0;
+
+void Trace_Init(void)
+{
+	trace_running = 0;
+	trace_stream = 0;
+	trace_head = 0;
+	trace_tail = 0;
+	trace_count = 0;
+	trace_dropped = 0;
+}
+
+void Trace_Start(void)
+{
+	Trace_Init();
+	trace_last_us = time_get_us();
+	trace_running = 1;
+}
+
+void Trace_Start_Stream(void)
+{
+	Trace_Init();
+	trace_sum = 0;
+	trace_stream = 1;
+	trace_last_us = time_get_us();
+	trace_running = 1;
+}
+
+void Trace_Stop(void)
+{
+	trace_running = 0;
+}
+
+// 不同优先级的串口中断和主循环都会调用, 短暂关中断保证写位置连续
+void Trace_Byte(uint8_t port, uint8_t dir, uint8_t data)
+{
+	uint32_t primask;
+	uint32_t now;
+	uint32_t dt;
+	uint16_t need;
+
+	struct Trace_Entry *e;
+
+	if (trace_running == 0)
+	{
+		return;
+	}
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (port == TRACE_PORT_UART1 && dir == TRACE_DIR_TX && trace_skip_tx > 0)
+	{
+		trace_skip_tx--;
+		__set_PRIMASK(primask);
+		return;
+	}
+	now = time_get_us();
+	dt = now - trace_last_us;
+	need = (dt > 0xFFFF) ? 2 : 1;
+	if ((uint16_t)(trace_head - trace_tail) + need > TRACE_BUF_NUM)
+	{
+		trace_dropped++;
+		__set_PRIMASK(primask);
+		return;
+	}
+	if (need == 2)
+	{
+		e = &trace_buf[trace_head & TRACE_MASK];
+		e->tag = TRACE_PORT_EXT << 6;
+		e->data = 0;
+		e->dt_us = dt >> 16;
+		trace_head++;
+	}
+	e = &trace_buf[trace_head & TRACE_MASK];
+	e->tag = (port << 6) | (dir << 5);
+	e->data = data;
+	e->dt_us = dt & 0xFFFF;
+	trace_head++;
+	trace_count += need;
+	trace_last_us = now;
+	__set_PRIMASK(primask);
+}
+
+void Trace_Get_tongji(struct Trace_tongji *out)
+{
+	out->count = trace_count;
+	out->dropped = trace_dropped;
+	out->running = trace_running;
+	out->stream = (trace_stream != 0);
+}
+
+static char trace_hex(uint8_t v)
+{
+	return (v < 10) ? ('0' + v) : ('A' + v - 10);
+}
+
+// 从 *pos 起取最多一行记录写入 line, 返回行长度
+static uint16_t trace_line(uint8_t line[], uint16_t *pos, uint16_t end, uint16_t *sum)
+{
+	uint8_t raw[4];
+	uint16_t len = 0;
+	uint8_t j;
+	const struct Trace_Entry *e;
+
+	line[len++] = 'T';
+	line[len++] = ' ';
+	for (j = 0; j < TRACE_LINE_ENTRIES && *pos != end; j++, (*pos)++)
+	{
+		e = &trace_buf[*pos & TRACE_MASK];
+		raw[0] = e->tag;
+		raw[1] = e->data;
+		raw[2] = e->dt_us & 0xFF;
+		raw[3] = e->dt_us >> 8;
+		*sum += raw[0] + raw[1] + raw[2] + raw[3];
+		line[len++] = trace_hex(raw[0] >> 4);
+		line[len++] = trace_hex(raw[0] & 0x0F);
+		line[len++] = trace_hex(raw[1] >> 4);
+		line[len++] = trace_hex(raw[1] & 0x0F);
+		line[len++] = trace_hex(raw[2] >> 4);
+		line[len++] = trace_hex(raw[2] & 0x0F);
+		line[len++] = trace_hex(raw[3] >> 4);
+		line[len++] = trace_hex(raw[3] & 0x0F);
+	}
+	line[len++] = '\r';
+	line[len++] = '\n';
+	return len;
+}
+
+// 发出不录制的一行 (调用前UART1须空闲, 接下来的发送字节即本行)
+static void trace_stream_send(uint8_t line[], uint16_t len)
+{
+	trace_skip_tx = len;
+	PC_Chuankou_tongxin_send(line, len);
+}
+
+void Trace_Process(void)
+{
+	uint8_t line[8 * TRACE_LINE_ENTRIES + 8];
+	uint16_t head = trace_head;
+	uint16_t pos;
+	int res;
+
+	if (trace_stream == 0 || Uart1_Kongxian() == 0 || Bus_Kongxian(BUS_RX_IDLE_MS) == 0)
+	{
+		return;
+	}
+	if (trace_stream == 1)
+	{
+		res = snprintf((char *)line, sizeof(line), "#TRACE BEGIN STREAM\r\n");
+		trace_stream_send(line, res);
+		trace_stream = 2;
+		return;
+	}
+	// 录制中凑满一行再发, 停止后发完剩余记录和结尾
+	if (head != trace_tail && (trace_running == 0 || (uint16_t)(head - trace_tail) >= TRACE_LINE_ENTRIES))
+	{
+		pos = trace_tail;
+		res = trace_line(line, &pos, head, &trace_sum);
+		trace_tail = pos; // 已复制到行缓冲, 释放缓冲位置
+		trace_stream_send(line, res);
+		return;
+	}
+	if (trace_running == 0 && head == trace_tail)
+	{
+		res = snprintf((char *)line, sizeof(line), "#TRACE STREAM END %lu %lu %04X\r\n",
+					   (unsigned long)trace_count, (unsigned long)trace_dropped, trace_sum);
+		trace_stream_send(line, res);
+		trace_stream = 0;
+	}
+}
+
+void Trace_Dump(void)
+{
+	uint8_t line[8 * TRACE_LINE_ENTRIES + 8];
+	uint16_t sum = 0;
+	uint16_t i;
+	uint16_t head;
+	int res;
+
+	// 导出本身经UART1发送, 先停止录制; 流式方式由 Trace_Process 发完剩余记录
+	Trace_Stop();
+	if (trace_stream != 0)
+	{
+		return;
+	}
+	head = trace_head;
+	res = snprintf((char *)line, sizeof(line), "#TRACE BEGIN %lu %lu\r\n",
+				   (unsigned long)trace_count, (unsigned long)trace_dropped);
+	PC_Chuankou_tongxin_send(line, res);
+	for (i = trace_tail; i != head;)
+	{
+		res = trace_line(line, &i, head, &sum);
+		// 9600波特率下每行约70ms, 整个导出需数秒; 等待发送期间由串口任务监管
+		PC_Chuankou_tongxin_send(line, res);
+	}
+	res = snprintf((char *)line, sizeof(line), "#TRACE END %04X\r\n", sum);
+	PC_Chuankou_tongxin_send(line, res);
+}
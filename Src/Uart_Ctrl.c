@@ -0,0 +1,486 @@
+#include "Uart_Ctrl.h"
+#include "time.h"
+#include "Idle_Ctrl.h"
+#include "Trace_Ctrl.h"
+#include "WTD.h"
+
+static const struct Uart_Port *uart_port_list[UART_PORT_MAX];
+static uint8_t uart_port_num = 0;
+
+// 发送期间占用总线, 空闲时释放
+static void uart_de(const struct Uart_Port *port, uint8_t send_state)
+{
+	FL_GPIO_InitTypeDef GPIO_InitStruct;
+
+	if (port->de_mode == UART_DE_PIN)
+	{
+		if (send_state)
+		{
+			FL_GPIO_SetOutputPin(port->de_gpio, port->de_pin);
+		}
+		else
+		{
+			FL_GPIO_ResetOutputPin(port->de_gpio, port->de_pin);
+		}
+	}
+	else if (port->de_mode == UART_DE_TX_FLOAT)
+	{
+		GPIO_InitStruct.pin = port->tx_pin;
+		GPIO_InitStruct.mode = send_state ? FL_GPIO_MODE_DIGITAL : FL_GPIO_MODE_INPUT;
+		GPIO_InitStruct.outputType = FL_GPIO_OUTPUT_PUSHPULL;
+		GPIO_InitStruct.pull = FL_ENABLE;
+		GPIO_InitStruct.remapPin = FL_DISABLE;
+		GPIO_InitStruct.analogSwitch = FL_DISABLE;
+		(void)FL_GPIO_Init(port->gpio, &GPIO_InitStruct);
+	}
+}
+
+// 等待发送完成最长 tx_wait_ms (uart1 为1000ms, 超过主循环签到期限), 期间登记为UART任务。
+// 等待中只喂狗不签到, 期限在等待上限之外留有余量, 等待未按时结束即停止喂狗
+static void uart_wait_begin(const struct Uart_Port *port)
+{
+	WDT_Task_Begin(WDT_TASK_UART, port->tx_wait_ms + WDT_DEADLINE_UART_MARGIN);
+}
+
+// 透传: 从对端缓冲取一字节发出, 缓冲空时关闭发送中断 (调用时需关中断)
+static void uart_bridge_tx(const struct Uart_Port *port)
+{
+	const struct Uart_Port *src = port->state->peer;
+	struct Uart_State *ss = src->state;
+	uint8_t data;
+
+	if (ss->ring_tail == ss->ring_head)
+	{
+		FL_UART_DisableIT_TXShiftBuffEmpty(port->uart);
+		port->state->bridge_tx = 0;
+		return;
+	}
+	data = src->rx_buf[ss->ring_tail];
+	ss->ring_tail = (ss->ring_tail + 1 < src->rx_size) ? ss->ring_tail + 1 : 0;
+	ss->bridge_fwd++;
+	port->state->bridge_tx = 1;
+	FL_UART_WriteTXBuff(port->uart, data);
+	Trace_Byte(port->trace_port, TRACE_DIR_TX, data);
+}
+
+static uint16_t uart_ring_used(const struct Uart_Port *port)
+{
+	struct Uart_State *s = port->state;
+	uint16_t head = s->ring_head;
+	uint16_t tail = s->ring_tail;
+	return (head >= tail) ? head - tail : port->rx_size - tail + head;
+}
+
+// 透传: 接收中断中把字节放入本口缓冲, 对端发送空闲时启动发送
+static void uart_bridge_rx(const struct Uart_Port *port, uint8_t data)
+{
+	struct Uart_State *s = port->state;
+	const struct Uart_Port *dst = s->peer;
+	uint16_t next = (s->ring_head + 1 < port->rx_size) ? s->ring_head + 1 : 0;
+	uint16_t used;
+
+	if (next == s->ring_tail)
+	{
+		s->bridge_drop++;
+	}
+	else
+	{
+		port->rx_buf[s->ring_head] = data;
+		s->ring_head = next;
+		used = uart_ring_used(port);
+		if (used > s->ring_peak)
+		{
+			s->ring_peak = used;
+		}
+	}
+	// 两口中断优先级不同, 对端发送中断可能正在判断缓冲为空
+	__disable_irq();
+	if (!dst->state->bridge_tx)
+	{
+		FL_UART_ClearFlag_TXShiftBuffEmpty(dst->uart);
+		FL_UART_EnableIT_TXShiftBuffEmpty(dst->uart);
+		uart_bridge_tx(dst);
+	}
+	__enable_irq();
+
+	if (s->escape_len == 0)
+	{
+		return;
+	}
+	if (data == s->escape[s->escape_pos])
+	{
+		if (++s->escape_pos == s->escape_len)
+		{
+			s->escape_pos = 0;
+			s->bridge_stop = 1;
+			Idle_Wake_Mark(port->wake_src);
+		}
+	}
+	else
+	{
+		s->escape_pos = (data == s->escape[0]) ? 1 : 0;
+	}
+}
+
+void Uart_Init(const struct Uart_Port *port)
+{
+	FL_GPIO_InitTypeDef GPIO_InitStruct;
+	FL_UART_InitTypeDef UART_InitStruct;
+	FL_NVIC_ConfigTypeDef InterruptConfigStruct;
+
+	memset(port->state, 0, sizeof(*port->state));
+
+	GPIO_InitStruct.pin = port->rx_pin;
+	GPIO_InitStruct.mode = FL_GPIO_MODE_DIGITAL;
+	GPIO_InitStruct.outputType = FL_GPIO_OUTPUT_PUSHPULL;
+	GPIO_InitStruct.pull = port->rx_pull ? FL_ENABLE : FL_DISABLE;
+	GPIO_InitStruct.remapPin = FL_DISABLE;
+	GPIO_InitStruct.analogSwitch = FL_DISABLE;
+	(void)FL_GPIO_Init(port->gpio, &GPIO_InitStruct);
+
+	GPIO_InitStruct.pin = port->tx_pin;
+	GPIO_InitStruct.pull = FL_DISABLE;
+	(void)FL_GPIO_Init(port->gpio, &GPIO_InitStruct);
+
+	if (port->de_mode == UART_DE_PIN)
+	{
+		GPIO_InitStruct.pin = port->de_pin;
+		GPIO_InitStruct.mode = FL_GPIO_MODE_OUTPUT;
+		(void)FL_GPIO_Init(port->de_gpio, &GPIO_InitStruct);
+	}
+	uart_de(port, 0);
+
+	UART_InitStruct.clockSrc = FL_CMU_UART0_CLK_SOURCE_APBCLK;
+	UART_InitStruct.baudRate = port->baud;
+	UART_InitStruct.transferDirection = FL_UART_DIRECTION_TX_RX;
+	UART_InitStruct.dataWidth = FL_UART_DATA_WIDTH_8B;
+	UART_InitStruct.stopBits = FL_UART_STOP_BIT_WIDTH_1B;
+	UART_InitStruct.parity = FL_UART_PARITY_NONE;
+	(void)FL_UART_Init(port->uart, &UART_InitStruct);
+
+	// 发送中断在 Uart_Send 时才打开
+	FL_UART_ClearFlag_RXBuffFull(port->uart);
+	FL_UART_EnableIT_RXBuffFull(port->uart);
+	FL_UART_ClearFlag_TXShiftBuffEmpty(port->uart);
+	FL_UART_DisableIT_TXShiftBuffEmpty(port->uart);
+
+	InterruptConfigStruct.preemptPriority = port->priority;
+	FL_NVIC_Init(&InterruptConfigStruct, port->irq);
+
+	if (uart_port_num < UART_PORT_MAX)
+	{
+		uart_port_list[uart_port_num++] = port;
+	}
+}
+
+void Uart_IRQ(const struct Uart_Port *port)
+{
+	struct Uart_State *s = port->state;
+	uint8_t data;
+
+	// 接收中断处理
+	if (FL_UART_IsEnabledIT_RXBuffFull(port->uart) && FL_UART_IsActiveFlag_RXBuffFull(port->uart))
+	{
+		data = FL_UART_ReadRXBuff(port->uart); // 读取rxreg清除接收中断标志
+		Trace_Byte(port->trace_port, TRACE_DIR_RX, data);
+		if (port->on_rx_byte != NULL)
+		{
+			port->on_rx_byte();
+		}
+		if (s->peer != NULL)
+		{
+			uart_bridge_rx(port, data);
+		}
+		else if (s->rx_count < port->rx_size)
+		{
+			port->rx_buf[s->rx_count++] = data;
+		}
+		else
+		{
+			s->rx_overflow = 1; // 缓冲区满，丢弃新数据
+		}
+		if (s->peer == NULL)
+		{
+			s->rx_flag = 1;
+			s->rx_timer = port->frame_ms;
+			Idle_Wake_Mark(port->wake_src);
+		}
+	}
+
+	// 发送中断处理
+	if (FL_UART_IsEnabledIT_TXShiftBuffEmpty(port->uart) && FL_UART_IsActiveFlag_TXShiftBuffEmpty(port->uart))
+	{
+		if (s->peer != NULL)
+		{
+			__disable_irq();
+			FL_UART_ClearFlag_TXShiftBuffEmpty(port->uart);
+			uart_bridge_tx(port);
+			__enable_irq();
+			return;
+		}
+		if (s->tx_async)
+		{
+			if (port->tx_fetch(&data))
+			{
+				FL_UART_WriteTXBuff(port->uart, data);
+				Trace_Byte(port->trace_port, TRACE_DIR_TX, data);
+			}
+			else
+			{
+				s->tx_async = 0; // 突发结束或整帧发完
+			}
+		}
+		else if (s->tx_opc < s->tx_len)
+		{
+			data = port->tx_buf[s->tx_opc++];
+			FL_UART_WriteTXBuff(port->uart, data);
+			Trace_Byte(port->trace_port, TRACE_DIR_TX, data);
+		}
+
+		FL_UART_ClearFlag_TXShiftBuffEmpty(port->uart);
+
+		if (!s->tx_async && s->tx_opc == s->tx_len)
+		{
+			FL_UART_DisableIT_TXShiftBuffEmpty(port->uart);
+			s->tx_done = 1;
+		}
+	}
+}
+
+uint8_t Uart_Send(const struct Uart_Port *port, uint8_t data[], uint16_t lenth)
+{
+	struct Uart_State *s = port->state;
+	uint32_t start;
+
+	// 透传期间本口只发对端数据
+	if (lenth == 0 || lenth > port->tx_size || s->peer != NULL)
+	{
+		return 0;
+	}
+	// 多包发送时，会等待上一包发送完再发送下一包
+	if (s->tx_len != s->tx_opc || s->tx_async)
+	{
+		start = time_ms_count;
+		uart_wait_begin(port);
+		while ((s->tx_len != s->tx_opc || s->tx_async) && time_ms_count - start < port->tx_wait_ms)
+		{
+			WDT_Feed();
+		}
+		WDT_Task_End(WDT_TASK_UART);
+	}
+	if (s->tx_len != s->tx_opc || s->tx_async)
+	{
+		return 0; // 超时退出，上一次发送未完成
+	}
+	FL_DelayMs(port->tx_guard_ms);
+	memcpy(port->tx_buf, data, lenth);
+	s->tx_done = 0; // 防止 Uart_Poll 在本包发送中释放总线
+	uart_de(port, 1);
+	s->tx_len = lenth;
+	s->tx_opc = 1;
+	FL_UART_ClearFlag_TXShiftBuffEmpty(port->uart);
+	FL_UART_EnableIT_TXShiftBuffEmpty(port->uart);
+	FL_UART_WriteTXBuff(port->uart, port->tx_buf[0]);
+	Trace_Byte(port->trace_port, TRACE_DIR_TX, port->tx_buf[0]);
+	return 1;
+}
+
+void Uart_Tx_AsyncKick(const struct Uart_Port *port)
+{
+	struct Uart_State *s = port->state;
+	uint8_t data;
+
+	if (port->tx_fetch == NULL || s->tx_async || s->peer != NULL || s->tx_len != s->tx_opc)
+	{
+		return;
+	}
+	if (!port->tx_fetch(&data))
+	{
+		return;
+	}
+	s->tx_async = 1;
+	s->tx_done = 0;
+	uart_de(port, 1);
+	FL_UART_ClearFlag_TXShiftBuffEmpty(port->uart);
+	FL_UART_EnableIT_TXShiftBuffEmpty(port->uart);
+	FL_UART_WriteTXBuff(port->uart, data);
+	Trace_Byte(port->trace_port, TRACE_DIR_TX, data);
+}
+
+void Uart_Poll(const struct Uart_Port *port)
+{
+	struct Uart_State *s = port->state;
+	uint16_t lenth;
+
+	if (s->bridge_stop)
+	{
+		// 退出序列作为一帧交给上层应答
+		s->bridge_stop = 0;
+		Uart_Bridge_Stop(port);
+		lenth = s->escape_len;
+		memcpy(port->frame_buf, s->escape, lenth);
+		port->on_frame(port->frame_buf, lenth);
+		return;
+	}
+	if (s->peer != NULL)
+	{
+		return;
+	}
+	// 最后一字节还在移位寄存器中, 延时后再释放总线
+	if (s->tx_done)
+	{
+		s->tx_done = 0;
+		if (port->de_mode != UART_DE_NONE)
+		{
+			FL_DelayMs(port->tx_guard_ms);
+			uart_de(port, 0);
+		}
+	}
+	if (s->rx_flag == 1 && s->rx_timer == 0)
+	{
+		// 复制期间暂停接收, 新字节留在接收寄存器中, 打开后立即进中断
+		FL_UART_DisableIT_RXBuffFull(port->uart);
+		lenth = s->rx_count;
+		memcpy(port->frame_buf, port->rx_buf, lenth);
+		s->rx_count = 0;
+		s->rx_flag = 0;
+		if (s->rx_overflow)
+		{
+			s->rx_overflow = 0;
+			s->overflow_count++;
+		}
+		FL_UART_EnableIT_RXBuffFull(port->uart);
+		port->on_frame(port->frame_buf, lenth);
+	}
+}
+
+uint8_t Uart_Kongxian(const struct Uart_Port *port)
+{
+	struct Uart_State *s = port->state;
+	return (s->rx_flag == 0 && s->tx_len == s->tx_opc && s->tx_async == 0 && s->peer == NULL);
+}
+
+void Uart_Tick(void)
+{
+	uint8_t i;
+	struct Uart_State *s;
+
+	for (i = 0; i < uart_port_num; i++)
+	{
+		s = uart_port_list[i]->state;
+		if (s->rx_timer > 0)
+		{
+			s->rx_timer--;
+		}
+	}
+}
+
+static uint8_t uart_tx_busy(const struct Uart_Port *port)
+{
+	struct Uart_State *s = port->state;
+	return (s->tx_len != s->tx_opc || s->tx_async || s->bridge_tx);
+}
+
+uint8_t Uart_Bridge_Start(const struct Uart_Port *a, const struct Uart_Port *b, const uint8_t *escape, uint8_t escape_len)
+{
+	const struct Uart_Port *pair[2];
+	struct Uart_State *s;
+	uint32_t start = time_ms_count;
+	uint8_t i;
+
+	pair[0] = a;
+	pair[1] = b;
+	if (a->state->peer != NULL || b->state->peer != NULL)
+	{
+		return 0;
+	}
+	// 等待应答等正在发送的数据发完
+	uart_wait_begin(a);
+	while ((uart_tx_busy(a) || uart_tx_busy(b)) && time_ms_count - start < a->tx_wait_ms)
+	{
+		WDT_Feed();
+	}
+	WDT_Task_End(WDT_TASK_UART);
+	if (uart_tx_busy(a) || uart_tx_busy(b))
+	{
+		return 0;
+	}
+	for (i = 0; i < 2; i++)
+	{
+		s = pair[i]->state;
+		FL_UART_DisableIT_RXBuffFull(pair[i]->uart);
+		s->rx_count = 0;
+		s->rx_flag = 0;
+		s->rx_overflow = 0;
+		s->tx_done = 0;
+		s->ring_head = 0;
+		s->ring_tail = 0;
+		s->ring_peak = 0;
+		s->bridge_fwd = 0;
+		s->bridge_drop = 0;
+		s->bridge_stop = 0;
+		s->escape_pos = 0;
+		s->escape = (i == 0) ? escape : NULL;
+		s->escape_len = (i == 0) ? escape_len : 0;
+		uart_de(pair[i], 1);
+	}
+	a->state->peer = b;
+	b->state->peer = a;
+	FL_UART_EnableIT_RXBuffFull(a->uart);
+	FL_UART_EnableIT_RXBuffFull(b->uart);
+	return 1;
+}
+
+void Uart_Bridge_Stop(const struct Uart_Port *port)
+{
+	const struct Uart_Port *pair[2];
+	struct Uart_State *s;
+	uint32_t start = time_ms_count;
+	uint8_t i;
+
+	pair[0] = port;
+	pair[1] = port->state->peer;
+	if (pair[1] == NULL)
+	{
+		return;
+	}
+	// 缓冲中剩余的字节继续由发送中断发完
+	uart_wait_begin(port);
+	while ((uart_ring_used(pair[0]) || uart_ring_used(pair[1])) && time_ms_count - start < port->tx_wait_ms)
+	{
+		WDT_Feed();
+	}
+	WDT_Task_End(WDT_TASK_UART);
+	for (i = 0; i < 2; i++)
+	{
+		FL_UART_DisableIT_RXBuffFull(pair[i]->uart);
+		FL_UART_DisableIT_TXShiftBuffEmpty(pair[i]->uart);
+	}
+	for (i = 0; i < 2; i++)
+	{
+		s = pair[i]->state;
+		s->bridge_drop += uart_ring_used(pair[i]);
+		s->peer = NULL;
+		s->bridge_tx = 0;
+		s->rx_count = 0;
+		s->rx_flag = 0;
+		// 最后一字节还在移位寄存器中, 由 Uart_Poll 延时后释放总线
+		s->tx_done = 1;
+		FL_UART_ClearFlag_RXBuffFull(pair[i]->uart);
+		FL_UART_EnableIT_RXBuffFull(pair[i]->uart);
+	}
+}
+
+uint8_t Uart_Bridge_Active(const struct Uart_Port *port)
+{
+	return (port->state->peer != NULL);
+}
+
+void Uart_Bridge_Get_tongji(const struct Uart_Port *port, struct Uart_Bridge_tongji *out)
+{
+	struct Uart_State *s = port->state;
+	out->fwd = s->bridge_fwd;
+	out->drop = s->bridge_drop;
+	out->peak = s->ring_peak;
+	out->size = port->rx_size - 1;
+}
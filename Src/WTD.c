@@ -1,8 +1,345 @@
 #include "WTD.h"
+#include "time.h"
+#include "uart1.h"
+#include "time_manager.h"
+
+// 软件看门狗
+// 每个长操作登记为一个任务并设置签到期限, 只有所有活动任务都在期限内时才喂硬件IWDT。
+// ATIM 1ms中断中检查期限, 超时则挂起PendSV抓取被打断的PC/LR写入保留RAM,
+// 此后不再喂狗, 由IWDT完成复位; 下次上电在WatchDog_Init中打印复位原因和现场。
+// 关中断死循环时PendSV无法执行, 仍由IWDT兜底复位, 只是没有现场记录。
+
+struct WDT_Task
+{
+	volatile uint8_t active;
+	volatile uint32_t deadline_ms;
+	volatile uint32_t last_ms;
+	volatile uint32_t checkin_addr;
+};
+
+static struct WDT_Task wdt_task[WDT_TASK_NUM];
+static volatile uint8_t wdt_long_count = 0;   // 除主循环外的活动任务数
+static uint32_t wdt_main_elapsed = 0;         // 长操作开始时主循环已走过的时间
+static volatile uint8_t wdt_tripped = 0;      // 已判定超时, 停止喂狗
+static volatile uint8_t wdt_culprit = WDT_TASK_NONE;
+static volatile uint32_t wdt_overrun_ms = 0;
+
+// 保留RAM, 启动代码不清零 (链接脚本.noinit段)
+static struct WDT_Record wdt_record __attribute__((section(".noinit")));
+
+static uint32_t wdt_record_sum(const struct WDT_Record *rec)
+{
+	const uint32_t *p = (const uint32_t *)rec;
+	uint32_t sum = 0;
+	uint8_t i;
+	for (i = 0; i < (sizeof(struct WDT_Record) - 4) / 4; i++)
+	{
+		sum ^= p[i];
+	}
+	return sum;
+}
+
+static uint8_t wdt_record_valid(void)
+{
+	return (wdt_record.magic == WDT_RECORD_MAGIC) && (wdt_record.checksum == wdt_record_sum(&wdt_record));
+}
+
+// 上电复位时RAM内容无意义, 重新建立记录
+static void wdt_record_reset(void)
+{
+	memset(&wdt_record, 0, sizeof(wdt_record));
+	wdt_record.magic = WDT_RECORD_MAGIC;
+	wdt_record.task_id = WDT_TASK_NONE;
+	wdt_record.checksum = wdt_record_sum(&wdt_record);
+}
+
+static const char *wdt_task_name(uint8_t id)
+{
+	switch (id)
+	{
+	case WDT_TASK_MAIN:
+		return "MAIN";
+	case WDT_TASK_CURRENT_CHK:
+		return "CURRENT_CHK";
+	case WDT_TASK_FLASH:
+		return "FLASH";
+	case WDT_TASK_DELAY:
+		return "DELAY";
+	case WDT_TASK_UART:
+		return "UART";
+	default:
+		return "UNKNOWN";
+	}
+}
+
+// 打印复位原因和上次超时现场
+static void wdt_boot_report(void)
+{
+	uint8_t iwdt_rst = FL_RMU_IsActiveFlag_IWDTN(RMU) ? 1 : 0;
+	uint8_t por_rst = FL_RMU_IsActiveFlag_PORN(RMU) ? 1 : 0;
+
+	if (por_rst || !wdt_record_valid())
+	{
+		wdt_record_reset();
+	}
+	if (iwdt_rst)
+	{
+		wdt_record.reset_count++;
+		if (wdt_record.task_id != WDT_TASK_NONE)
+		{
+			DeBug_print("[WDT] IWDT reset #%d, task=%s overrun=%dms PC=0x%08X LR=0x%08X checkin=0x%08X\r\n",
+						wdt_record.reset_count, wdt_task_name(wdt_record.task_id), wdt_record.overrun_ms,
+						wdt_record.pc, wdt_record.lr, wdt_record.checkin_addr);
+		}
+		else
+		{
+			// 关中断或硬件异常卡死, PendSV未能执行
+			DeBug_print("[WDT] IWDT reset #%d, no snapshot\r\n", wdt_record.reset_count);
+		}
+	}
+	// 记录已上报, 清除现场但保留复位计数
+	wdt_record.task_id = WDT_TASK_NONE;
+	wdt_record.pc = 0;
+	wdt_record.lr = 0;
+	wdt_record.checkin_addr = 0;
+	wdt_record.overrun_ms = 0;
+	wdt_record.checksum = wdt_record_sum(&wdt_record);
+
+	FL_RMU_ClearFlag_IWDTN(RMU);
+	FL_RMU_ClearFlag_SOFTN(RMU);
+	FL_RMU_ClearFlag_PORN(RMU);
+	FL_RMU_ClearFlag_NRSTN(RMU);
+	FL_RMU_ClearFlag_LKUPN(RMU);
+}
+
+// TM_DelayMs阻塞延时期间签到; 系统滴答停止时延时无法结束, 由期限检测发现
+static void wdt_delay_enter(uint32_t ms)
+{
+	(void)ms;
+	WDT_Task_Begin(WDT_TASK_DELAY, WDT_DEADLINE_DELAY);
+}
+
+static void wdt_delay_poll(void)
+{
+	WDT_CheckIn(WDT_TASK_DELAY);
+}
+
+static void wdt_delay_exit(void)
+{
+	WDT_Task_End(WDT_TASK_DELAY);
+}
+
+static const TM_DelayHooks_t wdt_delay_hooks = {
+	wdt_delay_enter,
+	wdt_delay_poll,
+	wdt_delay_exit,
+};
+
+// 覆盖驱动库中的弱定义: 原实现每1ms直接重载IWDT, 任务超时后仍在喂狗。
+// 改为与TM_DelayMs相同, 延时登记为DELAY任务, 每1ms签到并经WDT_Feed检查全部任务,
+// 有任务超时即停止喂狗。外层已登记DELAY任务时 (延时嵌套) 只签到。
+void FL_DelayMs(uint32_t count)
+{
+	uint8_t waiceng = (wdt_task[WDT_TASK_DELAY].active == 0);
+
+	if (waiceng)
+	{
+		WDT_Task_Begin(WDT_TASK_DELAY, WDT_DEADLINE_DELAY);
+	}
+	while (count--)
+	{
+		FL_DelayUs(1000);
+		WDT_CheckIn(WDT_TASK_DELAY);
+	}
+	if (waiceng)
+	{
+		WDT_Task_End(WDT_TASK_DELAY);
+	}
+}
+
 void WatchDog_Init()
 {
 	FL_IWDT_InitTypeDef WTD_InitTypeDef[1];
+
+	wdt_boot_report();
+
+	memset(wdt_task, 0, sizeof(wdt_task));
+	wdt_long_count = 0;
+	wdt_tripped = 0;
+	wdt_culprit = WDT_TASK_NONE;
+
 	FL_IWDT_StructInit(WTD_InitTypeDef);
-	FL_IWDT_Init(IWDT,WTD_InitTypeDef);
+	WTD_InitTypeDef->overflowPeriod = WDT_IWDT_PERIOD;
+	WTD_InitTypeDef->iwdtWindows = 0; // 不使用窗口, 任意时刻可喂狗
+	FL_IWDT_Init(IWDT, WTD_InitTypeDef);
 	FL_IWDT_ReloadCounter(IWDT);
+
+	// 主循环常驻
+	WDT_Task_Begin(WDT_TASK_MAIN, WDT_DEADLINE_MAIN);
+	TM_SetDelayHooks(&wdt_delay_hooks);
+}
+
+void WDT_Task_Begin(uint8_t id, uint32_t deadline_ms)
+{
+	if (id >= WDT_TASK_NUM)
+	{
+		return;
+	}
+	wdt_task[id].deadline_ms = deadline_ms;
+	wdt_task[id].last_ms = time_ms_count;
+	wdt_task[id].checkin_addr = (uint32_t)__builtin_return_address(0);
+	if (wdt_task[id].active == 0)
+	{
+		wdt_task[id].active = 1;
+		if (id != WDT_TASK_MAIN)
+		{
+			// 先置计数使中断跳过主循环检查, 再记下主循环的计时 (暂停)
+			wdt_long_count++;
+			if (wdt_long_count == 1)
+			{
+				wdt_main_elapsed = time_ms_count - wdt_task[WDT_TASK_MAIN].last_ms;
+			}
+		}
+	}
+	WDT_Feed();
+}
+
+void WDT_Task_End(uint8_t id)
+{
+	if (id >= WDT_TASK_NUM || wdt_task[id].active == 0)
+	{
+		return;
+	}
+	wdt_task[id].active = 0;
+	if (id != WDT_TASK_MAIN)
+	{
+		// 最后一个长操作结束: 主循环从暂停时的计时继续, 而不是重新计时,
+		// 否则在循环中反复延时/发送的死循环会一直把主循环任务续期
+		if (wdt_long_count == 1)
+		{
+			wdt_task[WDT_TASK_MAIN].last_ms = time_ms_count - wdt_main_elapsed;
+		}
+		wdt_long_count--;
+	}
+	WDT_Feed();
+}
+
+void WDT_CheckIn(uint8_t id)
+{
+	if (id >= WDT_TASK_NUM)
+	{
+		return;
+	}
+	wdt_task[id].last_ms = time_ms_count;
+	wdt_task[id].checkin_addr = (uint32_t)__builtin_return_address(0);
+	if (id == WDT_TASK_MAIN)
+	{
+		wdt_main_elapsed = 0;
+	}
+	WDT_Feed();
+}
+
+// 返回超时任务ID, 全部健康返回WDT_TASK_NONE
+static uint8_t wdt_find_overrun(uint32_t now, uint32_t *overrun)
+{
+	uint8_t i;
+	uint32_t elapsed;
+	for (i = 0; i < WDT_TASK_NUM; i++)
+	{
+		if (wdt_task[i].active == 0)
+		{
+			continue;
+		}
+		// 长操作期间主循环本身被阻塞, 由长操作任务代为签到
+		if (i == WDT_TASK_MAIN && wdt_long_count > 0)
+		{
+			continue;
+		}
+		elapsed = now - wdt_task[i].last_ms;
+		if (elapsed > wdt_task[i].deadline_ms)
+		{
+			*overrun = elapsed;
+			return i;
+		}
+	}
+	return WDT_TASK_NONE;
+}
+
+uint8_t WDT_Feed(void)
+{
+	uint32_t overrun;
+	if (wdt_tripped)
+	{
+		return 0;
+	}
+	if (wdt_find_overrun(time_ms_count, &overrun) != WDT_TASK_NONE)
+	{
+		return 0;
+	}
+	FL_IWDT_ReloadCounter(IWDT);
+	return 1;
+}
+
+void WDT_Tick(void)
+{
+	uint32_t overrun;
+	uint8_t id;
+	if (wdt_tripped)
+	{
+		return;
+	}
+	id = wdt_find_overrun(time_ms_count, &overrun);
+	if (id == WDT_TASK_NONE)
+	{
+		return;
+	}
+	wdt_tripped = 1;
+	wdt_culprit = id;
+	wdt_overrun_ms = overrun;
+	// ATIM中断返回后进入PendSV, 此时栈帧即为被打断的任务现场
+	SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+// 由PendSV_Handler调用, frame指向异常栈帧 r0,r1,r2,r3,r12,lr,pc,xpsr
+void WDT_Capture(uint32_t *frame)
+{
+	if (!wdt_tripped)
+	{
+		return;
+	}
+	wdt_record.magic = WDT_RECORD_MAGIC;
+	wdt_record.task_id = wdt_culprit;
+	wdt_record.lr = frame[5];
+	wdt_record.pc = frame[6];
+	wdt_record.checkin_addr = wdt_task[wdt_culprit].checkin_addr;
+	wdt_record.overrun_ms = wdt_overrun_ms;
+	wdt_record.checksum = wdt_record_sum(&wdt_record);
+	// 返回后不再喂狗, 等待IWDT复位
+}
+
+// 按EXC_RETURN选择MSP/PSP, 将栈帧地址交给WDT_Capture (覆盖启动文件中的弱定义)
+__attribute__((naked)) void PendSV_Handler(void)
+{
+	__asm volatile(
+		"movs r0, #4          \n"
+		"mov  r1, lr          \n"
+		"tst  r0, r1          \n"
+		"beq  1f              \n"
+		"mrs  r0, psp         \n"
+		"b    2f              \n"
+		"1:                   \n"
+		"mrs  r0, msp         \n"
+		"2:                   \n"
+		"ldr  r1, =WDT_Capture\n"
+		"bx   r1              \n");
+}
+
+uint8_t WDT_Get_Record(struct WDT_Record *out)
+{
+	if (!wdt_record_valid())
+	{
+		return 0;
+	}
+	memcpy(out, &wdt_record, sizeof(wdt_record));
+	return 1;
 }
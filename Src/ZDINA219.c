@@ -1,11 +1,16 @@
 #include "main.h"
 #include "ZDINA219.h"
 #include "GPIO.h"
+#include "WTD.h"
+#include "jig_config.h"
+#include "meas_calib.h"
+#include "Calib_Ctrl.h"
 #define TRUE 1
 #define FALSE 0
 unsigned char ZDINA219Buff[2];
 unsigned char ZDINA219CurrentBuff[20];
 unsigned short ZDINA219CurrentMidBuff[5];
+static unsigned short ZDINA219_Cal = 0x1000;//βдУ׼Ĵֵ
 void ZDINA219_IIC_Delay()
 {
   unsigned char ZDINA219_IIC_Delay_i;
@@ -212,8 +217,8 @@ unsigned short ReadZD_Current()////write-0x80 Read-0x81
 	ZDINA219_IIC_SendBytes(ZDINA219Buff,2);
   ZDINA219_IIC_Stop();
 
-	ZDINA219Buff[0]=0x10;
-	ZDINA219Buff[1]=0x00;
+	ZDINA219Buff[0]=(ZDINA219_Cal>>8)&0xFF;//У׼Ĵ, δУ׼ʱΪֵ(Ĭ0x1000)
+	ZDINA219Buff[1]=ZDINA219_Cal&0xFF;
   ZDINA219_IIC_Start();
   ZDINA219_IIC_SendByte(0x80);		
 	ZDINA219_IIC_SendByte(5);
@@ -223,6 +228,7 @@ unsigned short ReadZD_Current()////write-0x80 Read-0x81
 	for(Read_Current_i=0;Read_Current_i<10;Read_Current_i++)
 	{
 		FL_DelayMs(50);
+		WDT_CheckIn(WDT_TASK_CURRENT_CHK);
 		ZDINA219_IIC_Start();
 	  ZDINA219_IIC_SendByte(0x80);	
 		ZDINA219_IIC_SendByte(4);
@@ -271,9 +277,11 @@ uint16_t CheckZDCurrent()//
 	//MCP4561_Write_Data(0,0);///big;
 	ReadZD_Current();//ȶһΣһζȡпܶ
 	FL_DelayMs(100);
+	WDT_CheckIn(WDT_TASK_CURRENT_CHK);
 	for(CheckZDCurrent_i=0;CheckZDCurrent_i<3;CheckZDCurrent_i++)
 	{
 		FL_DelayMs(100);
+		WDT_CheckIn(WDT_TASK_CURRENT_CHK);
 		tmpZDCurrent[CheckZDCurrent_i]=ReadZD_Current();
 	}
 	minZDCurrent = 0;
@@ -302,14 +310,43 @@ uint16_t CheckZDCurrent()//
         return minZDCurrent;
 }
 
-uint16_t Current_CHK_Func()
+static uint16_t Current_CeLiang(uint16_t cal)
 {
 	uint16_t dianliu;
+	ZDINA219_Cal = cal;
 	//Current_CHK_CTRL_ON();
+	WDT_Task_Begin(WDT_TASK_CURRENT_CHK, WDT_DEADLINE_CURRENT_CHK);
 	FL_DelayMs(100);
+	WDT_CheckIn(WDT_TASK_CURRENT_CHK);
 	dianliu = CheckZDCurrent();//繦
 	Current_CHK_CTRL_OFF();
+	WDT_Task_End(WDT_TASK_CURRENT_CHK);
 	return dianliu;
 }
 
+//У׼ʱ㵽У׼Ĵ(Ĵֵ, ʧֱ), ƫƼڶ
+uint16_t Current_CHK_Func()
+{
+	uint32_t cal = JigConfig_Get(JIG_CFG_INA219_CAL);
+	int32_t dianliu;
+	if(!MeasCalib_Valid(CALIB_CH_GONGHAO))
+	{
+		return Current_CeLiang((uint16_t)cal);
+	}
+	cal = (cal * MeasCalib_Get(CALIB_CH_GONGHAO)->gain + (1UL << (MEASCAL_GAIN_SHIFT - 1))) >> MEASCAL_GAIN_SHIFT;
+	if(cal < 1) cal = 1;
+	if(cal > 0xFFFE) cal = 0xFFFE;
+	dianliu = (int16_t)Current_CeLiang((uint16_t)cal);
+	dianliu += MeasCalib_Get(CALIB_CH_GONGHAO)->offset;
+	if(dianliu > 32767) dianliu = 32767;
+	if(dianliu < -32768) dianliu = -32768;
+	return (uint16_t)dianliu;
+}
+
+//δУ׼Ķ(ĬУ׼Ĵ), У׼
+uint16_t Current_CHK_Raw()
+{
+	return Current_CeLiang((uint16_t)JigConfig_Get(JIG_CFG_INA219_CAL));
+}
+
 
@@ -8,27 +8,75 @@
 #include "LED_CTRL.h"
 #include "Test_List.h"
 #include "WTD.h"
+#include "Idle_Ctrl.h"
+#include "Trace_Ctrl.h"
+#include "jig_config.h"
+#include "step_profiler.h"
+#include "test_stats.h"
+#include "step_executor.h"
+#include "Bus_Ctrl.h"
+#include "Push_Ctrl.h"
+#include "Prof_Ctrl.h"
+#include "Stack_Ctrl.h"
+#include "Golden_Ctrl.h"
+#include "Calib_Ctrl.h"
+#include "PC_xieyi_Ctrl.h"
+#include "tongxin_xieyi_Ctrl.h"
+#include "Protocol/protocol_manager.h"
 // 版本：VER2.0
 uint8_t Debug_Mode = 0;
 uint16_t Debug_print_time = 10000;
 void test_Init()
 {
 	Others_GPIO_Init();
+	// 指示灯由GPTIM2播放, 不占用主循环
+	LED_Init();
 	UART5_MF_Config_Init();
 	UART1_MF_Config_Init();
 	UART0_MF_Config_Init();
 	ATIM_Init();
+	// 被测设备发送经协议管理器, 前导和帧由 UART0 发送中断逐字节发出
+	TONGXIN_Init();
 	MF_ADC_PC10_Config_Init();
+	// 工装配置 (KVDB), 工位检测和阈值判断前加载
+	JigConfig_SetTimeSource(time_get_us);
+	JigConfig_Init();
+	Debug_Mode = JigConfig_Get(JIG_CFG_DEBUG_MODE);
+	// 测试计划 (PC命令0xDA下载), 没有下载时使用内置计划
+	test_jihua_Init();
+	// 测试步骤耗时统计和Flash测试汇总 (PC命令0xD4读取)
+	StepProf_SetTimeSource(time_get_us);
+	TestStats_Init();
+	// 测试步骤并行执行 (步骤内重发/复测计时)
+	StepExec_SetTimeSource(time_get_us);
 	// ��λ���
 	gongwei_jiance();
 	// ���ذ����ó�ʼ��
 	test_start_Init();
+	// 0x55 帧命令转发到 Components 协议 (PC命令0xD6/0xD8 批量读写配置, 0xD4 测试统计, 0xDA/0xDC 测试计划, 0xE0 金样, 0xE2 校准, 0xBC 后台下载)
+	PC_xieyi_Init();
 	// ���Ź�
 	WatchDog_Init();
+	// 主循环空闲休眠
+	Idle_Init();
+	// 串口通讯录制 (PC命令0xA0启动)
+	Trace_Init();
+	// RS-485 广播命令时隙应答
+	Bus_Init();
+	// 测试事件主动上报 (PC命令0xB4开启)
+	Push_Init();
+	// CPU耗时剖析 (PC命令0xB6开始采样)
+	Prof_Init();
+	// 测量通道校准值 (PC命令0xE2, 0x55 帧经 PC_xieyi_Init 登记的转发)
+	Calib_Init();
+	// 金样检测 (PC命令0xE0, 0x55 帧经 PC_xieyi_Init 登记的转发), 加载参考和漂移趋势
+	Golden_Init();
 }
 
 int main(void)
 {
+	// 填充未使用的RAM, 用于统计栈深度水位 (PC命令0xB8读取)
+	Stack_Paint();
 	/* Initialize FL Driver Library */
 	/* SHOULD BE KEPT!!! */
 	FL_Init();
@@ -51,16 +99,38 @@ int main(void)
 
 	while (1)
 	{
+		PROF_ENTER(PROF_ZONE_LOOP);
 		if (Debug_print_time == 0) //
 		{
 			Debug_print_time = 10000;
 			DeBug_print("[Debug] Still alive, station=%d\r\n", Test_jiejuo_jilu.gongwei);
+			Idle_Report();
+			Stack_Report();
 		}
+		// 各任务耗时 (CPU周期), PC命令0xB6导出
+		PROF_ENTER(PROF_ZONE_UART5);
 		Uart5_Rx_rec();
+		PROF_EXIT(PROF_ZONE_UART5);
+		PROF_ENTER(PROF_ZONE_UART1);
 		Uart1_Rx_rec();
+		PROF_EXIT(PROF_ZONE_UART1);
+		PROF_ENTER(PROF_ZONE_BUS);
+		Bus_Process();
+		Push_Process();
+		Trace_Process();
+		PROF_EXIT(PROF_ZONE_BUS);
+		PROF_ENTER(PROF_ZONE_UART0);
 		Uart0_Rx_rec();
-		LED_FLAG_LOOP();
+		ProtocolManager_Process();
+		PROF_EXIT(PROF_ZONE_UART0);
+		PROF_ENTER(PROF_ZONE_TEST);
 		test_Loop_Func();
-		FL_IWDT_ReloadCounter(IWDT);
+		Golden_Process();
+		Calib_Process();
+		PROF_EXIT(PROF_ZONE_TEST);
+		// 主循环签到, 所有任务健康时才喂硬件看门狗
+		WDT_CheckIn(WDT_TASK_MAIN);
+		PROF_EXIT(PROF_ZONE_LOOP);
+		Idle_Sleep();
 	}
 }
@@ -0,0 +1,209 @@
+/**
+ * @file bus_bench.c
+ * @brief RS-485 多工位总线: 一个工位的主循环 (PC协议解析和总线时隙) 在模拟串口上运行 (本机)
+ *
+ * 由 VscodeGcc/scripts/bus_bench.py sim 与 replay_bench.c 相同的固件源文件一起编译
+ * (PC_xieyi_Ctrl.c、Bus_Ctrl.c、Test_List.c、uart0/uart1.c ...), 每个模拟工位一个进程:
+ *
+ *   bus_bench [-c 配置名=值] [-l 主循环us] [-b 最大阻塞us] [-s 随机种子]
+ *
+ * 主循环同 main.c, 每圈 -l 微秒 (另加 0..-b 微秒的随机阻塞) 后休眠到下一个中断。
+ * 脚本按时间步进所有工位, 标准输入每行一条命令 (时间us, 从初始化完成后的节拍起算):
+ *   x 时间 字节   UART1 在该时刻收到一个字节 (上位机或其他工位发出), 按时间顺序追加
+ *   g 时间        运行到该时刻, 输出期间 UART1 发出的字节 "时间 字节" (字节开始移出的时刻),
+ *                 最后一行 "."
+ *   q             输出 "end 广播 时隙应答 错过时隙 冲突 最大延迟ms" (Bus_Get_tongji) 后退出
+ * 主循环一圈内的阻塞延时 (FL_DelayMs) 可能越过步进时刻, 期间收到的字节在延时结束后送入。
+ */
+
+#include "uart_sim.h"
+#include "time.h"
+#include "uart0.h"
+#include "uart1.h"
+#include "Test_List.h"
+#include "PC_xieyi_Ctrl.h"
+#include "tongxin_xieyi_Ctrl.h"
+#include "Bus_Ctrl.h"
+#include "Push_Ctrl.h"
+#include "Trace_Ctrl.h"
+#include "jig_config.h"
+#include "step_profiler.h"
+#include "step_executor.h"
+#include "Protocol/protocol_manager.h"
+#include "flash_sim.h"
+#include <fal.h>
+
+uint8_t Debug_Mode = 0;
+
+static uint64_t bus_base_us;
+static uint8_t bus_running = 0;
+
+// 主循环状态: 执行一圈 / 一圈的剩余耗时 / 休眠等中断
+enum Bus_Loop
+{
+	BUS_LOOP_RUN = 0,
+	BUS_LOOP_BUSY,
+	BUS_LOOP_SLEEP
+};
+static enum Bus_Loop bus_loop = BUS_LOOP_RUN;
+static uint64_t bus_busy_until;
+
+// UART1 发出的字节在下次 g 命令结束时输出
+void Trace_Byte(uint8_t port, uint8_t dir, uint8_t data)
+{
+	if (!bus_running || port != TRACE_PORT_UART1 || dir != TRACE_DIR_TX)
+		return;
+	printf("%llu %02X\n", (unsigned long long)(Sim_Now_us() - bus_base_us), data);
+}
+
+void Trace_Process(void) {}
+
+static int bus_config(const char *arg)
+{
+	char name[32];
+	long value;
+	int id;
+
+	if (sscanf(arg, "%31[^=]=%ld", name, &value) != 2)
+		return 0;
+	for (id = 0; id < JIG_CFG_NUM; id++)
+	{
+		if (strcmp(JigConfig_GetName((JigConfigId)id), name) == 0)
+			return JigConfig_Set((JigConfigId)id, (int32_t)value) == JIG_CFG_OK;
+	}
+	return 0;
+}
+
+// 同 main.c test_Init 中仿真到的部分
+static void bus_init(int argc, char **argv)
+{
+	int i;
+
+	UART1_MF_Config_Init();
+	UART0_MF_Config_Init();
+	TONGXIN_Init();
+	flash_sim_reset();
+	fal_init();
+	JigConfig_SetTimeSource(time_get_us);
+	JigConfig_Init();
+	for (i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "-c") == 0 && !bus_config(argv[i + 1]))
+		{
+			fprintf(stderr, "bad config %s\n", argv[i + 1]);
+			exit(1);
+		}
+	}
+	Debug_Mode = JigConfig_Get(JIG_CFG_DEBUG_MODE);
+	test_jihua_Init();
+	StepProf_SetTimeSource(time_get_us);
+	StepExec_SetTimeSource(time_get_us);
+	gongwei_jiance();
+	test_start_Init();
+	PC_xieyi_Init();
+	Bus_Init();
+	Push_Init();
+}
+
+// 主循环运行到 t_us (绝对时间), 一圈执行中越过 t_us 时下次从剩余耗时继续
+static void bus_run_to(uint64_t t_us, uint32_t loop_us, uint32_t block_us)
+{
+	while (Sim_Now_us() < t_us)
+	{
+		if (bus_loop == BUS_LOOP_RUN)
+		{
+			Uart1_Rx_rec();
+			Bus_Process();
+			Push_Process();
+			Trace_Process();
+			Uart0_Rx_rec();
+			ProtocolManager_Process();
+			test_Loop_Func();
+			bus_busy_until = Sim_Now_us() + loop_us;
+			if (block_us > 0)
+				bus_busy_until += (uint32_t)rand() % (block_us + 1);
+			bus_loop = BUS_LOOP_BUSY;
+		}
+		else if (bus_loop == BUS_LOOP_BUSY)
+		{
+			if (bus_busy_until > t_us)
+			{
+				Sim_Run_To(t_us);
+				return;
+			}
+			Sim_Run_To(bus_busy_until);
+			bus_loop = BUS_LOOP_SLEEP;
+		}
+		else if (Sim_Wait_Irq_Until(t_us))
+		{
+			bus_loop = BUS_LOOP_RUN;
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	static char line[64];
+	struct Sim_Rx *rx = NULL;
+	uint32_t rx_count = 0;
+	uint32_t rx_size = 0;
+	uint32_t loop_us = 20;
+	uint32_t block_us = 0;
+	unsigned long long t;
+	unsigned int data;
+	struct Bus_tongji tongji;
+	int a;
+
+	for (a = 1; a + 1 < argc; a += 2)
+	{
+		if (strcmp(argv[a], "-l") == 0)
+			loop_us = (uint32_t)atoi(argv[a + 1]);
+		else if (strcmp(argv[a], "-b") == 0)
+			block_us = (uint32_t)atoi(argv[a + 1]);
+		else if (strcmp(argv[a], "-s") == 0)
+			srand((unsigned int)atoi(argv[a + 1]));
+	}
+	if (loop_us == 0)
+		loop_us = 1;
+
+	bus_init(argc, argv);
+	// 命令时间以初始化完成后的下一个节拍为0
+	bus_base_us = (Sim_Now_us() / 1000 + 1) * 1000;
+	Sim_Rx_Set(NULL, 0);
+	Sim_Run_To(bus_base_us - 1);
+	bus_running = 1;
+
+	while (fgets(line, sizeof(line), stdin) != NULL)
+	{
+		if (sscanf(line, "x %llu %x", &t, &data) == 2)
+		{
+			if (rx_count == rx_size)
+			{
+				rx_size = rx_size ? rx_size * 2 : 1024;
+				rx = realloc(rx, rx_size * sizeof(*rx));
+				if (rx == NULL)
+					return 1;
+			}
+			rx[rx_count].t_us = t + bus_base_us;
+			rx[rx_count].port = TRACE_PORT_UART1;
+			rx[rx_count].data = (uint8_t)data;
+			rx_count++;
+			Sim_Rx_Grow(rx, rx_count);
+		}
+		else if (sscanf(line, "g %llu", &t) == 1)
+		{
+			bus_run_to(t + bus_base_us, loop_us, block_us);
+			printf(".\n");
+			fflush(stdout);
+		}
+		else if (line[0] == 'q')
+		{
+			break;
+		}
+	}
+	Bus_Get_tongji(&tongji);
+	printf("end %lu %lu %lu %lu %lu\n", (unsigned long)tongji.guangbo_rx, (unsigned long)tongji.slot_tx,
+		   (unsigned long)tongji.slot_miss, (unsigned long)tongji.chongtu, (unsigned long)tongji.late_max_ms);
+	free(rx);
+	return 0;
+}
@@ -0,0 +1,201 @@
+/**
+ * @file jig_stubs.c
+ * @brief 仿真中不运行的工装模块 (本机运行)
+ *
+ * 继电器/按键/通信控制脚只是开关, 空操作; ADC 批量测量和 INA219 返回 Sim_Rail_mV 中的设定值;
+ * 录制、CPU剖析、栈水位、休眠统计读出全零; 0x55 帧协议 (配置/计划/金样/校准/后台下载)
+ * 不在本仿真范围内, 只计数不应答。
+ */
+
+#include "sim_jig.h"
+#include "GPIO.h"
+#include "LED_CTRL.h"
+#include "ADC_CHK.h"
+#include "ZDINA219.h"
+#include "Idle_Ctrl.h"
+#include "Prof_Ctrl.h"
+#include "Stack_Ctrl.h"
+#include "Trace_Ctrl.h"
+#include "pc_protocol.h"
+#include "Protocol/upgrade_bank.h"
+
+uint32_t Sim_Rail_mV[SIM_RAIL_NUM] = {
+	[SIM_RAIL_VCC] = 3300,
+	[SIM_RAIL_MAIN] = 6000,
+	[SIM_RAIL_VDD] = 3300,
+	[SIM_RAIL_CURRENT] = 0,
+};
+uint8_t Sim_Gongwei_Pin = 0;
+uint32_t Sim_Pc55_Count = 0;
+
+uint32_t Sim_GPIO_Input(GPIO_Type *gpio, uint32_t pin)
+{
+	(void)gpio;
+	return (Sim_Gongwei_Pin & pin) ? 0 : 1;
+}
+
+void Error_Handler(void)
+{
+	fprintf(stderr, "Error_Handler\n");
+	exit(1);
+}
+
+/*============ GPIO.h / LED_CTRL.h ============*/
+
+void zhudian_gongdian_On(void) {}
+void zhudian_gongdian_OFF(void) {}
+void beidian_gongdian_On(void) {}
+void beidian_gongdian_OFF(void) {}
+void zhudian_dianya_CHK_CTRL_ON(void) {}
+void zhudian_dianya_CHK_CTRL_OFF(void) {}
+void erji_dianya_CHK_CTRL_ON(void) {}
+void erji_dianya_CHK_CTRL_OFF(void) {}
+void VCC_dianya_CHK_CTRL_ON(void) {}
+void VCC_dianya_CHK_CTRL_OFF(void) {}
+void SY_dianya_CHK_CTRL_ON(void) {}
+void SY_dianya_CHK_CTRL_OFF(void) {}
+void Current_CHK_CTRL_ON(void) {}
+void Current_CHK_CTRL_OFF(void) {}
+void Uart_shineng_ON(void) {}
+void Uart_shineng_OFF(void) {}
+void ANJIAN_1_OFF(void) {}
+void ANJIAN_1_ON(void) {}
+void ANJIAN_2_OFF(void) {}
+void ANJIAN_2_ON(void) {}
+void ANJIAN_3_OFF(void) {}
+void ANJIAN_3_ON(void) {}
+void ANJIAN_4_OFF(void) {}
+void ANJIAN_4_ON(void) {}
+void dianlu_119_OFF(void) {}
+void dianlu_119_ON(void) {}
+void LED_FLAG_Run(void) {}
+
+/*============ ADC_CHK.h / ZDINA219.h ============*/
+
+// 只用作下标, 测量值按通道取 Sim_Rail_mV, 没有对应设定值的通道超时 (valid=0)
+const ADC_Rail_t ADC_Rails_Main[ADC_RAIL_MAIN_COUNT];
+
+static int sim_rail(uint8_t tongdao)
+{
+	switch (tongdao)
+	{
+	case ADC_RAIL_VCC:
+		return SIM_RAIL_VCC;
+	case ADC_RAIL_GONGDIAN:
+		return SIM_RAIL_MAIN;
+	case ADC_RAIL_ERJI:
+		return SIM_RAIL_VDD;
+	default:
+		return -1;
+	}
+}
+
+uint8_t ADC_MeasureRailSet(const ADC_Rail_t *rails, uint8_t count, uint8_t samples, ADC_RailSet_t *out)
+{
+	uint8_t i;
+	int rail;
+
+	if (rails == NULL || out == NULL || count == 0 || count > ADC_RAIL_MAX || samples == 0)
+		return 1;
+	memset(out, 0, sizeof(*out));
+	out->count = count;
+	out->samples = samples;
+	for (i = 0; i < count; i++)
+	{
+		rail = sim_rail((uint8_t)(&rails[i] - ADC_Rails_Main));
+		if (rail < 0)
+			continue;
+		out->rail[i].avg_mv = Sim_Rail_mV[rail];
+		out->rail[i].min_mv = Sim_Rail_mV[rail];
+		out->rail[i].max_mv = Sim_Rail_mV[rail];
+		out->rail[i].valid = 1;
+	}
+	return 0;
+}
+
+// 耗时只在工装上有意义 (68 A6 应答测量失败)
+uint8_t ADC_RailSet_Benchmark(uint8_t samples, ADC_RailBench_t *out)
+{
+	(void)samples;
+	(void)out;
+	return 1;
+}
+uint16_t Current_CHK_Func(void)
+{
+	return (uint16_t)Sim_Rail_mV[SIM_RAIL_CURRENT];
+}
+
+/*============ 统计类模块 ============*/
+
+uint8_t Idle_Enable = 0;
+void Idle_Wake_Mark(uint8_t wake_src)
+{
+	(void)wake_src;
+}
+void Idle_Get_tongji(struct Idle_tongji *out)
+{
+	memset(out, 0, sizeof(*out));
+}
+
+void Prof_Start(void) {}
+void Prof_Stop(void) {}
+void Prof_Dump(void) {}
+void Prof_Get_tongji(struct Prof_tongji *out)
+{
+	memset(out, 0, sizeof(*out));
+}
+
+void Stack_Get_tongji(struct Stack_tongji *out)
+{
+	memset(out, 0, sizeof(*out));
+}
+
+// 录制控制命令 (68 A0) 照常应答, 录制本身由 Trace_Byte 输出
+void Trace_Start(void) {}
+void Trace_Start_Stream(void) {}
+void Trace_Stop(void) {}
+void Trace_Dump(void) {}
+void Trace_Get_tongji(struct Trace_tongji *out)
+{
+	memset(out, 0, sizeof(*out));
+}
+
+/*============ 0x55 帧协议 ============*/
+
+static bool sim_pc55_init(void)
+{
+	return true;
+}
+static ProtocolResult sim_pc55_parse(uint8_t *data, uint16_t len)
+{
+	(void)data;
+	(void)len;
+	Sim_Pc55_Count++;
+	return PROTOCOL_RESULT_UNKNOWN_CMD;
+}
+static void sim_pc55_set_send_func(ProtocolSendFunc func)
+{
+	(void)func;
+}
+
+const ProtocolInterface config_pc_protocol = {
+	.name = "config_sim",
+	.init = sim_pc55_init,
+	.parse = sim_pc55_parse,
+	.set_send_func = sim_pc55_set_send_func,
+};
+const ProtocolInterface upgrade_pc_protocol = {
+	.name = "upgrade_sim",
+	.init = sim_pc55_init,
+	.parse = sim_pc55_parse,
+	.set_send_func = sim_pc55_set_send_func,
+};
+
+void PC_Protocol_SetStationIdFunc(PCGetStationIdFunc func)
+{
+	(void)func;
+}
+void UpgradeBank_SetBusyFunc(UpgradeBankBusyFunc func)
+{
+	(void)func;
+}
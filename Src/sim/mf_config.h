@@ -0,0 +1,70 @@
+/**
+ * @file mf_config.h
+ * @brief 本机仿真用 mf_config.h, 替代 MF-config/Inc/mf_config.h (后者引入的 FL 驱动直接访问外设寄存器)
+ *
+ * 由 VscodeGcc/scripts/trace_replay.py (sim) 等脚本在 MF-config/Inc 之外加入 Src/sim,
+ * Inc/main.h 照常使用。编译 Src 下的协议/流程代码时, 外设在这里只是串口描述符中的标识,
+ * 真正的收发由 Src/sim/uart_sim.c 按 Src/Uart_Ctrl.c 的中断/主循环时序模拟。
+ */
+#ifndef __MF_CONFIG_H
+#define __MF_CONFIG_H
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct
+{
+	uint32_t id;
+} UART_Type;
+typedef struct
+{
+	uint32_t id;
+} GPIO_Type;
+typedef int IRQn_Type;
+
+#define UART0 ((UART_Type *)0)
+#define UART1 ((UART_Type *)0)
+#define UART5 ((UART_Type *)0)
+#define UART0_IRQn 0
+#define UART1_IRQn 1
+#define UART5_IRQn 2
+#define GPIOA ((GPIO_Type *)0)
+#define GPIOB ((GPIO_Type *)0)
+#define GPIOC ((GPIO_Type *)0)
+#define GPIOD ((GPIO_Type *)0)
+#define GPIOE ((GPIO_Type *)0)
+
+#define FL_GPIO_PIN_0 (1U << 0)
+#define FL_GPIO_PIN_1 (1U << 1)
+#define FL_GPIO_PIN_2 (1U << 2)
+#define FL_GPIO_PIN_3 (1U << 3)
+#define FL_GPIO_PIN_4 (1U << 4)
+#define FL_GPIO_PIN_5 (1U << 5)
+#define FL_GPIO_PIN_6 (1U << 6)
+#define FL_GPIO_PIN_7 (1U << 7)
+#define FL_GPIO_PIN_8 (1U << 8)
+#define FL_GPIO_PIN_9 (1U << 9)
+#define FL_GPIO_PIN_10 (1U << 10)
+#define FL_GPIO_PIN_11 (1U << 11)
+#define FL_GPIO_PIN_12 (1U << 12)
+#define FL_GPIO_PIN_13 (1U << 13)
+#define FL_GPIO_PIN_14 (1U << 14)
+#define FL_GPIO_PIN_15 (1U << 15)
+
+// 工位拨码 (GPIOE PIN0~3, 低电平有效), 由仿真程序设置
+uint32_t Sim_GPIO_Input(GPIO_Type *gpio, uint32_t pin);
+#define FL_GPIO_GetInputPin(gpio, pin) Sim_GPIO_Input((gpio), (pin))
+
+// 推进模拟时钟
+void FL_DelayMs(uint32_t ms);
+
+#define __va_start va_start
+#define __va_end va_end
+#define __disable_irq() ((void)0)
+#define __enable_irq() ((void)0)
+
+// CPU耗时剖析依赖 BSTIM32 计数器, 仿真中关闭
+#define PROF_ENABLE 0
+
+#endif /* __MF_CONFIG_H */
@@ -0,0 +1,201 @@
+/**
+ * @file replay_bench.c
+ * @brief 串口录制回放: 工装主循环 (PC协议解析和测试流程) 在模拟串口上运行 (本机)
+ *
+ * 由 VscodeGcc/scripts/trace_replay.py sim 与 Src/PC_xieyi_Ctrl.c、Test_List.c、
+ * tongxin_xieyi_Ctrl.c、uart0.c、uart1.c、Bus_Ctrl.c、Push_Ctrl.c、协议管理器、PC命令表、
+ * 步骤执行器/耗时统计、jig_config/test_plan (FlashDB + 模拟NOR) 一起编译;
+ * 串口和1ms节拍由 uart_sim.c 模拟, 其余外设见 jig_stubs.c。
+ *
+ *   replay_bench [-r vcc|main|vdd|cur=值] [-c 配置名=值] [-l 主循环us] [-e 结束us]
+ *
+ * 标准输入: 工装收到的字节, 每行 "时间us 端口 字节(十六进制)", 端口同 TRACE_PORT_xxx,
+ * 时间从0开始 (初始化完成后的时刻)。主循环同 main.c, 每圈 -l 微秒后休眠到下一个中断。
+ * 标准输出: 录制 (同 Trace_Byte), 每个收发字节一行 "时间us 端口 方向 字节",
+ * 最后一行 "end 已输入条数 丢弃条数 0x55帧数 测试步骤"。
+ */
+
+#include "uart_sim.h"
+#include "sim_jig.h"
+#include "time.h"
+#include "uart0.h"
+#include "uart1.h"
+#include "Test_List.h"
+#include "PC_xieyi_Ctrl.h"
+#include "tongxin_xieyi_Ctrl.h"
+#include "Bus_Ctrl.h"
+#include "Push_Ctrl.h"
+#include "Trace_Ctrl.h"
+#include "jig_config.h"
+#include "step_profiler.h"
+#include "step_executor.h"
+#include "Protocol/protocol_manager.h"
+#include "flash_sim.h"
+#include <fal.h>
+
+uint8_t Debug_Mode = 0;
+
+static uint64_t replay_base_us;
+static uint8_t replay_recording = 0;
+
+// 同固件录制: 收发中断中逐字节记录
+void Trace_Byte(uint8_t port, uint8_t dir, uint8_t data)
+{
+	if (!replay_recording)
+		return;
+	printf("%llu %u %u %02X\n", (unsigned long long)(Sim_Now_us() - replay_base_us), port, dir, data);
+}
+
+void Trace_Process(void) {}
+
+static struct Sim_Rx *replay_load(uint32_t *count)
+{
+	static char line[128];
+	struct Sim_Rx *list = NULL;
+	uint32_t size = 0;
+	unsigned long long t;
+	unsigned int port;
+	unsigned int data;
+
+	*count = 0;
+	while (fgets(line, sizeof(line), stdin) != NULL)
+	{
+		if (sscanf(line, "%llu %u %x", &t, &port, &data) != 3)
+			continue;
+		if (*count == size)
+		{
+			size = size ? size * 2 : 4096;
+			list = realloc(list, size * sizeof(*list));
+			if (list == NULL)
+				exit(1);
+		}
+		list[*count].t_us = t;
+		list[*count].port = (uint8_t)port;
+		list[*count].data = (uint8_t)data;
+		(*count)++;
+	}
+	return list;
+}
+
+static int replay_config(const char *arg)
+{
+	char name[32];
+	long value;
+	int id;
+
+	if (sscanf(arg, "%31[^=]=%ld", name, &value) != 2)
+		return 0;
+	for (id = 0; id < JIG_CFG_NUM; id++)
+	{
+		if (strcmp(JigConfig_GetName((JigConfigId)id), name) == 0)
+			return JigConfig_Set((JigConfigId)id, (int32_t)value) == JIG_CFG_OK;
+	}
+	return 0;
+}
+
+static int replay_rail(const char *arg)
+{
+	static const char *const names[SIM_RAIL_NUM] = {"vcc", "main", "vdd", "cur"};
+	char name[8];
+	unsigned long value;
+	int i;
+
+	if (sscanf(arg, "%7[^=]=%lu", name, &value) != 2)
+		return 0;
+	for (i = 0; i < SIM_RAIL_NUM; i++)
+	{
+		if (strcmp(names[i], name) == 0)
+		{
+			Sim_Rail_mV[i] = (uint32_t)value;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+// 同 main.c test_Init 中仿真到的部分
+static void replay_init(int argc, char **argv)
+{
+	int i;
+
+	UART1_MF_Config_Init();
+	UART0_MF_Config_Init();
+	TONGXIN_Init();
+	flash_sim_reset();
+	fal_init();
+	JigConfig_SetTimeSource(time_get_us);
+	JigConfig_Init();
+	for (i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "-c") == 0 && !replay_config(argv[i + 1]))
+		{
+			fprintf(stderr, "bad config %s\n", argv[i + 1]);
+			exit(1);
+		}
+	}
+	Debug_Mode = JigConfig_Get(JIG_CFG_DEBUG_MODE);
+	test_jihua_Init();
+	StepProf_SetTimeSource(time_get_us);
+	StepExec_SetTimeSource(time_get_us);
+	gongwei_jiance();
+	test_start_Init();
+	PC_xieyi_Init();
+	Bus_Init();
+	Push_Init();
+}
+
+int main(int argc, char **argv)
+{
+	struct Sim_Rx *rx;
+	uint32_t rx_count;
+	uint32_t loop_us = 20;
+	uint64_t end_us = 0;
+	uint32_t i;
+	int a;
+
+	for (a = 1; a + 1 < argc; a += 2)
+	{
+		if (strcmp(argv[a], "-r") == 0 && !replay_rail(argv[a + 1]))
+		{
+			fprintf(stderr, "bad rail %s\n", argv[a + 1]);
+			return 1;
+		}
+		else if (strcmp(argv[a], "-l") == 0)
+			loop_us = (uint32_t)atoi(argv[a + 1]);
+		else if (strcmp(argv[a], "-e") == 0)
+			end_us = strtoull(argv[a + 1], NULL, 10);
+	}
+	if (loop_us == 0)
+		loop_us = 1;
+
+	rx = replay_load(&rx_count);
+	replay_init(argc, argv);
+
+	// 输入时间以初始化完成后的下一个节拍为0
+	replay_base_us = (Sim_Now_us() / 1000 + 1) * 1000;
+	for (i = 0; i < rx_count; i++)
+		rx[i].t_us += replay_base_us;
+	if (end_us == 0 && rx_count > 0)
+		end_us = rx[rx_count - 1].t_us - replay_base_us + 2000000;
+	Sim_Rx_Set(rx, rx_count);
+	Sim_Run_To(replay_base_us - 1);
+	replay_recording = 1;
+
+	while (Sim_Now_us() < replay_base_us + end_us)
+	{
+		Uart1_Rx_rec();
+		Bus_Process();
+		Push_Process();
+		Trace_Process();
+		Uart0_Rx_rec();
+		ProtocolManager_Process();
+		test_Loop_Func();
+		// 主循环一圈的时间, 然后 Idle_Sleep
+		Sim_Run_To(Sim_Now_us() + loop_us);
+		Sim_Wait_Irq();
+	}
+	printf("end %lu %lu %lu %d\n", (unsigned long)Sim_Rx_Done(), (unsigned long)Sim_Rx_Dropped(),
+		   (unsigned long)Sim_Pc55_Count, (int)Test_liucheng_L);
+	free(rx);
+	return 0;
+}
@@ -0,0 +1,24 @@
+/**
+ * @file sim_jig.h
+ * @brief 仿真中不运行的工装模块的设定值 (jig_stubs.c, 本机运行)
+ */
+#ifndef __SIM_JIG_H__
+#define __SIM_JIG_H__
+#include "main.h"
+
+enum Sim_Rail
+{
+	SIM_RAIL_VCC = 0, // ADC_RAIL_VCC
+	SIM_RAIL_MAIN,    // ADC_RAIL_GONGDIAN
+	SIM_RAIL_VDD,     // ADC_RAIL_ERJI
+	SIM_RAIL_CURRENT, // Current_CHK_Func (uA)
+	SIM_RAIL_NUM
+};
+
+// ADC/INA219 读数 (mV, 电流为uA), 默认在内置计划的合格范围内
+extern uint32_t Sim_Rail_mV[SIM_RAIL_NUM];
+// 接地的工位拨码 (FL_GPIO_PIN_x 位), 0=都不接
+extern uint8_t Sim_Gongwei_Pin;
+// 收到的 0x55 帧 (仿真中不处理)
+extern uint32_t Sim_Pc55_Count;
+#endif
@@ -0,0 +1,413 @@
+/**
+ * @file uart_sim.c
+ * @brief 模拟时钟和串口 (替代 Src/Uart_Ctrl.c 和 Src/time.c, 本机运行)
+ *
+ * 见 uart_sim.h。中断按时间顺序在 Sim_Run_To 中处理, 同一时刻先节拍、再发送、后接收。
+ */
+
+#include "uart_sim.h"
+#include "Uart_Ctrl.h"
+#include "time.h"
+#include "Test_List.h"
+#include "Trace_Ctrl.h"
+#include "Idle_Ctrl.h"
+
+#define SIM_NEVER UINT64_MAX
+
+volatile uint32_t time_ms_count = 0;
+
+static uint64_t sim_us = 0;
+
+static const struct Uart_Port *uart_port_list[UART_PORT_MAX];
+static uint8_t uart_port_num = 0;
+
+// 各端口发送移位寄存器
+static struct
+{
+	uint64_t done_us; // 当前字节移出的时刻, SIM_NEVER=空闲
+	uint32_t byte_us; // 每字节时间 (10位)
+	uint8_t it;       // 发送中断使能
+} sim_tx[UART_PORT_MAX];
+
+static const struct Sim_Rx *sim_rx_list;
+static uint32_t sim_rx_count;
+static uint32_t sim_rx_pos;
+static uint32_t sim_rx_drop;
+
+uint32_t time_get_us(void)
+{
+	return (uint32_t)sim_us;
+}
+
+uint64_t Sim_Now_us(void)
+{
+	return sim_us;
+}
+
+static int uart_sim_index(const struct Uart_Port *port)
+{
+	uint8_t i;
+	for (i = 0; i < uart_port_num; i++)
+	{
+		if (uart_port_list[i] == port)
+			return i;
+	}
+	return -1;
+}
+
+// 写发送寄存器: 录制并开始移位
+static void uart_sim_write(const struct Uart_Port *port, uint8_t data)
+{
+	int i = uart_sim_index(port);
+
+	Trace_Byte(port->trace_port, TRACE_DIR_TX, data);
+	sim_tx[i].done_us = sim_us + sim_tx[i].byte_us;
+	sim_tx[i].it = 1;
+}
+
+void Uart_Init(const struct Uart_Port *port)
+{
+	memset(port->state, 0, sizeof(*port->state));
+	if (uart_port_num < UART_PORT_MAX)
+	{
+		sim_tx[uart_port_num].done_us = SIM_NEVER;
+		sim_tx[uart_port_num].byte_us = (uint32_t)(10000000UL / port->baud);
+		uart_port_list[uart_port_num++] = port;
+	}
+}
+
+// 同 Uart_IRQ 的接收分支 (不透传)
+static void uart_sim_rx_isr(const struct Uart_Port *port, uint8_t data)
+{
+	struct Uart_State *s = port->state;
+
+	Trace_Byte(port->trace_port, TRACE_DIR_RX, data);
+	if (port->on_rx_byte != NULL)
+	{
+		port->on_rx_byte();
+	}
+	if (s->rx_count < port->rx_size)
+	{
+		port->rx_buf[s->rx_count++] = data;
+	}
+	else
+	{
+		s->rx_overflow = 1;
+	}
+	s->rx_flag = 1;
+	s->rx_timer = port->frame_ms;
+	Idle_Wake_Mark(port->wake_src);
+}
+
+// 同 Uart_IRQ 的发送分支: 上一字节移出后取下一字节
+static void uart_sim_tx_isr(const struct Uart_Port *port)
+{
+	struct Uart_State *s = port->state;
+	int i = uart_sim_index(port);
+	uint8_t data;
+
+	sim_tx[i].done_us = SIM_NEVER;
+	if (!sim_tx[i].it)
+	{
+		return;
+	}
+	if (s->tx_async)
+	{
+		if (port->tx_fetch(&data))
+		{
+			uart_sim_write(port, data);
+		}
+		else
+		{
+			s->tx_async = 0;
+		}
+	}
+	else if (s->tx_opc < s->tx_len)
+	{
+		uart_sim_write(port, port->tx_buf[s->tx_opc++]);
+	}
+	// 最后一字节写入后即关闭发送中断, 该字节仍在移位
+	if (!s->tx_async && s->tx_opc == s->tx_len)
+	{
+		sim_tx[i].it = 0;
+		s->tx_done = 1;
+	}
+}
+
+// 同 ATIM_IRQHandler
+static void sim_tick(void)
+{
+	time_ms_count++;
+	Uart_Tick();
+	if (Test_quanju_canshu_L.time_softdelay_ms > 0)
+	{
+		Test_quanju_canshu_L.time_softdelay_ms--;
+	}
+	if (Test_quanju_canshu_L.time_aroundtest_ms > 0)
+	{
+		Test_quanju_canshu_L.time_aroundtest_ms--;
+	}
+}
+
+static const struct Uart_Port *uart_sim_port(uint8_t trace_port)
+{
+	uint8_t i;
+	for (i = 0; i < uart_port_num; i++)
+	{
+		if (uart_port_list[i]->trace_port == trace_port)
+			return uart_port_list[i];
+	}
+	return NULL;
+}
+
+// 下一个中断的时刻和来源: 0=节拍 1=发送 2=接收
+static uint64_t sim_next_event(uint8_t *src, uint8_t *index)
+{
+	uint64_t next = (uint64_t)(time_ms_count + 1) * 1000;
+	uint8_t i;
+
+	*src = 0;
+	for (i = 0; i < uart_port_num; i++)
+	{
+		if (sim_tx[i].done_us < next)
+		{
+			next = sim_tx[i].done_us;
+			*src = 1;
+			*index = i;
+		}
+	}
+	if (sim_rx_pos < sim_rx_count && sim_rx_list[sim_rx_pos].t_us < next)
+	{
+		next = sim_rx_list[sim_rx_pos].t_us;
+		*src = 2;
+	}
+	return next;
+}
+
+static void sim_event(uint8_t src, uint8_t index)
+{
+	const struct Sim_Rx *rx;
+	const struct Uart_Port *port;
+
+	if (src == 0)
+	{
+		sim_tick();
+	}
+	else if (src == 1)
+	{
+		uart_sim_tx_isr(uart_port_list[index]);
+	}
+	else
+	{
+		rx = &sim_rx_list[sim_rx_pos++];
+		port = uart_sim_port(rx->port);
+		if (port != NULL)
+			uart_sim_rx_isr(port, rx->data);
+		else
+			sim_rx_drop++;
+	}
+}
+
+void Sim_Run_To(uint64_t t_us)
+{
+	uint64_t next;
+	uint8_t src;
+	uint8_t index = 0;
+
+	while ((next = sim_next_event(&src, &index)) <= t_us)
+	{
+		if (next > sim_us)
+			sim_us = next;
+		sim_event(src, index);
+	}
+	if (t_us > sim_us)
+		sim_us = t_us;
+}
+
+void Sim_Wait_Irq(void)
+{
+	uint8_t src;
+	uint8_t index = 0;
+	uint64_t next = sim_next_event(&src, &index);
+
+	if (next > sim_us)
+		sim_us = next;
+	sim_event(src, index);
+}
+
+uint8_t Sim_Wait_Irq_Until(uint64_t t_us)
+{
+	uint8_t src;
+	uint8_t index = 0;
+	uint64_t next = sim_next_event(&src, &index);
+
+	if (next > t_us)
+	{
+		if (t_us > sim_us)
+			sim_us = t_us;
+		return 0;
+	}
+	if (next > sim_us)
+		sim_us = next;
+	sim_event(src, index);
+	return 1;
+}
+
+void Sim_Rx_Set(const struct Sim_Rx *list, uint32_t count)
+{
+	sim_rx_list = list;
+	sim_rx_count = count;
+	sim_rx_pos = 0;
+	sim_rx_drop = 0;
+}
+
+void Sim_Rx_Grow(const struct Sim_Rx *list, uint32_t count)
+{
+	sim_rx_list = list;
+	sim_rx_count = count;
+}
+
+uint32_t Sim_Rx_Done(void)
+{
+	return sim_rx_pos;
+}
+
+uint32_t Sim_Rx_Dropped(void)
+{
+	return sim_rx_drop;
+}
+
+void FL_DelayMs(uint32_t ms)
+{
+	Sim_Run_To(sim_us + (uint64_t)ms * 1000);
+}
+
+/*============ Uart_Ctrl.h ============*/
+
+uint8_t Uart_Send(const struct Uart_Port *port, uint8_t data[], uint16_t lenth)
+{
+	struct Uart_State *s = port->state;
+	uint32_t start;
+
+	if (lenth == 0 || lenth > port->tx_size)
+	{
+		return 0;
+	}
+	if (s->tx_len != s->tx_opc || s->tx_async)
+	{
+		start = time_ms_count;
+		while ((s->tx_len != s->tx_opc || s->tx_async) && time_ms_count - start < port->tx_wait_ms)
+		{
+			Sim_Wait_Irq();
+		}
+	}
+	if (s->tx_len != s->tx_opc || s->tx_async)
+	{
+		return 0;
+	}
+	FL_DelayMs(port->tx_guard_ms);
+	memcpy(port->tx_buf, data, lenth);
+	s->tx_done = 0;
+	s->tx_len = lenth;
+	s->tx_opc = 1;
+	uart_sim_write(port, port->tx_buf[0]);
+	return 1;
+}
+
+void Uart_Tx_AsyncKick(const struct Uart_Port *port)
+{
+	struct Uart_State *s = port->state;
+	uint8_t data;
+
+	if (port->tx_fetch == NULL || s->tx_async || s->tx_len != s->tx_opc)
+	{
+		return;
+	}
+	if (!port->tx_fetch(&data))
+	{
+		return;
+	}
+	s->tx_async = 1;
+	s->tx_done = 0;
+	uart_sim_write(port, data);
+}
+
+void Uart_Poll(const struct Uart_Port *port)
+{
+	struct Uart_State *s = port->state;
+	uint16_t lenth;
+
+	if (s->tx_done)
+	{
+		s->tx_done = 0;
+		if (port->de_mode != UART_DE_NONE)
+		{
+			FL_DelayMs(port->tx_guard_ms);
+		}
+	}
+	if (s->rx_flag == 1 && s->rx_timer == 0)
+	{
+		lenth = s->rx_count;
+		memcpy(port->frame_buf, port->rx_buf, lenth);
+		s->rx_count = 0;
+		s->rx_flag = 0;
+		if (s->rx_overflow)
+		{
+			s->rx_overflow = 0;
+			s->overflow_count++;
+		}
+		port->on_frame(port->frame_buf, lenth);
+	}
+}
+
+uint8_t Uart_Kongxian(const struct Uart_Port *port)
+{
+	struct Uart_State *s = port->state;
+	return (s->rx_flag == 0 && s->tx_len == s->tx_opc && s->tx_async == 0);
+}
+
+void Uart_Tick(void)
+{
+	uint8_t i;
+	struct Uart_State *s;
+
+	for (i = 0; i < uart_port_num; i++)
+	{
+		s = uart_port_list[i]->state;
+		if (s->rx_timer > 0)
+		{
+			s->rx_timer--;
+		}
+	}
+}
+
+void Uart_IRQ(const struct Uart_Port *port)
+{
+	(void)port;
+}
+
+uint8_t Uart_Bridge_Start(const struct Uart_Port *a, const struct Uart_Port *b, const uint8_t *escape, uint8_t escape_len)
+{
+	(void)a;
+	(void)b;
+	(void)escape;
+	(void)escape_len;
+	return 0;
+}
+
+void Uart_Bridge_Stop(const struct Uart_Port *port)
+{
+	(void)port;
+}
+
+uint8_t Uart_Bridge_Active(const struct Uart_Port *port)
+{
+	(void)port;
+	return 0;
+}
+
+void Uart_Bridge_Get_tongji(const struct Uart_Port *port, struct Uart_Bridge_tongji *out)
+{
+	(void)port;
+	memset(out, 0, sizeof(*out));
+}
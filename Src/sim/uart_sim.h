@@ -0,0 +1,40 @@
+/**
+ * @file uart_sim.h
+ * @brief 模拟时钟和串口 (替代 Src/Uart_Ctrl.c 和 Src/time.c, 本机运行)
+ *
+ * uart0.c/uart1.c 的端口描述符照常通过 Uart_Init 注册, 收发按 Src/Uart_Ctrl.c:
+ *   - 接收中断: Trace_Byte、on_rx_byte、存入 rx_buf, 帧间隔 frame_ms 由1ms节拍倒计时
+ *   - 发送中断: 每字节10位, 逐字节从 tx_buf 或 tx_fetch 取数, 写入时 Trace_Byte
+ *   - Uart_Send: 上一包未发完时忙等 (最多 tx_wait_ms), 发送前延时 tx_guard_ms
+ *   - Uart_Poll: 发完释放总线前延时 tx_guard_ms, 帧结束时调用 on_frame
+ * 1ms节拍同 ATIM 中断: time_ms_count、Uart_Tick、测试流程软延时/总超时倒计时。
+ * 透传 (Uart_Bridge_xxx) 不模拟, 启动总是失败。
+ */
+#ifndef __UART_SIM_H__
+#define __UART_SIM_H__
+#include "main.h"
+
+// 外部输入的一个字节 (被测设备/上位机发给工装), 按时间排序
+struct Sim_Rx
+{
+	uint64_t t_us;
+	uint8_t port; // TRACE_PORT_xxx
+	uint8_t data;
+};
+
+// 设置输入序列, 到时刻后进入对应端口的接收中断 (未注册的端口计入丢弃)
+void Sim_Rx_Set(const struct Sim_Rx *list, uint32_t count);
+// 输入序列在末尾追加了条目 (list 可能已重新分配), 已送入的条目不重复送入
+void Sim_Rx_Grow(const struct Sim_Rx *list, uint32_t count);
+// 已送入接收中断的输入条数 / 因端口未注册丢弃的条数
+uint32_t Sim_Rx_Done(void);
+uint32_t Sim_Rx_Dropped(void);
+
+uint64_t Sim_Now_us(void);
+// 推进模拟时钟到 t_us, 期间按时间顺序处理节拍、收发中断
+void Sim_Run_To(uint64_t t_us);
+// 主循环休眠 (同 Idle_Sleep 的 WFI): 推进到下一个中断
+void Sim_Wait_Irq(void);
+// 同 Sim_Wait_Irq, 但下一个中断晚于 t_us 时只推进到 t_us 并返回0 (仍在休眠)
+uint8_t Sim_Wait_Irq_Until(uint64_t t_us);
+#endif
@@ -1,16 +1,14 @@
 #include "main.h"
 #include "time.h"
-#include "uart5.h"
-#include "uart1.h"
-#include "uart0.h"
+#include "Uart_Ctrl.h"
 #include "Test_List.h"
 #include "LED_CTRL.h"
+#include "WTD.h"
 
-extern uint16_t uart5_Rec_shuju_time_count;
-extern uint16_t uart1_Rec_shuju_time_count;
-extern uint8_t LED_thing_time;
-extern uint16_t uart0_Rec_shuju_time_count;
 extern uint16_t Debug_print_time;
+
+// 上电后的毫秒计数 (ATIM 1ms中断递增)，配合计数器值得到微秒时间戳
+volatile uint32_t time_ms_count = 0;
 void MF_ATIM_TimerBase_Init(void)
 {
 	FL_ATIM_InitTypeDef TimerBase_InitStruct;
@@ -62,18 +60,10 @@ void ATIM_IRQHandler()
 	if (FL_ATIM_IsEnabledIT_Update(ATIM) && FL_ATIM_IsActiveFlag_Update(ATIM))
 	{
 		FL_ATIM_ClearFlag_Update(ATIM);
-		if (uart5_Rec_shuju_time_count > 0)
-		{
-			uart5_Rec_shuju_time_count--;
-		}
-		if (uart1_Rec_shuju_time_count > 0)
-		{
-			uart1_Rec_shuju_time_count--;
-		}
-		if (uart0_Rec_shuju_time_count > 0)
-		{
-			uart0_Rec_shuju_time_count--;
-		}
+		time_ms_count++;
+		WDT_Tick();
+		// 各串口接收帧间隔超时
+		Uart_Tick();
 		if (Test_quanju_canshu_L.time_softdelay_ms > 0)
 		{
 			Test_quanju_canshu_L.time_softdelay_ms--;
@@ -82,17 +72,29 @@ void ATIM_IRQHandler()
 		{
 			Test_quanju_canshu_L.time_aroundtest_ms--;
 		}
-		if (LED_thing_time > 0)
-		{
-			LED_thing_time--;
-		}
-		if (chaoshi_dengdai > 0)
-		{
-			chaoshi_dengdai--;
-		}
 		if (Debug_print_time > 0)
 		{
 			Debug_print_time--;
 		}
 	}
 }
+
+// 读取微秒时间戳 (ATIM 计数器 1MHz, 0~999 循环)
+uint32_t time_get_us(void)
+{
+	uint32_t ms;
+	uint32_t cnt;
+
+	do
+	{
+		ms = time_ms_count;
+		cnt = FL_ATIM_ReadCounter(ATIM);
+	} while (ms != time_ms_count);
+
+	// 计数器已回绕但更新中断尚未处理 (如在关中断或更高优先级中断中调用)
+	if (FL_ATIM_IsActiveFlag_Update(ATIM) && cnt < 500)
+	{
+		ms++;
+	}
+	return ms * 1000 + cnt;
+}
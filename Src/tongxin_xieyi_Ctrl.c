@@ -3,6 +3,8 @@
 #include "uart1.h"
 #include "uart0.h"
 #include "Test_List.h"
+#include "time.h"
+#include "Protocol/protocol_manager.h"
 
 uint8_t NTST_SET[] = "NTST 000000000000\r\n";
 uint8_t ICDC_SET[] = "ICDC\r\n";
@@ -27,6 +29,33 @@ uint8_t bijiao_zifuchuan(uint8_t bijiao1[], uint8_t bijiao2[], uint16_t lenth)
 	return 1;
 }
 
+static uint32_t tongxin_tick(void)
+{
+	return time_ms_count;
+}
+
+// 异步发送完成回调 (ProtocolManager_Process 中调用)
+static void tongxin_fasong_wancheng(bool success, uint32_t elapsed_ms)
+{
+	if (!success)
+	{
+		DeBug_print("FT_TX timeout %lums\r\n", (unsigned long)elapsed_ms);
+	}
+}
+
+void TONGXIN_Init(void)
+{
+	static const ProtocolAsyncTxPort port = {
+		.tx_kick = Uart0_Tx_AsyncKick,
+		.get_tick = tongxin_tick,
+	};
+
+	ProtocolManager_Init();
+	ProtocolManager_SetDeviceSendFunc(Uart0_Tx_Send);
+	ProtocolManager_SetDeviceAsyncTx(&port);
+	ProtocolManager_SetTxDoneCallback(tongxin_fasong_wancheng);
+}
+
 void TONGXIN_xieyijiexi(uint8_t zufuchua[], uint16_t lenth)
 {
 	uint16_t pHead = 0;
@@ -99,12 +128,12 @@ void TONGXIN_xieyijiexi(uint8_t zufuchua[], uint16_t lenth)
 void TONGXIN_xieyifasong_NTST()
 {
 	memcpy(&NTST_SET[5], Test_jiejuo_jilu.zhuji_MAC, 12);
-	Uart0_Tx_Send(NTST_SET, sizeof(NTST_SET) - 1);
+	ProtocolManager_Device_SendRaw(NTST_SET, sizeof(NTST_SET) - 1);
 	PC_Chuankou_tongxin_Debug_send(NTST_SET, sizeof(NTST_SET) - 1);
 }
 
 void TONGXIN_xieyifasong_ICDC()
 {
-	Uart0_Tx_Send(ICDC_SET, sizeof(ICDC_SET) - 1);
+	ProtocolManager_Device_SendRaw(ICDC_SET, sizeof(ICDC_SET) - 1);
 	// PC_Chuankou_tongxin_Debug_send(ICDC_SET,sizeof(ICDC_SET)-1);
 }
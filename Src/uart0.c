@@ -1,176 +1,84 @@
 #include "main.h"
 #include "uart0.h"
-#include "uart5.h"
-#include "time.h"
 #include "uart1.h"
+#include "Uart_Ctrl.h"
 #include "LED_CTRL.h"
 #include "tongxin_xieyi_Ctrl.h"
+#include "Protocol/protocol_manager.h"
+#include "Idle_Ctrl.h"
+#include "Trace_Ctrl.h"
 #define lenth_Receive_Send_MAX 200
 #define lenth_Receive_MAX 512 // UART0 RX buffer needs to be larger to handle DUT verbose output
+// 透传时接收缓冲兼作 UART0->UART1 环形缓冲: 115200 收 9600 发, 突发B字节最多积压
+// B * (1 - 9600/115200) = 0.917B, 511字节可用空间可承受约557字节的连续突发
 
-uint8_t uart0_Rec_shuju_flag = 0;
-uint8_t uart0_Rec_shuju_neirong[lenth_Receive_MAX];
-uint16_t uart0_Rec_shuju_neirong_count = 0;
-uint8_t uart0_Rec_overflow = 0; // 溢出标志
-uint8_t uart0_Uart0_Tx_SendData[lenth_Receive_MAX];
-uint8_t send_data_zancun_0[lenth_Receive_Send_MAX];
-// 这一步需要注册到time时钟里
-uint16_t uart0_Rec_shuju_time_count = 0;
+static uint8_t uart0_Rec_shuju_neirong[lenth_Receive_MAX];
+static uint8_t uart0_Uart0_Tx_SendData[lenth_Receive_MAX];
+static uint8_t send_data_zancun_0[lenth_Receive_Send_MAX];
+static struct Uart_State uart0_state;
 
-struct UARTOpStruct UART0Op;
-
-void UART0_IRQHandler(void)
+// 被测设备应答: 转发到调试口后解析
+static void uart0_frame(uint8_t zufuchua[], uint16_t lenth)
 {
-    uint32_t UART0RXBuffFullIT = 0;
-    uint32_t UART0RXBuffFullFlag = 0;
-    uint32_t UART0TXBuffFullIT = 0;
-    uint32_t UART0TXBuffFullFlag = 0;
-
-    UART0RXBuffFullIT = FL_UART_IsEnabledIT_RXBuffFull(UART0);
-    UART0RXBuffFullFlag = FL_UART_IsActiveFlag_RXBuffFull(UART0);
-    UART0TXBuffFullIT = FL_UART_IsEnabledIT_TXShiftBuffEmpty(UART0);
-    UART0TXBuffFullFlag = FL_UART_IsActiveFlag_TXShiftBuffEmpty(UART0);
-
-    // 接收中断处理
-    if ((UART0RXBuffFullIT == 0x01UL) && (UART0RXBuffFullFlag == 0x01UL))
-    {
-        // 中断接收
-        uint8_t rx_byte = FL_UART_ReadRXBuff(UART0); // 接收中断标志可通过读取rxreg寄存器清除
-        if (uart0_Rec_shuju_neirong_count < lenth_Receive_MAX)
-        {
-            uart0_Rec_shuju_neirong[uart0_Rec_shuju_neirong_count] = rx_byte;
-            uart0_Rec_shuju_neirong_count++;
-        }
-        else
-        {
-            uart0_Rec_overflow = 1; // 缓冲区满，丢弃新数据
-        }
-        uart0_Rec_shuju_flag = 1;
-        uart0_Rec_shuju_time_count = 100;
-    }
-
-    // 发送中断处理
-    if ((UART0TXBuffFullIT == 0x01UL) && (UART0TXBuffFullFlag == 0x01UL))
-    {
-        // 发送中断标志可通过写txreg寄存器清除或txif写1清除
-        // 发送指定长度的数据
-        if (UART0Op.TxOpc < UART0Op.TxLen)
-        {
-            FL_UART_WriteTXBuff(UART0, UART0Op.TxBuf[UART0Op.TxOpc]); // 发送一个数据
-            UART0Op.TxOpc++;
-        }
+    LED_FLAG_Run();
+    DeBug_print("FT_RX[%d]: ", lenth);
+    PC_Chuankou_tongxin_Debug_send(zufuchua, lenth);
+    DeBug_print("\r\n");
+    TONGXIN_xieyijiexi(zufuchua, lenth);
+}
 
-        FL_UART_ClearFlag_TXShiftBuffEmpty(UART0); // 清除发送中断标志
+// 被测设备串口 PA13/PA14 115200
+const struct Uart_Port uart0_port = {
+    .uart = UART0,
+    .irq = UART0_IRQn,
+    .priority = 0x00,
+    .baud = 115200,
+    .gpio = GPIOA,
+    .rx_pin = FL_GPIO_PIN_13,
+    .tx_pin = FL_GPIO_PIN_14,
+    .rx_pull = 1,
+    .de_mode = UART_DE_NONE,
+    .rx_buf = uart0_Rec_shuju_neirong,
+    .frame_buf = uart0_Uart0_Tx_SendData,
+    .rx_size = lenth_Receive_MAX,
+    .tx_buf = send_data_zancun_0,
+    .tx_size = lenth_Receive_Send_MAX,
+    .frame_ms = 100,
+    .tx_wait_ms = 100,
+    .tx_guard_ms = 1,
+    .trace_port = TRACE_PORT_UART0,
+    .wake_src = IDLE_WAKE_UART0,
+    .on_frame = uart0_frame,
+    // 异步任务: 前导码由协议管理器逐字节生成，无需拷贝
+    .tx_fetch = ProtocolManager_TxIsrFetch,
+    .state = &uart0_state,
+};
 
-        if (UART0Op.TxOpc == UART0Op.TxLen)
-        {
-            FL_UART_DisableIT_TXShiftBuffEmpty(UART0);
-        }
-    }
-}
-void Uart0_Tx_Send_init()
+void UART0_IRQHandler(void)
 {
-    UART0Op.TxLen = 1;
-    UART0Op.TxOpc = 1;
+    Uart_IRQ(&uart0_port);
 }
 
 void Uart0_Tx_Send(uint8_t zufuchua[], uint16_t lenth)
 {
-    if (lenth == 0 || lenth > lenth_Receive_Send_MAX)
-    {
-        return;
-    }
-    chaoshi_dengdai = 100;
-    while (UART0Op.TxLen != UART0Op.TxOpc && chaoshi_dengdai != 0)
-    {
-    }
-    if (UART0Op.TxLen != UART0Op.TxOpc)
-    {
-        return; // 超时退出，上一次发送未完成
-    }
-    FL_DelayMs(1);
-    memcpy(send_data_zancun_0, zufuchua, lenth);
-    // 中断发送数组
-    UART0Op.TxBuf = send_data_zancun_0;
-    UART0Op.TxLen = lenth;
-    UART0Op.TxOpc = 0 + 1;
-    FL_UART_ClearFlag_TXShiftBuffEmpty(UART0);
-    FL_UART_EnableIT_TXShiftBuffEmpty(UART0);
-    FL_UART_WriteTXBuff(UART0, UART0Op.TxBuf[0]);
-}
-
-void MF_UART0_Init(void)
-{
-    FL_GPIO_InitTypeDef GPIO_InitStruct;
-
-    FL_UART_InitTypeDef UART0_InitStruct;
-
-    GPIO_InitStruct.pin = FL_GPIO_PIN_13;
-    GPIO_InitStruct.mode = FL_GPIO_MODE_DIGITAL;
-    GPIO_InitStruct.outputType = FL_GPIO_OUTPUT_PUSHPULL;
-    GPIO_InitStruct.pull = FL_ENABLE;
-    GPIO_InitStruct.remapPin = FL_DISABLE;
-    GPIO_InitStruct.analogSwitch = FL_DISABLE;
-    (void)FL_GPIO_Init(GPIOA, &GPIO_InitStruct);
-
-    GPIO_InitStruct.pin = FL_GPIO_PIN_14;
-    GPIO_InitStruct.mode = FL_GPIO_MODE_DIGITAL;
-    GPIO_InitStruct.outputType = FL_GPIO_OUTPUT_PUSHPULL;
-    GPIO_InitStruct.pull = FL_DISABLE;
-    GPIO_InitStruct.remapPin = FL_DISABLE;
-    GPIO_InitStruct.analogSwitch = FL_DISABLE;
-    (void)FL_GPIO_Init(GPIOA, &GPIO_InitStruct);
-
-    UART0_InitStruct.clockSrc = FL_CMU_UART0_CLK_SOURCE_APBCLK;
-    UART0_InitStruct.baudRate = 115200;
-    UART0_InitStruct.transferDirection = FL_UART_DIRECTION_TX_RX;
-    UART0_InitStruct.dataWidth = FL_UART_DATA_WIDTH_8B;
-    UART0_InitStruct.stopBits = FL_UART_STOP_BIT_WIDTH_1B;
-    UART0_InitStruct.parity = FL_UART_PARITY_NONE;
-
-    (void)FL_UART_Init(UART0, &UART0_InitStruct);
+    Uart_Send(&uart0_port, zufuchua, lenth);
 }
 
-void MF_UART0_Interrupt_Init(void)
+/**
+ * @brief 启动异步发送 (ProtocolAsyncTxPort.tx_kick)
+ * @note 发送中断仍在运行时不重复启动，由中断继续取字节
+ */
+void Uart0_Tx_AsyncKick(void)
 {
-    FL_UART_ClearFlag_RXBuffFull(UART0);
-    FL_UART_EnableIT_RXBuffFull(UART0);
-
-    FL_UART_ClearFlag_TXShiftBuffEmpty(UART0);
-    FL_UART_EnableIT_TXShiftBuffEmpty(UART0);
-}
-void UART0_MF_NVIC_Init(void)
-{
-    FL_NVIC_ConfigTypeDef InterruptConfigStruct;
-
-    InterruptConfigStruct.preemptPriority = 0x00;
-    FL_NVIC_Init(&InterruptConfigStruct, UART0_IRQn);
+    Uart_Tx_AsyncKick(&uart0_port);
 }
 
 void UART0_MF_Config_Init(void)
 {
-    /* Initial UART0 */
-    MF_UART0_Init();
-    MF_UART0_Interrupt_Init();
-
-    /* Initial NVIC */
-    UART0_MF_NVIC_Init();
-    Uart0_Tx_Send_init();
+    Uart_Init(&uart0_port);
 }
+
 void Uart0_Rx_rec()
 {
-    if (uart0_Rec_shuju_flag == 1 && uart0_Rec_shuju_time_count == 0)
-    {
-        uint16_t rx_len = uart0_Rec_shuju_neirong_count;
-        LED_FLAG_Run();
-        uart0_Rec_shuju_flag = 0;
-        // 对返回数据进行解析
-        memcpy(uart0_Uart0_Tx_SendData, uart0_Rec_shuju_neirong, rx_len);
-        uart0_Rec_shuju_neirong_count = 0;
-        uart0_Rec_overflow = 0;
-        DeBug_print("FT_RX[%d]: ", rx_len);
-        PC_Chuankou_tongxin_Debug_send(uart0_Uart0_Tx_SendData, rx_len);
-        DeBug_print("\r\n");
-        TONGXIN_xieyijiexi(uart0_Uart0_Tx_SendData, rx_len);
-    }
+    Uart_Poll(&uart0_port);
 }
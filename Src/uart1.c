@@ -1,200 +1,78 @@
 #include "main.h"
 #include "uart1.h"
 #include "stdarg.h"
-#include "uart5.h"
-#include "time.h"
+#include "Uart_Ctrl.h"
 #include "LED_CTRL.h"
 #include "PC_xieyi_Ctrl.h"
-#define lenth_Receive_Send_MAX 200
-uint8_t send_over_flag = 1;
-
-uint8_t uart1_Rec_shuju_flag = 0;
-uint8_t uart1_Rec_shuju_neirong[lenth_Receive_Send_MAX];
-uint16_t uart1_Rec_shuju_neirong_count = 0;
-uint8_t uart1_Uart0_Tx_SendData[lenth_Receive_Send_MAX];
-uint8_t send_data_zancun_1[lenth_Receive_Send_MAX];
-// 这一步需要注册到time时钟里
-uint16_t uart1_Rec_shuju_time_count = 0;
-
-void UART_TX_state_change(uint8_t send_state)
+#include "Idle_Ctrl.h"
+#include "Trace_Ctrl.h"
+#include "Bus_Ctrl.h"
+// 0x55 帧长度字段为1字节, 最长255字节 (满8步的测试计划下载/读回为214字节)
+#define lenth_Receive_Send_MAX 256
+
+static uint8_t uart1_Rec_shuju_neirong[lenth_Receive_Send_MAX];
+static uint8_t uart1_Uart0_Tx_SendData[lenth_Receive_Send_MAX];
+static uint8_t send_data_zancun_1[lenth_Receive_Send_MAX];
+static struct Uart_State uart1_state;
+
+// 上位机命令
+static void uart1_frame(uint8_t zufuchua[], uint16_t lenth)
 {
-    FL_GPIO_InitTypeDef GPIO_InitStruct;
-    // 空闲态
-    if (send_state == 0)
-    {
-        GPIO_InitStruct.mode = FL_GPIO_MODE_INPUT;
-    }
-    else
-    {
-        GPIO_InitStruct.mode = FL_GPIO_MODE_DIGITAL;
-    }
-    GPIO_InitStruct.pin = FL_GPIO_PIN_3;
-    GPIO_InitStruct.outputType = FL_GPIO_OUTPUT_PUSHPULL;
-    GPIO_InitStruct.pull = FL_ENABLE;
-    GPIO_InitStruct.remapPin = FL_DISABLE;
-    GPIO_InitStruct.analogSwitch = FL_DISABLE;
-    (void)FL_GPIO_Init(GPIOC, &GPIO_InitStruct);
+    LED_FLAG_Run();
+    DeBug_print("\r\n*** UART1 RX: %d bytes ***\r\n", lenth);
+    PC_xieyijiexi(zufuchua, lenth);
 }
 
-struct UARTOpStruct UART1Op;
+// 上位机RS-485总线 PC2/PC3 9600, 空闲时TX脚设为输入释放总线
+const struct Uart_Port uart1_port = {
+    .uart = UART1,
+    .irq = UART1_IRQn,
+    .priority = 0x02,
+    .baud = 9600,
+    .gpio = GPIOC,
+    .rx_pin = FL_GPIO_PIN_2,
+    .tx_pin = FL_GPIO_PIN_3,
+    .rx_pull = 0,
+    .de_mode = UART_DE_TX_FLOAT,
+    .rx_buf = uart1_Rec_shuju_neirong,
+    .frame_buf = uart1_Uart0_Tx_SendData,
+    .rx_size = lenth_Receive_Send_MAX,
+    .tx_buf = send_data_zancun_1,
+    .tx_size = lenth_Receive_Send_MAX,
+    .frame_ms = BUS_RX_IDLE_MS,
+    .tx_wait_ms = 1000,
+    .tx_guard_ms = 5,
+    .trace_port = TRACE_PORT_UART1,
+    .wake_src = IDLE_WAKE_UART1,
+    .on_rx_byte = Bus_Rx_Mark,
+    .on_frame = uart1_frame,
+    .state = &uart1_state,
+};
 
 void UART1_IRQHandler(void)
 {
-    uint32_t UART1RXBuffFullIT = 0;
-    uint32_t UART1RXBuffFullFlag = 0;
-    uint32_t UART1TXBuffFullIT = 0;
-    uint32_t UART1TXBuffFullFlag = 0;
-
-    UART1RXBuffFullIT = FL_UART_IsEnabledIT_RXBuffFull(UART1);
-    UART1RXBuffFullFlag = FL_UART_IsActiveFlag_RXBuffFull(UART1);
-    UART1TXBuffFullIT = FL_UART_IsEnabledIT_TXShiftBuffEmpty(UART1);
-    UART1TXBuffFullFlag = FL_UART_IsActiveFlag_TXShiftBuffEmpty(UART1);
-
-    // 接收中断处理
-    if ((UART1RXBuffFullIT == 0x01UL) && (UART1RXBuffFullFlag == 0x01UL))
-    {
-        // 中断接收
-        uart1_Rec_shuju_neirong[uart1_Rec_shuju_neirong_count] = FL_UART_ReadRXBuff(UART1); // 接收中断标志可通过读取rxreg寄存器清除
-        uart1_Rec_shuju_neirong_count++;
-        if (uart1_Rec_shuju_neirong_count >= lenth_Receive_Send_MAX)
-        {
-            uart1_Rec_shuju_neirong_count = 0;
-        }
-        uart1_Rec_shuju_flag = 1;
-        uart1_Rec_shuju_time_count = 100; // 100ms超时
-    }
-
-    // 发送中断处理
-    if ((UART1TXBuffFullIT == 0x01UL) && (UART1TXBuffFullFlag == 0x01UL))
-    {
-        // 发送中断标志可通过写txreg寄存器清除或txif写1清除
-        // 发送指定长度的数据
-        if (UART1Op.TxOpc < UART1Op.TxLen)
-        {
-            FL_UART_WriteTXBuff(UART1, UART1Op.TxBuf[UART1Op.TxOpc]); // 发送一个数据
-            UART1Op.TxOpc++;
-        }
-
-        FL_UART_ClearFlag_TXShiftBuffEmpty(UART1); // 清除发送中断标志
-
-        if (UART1Op.TxOpc == UART1Op.TxLen)
-        {
-            FL_UART_DisableIT_TXShiftBuffEmpty(UART1);
-            send_over_flag = 1;
-        }
-    }
-}
-void Uart1_Tx_Send_init()
-{
-    UART1Op.TxLen = 1;
-    UART1Op.TxOpc = 1;
-    UART_TX_state_change(0);
+    Uart_IRQ(&uart1_port);
 }
 
 void Uart1_Tx_Send(uint8_t zufuchua[], uint16_t lenth)
 {
-    if (lenth == 0 || lenth > lenth_Receive_Send_MAX)
-    {
-        return;
-    }
-    chaoshi_dengdai = 1000;
-    // 多包发送时，会等待上一包发送完再发送下一包
-    while (UART1Op.TxLen != UART1Op.TxOpc && chaoshi_dengdai != 0)
-    {
-    }
-    if (UART1Op.TxLen != UART1Op.TxOpc)
-    {
-        return; // 超时退出，上一次发送未完成
-    }
-    FL_DelayMs(5);
-    memcpy(send_data_zancun_1, zufuchua, lenth);
-    send_over_flag = 0; // 清除上次发送完成标志，防止Uart1_Rx_rec提前切换GPIO方向
-    UART_TX_state_change(1);
-    // 中断发送数组
-    UART1Op.TxBuf = send_data_zancun_1;
-    UART1Op.TxLen = lenth;
-    UART1Op.TxOpc = 1;
-    FL_UART_ClearFlag_TXShiftBuffEmpty(UART1);
-    FL_UART_EnableIT_TXShiftBuffEmpty(UART1);
-    FL_UART_WriteTXBuff(UART1, UART1Op.TxBuf[0]);
-}
-
-void MF_UART1_Init(void)
-{
-    FL_GPIO_InitTypeDef GPIO_InitStruct;
-
-    FL_UART_InitTypeDef UART1_InitStruct;
-
-    GPIO_InitStruct.pin = FL_GPIO_PIN_2;
-    GPIO_InitStruct.mode = FL_GPIO_MODE_DIGITAL;
-    GPIO_InitStruct.outputType = FL_GPIO_OUTPUT_PUSHPULL;
-    GPIO_InitStruct.pull = FL_DISABLE;
-    GPIO_InitStruct.remapPin = FL_DISABLE;
-    GPIO_InitStruct.analogSwitch = FL_DISABLE;
-    (void)FL_GPIO_Init(GPIOC, &GPIO_InitStruct);
-
-    GPIO_InitStruct.pin = FL_GPIO_PIN_3;
-    GPIO_InitStruct.mode = FL_GPIO_MODE_DIGITAL;
-    GPIO_InitStruct.outputType = FL_GPIO_OUTPUT_PUSHPULL;
-    GPIO_InitStruct.pull = FL_DISABLE;
-    GPIO_InitStruct.remapPin = FL_DISABLE;
-    GPIO_InitStruct.analogSwitch = FL_DISABLE;
-    (void)FL_GPIO_Init(GPIOC, &GPIO_InitStruct);
-
-    UART1_InitStruct.clockSrc = FL_CMU_UART0_CLK_SOURCE_APBCLK;
-    UART1_InitStruct.baudRate = 9600;
-    UART1_InitStruct.transferDirection = FL_UART_DIRECTION_TX_RX;
-    UART1_InitStruct.dataWidth = FL_UART_DATA_WIDTH_8B;
-    UART1_InitStruct.stopBits = FL_UART_STOP_BIT_WIDTH_1B;
-    UART1_InitStruct.parity = FL_UART_PARITY_NONE;
-
-    (void)FL_UART_Init(UART1, &UART1_InitStruct);
+    Uart_Send(&uart1_port, zufuchua, lenth);
 }
 
-void MF_UART1_Interrupt_Init(void)
+// 串口空闲: 没有待解析的接收帧, 上一包已发完
+uint8_t Uart1_Kongxian(void)
 {
-    FL_UART_ClearFlag_RXBuffFull(UART1);
-    FL_UART_EnableIT_RXBuffFull(UART1);
-
-    FL_UART_ClearFlag_TXShiftBuffEmpty(UART1);
-    FL_UART_EnableIT_TXShiftBuffEmpty(UART1);
-}
-void UART1_MF_NVIC_Init(void)
-{
-    FL_NVIC_ConfigTypeDef InterruptConfigStruct;
-
-    InterruptConfigStruct.preemptPriority = 0x02;
-    FL_NVIC_Init(&InterruptConfigStruct, UART1_IRQn);
+    return Uart_Kongxian(&uart1_port);
 }
 
 void UART1_MF_Config_Init(void)
 {
-    /* Initial UART0 */
-    MF_UART1_Init();
-    MF_UART1_Interrupt_Init();
-
-    /* Initial NVIC */
-    UART1_MF_NVIC_Init();
-    Uart1_Tx_Send_init();
+    Uart_Init(&uart1_port);
 }
+
 void Uart1_Rx_rec()
 {
-    if (send_over_flag == 1)
-    {
-        send_over_flag = 0;
-        FL_DelayMs(5);
-        UART_TX_state_change(0);
-    }
-    if (uart1_Rec_shuju_flag == 1 && uart1_Rec_shuju_time_count == 0)
-    {
-        LED_FLAG_Run();
-        uart1_Rec_shuju_flag = 0;
-        // 对返回数据进行解析
-        DeBug_print("\r\n*** UART1 RX: %d bytes ***\r\n", uart1_Rec_shuju_neirong_count);
-        memcpy(uart1_Uart0_Tx_SendData, uart1_Rec_shuju_neirong, uart1_Rec_shuju_neirong_count);
-        PC_xieyijiexi(uart1_Uart0_Tx_SendData, uart1_Rec_shuju_neirong_count);
-        uart1_Rec_shuju_neirong_count = 0;
-    }
+    Uart_Poll(&uart1_port);
 }
 void DeBug_print(const char fmt[], ...)
 {
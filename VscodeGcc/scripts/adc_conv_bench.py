@@ -0,0 +1,232 @@
+#!/usr/bin/env python3
+"""
+ADC 码值换算 检查/基准 (Components/Utility util_ratio_init/util_ratio_mul, Src/ADC_CHK.c)
+
+Src/ADC_CHK.c 把 floor(code * 3000 * ADC_VREF / (vref * 4095)) 的64位除法换成
+预先计算的定点倒数 (每个VREF码值/每批一次) 加三次32位乘法和移位。本工具用本机
+gcc 编译 Components/Utility/sim/ratio_bench.c + utility_convert.c, 与原除法公式逐个比较:
+
+  check   穷举比较 (结果必须完全相同):
+            单次换算  ADC_VREF 出厂定标值 --vref-min..--vref-max x VREF码值 1..4095
+                      x 通道码值 0..4095
+            分压系数  JIG_CFG_ADC_SCALE 1000..50000 x 引脚mV 0..4095
+            批量换算  采样次数 1..16 x 分压倍数 x VREF之和 (每 --step 取一个)
+                      x 通道码值之和 0..次数*4095
+          "无法换算" 为 util_ratio_init 拒绝的参数, 固件中这些情况仍用除法
+  bench   本机每次换算耗时, 按 --mhz 换算为周期 (只作相对比较);
+          工装上的 周期/次 用 ADC_Conv_Benchmark() 打印到调试口
+  rail    经PC串口让工装执行 ADC_RailSet_Benchmark() (命令 68 A6 工位 采样次数 和校验 16):
+          6个 get_xxx_dianya() 逐个读取与一批 ADC_MeasureRailSet() 的实测耗时,
+          同时列出两者的转换次数; --log 把结果追加到文件 (每行一次测量)
+
+用法:
+  adc_conv_bench.py check [--vref-min 1500] [--vref-max 1800] [--step 251] [--cc gcc]
+  adc_conv_bench.py bench [--adc-vref 1638] [--rounds 200] [--mhz 3000] [--cc gcc]
+  adc_conv_bench.py rail --port /dev/ttyUSB0 --station 1 [--samples 1,4] [--log adc_rail.log]
+"""
+
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+UTIL_DIR = os.path.normpath(os.path.join(HERE, "..", "..", "Components", "Utility"))
+
+ADC_VREF = 1638      # VREF1P2 出厂定标码值 (3.0V 时)
+SCALE_MIN = 1000     # JIG_CFG_ADC_SCALE 范围
+SCALE_MAX = 50000
+
+HEAD = 0x68
+TAIL = 0x16
+RAIL_COUNT = 6       # ADC_RAIL_MAIN_COUNT
+RAIL_STATE = {0: "成功", 1: "测试中, 未测量", 2: "测量失败 (ADC转换超时)"}
+
+
+def build(cc, tmp):
+    exe = os.path.join(tmp, "ratio_bench")
+    subprocess.check_call([cc, "-O2", "-w", "-I", UTIL_DIR,
+                           os.path.join(UTIL_DIR, "sim", "ratio_bench.c"),
+                           os.path.join(UTIL_DIR, "utility_convert.c"),
+                           "-o", exe])
+    return exe
+
+
+def run(exe, *args):
+    out = subprocess.check_output([exe] + [str(a) for a in args],
+                                  universal_newlines=True)
+    return out.splitlines()
+
+
+def cpu_mhz():
+    try:
+        with open("/proc/cpuinfo") as f:
+            for line in f:
+                if line.lower().startswith("cpu mhz"):
+                    return float(line.split(":")[1])
+    except OSError:
+        pass
+    return None
+
+
+def cmd_check(args):
+    tmp = tempfile.mkdtemp(prefix="adc_conv_")
+    failed = 0
+    try:
+        exe = build(args.cc, tmp)
+        rows = []
+        total = [0, 0, 0]
+        vrefs = list(range(args.vref_min, args.vref_max + 1))
+        for i in range(0, len(vrefs), 32):
+            for line in run(exe, "single", *vrefs[i:i + 32]):
+                parts = line.split()
+                if parts[0] == "diff":
+                    print("不同: " + line)
+                    continue
+                for j in range(3):
+                    total[j] += int(parts[2 + j])
+        rows.append(("单次换算 ADC_VREF %d..%d" % (args.vref_min, args.vref_max), total))
+
+        for name, cmd in (("分压系数 %d..%d" % (SCALE_MIN, SCALE_MAX),
+                           ("scale", SCALE_MIN, SCALE_MAX)),
+                          ("批量换算 1..16次, 步长 %d" % args.step,
+                           ("batch", ADC_VREF, args.step))):
+            total = [0, 0, 0]
+            for line in run(exe, *cmd):
+                parts = line.split()
+                if parts[0] == "diff":
+                    print("不同: " + line)
+                    continue
+                total = [int(v) for v in parts[1:4]]
+            rows.append((name, total))
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+
+    print("%-34s %14s %8s %10s" % ("项目", "比较数", "不同", "无法换算"))
+    for name, (checked, bad, nofit) in rows:
+        print("%-34s %14d %8d %10d" % (name, checked, bad, nofit))
+        failed += bad
+        if checked == 0:
+            print("错误: %s 没有比较" % name)
+            failed += 1
+    if failed:
+        print("\n%d 项不同" % failed)
+        return 1
+    print("\n结果与原除法公式完全相同")
+    return 0
+
+
+def cmd_bench(args):
+    mhz = args.mhz or cpu_mhz()
+    if not mhz:
+        raise SystemExit("无法读取CPU频率, 请用 --mhz 指定")
+    tmp = tempfile.mkdtemp(prefix="adc_conv_")
+    try:
+        exe = build(args.cc, tmp)
+        parts = run(exe, "time", args.adc_vref, args.rounds)[-1].split()
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+
+    div_ns, mul_ns, init_ns = (float(v) for v in parts[1:4])
+    print("ADC_VREF %d, 码值 0..4095, 取 %d 轮最快, 本机 %.0f MHz (只作相对比较)\n" % (
+        args.adc_vref, args.rounds, mhz))
+    print("%-22s %10s %10s" % ("换算", "ns/次", "周期/次"))
+    print("%-22s %10.2f %10.1f" % ("64位除法 (原公式)", div_ns, div_ns * mhz / 1000.0))
+    print("%-22s %10.2f %10.1f" % ("倒数乘法", mul_ns, mul_ns * mhz / 1000.0))
+    print("%-22s %10.2f %10.1f" % ("计算倒数 (每批一次)", init_ns, init_ns * mhz / 1000.0))
+    if mul_ns > 0:
+        print("\n倒数乘法快 %.1f 倍, 每批 %.0f 次换算以上即可抵消计算倒数的耗时" % (
+            div_ns / mul_ns, init_ns / max(div_ns - mul_ns, 1e-9)))
+    print("工装上的 周期/次: 调用 ADC_Conv_Benchmark() 查看调试口输出")
+    return 0
+
+
+def frame(cmd, station, payload=b""):
+    f = bytearray([HEAD, cmd, station]) + bytes(payload)
+    f.append(sum(f) & 0xFF)
+    f.append(TAIL)
+    return bytes(f)
+
+
+def read_rail(port, station, samples, timeout):
+    """68 A7 工位 采样次数 状态 逐个us(4) 批量us(4) 和校验 16"""
+    port.reset_input_buffer()
+    port.write(frame(0xA6, station, [samples]))
+    buf = bytearray()
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        buf += port.read(64)
+        i = buf.find(bytes([HEAD, 0xA7, station]))
+        if i >= 0 and len(buf) >= i + 15:
+            f = buf[i:i + 15]
+            if f[14] == TAIL and sum(f[:13]) & 0xFF == f[13]:
+                return (f[4], int.from_bytes(f[5:9], "big"), int.from_bytes(f[9:13], "big"))
+            del buf[:i + 1]
+    raise SystemExit("工位 %d 无应答" % station)
+
+
+def cmd_rail(args):
+    try:
+        import serial
+    except ImportError:
+        raise SystemExit("需要 pyserial: pip install pyserial")
+    samples = [int(v) for v in args.samples.split(",")]
+    rows = []
+    with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+        for n in samples:
+            if not 1 <= n <= 255:
+                raise SystemExit("采样次数 1..255")
+            state, legacy_us, batch_us = read_rail(port, args.station, n, args.timeout)
+            if state != 0:
+                raise SystemExit("工位 %d: %s" % (args.station, RAIL_STATE.get(state, state)))
+            rows.append((n, legacy_us, batch_us))
+
+    # 逐个读取: 每路一次VREF和一次通道转换, 各自开关ADC (VREF BUFFER每路开关一次)
+    # 批量: 一次VREF BUFFER, VREF和各通道各 n 次转换, 每个通道开关一次ADC
+    print("工位 %d, %d 路\n" % (args.station, RAIL_COUNT))
+    print("%-20s %6s %6s %10s %10s" % ("方式", "次数", "转换", "us", "us/转换"))
+    for n, legacy_us, batch_us in rows:
+        conv = (RAIL_COUNT + 1) * n
+        print("%-20s %6d %6d %10d %10.1f" % ("逐个 get_xxx", 1, RAIL_COUNT * 2, legacy_us,
+                                            legacy_us / (RAIL_COUNT * 2.0)))
+        print("%-20s %6d %6d %10d %10.1f" % ("批量 MeasureRailSet", n, conv, batch_us,
+                                            batch_us / float(conv)))
+    if args.log:
+        with open(args.log, "a") as f:
+            for n, legacy_us, batch_us in rows:
+                f.write("%s station=%d samples=%d legacy_us=%d batch_us=%d\n" % (
+                    time.strftime("%Y-%m-%d %H:%M:%S"), args.station, n, legacy_us, batch_us))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="ADC 码值换算 检查/基准")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+    p = sub.add_parser("check")
+    p.add_argument("--vref-min", type=int, default=1500)
+    p.add_argument("--vref-max", type=int, default=1800)
+    p.add_argument("--step", type=int, default=251)
+    p.add_argument("--cc", default="gcc")
+    p = sub.add_parser("bench")
+    p.add_argument("--adc-vref", type=int, default=ADC_VREF)
+    p.add_argument("--rounds", type=int, default=200)
+    p.add_argument("--mhz", type=float, help="本机CPU频率, 默认读 /proc/cpuinfo")
+    p.add_argument("--cc", default="gcc")
+    p = sub.add_parser("rail")
+    p.add_argument("--port", required=True)
+    p.add_argument("--baud", type=int, default=115200)
+    p.add_argument("--station", type=int, required=True)
+    p.add_argument("--samples", default="1,4", help="采样次数, 逗号分隔")
+    p.add_argument("--timeout", type=float, default=2.0)
+    p.add_argument("--log", help="结果追加到该文件")
+    args = parser.parse_args()
+    if args.cmd == "rail":
+        return cmd_rail(args)
+    return cmd_check(args) if args.cmd == "check" else cmd_bench(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
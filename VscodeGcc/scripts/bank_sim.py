@@ -0,0 +1,308 @@
+#!/usr/bin/env python3
+"""
+后台下载 (B区) 升级 仿真工具
+
+比较两种升级方式在一条 RS-485 总线上的停产时间和总线占用:
+  xmodem  原流程: 0xBA 命令后重启进Bootloader, Xmodem 传完整镜像再启动,
+          传输期间总线被独占, 同一总线的其他工位也取不到结果/开始不了测试
+  bank    后台下载: 0xBC 在各工位换料间隙逐块写入 B区, 测试进行中不发,
+          收完提交 (回读CRC), 在下一次换料时短重启, Bootloader 把 B区拷贝到APP区
+
+Flash 侧耗时 (单块编程/擦除、提交校验、Bootloader拷贝) 不是估算值:
+脚本用本机 gcc 把 upgrade_bank.c、upgrade_storage.c、FAL、移植层和
+RAM 模拟 NOR (Components/FlashDB/sim) 编译在一起, 跑一遍真实的
+开始 -> 写入 -> 提交 -> 拷贝 (Components/Protocol/sim/bank_bench.c), 取模型周期。
+总线侧按固件时序 (接收帧间隔超时100ms, 发送前5ms) 逐毫秒仿真, 测试流量
+与 push_sim.py 的轮询方式一致 (开始命令 + 轮询查询结果)。
+
+输出:
+  - 每工位停产时间、整线停产 (工位·秒)
+  - 下载完成用时、总线占用 (测试 / 下载 / 空闲)
+  - 下载对测试的影响: 完成的测试数、结果延时、开始命令等待总线的时间
+
+用法:
+  bank_sim.py [--image-kb 96] [--stations 4] [--baud 9600] [--minutes 60]
+              [--chunk 128] [--handoff 5000] [--cc gcc]
+"""
+
+import argparse
+import math
+import os
+import random
+import shutil
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+COMP = os.path.normpath(os.path.join(HERE, "..", "..", "Components"))
+FDB = os.path.join(COMP, "FlashDB")
+
+SOURCES = [
+    "FlashDB/port/fal/src/fal.c", "FlashDB/port/fal/src/fal_flash.c",
+    "FlashDB/port/fal/src/fal_partition.c", "FlashDB/fal_flash_fm33lg04_port.c",
+    "FlashDB/sim/flash_sim.c", "Protocol/upgrade_bank.c",
+    "Protocol/upgrade_storage.c", "Protocol/upgrade_magic.c",
+    "Utility/utility_crc.c", "Protocol/sim/bank_bench.c",
+]
+
+CPU_HZ = 32000000.0
+
+# 固件时序 (Src/uart1.c)
+RX_IDLE_MS = 100
+TX_PRE_MS = 5
+
+# 测试流量 (帧长含帧头帧尾)
+START_LEN = 17
+START_ACK_LEN = 5
+QUERY_LEN = 5
+RESULT_LEN = 63
+
+# 后台下载 (pc_protocol_upgrade.c 0xBC/0xBD)
+BANK_OVERHEAD = 11      # 55 BC 长度 工位 01 偏移4 ... 校验和 AA
+BANK_ACK_LEN = 13
+BANK_COMMIT_LEN = 8
+
+# 原流程
+UPGRADE_LEN = 17        # 0xBA
+UPGRADE_ACK_LEN = 11
+XMODEM_PKT = 133        # SOH 序号 反码 128字节 CRC16
+XMODEM_DATA = 128
+
+
+# ---------------------------------------------------------------- Flash 侧
+
+def run_bench(cc, image_kb, chunk, defines):
+    tmp = tempfile.mkdtemp(prefix="bank_sim_")
+    try:
+        # 本机编译不带 EasyLogger, 日志宏置空
+        with open(os.path.join(tmp, "elog.h"), "w") as f:
+            f.write("#define log_i(...)\n#define log_e(...)\n"
+                    "#define log_w(...)\n#define log_d(...)\n")
+        exe = os.path.join(tmp, "bank_bench")
+        # Bootloader模式的布局 (APP在0x4000), 独立运行时B区下载被拒绝
+        cmd = [cc, "-O2", "-w", "-DFAL_FLASH_SIM", "-DUPGRADE_BANK_INSTALLER", "-DUSE_BOOTLOADER",
+               "-DFAL_PRINTF(...)=", "-I", tmp,
+               "-I", FDB, "-I", os.path.join(FDB, "inc"),
+               "-I", os.path.join(FDB, "port", "fal", "inc"),
+               "-I", os.path.join(FDB, "sim"),
+               "-I", os.path.join(COMP, "Protocol"),
+               "-I", os.path.join(COMP, "Utility")]
+        cmd += ["-D" + d for d in defines]
+        cmd += [os.path.join(COMP, s) for s in SOURCES] + ["-o", exe]
+        subprocess.check_call(cmd)
+        out = subprocess.check_output([exe, str(image_kb), str(chunk)],
+                                      universal_newlines=True)
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+
+    ms = lambda c: int(c) * 1000.0 / CPU_HZ
+    res = {}
+    for line in out.splitlines():
+        p = line.split()
+        if p[:2] == ["op", "begin"]:
+            res["begin_ms"] = ms(p[2])
+        elif p[:2] == ["op", "chunk"]:
+            res["chunks"] = int(p[2])
+            res["chunk_ms"] = ms(p[3]) / int(p[2])
+            res["chunk_max_ms"] = ms(p[4])
+        elif p[:2] == ["op", "commit"]:
+            res["commit_ms"] = ms(p[2])
+        elif p[:2] == ["op", "install"]:
+            res["install_ms"] = ms(p[2])
+        elif p[0] == "img":
+            res["size"] = int(p[1])
+            res["erases"] = int(p[2])
+    return res
+
+
+# ---------------------------------------------------------------- 总线侧
+
+class Station:
+    def __init__(self, sid, start_ms, chunks):
+        self.sid = sid
+        self.start_due = start_ms   # 操作员放好产品, 等待开始命令
+        self.testing = False
+        self.done_at = None         # 测试结束 (结果未取走)
+        self.test_end = 0.0
+        self.left = chunks          # 未下载的块
+        self.committed = False
+        self.switched = False
+
+
+def simulate(args, flash, download):
+    random.seed(args.seed)
+    b = 10.0 * 1000.0 / args.baud
+    horizon = args.minutes * 60000.0
+    chunk_tx = (BANK_OVERHEAD + args.chunk) * b + RX_IDLE_MS + flash["chunk_ms"] \
+        + TX_PRE_MS + BANK_ACK_LEN * b + args.gap
+    commit_tx = BANK_COMMIT_LEN * b + RX_IDLE_MS + flash["commit_ms"] \
+        + TX_PRE_MS + BANK_ACK_LEN * b + args.gap
+    switch_ms = args.boot + flash["install_ms"] + args.boot
+    stations = [Station(k, random.uniform(0, args.handoff), flash["chunks"] if download else 0)
+                for k in range(args.stations)]
+
+    t = 0.0
+    test_ms = dl_ms = 0.0
+    tests = 0
+    latency = []
+    start_wait = []
+    lost = []
+    dl_done_at = None
+    poll_idx = 0
+    next_poll = 0.0
+
+    while t < horizon:
+        for st in stations:
+            if st.testing and t >= st.test_end:
+                st.testing = False
+                st.done_at = st.test_end
+
+        # 1. 开始命令 (操作员已放好产品)
+        st = next((s for s in stations if not s.testing and s.done_at is None
+                   and t >= s.start_due), None)
+        if st is not None:
+            start_wait.append(t - st.start_due)
+            dur = START_LEN * b + RX_IDLE_MS + TX_PRE_MS + START_ACK_LEN * b + args.gap
+            t += dur
+            test_ms += dur
+            st.testing = True
+            st.test_end = t + args.test * random.uniform(0.8, 1.2)
+            st.start_due = float("inf")
+            continue
+
+        # 2. 轮询查询结果 (与 push_sim.py 的 poll 方式一致)
+        if t >= next_poll:
+            busy = [s for s in stations if s.testing or s.done_at is not None]
+            if busy:
+                st = busy[poll_idx % len(busy)]
+                poll_idx += 1
+                t0 = t
+                t += QUERY_LEN * b
+                if st.done_at is not None:
+                    t += RX_IDLE_MS + TX_PRE_MS + RESULT_LEN * b + args.gap
+                    latency.append(t - st.done_at)
+                    st.done_at = None
+                    tests += 1
+                    handoff = args.handoff * random.uniform(0.8, 1.2)
+                    st.start_due = t + handoff
+                    # 已提交的新固件在换料时切换
+                    if st.committed and not st.switched:
+                        st.switched = True
+                        lost.append(max(0.0, switch_ms - handoff))
+                        st.start_due = t + max(handoff, switch_ms)
+                else:
+                    t += args.timeout
+                test_ms += t - t0
+                next_poll = t0 + args.poll / len(stations)
+                continue
+
+        # 3. 后台下载: 只发给换料中的工位 (测试中工位会应答"忙")
+        st = next((s for s in stations if not s.testing and s.done_at is None
+                   and (s.left > 0 or not s.committed) and download
+                   and t < s.start_due), None)
+        if st is not None:
+            if st.left > 0:
+                st.left -= 1
+                t += chunk_tx
+                dl_ms += chunk_tx
+            else:
+                st.committed = True
+                t += commit_tx
+                dl_ms += commit_tx
+                if all(s.committed for s in stations):
+                    dl_done_at = t
+            continue
+
+        t += 1.0
+
+    return {
+        "tests": tests,
+        "test_share": test_ms / horizon * 100.0,
+        "dl_share": dl_ms / horizon * 100.0,
+        "lat_avg": sum(latency) / max(1, len(latency)),
+        "lat_max": max(latency) if latency else 0.0,
+        "wait_avg": sum(start_wait) / max(1, len(start_wait)),
+        "wait_max": max(start_wait) if start_wait else 0.0,
+        "dl_done": dl_done_at,
+        "switched": sum(1 for s in stations if s.switched),
+        "switch_ms": switch_ms,
+        "lost_max": max(lost) if lost else 0.0,
+        "chunk_tx": chunk_tx,
+    }
+
+
+def xmodem_downtime(args, flash):
+    """原流程单个工位的停产时间 (ms)"""
+    b = 10.0 * 1000.0 / args.baud
+    pkts = int(math.ceil(flash["size"] / float(XMODEM_DATA)))
+    # Bootloader 逐字节接收, 没有100ms帧间隔; 每包写Flash后回 ACK
+    per_pkt = XMODEM_PKT * b + flash["chunk_ms"] * XMODEM_DATA / args.chunk + b + args.gap
+    return (UPGRADE_LEN * b + RX_IDLE_MS + TX_PRE_MS + UPGRADE_ACK_LEN * b
+            + args.boot + args.handshake + pkts * per_pkt + args.boot)
+
+
+def main():
+    p = argparse.ArgumentParser(description="后台下载升级仿真")
+    p.add_argument("--image-kb", type=int, default=96, help="镜像大小 (KB, <=111)")
+    p.add_argument("--stations", type=int, default=4)
+    p.add_argument("--baud", type=int, default=9600)
+    p.add_argument("--chunk", type=int, default=128, help="每块数据字节 (4的倍数, <=128)")
+    p.add_argument("--minutes", type=int, default=60)
+    p.add_argument("--test", type=float, default=17500.0, help="一次测试耗时(ms)")
+    p.add_argument("--handoff", type=float, default=5000.0, help="换料时间(ms)")
+    p.add_argument("--poll", type=float, default=1000.0, help="轮询一遍所有工位的周期(ms)")
+    p.add_argument("--timeout", type=float, default=150.0, help="轮询无应答超时(ms)")
+    p.add_argument("--gap", type=float, default=10.0, help="上位机收到应答后再发送的间隔(ms)")
+    p.add_argument("--boot", type=float, default=500.0, help="复位到主循环运行(ms)")
+    p.add_argument("--handshake", type=float, default=1500.0,
+                   help="Bootloader Xmodem 握手等待(ms)")
+    p.add_argument("--seed", type=int, default=1)
+    p.add_argument("--cc", default="gcc")
+    p.add_argument("-D", dest="defines", action="append", default=[],
+                   help="覆盖周期模型参数, 如 FLASH_SIM_COST_ERASE=120000")
+    args = p.parse_args()
+
+    flash = run_bench(args.cc, args.image_kb, args.chunk, args.defines)
+    print("镜像 %dKB, %d 工位, %d 波特率, 测试 %.1fs, 换料 %.1fs" % (
+        args.image_kb, args.stations, args.baud, args.test / 1000, args.handoff / 1000))
+    print("Flash (模型): 开始 %.1fms, 每块 %.2fms (最大 %.2fms, 含扇区擦除), "
+          "提交校验 %.1fms, Bootloader拷贝 %.0fms, 擦除 %d 次" % (
+              flash["begin_ms"], flash["chunk_ms"], flash["chunk_max_ms"],
+              flash["commit_ms"], flash["install_ms"], flash["erases"]))
+    print("")
+
+    xm = xmodem_downtime(args, flash)
+    base = simulate(args, flash, False)
+    bank = simulate(args, flash, True)
+
+    print("%-8s %12s %14s %8s %8s %8s %10s %10s" % (
+        "方式", "每工位停产", "整线(工位·秒)", "测试数", "测试占用", "下载占用",
+        "结果延时max", "开始等待max"))
+    print("%-8s %10.1fs %14.0f %8s %8s %8s %10s %10s" % (
+        "xmodem", xm * args.stations / 1000, xm * args.stations * args.stations / 1000,
+        "-", "-", "独占", "-", "-"))
+    for name, r, down in (("无升级", base, 0.0), ("bank", bank, bank["switch_ms"])):
+        print("%-8s %10.1fs %14.0f %8d %7.1f%% %7.1f%% %9.0fms %9.0fms" % (
+            name, down / 1000, down * args.stations / 1000, r["tests"], r["test_share"],
+            r["dl_share"], r["lat_max"], r["wait_max"]))
+    print("")
+    print("xmodem: 单工位传输 %.1fs, 总线独占, %d 个工位依次升级期间整条线停产" % (
+        xm / 1000, args.stations))
+    if bank["dl_done"] is None:
+        print("bank: %d 分钟内未下载完成, 加大 --minutes" % args.minutes)
+        return 1
+    print("bank: 全部工位下载完成用时 %.1f 分钟, 每块一问一答 %.0fms; "
+          "切换 (复位+拷贝+启动) %.1fs, 超出换料时间 %.1fs; 已切换 %d/%d" % (
+              bank["dl_done"] / 60000, bank["chunk_tx"], bank["switch_ms"] / 1000,
+              bank["lost_max"] / 1000, bank["switched"], args.stations))
+    print("      测试数 %d -> %d (%.1f%%), 结果延时avg %.0f -> %.0fms, "
+          "开始等待avg %.0f -> %.0fms" % (
+              base["tests"], bank["tests"],
+              (bank["tests"] - base["tests"]) * 100.0 / max(1, base["tests"]),
+              base["lat_avg"], bank["lat_avg"], base["wait_avg"], bank["wait_avg"]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,242 @@
+#!/usr/bin/env python3
+"""
+UART0 <-> UART1 透传 仿真/实测工具
+
+  sim   按固件时序逐字节模拟被测设备 (UART0, 115200) 输出经工装转发到上位机
+        (UART1, 9600) 的过程, 比较
+          loop    原方式: 主循环等 100ms 帧间隔超时, 复制整帧后阻塞发送
+                  (接收缓冲512字节, 单次发送最多200字节, 超长帧整帧丢弃)
+          bridge  透传: 接收中断放入环形缓冲, UART1 发送中断直接取字节
+        输出转发字节数、丢失字节数和逐字节转发延时 (收到 -> 开始从UART1发出)
+  run   接在真实工装上: 68 A2 01 进入透传, 统计一段时间内收到的字节和间隔,
+        再发 68 A2 00 退出并读取固件统计 (转发/丢弃/最大积压)
+
+用法:
+  bridge_sim.py sim [--seconds 60] [--burst 40 600] [--gap 20 800] [--ring 512]
+  bridge_sim.py run --port /dev/ttyUSB0 --station 1 [--seconds 10]
+"""
+
+import argparse
+import random
+import sys
+import time
+
+HEAD = 0x68
+TAIL = 0x16
+CMD_BRIDGE = 0xA2      # pc_cmd_def.h BRIDGE
+CMD_BRIDGE_ACK = 0xA3
+
+# 固件时序 (Src/uart0.c, Src/uart1.c)
+UART0_BAUD = 115200
+UART1_BAUD = 9600
+RX_IDLE_MS = 100
+UART0_RX_MAX = 512
+UART1_TX_MAX = 200
+UART1_GUARD_MS = 5
+UART1_WAIT_MS = 1000
+
+
+def byte_ms(baud):
+    return 10 * 1000.0 / baud
+
+
+def frame(cmd, station, payload=b""):
+    f = bytearray([HEAD, cmd, station]) + bytes(payload)
+    f.append(sum(f) & 0xFF)
+    f.append(TAIL)
+    return bytes(f)
+
+
+def percentile(values, p):
+    if not values:
+        return 0.0
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * p / 100.0))]
+
+
+# ---------------------------------------------------------------- 仿真
+
+def dut_traffic(seconds, burst, gap, seed):
+    """被测设备输出: 返回每个字节到达UART0的时刻(ms)"""
+    rnd = random.Random(seed)
+    t = 0.0
+    times = []
+    bt = byte_ms(UART0_BAUD)
+    while t < seconds * 1000.0:
+        n = rnd.randint(burst[0], burst[1])
+        for _ in range(n):
+            times.append(t)
+            t += bt
+        t += rnd.uniform(gap[0], gap[1])
+    return times
+
+
+def sim_loop(arrivals):
+    """主循环转发: 返回 (每字节延时列表, 丢失字节数)"""
+    bt = byte_ms(UART1_BAUD)
+    # 按帧间隔切分
+    frames = []
+    cur = []
+    for t in arrivals:
+        if cur and t - cur[-1] >= RX_IDLE_MS:
+            frames.append(cur)
+            cur = []
+        cur.append(t)
+    if cur:
+        frames.append(cur)
+
+    lat = []
+    lost = 0
+    tx_free = 0.0   # UART1 上一包发完的时刻
+    for f in frames:
+        kept = f[:UART0_RX_MAX]
+        lost += len(f) - len(kept)
+        ready = f[-1] + RX_IDLE_MS
+        if len(kept) > UART1_TX_MAX:
+            lost += len(kept)   # Uart_Send 拒绝超长包
+            continue
+        if tx_free - ready > UART1_WAIT_MS:
+            lost += len(kept)   # 等待上一包超时
+            continue
+        start = max(ready, tx_free) + UART1_GUARD_MS
+        for k, t in enumerate(kept):
+            lat.append(start + k * bt - t)
+        tx_free = start + len(kept) * bt
+    return lat, lost
+
+
+def sim_bridge(arrivals, ring):
+    """中断透传: 环形缓冲可用 ring-1 字节"""
+    bt = byte_ms(UART1_BAUD)
+    lat = []
+    lost = 0
+    queue = []      # 缓冲中字节的到达时刻 (按序)
+    head = 0
+    tx_free = 0.0
+    peak = 0
+    for t in arrivals:
+        # 到 t 时刻为止发送中断已取走的字节
+        while head < len(queue) and max(tx_free, queue[head]) <= t:
+            start = max(tx_free, queue[head])
+            lat.append(start - queue[head])
+            tx_free = start + bt
+            head += 1
+        if len(queue) - head >= ring - 1:
+            lost += 1
+            continue
+        queue.append(t)
+        peak = max(peak, len(queue) - head)
+    while head < len(queue):
+        start = max(tx_free, queue[head])
+        lat.append(start - queue[head])
+        tx_free = start + bt
+        head += 1
+    return lat, lost, peak
+
+
+def cmd_sim(args):
+    arrivals = dut_traffic(args.seconds, args.burst, args.gap, args.seed)
+    total = len(arrivals)
+    offered = total * 10.0 / args.seconds
+    print("被测设备输出 %d 字节 / %ds, 平均 %.0f bit/s (UART1 %d 波特率可承载 %.0f%%)" % (
+        total, args.seconds, offered, UART1_BAUD, UART1_BAUD * 100.0 / max(1.0, offered)))
+    print("突发 %d~%d 字节, 间隔 %d~%dms, 突发最多积压 %.0f 字节 (%.1f%%)\n" % (
+        args.burst[0], args.burst[1], args.gap[0], args.gap[1],
+        args.burst[1] * (1 - float(UART1_BAUD) / UART0_BAUD), 100 - UART1_BAUD * 100.0 / UART0_BAUD))
+
+    rows = []
+    lat, lost = sim_loop(arrivals)
+    rows.append(("loop", lat, lost, None))
+    lat, lost, peak = sim_bridge(arrivals, args.ring)
+    rows.append(("bridge", lat, lost, peak))
+
+    print("%-8s %9s %9s %7s %9s %9s %9s %8s" % (
+        "方式", "转发", "丢失", "丢失率", "延时P50", "延时P99", "最大ms", "最大积压"))
+    for name, lat, lost, peak in rows:
+        print("%-8s %9d %9d %6.1f%% %9.1f %9.1f %9.1f %8s" % (
+            name, len(lat), lost, lost * 100.0 / max(1, total),
+            percentile(lat, 50), percentile(lat, 99), max(lat) if lat else 0.0,
+            "-" if peak is None else str(peak)))
+    return 0
+
+
+# ---------------------------------------------------------------- 实测
+
+def read_stats(port, station, timeout=2.0):
+    buf = bytearray()
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        buf += port.read(64)
+        i = buf.find(bytes([HEAD, CMD_BRIDGE_ACK, station]))
+        if i >= 0 and len(buf) >= i + 22:
+            f = buf[i:i + 22]
+            if f[21] == TAIL and sum(f[:20]) & 0xFF == f[20]:
+                def u32(k):
+                    return (f[k] << 24) | (f[k + 1] << 16) | (f[k + 2] << 8) | f[k + 3]
+
+                def u16(k):
+                    return (f[k] << 8) | f[k + 1]
+                return {"mode": f[3],
+                        "up": (u32(4), u16(8), u16(10)),
+                        "down": (u32(12), u16(16), u16(18))}
+            del buf[:i + 1]
+    return None
+
+
+def cmd_run(args):
+    try:
+        import serial
+    except ImportError:
+        raise SystemExit("需要 pyserial: pip install pyserial")
+    with serial.Serial(args.port, args.baud, timeout=0.05) as port:
+        port.reset_input_buffer()
+        port.write(frame(CMD_BRIDGE, args.station, b"\x01"))
+        if read_stats(port, args.station) is None:
+            raise SystemExit("工位 %d 无应答" % args.station)
+        print("已进入透传, 采集 %ds ..." % args.seconds)
+        got = 0
+        gaps = []
+        last = None
+        deadline = time.time() + args.seconds
+        while time.time() < deadline:
+            data = port.read(256)
+            now = time.time()
+            if data:
+                if last is not None:
+                    gaps.append((now - last) * 1000.0)
+                last = now
+                got += len(data)
+        port.write(frame(CMD_BRIDGE, args.station, b"\x00"))
+        stats = read_stats(port, args.station)
+    print("上位机收到 %d 字节, 读取间隔 P50 %.1fms 最大 %.1fms" % (
+        got, percentile(gaps, 50), max(gaps) if gaps else 0.0))
+    if stats is None:
+        print("退出命令无应答")
+        return 1
+    for name in ("up", "down"):
+        fwd, drop, peak = stats[name]
+        print("%-4s 转发 %d 丢弃 %d 最大积压 %d" % (
+            "上行" if name == "up" else "下行", fwd, drop, peak))
+    return 0 if stats["up"][1] == 0 else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description="UART0<->UART1 透传仿真/实测")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+    p = sub.add_parser("sim")
+    p.add_argument("--seconds", type=int, default=60)
+    p.add_argument("--burst", type=int, nargs=2, default=[40, 600])
+    p.add_argument("--gap", type=int, nargs=2, default=[20, 800], help="突发间隔ms")
+    p.add_argument("--ring", type=int, default=UART0_RX_MAX)
+    p.add_argument("--seed", type=int, default=1)
+    p = sub.add_parser("run")
+    p.add_argument("--port", required=True)
+    p.add_argument("--baud", type=int, default=UART1_BAUD)
+    p.add_argument("--station", type=int, default=1)
+    p.add_argument("--seconds", type=int, default=10)
+    args = parser.parse_args()
+    return cmd_sim(args) if args.cmd == "sim" else cmd_run(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,351 @@
+#!/usr/bin/env python3
+"""
+RS-485 多工位总线吞吐测试工具
+
+比较两种取结果方式在一条总线上的 结果数/秒:
+  seq    逐个工位发送查询结果 68 AC 工位 和校验 16, 等待应答后再查下一个
+  bcast  发送一次广播查询 68 AC FF 和校验 16, 各工位按工位号分时隙应答
+
+用法:
+  bus_bench.py sim [--stations 4] [--slot 100] [--rounds 20] [--loop-us 20] [--block 0]
+                   [--gap 10] [--seed 1] [--cc gcc]
+      无需硬件: 用本机 gcc 把 PC_xieyi_Ctrl.c、Bus_Ctrl.c、uart1.c 等 (与 trace_replay.py
+      sim 相同的固件源文件) 编译成 Src/sim/bus_bench.c, 每个模拟工位一个进程, 串口和
+      1ms节拍由 Src/sim/uart_sim.c 模拟 (9600 每字节10位)。所有工位按1ms同步步进,
+      上位机和各工位发出的字节送入其他所有工位的接收中断 (时隙冲突检测看得到),
+      字节在总线上重叠的应答按校验错误计。上位机收齐期望的应答 (或超时) 后隔 --gap
+      发下一帧。--block 为主循环每圈另加的随机阻塞上限(ms), 用于估计错过时隙的比例;
+      广播模式另外汇总各工位的固件时隙统计 (Bus_Get_tongji)
+  bus_bench.py run --port /dev/ttyUSB0 [--stations 4] [--rounds 20]
+                   [--mode seq|bcast|both] [--slot 100]
+      在真实总线上测量: 统计各工位有效应答、超时和校验错误 (冲突)
+  bus_bench.py stats --port /dev/ttyUSB0 --station 1
+      读取工装时隙统计 (68 B0 工位 和校验 16)
+"""
+
+import argparse
+import bisect
+import os
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from trace_replay import sim_build  # noqa: E402
+
+HEAD = 0x68
+TAIL = 0x16
+BROADCAST = 0xFF
+RX_IDLE_MS = 100      # 固件 uart1 接收帧间隔超时
+TX_PRE_MS = 5         # Uart1_Tx_Send 发送前延时
+RESULT_LEN = 63       # 查询结果应答帧长 (68 AD ... 16)
+QUERY_LEN = 5
+BUS_GONGWEI_MAX = 4   # Bus_Ctrl.h 广播窗口时隙数
+
+
+def frame(cmd, station, payload=b""):
+    f = bytearray([HEAD, cmd, station]) + payload
+    f.append(sum(f) & 0xFF)
+    f.append(TAIL)
+    return bytes(f)
+
+
+def byte_ms(baud):
+    return 10.0 * 1000.0 / baud
+
+
+# ---------------------------------------------------------------- 模拟
+
+STEP_US = 1000        # 步进间隔, 短于一个字节: 本步发出的字节在下一步之后才到达其他工位
+BAUD = 9600           # uart1.c
+
+
+class SimStation:
+    """一个模拟工位: Src/sim/bus_bench.c 进程 (固件 PC_xieyi_Ctrl.c + Bus_Ctrl.c ...)"""
+
+    def __init__(self, exe, sid, args):
+        opts = ["-c", "station=%d" % sid, "-c", "bus_slot=%d" % args.slot,
+                "-l", str(args.loop_us), "-b", str(int(args.block * 1000)),
+                "-s", str(args.seed + sid)]
+        self.sid = sid
+        self.proc = subprocess.Popen([exe] + opts, stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                                     universal_newlines=True, bufsize=1)
+        self.tx = []        # 发出的字节 (开始移出us, 字节)
+        self.scan = 0       # 已找过应答帧的位置
+
+    def feed(self, t_us, data):
+        self.proc.stdin.write("x %d %02X\n" % (t_us, data))
+
+    def step(self, t_us):
+        self.proc.stdin.write("g %d\n" % t_us)
+        self.proc.stdin.flush()
+        out = []
+        for line in self.proc.stdout:
+            if line.startswith("."):
+                break
+            t, b = line.split()
+            out.append((int(t), int(b, 16)))
+        self.tx += out
+        return out
+
+    def replies(self):
+        """新发完的查询结果应答 68 AD, 返回 [(开始us, 结束us)], 结束为最后一字节移出时刻"""
+        found = []
+        b_us = 10e6 / BAUD
+        while self.scan + RESULT_LEN <= len(self.tx):
+            f = [d for _, d in self.tx[self.scan:self.scan + RESULT_LEN]]
+            if f[0] == HEAD and f[1] == 0xAD and f[-1] == TAIL and sum(f[:-2]) & 0xFF == f[-2]:
+                found.append((self.tx[self.scan][0], self.tx[self.scan + RESULT_LEN - 1][0] + b_us))
+                self.scan += RESULT_LEN
+            else:
+                self.scan += 1
+        return found
+
+    def close(self):
+        self.proc.stdin.write("q\n")
+        self.proc.stdin.flush()
+        line = ""
+        for line in self.proc.stdout:
+            if line.startswith("end"):
+                break
+        self.proc.wait()
+        return [int(x) for x in line.split()[1:]]
+
+
+def overlapped(bus, start, end, src):
+    """[start, end) 内总线上是否有其他来源的字节 (冲突, 上位机收到的帧损坏)"""
+    b_us = 10e6 / BAUD
+    i = bisect.bisect_left(bus, (start - b_us, -2, 0))
+    while i < len(bus) and bus[i][0] < end:
+        if bus[i][1] != src and bus[i][0] + b_us > start:
+            return True
+        i += 1
+    return False
+
+
+def sim_mode(exe, mode, args):
+    """一种取结果方式: N 个工位进程按 STEP_US 同步步进, 总线上所有字节互相可见"""
+    b_us = 10e6 / BAUD
+    n = args.stations
+    stations = [SimStation(exe, sid, args) for sid in range(n)]
+    bus = []            # (开始us, 来源 -1=上位机, 字节), 按时间排序
+    pending = [[] for _ in stations]    # 各工位待送入的 (到达us, 字节)
+    queries = [st for _ in range(args.rounds) for st in (range(n) if mode == "seq" else [BROADCAST])]
+    qi = 0
+    next_send = 0
+    wait = None         # (截止us, 期望应答的工位)
+    got = {}
+    timeout = 0
+    collide = 0
+    t = 0
+    end_us = 0
+    while qi < len(queries) or wait is not None:
+        # 上位机: 到时刻发下一帧, 各字节移出后到达所有工位
+        if wait is None and next_send < t + STEP_US:
+            st = queries[qi]
+            qi += 1
+            f = frame(0xAC, st)
+            for i, d in enumerate(f):
+                s = next_send + i * b_us
+                bus.append((s, -1, d))
+                for p in pending:
+                    p.append((s + b_us, d))
+            q_end = next_send + len(f) * b_us
+            if st == BROADCAST:
+                wait = [q_end + (RX_IDLE_MS + n * args.slot + 50) * 1000, set(range(n))]
+            else:
+                wait = [q_end + (RX_IDLE_MS + TX_PRE_MS + 50) * 1000 + RESULT_LEN * b_us, {st}]
+        t += STEP_US
+        for k, sim in enumerate(stations):
+            pending[k].sort()
+            while pending[k] and pending[k][0][0] < t:
+                a, d = pending[k].pop(0)
+                sim.feed(a, d)
+        for k, sim in enumerate(stations):
+            for s, d in sim.step(t):
+                bus.append((s, sim.sid, d))
+                for j, p in enumerate(pending):
+                    if j != k:
+                        p.append((s + b_us, d))
+        bus.sort()
+        # 上位机收应答: 与其他字节重叠的帧校验错误
+        for sim in stations:
+            for s, e in sim.replies():
+                if wait is None or sim.sid not in wait[1]:
+                    continue
+                if overlapped(bus, s, e, sim.sid):
+                    collide += 1
+                else:
+                    got[sim.sid] = got.get(sim.sid, 0) + 1
+                    wait[1].discard(sim.sid)
+        if wait is not None and (not wait[1] or t >= wait[0]):
+            timeout += len(wait[1])
+            end_us = min(t, wait[0])
+            next_send = end_us + args.gap * 1000
+            wait = None
+    stats = [sim.close() for sim in stations]
+    total = sum(got.values())
+    expected = args.rounds * n
+    print("%-6s 每轮 %.0fms, %d/%d 应答, %.2f 结果/秒, 超时 %d, 冲突 %d" % (
+        mode, end_us / 1000.0 / args.rounds, total, expected, total * 1e6 / end_us,
+        timeout, collide))
+    if mode == "bcast":
+        print("       固件统计: 时隙应答 %d, 错过时隙 %d, 放弃(冲突) %d, 最大延迟 %dms" % (
+            sum(x[1] for x in stats), sum(x[2] for x in stats), sum(x[3] for x in stats),
+            max(x[4] for x in stats)))
+    for st in range(n):
+        if got.get(st, 0) < args.rounds:
+            print("       工位%d: %d/%d" % (st, got.get(st, 0), args.rounds))
+
+
+def cmd_sim(args):
+    b = byte_ms(BAUD)
+    reply_ms = TX_PRE_MS + RESULT_LEN * b
+    print("%d 工位, 波特率 %d: 每字节 %.2fms, 应答占用 %.1fms, 时隙 %dms, 主循环 %dus + 阻塞0-%.0fms" % (
+        args.stations, BAUD, b, reply_ms, args.slot, args.loop_us, args.block))
+    if reply_ms > args.slot:
+        print("警告: 应答长于时隙, 相邻工位会冲突")
+    if args.stations > BUS_GONGWEI_MAX:
+        print("注意: 工位号 >= %d 没有广播时隙, 不应答广播" % BUS_GONGWEI_MAX)
+    tmp = tempfile.mkdtemp(prefix="bus_sim_")
+    try:
+        exe = sim_build(args.cc, tmp, "bus_bench")
+        for mode in ("seq", "bcast"):
+            sim_mode(exe, mode, args)
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+    return 0
+
+
+# ---------------------------------------------------------------- 真实总线
+
+def split_frames(buf):
+    """按 68 AD 工位 ... 16 提取查询结果应答, 返回 (有效{工位}, 错误数)"""
+    ok = {}
+    bad = 0
+    i = 0
+    while i + RESULT_LEN <= len(buf):
+        if buf[i] != HEAD or buf[i + 1] != 0xAD:
+            i += 1
+            continue
+        f = buf[i:i + RESULT_LEN]
+        if f[-1] == TAIL and sum(f[:-2]) & 0xFF == f[-2]:
+            ok[f[2]] = ok.get(f[2], 0) + 1
+            i += RESULT_LEN
+        else:
+            bad += 1
+            i += 1
+    return ok, bad
+
+
+def collect(port, wait_s):
+    buf = bytearray()
+    deadline = time.time() + wait_s
+    while time.time() < deadline:
+        buf += port.read(512)
+    return buf
+
+
+def run_mode(port, mode, args):
+    b = byte_ms(args.baud) / 1000.0
+    got = {}
+    bad = 0
+    t0 = time.time()
+    for _ in range(args.rounds):
+        if mode == "seq":
+            for st in range(args.stations):
+                port.reset_input_buffer()
+                port.write(frame(0xAC, st))
+                buf = collect(port, (RX_IDLE_MS + TX_PRE_MS) / 1000.0 + RESULT_LEN * b + 0.05)
+                ok, nbad = split_frames(buf)
+                bad += nbad
+                for k, v in ok.items():
+                    got[k] = got.get(k, 0) + v
+        else:
+            port.reset_input_buffer()
+            port.write(frame(0xAC, BROADCAST))
+            wait = (RX_IDLE_MS + args.stations * args.slot) / 1000.0 + 0.05
+            ok, nbad = split_frames(collect(port, wait))
+            bad += nbad
+            for k, v in ok.items():
+                got[k] = got.get(k, 0) + v
+    elapsed = time.time() - t0
+    total = sum(got.values())
+    expected = args.rounds * args.stations
+    print("%-6s %.1fs, %d/%d 应答, %.2f 结果/秒, 超时 %d, 校验错误 %d" % (
+        mode, elapsed, total, expected, total / elapsed, expected - total, bad))
+    for st in range(args.stations):
+        print("       工位%d: %d" % (st, got.get(st, 0)))
+
+
+def open_port(args):
+    try:
+        import serial
+    except ImportError:
+        raise SystemExit("需要 pyserial: pip install pyserial")
+    return serial.Serial(args.port, args.baud, timeout=0.01)
+
+
+def cmd_run(args):
+    with open_port(args) as port:
+        modes = ("seq", "bcast") if args.mode == "both" else (args.mode,)
+        for mode in modes:
+            run_mode(port, mode, args)
+    return 0
+
+
+def cmd_stats(args):
+    with open_port(args) as port:
+        port.reset_input_buffer()
+        port.write(frame(0xB0, args.station))
+        buf = collect(port, 0.5)
+    for i in range(len(buf) - 14):
+        f = buf[i:i + 15]
+        if f[0] == HEAD and f[1] == 0xB1 and f[14] == TAIL and sum(f[:13]) & 0xFF == f[13]:
+            rx, tx, miss, col, late = struct.unpack(">5H", f[3:13])
+            print("工位%d: 广播 %d, 时隙应答 %d, 错过 %d, 冲突 %d, 最大延迟 %dms" % (
+                f[2], rx, tx, miss, col, late))
+            return 0
+    print("无应答")
+    return 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description="RS-485 多工位总线吞吐测试")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+
+    p = sub.add_parser("sim", help="N个工位进程运行固件代码, 共享模拟总线")
+    p.add_argument("--stations", type=int, default=4)
+    p.add_argument("--slot", type=int, default=100, help="时隙(ms), 写入各工位配置 bus_slot")
+    p.add_argument("--gap", type=float, default=10.0, help="上位机收齐应答后到下一帧的间隔(ms)")
+    p.add_argument("--loop-us", type=int, default=20, help="主循环一圈耗时(us)")
+    p.add_argument("--block", type=float, default=0.0, help="主循环每圈另加的随机阻塞上限(ms)")
+    p.add_argument("--rounds", type=int, default=20)
+    p.add_argument("--seed", type=int, default=1)
+    p.add_argument("--cc", default="gcc")
+    p.set_defaults(func=cmd_sim)
+
+    p = sub.add_parser("run", help="在真实总线上测量")
+    p.add_argument("--port", required=True)
+    p.add_argument("--baud", type=int, default=9600)
+    p.add_argument("--stations", type=int, default=4)
+    p.add_argument("--rounds", type=int, default=20)
+    p.add_argument("--slot", type=int, default=100)
+    p.add_argument("--mode", choices=("seq", "bcast", "both"), default="both")
+    p.set_defaults(func=cmd_run)
+
+    p = sub.add_parser("stats", help="读取工装时隙统计")
+    p.add_argument("--port", required=True)
+    p.add_argument("--baud", type=int, default=9600)
+    p.add_argument("--station", type=int, required=True)
+    p.set_defaults(func=cmd_stats)
+
+    args = parser.parse_args()
+    return args.func(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,376 @@
+#!/usr/bin/env python3
+"""
+测量校准 上位机/仿真工具
+
+生成 0xE2 测量校准命令帧, 并在本机把 meas_calib.c + jig_config.c + FlashDB +
+模拟NOR 编译在一起, 用板间差异模型检查两点校准的计算、换算和保存
+(镜像格式见 Components/FlashDB/meas_calib.h)。
+
+板间差异模型 (每块工装板固定):
+  电压: 分压比误差 N(0, 0.5%) (每通道), ADC 增益 N(0, 0.1%) 和偏移 N(0, 1.5LSB),
+        VREF1P2 出厂定标残差 N(0, 0.2%) (全部通道相同);
+        读数按 GetSingleChannelVoltage_POLL 的整数公式, 每次带 ADC 噪声
+  功耗: 分流电阻误差 N(0, 1%), INA219 偏移 N(0, 3LSB), 读数噪声
+校准 (与 Src/Calib_Ctrl.c 相同):
+  电压每点取 16 次引脚 mV 之和, 参考值为校准源输出 (万用表误差 0.02%+0.5mV)
+  功耗每点读一次 (已是多次平均), 增益折算到 INA219 校准寄存器, 偏移加在读数上
+
+子命令:
+  frame <操作> [数据...] [--station N]  输出 0xE2 帧 hex
+      0 状态 / 1 采样: 点号 掩码 参考值... / 2 计算: 掩码 / 3 读取 / 4 下载: 镜像hex|- / 5 采样点
+  sim [--boards 200]                    比较校准前后各通道的测量误差
+  check [--cc gcc]                      检查计算/换算/出错处理/保存
+"""
+
+import argparse
+import os
+import random
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import zlib
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.normpath(os.path.join(HERE, "..", ".."))
+FDB = os.path.join(ROOT, "Components", "FlashDB")
+
+MAGIC = 0x434D
+FORMAT = 1
+GAIN_SHIFT = 14
+RAW_SHIFT = 4
+ADC_SCALE = 11000      # JIG_CFG_ADC_SCALE 默认值
+ADC_VREF = 1638        # VREF1P2 出厂定标码值 (3.0V 时)
+INA_CAL = 0x1000       # JIG_CFG_INA219_CAL 默认值
+
+RESULTS = ("成功", "长度错误", "魔数错误", "格式版本错误", "CRC错误", "参数错误", "忙",
+           "没有采样点", "两点太近", "增益超出范围", "偏移超出范围", "保存失败")
+
+# 通道顺序同 Inc/Calib_Ctrl.h, (名称, 测试值, 校准点0, 校准点1)
+CHANNELS = [
+    ("VCC", 3300, 1500, 6000),
+    ("GONGDIAN", 6000, 1500, 6000),
+    ("VDD", 3900, 1500, 6000),
+    ("ZHUDIAN", 6000, 1500, 6000),
+    ("SHENGYA", 5000, 1500, 6000),
+    ("GONGZHUANG", 3300, 1500, 6000),
+    ("GONGHAO", 850, 100, 900),
+]
+CURRENT_CH = 6
+NOMINAL = [11 << GAIN_SHIFT] * CURRENT_CH + [1 << GAIN_SHIFT]
+
+
+def frame(op, payload, station):
+    body = bytearray([0x55, 0xE2, 0, station, op]) + payload
+    body[2] = len(body) + 2
+    return bytes(body) + bytes([sum(body) & 0xFF, 0xAA])
+
+
+def apply(raw, gain, offset):
+    """与 MeasCalib_Apply 相同: 按绝对值四舍五入"""
+    v = (abs(raw) * gain + (1 << (GAIN_SHIFT - 1))) >> GAIN_SHIFT
+    return (-v if raw < 0 else v) + offset
+
+
+# ---------------------------------------------------------------- 板间差异模型
+
+class Board:
+    def __init__(self, rng):
+        self.rng = rng
+        self.div = [rng.gauss(0, 0.005) for _ in range(CURRENT_CH)]
+        self.adc_gain = rng.gauss(0, 0.001)
+        self.adc_off = rng.gauss(0, 1.5)
+        self.vref = rng.gauss(0, 0.002)
+        self.shunt = rng.gauss(0, 0.01)
+        self.ina_off = rng.gauss(0, 3)
+
+    def pin_mv(self, ch, rail):
+        """GetSingleChannelVoltage_POLL"""
+        code = rail / 11.0 * (1 + self.div[ch]) / 3000 * 4095 * (1 + self.adc_gain)
+        code = min(max(round(code + self.adc_off + self.rng.gauss(0, 0.8)), 0), 4095)
+        vref = round(ADC_VREF * (1 + self.vref) + self.rng.gauss(0, 0.6))
+        return code * 3000 * ADC_VREF // (vref * 4095)
+
+    def ina(self, current, cal):
+        """默认校准寄存器下的分流读数, 按校准寄存器比例换算 (截断)"""
+        shunt = round(current * (1 + self.shunt) + self.ina_off + self.rng.gauss(0, 0.5))
+        v = abs(shunt) * cal // INA_CAL
+        return -v if shunt < 0 else v
+
+    def read(self, ch, value, cal=None):
+        """生产测试读数; cal 为 (增益, 偏移) 或 None (未校准)"""
+        if ch == CURRENT_CH:
+            if cal is None:
+                return self.ina(value, INA_CAL)
+            reg = min(max((INA_CAL * cal[0] + (1 << (GAIN_SHIFT - 1))) >> GAIN_SHIFT, 1), 0xFFFE)
+            return max(min(self.ina(value, reg) + cal[1], 32767), -32768)
+        pin = self.pin_mv(ch, value)
+        if cal is None:
+            return pin * ADC_SCALE // 1000
+        return max(apply(pin, cal[0], cal[1]), 0)
+
+    def raw(self, ch, value):
+        """校准采样原始值 x16"""
+        if ch == CURRENT_CH:
+            return self.ina(value, INA_CAL) << RAW_SHIFT
+        return sum(self.pin_mv(ch, value) for _ in range(1 << RAW_SHIFT))
+
+
+def dmm(rng, value, ch):
+    """参考值: 校准源输出经万用表测量"""
+    if ch == CURRENT_CH:
+        return value
+    return round(value * (1 + rng.gauss(0, 0.0002)) + rng.gauss(0, 0.5))
+
+
+# ---------------------------------------------------------------- 固件 (本机编译)
+
+class Bench:
+    def __init__(self, cc, tmp):
+        exe = os.path.join(tmp, "calib_bench")
+        if not os.path.exists(exe):
+            with open(os.path.join(tmp, "elog.h"), "w") as f:
+                f.write("#define log_i(...)\n#define log_e(...)\n"
+                        "#define log_w(...)\n#define log_d(...)\n")
+            sources = ["src/fdb.c", "src/fdb_kvdb.c", "src/fdb_utils.c",
+                       "port/fal/src/fal.c", "port/fal/src/fal_flash.c",
+                       "port/fal/src/fal_partition.c", "fal_flash_fm33lg04_port.c",
+                       "sim/flash_sim.c", "jig_config.c", "meas_calib.c",
+                       "sim/calib_bench.c"]
+            util = os.path.join(ROOT, "Components", "Utility")
+            subprocess.check_call(
+                [cc, "-O2", "-w", "-DFAL_FLASH_SIM", "-I", tmp, "-I", FDB,
+                 "-I", os.path.join(FDB, "inc"), "-I", os.path.join(FDB, "port", "fal", "inc"),
+                 "-I", os.path.join(FDB, "sim"), "-I", util] +
+                [os.path.join(FDB, s) for s in sources] +
+                [os.path.join(util, "utility_crc.c"), "-o", exe])
+        self.proc = subprocess.Popen([exe], stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                                     universal_newlines=True)
+        self.cmd("init " + " ".join(map(str, NOMINAL)))
+
+    def cmd(self, text):
+        self.proc.stdin.write(text + "\n")
+        self.proc.stdin.flush()
+        # 跳过 FAL 的日志行
+        while True:
+            r = self.proc.stdout.readline().split()
+            if not r or r[0] == text.split()[0]:
+                return r
+
+    def ints(self, text):
+        return [int(x) for x in self.cmd(text)[1:]]
+
+    def capture(self, point, mask, refs, raws):
+        r = self.ints("req %d %d %s" % (point, mask, " ".join(map(str, refs))))[0]
+        if r != 0:
+            return r
+        return self.ints("point " + " ".join(map(str, raws)))[0]
+
+    def calibrate(self, board, rng, mask=(1 << len(CHANNELS)) - 1):
+        for k in (0, 1):
+            refs, raws = [], []
+            for ch, c in enumerate(CHANNELS):
+                refs.append(dmm(rng, c[2 + k], ch))
+                raws.append(board.raw(ch, c[2 + k]))
+            self.capture(k, mask, refs, raws)
+        return self.ints("commit %d" % mask)
+
+    def table(self):
+        image = bytes.fromhex(self.cmd("image")[1])
+        n = image[3]
+        return [struct.unpack_from("<Ih", image, 6 + 6 * i) for i in range(n)]
+
+    def close(self):
+        self.proc.stdin.close()
+        self.proc.wait()
+
+
+def image(seq, table):
+    data = struct.pack("<HBBH", MAGIC, FORMAT, len(table), seq)
+    for gain, offset in table:
+        data += struct.pack("<Ih", gain, offset)
+    return data + struct.pack("<I", zlib.crc32(data) & 0xFFFFFFFF)
+
+
+# ---------------------------------------------------------------- 子命令
+
+def cmd_frame(args):
+    data = args.data
+    if args.op == 1:
+        payload = bytes([int(data[0]), int(data[1], 0)])
+        payload += b"".join(struct.pack("<i", int(v)) for v in data[2:])
+    elif args.op == 2:
+        payload = bytes([int(data[0], 0)])
+    elif args.op == 4:
+        payload = b"" if not data or data[0] == "-" else bytes.fromhex(data[0])
+    else:
+        payload = b""
+    print(frame(args.op, payload, args.station).hex(" ").upper())
+    return 0
+
+
+def errors(bench, boards, seed, cal):
+    """各通道在测试值处的误差 (绝对值), 每块板 8 次读数"""
+    rng = random.Random(seed)
+    out = [[] for _ in CHANNELS]
+    for b in range(boards):
+        board = Board(rng)
+        table = None
+        if cal:
+            bench.cmd("load -")
+            r, bad = bench.calibrate(board, rng)
+            if r != 0:
+                raise RuntimeError("校准失败: %s 通道%d" % (RESULTS[r], bad))
+            table = bench.table()
+        for ch, c in enumerate(CHANNELS):
+            for _ in range(8):
+                v = board.read(ch, c[1], None if table is None else table[ch])
+                out[ch].append(abs(v - c[1]))
+    return out
+
+
+def pct(values, p):
+    v = sorted(values)
+    return v[min(len(v) - 1, int(len(v) * p))]
+
+
+def cmd_sim(args):
+    tmp = tempfile.mkdtemp(prefix="calib_sim_")
+    try:
+        b = Bench(args.cc, tmp)
+        before = errors(b, args.boards, 1, False)
+        after = errors(b, args.boards, 1, True)
+        b.close()
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+    print("%d 块工装板, 每块在测试值处读 8 次, 误差 |读数-真值|" % args.boards)
+    print("%-11s %6s %18s %18s" % ("通道", "测试值", "固定系数 p50/p99", "两点校准 p50/p99"))
+    for ch, c in enumerate(CHANNELS):
+        print("%-11s %6d %9d/%-8d %9d/%-8d" % (
+            c[0], c[1], pct(before[ch], 0.5), pct(before[ch], 0.99),
+            pct(after[ch], 0.5), pct(after[ch], 0.99)))
+    return 0
+
+
+def cmd_check(args):
+    tmp = tempfile.mkdtemp(prefix="calib_sim_")
+    failed = []
+    checks = [0]
+
+    def expect(name, got, want):
+        checks[0] += 1
+        if got != want:
+            failed.append("%s: %s, 应为 %s" % (name, got, want))
+
+    rng = random.Random(3)
+    try:
+        b = Bench(args.cc, tmp)
+        all_mask = (1 << len(CHANNELS)) - 1
+        expect("未校准", b.ints("reboot"), [0, 0])
+
+        # 参数和出错处理
+        expect("点号无效", b.ints("req 2 1 1000")[0], 5)
+        expect("通道超出", b.ints("req 0 128 0 0 0 0 0 0 0 0")[0], 5)
+        expect("没有采样点", b.ints("commit 1"), [7, 0])
+        b.ints("req 0 1 1000")
+        expect("采样中再请求", b.ints("req 0 1 1000")[0], 6)
+        b.ints("point 1456")           # 91mV x16
+        b.ints("req 1 1 1000")
+        b.ints("point 1460")
+        expect("两点太近", b.ints("commit 1"), [8, 0])
+        b.capture(0, 1, [1000], [91 * 16])
+        b.capture(1, 1, [5000], [455 * 16])
+        expect("通道0合格", b.ints("commit 1"), [0, 255])
+        b.capture(0, 3, [1000, 2000], [91 * 16, 91 * 16])
+        b.capture(1, 3, [5000, 10000], [455 * 16, 455 * 16])
+        expect("增益超出范围 (通道1)", b.ints("commit 3"), [9, 1])
+        expect("失败时全部不生效", b.ints("reboot"), [1, 1])
+        b.capture(0, 1, [1000 + 800], [91 * 16])
+        b.capture(1, 1, [5000 + 800], [455 * 16])
+        expect("偏移超出范围", b.ints("commit 1"), [10, 0])
+
+        # 一点校准: 过零点
+        b.capture(0, 4, [0, 0, 3300], [0, 0, 300 * 16])
+        expect("一点校准", b.ints("commit 4"), [0, 255])
+        expect("一点校准的增益/偏移", b.table()[2], (3300 * 16384 * 16 // (300 * 16), 0))
+        expect("校准序号", b.ints("reboot"), [5, 2])
+
+        # 两点校准: 增益/偏移与浮点计算一致 (误差不超过1个定点单位)
+        board = Board(rng)
+        b.cmd("load -")
+        expect("全部通道校准", b.calibrate(board, rng), [0, 255])
+        table = b.table()
+        expect("全部通道已校准", b.ints("reboot")[0], all_mask)
+        expect("复位后校准值不变", b.table(), table)
+
+        # 换算: 全部原始值范围与公式逐一比较
+        for ch, (gain, offset) in enumerate(table):
+            lo, hi = (-4096, 4095) if ch == CURRENT_CH else (0, 4095)
+            got = b.ints("apply %d %d %d" % (ch, lo, hi))
+            want = [apply(r, gain, offset) for r in range(lo, hi + 1)]
+            expect("通道%d 换算 (%d..%d)" % (ch, lo, hi), got, want)
+
+        # 镜像: 读回/下载/出错
+        img = bytes.fromhex(b.cmd("image")[1])
+        expect("镜像CRC", struct.unpack("<I", img[-4:])[0], zlib.crc32(img[:-4]) & 0xFFFFFFFF)
+        expect("删除", b.ints("load -"), [0, 255])
+        expect("删除后复位", b.ints("reboot")[0], 0)
+        expect("下载备份", b.ints("load " + img.hex()), [0, 255])
+        expect("下载后复位", b.table(), table)
+        bad = bytearray(img)
+        bad[8] ^= 0x01
+        expect("CRC错误", b.ints("load " + bytes(bad).hex())[0], 4)
+        expect("截断", b.ints("load " + img[:-1].hex())[0], 1)
+        bad = bytearray(img)
+        bad[0] ^= 0xFF
+        expect("魔数错误", b.ints("load " + bytes(bad).hex())[0], 2)
+        bad = bytearray(img)
+        bad[2] = 9
+        expect("格式版本错误", b.ints("load " + bytes(bad).hex())[0], 3)
+        t = list(table)
+        t[3] = (15 << GAIN_SHIFT, 0)
+        expect("镜像增益超出范围", b.ints("load " + image(7, t).hex()), [9, 3])
+        expect("出错时校准值不变", b.table(), table)
+
+        # 校准后误差: 电压不超过 0.3%+15mV, 功耗不超过 1%+3, 比固定系数小
+        before = errors(b, 40, 11, False)
+        after = errors(b, 40, 11, True)
+        for ch, c in enumerate(CHANNELS):
+            limit = (c[1] * 0.01 + 3) if ch == CURRENT_CH else (c[1] * 0.003 + 15)
+            expect("%s 校准后 p99 误差不超过 %d" % (c[0], limit),
+                   pct(after[ch], 0.99) <= limit, True)
+            expect("%s 校准后误差减小" % c[0],
+                   pct(after[ch], 0.99) < pct(before[ch], 0.99), True)
+        b.close()
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+
+    for f in failed:
+        print("失败: " + f)
+    print("%d 项检查, %d 项失败" % (checks[0], len(failed)))
+    return 1 if failed else 0
+
+
+def main():
+    p = argparse.ArgumentParser(description="测量校准工具")
+    sub = p.add_subparsers(dest="cmd")
+    s = sub.add_parser("frame")
+    s.add_argument("op", type=int)
+    s.add_argument("data", nargs="*")
+    s.add_argument("--station", type=lambda x: int(x, 0), default=0)
+    s = sub.add_parser("sim")
+    s.add_argument("--boards", type=int, default=200)
+    s.add_argument("--cc", default="gcc")
+    s = sub.add_parser("check")
+    s.add_argument("--cc", default="gcc")
+    args = p.parse_args()
+    handlers = {"frame": cmd_frame, "sim": cmd_sim, "check": cmd_check}
+    if args.cmd not in handlers:
+        p.print_help()
+        return 1
+    return handlers[args.cmd](args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,353 @@
+#!/usr/bin/env python3
+"""
+CRC 引擎基准/查表生成工具 (Components/Utility/utility_crc.c)
+
+  bench   用本机 gcc 按三种配置 (UTIL_CRC_PROFILE 0=逐位 1=半字节表 2=slicing-by-4)
+          分别编译 utility_crc.c, 校验标准测试向量 "123456789" 和分段增量计算,
+          输出每种算法的 字节/周期 (按 --mhz 换算) 和 Flash 占用 (代码+表).
+          找到 arm-none-eabi-gcc 时 Flash 占用按 cortex-m0plus -Os 编译统计,
+          否则用本机目标文件代替 (只作相对比较)
+  tables  输出 utility_crc.c 中的 C 查表 (修改多项式后重新生成)
+
+用法:
+  crc_bench.py bench [--size 65536] [--rounds 50] [--mhz 3000] [--cc gcc]
+  crc_bench.py tables
+"""
+
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+UTIL_DIR = os.path.normpath(os.path.join(HERE, "..", "..", "Components", "Utility"))
+
+PROFILES = ((0, "bitwise"), (1, "nibble"), (2, "slice4"))
+
+# 名称, 宽度, 多项式, 初始值, 反转, 结果异或, "123456789" 校验值
+ALGOS = (
+    ("crc8", 8, 0x07, 0x00, False, 0x00, 0xF4),
+    ("crc16_ccitt", 16, 0x1021, 0x0000, False, 0x0000, 0x31C3),
+    ("crc16_modbus", 16, 0x8005, 0xFFFF, True, 0x0000, 0x4B37),
+    ("crc32", 32, 0x04C11DB7, 0xFFFFFFFF, True, 0xFFFFFFFF, 0xCBF43926),
+)
+
+
+def reflect(v, width):
+    r = 0
+    for _ in range(width):
+        r = (r << 1) | (v & 1)
+        v >>= 1
+    return r
+
+
+def crc_byte_table(width, poly, refin):
+    """单字节表: 寄存器为0时一个字节的余式"""
+    mask = (1 << width) - 1
+    table = []
+    for i in range(256):
+        if refin:
+            rpoly = reflect(poly, width)
+            c = i
+            for _ in range(8):
+                c = (c >> 1) ^ rpoly if c & 1 else c >> 1
+        else:
+            top = 1 << (width - 1)
+            c = i << (width - 8)
+            for _ in range(8):
+                c = ((c << 1) ^ poly) if c & top else (c << 1)
+            c &= mask
+        table.append(c)
+    return table
+
+
+def crc_nibble_table(width, poly, refin):
+    mask = (1 << width) - 1
+    table = []
+    for i in range(16):
+        if refin:
+            rpoly = reflect(poly, width)
+            c = i
+            for _ in range(4):
+                c = (c >> 1) ^ rpoly if c & 1 else c >> 1
+        else:
+            top = 1 << (width - 1)
+            c = i << (width - 4)
+            for _ in range(4):
+                c = ((c << 1) ^ poly) if c & top else (c << 1)
+            c &= mask
+        table.append(c)
+    return table
+
+
+def crc_slice_tables(width, poly, refin):
+    """T[k][x]: 字节 x 后跟 k 个零字节的余式"""
+    mask = (1 << width) - 1
+    t0 = crc_byte_table(width, poly, refin)
+    tables = [t0]
+    for _ in range(3):
+        prev = tables[-1]
+        if refin:
+            nxt = [(c >> 8) ^ t0[c & 0xFF] for c in prev]
+        elif width == 8:
+            nxt = [t0[c] for c in prev]
+        else:
+            nxt = [((c << 8) & mask) ^ t0[c >> (width - 8)] for c in prev]
+        tables.append(nxt)
+    return tables
+
+
+def crc_ref(name, data):
+    for n, width, poly, init, refin, xorout, _ in ALGOS:
+        if n != name:
+            continue
+        t0 = crc_byte_table(width, poly, refin)
+        mask = (1 << width) - 1
+        c = init
+        for b in data:
+            if refin:
+                c = (c >> 8) ^ t0[(c ^ b) & 0xFF]
+            else:
+                c = ((c << 8) & mask) ^ t0[((c >> (width - 8)) ^ b) & 0xFF]
+        return c ^ xorout
+    raise KeyError(name)
+
+
+# ---------------------------------------------------------------- 查表输出
+
+def c_array(ctype, name, values, width, per_line):
+    digits = width // 4
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append("    " + ", ".join("0x%0*X" % (digits, v) for v in values[i:i + per_line]) + ",")
+    lines[-1] = lines[-1].rstrip(",")
+    return "static const %s %s = {\n%s};\n" % (ctype, name, "\n".join(lines))
+
+
+def c_slice(ctype, name, tables, width, per_line):
+    digits = width // 4
+    out = ["static const %s %s[4][256] = {" % (ctype, name)]
+    for k, t in enumerate(tables):
+        out.append("    {")
+        for i in range(0, 256, per_line):
+            out.append("        " + ", ".join("0x%0*X" % (digits, v) for v in t[i:i + per_line]) + ",")
+        out[-1] = out[-1].rstrip(",")
+        out.append("    }" + ("," if k < 3 else ""))
+    out.append("};")
+    return "\n".join(out) + "\n"
+
+
+def cmd_tables(args):
+    ctypes = {8: "uint8_t", 16: "uint16_t", 32: "uint32_t"}
+    per = {8: 12, 16: 8, 32: 6}
+    for name, width, poly, _, refin, _, _ in ALGOS:
+        print("/* %s nibble */" % name)
+        print(c_array(ctypes[width], "%s_nibble[16]" % name,
+                      crc_nibble_table(width, poly, refin), width, per[width]))
+        print("/* %s slice4 */" % name)
+        print(c_slice(ctypes[width], "%s_slice4" % name,
+                      crc_slice_tables(width, poly, refin), width, per[width]))
+    return 0
+
+
+# ---------------------------------------------------------------- 基准
+
+HARNESS = r"""
+#include "utility.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+#define BENCH(label, expr)                                                     \
+  do {                                                                         \
+    volatile uint32_t sink = 0;                                                \
+    double best = 1e30;                                                        \
+    for (int r = 0; r < rounds; r++) {                                         \
+      double t0 = now_ns();                                                    \
+      sink ^= (uint32_t)(expr);                                                \
+      double t = now_ns() - t0;                                                \
+      if (t < best) best = t;                                                  \
+    }                                                                          \
+    printf("time %s %.1f\n", label, best);                                     \
+  } while (0)
+
+int main(int argc, char **argv) {
+  uint32_t size = (uint32_t)atoi(argv[1]);
+  int rounds = atoi(argv[2]);
+  uint8_t *buf = malloc(size);
+  const uint8_t check[] = "123456789";
+  uint32_t seed = 1;
+  for (uint32_t i = 0; i < size; i++) {
+    seed = seed * 1103515245u + 12345u;
+    buf[i] = (uint8_t)(seed >> 16);
+  }
+
+  printf("check crc8 %u\n", util_crc8_update(UTIL_CRC8_INIT, check, 9));
+  printf("check crc16_ccitt %u\n", util_crc16_ccitt(check, 9));
+  printf("check crc16_modbus %u\n", util_crc16_modbus(check, 9));
+  printf("check crc32 %u\n", util_crc32(check, 9));
+
+  /* 分段增量: 各种长度和起始对齐 */
+  {
+    uint32_t a = 0, b = 0;
+    uint8_t c8 = UTIL_CRC8_INIT;
+    uint16_t cc = UTIL_CRC16_CCITT_INIT, cm = UTIL_CRC16_MODBUS_INIT;
+    uint32_t c32 = UTIL_CRC32_INIT;
+    uint32_t n = size < 4099 ? size : 4099;
+    while (a < n) {
+      b = a + 1 + (a * 7) % 13;
+      if (b > n) b = n;
+      c8 = util_crc8_update(c8, buf + a, b - a);
+      cc = util_crc16_ccitt_update(cc, buf + a, b - a);
+      cm = util_crc16_modbus_update(cm, buf + a, b - a);
+      c32 = util_crc32_update(c32, buf + a, b - a);
+      a = b;
+    }
+    printf("split crc8 %u %u\n", c8, util_crc8_update(UTIL_CRC8_INIT, buf, n));
+    printf("split crc16_ccitt %u %u\n", cc,
+           util_crc16_ccitt_update(UTIL_CRC16_CCITT_INIT, buf, n));
+    printf("split crc16_modbus %u %u\n", cm,
+           util_crc16_modbus_update(UTIL_CRC16_MODBUS_INIT, buf, n));
+    printf("split crc32 %u %u\n", c32, util_crc32(buf, n));
+  }
+
+  BENCH("crc8", util_crc8_update(UTIL_CRC8_INIT, buf, size));
+  BENCH("crc16_ccitt", util_crc16_ccitt_update(UTIL_CRC16_CCITT_INIT, buf, size));
+  BENCH("crc16_modbus", util_crc16_modbus_update(UTIL_CRC16_MODBUS_INIT, buf, size));
+  BENCH("crc32", util_crc32(buf, size));
+  return 0;
+}
+"""
+
+
+def bench_data(size):
+    """与 HARNESS 相同的伪随机数据"""
+    seed = 1
+    out = bytearray(size)
+    for i in range(size):
+        seed = (seed * 1103515245 + 12345) & 0xFFFFFFFF
+        out[i] = (seed >> 16) & 0xFF
+    return bytes(out)
+
+
+def cpu_mhz():
+    try:
+        with open("/proc/cpuinfo") as f:
+            for line in f:
+                if line.lower().startswith("cpu mhz"):
+                    return float(line.split(":")[1])
+    except OSError:
+        pass
+    return None
+
+
+def footprint(cc, size_tool, obj_args, src, tmp, profile):
+    """返回 {算法: 字节}: 按符号名归类 util_xxx 函数和 xxx_nibble/xxx_slice4 表"""
+    obj = os.path.join(tmp, "crc_%d_fp.o" % profile)
+    subprocess.check_call([cc] + obj_args + ["-ffunction-sections", "-fdata-sections",
+                                             "-I", UTIL_DIR,
+                                             "-DUTIL_CRC_PROFILE=%d" % profile,
+                                             "-DUTIL_CRC32_PROFILE=%d" % profile,
+                                             "-c", src, "-o", obj])
+    out = subprocess.check_output([size_tool, "--print-size", "--radix=d", obj],
+                                  universal_newlines=True)
+    sizes = dict.fromkeys([a[0] for a in ALGOS], 0)
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) != 4:
+            continue
+        size, name = int(parts[1]), parts[3]
+        for algo in sorted(sizes, key=len, reverse=True):
+            if algo in name:
+                sizes[algo] += size
+                break
+    return sizes
+
+
+def cmd_bench(args):
+    src = os.path.join(UTIL_DIR, "utility_crc.c")
+    cross = shutil.which("arm-none-eabi-gcc")
+    if cross:
+        fp_cc, fp_nm = cross, shutil.which("arm-none-eabi-nm") or "nm"
+        fp_args = ["-mcpu=cortex-m0plus", "-mthumb", "-Os"]
+        fp_note = "cortex-m0plus -Os"
+    else:
+        fp_cc, fp_nm = args.cc, "nm"
+        fp_args = ["-Os"]
+        fp_note = "本机 -Os (未找到 arm-none-eabi-gcc, 仅作相对比较)"
+
+    mhz = args.mhz or cpu_mhz()
+    if not mhz:
+        raise SystemExit("无法读取CPU频率, 请用 --mhz 指定")
+
+    expect = {a[0]: a[6] for a in ALGOS}
+    ref = {a[0]: crc_ref(a[0], bench_data(min(args.size, 4099))) for a in ALGOS}
+    rows = []
+    failed = 0
+    tmp = tempfile.mkdtemp(prefix="crc_bench_")
+    try:
+        harness = os.path.join(tmp, "harness.c")
+        with open(harness, "w") as f:
+            f.write(HARNESS)
+        for profile, pname in PROFILES:
+            exe = os.path.join(tmp, "crc_%d" % profile)
+            subprocess.check_call([args.cc, "-O2", "-I", UTIL_DIR,
+                                   "-DUTIL_CRC_PROFILE=%d" % profile,
+                                   "-DUTIL_CRC32_PROFILE=%d" % profile,
+                                   harness, src, "-o", exe])
+            out = subprocess.check_output([exe, str(args.size), str(args.rounds)],
+                                          universal_newlines=True)
+            fp = footprint(fp_cc, fp_nm, fp_args, src, tmp, profile)
+            times = {}
+            for line in out.splitlines():
+                parts = line.split()
+                if parts[0] == "check" and int(parts[2]) != expect[parts[1]]:
+                    print("错误: %s %s 校验值 0x%X, 应为 0x%X" % (
+                        pname, parts[1], int(parts[2]), expect[parts[1]]))
+                    failed += 1
+                elif parts[0] == "split" and not (
+                        int(parts[2]) == int(parts[3]) == ref[parts[1]]):
+                    print("错误: %s %s 分段增量结果不一致" % (pname, parts[1]))
+                    failed += 1
+                elif parts[0] == "time":
+                    times[parts[1]] = float(parts[2])
+            for algo, _, _, _, _, _, _ in ALGOS:
+                cycles = times[algo] * mhz / 1000.0
+                rows.append((pname, algo, args.size / max(cycles, 1.0), fp[algo]))
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+
+    print("数据 %d 字节, 取 %d 次最快, 本机 %.0f MHz; Flash 占用: %s\n" % (
+        args.size, args.rounds, mhz, fp_note))
+    print("%-8s %-14s %12s %12s" % ("配置", "算法", "字节/周期", "Flash字节"))
+    for pname, algo, bpc, fp in rows:
+        print("%-8s %-14s %12.3f %12d" % (pname, algo, bpc, fp))
+    if failed:
+        print("\n%d 项校验失败" % failed)
+        return 1
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="CRC 引擎基准/查表生成")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+    p = sub.add_parser("bench")
+    p.add_argument("--size", type=int, default=65536)
+    p.add_argument("--rounds", type=int, default=50)
+    p.add_argument("--mhz", type=float, help="本机CPU频率, 默认读 /proc/cpuinfo")
+    p.add_argument("--cc", default="gcc")
+    sub.add_parser("tables")
+    args = parser.parse_args()
+    return cmd_bench(args) if args.cmd == "bench" else cmd_tables(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,608 @@
+#!/usr/bin/env python3
+"""
+差分升级 上位机工具
+
+生成/应用差分包 (格式见 Components/Protocol/upgrade_delta.h), 生成前按
+upgrade_magic.c 的芯片表检查目标芯片、镜像大小和向量表, 并在本机
+用C还原器 (upgrade_delta.c + upgrade_bank.c + 模拟NOR) 统计工装上的
+还原时间。
+
+子命令:
+  diff  OLD.bin NEW.bin -o PATCH.bin [--chip FM33LG04x] [--version N]
+        生成差分包, 生成后用本脚本的参考还原器回放一遍, 结果必须与 NEW 一致
+  apply OLD.bin PATCH.bin -o NEW.bin
+        参考还原器 (与工装上的还原器同一格式), 校验基准和结果的CRC32
+  info  PATCH.bin
+        显示文件头
+  bench [--commits 5e395c4 fc73b0e ...] [--cc gcc]
+        有代表性的改动: 只改一个限值 (jig_config 默认值)、单个提交、整个
+        开发周期。每种改动在临时目录中用本机 gcc 编译新旧两版代码 (代理镜像,
+        见下), 生成差分包, 在模拟NOR上运行还原器, 输出 差分包大小、
+        9600波特率下的传输时间 (整包/差分) 和工装上的还原时间
+
+代理镜像: 沙箱里没有 arm-none-eabi-gcc, bench 用本机 gcc -Os 编译
+Src/Components 中能在本机编译的文件 (少数含Cortex-M汇编的文件跳过),
+链接成 APP 起始地址的平面镜像, 前面加一张向量表。指令集不同, 但
+"改一处、后面的函数整体挪位、调用地址跟着变" 的特点相同, 差分包大小
+的量级可以参考; 有真实固件时直接用 diff 子命令对比 .bin。
+
+用法:
+  delta_tool.py diff old.bin new.bin -o fw.dlt --version 20261016
+  delta_tool.py bench
+"""
+
+import argparse
+import os
+import re
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import zlib
+from concurrent.futures import ThreadPoolExecutor
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.normpath(os.path.join(HERE, "..", ".."))
+COMP = os.path.join(ROOT, "Components")
+FDB = os.path.join(COMP, "FlashDB")
+
+# upgrade_delta.h
+DELTA_MAGIC = 0x544C444A
+HDR_FMT = "<IBBHIIIIII"
+HDR_SIZE = struct.calcsize(HDR_FMT)
+RLE_LITERAL = 0x00
+RLE_REPEAT = 0x01
+RLE_MIN_RUN = 5
+
+# upgrade_magic.h
+MAGIC_PREFIX = 0xF7
+
+# 总线 (与 bank_sim.py 相同)
+RX_IDLE_MS = 100
+TX_PRE_MS = 5
+BANK_OVERHEAD = 11
+BANK_ACK_LEN = 13
+CHUNK = 128
+
+CPU_HZ = 32000000.0
+
+# 差分匹配: 以 MATCH_KEY 字节为索引找旧镜像中的完全匹配,
+# 再按 bsdiff 的方法向两侧扩展成"大部分相同"的区段
+MATCH_KEY = 8
+MATCH_CANDIDATES = 32
+
+
+def crc32(data):
+    return zlib.crc32(data) & 0xFFFFFFFF
+
+
+# ---------------------------------------------------------------- 芯片表
+
+def load_chip_table():
+    """解析 upgrade_magic.h/.c, 返回 {名称: 芯片信息}"""
+    with open(os.path.join(COMP, "Protocol", "upgrade_magic.h"), encoding="utf-8") as f:
+        hdr = f.read()
+    with open(os.path.join(COMP, "Protocol", "upgrade_magic.c"), encoding="utf-8") as f:
+        src = f.read()
+    consts = {k: int(v, 0) for k, v in
+              re.findall(r"\b([A-Z][A-Z0-9_]+)\s*=\s*(0x[0-9A-Fa-f]+|\d+)\s*,", hdr)}
+
+    aliases = dict(re.findall(r"#define (\w+) ([A-Z_][A-Z0-9_]*)\s*$", hdr, re.M))
+
+    def value(expr):
+        expr = aliases.get(expr.strip(), expr.strip())
+        m = re.match(r"^(\d+)\s*\*\s*1024$", expr)
+        if m:
+            return int(m.group(1)) * 1024
+        if expr in consts:
+            return consts[expr]
+        return int(expr, 0)
+
+    table = {}
+    for body in re.findall(r"\{(\s*\.vendor_code.*?)\}", src, re.S):
+        body = re.sub(r"/\*.*?\*/", "", body, flags=re.S)
+        fields = dict(re.findall(r"\.(\w+)\s*=\s*([^,]+?)\s*(?:,|$)", body))
+        if '"' not in fields.get("name", ""):
+            continue
+        info = {k: value(v) for k, v in fields.items() if k != "name"}
+        info["name"] = fields["name"].strip().strip('"')
+        table[info["name"]] = info
+    current = re.search(r"#define CURRENT_CHIP_CODE (\w+)", hdr).group(1)
+    current = next(n for n, i in table.items() if i["chip_code"] == consts[current])
+    return table, current
+
+
+def bank_app_size():
+    with open(os.path.join(COMP, "Protocol", "upgrade_bank.h"), encoding="utf-8") as f:
+        m = re.search(r"#define UPGRADE_BANK_APP_SIZE \((\d+) \* 1024\)", f.read())
+    return int(m.group(1)) * 1024
+
+
+def check_image(chip, image, what):
+    """新镜像须能放进APP区 (和B区), 向量表指向RAM和APP区"""
+    limit = chip["flash_size"] - chip["bootloader_size"]
+    if chip["name"].startswith("FM33LG04"):
+        limit = min(limit, bank_app_size())
+    if len(image) > limit:
+        raise SystemExit("%s %dB 超出 %s APP区 %dB" % (what, len(image), chip["name"], limit))
+    if len(image) < 8:
+        raise SystemExit("%s 太短" % what)
+    sp, reset = struct.unpack_from("<II", image)
+    app = chip["app_start"]
+    if sp & 0xFFF00000 != 0x20000000 or not (reset & 1) or \
+            not app <= (reset & ~1) < app + len(image):
+        raise SystemExit("%s 向量表不像 %s 的APP (SP=0x%08X 复位=0x%08X, APP起始0x%08X)"
+                         % (what, chip["name"], sp, reset, app))
+
+
+# ---------------------------------------------------------------- 编码
+
+def varint(v):
+    out = bytearray()
+    while True:
+        b = v & 0x7F
+        v >>= 7
+        if v:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+
+def zigzag(v):
+    return v * 2 if v >= 0 else -v * 2 - 1
+
+
+def unzigzag(z):
+    return (z >> 1) ^ -(z & 1)
+
+
+def rle_encode(data):
+    out = bytearray()
+    lit = bytearray()
+    i, n = 0, len(data)
+
+    def flush():
+        if lit:
+            out.append(RLE_LITERAL)
+            out.extend(varint(len(lit)))
+            out.extend(lit)
+            del lit[:]
+
+    while i < n:
+        j = i + 1
+        while j < n and data[j] == data[i]:
+            j += 1
+        if j - i >= RLE_MIN_RUN:
+            flush()
+            out.append(RLE_REPEAT)
+            out += varint(j - i)
+            out.append(data[i])
+        else:
+            lit += data[i:j]
+        i = j
+    flush()
+    return bytes(out)
+
+
+def bsdiff_records(old, new):
+    """bsdiff 主循环 (完全匹配用哈希索引代替后缀数组), 返回 [(diff, extra, seek)]"""
+    oldsize, newsize = len(old), len(new)
+    index = {}
+    for i in range(oldsize - MATCH_KEY + 1):
+        lst = index.setdefault(old[i:i + MATCH_KEY], [])
+        if len(lst) < MATCH_CANDIDATES:
+            lst.append(i)
+
+    def search(scan):
+        cands = index.get(new[scan:scan + MATCH_KEY])
+        best_len, best_pos = 0, 0
+        if not cands:
+            return 0, 0
+        for p in cands:
+            n = MATCH_KEY
+            while p + n < oldsize and scan + n < newsize:
+                step = min(64, oldsize - p - n, newsize - scan - n)
+                if old[p + n:p + n + step] == new[scan + n:scan + n + step]:
+                    n += step
+                    continue
+                while old[p + n] == new[scan + n]:
+                    n += 1
+                break
+            if n > best_len:
+                best_len, best_pos = n, p
+        return best_len, best_pos
+
+    records = []
+    scan = length = pos = 0
+    lastscan = lastpos = lastoffset = 0
+    while scan < newsize:
+        oldscore = 0
+        scan += length
+        scsc = scan
+        while scan < newsize:
+            length, pos = search(scan)
+            while scsc < scan + length:
+                if 0 <= scsc + lastoffset < oldsize and old[scsc + lastoffset] == new[scsc]:
+                    oldscore += 1
+                scsc += 1
+            if (length == oldscore and length != 0) or length > oldscore + 8:
+                break
+            if 0 <= scan + lastoffset < oldsize and old[scan + lastoffset] == new[scan]:
+                oldscore -= 1
+            scan += 1
+
+        if length != oldscore or scan == newsize:
+            s = sf = lenf = 0
+            i = 0
+            while lastscan + i < scan and lastpos + i < oldsize:
+                if old[lastpos + i] == new[lastscan + i]:
+                    s += 1
+                i += 1
+                if s * 2 - i > sf * 2 - lenf:
+                    sf, lenf = s, i
+            lenb = 0
+            if scan < newsize:
+                s = sb = 0
+                i = 1
+                while scan >= lastscan + i and pos >= i:
+                    if old[pos - i] == new[scan - i]:
+                        s += 1
+                    if s * 2 - i > sb * 2 - lenb:
+                        sb, lenb = s, i
+                    i += 1
+            if lastscan + lenf > scan - lenb:
+                overlap = (lastscan + lenf) - (scan - lenb)
+                s = ss = lens = 0
+                for i in range(overlap):
+                    if new[lastscan + lenf - overlap + i] == old[lastpos + lenf - overlap + i]:
+                        s += 1
+                    if new[scan - lenb + i] == old[pos - lenb + i]:
+                        s -= 1
+                    if s > ss:
+                        ss, lens = s, i + 1
+                lenf += lens - overlap
+                lenb -= lens
+            diff = bytes((new[lastscan + i] - old[lastpos + i]) & 0xFF for i in range(lenf))
+            extra = new[lastscan + lenf:scan - lenb]
+            seek = (pos - lenb) - (lastpos + lenf)
+            if diff or extra:
+                records.append([diff, extra, seek])
+            elif records:
+                records[-1][2] += seek
+            elif seek:
+                records.append([b"", b"", seek])
+            lastscan = scan - lenb
+            lastpos = pos - lenb
+            lastoffset = pos - scan
+    return records
+
+
+def make_patch(old, new, target, version):
+    body = bytearray()
+    for diff, extra, seek in bsdiff_records(old, new):
+        body += varint(len(diff)) + varint(len(extra)) + varint(zigzag(seek))
+        body += diff + extra
+    hdr = struct.pack(HDR_FMT[:-1], DELTA_MAGIC, target[0], target[1], target[2],
+                      len(old), crc32(old), len(new), crc32(new), version)
+    return hdr + struct.pack("<I", crc32(hdr)) + rle_encode(bytes(body))
+
+
+def parse_header(patch):
+    if len(patch) < HDR_SIZE:
+        raise SystemExit("差分包太短")
+    f = struct.unpack_from(HDR_FMT, patch)
+    if f[0] != DELTA_MAGIC or f[-1] != crc32(patch[:HDR_SIZE - 4]):
+        raise SystemExit("差分包文件头无效")
+    return {"target": (f[1], f[2], f[3]), "old_size": f[4], "old_crc": f[5],
+            "new_size": f[6], "new_crc": f[7], "version": f[8]}
+
+
+def apply_patch(old, patch):
+    """参考还原器, 与 upgrade_delta.c 同一格式"""
+    h = parse_header(patch)
+    if len(old) != h["old_size"] or crc32(old) != h["old_crc"]:
+        raise SystemExit("基准镜像与差分包不符")
+    stream = bytearray()
+    data, i = patch[HDR_SIZE:], 0
+
+    def read_varint(buf, k):
+        v = shift = 0
+        while True:
+            b = buf[k]
+            k += 1
+            v |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                return v, k
+
+    while i < len(data):
+        tag = data[i]
+        n, i = read_varint(data, i + 1)
+        if tag == RLE_LITERAL:
+            stream += data[i:i + n]
+            i += n
+        elif tag == RLE_REPEAT:
+            stream += bytes([data[i]]) * n
+            i += 1
+        else:
+            raise SystemExit("差分包游程标记错误")
+
+    new = bytearray()
+    k = oldpos = 0
+    while k < len(stream):
+        dlen, k = read_varint(stream, k)
+        elen, k = read_varint(stream, k)
+        z, k = read_varint(stream, k)
+        new += bytes((old[oldpos + j] + stream[k + j]) & 0xFF for j in range(dlen))
+        k += dlen
+        oldpos += dlen
+        new += stream[k:k + elen]
+        k += elen
+        oldpos += unzigzag(z)
+    if len(new) != h["new_size"] or crc32(new) != h["new_crc"]:
+        raise SystemExit("还原结果CRC错误")
+    return bytes(new)
+
+
+# ---------------------------------------------------------------- 代理镜像
+
+PROXY_DIRS = ["Src", "Inc", "Components", "MF-config", "Drivers/CMSIS",
+              "Drivers/FM33LG0xx_FL_Driver"]
+PROXY_GLOBS = ["Src", "Components/Utility", "Components/Protocol", "Components/FlashDB",
+               "Components/TimeManager", "Components/LedIndicator", "MF-config/Src",
+               "Drivers/FM33LG0xx_FL_Driver/Src"]
+PROXY_INC = ["Inc", "MF-config/Inc", "Drivers/CMSIS/Device/FM/FM33xx/Include",
+             "Drivers/FM33LG0xx_FL_Driver/Inc", "Components", "Components/Protocol",
+             "Components/Protocol/PC", "Components/Protocol/Device", "Components/Utility",
+             "Components/TimeManager", "Components/LedIndicator", "Components/FlashDB",
+             "Components/FlashDB/inc", "Components/FlashDB/port/fal/inc",
+             "Components/EasyLogger/easylogger/inc"]
+VECTOR_BYTES = 0xC0
+
+
+def proxy_image(rev, tmp, tag, edits=()):
+    """在 rev 版本上 (可附加源码修改) 用本机 gcc 编译代理镜像"""
+    src = os.path.join(tmp, tag)
+    os.makedirs(src)
+    archive = subprocess.run(["git", "-C", ROOT, "archive", rev] + PROXY_DIRS,
+                             stdout=subprocess.PIPE, check=True).stdout
+    subprocess.run(["tar", "-x", "-C", src], input=archive, check=True)
+    for path, old, new in edits:
+        p = os.path.join(src, path)
+        with open(p, "rb") as f:
+            text = f.read()
+        if old not in text:
+            raise SystemExit("%s: 找不到要修改的内容" % path)
+        with open(p, "wb") as f:
+            f.write(text.replace(old, new, 1))
+    # CMSIS 头文件大小写与 #include 不一致, 本机文件系统区分大小写
+    stub = os.path.join(src, "_stub")
+    os.makedirs(stub)
+    inc = os.path.join(src, "Drivers/CMSIS/Device/FM/FM33xx/Include")
+    for name in os.listdir(inc):
+        if name.lower() != name:
+            shutil.copy(os.path.join(inc, name), os.path.join(stub, name.lower()))
+
+    files = []
+    for d in PROXY_GLOBS:
+        full = os.path.join(src, d)
+        if os.path.isdir(full):
+            files += sorted(os.path.join(d, n) for n in os.listdir(full) if n.endswith(".c"))
+    flags = ["gcc", "-c", "-Os", "-w", "-std=gnu11", "-fno-pic", "-fno-asynchronous-unwind-tables",
+             "-fno-stack-protector", "-DFM33LG0XX", "-I", stub]
+    flags += ["-I" + os.path.join(src, d) for d in PROXY_INC]
+
+    def compile_one(f):
+        obj = os.path.join(src, f.replace("/", "_") + ".o")
+        r = subprocess.run(flags + [os.path.join(src, f), "-o", obj],
+                           stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        return obj if r.returncode == 0 else None
+
+    with ThreadPoolExecutor(max_workers=os.cpu_count() or 4) as pool:
+        objs = [o for o in pool.map(compile_one, files) if o]
+    elf = os.path.join(src, "app.elf")
+    subprocess.check_call(["ld", "-static", "-nostdlib", "-N", "-e", "main",
+                           "--unresolved-symbols=ignore-all", "--no-warn-rwx-segments",
+                           "-Ttext=0x%X" % (0x4000 + VECTOR_BYTES), "-o", elf] + objs)
+    binf = os.path.join(src, "app.bin")
+    subprocess.check_call(["objcopy", "-O", "binary", "-R", ".comment", "-R", ".note*",
+                           "-R", ".bss", elf, binf])
+    with open(binf, "rb") as f:
+        body = f.read()
+    vec = struct.pack("<II", 0x20008000, 0x4000 + VECTOR_BYTES + 1)
+    vec += b"\x00" * (VECTOR_BYTES - len(vec))
+    return vec + body, len(objs), len(files)
+
+
+def run_device(cc, old, new, patch, tmp):
+    """在模拟NOR上运行 upgrade_delta.c, 返回各步耗时"""
+    with open(os.path.join(tmp, "elog.h"), "w") as f:
+        f.write("#define log_i(...)\n#define log_e(...)\n"
+                "#define log_w(...)\n#define log_d(...)\n")
+    exe = os.path.join(tmp, "delta_bench")
+    if not os.path.exists(exe):
+        srcs = ["FlashDB/port/fal/src/fal.c", "FlashDB/port/fal/src/fal_flash.c",
+                "FlashDB/port/fal/src/fal_partition.c", "FlashDB/fal_flash_fm33lg04_port.c",
+                "FlashDB/sim/flash_sim.c", "Protocol/upgrade_delta.c",
+                "Protocol/upgrade_bank.c", "Protocol/upgrade_storage.c",
+                "Protocol/upgrade_magic.c", "Utility/utility_crc.c",
+                "Protocol/sim/delta_bench.c"]
+        # Bootloader模式的布局 (APP在0x4000), 独立运行时B区下载被拒绝
+        cmd = [cc, "-O2", "-w", "-DFAL_FLASH_SIM", "-DUSE_BOOTLOADER", "-DFAL_PRINTF(...)=", "-I", tmp,
+               "-I", FDB, "-I", os.path.join(FDB, "inc"),
+               "-I", os.path.join(FDB, "port", "fal", "inc"), "-I", os.path.join(FDB, "sim"),
+               "-I", os.path.join(COMP, "Protocol"), "-I", os.path.join(COMP, "Utility")]
+        subprocess.check_call(cmd + [os.path.join(COMP, s) for s in srcs] + ["-o", exe])
+    paths = []
+    for name, data in (("old", old), ("new", new), ("patch", patch)):
+        p = os.path.join(tmp, name + ".bin")
+        with open(p, "wb") as f:
+            f.write(data)
+        paths.append(p)
+    out = subprocess.check_output([exe] + paths + [str(CHUNK)], universal_newlines=True)
+    ms = lambda c: int(c) * 1000.0 / CPU_HZ
+    res = {}
+    for line in out.splitlines():
+        p = line.split()
+        if p[:2] == ["op", "begin"]:
+            res["begin_ms"] = ms(p[2])
+        elif p[:2] == ["op", "call"]:
+            res["calls"] = int(p[2])
+            res["apply_ms"] = ms(p[3])
+            res["call_max_ms"] = ms(p[4])
+        elif p[:2] == ["op", "commit"]:
+            res["commit_ms"] = ms(p[2])
+        elif p[0] == "img":
+            res["erases"] = int(p[3])
+            res["pauses"] = int(p[4])
+    return res
+
+
+def bus_ms(payload, frames, baud, gap):
+    """0xBC 下发 payload 字节 (frames 帧, 含暂停后的续传) 的总线时间"""
+    b = 10.0 * 1000.0 / baud
+    return payload * b + frames * ((BANK_OVERHEAD + BANK_ACK_LEN) * b + RX_IDLE_MS
+                                   + TX_PRE_MS + gap)
+
+
+# ---------------------------------------------------------------- 子命令
+
+def chip_magic(name):
+    table, current = load_chip_table()
+    name = name or current
+    if name not in table:
+        raise SystemExit("芯片表中没有 %s, 可选: %s" % (name, ", ".join(sorted(table))))
+    chip = table[name]
+    return chip, (MAGIC_PREFIX, chip["vendor_code"], chip["chip_code"])
+
+
+def cmd_diff(args):
+    chip, target = chip_magic(args.chip)
+    with open(args.old, "rb") as f:
+        old = f.read()
+    with open(args.new, "rb") as f:
+        new = f.read()
+    check_image(chip, old, "旧镜像")
+    check_image(chip, new, "新镜像")
+    patch = make_patch(old, new, target, args.version)
+    if apply_patch(old, patch) != new:
+        raise SystemExit("差分包自检失败")
+    with open(args.output, "wb") as f:
+        f.write(patch)
+    print("%s: %s, %dB -> %dB, 差分包 %dB (%.1f%%)" % (
+        args.output, chip["name"], len(old), len(new), len(patch),
+        len(patch) * 100.0 / len(new)))
+    return 0
+
+
+def cmd_apply(args):
+    with open(args.old, "rb") as f:
+        old = f.read()
+    with open(args.patch, "rb") as f:
+        patch = f.read()
+    new = apply_patch(old, patch)
+    with open(args.output, "wb") as f:
+        f.write(new)
+    print("%s: %dB, CRC32=0x%08X" % (args.output, len(new), crc32(new)))
+    return 0
+
+
+def cmd_info(args):
+    with open(args.patch, "rb") as f:
+        patch = f.read()
+    h = parse_header(patch)
+    table, _ = load_chip_table()
+    name = next((n for n, i in table.items() if i["vendor_code"] == h["target"][1]
+                 and i["chip_code"] == h["target"][2]), "未知芯片")
+    print("目标: %02X %02X %04X (%s)" % (h["target"] + (name,)))
+    print("基准: %dB CRC32=0x%08X" % (h["old_size"], h["old_crc"]))
+    print("新镜像: %dB CRC32=0x%08X 版本 %d" % (h["new_size"], h["new_crc"], h["version"]))
+    print("差分数据: %dB" % (len(patch) - HDR_SIZE))
+    return 0
+
+
+LIMIT_EDIT = ("Components/FlashDB/jig_config.c",
+              b'{"vcc_min", JIG_CFG_TYPE_U16, 3000, 0, 20000}',
+              b'{"vcc_min", JIG_CFG_TYPE_U16, 3100, 0, 20000}')
+
+
+def cmd_bench(args):
+    chip, target = chip_magic(None)
+    tmp = tempfile.mkdtemp(prefix="delta_tool_")
+    try:
+        cases = [("限值表 (vcc_min 3000->3100)", "HEAD", "HEAD", [LIMIT_EDIT])]
+        for c in args.commits:
+            subject = subprocess.check_output(
+                ["git", "-C", ROOT, "log", "-1", "--format=%s", c],
+                universal_newlines=True).strip()
+            cases.append((subject[:36], c + "^", c, []))
+        cases.append(("%s..HEAD (开发周期)" % args.since[:7], args.since, "HEAD", []))
+
+        rows = []
+        for k, (name, old_rev, new_rev, edits) in enumerate(cases):
+            old, nobj, nfiles = proxy_image(old_rev, tmp, "o%d" % k)
+            new, _, _ = proxy_image(new_rev, tmp, "n%d" % k, edits)
+            check_image(chip, new, name)
+            patch = make_patch(old, new, target, 0)
+            if apply_patch(old, patch) != new:
+                raise SystemExit("%s: 差分包自检失败" % name)
+            dev = run_device(args.cc, old, new, patch, tmp)
+            full_frames = (len(new) + CHUNK - 1) // CHUNK
+            body = len(patch) - HDR_SIZE
+            rows.append((name, len(old), len(new), len(patch), dev,
+                         bus_ms(len(new), full_frames, args.baud, args.gap),
+                         bus_ms(body, dev["calls"], args.baud, args.gap)))
+
+        print("代理镜像: 本机 gcc -Os, %d/%d 个源文件, 9600波特率每帧 %d 字节" % (
+            nobj, nfiles, CHUNK))
+        print("%-36s %8s %8s %8s %7s %9s %9s %9s %9s" % (
+            "改动", "旧镜像", "新镜像", "差分包", "比例", "整包传输", "差分传输",
+            "还原", "单帧max"))
+        for name, ol, nl, pl, dev, full, delta in rows:
+            apply_ms = dev["begin_ms"] + dev["apply_ms"] + dev["commit_ms"]
+            print("%-36s %7dB %7dB %7dB %6.1f%% %8.1fs %8.1fs %7.0fms %7.1fms" % (
+                name, ol, nl, pl, pl * 100.0 / nl, full / 1000, delta / 1000,
+                apply_ms, dev["call_max_ms"]))
+        print("")
+        print("还原 = 差分开始 (APP区CRC) + 全部数据帧 + 提交 (B区回读CRC), 按模拟NOR周期和32MHz换算;")
+        print("单帧max 为主循环单次阻塞 (每次最多输出 %d 字节, 含扇区擦除)" % 2048)
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+    return 0
+
+
+def main():
+    p = argparse.ArgumentParser(description="差分升级上位机工具")
+    sub = p.add_subparsers(dest="cmd")
+    s = sub.add_parser("diff", help="生成差分包")
+    s.add_argument("old")
+    s.add_argument("new")
+    s.add_argument("-o", "--output", required=True)
+    s.add_argument("--chip", help="芯片名称 (upgrade_magic.c), 默认当前芯片")
+    s.add_argument("--version", type=int, default=0)
+    s = sub.add_parser("apply", help="参考还原器")
+    s.add_argument("old")
+    s.add_argument("patch")
+    s.add_argument("-o", "--output", required=True)
+    s = sub.add_parser("info", help="显示差分包文件头")
+    s.add_argument("patch")
+    s = sub.add_parser("bench", help="代表性改动的差分包大小和还原时间")
+    s.add_argument("--commits", nargs="*", default=["5e395c4", "fc73b0e", "a491d29"],
+                   help="逐个与父提交比较")
+    s.add_argument("--since", default="ab628b8", help="开发周期起点")
+    s.add_argument("--baud", type=int, default=9600)
+    s.add_argument("--gap", type=float, default=10.0, help="上位机收到应答后再发送的间隔(ms)")
+    s.add_argument("--cc", default="gcc")
+    args = p.parse_args()
+
+    handlers = {"diff": cmd_diff, "apply": cmd_apply, "info": cmd_info, "bench": cmd_bench}
+    if args.cmd not in handlers:
+        p.print_help()
+        return 1
+    return handlers[args.cmd](args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
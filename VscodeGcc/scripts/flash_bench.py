@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""
+FlashDB / FAL 移植层 本机基准工具
+
+用本机 gcc 把 FlashDB (KVDB)、FAL、fal_flash_fm33lg04_port.c 与 RAM 模拟 NOR
+(Components/FlashDB/sim) 编译在一起, 按几种移植层配置运行相同负载:
+  kv_set   轮流改写8个配置键 (jig_config 写入)
+  kv_get   读取配置键
+  kv_boot  反复 deinit/init (上电扫描)
+  stats    擦除后写入64字节并读回 (test_stats 汇总)
+  cfg_get  jig_config.c 的 JigConfig_Benchmark (缓存读 / KVDB 直接读各100次)
+输出每种配置的 操作/秒 (按模拟器周期模型和 32MHz 换算)、编程次数/字数、
+擦除次数和单扇区最大擦除次数 (磨损), 以及读缓存命中率; 最后列出各配置下
+JigConfig_Benchmark 的结果 (时间按模拟器周期: 只计 Flash 访问, 缓存读取为0)。
+
+配置:
+  before  逐字编程, 不缓存 (FAL_FM33_WC_ROW_SIZE=0, FAL_FM33_RC_LINES=0)
+  wc      写合并 (当前默认)
+  wc+rc   写合并 + 4行读缓存
+
+用法:
+  flash_bench.py [--scale 1] [--cc gcc] [-D FLASH_SIM_COST_PROG_WORD=1200 ...]
+"""
+
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+FDB = os.path.normpath(os.path.join(HERE, "..", "..", "Components", "FlashDB"))
+
+SOURCES = [
+    "src/fdb.c", "src/fdb_kvdb.c", "src/fdb_utils.c",
+    "port/fal/src/fal.c", "port/fal/src/fal_flash.c", "port/fal/src/fal_partition.c",
+    "fal_flash_fm33lg04_port.c", "sim/flash_sim.c", "jig_config.c", "sim/flash_bench.c",
+]
+
+VARIANTS = (
+    ("before", ["FAL_FM33_WC_ROW_SIZE=0", "FAL_FM33_RC_LINES=0"]),
+    ("wc", []),
+    ("wc+rc", ["FAL_FM33_RC_LINES=4"]),
+)
+
+FIELDS = ("ops", "cycles", "sessions", "words", "skipped", "erases",
+          "max_erase", "rc_hits", "rc_misses", "double_prog")
+
+CPU_HZ = 32000000.0
+
+
+def build_and_run(cc, defines, scale, tmp, tag):
+    exe = os.path.join(tmp, "flash_bench_%s" % tag.replace("+", "_"))
+    cmd = [cc, "-O2", "-w", "-DFAL_FLASH_SIM", "-I", tmp,
+           "-I", FDB, "-I", os.path.join(FDB, "inc"),
+           "-I", os.path.join(FDB, "port", "fal", "inc"), "-I", os.path.join(FDB, "sim")]
+    cmd += ["-D" + d for d in defines]
+    cmd += [os.path.join(FDB, s) for s in SOURCES] + ["-o", exe]
+    subprocess.check_call(cmd)
+    out = subprocess.check_output([exe, str(scale)], universal_newlines=True)
+    result = {}
+    for line in out.splitlines():
+        parts = line.split()
+        if parts and parts[0] == "wl":
+            result[parts[1]] = dict(zip(FIELDS, map(int, parts[2:])))
+        elif parts and parts[0] == "cfg":
+            result["cfg"] = (int(parts[1]), int(parts[2]))
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description="FlashDB/FAL 移植层本机基准")
+    parser.add_argument("--scale", type=int, default=1, help="负载次数倍数")
+    parser.add_argument("--cc", default="gcc")
+    parser.add_argument("-D", dest="defines", action="append", default=[],
+                        help="覆盖周期模型参数, 如 FLASH_SIM_COST_PROG_WORD=1200")
+    args = parser.parse_args()
+
+    tmp = tempfile.mkdtemp(prefix="flash_bench_")
+    # jig_config.c 本机编译不带 EasyLogger, 日志宏置空
+    with open(os.path.join(tmp, "elog.h"), "w") as f:
+        f.write("#define log_i(...)\n#define log_e(...)\n"
+                "#define log_w(...)\n#define log_d(...)\n")
+    results = []
+    try:
+        for name, defines in VARIANTS:
+            results.append((name, build_and_run(args.cc, defines + args.defines,
+                                                args.scale, tmp, name)))
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+
+    base = results[0][1]
+    print("%-8s %-7s %6s %10s %7s %8s %6s %6s %6s %7s %6s" % (
+        "负载", "配置", "操作", "操作/秒", "相对", "编程次数", "编程字",
+        "擦除", "最大", "缓存命中", "重复"))
+    failed = 0
+    for wl in base:
+        if wl == "cfg":
+            continue
+        for name, res in results:
+            r = res[wl]
+            ops_s = r["ops"] * CPU_HZ / max(1, r["cycles"])
+            rel = float(base[wl]["cycles"]) / max(1, r["cycles"])
+            lookups = r["rc_hits"] + r["rc_misses"]
+            print("%-8s %-7s %6d %10.0f %6.2fx %8d %6d %6d %6d %7s %6d" % (
+                wl, name, r["ops"], ops_s, rel, r["sessions"], r["words"],
+                r["erases"], r["max_erase"],
+                "%.0f%%" % (r["rc_hits"] * 100.0 / lookups) if lookups else "-",
+                r["double_prog"]))
+            if r["double_prog"]:
+                failed += 1
+        print("")
+    print("JigConfig_Benchmark (模拟器周期, 缓存读取不访问Flash, 计为0):")
+    for name, res in results:
+        print("  %-7s 缓存 %dns/次, KVDB直接读 %dus/次" % ((name,) + res["cfg"]))
+    if failed:
+        print("警告: 有未擦除即编程的字 (重复编程)")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
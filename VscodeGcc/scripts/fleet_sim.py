@@ -0,0 +1,305 @@
+#!/usr/bin/env python3
+"""
+整线广播升级 仿真工具
+
+比较同一条 RS-485 总线上 N 个工位的两种后台下载方式 (pc_protocol_upgrade.c 0xBC):
+  unicast    逐个工位: 开始 -> 数据(一问一答, 按"下一偏移"续传) -> 提交,
+             整个镜像在总线上发 N 遍
+  broadcast  分块开始/分块数据用工位号 0xFF 广播, 各工位不应答, 只发一遍;
+             之后逐个工位查询缺块位图, 广播所有工位缺块的并集, 重复直到收齐,
+             最后逐个工位提交, 提交时回读B区CRC32 通过才算完成
+
+工位不是估算模型: 脚本用本机 gcc 把 pc_protocol_upgrade.c、upgrade_bank.c、
+FAL、移植层和 RAM 模拟 NOR 编译成 Components/Protocol/sim/fleet_bench.c,
+每个模拟工位一个进程, 上位机发出的每一帧都交给真实的协议处理函数,
+应答、缺块位图、提交结果都来自固件代码; 每帧的处理时间取模型周期。
+
+丢帧: 每个工位一个 Gilbert 信道 (好/坏两状态, 坏状态连续丢帧,
+--burst 为平均连续丢帧数, --loss 为平均丢帧率), 下发帧和应答帧都可能丢。
+丢了的单播帧等 --timeout 后重发; 丢了的广播帧由缺块查询补发。
+
+总线时间按固件时序: 9600波特率每字节10位, 接收帧间隔超时100ms后才处理,
+发送前5ms, 上位机收到应答 (或广播帧处理完) 后再隔 --gap 发下一帧。
+
+用法:
+  fleet_sim.py [--stations 1,4,8,16] [--image-kb 96] [--loss 0.05] [--burst 4]
+               [--baud 9600] [--seed 1] [--cc gcc]
+"""
+
+import argparse
+import os
+import random
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import zlib
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+COMP = os.path.normpath(os.path.join(HERE, "..", "..", "Components"))
+FDB = os.path.join(COMP, "FlashDB")
+
+sys.path.insert(0, HERE)
+from delta_tool import chip_magic  # noqa: E402
+
+SOURCES = [
+    "FlashDB/port/fal/src/fal.c", "FlashDB/port/fal/src/fal_flash.c",
+    "FlashDB/port/fal/src/fal_partition.c", "FlashDB/fal_flash_fm33lg04_port.c",
+    "FlashDB/sim/flash_sim.c", "Protocol/upgrade_bank.c",
+    "Protocol/upgrade_delta.c", "Protocol/upgrade_storage.c",
+    "Protocol/upgrade_magic.c", "Utility/utility_crc.c",
+    "Protocol/PC/pc_protocol_upgrade.c", "Protocol/PC/pc_protocol_common.c",
+    "Protocol/PC/pc_cmd_table.c", "Protocol/sim/fleet_bench.c",
+]
+
+CPU_HZ = 32000000.0
+
+# 固件时序 (与 bank_sim.py 相同)
+RX_IDLE_MS = 100
+TX_PRE_MS = 5
+
+# pc_protocol_upgrade.c 0xBC
+CMD_BANK_LOAD = 0xBC
+BROADCAST = 0xFF
+SUB_BEGIN, SUB_DATA, SUB_STATUS, SUB_COMMIT = 0x00, 0x01, 0x02, 0x03
+SUB_BLOCK_BEGIN, SUB_BLOCK_DATA, SUB_MISSING = 0x07, 0x08, 0x09
+CHUNK = 128             # UPGRADE_BANK_CHUNK_MAX / UPGRADE_BANK_BLOCK_SIZE
+MISSING_WINDOW = 128    # 缺块应答位图覆盖的块数
+
+# upgrade_bank.h UpgradeBankResult
+BANK_OK = 0x00
+BANK_ERR_OFFSET = 0x05
+BANK_ERR_STATE = 0x06
+
+
+def frame(station, sub, payload=b""):
+    body = bytes([0x55, CMD_BANK_LOAD, 7 + len(payload), station, sub]) + payload
+    return body + bytes([sum(body) & 0xFF, 0xAA])
+
+
+def build(cc, tmp):
+    # 本机编译不带 EasyLogger, 日志宏置空
+    with open(os.path.join(tmp, "elog.h"), "w") as f:
+        f.write("#define log_i(...)\n#define log_e(...)\n"
+                "#define log_w(...)\n#define log_d(...)\n")
+    exe = os.path.join(tmp, "fleet_bench")
+    # Bootloader模式的布局 (APP在0x4000), 独立运行时B区下载被拒绝
+    cmd = [cc, "-O2", "-w", "-DFAL_FLASH_SIM", "-DUSE_BOOTLOADER", "-DFAL_PRINTF(...)=", "-I", tmp,
+           "-I", FDB, "-I", os.path.join(FDB, "inc"),
+           "-I", os.path.join(FDB, "port", "fal", "inc"),
+           "-I", os.path.join(FDB, "sim"), "-I", COMP,
+           "-I", os.path.join(COMP, "Protocol"),
+           "-I", os.path.join(COMP, "Utility")]
+    cmd += [os.path.join(COMP, s) for s in SOURCES] + ["-o", exe]
+    subprocess.check_call(cmd)
+    return exe
+
+
+class Channel:
+    """Gilbert 两状态信道: 坏状态下连续丢帧"""
+
+    def __init__(self, rng, loss, burst):
+        self.rng = rng
+        self.bad = False
+        self.p_recover = 1.0 / burst if loss > 0 else 1.0
+        self.p_fail = loss * self.p_recover / (1.0 - loss) if loss > 0 else 0.0
+
+    def lost(self):
+        if self.bad:
+            self.bad = self.rng.random() >= self.p_recover
+        else:
+            self.bad = self.rng.random() < self.p_fail
+        return self.bad
+
+
+class Station:
+    def __init__(self, exe, sid, channel):
+        self.sid = sid
+        self.channel = channel
+        self.proc = subprocess.Popen([exe, str(sid)], stdin=subprocess.PIPE,
+                                     stdout=subprocess.PIPE, universal_newlines=True)
+
+    def feed(self, data):
+        """交给工位的协议处理, 返回 (应答, 处理ms)"""
+        self.proc.stdin.write(data.hex() + "\n")
+        self.proc.stdin.flush()
+        resp, cycles = self.proc.stdout.readline().split()
+        return (None if resp == "-" else bytes.fromhex(resp)), int(cycles) * 1000.0 / CPU_HZ
+
+    def close(self):
+        self.proc.stdin.write("q\n")
+        self.proc.stdin.flush()
+        img = self.proc.stdout.readline().split()
+        self.proc.wait()
+        return {"erases": int(img[1]), "duplicates": int(img[2]), "double": int(img[3])}
+
+
+class Bus:
+    def __init__(self, args, stations):
+        self.args = args
+        self.stations = stations
+        self.ms = 0.0
+        self.frames = 0
+        self.retries = 0
+        self.byte_ms = 10.0 * 1000.0 / args.baud
+
+    def request(self, st, data):
+        """单播一问一答, 丢了 (请求或应答) 等超时重发"""
+        while True:
+            self.frames += 1
+            self.ms += len(data) * self.byte_ms
+            if st.channel.lost():
+                self.ms += self.args.timeout
+                self.retries += 1
+                continue
+            resp, proc = st.feed(data)
+            if resp is None or st.channel.lost():
+                self.ms += self.args.timeout
+                self.retries += 1
+                continue
+            self.ms += RX_IDLE_MS + proc + TX_PRE_MS + len(resp) * self.byte_ms + self.args.gap
+            return resp
+
+    def broadcast(self, data):
+        """广播, 无应答: 等最慢的工位处理完再发下一帧"""
+        self.frames += 1
+        worst = 0.0
+        for st in self.stations:
+            if not st.channel.lost():
+                worst = max(worst, st.feed(data)[1])
+        self.ms += len(data) * self.byte_ms + RX_IDLE_MS + worst + self.args.gap
+
+
+def begin_payload(magic, image):
+    return bytes([magic[0], magic[1]]) + struct.pack(
+        "<HIII", magic[2], len(image), zlib.crc32(image) & 0xFFFFFFFF, 0x00020300)
+
+
+def commit(bus, st):
+    resp = bus.request(st, frame(st.sid, SUB_COMMIT, b"\x00"))
+    return resp[5] == BANK_OK
+
+
+def run_unicast(bus, magic, image):
+    ok = 0
+    for st in bus.stations:
+        bus.request(st, frame(st.sid, SUB_BEGIN, begin_payload(magic, image)))
+        off = 0
+        while off < len(image):
+            resp = bus.request(st, frame(st.sid, SUB_DATA, struct.pack("<I", off) + image[off:off + CHUNK]))
+            if resp[5] not in (BANK_OK, BANK_ERR_OFFSET):
+                raise SystemExit("工位 %d 偏移 %d 写入失败: %02X" % (st.sid, off, resp[5]))
+            off = struct.unpack_from("<I", resp, 7)[0]   # 应答丢了重发时从"下一偏移"续传
+        ok += commit(bus, st)
+    return {"ok": ok}
+
+
+def query_missing(bus, st, count, magic, image):
+    """逐页查询缺块, 找齐缺块总数即停; 工位没收到分块开始时单播补发"""
+    missing = set()
+    start = 0
+    while start < count:
+        resp = bus.request(st, frame(st.sid, SUB_MISSING, struct.pack("<H", start)))
+        if resp[5] == BANK_ERR_STATE:
+            bus.request(st, frame(st.sid, SUB_BLOCK_BEGIN, begin_payload(magic, image)))
+            return set(range(count)), 1
+        total = struct.unpack_from("<H", resp, 7)[0]
+        for i in range(MISSING_WINDOW):
+            if resp[11 + i // 8] >> (i % 8) & 1:
+                missing.add(start + i)
+        if len(missing) >= total:
+            return missing, 0
+        start += MISSING_WINDOW
+    return missing, 0
+
+
+def run_broadcast(bus, magic, image):
+    count = (len(image) + CHUNK - 1) // CHUNK
+    blocks = [frame(BROADCAST, SUB_BLOCK_DATA, struct.pack("<H", i) + image[i * CHUNK:(i + 1) * CHUNK])
+              for i in range(count)]
+    bus.broadcast(frame(BROADCAST, SUB_BLOCK_BEGIN, begin_payload(magic, image)))
+    pending = range(count)
+    rounds = resent = rebegins = 0
+    waiting = list(bus.stations)
+    while True:
+        for i in pending:
+            bus.broadcast(blocks[i])
+        union = set()
+        still = []
+        for st in waiting:
+            missing, rb = query_missing(bus, st, count, magic, image)
+            rebegins += rb
+            if missing:
+                union |= missing
+                still.append(st)
+        waiting = still
+        if not union:
+            break
+        rounds += 1
+        resent += len(union)
+        pending = sorted(union)
+    ok = sum(commit(bus, st) for st in bus.stations)
+    return {"ok": ok, "rounds": rounds, "resent": resent, "rebegins": rebegins}
+
+
+def run(args, exe, n, mode, image, magic):
+    rng = random.Random("%d-%d-%s" % (args.seed, n, mode))
+    stations = [Station(exe, sid + 1, Channel(random.Random(rng.random()), args.loss, args.burst))
+                for sid in range(n)]
+    bus = Bus(args, stations)
+    try:
+        res = (run_unicast if mode == "unicast" else run_broadcast)(bus, magic, image)
+    finally:
+        sims = [st.close() for st in stations]
+    res.update(ms=bus.ms, frames=bus.frames, retries=bus.retries,
+               erases=max(s["erases"] for s in sims),
+               duplicates=sum(s["duplicates"] for s in sims),
+               double=sum(s["double"] for s in sims))
+    return res
+
+
+def main():
+    p = argparse.ArgumentParser(description="整线广播升级仿真")
+    p.add_argument("--stations", default="1,4,8,16", help="工位数, 逗号分隔")
+    p.add_argument("--image-kb", type=int, default=96, help="镜像大小 (KB, <=111)")
+    p.add_argument("--loss", type=float, default=0.05, help="平均丢帧率")
+    p.add_argument("--burst", type=float, default=4.0, help="平均连续丢帧数")
+    p.add_argument("--baud", type=int, default=9600)
+    p.add_argument("--timeout", type=float, default=300.0, help="单播无应答超时(ms)")
+    p.add_argument("--gap", type=float, default=10.0, help="上位机收到应答后再发送的间隔(ms)")
+    p.add_argument("--seed", type=int, default=1)
+    p.add_argument("--cc", default="gcc")
+    args = p.parse_args()
+
+    # 随机内容, 向量表像本机APP (栈顶在RAM内, 复位向量在APP区), 提交时才能通过检查
+    image = struct.pack("<II", 0x20008000, 0x4000 + 0x101) + bytes(
+        random.Random(args.seed).getrandbits(8) for _ in range(args.image_kb * 1024 - 8))
+    magic = chip_magic(None)[1]
+    tmp = tempfile.mkdtemp(prefix="fleet_sim_")
+    try:
+        exe = build(args.cc, tmp)
+        print("镜像 %dKB (%d 块), %d 波特率, 丢帧率 %.1f%% (平均连续 %.0f 帧)" % (
+            args.image_kb, (len(image) + CHUNK - 1) // CHUNK, args.baud,
+            args.loss * 100, args.burst))
+        print("%4s %12s %12s %7s %6s %8s %8s %8s %8s" % (
+            "工位", "逐个单播", "广播+补发", "加速", "轮数", "补发块", "重复块",
+            "单播重发", "CRC通过"))
+        for n in [int(s) for s in args.stations.split(",")]:
+            uni = run(args, exe, n, "unicast", image, magic)
+            bc = run(args, exe, n, "broadcast", image, magic)
+            if uni["double"] or bc["double"]:
+                raise SystemExit("模拟Flash检测到重复编程")
+            print("%4d %11.1fs %11.1fs %6.1fx %6d %8d %8d %8d %5d/%d" % (
+                n, uni["ms"] / 1000, bc["ms"] / 1000, uni["ms"] / bc["ms"], bc["rounds"],
+                bc["resent"], bc["duplicates"], uni["retries"], bc["ok"], n))
+            if uni["ok"] != n or bc["ok"] != n:
+                print("提交失败: 单播 %d/%d, 广播 %d/%d" % (uni["ok"], n, bc["ok"], n))
+                return 1
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
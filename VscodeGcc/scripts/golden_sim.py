@@ -0,0 +1,423 @@
+#!/usr/bin/env python3
+"""
+金样检测 上位机/仿真工具
+
+生成金样参考镜像和PC下载帧 (格式见 Components/FlashDB/golden_sample.h),
+并在本机把 golden_sample.c + jig_config.c + FlashDB + 模拟NOR 编译在一起,
+用漂移的传感器模型检查判定、漂移估计、标记和掉电保持。
+
+参考文件 (JSON):
+  {"sample": 1,
+   "channels": [{"name": "VCC", "expected": 3300, "tol": 40, "drift": 20}, ...]}
+  通道顺序与 Inc/Golden_Ctrl.h 相同; tol=0 不检测, drift=0 不做漂移判断
+
+传感器模型 (每次检测):
+  电压: 按 GetSingleChannelVoltage_POLL 的整数公式换算, 通道码值和
+        VREF1P2 码值各带 ADC 噪声, 每个通道平均 GOLDEN_CAIYANG 次。
+        VREF1P2 漂移使全部电压通道同比例偏移, 分压电阻漂移只影响本通道。
+  功耗: 分流电阻漂移为比例误差, 另加读数噪声。
+  金样本身每次检测也有微小差异 (温度等)。
+场景:
+  stable      无漂移, 统计误报
+  vref        VREF1P2 每次检测漂移 +0.01%
+  divider     VDD 分压每次检测漂移 -0.02%
+  shunt_ramp  分流电阻每次检测漂移 +0.05%
+  shunt_step  第40次检测时分流电阻阶跃 +5% (焊点开裂)
+对每个场景给出: 标记时的检测次数、此时的系统误差占允许偏差的比例、
+比系统误差超出允许偏差 (生产测试开始误判) 提前多少次检测。
+
+子命令:
+  default [-o ref.json]            输出默认参考 (仿真用的金样)
+  build ref.json -o ref.bin        生成参考镜像
+  frame ref.bin|ref.json [--station N] [--op 2]   输出 0xE0 帧 hex
+  sim [--runs 200] [--seeds 20] [--scenario 名称]  蒙特卡洛仿真
+  check [--cc gcc]                 检查判定/漂移/标记/保存
+"""
+
+import argparse
+import json
+import os
+import random
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import zlib
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.normpath(os.path.join(HERE, "..", ".."))
+FDB = os.path.join(ROOT, "Components", "FlashDB")
+
+MAGIC = 0x5347
+FORMAT = 1
+MAX_CH = 8
+TREND_NUM = 12
+FAIL_CONFIRM = 2
+
+# Inc/Golden_Ctrl.h
+CAIYANG = 8
+ADC_SCALE = 11000      # JIG_CFG_ADC_SCALE 默认值
+ADC_VREF = 1638        # VREF1P2 出厂定标码值 (3.0V 时)
+
+RESULTS = ("成功", "长度错误", "魔数错误", "格式版本错误", "CRC错误", "没有参考",
+           "忙", "保存失败")
+
+DEFAULT_REF = {
+    "sample": 1,
+    "channels": [
+        {"name": "VCC", "expected": 3300, "tol": 40, "drift": 20},
+        {"name": "GONGDIAN", "expected": 6000, "tol": 60, "drift": 30},
+        {"name": "VDD", "expected": 3900, "tol": 50, "drift": 25},
+        {"name": "ZHUDIAN", "expected": 6000, "tol": 60, "drift": 30},
+        {"name": "SHENGYA", "expected": 5000, "tol": 60, "drift": 30},
+        {"name": "GONGZHUANG", "expected": 3300, "tol": 40, "drift": 20},
+        {"name": "GONGHAO", "expected": 850, "tol": 25, "drift": 12},
+    ],
+}
+CURRENT_CH = 6
+
+
+def encode(ref):
+    chs = ref["channels"]
+    data = struct.pack("<HBBH", MAGIC, FORMAT, len(chs), ref.get("sample", 0))
+    for c in chs:
+        data += struct.pack("<iHH", c["expected"], c.get("tol", 0), c.get("drift", 0))
+    return data + struct.pack("<I", zlib.crc32(data) & 0xFFFFFFFF)
+
+
+def load(path):
+    with open(path, "rb") as f:
+        raw = f.read()
+    if path.endswith(".json"):
+        return encode(json.loads(raw.decode("utf-8")))
+    return raw
+
+
+def frame(op, payload, station):
+    body = bytes([0x55, 0xE0, 0, station, op]) + payload
+    body = bytearray(body)
+    body[2] = len(body) + 2
+    return bytes(body) + bytes([sum(body) & 0xFF, 0xAA])
+
+
+# ---------------------------------------------------------------- 传感器模型
+
+class Station:
+    """一个工位的测量通道 (误差为相对值)"""
+
+    def __init__(self, rng, ref):
+        self.rng = rng
+        self.ref = ref
+        self.vref_err = 0.0
+        self.div_err = [0.0] * len(ref["channels"])
+        self.shunt_err = 0.0
+
+    def recalibrate(self):
+        self.vref_err = 0.0
+        self.div_err = [0.0] * len(self.div_err)
+        self.shunt_err = 0.0
+
+    def adc_mv(self, rail_mv, i):
+        # 与 GetSingleChannelVoltage_POLL + get_xxx_dianya 相同的整数换算
+        pin = rail_mv * 1000.0 / ADC_SCALE * (1 + self.div_err[i])
+        vref_code = round(1.2 * (1 + self.vref_err) / 3.0 * 4095 + self.rng.gauss(0, 0.6))
+        code = round(pin / 3000.0 * 4095 + self.rng.gauss(0, 0.8))
+        code = min(max(code, 0), 4095)
+        mv = code * 3000 * ADC_VREF // (vref_code * 4095)
+        return mv * ADC_SCALE // 1000
+
+    def systematic(self, i):
+        """不含噪声的相对误差"""
+        if i == CURRENT_CH:
+            return self.shunt_err
+        return (1 + self.div_err[i]) / (1 + self.vref_err) - 1
+
+    def measure(self):
+        values = []
+        for i, c in enumerate(self.ref["channels"]):
+            if i == CURRENT_CH:
+                true = c["expected"] * (1 + self.rng.gauss(0, 0.003))
+                values.append(int(round(true * (1 + self.shunt_err) + self.rng.gauss(0, 1.0))))
+                continue
+            true = c["expected"] * (1 + self.rng.gauss(0, 0.0005))
+            s = sum(self.adc_mv(true, i) for _ in range(CAIYANG))
+            values.append((s + CAIYANG // 2) // CAIYANG)
+        return values
+
+
+SCENARIOS = {
+    "stable": lambda st, n: None,
+    "vref": lambda st, n: setattr(st, "vref_err", st.vref_err + 0.0001),
+    "divider": lambda st, n: st.div_err.__setitem__(2, st.div_err[2] - 0.0002),
+    "shunt_ramp": lambda st, n: setattr(st, "shunt_err", st.shunt_err + 0.0005),
+    "shunt_step": lambda st, n: setattr(st, "shunt_err", 0.05 if n >= 40 else 0.0),
+}
+
+
+# ---------------------------------------------------------------- 固件 (本机编译)
+
+class Bench:
+    def __init__(self, cc, tmp):
+        exe = os.path.join(tmp, "golden_bench")
+        if not os.path.exists(exe):
+            with open(os.path.join(tmp, "elog.h"), "w") as f:
+                f.write("#define log_i(...)\n#define log_e(...)\n"
+                        "#define log_w(...)\n#define log_d(...)\n")
+            sources = ["src/fdb.c", "src/fdb_kvdb.c", "src/fdb_utils.c",
+                       "port/fal/src/fal.c", "port/fal/src/fal_flash.c",
+                       "port/fal/src/fal_partition.c", "fal_flash_fm33lg04_port.c",
+                       "sim/flash_sim.c", "jig_config.c", "golden_sample.c",
+                       "sim/golden_bench.c"]
+            util = os.path.join(ROOT, "Components", "Utility")
+            subprocess.check_call(
+                [cc, "-O2", "-w", "-DFAL_FLASH_SIM", "-I", tmp, "-I", FDB,
+                 "-I", os.path.join(FDB, "inc"), "-I", os.path.join(FDB, "port", "fal", "inc"),
+                 "-I", os.path.join(FDB, "sim"), "-I", util] +
+                [os.path.join(FDB, s) for s in sources] +
+                [os.path.join(util, "utility_crc.c"), "-o", exe])
+        self.proc = subprocess.Popen([exe], stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                                     universal_newlines=True)
+
+    def cmd(self, text):
+        self.proc.stdin.write(text + "\n")
+        self.proc.stdin.flush()
+        # 跳过 FAL 的日志行
+        while True:
+            r = self.proc.stdout.readline().split()
+            if not r or r[0] == text.split()[0]:
+                return r
+
+    def ref(self, image):
+        return int(self.cmd("ref " + (image.hex() if image else "-"))[1])
+
+    def run(self, values):
+        r = [int(v) for v in self.cmd("run " + " ".join(map(str, values)))[1:]]
+        return {"result": r[0], "fail": r[1], "recal": r[2], "flags": r[3],
+                "ewma": [v / 16.0 for v in r[4:]]}
+
+    def close(self):
+        self.proc.stdin.close()
+        self.proc.wait()
+
+
+def simulate(bench, ref, scenario, seed, runs):
+    """返回 (标记时的检测序号, 系统误差开始超出允许偏差的检测序号, 标记时误差/允许偏差)"""
+    rng = random.Random(seed)
+    st = Station(rng, ref)
+    bench.ref(encode(ref))
+    flagged = onset = None
+    ratio = 0.0
+    for n in range(runs):
+        SCENARIOS[scenario](st, n)
+        worst = max(abs(st.systematic(i)) * c["expected"] / c["tol"]
+                    for i, c in enumerate(ref["channels"]) if c["tol"])
+        if onset is None and worst > 1.0:
+            onset = n
+        r = bench.run(st.measure())
+        if flagged is None and r["recal"]:
+            flagged = n
+            ratio = worst
+    return flagged, onset, ratio
+
+
+# ---------------------------------------------------------------- 子命令
+
+def cmd_default(args):
+    text = json.dumps(DEFAULT_REF, ensure_ascii=False, indent=2)
+    if args.output:
+        with open(args.output, "w", encoding="utf-8") as f:
+            f.write(text + "\n")
+    else:
+        print(text)
+    return 0
+
+
+def cmd_build(args):
+    image = load(args.ref)
+    with open(args.output, "wb") as f:
+        f.write(image)
+    print("%d 字节, CRC %08X" % (len(image), struct.unpack("<I", image[-4:])[0]))
+    return 0
+
+
+def cmd_frame(args):
+    data = frame(args.op, load(args.ref) if args.op == 2 else b"", args.station)
+    print(data.hex(" ").upper())
+    return 0
+
+
+def cmd_sim(args):
+    ref = DEFAULT_REF
+    names = [args.scenario] if args.scenario else list(SCENARIOS)
+    tmp = tempfile.mkdtemp(prefix="golden_sim_")
+    try:
+        print("%d 个工位 x %d 次检测, 漂移门限=允许偏差/2, 连续%d次超差标记" % (
+            args.seeds, args.runs, FAIL_CONFIRM))
+        print("%-11s %8s %10s %12s %14s" % ("场景", "标记", "误差/允许", "超出允许", "提前(次)"))
+        for name in names:
+            flags, leads, ratios, onsets = [], [], [], []
+            for seed in range(args.seeds):
+                b = Bench(args.cc, tmp)
+                f, o, ratio = simulate(b, ref, name, seed, args.runs)
+                b.close()
+                if f is not None:
+                    flags.append(f)
+                    ratios.append(ratio)
+                if o is not None:
+                    onsets.append(o)
+                    if f is not None:
+                        leads.append(o - f)
+            med = lambda v: sorted(v)[len(v) // 2] if v else None
+            fmt = lambda v: "-" if v is None else str(v)
+            print("%-11s %4d/%-3d %9s %12s %14s" % (
+                name, len(flags), args.seeds,
+                "-" if not ratios else "%.2f" % med(ratios),
+                fmt(med(onsets)), "-" if not leads else "%d (最少%d)" % (med(leads), min(leads))))
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+    return 0
+
+
+def cmd_check(args):
+    tmp = tempfile.mkdtemp(prefix="golden_sim_")
+    failed = []
+    checks = [0]
+
+    def expect(name, got, want):
+        checks[0] += 1
+        if got != want:
+            failed.append("%s: %s, 应为 %s" % (name, got, want))
+
+    ref = DEFAULT_REF
+    good = encode(ref)
+    exp = [c["expected"] for c in ref["channels"]]
+    try:
+        b = Bench(args.cc, tmp)
+        expect("没有参考时检测", b.run(exp)["result"], 5)
+        bad = bytearray(good)
+        bad[10] ^= 0x01
+        expect("CRC错误", b.ref(bytes(bad)), 4)
+        expect("截断", b.ref(good[:-1]), 1)
+        bad = bytearray(good)
+        bad[0] ^= 0xFF
+        expect("魔数错误", b.ref(bytes(bad)), 2)
+        bad = bytearray(good)
+        bad[2] = 9
+        expect("格式版本错误", b.ref(bytes(bad)), 3)
+        expect("下载参考", b.ref(good), 0)
+
+        r = b.run(exp)
+        expect("期望值: 合格", (r["result"], r["fail"], r["recal"], r["flags"]), (0, 0, 0, 1))
+        # 单次接触不良: 超差但不标记
+        glitch = list(exp)
+        glitch[0] = 0
+        r = b.run(glitch)
+        expect("单次异常读数: 超差", r["fail"], 1)
+        expect("单次异常读数: 不标记", r["recal"], 0)
+        r = b.run(exp)
+        expect("恢复后合格", (r["fail"], r["recal"]), (0, 0))
+        # 连续超差
+        step = list(exp)
+        step[CURRENT_CH] += 40
+        b.run(step)
+        r = b.run(step)
+        expect("连续2次超差标记", (r["recal"] >> CURRENT_CH & 1, r["flags"] & 2), (1, 2))
+        r = b.run(exp)
+        expect("标记保持到清除", r["recal"] >> CURRENT_CH & 1, 1)
+        before = b.cmd("reboot")[1:]
+        expect("复位后标记和次数保持", before, [str(1 << CURRENT_CH), "6", "6"])
+        expect("清除标记", int(b.cmd("clear")[1]), 0)
+        r = b.run(exp)
+        expect("清除后重新建立基线", (r["recal"], r["flags"]), (0, 1))
+
+        # 漂移: 每次 +6mV (VCC), 门限20, 滤波后约第5次超过
+        ramp = list(exp)
+        marked = None
+        for n in range(1, 10):
+            ramp[0] = exp[0] + 6 * n
+            r = b.run(ramp)
+            if marked is None and r["recal"] & 1:
+                marked = n
+        expect("缓慢漂移在超差前标记", marked is not None and 6 * marked < ref["channels"][0]["tol"], True)
+
+        t = b.cmd("trend")
+        expect("记录条数", int(t[1]), TREND_NUM)
+        runs = [int(x.split(":")[0]) for x in t[2:]]
+        expect("记录按时间顺序", runs, list(range(runs[-1] - TREND_NUM + 1, runs[-1] + 1)))
+        expect("记录偏差", t[-1].split(":")[3].split(",")[0], str(6 * 9))
+
+        # 掉电保持: 两个工位输入相同, 其中一个中途复位, 之后输出应相同
+        b2 = Bench(args.cc, tmp)
+        b2.ref(good)
+        rng = random.Random(7)
+        st = Station(rng, ref)
+        seq = []
+        for n in range(30):
+            SCENARIOS["vref"](st, n)
+            seq.append(st.measure())
+        b.ref(good)
+        out1, out2 = [], []
+        for n, v in enumerate(seq):
+            if n == 15:
+                b2.cmd("reboot")
+            out1.append(b.run(v))
+            out2.append(b2.run(v))
+        expect("复位前后漂移估计连续", out1, out2)
+        b2.close()
+
+        # 蒙特卡洛: 无漂移不误报, 各种漂移在生产测试误判前标记
+        for name in SCENARIOS:
+            flagged, leads = 0, []
+            for seed in range(args.seeds):
+                f, o, _ = simulate(b, ref, name, 100 + seed, 200)
+                flagged += f is not None
+                if o is not None:
+                    leads.append(-1 if f is None else o - f)
+            if name == "stable":
+                expect("无漂移不误报", flagged, 0)
+            elif name == "shunt_step":
+                expect("阶跃在第2次检测时标记", min(leads) >= -1 and max(leads) <= 0 and flagged == args.seeds, True)
+            else:
+                expect("%s 在超出允许偏差前标记" % name, min(leads) > 0, True)
+        b.close()
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+
+    for f in failed:
+        print("失败: " + f)
+    print("%d 项检查, %d 项失败" % (checks[0], len(failed)))
+    return 1 if failed else 0
+
+
+def main():
+    p = argparse.ArgumentParser(description="金样检测工具")
+    sub = p.add_subparsers(dest="cmd")
+    s = sub.add_parser("default")
+    s.add_argument("-o", "--output")
+    s = sub.add_parser("build")
+    s.add_argument("ref")
+    s.add_argument("-o", "--output", required=True)
+    s = sub.add_parser("frame")
+    s.add_argument("ref", nargs="?")
+    s.add_argument("--station", type=lambda x: int(x, 0), default=0)
+    s.add_argument("--op", type=int, default=2, help="0状态 1启动 2下载参考 3读取参考 4趋势 5清除标记")
+    s = sub.add_parser("sim")
+    s.add_argument("--runs", type=int, default=200)
+    s.add_argument("--seeds", type=int, default=20)
+    s.add_argument("--scenario", choices=sorted(SCENARIOS))
+    s.add_argument("--cc", default="gcc")
+    s = sub.add_parser("check")
+    s.add_argument("--seeds", type=int, default=10)
+    s.add_argument("--cc", default="gcc")
+    args = p.parse_args()
+    handlers = {"default": cmd_default, "build": cmd_build, "frame": cmd_frame,
+                "sim": cmd_sim, "check": cmd_check}
+    if args.cmd not in handlers:
+        p.print_help()
+        return 1
+    return handlers[args.cmd](args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
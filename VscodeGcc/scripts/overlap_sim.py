@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+"""
+测试步骤并行执行 仿真工具
+
+用本机 gcc 把 Components/TimeManager/step_executor.c 与
+Components/TimeManager/sim/step_exec_bench.c 编译在一起, 步骤表与
+Src/Test_List.c 相同, 被测板和电源换成模型 (虚拟时钟, 主循环每轮1ms)。
+每次测试随机生成一个场景, 分别按原流程串行和按资源/前置步骤并行执行,
+比较测试周期, 统计关键路径。
+
+场景模型 (ms, 相对测试开始, 均匀分布, 可用参数调整):
+  --vcc      VCC 合格时刻             默认 0-300
+  --main     主电供电合格时刻         默认 0-1500   (继电器吸合后电压稳定)
+  --vdd      VDD 合格时刻             默认 300-2500
+  --boot     被测板串口可应答时刻     默认 1500-4000
+  --reply    被测板应答延时           默认 50-200
+  --net      5G注册完成               默认 12000-25000 (上电起算)
+  --net-rel  5G注册改为从设置表号成功起算 (被测板收到表号后才注册)
+电压检测不合格时1秒复测, 串口命令3秒重发 (--resend), 与固件相同。
+
+用法:
+  overlap_sim.py [--runs 2000] [--seed 1] [--net-rel] [--resend 3000] [--example]
+"""
+
+import argparse
+import collections
+import os
+import random
+import shutil
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+TM = os.path.normpath(os.path.join(HERE, "..", "..", "Components", "TimeManager"))
+
+# 步骤名称 (与 Inc/Test_List.h 中 Test_liucheng 枚举一致)
+STEP_NAMES = {1: "VCC检测", 2: "主电检测", 3: "VDD检测", 4: "切换供电",
+              5: "设置表号", 6: "5G上告", 7: "功耗测试"}
+
+
+def build(cc, tmp):
+    # 本机编译不带 EasyLogger, 日志宏置空
+    with open(os.path.join(tmp, "elog.h"), "w") as f:
+        f.write("#define log_i(...)\n#define log_e(...)\n"
+                "#define log_w(...)\n#define log_d(...)\n")
+    exe = os.path.join(tmp, "step_exec_bench")
+    subprocess.check_call([cc, "-O2", "-w", "-I", tmp, "-I", TM,
+                           os.path.join(TM, "step_executor.c"),
+                           os.path.join(TM, "sim", "step_exec_bench.c"), "-o", exe])
+    return exe
+
+
+def span(text):
+    lo, hi = text.split("-")
+    return int(lo), int(hi)
+
+
+def scenario(rng, args):
+    u = lambda r: rng.randint(*r)
+    return [u(args.vcc), u(args.main), u(args.vdd), u(args.boot), u(args.reply),
+            u(args.net), args.adc, args.ina, 1 if args.net_rel else 0, args.resend]
+
+
+def parse(line):
+    p = line.split()
+    segs = [tuple(int(v) / 1000.0 for v in s.split(",")) for s in p[4:]]
+    return {"mode": p[0], "total": int(p[1]) / 1000.0, "busy": int(p[2]) / 1000.0,
+            "path": tuple(int(v) for v in p[3].split(",")), "segs": segs}
+
+
+def pct(values, q):
+    s = sorted(values)
+    return s[min(len(s) - 1, int(len(s) * q))]
+
+
+def waterfall(run, width=60):
+    scale = width / max(run["total"], 1.0)
+    print("  %s: %.2fs, 关键路径 %s" % (run["mode"], run["total"] / 1000,
+                                   " -> ".join(STEP_NAMES[s] for s in run["path"])))
+    for i, (start, end) in enumerate(run["segs"]):
+        a = int(start * scale)
+        b = max(a + 1, int(end * scale))
+        print("    %-8s |%s%s%s| %6.2fs +%.2fs" % (
+            STEP_NAMES[i + 1], " " * a, "#" * (b - a), " " * (width - b),
+            start / 1000, (end - start) / 1000))
+
+
+def main():
+    p = argparse.ArgumentParser(description="测试步骤并行执行仿真")
+    p.add_argument("--runs", type=int, default=2000)
+    p.add_argument("--seed", type=int, default=1)
+    p.add_argument("--vcc", type=span, default=(0, 300))
+    p.add_argument("--main", type=span, default=(0, 1500))
+    p.add_argument("--vdd", type=span, default=(300, 2500))
+    p.add_argument("--boot", type=span, default=(1500, 4000))
+    p.add_argument("--reply", type=span, default=(50, 200))
+    p.add_argument("--net", type=span, default=(12000, 25000))
+    p.add_argument("--net-rel", action="store_true")
+    p.add_argument("--resend", type=int, default=3000,
+                   help="串口命令重发间隔(ms), 固件为3000, 用于评估缩短重发间隔的效果")
+    p.add_argument("--adc", type=int, default=6, help="一次电压检测阻塞(ms)")
+    p.add_argument("--ina", type=int, default=500, help="功耗测试阻塞(ms), Current_CHK_Func")
+    p.add_argument("--example", action="store_true", help="打印第一个场景的时间线")
+    p.add_argument("--cc", default="gcc")
+    args = p.parse_args()
+
+    rng = random.Random(args.seed)
+    lines = "".join(" ".join(map(str, scenario(rng, args))) + "\n" for _ in range(args.runs))
+    tmp = tempfile.mkdtemp(prefix="overlap_sim_")
+    try:
+        exe = build(args.cc, tmp)
+        out = subprocess.run([exe], input=lines, stdout=subprocess.PIPE,
+                             universal_newlines=True, check=True).stdout
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+
+    runs = [parse(l) for l in out.splitlines()]
+    serial = [r for r in runs if r["mode"] == "serial"]
+    overlap = [r for r in runs if r["mode"] == "overlap"]
+    st = [r["total"] / 1000 for r in serial]
+    ot = [r["total"] / 1000 for r in overlap]
+    gain = [a - b for a, b in zip(st, ot)]
+
+    print("%d 次测试, 5G注册%s, 串口命令重发间隔 %dms" % (
+        args.runs, "从设置表号成功起算" if args.net_rel else "从上电起算", args.resend))
+    print("%-8s %8s %8s %8s %8s" % ("", "平均", "P50", "P95", "最大"))
+    for name, v in (("串行", st), ("并行", ot)):
+        print("%-8s %7.2fs %7.2fs %7.2fs %7.2fs" % (name, sum(v) / len(v), pct(v, 0.5),
+                                                   pct(v, 0.95), max(v)))
+    print("缩短: 平均 %.2fs (%.1f%%), 缩短的测试 %.1f%%, 变长的测试 %.1f%% (最多 %.2fs)" % (
+        sum(gain) / len(gain), sum(gain) * 100.0 / sum(st),
+        sum(1 for g in gain if g > 0.0005) * 100.0 / len(gain),
+        sum(1 for g in gain if g < -0.0005) * 100.0 / len(gain), -min(gain)))
+    print("并行时步骤耗时之和 / 测试周期: %.2f" % (
+        sum(r["busy"] for r in overlap) / sum(r["total"] for r in overlap)))
+    print("")
+    print("并行关键路径:")
+    for path, n in collections.Counter(r["path"] for r in overlap).most_common(4):
+        print("  %5.1f%%  %s" % (n * 100.0 / len(overlap), " -> ".join(STEP_NAMES[s] for s in path)))
+    # 关键路径上各步骤占的时间 (并行)
+    share = collections.Counter()
+    for r in overlap:
+        for s in r["path"]:
+            start, end = r["segs"][s - 1]
+            share[s] += end - start
+    total = sum(r["total"] for r in overlap)
+    print("关键路径时间占比 (并行): " + ", ".join(
+        "%s %.1f%%" % (STEP_NAMES[s], share[s] * 100.0 / total) for s in sorted(share)))
+    if args.example:
+        print("")
+        waterfall(serial[0])
+        waterfall(overlap[0])
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+"""
+PC协议命令表生成工具
+
+解析固件命令表 Components/Protocol/PC/pc_cmd_def.h (PC_CMD_TABLE),
+检查命令码重复, 并生成上位机侧使用的命令定义, 保证上位机与固件一致。
+
+用法:
+  pc_cmd_table.py check              只检查 (命令码重复时返回非0)
+  pc_cmd_table.py list               打印命令表
+  pc_cmd_table.py md                 生成 Markdown 表格 (用于协议文档)
+  pc_cmd_table.py py  [-o 文件]      生成 Python 模块 (PC_CMD 字典等)
+  pc_cmd_table.py json [-o 文件]     生成 JSON
+  --header <路径>                    指定命令表头文件 (默认按本脚本位置查找)
+
+其他脚本可直接 import 使用:
+  from pc_cmd_table import load_table
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+DEFAULT_HEADER = os.path.normpath(
+    os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                 "..", "..", "Components", "Protocol", "PC", "pc_cmd_def.h"))
+
+# X(名称, 请求码, 应答名称, 应答码, 请求最小帧长, 应答帧长, "说明")
+ROW_RE = re.compile(
+    r'X\(\s*(\w+)\s*,\s*(0x[0-9A-Fa-f]+|\d+)\s*,\s*(\w+)\s*,\s*'
+    r'(0x[0-9A-Fa-f]+|\d+)\s*,\s*(\d+)\s*,\s*(\d+)\s*,\s*"([^"]*)"\s*\)')
+
+
+class PcCmd:
+    __slots__ = ("slot", "name", "code", "ack_name", "ack_code", "req_len",
+                 "ack_len", "desc")
+
+    def __init__(self, slot, m):
+        self.slot = slot
+        self.name = m.group(1)
+        self.code = int(m.group(2), 0)
+        self.ack_name = m.group(3)
+        self.ack_code = int(m.group(4), 0)
+        self.req_len = int(m.group(5))
+        self.ack_len = int(m.group(6))
+        self.desc = m.group(7)
+
+    def as_dict(self):
+        return {k: getattr(self, k) for k in self.__slots__}
+
+
+def load_table(header=DEFAULT_HEADER):
+    """解析命令表, 返回按行顺序排列的 PcCmd 列表"""
+    with open(header, encoding="utf-8") as f:
+        text = f.read()
+    start = text.find("#define PC_CMD_TABLE(X)")
+    if start < 0:
+        raise ValueError("%s 中没有 PC_CMD_TABLE" % header)
+    # 宏定义到第一个不以反斜杠结尾的行为止
+    body = []
+    for line in text[start:].splitlines():
+        body.append(line)
+        if not line.rstrip().endswith("\\"):
+            break
+    return [PcCmd(i, m) for i, m in enumerate(ROW_RE.finditer("\n".join(body)))]
+
+
+def find_duplicates(cmds):
+    """返回 [(命令码, [使用该码的名称...]), ...]"""
+    owners = {}
+    for c in cmds:
+        owners.setdefault(c.code, []).append(c.name)
+        owners.setdefault(c.ack_code, []).append(c.ack_name)
+    return sorted((code, names) for code, names in owners.items()
+                  if len(names) > 1)
+
+
+def gen_markdown(cmds):
+    lines = ["| 命令 | 请求码 | 应答 | 应答码 | 请求最小帧长 | 应答帧长 | 说明 |",
+             "|------|--------|------|--------|--------------|----------|------|"]
+    for c in cmds:
+        lines.append("| %s | 0x%02X | %s | 0x%02X | %s | %s | %s |" % (
+            c.name, c.code, c.ack_name, c.ack_code, c.req_len or "变长",
+            c.ack_len or "变长", c.desc))
+    return "\n".join(lines) + "\n"
+
+
+def gen_python(cmds):
+    lines = ['"""由 pc_cmd_table.py 从 pc_cmd_def.h 生成, 请勿手工修改"""', "",
+             "PC_CMD = {"]
+    for c in cmds:
+        lines.append("    %r: 0x%02X," % (c.name, c.code))
+        lines.append("    %r: 0x%02X," % (c.ack_name, c.ack_code))
+    lines.append("}")
+    lines.append("")
+    lines.append("# 请求码 -> 应答码")
+    lines.append("PC_CMD_ACK = {")
+    for c in cmds:
+        lines.append("    0x%02X: 0x%02X,  # %s" % (c.code, c.ack_code, c.name))
+    lines.append("}")
+    lines.append("")
+    lines.append("# 请求码 -> (请求最小帧长, 应答帧长), 0=变长")
+    lines.append("PC_CMD_LEN = {")
+    for c in cmds:
+        lines.append("    0x%02X: (%d, %d)," % (c.code, c.req_len, c.ack_len))
+    lines.append("}")
+    lines.append("")
+    lines.append("PC_CMD_NAME = {v: k for k, v in PC_CMD.items()}")
+    return "\n".join(lines) + "\n"
+
+
+def write_out(text, path):
+    if path:
+        with open(path, "w", encoding="utf-8", newline="\n") as f:
+            f.write(text)
+        print("已生成 %s" % path)
+    else:
+        sys.stdout.write(text)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="PC协议命令表生成工具")
+    parser.add_argument("--header", default=DEFAULT_HEADER, help="命令表头文件")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+    sub.add_parser("check", help="检查命令码重复")
+    sub.add_parser("list", help="打印命令表")
+    for name, desc in (("md", "生成 Markdown 表格"), ("py", "生成 Python 模块"),
+                       ("json", "生成 JSON")):
+        p = sub.add_parser(name, help=desc)
+        p.add_argument("-o", "--output", help="输出文件 (默认标准输出)")
+    args = parser.parse_args()
+
+    cmds = load_table(args.header)
+    if not cmds:
+        print("命令表为空: %s" % args.header, file=sys.stderr)
+        return 1
+    dups = find_duplicates(cmds)
+    for code, names in dups:
+        print("命令码重复 0x%02X: %s" % (code, ", ".join(names)), file=sys.stderr)
+    if dups:
+        return 1
+
+    if args.cmd == "check":
+        print("命令表正常: %d 条命令, %d 个命令码" % (len(cmds), len(cmds) * 2))
+    elif args.cmd == "list":
+        for c in cmds:
+            print("%2d  %-16s 0x%02X -> 0x%02X %-20s %s" % (
+                c.slot, c.name, c.code, c.ack_code, c.ack_name, c.desc))
+    elif args.cmd == "md":
+        write_out(gen_markdown(cmds), args.output)
+    elif args.cmd == "py":
+        write_out(gen_python(cmds), args.output)
+    elif args.cmd == "json":
+        write_out(json.dumps([c.as_dict() for c in cmds], ensure_ascii=False,
+                             indent=2) + "\n", args.output)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+"""
+设备发送前导 阻塞/异步 对比工具
+
+比较被测设备口 (UART0) 两种发送方式下主循环被阻塞的时间:
+  block  原方式: 前导每段调用一次 Uart_Send, 段间 FL_DelayMs, 整帧发完才返回
+         (Uart_Send 每包还有 tx_guard_ms 发送前延时, 上一包未发完时忙等)
+  async  ProtocolManager_SetDeviceAsyncTx 绑定 Uart0_Tx_AsyncKick 后:
+         只复制帧并启动发送中断, 前导字节由 ProtocolManager_TxIsrFetch 在中断中
+         生成, 段间间隔由主循环的 ProtocolManager_Process 按 tick 调度,
+         发完调用完成回调
+
+不是估算模型: 脚本用本机 gcc 把 protocol_manager.c 和
+Components/Protocol/sim/preamble_bench.c 编译在一起, 后者按 Src/Uart_Ctrl.c
+的发送中断/Uart_Send/Uart_Tx_AsyncKick 模拟 UART0, 逐字节推进模拟时钟。
+
+命令:
+  NTST   19字节 (Src/tongxin_xieyi_Ctrl.c), 当前设备协议无前导
+  ICDC    6字节, 无前导
+  water  24字节水表帧 + 水表前导 (50 x 0xAA 重复32次, 间隔3ms, 10 x 0xFE)
+
+输出每条命令:
+  阻塞   调用 ProtocolManager_Device_SendRaw 到返回的时间 (最大 / 每帧平均)
+  发完   第一帧开始到最后一个字节移出的时间
+  统计   协议管理器自己的 ProtocolTxStats (ms, 与模拟值互相校对)
+  丢字节 应发 - 实际移出; 阻塞方式下一段前导发送时间超过 UART0 的
+         tx_wait_ms (100ms, 2400bps 下50字节约208ms) 时 Uart_Send 超时丢弃该段
+
+用法:
+  preamble_sim.py [--baud 115200,9600,2400] [--count 1,4] [--loop-us 200]
+                  [--think-us 5000] [--cc gcc]
+"""
+
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+COMP = os.path.normpath(os.path.join(HERE, "..", "..", "Components"))
+
+SOURCES = ["Protocol/protocol_manager.c", "Protocol/sim/preamble_bench.c"]
+
+
+def build(cc, tmp):
+    # 本机编译不带 EasyLogger, 日志宏置空
+    with open(os.path.join(tmp, "elog.h"), "w") as f:
+        f.write("#define log_i(...)\n#define log_e(...)\n"
+                "#define log_w(...)\n#define log_d(...)\n")
+    exe = os.path.join(tmp, "preamble_bench")
+    cmd = [cc, "-O2", "-w", "-I", tmp,
+           "-I", os.path.join(COMP, "Protocol"),
+           "-I", os.path.join(COMP, "Utility")]
+    cmd += [os.path.join(COMP, s) for s in SOURCES] + ["-o", exe]
+    subprocess.check_call(cmd)
+    return exe
+
+
+def run(exe, baud, count, loop_us, think_us):
+    out = subprocess.check_output(
+        [exe, str(baud), str(count), str(loop_us), str(think_us)],
+        universal_newlines=True)
+    rows = []
+    for line in out.splitlines():
+        p = line.split()
+        if p[0] != "cmd":
+            continue
+        rows.append({
+            "name": p[1], "mode": p[2], "len": int(p[3]), "pre": int(p[4]),
+            "blk_max": int(p[5]), "blk_sum": int(p[6]), "done": int(p[7]),
+            "st_blk": int(p[8]), "st_done": int(p[9]),
+            "timeouts": int(p[10]), "cb": int(p[11]), "bytes": int(p[12]),
+        })
+    return rows
+
+
+def fmt_us(us):
+    return "%.3f" % (us / 1000.0)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    ap.add_argument("--baud", default="115200,9600,2400")
+    ap.add_argument("--count", default="1,4",
+                    help="每条命令连续发送的次数")
+    ap.add_argument("--loop-us", type=int, default=200,
+                    help="主循环一圈的时间")
+    ap.add_argument("--think-us", type=int, default=5000,
+                    help="两次发送之间主循环做别的事的时间")
+    ap.add_argument("--cc", default="gcc")
+    args = ap.parse_args()
+
+    tmp = tempfile.mkdtemp(prefix="preamble_sim_")
+    try:
+        exe = build(args.cc, tmp)
+        bad = 0
+        for baud in [int(b) for b in args.baud.split(",")]:
+            for count in [int(c) for c in args.count.split(",")]:
+                rows = run(exe, baud, count, args.loop_us, args.think_us)
+                print("\n== %d bps, 每条命令 %d 帧, 间隔 %.1fms ==" %
+                      (baud, count, args.think_us / 1000.0))
+                print("%-6s %-5s %4s %5s %10s %10s %10s %12s %6s" %
+                      ("命令", "方式", "帧长", "前导", "阻塞最大ms",
+                       "阻塞平均ms", "发完ms", "统计阻塞/发完", "丢字节"))
+                for r in rows:
+                    lost = (r["len"] + r["pre"]) * count - r["bytes"]
+                    print("%-6s %-5s %4d %5d %10s %10s %10s %8d/%-5d %6d" % (
+                        r["name"], r["mode"], r["len"], r["pre"],
+                        fmt_us(r["blk_max"]), fmt_us(r["blk_sum"] / count),
+                        fmt_us(r["done"]), r["st_blk"], r["st_done"], lost))
+                    # 异步方式每帧都要有一次成功的完成回调, 且不丢字节
+                    if r["timeouts"] or (r["mode"] == "async" and
+                                         (r["cb"] != count or lost)):
+                        print("  !! 超时 %d 完成回调 %d" %
+                              (r["timeouts"], r["cb"]))
+                        bad += 1
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+    return 1 if bad else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,228 @@
+#!/usr/bin/env python3
+"""
+CPU 耗时剖析报告工具
+
+读取工装 PC 命令 68 B6 工位 02 和校验 16 导出的剖析数据:
+  #PROF BEGIN 采样数 中断内采样数 丢弃数 采样周期us 时钟Hz
+  Z 编号 次数 最大周期 总周期(16位十六进制)      主循环各任务 (PROF_ENTER/EXIT)
+  P PC(十六进制) 次数(十六进制)                  PC 采样直方图
+  #PROF END 次数累加和(十六进制)
+按 ELF 符号表把 PC 汇总到函数, 输出热点函数和主循环各任务耗时。
+
+用法:
+  prof_report.py --port /dev/ttyUSB0 --station 1 --start      清空并开始采样
+  prof_report.py --port /dev/ttyUSB0 --station 1 --elf build/xxx.elf
+      停止采样并导出, 按函数汇总
+  prof_report.py --log dump.txt --elf build/xxx.elf [--lines 10]
+      离线解析串口助手保存的导出文本; --lines N 对前N个热点PC给出源码行
+  --nm / --addr2line 指定工具 (默认 arm-none-eabi-nm / arm-none-eabi-addr2line)
+"""
+
+import argparse
+import bisect
+import subprocess
+import sys
+import time
+
+HEAD = 0x68
+TAIL = 0x16
+
+# 与 Inc/Prof_Ctrl.h 一致
+ZONE_NAMES = {
+    0: "Uart5_Rx_rec",
+    1: "Uart1_Rx_rec",
+    2: "Bus/Push_Process",
+    3: "Uart0_Rx_rec",
+    4: "LED_FLAG_LOOP",
+    5: "test_Loop_Func",
+    6: "主循环一轮",
+}
+ZONE_LOOP = 6
+
+
+def frame(cmd, station, payload=b""):
+    f = bytearray([HEAD, cmd, station]) + bytes(payload)
+    f.append(sum(f) & 0xFF)
+    f.append(TAIL)
+    return bytes(f)
+
+
+def parse_dump(text):
+    """返回 (头信息dict, 代码段{编号: (次数, 最大, 总)}, {pc: 次数})"""
+    head = None
+    zones = {}
+    pcs = {}
+    end_sum = None
+    for line in text.splitlines():
+        parts = line.strip().split()
+        if len(parts) >= 7 and parts[0] == "#PROF" and parts[1] == "BEGIN":
+            head = {"samples": int(parts[2]), "handler": int(parts[3]),
+                    "dropped": int(parts[4]), "period_us": int(parts[5]),
+                    "clk_hz": int(parts[6])}
+            zones.clear()
+            pcs.clear()
+        elif len(parts) == 5 and parts[0] == "Z":
+            zones[int(parts[1])] = (int(parts[2]), int(parts[3]), int(parts[4], 16))
+        elif len(parts) == 3 and parts[0] == "P":
+            pc = int(parts[1], 16)
+            pcs[pc] = pcs.get(pc, 0) + int(parts[2], 16)
+        elif len(parts) == 3 and parts[0] == "#PROF" and parts[1] == "END":
+            end_sum = int(parts[2], 16)
+    if head is None:
+        raise SystemExit("没有找到 #PROF BEGIN")
+    if end_sum is None:
+        print("警告: 导出不完整 (没有 #PROF END)", file=sys.stderr)
+    elif sum(pcs.values()) & 0xFFFF != end_sum:
+        print("警告: 累加和不一致, 数据可能有丢失", file=sys.stderr)
+    return head, zones, pcs
+
+
+# ---------------------------------------------------------------- 符号
+
+class Symbols:
+    def __init__(self, elf, nm):
+        out = subprocess.run([nm, "-n", "-S", "--defined-only", elf],
+                             capture_output=True, text=True, check=True).stdout
+        syms = []
+        for line in out.splitlines():
+            parts = line.split()
+            if len(parts) == 4:
+                addr, size, kind, name = parts
+                size = int(size, 16)
+            elif len(parts) == 3:
+                addr, kind, name = parts
+                size = 0
+            else:
+                continue
+            if kind not in "tTwW":
+                continue
+            # Thumb 函数地址最低位为1
+            syms.append((int(addr, 16) & ~1, size, name))
+        syms.sort()
+        self.addrs = [s[0] for s in syms]
+        self.syms = syms
+
+    def lookup(self, pc):
+        i = bisect.bisect_right(self.addrs, pc) - 1
+        if i < 0:
+            return None
+        addr, size, name = self.syms[i]
+        if size == 0:
+            # 没有大小的符号 (汇编标号) 以下一个符号为界
+            if i + 1 >= len(self.syms):
+                return None
+            size = self.syms[i + 1][0] - addr
+        if pc >= addr + size:
+            return None
+        return name
+
+
+def addr2line(tool, elf, pcs):
+    if not pcs:
+        return {}
+    out = subprocess.run([tool, "-e", elf, "-f", "-C"] + ["%x" % p for p in pcs],
+                         capture_output=True, text=True).stdout.splitlines()
+    return {pc: "%s %s" % (out[2 * k], out[2 * k + 1])
+            for k, pc in enumerate(pcs) if 2 * k + 1 < len(out)}
+
+
+# ---------------------------------------------------------------- 报告
+
+def print_zones(head, zones):
+    if not zones:
+        return
+    mhz = head["clk_hz"] / 1e6
+    loop_total = zones.get(ZONE_LOOP, (0, 0, 0))[2]
+    print("\n主循环各任务 (周期数 @%.0fMHz)" % mhz)
+    print("%-18s %10s %10s %10s %10s %8s" % ("任务", "次数", "平均us", "最大us", "总ms", "占一轮"))
+    for zid in sorted(zones):
+        count, mx, total = zones[zid]
+        share = "%7.1f%%" % (total * 100.0 / loop_total) if loop_total and zid != ZONE_LOOP else ""
+        print("%-18s %10d %10.1f %10.1f %10.1f %8s" % (
+            ZONE_NAMES.get(zid, "段%d" % zid), count, total / count / mhz,
+            mx / mhz, total / mhz / 1000.0, share))
+
+
+def print_hotspots(head, pcs, syms, top, lines, a2l, elf):
+    total = head["samples"]
+    print("采样 %d 次 (周期 %dus, 约 %.1fs), 中断内 %.1f%%, 直方图满丢弃 %d" % (
+        total, head["period_us"], total * head["period_us"] / 1e6,
+        head["handler"] * 100.0 / max(1, total), head["dropped"]))
+    funcs = {}
+    for pc, n in pcs.items():
+        name = syms.lookup(pc) if syms else None
+        name = name or "0x%08X" % pc
+        funcs[name] = funcs.get(name, 0) + n
+    print("\n%-36s %8s %7s" % ("函数", "采样", "占比"))
+    for name, n in sorted(funcs.items(), key=lambda x: -x[1])[:top]:
+        print("%-36s %8d %6.1f%%" % (name, n, n * 100.0 / max(1, total)))
+    if lines and elf:
+        hot = [pc for pc, _ in sorted(pcs.items(), key=lambda x: -x[1])[:lines]]
+        where = addr2line(a2l, elf, hot)
+        print("\n热点PC")
+        for pc in hot:
+            print("0x%08X %6d  %s" % (pc, pcs[pc], where.get(pc, "")))
+
+
+def serial_dump(args):
+    try:
+        import serial
+    except ImportError:
+        raise SystemExit("需要 pyserial: pip install pyserial")
+    with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+        port.reset_input_buffer()
+        if args.start:
+            port.write(frame(0xB6, args.station, b"\x01"))
+            time.sleep(0.5)
+            print("已开始采样, 运行需要剖析的场景后再导出")
+            return None
+        port.write(frame(0xB6, args.station, b"\x02"))
+        buf = bytearray()
+        deadline = time.time() + args.timeout
+        while time.time() < deadline:
+            buf += port.read(1024)
+            end = buf.rfind(b"#PROF END")
+            if end >= 0 and buf.find(b"\n", end) >= 0:
+                break
+    text = buf.decode("latin-1")
+    if args.save:
+        with open(args.save, "w", encoding="latin-1") as f:
+            f.write(text)
+    return text
+
+
+def main():
+    parser = argparse.ArgumentParser(description="CPU 耗时剖析报告")
+    parser.add_argument("--port", help="工装PC串口")
+    parser.add_argument("--baud", type=int, default=9600)
+    parser.add_argument("--station", type=int, default=1)
+    parser.add_argument("--start", action="store_true", help="清空并开始采样")
+    parser.add_argument("--timeout", type=float, default=10.0)
+    parser.add_argument("--save", help="保存导出文本")
+    parser.add_argument("--log", help="离线导出文本文件")
+    parser.add_argument("--elf", help="固件ELF, 用于符号化")
+    parser.add_argument("--nm", default="arm-none-eabi-nm")
+    parser.add_argument("--addr2line", default="arm-none-eabi-addr2line")
+    parser.add_argument("--top", type=int, default=20)
+    parser.add_argument("--lines", type=int, default=0, help="给出前N个热点PC的源码行")
+    args = parser.parse_args()
+
+    if args.log:
+        with open(args.log, encoding="latin-1") as f:
+            text = f.read()
+    elif args.port:
+        text = serial_dump(args)
+        if text is None:
+            return 0
+    else:
+        parser.error("需要 --port 或 --log")
+
+    head, zones, pcs = parse_dump(text)
+    syms = Symbols(args.elf, args.nm) if args.elf else None
+    print_hotspots(head, pcs, syms, args.top, args.lines, args.addr2line, args.elf)
+    print_zones(head, zones)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,345 @@
+#!/usr/bin/env python3
+"""
+测试事件主动上报 仿真/监听工具
+
+  sim     按固件时序模拟一条 RS-485 总线上的 N 个工位, 比较
+            poll  MES 轮流发送查询结果 68 AC 工位, 未测完的工位不应答(超时)
+            push  工位主动上报事件 68 B2, MES 确认 68 B3, 收到测试结束事件后
+                  查询一次结果
+          输出每次测试占用的总线字节数、线路占用率 (有数据在线上)、
+          总线占用率 (一问一答从开始到结束, 期间 MES 不能发其他命令)、
+          结果可用延时 (测试结束 -> MES 拿到结果) 以及 MES 命令等待总线的时间
+  listen  作为 MES 端接在真实总线上: 开启上报 (68 B4), 打印并确认收到的事件,
+          收到测试结束事件后查询结果, 统计结果可用延时
+
+用法:
+  push_sim.py sim [--stations 4] [--baud 9600] [--poll 1000] [--minutes 30]
+  push_sim.py listen --port /dev/ttyUSB0 [--stations 0 1 2 3] [--no-enable]
+"""
+
+import argparse
+import random
+import sys
+import time
+
+HEAD = 0x68
+TAIL = 0x16
+
+# 固件时序 (Src/uart1.c, Src/Push_Ctrl.h)
+RX_IDLE_MS = 100
+TX_PRE_MS = 5
+PUSH_IDLE_MS = 130
+PUSH_STAGGER_MS = 30
+PUSH_GAP_MS = 50
+PUSH_ACK_MS = 300
+PUSH_RETRY = 3
+PUSH_BURST = 4
+
+QUERY_LEN = 5
+RESULT_LEN = 63
+PUSH_LEN = 13
+ACK_LEN = 6
+
+EVT_NAMES = {1: "步骤开始", 2: "步骤结果", 3: "测试结束", 4: "异常", 5: "金样检测", 6: "校准采样"}
+STEP_NAMES = {0: "等待", 1: "VCC检测", 2: "主电检测", 3: "VDD检测", 4: "切换供电",
+              5: "设置表号", 6: "5G上告", 7: "功耗测试", 8: "结束"}
+
+# 各步骤典型耗时 ms (w_start .. w_end), 仿真时加 ±20% 抖动
+STEP_MS = [1000, 1000, 1000, 20, 3000, 9000, 2500, 10]
+
+
+def frame(cmd, station, payload=b""):
+    f = bytearray([HEAD, cmd, station]) + bytes(payload)
+    f.append(sum(f) & 0xFF)
+    f.append(TAIL)
+    return bytes(f)
+
+
+def percentile(values, p):
+    if not values:
+        return 0.0
+    v = sorted(values)
+    return v[min(len(v) - 1, int(len(v) * p / 100.0))]
+
+
+# ---------------------------------------------------------------- 仿真
+
+class Bus:
+    """单条半双工总线: 记录占用时间和最后活动时刻"""
+
+    def __init__(self, byte_ms):
+        self.byte_ms = byte_ms
+        self.free_at = 0.0
+        self.last_rx = 0.0
+        self.wire_ms = 0.0
+        self.busy_ms = 0.0
+        self.nbytes = 0
+
+    def send(self, t, nbytes, pre_ms=0.0):
+        """t 时刻请求发送, 返回发送结束时刻"""
+        start = max(t, self.free_at) + pre_ms
+        dur = nbytes * self.byte_ms
+        self.free_at = start + dur
+        self.last_rx = self.free_at
+        self.wire_ms += dur
+        self.nbytes += nbytes
+        return self.free_at
+
+    def reserve(self, start, end):
+        self.busy_ms += end - start
+
+
+class Station:
+    def __init__(self, sid, start_ms):
+        self.sid = sid
+        self.events = []          # (t, 类型) 待产生的事件
+        self.queue = []           # 已产生未确认的事件时刻
+        self.done_at = None       # 最近一次测试结束时刻 (结果未取走)
+        self.next_test = start_ms
+        self.last_tx = -1e9
+        self.tries = 0
+        self.retry_at = None
+        self.burst = 0
+        self.ack_end = -1e9
+        self.schedule()
+
+    def schedule(self):
+        t = self.next_test
+        for dur in STEP_MS:
+            self.events.append((t, 1))
+            t += dur * random.uniform(0.8, 1.2)
+            self.events.append((t, 2))
+        self.events.append((t, 3))
+        self.next_test = t
+
+    def pop_due(self, now):
+        due = [e for e in self.events if e[0] <= now]
+        self.events = [e for e in self.events if e[0] > now]
+        return due
+
+
+def simulate(mode, args):
+    random.seed(args.seed)
+    byte_ms = 10.0 * 1000.0 / args.baud
+    bus = Bus(byte_ms)
+    horizon = args.minutes * 60000.0
+    stations = [Station(k, random.uniform(0, 5000)) for k in range(args.stations)]
+    latency = []
+    cmd_wait = []
+    tests = 0
+    t = 0.0
+    poll_idx = 0
+    next_poll = 0.0
+
+    while t < horizon:
+        for st in stations:
+            for et, kind in st.pop_due(t):
+                if mode == "push":
+                    st.queue.append((et, kind))
+                if kind == 3:
+                    st.done_at = et
+                    tests += 1
+                    st.next_test = et + args.handoff
+                    st.schedule()
+
+        if mode == "poll":
+            if t >= next_poll and t >= bus.free_at:
+                st = stations[poll_idx]
+                poll_idx = (poll_idx + 1) % len(stations)
+                cmd_wait.append(t - next_poll)
+                t0 = t
+                end = bus.send(t, QUERY_LEN)
+                if st.done_at is not None:
+                    end = bus.send(end + RX_IDLE_MS, RESULT_LEN, TX_PRE_MS)
+                    latency.append(end - st.done_at)
+                    st.done_at = None
+                    t = end + args.gap
+                else:
+                    t = end + args.timeout
+                bus.free_at = max(bus.free_at, t)
+                bus.reserve(t0, t)
+                next_poll = t + max(0.0, args.poll / len(stations) - (t - next_poll))
+                continue
+        else:
+            sent = False
+            for st in stations:
+                if not st.queue:
+                    continue
+                if st.retry_at is not None and t < st.retry_at:
+                    continue
+                if st.tries > PUSH_RETRY:
+                    st.queue.pop(0)
+                    st.tries = 0
+                    st.retry_at = None
+                    continue
+                if t < bus.free_at or t - st.last_tx < PUSH_GAP_MS:
+                    continue
+                # 确认后总线无其他数据: 确认帧解析完即续发
+                fast = (st.retry_at is None and 0 < st.burst < PUSH_BURST
+                        and bus.last_rx <= st.ack_end and t >= st.ack_end + RX_IDLE_MS)
+                if not fast:
+                    if t - bus.last_rx < PUSH_IDLE_MS + st.sid * PUSH_STAGGER_MS:
+                        continue
+                    st.burst = 0
+                et, kind = st.queue[0]
+                end = bus.send(t, PUSH_LEN, TX_PRE_MS)
+                st.last_tx = t
+                st.tries += 1
+                if random.random() < args.loss:
+                    st.retry_at = t + PUSH_ACK_MS
+                    bus.reserve(t, end)
+                    t = end
+                    sent = True
+                    break
+                # MES 确认
+                ack_req = end + args.gap
+                cmd_wait.append(max(0.0, bus.free_at - ack_req))
+                t0 = t
+                end = bus.send(ack_req, ACK_LEN)
+                st.ack_end = end
+                st.burst = min(PUSH_BURST, st.burst + 1)
+                st.queue.pop(0)
+                st.tries = 0
+                st.retry_at = None
+                if kind == 3 and st.done_at is not None:
+                    # 收到测试结束后查询一次结果
+                    q = end + args.gap
+                    end = bus.send(q, QUERY_LEN)
+                    end = bus.send(end + RX_IDLE_MS, RESULT_LEN, TX_PRE_MS)
+                    latency.append(end - st.done_at)
+                    st.done_at = None
+                bus.reserve(t0, end)
+                t = end
+                sent = True
+                break
+            if sent:
+                continue
+        t += 1.0
+
+    return {
+        "tests": tests,
+        "bytes_per_test": bus.nbytes / max(1, tests),
+        "wire": bus.wire_ms / horizon * 100.0,
+        "busy": bus.busy_ms / horizon * 100.0,
+        "lat_avg": sum(latency) / max(1, len(latency)),
+        "lat_p95": percentile(latency, 95),
+        "lat_max": max(latency) if latency else 0.0,
+        "wait_max": max(cmd_wait) if cmd_wait else 0.0,
+    }
+
+
+def cmd_sim(args):
+    print("%d 工位, %d 波特率, 模拟 %d 分钟, 轮询周期 %dms, 上报丢帧率 %.0f%%" % (
+        args.stations, args.baud, args.minutes, args.poll, args.loss * 100))
+    print("%-5s %6s %10s %8s %8s %12s %12s %12s %12s" % (
+        "方式", "测试数", "字节/测试", "线路占用", "总线占用", "延时avg", "延时p95",
+        "延时max", "命令等待max"))
+    for mode in ("poll", "push"):
+        r = simulate(mode, args)
+        print("%-5s %6d %10.0f %7.1f%% %7.1f%% %10.0fms %10.0fms %10.0fms %10.0fms" % (
+            mode, r["tests"], r["bytes_per_test"], r["wire"], r["busy"], r["lat_avg"],
+            r["lat_p95"], r["lat_max"], r["wait_max"]))
+    return 0
+
+
+# ---------------------------------------------------------------- 监听
+
+def read_frames(port, buf):
+    buf += port.read(256)
+    out = []
+    i = 0
+    while i + 5 <= len(buf):
+        if buf[i] != HEAD:
+            i += 1
+            continue
+        n = {0xB2: PUSH_LEN, 0xAD: RESULT_LEN, 0xB5: 18}.get(buf[i + 1])
+        if n is None:
+            i += 1
+            continue
+        if i + n > len(buf):
+            break
+        f = bytes(buf[i:i + n])
+        if f[-1] == TAIL and sum(f[:-2]) & 0xFF == f[-2]:
+            out.append(f)
+            i += n
+        else:
+            i += 1
+    del buf[:i]
+    return out
+
+
+def cmd_listen(args):
+    try:
+        import serial
+    except ImportError:
+        raise SystemExit("需要 pyserial: pip install pyserial")
+    buf = bytearray()
+    done_at = {}
+    last_seq = {}
+    with serial.Serial(args.port, args.baud, timeout=0.02) as port:
+        if not args.no_enable:
+            for st in args.stations:
+                port.write(frame(0xB4, st, b"\x01"))
+                time.sleep(0.3)
+        print("监听中, Ctrl+C 退出")
+        try:
+            while True:
+                for f in read_frames(port, buf):
+                    st = f[2]
+                    if f[1] == 0xB5:
+                        print("工位%d 上报%s" % (st, "开启" if f[3] else "关闭"))
+                        continue
+                    if f[1] == 0xAD:
+                        if st in done_at:
+                            print("工位%d 结果可用, 延时 %.0fms" % (
+                                st, (time.time() - done_at.pop(st)) * 1000))
+                        continue
+                    seq, kind, step, res = f[3], f[4], f[5], f[6]
+                    val = int.from_bytes(f[7:11], "big")
+                    time.sleep(0.01)
+                    port.write(frame(0xB3, st, bytes([seq])))
+                    if last_seq.get(st) == seq:
+                        print("工位%d 重复事件 #%d (已确认)" % (st, seq))
+                        continue
+                    last_seq[st] = seq
+                    print("工位%d #%3d %s %s 结果=%d 数据=%d" % (
+                        st, seq, EVT_NAMES.get(kind, kind), STEP_NAMES.get(step, step),
+                        res, val))
+                    if kind == 3:
+                        done_at[st] = time.time()
+                        time.sleep(0.05)
+                        port.write(frame(0xAC, st))
+        except KeyboardInterrupt:
+            pass
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="测试事件主动上报 仿真/监听")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+
+    p = sub.add_parser("sim", help="比较轮询与主动上报")
+    p.add_argument("--stations", type=int, default=4)
+    p.add_argument("--baud", type=int, default=9600)
+    p.add_argument("--poll", type=float, default=1000.0, help="轮询一遍所有工位的周期(ms)")
+    p.add_argument("--timeout", type=float, default=150.0, help="轮询无应答超时(ms)")
+    p.add_argument("--gap", type=float, default=10.0, help="MES 收到后再发送的间隔(ms)")
+    p.add_argument("--handoff", type=float, default=5000.0, help="换料时间(ms)")
+    p.add_argument("--loss", type=float, default=0.0, help="上报帧丢失概率 (触发重发)")
+    p.add_argument("--minutes", type=int, default=30)
+    p.add_argument("--seed", type=int, default=1)
+    p.set_defaults(func=cmd_sim)
+
+    p = sub.add_parser("listen", help="作为 MES 接收真实上报")
+    p.add_argument("--port", required=True)
+    p.add_argument("--baud", type=int, default=9600)
+    p.add_argument("--stations", type=int, nargs="+", default=[0, 1, 2, 3])
+    p.add_argument("--no-enable", action="store_true", help="不发送开启命令")
+    p.set_defaults(func=cmd_listen)
+
+    args = parser.parse_args()
+    return args.func(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
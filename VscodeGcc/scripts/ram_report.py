@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+"""
+RAM 使用报告工具
+
+1. 解析 GNU ld 生成的 .map 文件 (CMake 已加 -Wl,-Map), 按模块(目标文件/库)
+   和目录汇总 .data / .bss / .noinit / COMMON 静态RAM, 并列出最大的变量。
+2. 可选经PC串口读取工装运行时栈水位 (命令 68 B8 工位 和校验 16), 与静态RAM
+   合并输出, 栈水位超过链接脚本保留的 _Stack_Size 时给出警告。
+
+用法:
+  ram_report.py --map build/xxx.map [--top 20] [--dirs]
+  ram_report.py --map build/xxx.map --port /dev/ttyUSB0 --station 1
+  ram_report.py --port /dev/ttyUSB0 --station 1          只读运行时数据
+"""
+
+import argparse
+import os
+import re
+import sys
+import time
+
+HEAD = 0x68
+TAIL = 0x16
+
+RAM_START = 0x20000000
+RAM_END = 0x20008000
+
+KINDS = (".data", ".bss", ".noinit", "COMMON")
+
+# 输入段行: " .bss.name  0x20000100  0x40 file" 或段名单独一行, 地址等在下一行
+SECT_RE = re.compile(r"^ (\.\S+|COMMON)(?:\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)\s+(.+))?$")
+CONT_RE = re.compile(r"^\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)\s+(.+)$")
+
+
+def frame(cmd, station, payload=b""):
+    f = bytearray([HEAD, cmd, station]) + bytes(payload)
+    f.append(sum(f) & 0xFF)
+    f.append(TAIL)
+    return bytes(f)
+
+
+def section_kind(name):
+    for kind in KINDS:
+        if name == kind or name.startswith(kind + "."):
+            return kind
+    return None
+
+
+def module_name(path):
+    """CMakeFiles/x.dir/Src/uart1.c.obj -> Src/uart1.c; libc.a(lib_a-x.o) 保持不变"""
+    path = path.strip().replace("\\", "/")
+    m = re.search(r"\.dir/(.+?)\.(?:obj|o)$", path)
+    if m:
+        return m.group(1)
+    m = re.search(r"([^/]+\.a)\((.+)\)$", path)
+    if m:
+        return "%s(%s)" % (m.group(1), m.group(2))
+    return os.path.basename(path)
+
+
+def parse_map(path):
+    """返回 [(类型, 变量名, 模块, 地址, 大小), ...], 只包含RAM中的输入段"""
+    with open(path, encoding="utf-8", errors="replace") as f:
+        lines = f.read().splitlines()
+    try:
+        start = next(i for i, l in enumerate(lines)
+                     if l.startswith("Linker script and memory map"))
+    except StopIteration:
+        raise SystemExit("%s 不是 GNU ld 的 map 文件" % path)
+
+    items = []
+    pending = None
+    for line in lines[start:]:
+        if pending is not None:
+            m = CONT_RE.match(line)
+            if m:
+                items.append((pending,) + m.groups())
+            pending = None
+            continue
+        m = SECT_RE.match(line)
+        if not m or section_kind(m.group(1)) is None:
+            continue
+        if m.group(2) is None:
+            pending = m.group(1)
+        else:
+            items.append(m.groups())
+
+    result = []
+    for name, addr, size, obj in items:
+        addr = int(addr, 16)
+        size = int(size, 16)
+        if size == 0 or not RAM_START <= addr < RAM_END:
+            continue
+        kind = section_kind(name)
+        # -fdata-sections 时段名后缀就是变量名
+        var = name[len(kind) + 1:] if name != kind else ""
+        result.append((kind, var, module_name(obj), addr, size))
+    return result
+
+
+def print_static(items, top, dirs):
+    total = {}
+    modules = {}
+    for kind, _, mod, _, size in items:
+        total[kind] = total.get(kind, 0) + size
+        row = modules.setdefault(mod, dict.fromkeys(KINDS, 0))
+        row[kind] += size
+
+    print("静态RAM %d 字节: %s" % (
+        sum(total.values()),
+        ", ".join("%s=%d" % (k, total[k]) for k in KINDS if k in total)))
+
+    print("\n%-44s %7s %7s %7s %7s %7s" % ("模块", ".data", ".bss", ".noinit", "COMMON", "合计"))
+    for mod, row in sorted(modules.items(), key=lambda x: -sum(x[1].values()))[:top]:
+        print("%-44s %7d %7d %7d %7d %7d" % (
+            mod, row[".data"], row[".bss"], row[".noinit"], row["COMMON"], sum(row.values())))
+
+    if dirs:
+        per_dir = {}
+        for mod, row in modules.items():
+            d = os.path.dirname(mod) if "(" not in mod else "(库)"
+            per_dir[d or "."] = per_dir.get(d or ".", 0) + sum(row.values())
+        print("\n%-44s %7s" % ("目录", "合计"))
+        for d, size in sorted(per_dir.items(), key=lambda x: -x[1]):
+            print("%-44s %7d" % (d, size))
+
+    print("\n%-32s %-8s %-10s %7s  %s" % ("变量", "段", "地址", "大小", "模块"))
+    named = sorted(items, key=lambda x: -x[4])[:top]
+    for kind, var, mod, addr, size in named:
+        print("%-32s %-8s 0x%08X %7d  %s" % (var or "-", kind, addr, size, mod))
+    return sum(total.values())
+
+
+def read_live(args):
+    try:
+        import serial
+    except ImportError:
+        raise SystemExit("需要 pyserial: pip install pyserial")
+    with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+        port.reset_input_buffer()
+        port.write(frame(0xB8, args.station))
+        buf = bytearray()
+        deadline = time.time() + args.timeout
+        while time.time() < deadline:
+            buf += port.read(64)
+            i = buf.find(bytes([HEAD, 0xB9, args.station]))
+            if i >= 0 and len(buf) >= i + 19:
+                f = buf[i:i + 19]
+                if f[18] == TAIL and sum(f[:17]) & 0xFF == f[17]:
+                    vals = [(f[3 + k * 2] << 8) | f[4 + k * 2] for k in range(7)]
+                    return dict(zip(("ram_size", "static_size", "heap_used", "stack_rsv",
+                                     "stack_peak", "stack_now", "free_min"), vals))
+                del buf[:i + 1]
+    raise SystemExit("工位 %d 无应答" % args.station)
+
+
+def print_live(live, static_size):
+    print("\n运行时 (工装实测)")
+    print("RAM总计      %6d" % live["ram_size"])
+    print("静态变量     %6d" % live["static_size"])
+    if static_size is not None and static_size != live["static_size"]:
+        print("  注意: 与map统计 %d 不一致, 固件版本可能与map不对应" % static_size)
+    print("堆已分配     %6d" % live["heap_used"])
+    print("栈水位       %6d / 保留 %d, 当前 %d" % (
+        live["stack_peak"], live["stack_rsv"], live["stack_now"]))
+    print("从未使用     %6d" % live["free_min"])
+    if live["stack_peak"] > live["stack_rsv"]:
+        print("警告: 栈水位超过 _Stack_Size %d 字节, 已占用堆区" % (
+            live["stack_peak"] - live["stack_rsv"]))
+        return 1
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="RAM 使用报告")
+    parser.add_argument("--map", help="链接生成的 .map 文件")
+    parser.add_argument("--top", type=int, default=20)
+    parser.add_argument("--dirs", action="store_true", help="同时按目录汇总")
+    parser.add_argument("--port", help="工装PC串口, 读取运行时栈水位")
+    parser.add_argument("--baud", type=int, default=9600)
+    parser.add_argument("--station", type=int, default=1)
+    parser.add_argument("--timeout", type=float, default=2.0)
+    args = parser.parse_args()
+
+    if not args.map and not args.port:
+        parser.error("需要 --map 或 --port")
+
+    static_size = None
+    if args.map:
+        static_size = print_static(parse_map(args.map), args.top, args.dirs)
+    if args.port:
+        return print_live(read_live(args), static_size)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
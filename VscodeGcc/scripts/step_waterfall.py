@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+"""
+测试步骤耗时瀑布图工具
+
+通过 PC 命令 0xD4 (测试统计) 读取工装 RAM 中的步骤耗时剖析数据:
+  段1 各步骤 次数/min/avg/max/p95 (us), 步骤 0xFF 为整个测试周期
+  段2 最近一次测试的时间线 (各步骤起始偏移和耗时)
+并以文本瀑布图显示, 便于定位测试节拍变慢的步骤。
+
+用法:
+  step_waterfall.py --port /dev/ttyUSB0 [--station 1] [--baud 9600]
+  step_waterfall.py --port COM3 --reset          清除工装中的耗时统计
+  step_waterfall.py --hex "55 D5 ..." [--hex "55 D5 ..."]
+      离线解析串口助手里抓到的应答帧 (可同时给出段1和段2)
+  --width 60                                      瀑布图宽度 (字符)
+"""
+
+import argparse
+import os
+import struct
+import sys
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from pc_cmd_table import load_table  # noqa: E402
+
+FRAME_HEAD = 0x55
+FRAME_TAIL = 0xAA
+STEP_CYCLE = 0xFF
+
+# 步骤名称 (与 Inc/Test_List.h 中 Test_liucheng 枚举一致)
+STEP_NAMES = {
+    0: "等待",
+    1: "VCC检测",
+    2: "主电检测",
+    3: "VDD检测",
+    4: "切换供电",
+    5: "设置表号",
+    6: "5G上告",
+    7: "功耗测试",
+    8: "结束",
+    STEP_CYCLE: "整个周期",
+}
+
+
+def cmd_codes():
+    for c in load_table():
+        if c.name == "TEST_STATS":
+            return c.code, c.ack_code
+    raise SystemExit("命令表中没有 TEST_STATS")
+
+
+def build_request(code, station, section):
+    frame = bytearray([FRAME_HEAD, code, 7, station, section])
+    frame.append(sum(frame) & 0xFF)
+    frame.append(FRAME_TAIL)
+    return bytes(frame)
+
+
+def parse_frame(data, ack_code):
+    """从字节流中找出第一帧 0xD5 应答, 返回 (段号, 段数据)"""
+    for i in range(len(data) - 5):
+        if data[i] != FRAME_HEAD or data[i + 1] != ack_code:
+            continue
+        n = data[i + 2]
+        if i + n > len(data) or data[i + n - 1] != FRAME_TAIL:
+            continue
+        frame = data[i:i + n]
+        if sum(frame[:-2]) & 0xFF != frame[-2]:
+            print("校验和错误, 丢弃", file=sys.stderr)
+            continue
+        return frame[4], frame[5:-2]
+    return None, None
+
+
+def parse_timing(body):
+    count = body[0]
+    rows = []
+    for k in range(count):
+        step, n, mn, avg, mx, p95 = struct.unpack_from("<BHIIII", body, 1 + k * 19)
+        rows.append((step, n, mn, avg, mx, p95))
+    return rows
+
+
+def parse_timeline(body):
+    total, count = struct.unpack_from("<IB", body, 0)
+    segs = [struct.unpack_from("<BII", body, 5 + k * 9) for k in range(count)]
+    return total, segs
+
+
+def name_of(step):
+    return STEP_NAMES.get(step, "步骤%d" % step)
+
+
+def fmt_us(us):
+    if us >= 1000000:
+        return "%.2fs" % (us / 1e6)
+    if us >= 1000:
+        return "%.1fms" % (us / 1e3)
+    return "%dus" % us
+
+
+def print_timing(rows):
+    print("%-10s %6s %10s %10s %10s %10s" % ("步骤", "次数", "min", "avg", "max", "p95"))
+    for step, n, mn, avg, mx, p95 in rows:
+        print("%-10s %6d %10s %10s %10s %10s" % (
+            name_of(step), n, fmt_us(mn), fmt_us(avg), fmt_us(mx), fmt_us(p95)))
+
+
+def print_waterfall(total, segs, width, timing):
+    if total == 0 or not segs:
+        print("还没有完整的测试时间线")
+        return
+    p95 = {row[0]: row[5] for row in timing or []}
+    print("\n最近一次测试 总耗时 %s" % fmt_us(total))
+    for step, start, dur in segs:
+        a = int(start * width / total)
+        b = max(a + 1, int((start + dur) * width / total))
+        bar = " " * a + "#" * (b - a) + " " * (width - b)
+        note = ""
+        if step in p95 and p95[step] and dur > p95[step]:
+            note = "  > p95 %s" % fmt_us(p95[step])
+        print("%-10s |%s| %9s @%s%s" % (name_of(step), bar, fmt_us(dur),
+                                        fmt_us(start), note))
+
+
+def query(port, station, section, req_code, ack_code, timeout):
+    port.reset_input_buffer()
+    port.write(build_request(req_code, station, section))
+    buf = bytearray()
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        buf += port.read(256)
+        sec, body = parse_frame(buf, ack_code)
+        if sec is not None:
+            return body
+    raise SystemExit("段%d 无应答" % section)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="测试步骤耗时瀑布图")
+    parser.add_argument("--port", help="工装PC串口")
+    parser.add_argument("--baud", type=int, default=9600)
+    parser.add_argument("--station", type=int, default=1, help="工位号")
+    parser.add_argument("--reset", action="store_true", help="清除耗时统计")
+    parser.add_argument("--hex", action="append", default=[], help="离线应答帧 (十六进制)")
+    parser.add_argument("--width", type=int, default=60)
+    parser.add_argument("--timeout", type=float, default=2.0)
+    args = parser.parse_args()
+
+    req_code, ack_code = cmd_codes()
+    timing = None
+    timeline = None
+
+    if args.hex:
+        for text in args.hex:
+            sec, body = parse_frame(bytes.fromhex(text.replace(" ", "")), ack_code)
+            if sec == 1:
+                timing = parse_timing(body)
+            elif sec == 2:
+                timeline = parse_timeline(body)
+    elif args.port:
+        try:
+            import serial
+        except ImportError:
+            raise SystemExit("需要 pyserial: pip install pyserial")
+        with serial.Serial(args.port, args.baud, timeout=0.05) as port:
+            if args.reset:
+                query(port, args.station, 0xFF, req_code, ack_code, args.timeout)
+                print("已清除耗时统计")
+                return 0
+            timing = parse_timing(query(port, args.station, 1, req_code, ack_code,
+                                        args.timeout))
+            timeline = parse_timeline(query(port, args.station, 2, req_code,
+                                            ack_code, args.timeout))
+    else:
+        parser.error("需要 --port 或 --hex")
+
+    if timing:
+        print_timing(timing)
+    if timeline:
+        print_waterfall(timeline[0], timeline[1], args.width, timing)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
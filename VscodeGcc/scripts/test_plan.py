@@ -0,0 +1,358 @@
+#!/usr/bin/env python3
+"""
+测试计划 上位机工具
+
+生成/查看测试计划镜像 (格式见 Components/FlashDB/test_plan.h), 生成PC
+下载帧 (0xDA), 并在本机用C检查固件侧的校验和切换逻辑。
+
+计划文件 (JSON):
+  {"version": 3, "product": 17, "timeout_ms": 90000,
+   "steps": [
+     {"step": "VCC", "interval_ms": 1000, "tries": 5, "lo": 3000, "hi": 3600},
+     {"step": "MAIN", "after": ["VCC"], "lo": 5500, "hi": 6500},
+     ...]}
+  step      步骤名 (见 STEPS) 或步骤号
+  after     前置步骤, 计划内下标或前面出现过的步骤名, 默认无
+  interval_ms/tries/timeout_ms  复测/重发间隔, 最多次数 (0=不限), 步骤超时 (0=不限)
+  lo/hi     合格范围 (lo < 测量值 < hi), 省略为不限
+  aux       附加限值 (VDD: 主电供电电压下限)
+
+子命令:
+  builtin [-o plan.json]            输出固件内置计划 (jig_config 默认值)
+  build plan.json -o plan.bin       生成镜像
+  show  plan.bin|plan.json          显示计划
+  frame plan.bin [--station N]      输出下载帧 hex (默认 FF 整线广播)
+  check [--cc gcc]                  编译 test_plan.c + jig_config.c + FlashDB
+                                    + 模拟NOR, 检查下载/校验/保存/切换
+"""
+
+import argparse
+import json
+import os
+import random
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import zlib
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.normpath(os.path.join(HERE, "..", ".."))
+FDB = os.path.join(ROOT, "Components", "FlashDB")
+
+MAGIC = 0x5054
+FORMAT = 1
+MAX_STEPS = 8
+HEAD = struct.Struct("<HBBHHI")
+STEP = struct.Struct("<BBHHHIiii")
+INT32_MIN, INT32_MAX = -2 ** 31, 2 ** 31 - 1
+
+# 步骤号与 Src/Test_List.c (enum Test_liucheng) 一致
+STEPS = {"VCC": 1, "MAIN": 2, "VDD": 3, "SWITCH": 4, "NTST": 5, "REPORT": 6, "CURRENT": 7}
+STEP_DESC = {1: "VCC检测", 2: "主电检测", 3: "VDD检测", 4: "切换供电",
+             5: "设置表号", 6: "5G上告", 7: "功耗测试"}
+NAMES = {v: k for k, v in STEPS.items()}
+
+RESULTS = ("成功", "长度错误", "魔数错误", "格式版本错误", "CRC错误", "步骤无效", "保存失败")
+STATES = ("内置", "下载的", "下一次测试起生效")
+
+# jig_config.c 默认值
+CFG = {"vcc_min": 3000, "vcc_max": 3600, "main_min": 5500, "main_max": 6500,
+       "vdd_min": 3200, "vdd_main": 4200, "test_tmo": 90000}
+
+
+def builtin_plan():
+    """与 Test_List.c test_jihua_neizhi() 相同"""
+    return {"version": 0, "product": 0, "timeout_ms": CFG["test_tmo"], "steps": [
+        {"step": "VCC", "interval_ms": 1000, "lo": CFG["vcc_min"], "hi": CFG["vcc_max"]},
+        {"step": "MAIN", "after": [0], "interval_ms": 1000,
+         "lo": CFG["main_min"], "hi": CFG["main_max"]},
+        {"step": "VDD", "after": [1], "interval_ms": 1000, "lo": CFG["vdd_min"],
+         "aux": CFG["vdd_main"]},
+        {"step": "SWITCH", "after": [0]},
+        {"step": "NTST", "after": [3], "interval_ms": 3000},
+        {"step": "REPORT", "after": [4], "interval_ms": 3000},
+        {"step": "CURRENT", "after": [5], "interval_ms": 1000},
+    ]}
+
+
+def step_id(value):
+    if isinstance(value, int):
+        return value
+    if value.upper() not in STEPS:
+        raise ValueError("未知步骤 %s (可用: %s)" % (value, ", ".join(STEPS)))
+    return STEPS[value.upper()]
+
+
+def encode(plan):
+    steps = plan["steps"]
+    if not 1 <= len(steps) <= MAX_STEPS:
+        raise ValueError("步骤数 %d 超出 1..%d" % (len(steps), MAX_STEPS))
+    out = HEAD.pack(MAGIC, FORMAT, len(steps), plan.get("version", 0),
+                    plan.get("product", 0), plan.get("timeout_ms", 90000))
+    seen = []
+    for i, s in enumerate(steps):
+        sid = step_id(s["step"])
+        after = 0
+        for a in s.get("after", []):
+            idx = a if isinstance(a, int) else seen.index(step_id(a))
+            if idx >= i:
+                raise ValueError("步骤%d 的前置步骤 %s 不在它前面" % (i, a))
+            after |= 1 << idx
+        lo = s.get("lo", INT32_MIN)
+        hi = s.get("hi", INT32_MAX)
+        out += STEP.pack(sid, s.get("tries", 0), after, s.get("interval_ms", 0), 0,
+                         s.get("timeout_ms", 0), INT32_MIN if lo is None else lo,
+                         INT32_MAX if hi is None else hi, s.get("aux", 0))
+        seen.append(sid)
+    return out + struct.pack("<I", zlib.crc32(out) & 0xFFFFFFFF)
+
+
+def decode(image):
+    magic, fmt, count, version, product, timeout = HEAD.unpack_from(image, 0)
+    if magic != MAGIC or fmt != FORMAT:
+        raise ValueError("不是测试计划镜像 (魔数 %04X, 格式 %d)" % (magic, fmt))
+    size = HEAD.size + count * STEP.size
+    crc = struct.unpack_from("<I", image, size)[0]
+    plan = {"version": version, "product": product, "timeout_ms": timeout, "steps": [],
+            "crc": crc, "crc_ok": zlib.crc32(image[:size]) & 0xFFFFFFFF == crc}
+    for i in range(count):
+        sid, tries, after, interval, _, tmo, lo, hi, aux = STEP.unpack_from(
+            image, HEAD.size + i * STEP.size)
+        s = {"step": NAMES.get(sid, sid), "after": [b for b in range(16) if after >> b & 1],
+             "interval_ms": interval, "tries": tries, "timeout_ms": tmo}
+        if lo != INT32_MIN:
+            s["lo"] = lo
+        if hi != INT32_MAX:
+            s["hi"] = hi
+        if aux:
+            s["aux"] = aux
+        plan["steps"].append(s)
+    return plan
+
+
+def frame(image, station):
+    body = bytes([0x55, 0xDA, len(image) + 6, station]) + image
+    return body + bytes([sum(body) & 0xFF, 0xAA])
+
+
+def load(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if path.endswith(".json"):
+        return encode(json.loads(data.decode("utf-8")))
+    return data
+
+
+def show(image):
+    plan = decode(image)
+    print("计划 v%d 产品%d 整体超时 %dms, %d 步, %d 字节, CRC %08X%s" % (
+        plan["version"], plan["product"], plan["timeout_ms"], len(plan["steps"]),
+        len(image), plan["crc"], "" if plan["crc_ok"] else " (错误)"))
+    for i, s in enumerate(plan["steps"]):
+        sid = step_id(s["step"])
+        rng = "%s < x < %s" % (s.get("lo", "-"), s.get("hi", "-"))
+        print("  [%d] %-8s 前置%-8s 间隔%5dms 次数%3s 超时%6s 范围 %s%s" % (
+            i, STEP_DESC.get(sid, sid), ",".join(map(str, s["after"])) or "-",
+            s["interval_ms"], s["tries"] or "不限", s["timeout_ms"] or "不限", rng,
+            " 附加%d" % s["aux"] if "aux" in s else ""))
+
+
+def cmd_builtin(args):
+    text = json.dumps(builtin_plan(), ensure_ascii=False, indent=2)
+    if args.output:
+        with open(args.output, "w", encoding="utf-8") as f:
+            f.write(text + "\n")
+    else:
+        print(text)
+    return 0
+
+
+def cmd_build(args):
+    image = load(args.plan)
+    with open(args.output, "wb") as f:
+        f.write(image)
+    show(image)
+    return 0
+
+
+def cmd_show(args):
+    show(load(args.plan))
+    return 0
+
+
+def cmd_frame(args):
+    image = load(args.plan)
+    data = frame(image, args.station)
+    print(data.hex(" ").upper())
+    # 9600 8N1: 每字节10位
+    print("%d 字节, 9600波特率 %.0fms" % (len(data), len(data) * 10 * 1000.0 / 9600),
+          file=sys.stderr)
+    return 0
+
+
+class Bench:
+    def __init__(self, cc, tmp):
+        with open(os.path.join(tmp, "elog.h"), "w") as f:
+            f.write("#define log_i(...)\n#define log_e(...)\n"
+                    "#define log_w(...)\n#define log_d(...)\n")
+        exe = os.path.join(tmp, "test_plan_bench")
+        sources = ["src/fdb.c", "src/fdb_kvdb.c", "src/fdb_utils.c",
+                   "port/fal/src/fal.c", "port/fal/src/fal_flash.c",
+                   "port/fal/src/fal_partition.c", "fal_flash_fm33lg04_port.c",
+                   "sim/flash_sim.c", "jig_config.c", "test_plan.c",
+                   "sim/test_plan_bench.c"]
+        util = os.path.join(ROOT, "Components", "Utility")
+        subprocess.check_call(
+            [cc, "-O2", "-w", "-DFAL_FLASH_SIM", "-I", tmp, "-I", FDB,
+             "-I", os.path.join(FDB, "inc"), "-I", os.path.join(FDB, "port", "fal", "inc"),
+             "-I", os.path.join(FDB, "sim"), "-I", util] +
+            [os.path.join(FDB, s) for s in sources] +
+            [os.path.join(util, "utility_crc.c"), "-o", exe])
+        self.proc = subprocess.Popen([exe], stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                                     universal_newlines=True)
+
+    def cmd(self, text):
+        self.proc.stdin.write(text + "\n")
+        self.proc.stdin.flush()
+        # 跳过 FAL 的日志行
+        while True:
+            r = self.proc.stdout.readline().split()
+            if not r or r[0] == text.split()[0]:
+                return r
+
+    def load(self, image):
+        r = self.cmd("load " + (image.hex() if image else "-"))
+        return int(r[1]), int(r[2]), int(r[3])
+
+    def close(self):
+        self.proc.stdin.close()
+        self.proc.wait()
+
+
+def cmd_check(args):
+    tmp = tempfile.mkdtemp(prefix="test_plan_")
+    failed = []
+    checks = [0]
+
+    def expect(name, got, want):
+        checks[0] += 1
+        if got != want:
+            failed.append("%s: %s, 应为 %s" % (name, got, want))
+
+    try:
+        b = Bench(args.cc, tmp)
+        builtin = encode(builtin_plan())
+        r = b.cmd("read")
+        expect("内置计划读取 (C编码与本脚本一致)", (r[1], r[2]), ("0", builtin.hex()))
+
+        plan = builtin_plan()
+        plan.update(version=7, product=0x21)
+        plan["steps"][0].update(tries=5, lo=3100, hi=3500)
+        plan["steps"][4].update(tries=10, timeout_ms=40000)
+        good = encode(plan)
+        expect("下载", b.load(good), (0, 0xFF, 2))
+        r = b.cmd("read")
+        expect("下载后读取", (r[1], r[2]), ("2", good.hex()))
+        expect("测试开始切换", b.cmd("begin")[1:3], ["7", "%08x" % zlib.crc32(good[:-4])])
+        expect("切换后状态", b.cmd("read")[1], "1")
+
+        # 进行中的测试不受新计划影响: 下载后当前计划不变, 下一次 begin 才切换
+        plan2 = dict(plan, version=8)
+        second = encode(plan2)
+        expect("测试中下载", b.load(second), (0, 0xFF, 2))
+        writes = b.cmd("writes")[1]
+        expect("重复下载", b.load(second), (0, 0xFF, 2))
+        expect("重复下载不重写Flash", b.cmd("writes")[1], writes)
+        expect("下一次测试切换", b.cmd("begin")[1], "8")
+
+        # 任意单个比特翻转都必须拒收
+        rejected = 0
+        for bit in range(len(second) * 8):
+            bad = bytearray(second)
+            bad[bit // 8] ^= 1 << (bit % 8)
+            if b.load(bytes(bad))[0] != 0:
+                rejected += 1
+        expect("单比特翻转拒收", rejected, len(second) * 8)
+        rng = random.Random(1)
+        for n in range(200):
+            cut = rng.randrange(1, len(second))  # 空镜像为删除计划
+            if b.load(second[:cut])[0] == 0:
+                rejected = -1
+        expect("截断拒收", rejected >= 0, True)
+        expect("拒收后计划不变", b.cmd("read")[1:], ["1", second.hex()])
+
+        # 语义错误: 出错步骤下标
+        def bad_plan(idx, **kw):
+            p = json.loads(json.dumps(plan2))
+            p["steps"][idx].update(kw)
+            return p
+        for name, p, idx in (
+                ("未知步骤号", bad_plan(3, step=9), 3),
+                ("间隔过小", bad_plan(5, interval_ms=5), 5),
+                ("下限不小于上限", bad_plan(2, lo=5000, hi=5000), 2),
+                ("步骤超时过大", bad_plan(6, timeout_ms=700000), 6)):
+            expect(name, b.load(encode(p))[:2], (5, idx))
+        p = json.loads(json.dumps(plan2))
+        image = bytearray(encode(p))
+        struct.pack_into("<H", image, HEAD.size + 1 * STEP.size + 2, 1 << 3)  # 前置指向后面
+        image[-4:] = struct.pack("<I", zlib.crc32(bytes(image[:-4])) & 0xFFFFFFFF)
+        expect("前置步骤在后面", b.load(bytes(image))[:2], (5, 1))
+        p = dict(plan2, timeout_ms=500)
+        expect("整体超时过小", b.load(encode(p))[:2], (5, 0xFF))
+        expect("错误计划不影响当前计划", b.cmd("read")[1:], ["1", second.hex()])
+
+        # 复位后从KVDB加载, 第一次测试开始时生效
+        expect("复位后加载", b.cmd("reboot")[1], "2")
+        expect("复位后第一次测试", b.cmd("begin")[1], "8")
+
+        # 删除计划: 下一次测试起恢复内置计划, 复位后也是内置计划
+        expect("删除计划", b.load(b""), (0, 0xFF, 2))
+        expect("删除后读取为内置计划", b.cmd("read")[2], builtin.hex())
+        expect("删除后测试开始", b.cmd("begin")[1:4], ["0", "00000000", "7"])
+        expect("删除后复位", b.cmd("reboot")[1], "0")
+        b.close()
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+
+    full = frame(good, 0xFF)
+    print("内置计划 %d 字节, 下载帧 %d 字节, 9600波特率 %.0fms (整线广播一帧)" % (
+        len(builtin), len(full), len(full) * 10 * 1000.0 / 9600))
+    for f in failed:
+        print("失败: " + f)
+    print("%d 项检查, %d 项失败" % (checks[0], len(failed)))
+    return 1 if failed else 0
+
+
+def main():
+    p = argparse.ArgumentParser(description="测试计划上位机工具")
+    sub = p.add_subparsers(dest="cmd")
+    s = sub.add_parser("builtin", help="输出固件内置计划")
+    s.add_argument("-o", "--output")
+    s = sub.add_parser("build", help="生成镜像")
+    s.add_argument("plan")
+    s.add_argument("-o", "--output", required=True)
+    s = sub.add_parser("show", help="显示计划")
+    s.add_argument("plan")
+    s = sub.add_parser("frame", help="输出下载帧")
+    s.add_argument("plan")
+    s.add_argument("--station", type=lambda v: int(v, 0), default=0xFF)
+    s = sub.add_parser("check", help="本机检查固件侧下载/校验/切换")
+    s.add_argument("--cc", default="gcc")
+    args = p.parse_args()
+
+    handlers = {"builtin": cmd_builtin, "build": cmd_build, "show": cmd_show,
+                "frame": cmd_frame, "check": cmd_check}
+    if args.cmd not in handlers:
+        p.print_help()
+        return 1
+    try:
+        return handlers[args.cmd](args)
+    except ValueError as e:
+        print("错误: %s" % e, file=sys.stderr)
+        return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
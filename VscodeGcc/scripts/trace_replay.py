@@ -0,0 +1,524 @@
+#!/usr/bin/env python3
+"""
+串口通讯录制分析/回放工具
+
+配合固件 Trace_Ctrl (PC命令 68 A0 工位 子命令 和校验 16) 使用:
+  子命令 1 开始录制, 0 停止, 2 导出。导出文本形如
+    #TRACE BEGIN <条数> <丢弃数>
+    T 40AA6400 ...
+    #TRACE END <16位累加和>
+  子命令 3 流式录制: 工装边录边在 UART1 空闲时发出 T 行 (与其他输出交错),
+  子命令 0 停止后发完剩余记录, 可覆盖整个测试周期:
+    #TRACE BEGIN STREAM
+    T ...
+    #TRACE STREAM END <条数> <丢弃数> <16位累加和>
+  可直接保存串口助手日志, 本工具会从中提取。
+
+用法:
+  trace_replay.py stats  <录制日志>                 统计总周期、各步骤延时
+  trace_replay.py diff   <参考日志> <新日志>        比对工装发出的帧
+  trace_replay.py replay <录制日志> --port UART1=/dev/ttyUSB0 [--port UART0=/dev/ttyUSB1 ...]
+                         [--baud UART1=9600] [--out new.trace]
+      按原始字节间隔把工装当时收到的数据(PC/被测设备)重新灌入工装,
+      同时采集工装发出的数据, 保存为同格式日志并与录制比对。
+  trace_replay.py sim    <录制日志> [--station N] [--rail vcc=3300 ...] [--cfg step_ovl=1 ...]
+                         [--loop-us 20] [--out new.trace] [--cc gcc]
+      不需要工装: 用本机 gcc 把 PC_xieyi_Ctrl.c、Test_List.c、tongxin_xieyi_Ctrl.c、
+      uart0.c/uart1.c、Bus_Ctrl.c、Push_Ctrl.c、协议管理器和PC命令表、步骤执行器和
+      jig_config/test_plan (模拟NOR) 编译成 Src/sim/replay_bench.c, 串口和1ms节拍由
+      Src/sim/uart_sim.c 按 Uart_Ctrl.c 的时序模拟 (9600/115200 每字节10位)。
+      录制中工装收到的字节按原始时间送入模拟串口的接收中断, 工装发出的字节按模拟时间
+      录制, 再与录制比对 (内容和每步延时)。
+      ADC/电流读数不在串口录制中: 默认取录制中结果应答 (68 AD) 里的测量值, 没有时
+      用 --rail 指定 (默认在内置计划合格范围内)。工位号默认取录制中的开始应答 (68 AB),
+      经配置项 station 设置。
+      0x55 帧 (配置/计划/金样/校准/后台下载) 和透传不在仿真范围内, 只报告条数。
+"""
+
+import argparse
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+PORT_NAMES = ["UART0", "UART1", "UART5"]
+PORT_EXT = 3
+DIR_RX = 0
+DIR_TX = 1
+
+# 默认波特率 (与固件一致)
+DEFAULT_BAUD = {"UART0": 115200, "UART1": 9600, "UART5": 9600}
+
+# 录制控制帧本身不参与比对
+IGNORE_CMDS = {0xA0, 0xA1}
+
+
+class TraceByte:
+    __slots__ = ("t_us", "port", "dir", "data")
+
+    def __init__(self, t_us, port, direction, data):
+        self.t_us = t_us
+        self.port = port
+        self.dir = direction
+        self.data = data
+
+
+class Frame:
+    """同一端口、同一方向、字节间隔不超过 gap 的连续字节"""
+
+    def __init__(self, port, direction, t_start):
+        self.port = port
+        self.dir = direction
+        self.t_start = t_start
+        self.t_end = t_start
+        self.data = bytearray()
+
+    @property
+    def cmd(self):
+        # PC协议: 68 CMD ...
+        if len(self.data) >= 2 and self.data[0] == 0x68:
+            return self.data[1]
+        return None
+
+    def name(self):
+        return "%s %s" % (PORT_NAMES[self.port], "TX" if self.dir == DIR_TX else "RX")
+
+    def hex(self, limit=24):
+        text = " ".join("%02X" % b for b in self.data[:limit])
+        if len(self.data) > limit:
+            text += " ..(%d)" % len(self.data)
+        return text
+
+
+# ---------------------------------------------------------------------------
+# 解析 / 生成
+# ---------------------------------------------------------------------------
+
+# 流式导出的 T 行前面可能紧接其他 UART1 输出 (应答帧没有换行)
+STREAM_LINE = re.compile(r"T ((?:[0-9A-F]{8}){1,8})\r?\n")
+
+
+def parse_dump(text):
+    """从日志文本中提取最后一段完整的 #TRACE 导出 (缓存或流式), 返回 TraceByte 列表"""
+    blocks = [(m.start(), m.group(1), m.group(2), m.group(3), m.group(4), False) for m in
+              re.finditer(r"#TRACE BEGIN (\d+) (\d+)\s*\r?\n(.*?)#TRACE END ([0-9A-Fa-f]{4})",
+                          text, re.S)]
+    blocks += [(m.start(), m.group(2), m.group(3), m.group(1), m.group(4), True) for m in
+               re.finditer(r"#TRACE BEGIN STREAM\s*\r?\n(.*?)#TRACE STREAM END (\d+) (\d+) ([0-9A-Fa-f]{4})",
+                           text, re.S)]
+    if not blocks:
+        raise ValueError("未找到 #TRACE BEGIN/END 段")
+    _, count, dropped, body, checksum, stream = max(blocks)
+    raw = bytearray()
+    if stream:
+        for m in STREAM_LINE.finditer(body):
+            raw += bytes.fromhex(m.group(1))
+    else:
+        for line in body.splitlines():
+            line = line.strip()
+            if line.startswith("T "):
+                raw += bytes.fromhex(line[2:].strip())
+    if len(raw) != int(count) * 4:
+        raise ValueError("条数不符: 头部 %s, 实际 %d" % (count, len(raw) // 4))
+    if (sum(raw) & 0xFFFF) != int(checksum, 16):
+        raise ValueError("校验和错误: 头部 %s, 计算 %04X" % (checksum, sum(raw) & 0xFFFF))
+    if int(dropped):
+        print("警告: 录制缓冲区已满, 丢弃 %s 字节" % dropped, file=sys.stderr)
+
+    entries = []
+    t_us = 0
+    ext = 0
+    for i in range(0, len(raw), 4):
+        tag, data = raw[i], raw[i + 1]
+        dt = raw[i + 2] | (raw[i + 3] << 8)
+        port = tag >> 6
+        if port == PORT_EXT:
+            ext = dt << 16
+            continue
+        t_us += ext + dt
+        ext = 0
+        entries.append(TraceByte(t_us, port, (tag >> 5) & 1, data))
+    return entries
+
+
+def format_dump(entries):
+    """生成与固件相同格式的导出文本"""
+    raw = bytearray()
+    last = entries[0].t_us if entries else 0
+    for e in entries:
+        dt = max(0, e.t_us - last)
+        last = e.t_us
+        if dt > 0xFFFF:
+            raw += bytes([PORT_EXT << 6, 0, (dt >> 16) & 0xFF, (dt >> 24) & 0xFF])
+            dt &= 0xFFFF
+        raw += bytes([(e.port << 6) | (e.dir << 5), e.data, dt & 0xFF, dt >> 8])
+    lines = ["#TRACE BEGIN %d 0" % (len(raw) // 4)]
+    for i in range(0, len(raw), 32):
+        lines.append("T " + raw[i:i + 32].hex().upper())
+    lines.append("#TRACE END %04X" % (sum(raw) & 0xFFFF))
+    return "\r\n".join(lines) + "\r\n"
+
+
+def load(path):
+    with open(path, "rb") as f:
+        return parse_dump(f.read().decode("latin-1"))
+
+
+def split_frames(entries, gap_ms):
+    frames = []
+    open_frames = {}
+    gap_us = gap_ms * 1000
+    for e in entries:
+        key = (e.port, e.dir)
+        fr = open_frames.get(key)
+        if fr is None or e.t_us - fr.t_end > gap_us:
+            fr = Frame(e.port, e.dir, e.t_us)
+            open_frames[key] = fr
+            frames.append(fr)
+        fr.data.append(e.data)
+        fr.t_end = e.t_us
+    frames.sort(key=lambda f: f.t_start)
+    return [f for f in frames if f.cmd not in IGNORE_CMDS]
+
+
+# ---------------------------------------------------------------------------
+# 统计
+# ---------------------------------------------------------------------------
+
+def steps(frames):
+    """每个收到的帧到工装下一次发出数据的延时 (即一步处理耗时)"""
+    result = []
+    for i, fr in enumerate(frames):
+        if fr.dir != DIR_RX:
+            continue
+        for nxt in frames[i + 1:]:
+            if nxt.dir == DIR_TX:
+                result.append((fr, nxt, (nxt.t_start - fr.t_end) / 1000.0))
+                break
+    return result
+
+
+def cycle_time(frames):
+    """PC开始命令(0xAA)到结果应答(0xAD)的总周期, 没有则取首尾"""
+    start = next((f for f in frames if f.dir == DIR_RX and f.cmd == 0xAA), None)
+    end = next((f for f in reversed(frames) if f.dir == DIR_TX and f.cmd == 0xAD), None)
+    if start is None or end is None:
+        if not frames:
+            return 0.0
+        start, end = frames[0], frames[-1]
+    return (end.t_end - start.t_start) / 1000.0
+
+
+def cmd_stats(args):
+    frames = split_frames(load(args.trace), args.gap)
+    print("帧数: %d   总周期: %.1f ms" % (len(frames), cycle_time(frames)))
+    print("%10s  %-9s %-30s -> %-9s %9s" % ("t(ms)", "输入", "", "输出", "延时(ms)"))
+    for rx, tx, lat in steps(frames):
+        print("%10.1f  %-9s %-30s -> %-9s %9.1f" % (rx.t_start / 1000.0, rx.name(), rx.hex(10), tx.name(), lat))
+    return 0
+
+
+# ---------------------------------------------------------------------------
+# 比对
+# ---------------------------------------------------------------------------
+
+def diff_frames(ref, new, tolerance_ms):
+    """逐端口比对工装发出的帧, 返回差异条数"""
+    diverged = 0
+    ref_lat = {id(tx): lat for _, tx, lat in steps(ref)}
+    new_lat = {id(tx): lat for _, tx, lat in steps(new)}
+    for port in range(len(PORT_NAMES)):
+        a = [f for f in ref if f.port == port and f.dir == DIR_TX]
+        b = [f for f in new if f.port == port and f.dir == DIR_TX]
+        for i in range(max(len(a), len(b))):
+            fa = a[i] if i < len(a) else None
+            fb = b[i] if i < len(b) else None
+            if fa is None:
+                print("[%s #%d] 多出: %s" % (PORT_NAMES[port], i, fb.hex()))
+                diverged += 1
+            elif fb is None:
+                print("[%s #%d] 缺少: %s" % (PORT_NAMES[port], i, fa.hex()))
+                diverged += 1
+            elif fa.data != fb.data:
+                pos = next((k for k in range(min(len(fa.data), len(fb.data)))
+                            if fa.data[k] != fb.data[k]), min(len(fa.data), len(fb.data)))
+                print("[%s #%d] 内容不同 (第%d字节)\n    参考: %s\n    新  : %s"
+                      % (PORT_NAMES[port], i, pos, fa.hex(), fb.hex()))
+                diverged += 1
+            else:
+                la, lb = ref_lat.get(id(fa)), new_lat.get(id(fb))
+                if la is not None and lb is not None and abs(la - lb) > tolerance_ms:
+                    print("[%s #%d] 延时变化 %.1f -> %.1f ms: %s"
+                          % (PORT_NAMES[port], i, la, lb, fa.hex(10)))
+    ca, cb = cycle_time(ref), cycle_time(new)
+    print("总周期: 参考 %.1f ms, 新 %.1f ms (%+.1f ms)" % (ca, cb, cb - ca))
+    print("差异: %d" % diverged)
+    return diverged
+
+
+def cmd_diff(args):
+    ref = split_frames(load(args.ref), args.gap)
+    new = split_frames(load(args.new), args.gap)
+    return 1 if diff_frames(ref, new, args.tolerance) else 0
+
+
+# ---------------------------------------------------------------------------
+# 回放
+# ---------------------------------------------------------------------------
+
+def parse_mapping(items, convert):
+    result = {}
+    for item in items or []:
+        name, _, value = item.partition("=")
+        name = name.upper()
+        if name not in PORT_NAMES or not value:
+            raise SystemExit("无效参数: %s (应为 UART0/UART1/UART5=值)" % item)
+        result[PORT_NAMES.index(name)] = convert(value)
+    return result
+
+
+def cmd_replay(args):
+    try:
+        import serial
+    except ImportError:
+        raise SystemExit("回放需要 pyserial: pip install pyserial")
+
+    ref_entries = load(args.trace)
+    devices = parse_mapping(args.port, str)
+    bauds = parse_mapping(args.baud, int)
+    if not devices:
+        raise SystemExit("至少指定一个 --port")
+
+    ports = {}
+    for idx, dev in devices.items():
+        baud = bauds.get(idx, DEFAULT_BAUD[PORT_NAMES[idx]])
+        ports[idx] = serial.Serial(dev, baud, timeout=0.01)
+        ports[idx].reset_input_buffer()
+
+    captured = []
+    lock = threading.Lock()
+    stop = threading.Event()
+    t0 = time.perf_counter()
+
+    def now_us():
+        return int((time.perf_counter() - t0) * 1e6)
+
+    def reader(idx, ser):
+        while not stop.is_set():
+            chunk = ser.read(256)
+            t = now_us()
+            with lock:
+                for b in chunk:
+                    captured.append(TraceByte(t, idx, DIR_TX, b))
+
+    threads = [threading.Thread(target=reader, args=item, daemon=True) for item in ports.items()]
+    for th in threads:
+        th.start()
+
+    # 按原始时间重放工装收到的字节 (未映射的端口跳过)
+    feed = [e for e in ref_entries if e.dir == DIR_RX and e.port in ports]
+    base = feed[0].t_us if feed else 0
+    for e in feed:
+        target = (e.t_us - base) / 1e6
+        delay = target - (time.perf_counter() - t0)
+        if delay > 0.002:
+            time.sleep(delay - 0.001)
+        while time.perf_counter() - t0 < target:
+            pass
+        t = now_us()
+        ports[e.port].write(bytes([e.data]))
+        with lock:
+            captured.append(TraceByte(t, e.port, DIR_RX, e.data))
+
+    # 等待最后一次输出
+    last_ref = ref_entries[-1].t_us - base if ref_entries else 0
+    time.sleep(max(args.settle, (last_ref - now_us()) / 1e6 + args.settle))
+    stop.set()
+    for th in threads:
+        th.join()
+    for ser in ports.values():
+        ser.close()
+
+    captured.sort(key=lambda e: e.t_us)
+    if args.out:
+        with open(args.out, "w", newline="") as f:
+            f.write(format_dump(captured))
+        print("已保存: %s" % args.out)
+
+    # 只比对已映射端口
+    ref = [f for f in split_frames(ref_entries, args.gap) if f.port in ports]
+    new = split_frames(captured, args.gap)
+    return 1 if diff_frames(ref, new, args.tolerance) else 0
+
+
+# ---------------------------------------------------------------------------
+# 本机仿真回放
+# ---------------------------------------------------------------------------
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.normpath(os.path.join(HERE, "..", ".."))
+
+# 固件源文件, 与 Src/sim 中的一个主程序 (replay_bench.c / bus_bench.c) 一起编译
+SIM_SOURCES = [
+    "Src/sim/uart_sim.c", "Src/sim/jig_stubs.c",
+    "Src/PC_xieyi_Ctrl.c", "Src/Test_List.c", "Src/tongxin_xieyi_Ctrl.c",
+    "Src/uart0.c", "Src/uart1.c", "Src/Bus_Ctrl.c", "Src/Push_Ctrl.c",
+    "Components/Protocol/protocol_manager.c", "Components/Protocol/PC/pc_cmd_table.c",
+    "Components/TimeManager/step_executor.c", "Components/TimeManager/step_profiler.c",
+    "Components/FlashDB/src/fdb.c", "Components/FlashDB/src/fdb_kvdb.c",
+    "Components/FlashDB/src/fdb_utils.c", "Components/FlashDB/port/fal/src/fal.c",
+    "Components/FlashDB/port/fal/src/fal_flash.c",
+    "Components/FlashDB/port/fal/src/fal_partition.c",
+    "Components/FlashDB/fal_flash_fm33lg04_port.c", "Components/FlashDB/sim/flash_sim.c",
+    "Components/FlashDB/jig_config.c", "Components/FlashDB/test_plan.c",
+    "Components/Utility/utility_crc.c",
+]
+
+# Src/sim 中的 mf_config.h 代替 FL 驱动; 用 -iquote 避免 Inc/time.h 遮住系统 <time.h>
+SIM_QUOTE_DIRS = [
+    "Src/sim", "Inc", "Components", "Components/Protocol", "Components/Protocol/PC",
+    "Components/TimeManager", "Components/LedIndicator", "Components/Utility",
+    "Components/FlashDB",
+]
+SIM_INC_DIRS = [
+    "Components/FlashDB", "Components/FlashDB/inc", "Components/FlashDB/port/fal/inc",
+    "Components/FlashDB/sim", "Components/Utility",
+]
+
+# 68 AD 结果应答中的测量值 (PC_xieyifasong_2, 值/10, 大端)
+RESULT_RAILS = (("main", 3), ("cur", 5), ("vdd", 7), ("vcc", 9))
+
+
+def sim_build(cc, tmp, bench="replay_bench"):
+    # 本机编译不带 EasyLogger, 日志宏置空
+    with open(os.path.join(tmp, "elog.h"), "w") as f:
+        f.write("#define log_i(...)\n#define log_e(...)\n"
+                "#define log_w(...)\n#define log_d(...)\n")
+    exe = os.path.join(tmp, bench)
+    cmd = [cc, "-O2", "-w", "-DFAL_FLASH_SIM", "-DFAL_PRINTF(...)=", "-I", tmp]
+    for d in SIM_QUOTE_DIRS:
+        cmd += ["-iquote", os.path.join(ROOT, d)]
+    for d in SIM_INC_DIRS:
+        cmd += ["-I", os.path.join(ROOT, d)]
+    cmd += [os.path.join(ROOT, "Src", "sim", bench + ".c")]
+    cmd += [os.path.join(ROOT, s) for s in SIM_SOURCES] + ["-o", exe]
+    subprocess.check_call(cmd)
+    return exe
+
+
+def sim_defaults(frames):
+    """从录制的应答中取工位号和测量值"""
+    station = None
+    rails = {}
+    for f in frames:
+        if f.dir != DIR_TX or f.port != PORT_NAMES.index("UART1"):
+            continue
+        if f.cmd == 0xAB and len(f.data) >= 3 and station is None:
+            station = f.data[2]
+        elif f.cmd == 0xAD and len(f.data) >= 11:
+            rails = {name: ((f.data[i] << 8) | f.data[i + 1]) * 10 for name, i in RESULT_RAILS}
+    return station, rails
+
+
+def cmd_sim(args):
+    ref_entries = load(args.trace)
+    ref = split_frames(ref_entries, args.gap)
+    feed = [e for e in ref_entries if e.dir == DIR_RX]
+    if not feed:
+        raise SystemExit("录制中没有工装收到的数据")
+    base = feed[0].t_us
+
+    station, rails = sim_defaults(ref)
+    if args.station is not None:
+        station = args.station
+    for item in args.rail or []:
+        name, _, value = item.partition("=")
+        rails[name] = int(value)
+    opts = ["-l", str(args.loop_us),
+            "-e", str(ref_entries[-1].t_us - base + int(args.settle * 1e6))]
+    if station is not None:
+        opts += ["-c", "station=%d" % station]
+    for name, value in sorted(rails.items()):
+        opts += ["-r", "%s=%d" % (name, value)]
+    for item in args.cfg or []:
+        opts += ["-c", item]
+
+    tmp = tempfile.mkdtemp(prefix="replay_sim_")
+    try:
+        exe = sim_build(args.cc, tmp)
+        stdin = "".join("%d %d %02X\n" % (e.t_us - base, e.port, e.data) for e in feed)
+        out = subprocess.run([exe] + opts, input=stdin, stdout=subprocess.PIPE,
+                             universal_newlines=True, check=True).stdout
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+
+    captured = []
+    summary = None
+    for line in out.splitlines():
+        p = line.split()
+        if p[0] == "end":
+            summary = [int(x) for x in p[1:]]
+        elif len(p) == 4:
+            captured.append(TraceByte(int(p[0]), int(p[1]), int(p[2]), int(p[3], 16)))
+    if summary is None:
+        raise SystemExit("仿真程序异常退出")
+    print("工位 %s  测量值 %s" % (station if station is not None else "拨码",
+                                 " ".join("%s=%d" % kv for kv in sorted(rails.items())) or "默认"))
+    print("送入 %d 字节, 未模拟端口丢弃 %d, 0x55帧(不处理) %d" % tuple(summary[:3]))
+    if args.out:
+        with open(args.out, "w", newline="") as f:
+            f.write(format_dump(captured))
+        print("已保存: %s" % args.out)
+
+    # 录制时间以第一条输入为0, 与仿真对齐
+    for e in ref_entries:
+        e.t_us -= base
+    ref = split_frames(ref_entries, args.gap)
+    new = split_frames(captured, args.gap)
+    return 1 if diff_frames(ref, new, args.tolerance) else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="串口通讯录制分析/回放工具")
+    parser.add_argument("--gap", type=float, default=5.0, help="帧间隔判定 (ms), 默认5")
+    parser.add_argument("--tolerance", type=float, default=20.0, help="延时变化报告阈值 (ms), 默认20")
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    p = sub.add_parser("stats", help="统计总周期和各步骤延时")
+    p.add_argument("trace")
+    p.set_defaults(func=cmd_stats)
+
+    p = sub.add_parser("diff", help="比对两次录制中工装发出的帧")
+    p.add_argument("ref")
+    p.add_argument("new")
+    p.set_defaults(func=cmd_diff)
+
+    p = sub.add_parser("replay", help="向工装回放录制的输入并比对输出")
+    p.add_argument("trace")
+    p.add_argument("--port", action="append", help="端口映射, 如 UART1=/dev/ttyUSB0")
+    p.add_argument("--baud", action="append", help="波特率, 如 UART0=115200")
+    p.add_argument("--out", help="保存本次采集的日志")
+    p.add_argument("--settle", type=float, default=2.0, help="输入结束后继续采集的时间 (s)")
+    p.set_defaults(func=cmd_replay)
+
+    p = sub.add_parser("sim", help="在本机仿真的工装上回放录制的输入并比对输出")
+    p.add_argument("trace")
+    p.add_argument("--station", type=int, help="工位号, 默认取录制中的开始应答")
+    p.add_argument("--rail", action="append", help="测量值, 如 vcc=3300 (vcc/main/vdd mV, cur uA)")
+    p.add_argument("--cfg", action="append", help="工装配置, 如 step_ovl=1")
+    p.add_argument("--loop-us", type=int, default=20, help="主循环一圈的时间 (us)")
+    p.add_argument("--out", help="保存仿真录制的日志")
+    p.add_argument("--settle", type=float, default=2.0, help="录制结束后继续运行的时间 (s)")
+    p.add_argument("--cc", default="gcc")
+    p.set_defaults(func=cmd_sim)
+
+    args = parser.parse_args()
+    sys.exit(args.func(args))
+
+
+if __name__ == "__main__":
+    main()